@@ -11,12 +11,13 @@
  *
  */
 
-#include <assert.h>
 #include <getopt.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <doca_apsh.h>
@@ -28,6 +29,78 @@
 
 DOCA_LOG_REGISTER(APSH_APP);
 
+#define USEC_PER_SEC 1000000L	/* Number of microseconds in a second */
+#define NSEC_PER_USEC 1000L	/* Number of nanoseconds in a microsecond */
+
+/*
+ * Get the time elapsed since a given starting point
+ *
+ * @start [in]: Starting point, taken with CLOCK_MONOTONIC
+ * @return: elapsed time in microseconds
+ */
+static uint64_t
+elapsed_usec(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * USEC_PER_SEC + (now.tv_nsec - start->tv_nsec) / NSEC_PER_USEC;
+}
+
+/*
+ * Refresh and check the attestation of a single process, and report the result to telemetry
+ *
+ * @target [in]: Process to attest
+ * @telemetry_source [in]: Telemetry source, NULL if telemetry is disabled
+ * @indexes [in]: Telemetry event indexes
+ * @return: true if the process failed attestation
+ */
+static bool
+attest_target(struct apsh_target *target, struct doca_telemetry_source *telemetry_source,
+	      struct event_indexes *indexes)
+{
+	struct attestation_scan_result scan_result;
+	struct timespec scan_start;
+	doca_telemetry_timestamp_t timestamp;
+	doca_error_t result;
+	bool att_failure = false;
+
+	clock_gettime(CLOCK_MONOTONIC, &scan_start);
+
+	/* Refresh attestation */
+	result = doca_apsh_attst_refresh(&target->attestation, &target->att_count);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create a new attestation for pid=%d, error code: %d", target->attest_event.pid,
+			     result);
+		att_failure = true;
+	}
+
+	/* Check attestation and count the regions that changed since the last scan */
+	if (!att_failure) {
+		result = attestation_scan(&target->history, target->attestation, target->att_count, &scan_result);
+		att_failure = (result != DOCA_SUCCESS) || scan_result.failed;
+		target->attest_event.dirty_regions = scan_result.dirty_regions;
+		DOCA_LOG_DBG("Scan %" PRIu64 " of pid=%d: %d of %d regions dirty", target->attest_event.scan_count,
+			     target->attest_event.pid, scan_result.dirty_regions, target->att_count);
+	}
+	target->attest_event.scan_duration = elapsed_usec(&scan_start);
+
+	/* Send telemetry data */
+	if (telemetry_source != NULL) {
+		result = doca_telemetry_get_timestamp(&timestamp);
+		if (result != DOCA_SUCCESS)
+			DOCA_LOG_ERR("Failed to get timestamp, error code: %d", result);
+		target->attest_event.timestamp = timestamp;
+		target->attest_event.result = att_failure;
+		if (doca_telemetry_source_report(telemetry_source, indexes->attest_index, &target->attest_event, 1) !=
+		    DOCA_SUCCESS)
+			DOCA_LOG_ERR("Cannot report to telemetry");
+		++target->attest_event.scan_count;
+	}
+
+	return att_failure;
+}
+
 /*
  * APSH agent application main function
  *
@@ -41,19 +114,16 @@ main(int argc, char **argv)
 	doca_error_t result;
 	int exit_status = EXIT_SUCCESS;
 	struct doca_apsh_process **processes;
-	struct doca_apsh_process *process = NULL;
-	struct doca_apsh_attestation **attestation;
-	int att_failure = 0, att_count;
+	struct apsh_target *targets, *target;
+	int nb_targets, nb_active, target_idx;
 	struct apsh_resources resources;
-	struct apsh_config apsh_conf;
-	int runtime_file_ind;
+	struct apsh_config apsh_conf = {0};
 	struct event_indexes indexes;
-	struct attestation_event attest_event;
 	struct doca_telemetry_schema *telemetry_schema;
 	struct doca_telemetry_source *telemetry_source;
-	const char *process_path;
 	bool telemetry_enabled;
-	doca_telemetry_timestamp_t timestamp;
+	struct timespec now;
+	time_t wait;
 	struct doca_log_backend *sdk_log;
 
 	/* Register a logger backend */
@@ -88,7 +158,7 @@ main(int argc, char **argv)
 		return EXIT_FAILURE;
 	}
 
-	/* Init the app shield agent app */
+	/* Init the app shield agent app, a single APSH system is shared by all the attested processes */
 	result = app_shield_agent_init(&apsh_conf, &resources);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to init application: %s", doca_error_get_descr(result));
@@ -96,10 +166,11 @@ main(int argc, char **argv)
 		return EXIT_FAILURE;
 	}
 
-	/* Get process with 'pid' */
-	result = get_process_by_pid(&resources, &apsh_conf, &processes, &process);
+	/* Get the processes to attest and their initial attestation */
+	result = attestation_targets_create(&resources, &apsh_conf, &processes, &targets, &nb_targets);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Apsh init was successful but failed to read process %d information: %s", apsh_conf.pid, doca_error_get_descr(result));
+		DOCA_LOG_ERR("Apsh init was successful but failed to read processes information: %s",
+			     doca_error_get_descr(result));
 		exit_status = EXIT_FAILURE;
 		goto apsh_cleanup;
 	}
@@ -107,67 +178,39 @@ main(int argc, char **argv)
 	/* Creating telemetry schema */
 	telemetry_enabled = (telemetry_start(&telemetry_schema, &telemetry_source, &indexes) == DOCA_SUCCESS);
 
-	/* Set const values of the telemetry data */
-	attest_event.pid = apsh_conf.pid;
-	attest_event.scan_count = 0;
-	process_path = doca_apsh_process_info_get(process, DOCA_APSH_PROCESS_COMM);
-	assert(process_path != NULL);  /* Should never happen, but will catch this error here instead of in strncpy */
-	/* Copy string & pad with '\0' until MAX_PATH_LEN bytes were written. this clean the telemetry message */
-	strncpy(attest_event.path, process_path, MAX_PATH_LEN);
-	attest_event.path[MAX_PATH_LEN] = '\0';
-
-	/* Get attestation */
-	result = doca_apsh_attestation_get(process, apsh_conf.exec_hash_map_path, &attestation, &att_count);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Attestation init failed: %s", doca_error_get_descr(result));
-		exit_status = EXIT_FAILURE;
-		goto telemetry_cleanup;
-	}
-
-	/* Start attestation on loop with time_interval */
-	DOCA_LOG_INFO("Start attestation on pid=%d", apsh_conf.pid);
-	do {
-		/* Refresh attestation */
-		result = doca_apsh_attst_refresh(&attestation, &att_count);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Failed to create a new attestation, error code: %d", result);
-			att_failure = true;
-		}
-
-		/* Check attestation */
-		for (runtime_file_ind = 0; runtime_file_ind < att_count && !att_failure; runtime_file_ind++) {
-			att_failure =
-				  doca_apsh_attst_info_get(attestation[runtime_file_ind], DOCA_APSH_ATTESTATION_PAGES_PRESENT) !=
-				  doca_apsh_attst_info_get(attestation[runtime_file_ind], DOCA_APSH_ATTESTATION_MATCHING_HASHES);
+	/* Start attestation, each process is scanned every time_interval of its own */
+	for (target_idx = 0; target_idx < nb_targets; target_idx++)
+		DOCA_LOG_INFO("Start attestation on pid=%d, every %d seconds, weight %d",
+			      targets[target_idx].attest_event.pid, targets[target_idx].time_interval,
+			      targets[target_idx].weight);
+
+	nb_active = nb_targets;
+	while (nb_active > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		target = attestation_schedule_next(targets, nb_targets, now.tv_sec, &wait);
+		if (target == NULL) {
+			sleep(wait);
+			continue;
 		}
 
-		/* Send telemetry data */
-		if (telemetry_enabled) {
-			result = doca_telemetry_get_timestamp(&timestamp);
-			if (result != DOCA_SUCCESS)
-				DOCA_LOG_ERR("Failed to get timestamp, error code: %d", result);
-			attest_event.timestamp = timestamp;
-			attest_event.result = att_failure;
-			if (doca_telemetry_source_report(telemetry_source, indexes.attest_index, &attest_event, 1) != DOCA_SUCCESS)
-				DOCA_LOG_ERR("Cannot report to telemetry");
-			++attest_event.scan_count;
-		}
-
-		/* Check attestation attempt status */
-		if (att_failure) {
-			DOCA_LOG_INFO("Attestation failed");
+		/* Check attestation attempt status, a process that failed is no longer attested */
+		if (attest_target(target, telemetry_enabled ? telemetry_source : NULL, &indexes)) {
+			DOCA_LOG_INFO("Attestation failed on pid=%d", target->attest_event.pid);
 			exit_status = EXIT_FAILURE;
-			break;
+			target->active = false;
+			nb_active--;
+			continue;
 		}
-		DOCA_LOG_INFO("Attestation pass");
-		sleep(apsh_conf.time_interval);
-	} while (true);
+		DOCA_LOG_INFO("Attestation pass on pid=%d", target->attest_event.pid);
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		target->next_scan = now.tv_sec + target->time_interval;
+	}
 
 	/* Destroy */
-	doca_apsh_attestation_free(attestation);
-telemetry_cleanup:
 	if (telemetry_enabled)
 		telemetry_destroy(telemetry_schema, telemetry_source);
+	attestation_targets_destroy(targets, nb_targets);
 	doca_apsh_processes_free(processes);
 apsh_cleanup:
 	app_shield_agent_cleanup(&resources);
@@ -27,6 +27,37 @@ DOCA_LOG_REGISTER(APSH_APP::Core);
 /* This value is guaranteed to be 253 on Linux, and 16 bytes on Windows */
 #define MAX_HOSTNAME_LEN 253
 
+/*
+ * Add a process to attest by pid, ignoring pids that were already added
+ *
+ * @conf [in/out]: Program configuration context
+ * @pid [in]: Pid of the process
+ * @time_interval [in]: Seconds between two checks of the process, 0 for the global interval
+ * @weight [in]: Scheduling weight of the process
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+add_target(struct apsh_config *conf, DOCA_APSH_PROCESS_PID_TYPE pid, int time_interval, int weight)
+{
+	int idx;
+
+	for (idx = 0; idx < conf->nb_targets; idx++) {
+		if (conf->targets[idx].pid == pid) {
+			DOCA_LOG_WARN("Process %d was requested more than once, using its first settings", pid);
+			return DOCA_SUCCESS;
+		}
+	}
+	if (conf->nb_targets == MAX_ATTESTATION_TARGETS) {
+		DOCA_LOG_ERR("Too many processes to attest, at most %d are supported", MAX_ATTESTATION_TARGETS);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	conf->targets[conf->nb_targets].pid = pid;
+	conf->targets[conf->nb_targets].time_interval = time_interval;
+	conf->targets[conf->nb_targets].weight = weight;
+	conf->nb_targets++;
+	return DOCA_SUCCESS;
+}
+
 /*
  * ARGP Callback - Handle target process PID parameter
  *
@@ -39,7 +70,54 @@ pid_callback(void *param, void *config)
 {
 	struct apsh_config *conf = (struct apsh_config *)config;
 
-	conf->pid = *(DOCA_APSH_PROCESS_PID_TYPE *)param;
+	return add_target(conf, *(DOCA_APSH_PROCESS_PID_TYPE *)param, 0, 1);
+}
+
+/*
+ * ARGP Callback - Handle target process with scheduling settings parameter, formatted <pid>[:<seconds>[:<weight>]]
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+target_callback(void *param, void *config)
+{
+	struct apsh_config *conf = (struct apsh_config *)config;
+	unsigned int pid;
+	int time_interval = 0, weight = 1, nb_fields;
+	char extra;
+
+	nb_fields = sscanf((char *)param, "%u:%d:%d%c", &pid, &time_interval, &weight, &extra);
+	if (nb_fields < 1 || nb_fields > 3 || time_interval < 0 || weight < 1) {
+		DOCA_LOG_ERR("Invalid target \"%s\", expected <pid>[:<seconds>[:<weight>]]", (char *)param);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return add_target(conf, pid, time_interval, weight);
+}
+
+/*
+ * ARGP Callback - Handle process name filter parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+process_name_callback(void *param, void *config)
+{
+	struct apsh_config *conf = (struct apsh_config *)config;
+	size_t size = sizeof(conf->process_filters[0]);
+
+	if (conf->nb_process_filters == MAX_PROCESS_FILTERS) {
+		DOCA_LOG_ERR("Too many process names, at most %d are supported", MAX_PROCESS_FILTERS);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (strnlen(param, size) >= size) {
+		DOCA_LOG_ERR("Process name argument too long, must be <=%zu long", size - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(conf->process_filters[conf->nb_process_filters++], param);
 	return DOCA_SUCCESS;
 }
 
@@ -203,12 +281,31 @@ time_callback(void *param, void *config)
 	return DOCA_SUCCESS;
 }
 
+/*
+ * ARGP validation Callback - Check that there is at least one process to attest
+ *
+ * @config [in]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+args_validation_callback(void *config)
+{
+	struct apsh_config *conf = (struct apsh_config *)config;
+
+	if (conf->nb_targets == 0 && conf->nb_process_filters == 0) {
+		DOCA_LOG_ERR("No process to attest, at least one pid, target or process name is required");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
 doca_error_t
 register_apsh_params(void)
 {
 	doca_error_t result;
 	struct doca_argp_param *pid_param, *hash_map_param, *memr_param, *vuid_param, *dma_param, *os_syms_param;
 	struct doca_argp_param *time_param, *os_type_param;
+	struct doca_argp_param *target_param, *process_name_param;
 
 	/* Create and register pid param */
 	result = doca_argp_param_create(&pid_param);
@@ -218,16 +315,56 @@ register_apsh_params(void)
 	}
 	doca_argp_param_set_short_name(pid_param, "p");
 	doca_argp_param_set_long_name(pid_param, "pid");
-	doca_argp_param_set_description(pid_param, "Process ID of process to be attested");
+	doca_argp_param_set_description(pid_param, "Process ID of process to be attested, can be given multiple times");
 	doca_argp_param_set_callback(pid_param, pid_callback);
 	doca_argp_param_set_type(pid_param, DOCA_ARGP_TYPE_INT);
-	doca_argp_param_set_mandatory(pid_param);
+	doca_argp_param_set_multiplicity(pid_param);
 	result = doca_argp_register_param(pid_param);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
 		return result;
 	}
 
+	/* Create and register target with scheduling settings param */
+	result = doca_argp_param_create(&target_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(target_param, "target");
+	doca_argp_param_set_arguments(target_param, "<pid>[:<seconds>[:<weight>]]");
+	doca_argp_param_set_description(target_param,
+					"Process ID to be attested with its own scan interval and scheduling weight, "
+					"can be given multiple times");
+	doca_argp_param_set_callback(target_param, target_callback);
+	doca_argp_param_set_type(target_param, DOCA_ARGP_TYPE_STRING);
+	doca_argp_param_set_multiplicity(target_param);
+	result = doca_argp_register_param(target_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register process name filter param */
+	result = doca_argp_param_create(&process_name_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(process_name_param, "n");
+	doca_argp_param_set_long_name(process_name_param, "name");
+	doca_argp_param_set_arguments(process_name_param, "<name>");
+	doca_argp_param_set_description(process_name_param,
+					"Attest all the processes with this name, can be given multiple times");
+	doca_argp_param_set_callback(process_name_param, process_name_callback);
+	doca_argp_param_set_type(process_name_param, DOCA_ARGP_TYPE_STRING);
+	doca_argp_param_set_multiplicity(process_name_param);
+	result = doca_argp_register_param(process_name_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
 	/* Create and register process hash map param for attestation */
 	result = doca_argp_param_create(&hash_map_param);
 	if (result != DOCA_SUCCESS) {
@@ -349,7 +486,7 @@ register_apsh_params(void)
 	doca_argp_param_set_short_name(time_param, "t");
 	doca_argp_param_set_long_name(time_param, "time");
 	doca_argp_param_set_arguments(time_param, "<seconds>");
-	doca_argp_param_set_description(time_param, "Scan time interval in seconds");
+	doca_argp_param_set_description(time_param, "Scan time interval in seconds, for processes without their own");
 	doca_argp_param_set_callback(time_param, time_callback);
 	doca_argp_param_set_type(time_param, DOCA_ARGP_TYPE_INT);
 	doca_argp_param_set_mandatory(time_param);
@@ -359,6 +496,12 @@ register_apsh_params(void)
 		return result;
 	}
 
+	result = doca_argp_register_validation_callback(args_validation_callback);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program validation callback: %s", doca_error_get_descr(result));
+		return result;
+	}
+
 	result = doca_argp_register_version_callback(sdk_version_callback);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to register version callback: %s", doca_error_get_descr(result));
@@ -535,42 +678,245 @@ app_shield_agent_cleanup(struct apsh_resources *resources)
 	}
 }
 
+/*
+ * Check if a process was requested for attestation, by pid or by name
+ *
+ * @apsh_conf [in]: Configuration values
+ * @process [in]: Target system process
+ * @target_conf [out]: Settings of the process when requested by pid, NULL when requested by name only
+ * @return: true if the process should be attested
+ */
+static bool
+is_requested_process(struct apsh_config *apsh_conf, struct doca_apsh_process *process,
+		     struct apsh_target_config **target_conf)
+{
+	DOCA_APSH_PROCESS_PID_TYPE pid = doca_apsh_process_info_get(process, DOCA_APSH_PROCESS_PID);
+	const char *comm;
+	int idx;
+
+	*target_conf = NULL;
+	for (idx = 0; idx < apsh_conf->nb_targets; idx++) {
+		if (apsh_conf->targets[idx].pid == pid) {
+			*target_conf = &apsh_conf->targets[idx];
+			return true;
+		}
+	}
+
+	comm = doca_apsh_process_info_get(process, DOCA_APSH_PROCESS_COMM);
+	if (comm == NULL)
+		return false;
+	for (idx = 0; idx < apsh_conf->nb_process_filters; idx++) {
+		if (strcmp(apsh_conf->process_filters[idx], comm) == 0)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Initialize an attestation target and get its initial attestation
+ *
+ * @apsh_conf [in]: Configuration values
+ * @process [in]: Target system process
+ * @target_conf [in]: Settings of the process, NULL for the defaults
+ * @target [out]: Attestation target to initialize
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+attestation_target_init(struct apsh_config *apsh_conf, struct doca_apsh_process *process,
+			struct apsh_target_config *target_conf, struct apsh_target *target)
+{
+	const char *process_path;
+	doca_error_t result;
+
+	memset(target, 0, sizeof(*target));
+	target->process = process;
+	target->time_interval = apsh_conf->time_interval;
+	target->weight = 1;
+	if (target_conf != NULL) {
+		if (target_conf->time_interval != 0)
+			target->time_interval = target_conf->time_interval;
+		target->weight = target_conf->weight;
+	}
+
+	/* Set const values of the telemetry data */
+	target->attest_event.pid = doca_apsh_process_info_get(process, DOCA_APSH_PROCESS_PID);
+	process_path = doca_apsh_process_info_get(process, DOCA_APSH_PROCESS_COMM);
+	if (process_path == NULL) {
+		DOCA_LOG_ERR("Failed to read process %d name", target->attest_event.pid);
+		return DOCA_ERROR_NOT_FOUND;
+	}
+	/* Copy string & pad with '\0' until MAX_PATH_LEN bytes were written. this clean the telemetry message */
+	strncpy(target->attest_event.path, process_path, MAX_PATH_LEN);
+	target->attest_event.path[MAX_PATH_LEN] = '\0';
+
+	/* All targets use the same exec hash map, lib APSH loads it along with the process attestation */
+	result = doca_apsh_attestation_get(process, apsh_conf->exec_hash_map_path, &target->attestation,
+					   &target->att_count);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Attestation init of process %d failed: %s", target->attest_event.pid,
+			     doca_error_get_descr(result));
+		return result;
+	}
+
+	target->active = true;
+	return DOCA_SUCCESS;
+}
+
 doca_error_t
-get_process_by_pid(struct apsh_resources *resources, struct apsh_config *apsh_conf,
-		   struct doca_apsh_process ***pslist, struct doca_apsh_process **process)
+attestation_targets_create(struct apsh_resources *resources, struct apsh_config *apsh_conf,
+			   struct doca_apsh_process ***pslist, struct apsh_target **targets, int *nb_targets)
 {
 	struct doca_apsh_process **processes;
+	struct apsh_target *new_targets;
+	struct apsh_target_config *target_conf;
 	doca_error_t result;
-	int proc_count, process_idx;
-	typeof(apsh_conf->pid) cur_proc_pid = 0;
+	int proc_count, process_idx, target_idx, nb_new_targets = 0;
 
-	/* Create list of processes on remote system */
+	/* Create list of processes on remote system, shared by all targets */
 	result = doca_apsh_processes_get(resources->sys, &processes, &proc_count);
-	if (result == DOCA_SUCCESS)
-		*pslist = processes;
-	else {
-		app_shield_agent_cleanup(resources);
+	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Get processes failed");
 		return result;
 	}
 
-	/* Search for the process 'pid' */
+	new_targets = (struct apsh_target *)calloc(MAX_ATTESTATION_TARGETS, sizeof(*new_targets));
+	if (new_targets == NULL) {
+		DOCA_LOG_ERR("Failed to allocate attestation targets");
+		doca_apsh_processes_free(processes);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	/* Search for the processes requested by pid or by name */
 	for (process_idx = 0; process_idx < proc_count; process_idx++) {
-		cur_proc_pid = doca_apsh_process_info_get(processes[process_idx], DOCA_APSH_PROCESS_PID);
+		if (!is_requested_process(apsh_conf, processes[process_idx], &target_conf))
+			continue;
+		if (nb_new_targets == MAX_ATTESTATION_TARGETS) {
+			DOCA_LOG_ERR("Too many processes to attest, at most %d are supported", MAX_ATTESTATION_TARGETS);
+			result = DOCA_ERROR_FULL;
+			goto targets_cleanup;
+		}
+		result = attestation_target_init(apsh_conf, processes[process_idx], target_conf,
+						 &new_targets[nb_new_targets]);
+		if (result != DOCA_SUCCESS)
+			goto targets_cleanup;
+		nb_new_targets++;
+	}
 
-		if (apsh_conf->pid == cur_proc_pid) {
-			*process = processes[process_idx];
-			break;
+	/* Every process requested by pid must exist, name filters may match nothing */
+	for (target_idx = 0; target_idx < apsh_conf->nb_targets; target_idx++) {
+		for (process_idx = 0; process_idx < nb_new_targets; process_idx++) {
+			if (new_targets[process_idx].attest_event.pid == (int32_t)apsh_conf->targets[target_idx].pid)
+				break;
+		}
+		if (process_idx == nb_new_targets) {
+			DOCA_LOG_ERR("Process (%d) was not found", apsh_conf->targets[target_idx].pid);
+			result = DOCA_ERROR_NOT_FOUND;
+			goto targets_cleanup;
 		}
 	}
-	if (*process == NULL) {
-		doca_apsh_processes_free(processes);
-		app_shield_agent_cleanup(resources);
-		DOCA_LOG_ERR("Process (%d) was not found", apsh_conf->pid);
-		return DOCA_ERROR_NOT_FOUND;
+	if (nb_new_targets == 0) {
+		DOCA_LOG_ERR("No process matches the requested process names");
+		result = DOCA_ERROR_NOT_FOUND;
+		goto targets_cleanup;
 	}
 
 	*pslist = processes;
+	*targets = new_targets;
+	*nb_targets = nb_new_targets;
+	return DOCA_SUCCESS;
+
+targets_cleanup:
+	attestation_targets_destroy(new_targets, nb_new_targets);
+	doca_apsh_processes_free(processes);
+	return result;
+}
+
+void
+attestation_targets_destroy(struct apsh_target *targets, int nb_targets)
+{
+	int target_idx;
+
+	for (target_idx = 0; target_idx < nb_targets; target_idx++) {
+		if (targets[target_idx].attestation != NULL)
+			doca_apsh_attestation_free(targets[target_idx].attestation);
+		free(targets[target_idx].history.regions);
+	}
+	free(targets);
+}
+
+struct apsh_target *
+attestation_schedule_next(struct apsh_target *targets, int nb_targets, time_t now, time_t *wait)
+{
+	struct apsh_target *next = NULL;
+	time_t next_due = 0;
+	int target_idx, total_weight = 0;
+
+	for (target_idx = 0; target_idx < nb_targets; target_idx++) {
+		if (!targets[target_idx].active)
+			continue;
+		if (targets[target_idx].next_scan > now) {
+			if (next_due == 0 || targets[target_idx].next_scan < next_due)
+				next_due = targets[target_idx].next_scan;
+			continue;
+		}
+		targets[target_idx].current_weight += targets[target_idx].weight;
+		total_weight += targets[target_idx].weight;
+		if (next == NULL || targets[target_idx].current_weight > next->current_weight)
+			next = &targets[target_idx];
+	}
+
+	if (next != NULL)
+		next->current_weight -= total_weight;
+	else
+		*wait = next_due - now;
+	return next;
+}
+
+doca_error_t
+attestation_scan(struct attestation_history *history, struct doca_apsh_attestation **attestation, int att_count,
+		 struct attestation_scan_result *result)
+{
+	struct attestation_region *regions, *region;
+	uint64_t start_address, end_address;
+	int idx, pages_present, matching_hashes;
+
+	/* Grow the regions state to the number of entries, new regions are dirty */
+	if (att_count > history->nb_regions) {
+		regions = (struct attestation_region *)realloc(history->regions, att_count * sizeof(*regions));
+		if (regions == NULL) {
+			DOCA_LOG_ERR("Failed to allocate attestation regions state");
+			return DOCA_ERROR_NO_MEMORY;
+		}
+		memset(&regions[history->nb_regions], 0, (att_count - history->nb_regions) * sizeof(*regions));
+		history->regions = regions;
+		history->nb_regions = att_count;
+	}
+
+	/*
+	 * The refresh already hashed every present page, checking an entry is a few reads and compares, so all the
+	 * entries are checked and the previous scan only tells which regions changed
+	 */
+	memset(result, 0, sizeof(*result));
+	for (idx = 0; idx < att_count; idx++) {
+		region = &history->regions[idx];
+		start_address = doca_apsh_attst_info_get(attestation[idx], DOCA_APSH_ATTESTATION_START_ADDRESS);
+		end_address = doca_apsh_attst_info_get(attestation[idx], DOCA_APSH_ATTESTATION_END_ADDRESS);
+		pages_present = doca_apsh_attst_info_get(attestation[idx], DOCA_APSH_ATTESTATION_PAGES_PRESENT);
+		matching_hashes = doca_apsh_attst_info_get(attestation[idx], DOCA_APSH_ATTESTATION_MATCHING_HASHES);
+
+		if (!region->valid || region->start_address != start_address || region->end_address != end_address ||
+		    region->pages_present != pages_present || region->matching_hashes != matching_hashes)
+			result->dirty_regions++;
+
+		region->start_address = start_address;
+		region->end_address = end_address;
+		region->pages_present = pages_present;
+		region->matching_hashes = matching_hashes;
+		region->valid = (pages_present == matching_hashes);
+		if (!region->valid)
+			result->failed = true;
+	}
+	history->scan_count++;
 	return DOCA_SUCCESS;
 }
 
@@ -588,7 +934,7 @@ telemetry_register_attest_event(struct doca_telemetry_schema *schema, doca_telem
 	/* Event type for schema. Should be consistent with event struct */
 	struct doca_telemetry_type *type;
 	struct doca_telemetry_field *field;
-	const int nb_fields = 5;
+	const int nb_fields = 7;
 	int idx = 0;
 	struct {
 		const char *name;
@@ -600,6 +946,8 @@ telemetry_register_attest_event(struct doca_telemetry_schema *schema, doca_telem
 		{"pid", "Pid", DOCA_TELEMETRY_FIELD_TYPE_INT32, 1},
 		{"result", "Result", DOCA_TELEMETRY_FIELD_TYPE_INT32, 1},
 		{ "scan_count", "Scan Count", DOCA_TELEMETRY_FIELD_TYPE_UINT64, 1},
+		{ "scan_duration", "Scan Duration [us]", DOCA_TELEMETRY_FIELD_TYPE_UINT64, 1},
+		{ "dirty_regions", "Dirty Regions", DOCA_TELEMETRY_FIELD_TYPE_INT32, 1},
 		{ "path", "Path", DOCA_TELEMETRY_FIELD_TYPE_CHAR, MAX_PATH_LEN},
 	};
 
@@ -14,6 +14,9 @@
 #ifndef APP_SHIELD_AGENT_CORE_H_
 #define APP_SHIELD_AGENT_CORE_H_
 
+#include <stdbool.h>
+#include <time.h>
+
 #include <doca_apsh.h>
 #include <doca_apsh_attr.h>
 #include <doca_dev.h>
@@ -30,9 +33,21 @@ extern "C" {
  * the official doc refer only to a full path to file and is saying the default MAX_PATH_LEN value is 260 (can be changed).
  */
 #define MAX_PATH_LEN 260
+#define MAX_ATTESTATION_TARGETS 256	/* Maximal number of processes attested by a single agent */
+#define MAX_PROCESS_FILTERS 16		/* Maximal number of process name filters */
 
-struct apsh_config {
+/* Process requested for attestation by pid */
+struct apsh_target_config {
 	DOCA_APSH_PROCESS_PID_TYPE pid;				/* Pid of process to validate integrity of */
+	int time_interval;					/* Seconds between two checks, 0 for the global interval */
+	int weight;						/* Scheduling weight when several processes are due */
+};
+
+struct apsh_config {
+	struct apsh_target_config targets[MAX_ATTESTATION_TARGETS];	/* Processes to attest, by pid */
+	int nb_targets;						/* Number of processes requested by pid */
+	char process_filters[MAX_PROCESS_FILTERS][MAX_PATH_LEN];	/* Names of processes to attest */
+	int nb_process_filters;					/* Number of process name filters */
 	char exec_hash_map_path[MAX_PATH_LEN];			/* Path to APSH's hash.zip file */
 	char system_mem_region_path[MAX_PATH_LEN];			/* Path to APSH's mem_regions.json file */
 	char system_vuid[DOCA_DEVINFO_VUID_SIZE + 1];		/* Virtual Unique Identifier belonging to the PF/VF
@@ -41,7 +56,7 @@ struct apsh_config {
 	char dma_dev_name[DOCA_DEVINFO_IBDEV_NAME_SIZE + 1];	/* DMA device name */
 	char system_os_symbol_map_path[MAX_PATH_LEN];		/* Path to APSH's os_symbols.json file */
 	enum doca_apsh_system_os os_type;			/* Enum describing the target system OS type */
-	int time_interval;					/* Seconds to sleep between two integrity checks */
+	int time_interval;					/* Default seconds between two integrity checks of a process */
 };
 
 struct apsh_resources {
@@ -59,6 +74,8 @@ struct attestation_event {
 	int32_t                     pid;		/* Process id number that have been scanned */
 	int32_t                     result;		/* The end result of the scan, 0 on uncompromising, error otherwise */
 	uint64_t                    scan_count;		/* This scan number, beginning with 0 */
+	uint64_t                    scan_duration;	/* Time the scan took (refresh and check), in microseconds */
+	int32_t                     dirty_regions;	/* Number of regions that changed since the previous scan */
 	char                        path[MAX_PATH_LEN + 1];	/* The path of that process  */
 } __attribute__((packed));
 
@@ -68,6 +85,42 @@ struct event_indexes {
 							 */
 };
 
+/* State of an attested memory region, as seen on the previous scan */
+struct attestation_region {
+	uint64_t start_address;				/* Region start address */
+	uint64_t end_address;				/* Region end address */
+	int pages_present;				/* Number of region pages that were present in memory */
+	int matching_hashes;				/* Number of present pages that matched their hashes */
+	bool valid;					/* True if the region matched its hashes */
+};
+
+/* Per-process attestation state, kept between scans */
+struct attestation_history {
+	struct attestation_region *regions;		/* Regions state, indexed as the attestation entries */
+	int nb_regions;					/* Allocated size of the regions array */
+	uint64_t scan_count;				/* Number of scans done so far */
+};
+
+/* A process attested by the agent */
+struct apsh_target {
+	struct doca_apsh_process *process;		/* Target process, owned by the shared processes list */
+	struct doca_apsh_attestation **attestation;	/* Latest attestation snapshot of the process */
+	int att_count;					/* Number of attestation entries in the snapshot */
+	struct attestation_history history;		/* Regions state of the previous scans */
+	struct attestation_event attest_event;		/* Telemetry event, holds the pid, path and scan count */
+	int time_interval;				/* Seconds between two checks of the process */
+	int weight;					/* Scheduling weight when several processes are due */
+	int current_weight;				/* Smooth weighted round-robin credit */
+	time_t next_scan;				/* Monotonic time, in seconds, the process is due for a scan */
+	bool active;					/* False once the process failed attestation */
+};
+
+/* Outcome of a single attestation scan */
+struct attestation_scan_result {
+	bool failed;					/* True if at least one region does not match its hashes */
+	int dirty_regions;				/* Regions that are new or changed since the previous scan */
+};
+
 /*
  * Register the command line parameters for the application
  *
@@ -94,18 +147,57 @@ doca_error_t app_shield_agent_init(struct apsh_config *conf, struct apsh_resourc
 void app_shield_agent_cleanup(struct apsh_resources *resources);
 
 /*
- * Searches the target system for a process with the provided PID.
+ * Searches the target system for the processes to attest, by pid and by name, and gets their initial attestation.
+ * All targets share the same APSH system and processes list.
  *
  * @resources [in]: Resources to use with lib APSH API
- * @apsh_conf [in]: Configuration values, including the PID to search for
+ * @apsh_conf [in]: Configuration values, including the pids and names to search for
  * @pslist [out]: Allocated target-system processes list
- * @process [out]: The process with the PID
+ * @targets [out]: Allocated array of attestation targets
+ * @nb_targets [out]: Number of attestation targets
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  *
  * @NOTE: In case of failure, all allocated resource are freed
  */
-doca_error_t get_process_by_pid(struct apsh_resources *resources, struct apsh_config *apsh_conf,
-				struct doca_apsh_process ***pslist, struct doca_apsh_process **process);
+doca_error_t attestation_targets_create(struct apsh_resources *resources, struct apsh_config *apsh_conf,
+					struct doca_apsh_process ***pslist, struct apsh_target **targets,
+					int *nb_targets);
+
+/*
+ * Free the attestation targets
+ *
+ * @targets [in]: Array of attestation targets
+ * @nb_targets [in]: Number of attestation targets
+ */
+void attestation_targets_destroy(struct apsh_target *targets, int nb_targets);
+
+/*
+ * Pick the next process to attest.
+ * Among the processes that are due, the choice is made by smooth weighted round-robin, so a process with weight w is
+ * picked w times as often as a process with weight 1 while the agent is behind schedule.
+ *
+ * @targets [in]: Array of attestation targets
+ * @nb_targets [in]: Number of attestation targets
+ * @now [in]: Current monotonic time, in seconds
+ * @wait [out]: When no process is due, the number of seconds until the next one is
+ * @return: the process to attest, or NULL if none is due
+ */
+struct apsh_target *attestation_schedule_next(struct apsh_target *targets, int nb_targets, time_t now, time_t *wait);
+
+/*
+ * Check a freshly refreshed attestation snapshot and count the regions whose address range, present pages or
+ * matching hashes changed since the previous scan of the process.
+ * All the entries are checked: doca_apsh_attst_refresh() hashes the whole process and APSH has no per-region refresh,
+ * so skipping the unchanged regions would not save any hashing.
+ *
+ * @history [in/out]: Regions state of the attested process, updated by the scan
+ * @attestation [in]: Attestation entries, as returned by doca_apsh_attst_refresh()
+ * @att_count [in]: Number of attestation entries
+ * @result [out]: Scan outcome
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t attestation_scan(struct attestation_history *history, struct doca_apsh_attestation **attestation,
+			      int att_count, struct attestation_scan_result *result);
 
 /*
  * Creates a new DOCA Telemetry schema and source, with a register attestation event
@@ -0,0 +1,378 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flow_id_registry.h"
+
+#define HANDLE_INDEX(handle) ((uint32_t)(handle))		/* Slot index of a handle */
+#define HANDLE_GENERATION(handle) ((uint32_t)((handle) >> 32))	/* Generation of a handle */
+#define SLAB_OF(index) ((index) >> FLOW_ID_SLAB_SHIFT)		/* Slab of a slot index */
+#define SLOT_OF(index) ((index) & (FLOW_ID_SLAB_SIZE - 1))	/* Position of a slot index in its slab */
+#define MAP_WORD_BITS 64					/* Bits in a word of the free map */
+
+/*
+ * Get the slot of a slot index, the slab of the index must be allocated
+ *
+ * @registry [in]: Registry
+ * @index [in]: Slot index
+ * @return: The slot
+ */
+static inline struct flow_id_slot *
+get_slot(const struct flow_id_registry *registry, uint32_t index)
+{
+	return &registry->slabs[SLAB_OF(index)]->slots[SLOT_OF(index)];
+}
+
+/*
+ * Find the live slot of a handle
+ *
+ * @registry [in]: Registry
+ * @handle [in]: Handle of the object
+ * @type [in]: Expected type of the object
+ * @return: The slot, NULL if the handle is not a live object of that type
+ */
+static struct flow_id_slot *
+find_slot(const struct flow_id_registry *registry, uint64_t handle, enum flow_id_type type)
+{
+	uint32_t index = HANDLE_INDEX(handle);
+	struct flow_id_slab *slab;
+	struct flow_id_slot *slot;
+
+	if (SLAB_OF(index) >= registry->nb_slabs)
+		return NULL;
+	slab = registry->slabs[SLAB_OF(index)];
+	if (slab == NULL)
+		return NULL;
+	slot = &slab->slots[SLOT_OF(index)];
+	if (slot->type != type || slot->generation != HANDLE_GENERATION(handle))
+		return NULL;
+	return slot;
+}
+
+/*
+ * Set or clear the free map bit of a slab
+ *
+ * @registry [in]: Registry
+ * @slab_idx [in]: Index of the slab
+ * @has_free [in]: True if the slab is allocated and has free slots
+ */
+static inline void
+set_has_free(struct flow_id_registry *registry, uint32_t slab_idx, bool has_free)
+{
+	uint64_t bit = 1ULL << (slab_idx % MAP_WORD_BITS);
+
+	if (has_free)
+		registry->free_map[slab_idx / MAP_WORD_BITS] |= bit;
+	else
+		registry->free_map[slab_idx / MAP_WORD_BITS] &= ~bit;
+}
+
+/*
+ * Double the size of the slabs array and of the free map
+ *
+ * @registry [in]: Registry
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+grow_slabs(struct flow_id_registry *registry)
+{
+	uint32_t nb_slabs = registry->nb_slabs == 0 ? MAP_WORD_BITS : registry->nb_slabs * 2;
+	uint32_t nb_words = nb_slabs / MAP_WORD_BITS, old_nb_words = registry->nb_slabs / MAP_WORD_BITS;
+	struct flow_id_slab **slabs;
+	uint64_t *free_map;
+
+	if (registry->nb_slabs == FLOW_ID_MAX_SLABS)
+		return DOCA_ERROR_FULL;
+
+	slabs = realloc(registry->slabs, nb_slabs * sizeof(*slabs));
+	if (slabs == NULL)
+		return DOCA_ERROR_NO_MEMORY;
+	registry->slabs = slabs;
+	memset(&slabs[registry->nb_slabs], 0, (nb_slabs - registry->nb_slabs) * sizeof(*slabs));
+
+	free_map = realloc(registry->free_map, nb_words * sizeof(*free_map));
+	if (free_map == NULL)
+		return DOCA_ERROR_NO_MEMORY;
+	registry->free_map = free_map;
+	memset(&free_map[old_nb_words], 0, (nb_words - old_nb_words) * sizeof(*free_map));
+
+	registry->nb_slabs = nb_slabs;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Allocate a slab in the first unused place of the slabs array. The generations of its slots start above every
+ * generation the registry handed out, so a handle of a released slab does not match the new slots.
+ *
+ * @registry [in]: Registry
+ * @slab_idx [out]: Index of the new slab
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+add_slab(struct flow_id_registry *registry, uint32_t *slab_idx)
+{
+	struct flow_id_slab *slab;
+	uint32_t idx, i, generation;
+	doca_error_t result;
+
+	for (idx = 0; idx < registry->nb_slabs; idx++) {
+		if (registry->slabs[idx] == NULL)
+			break;
+	}
+	if (idx == registry->nb_slabs) {
+		result = grow_slabs(registry);
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+
+	slab = malloc(sizeof(*slab));
+	if (slab == NULL)
+		return DOCA_ERROR_NO_MEMORY;
+
+	generation = registry->max_generation + 1;
+	if (generation == 0)
+		generation = 1;
+	for (i = 0; i < FLOW_ID_SLAB_SIZE; i++) {
+		slab->slots[i].object = NULL;
+		slab->slots[i].generation = generation;
+		slab->slots[i].type = FLOW_ID_TYPE_FREE;
+		slab->slots[i].next = i + 1 < FLOW_ID_SLAB_SIZE ? (idx << FLOW_ID_SLAB_SHIFT) + i + 1 : FLOW_ID_NONE;
+	}
+	slab->free_head = idx << FLOW_ID_SLAB_SHIFT;
+	slab->nb_used = 0;
+
+	registry->slabs[idx] = slab;
+	registry->nb_allocated_slabs++;
+	registry->nb_free += FLOW_ID_SLAB_SIZE;
+	set_has_free(registry, idx, true);
+	*slab_idx = idx;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Find the first slab with free slots, filling the lowest slabs first keeps the live objects packed so the slabs at
+ * the end empty out and get released
+ *
+ * @registry [in]: Registry
+ * @slab_idx [out]: Index of the slab
+ * @return: true if such a slab exists
+ */
+static bool
+find_free_slab(const struct flow_id_registry *registry, uint32_t *slab_idx)
+{
+	uint32_t word;
+
+	for (word = 0; word < registry->nb_slabs / MAP_WORD_BITS; word++) {
+		if (registry->free_map[word] != 0) {
+			*slab_idx = word * MAP_WORD_BITS + __builtin_ctzll(registry->free_map[word]);
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Add a slot to the front of the children list of its parent
+ *
+ * @registry [in]: Registry
+ * @parent [in]: Index of the parent slot
+ * @index [in]: Index of the child slot
+ */
+static void
+link_child(struct flow_id_registry *registry, uint32_t parent, uint32_t index)
+{
+	struct flow_id_slot *parent_slot = get_slot(registry, parent), *slot = get_slot(registry, index);
+
+	slot->parent = parent;
+	slot->prev = FLOW_ID_NONE;
+	slot->next = parent_slot->first_child;
+	if (slot->next != FLOW_ID_NONE)
+		get_slot(registry, slot->next)->prev = index;
+	parent_slot->first_child = index;
+}
+
+/*
+ * Remove a slot from the children list of its parent
+ *
+ * @registry [in]: Registry
+ * @index [in]: Index of the slot
+ */
+static void
+unlink_child(struct flow_id_registry *registry, uint32_t index)
+{
+	struct flow_id_slot *slot = get_slot(registry, index);
+
+	if (slot->parent == FLOW_ID_NONE)
+		return;
+	if (slot->prev != FLOW_ID_NONE)
+		get_slot(registry, slot->prev)->next = slot->next;
+	else
+		get_slot(registry, slot->parent)->first_child = slot->next;
+	if (slot->next != FLOW_ID_NONE)
+		get_slot(registry, slot->next)->prev = slot->prev;
+}
+
+/*
+ * Return a slot to the free list of its slab. The slab is released once empty if the other slabs have at least half
+ * a slab of free slots, so a workload that keeps adding and removing a single object does not allocate and release the
+ * same slab over and over.
+ *
+ * @registry [in]: Registry
+ * @index [in]: Index of the slot
+ */
+static void
+release_slot(struct flow_id_registry *registry, uint32_t index)
+{
+	uint32_t slab_idx = SLAB_OF(index);
+	struct flow_id_slab *slab = registry->slabs[slab_idx];
+	struct flow_id_slot *slot = &slab->slots[SLOT_OF(index)];
+
+	slot->object = NULL;
+	slot->type = FLOW_ID_TYPE_FREE;
+	slot->generation++;
+	if (slot->generation == 0)
+		slot->generation = 1;
+	if (slot->generation > registry->max_generation)
+		registry->max_generation = slot->generation;
+
+	slot->next = slab->free_head;
+	slab->free_head = index;
+	slab->nb_used--;
+	registry->nb_used--;
+	registry->nb_free++;
+	set_has_free(registry, slab_idx, true);
+
+	if (slab->nb_used == 0 && registry->nb_free - FLOW_ID_SLAB_SIZE >= FLOW_ID_SLAB_SIZE / 2) {
+		set_has_free(registry, slab_idx, false);
+		registry->slabs[slab_idx] = NULL;
+		registry->nb_allocated_slabs--;
+		registry->nb_free -= FLOW_ID_SLAB_SIZE;
+		free(slab);
+	}
+}
+
+void
+flow_id_registry_init(struct flow_id_registry *registry)
+{
+	memset(registry, 0, sizeof(*registry));
+}
+
+void
+flow_id_registry_destroy(struct flow_id_registry *registry)
+{
+	uint32_t i;
+
+	for (i = 0; i < registry->nb_slabs; i++)
+		free(registry->slabs[i]);
+	free(registry->slabs);
+	free(registry->free_map);
+	memset(registry, 0, sizeof(*registry));
+}
+
+doca_error_t
+flow_id_alloc(struct flow_id_registry *registry, enum flow_id_type type, void *object, uint64_t parent,
+	      uint64_t *handle)
+{
+	struct flow_id_slab *slab;
+	struct flow_id_slot *slot;
+	uint32_t slab_idx, index, parent_index = FLOW_ID_NONE;
+	enum flow_id_type parent_type;
+	doca_error_t result;
+
+	if (type == FLOW_ID_TYPE_PIPE || type == FLOW_ID_TYPE_ENTRY) {
+		parent_type = type == FLOW_ID_TYPE_PIPE ? FLOW_ID_TYPE_PORT : FLOW_ID_TYPE_PIPE;
+		if (find_slot(registry, parent, parent_type) == NULL)
+			return DOCA_ERROR_NOT_FOUND;
+		parent_index = HANDLE_INDEX(parent);
+	} else if (type != FLOW_ID_TYPE_PORT) {
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (!find_free_slab(registry, &slab_idx)) {
+		result = add_slab(registry, &slab_idx);
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+
+	slab = registry->slabs[slab_idx];
+	index = slab->free_head;
+	slot = &slab->slots[SLOT_OF(index)];
+	slab->free_head = slot->next;
+	slab->nb_used++;
+	registry->nb_used++;
+	registry->nb_free--;
+	if (slab->free_head == FLOW_ID_NONE)
+		set_has_free(registry, slab_idx, false);
+
+	slot->object = object;
+	slot->type = type;
+	slot->first_child = FLOW_ID_NONE;
+	slot->parent = FLOW_ID_NONE;
+	slot->prev = FLOW_ID_NONE;
+	slot->next = FLOW_ID_NONE;
+	if (parent_index != FLOW_ID_NONE)
+		link_child(registry, parent_index, index);
+
+	*handle = ((uint64_t)slot->generation << 32) | index;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+flow_id_lookup(const struct flow_id_registry *registry, uint64_t handle, enum flow_id_type type, void **object)
+{
+	struct flow_id_slot *slot = find_slot(registry, handle, type);
+
+	if (slot == NULL)
+		return DOCA_ERROR_NOT_FOUND;
+	*object = slot->object;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+flow_id_free(struct flow_id_registry *registry, uint64_t handle, enum flow_id_type type, uint64_t *nb_freed)
+{
+	uint32_t root = HANDLE_INDEX(handle), index, parent;
+	uint64_t count = 0;
+
+	if (find_slot(registry, handle, type) == NULL)
+		return DOCA_ERROR_NOT_FOUND;
+
+	/* Free the subtree leaf by leaf: go down first children to a leaf, free it and go back to its parent */
+	index = root;
+	while (true) {
+		while (get_slot(registry, index)->first_child != FLOW_ID_NONE)
+			index = get_slot(registry, index)->first_child;
+		parent = get_slot(registry, index)->parent;
+		unlink_child(registry, index);
+		release_slot(registry, index);
+		count++;
+		if (index == root)
+			break;
+		index = parent;
+	}
+
+	if (nb_freed != NULL)
+		*nb_freed = count;
+	return DOCA_SUCCESS;
+}
+
+uint64_t
+flow_id_registry_memory(const struct flow_id_registry *registry)
+{
+	return (uint64_t)registry->nb_allocated_slabs * sizeof(struct flow_id_slab) +
+	       (uint64_t)registry->nb_slabs * sizeof(struct flow_id_slab *) +
+	       (uint64_t)registry->nb_slabs / MAP_WORD_BITS * sizeof(uint64_t);
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef COMMON_FLOW_ID_REGISTRY_H_
+#define COMMON_FLOW_ID_REGISTRY_H_
+
+#include <stdint.h>
+
+#include <doca_error.h>
+
+/*
+ * Registry of the IDs of DOCA Flow ports, pipes and entries. Every object gets a slot in a slab of slots and a 64-bit
+ * handle made of the slot index (low 32 bits) and the generation of the slot (high 32 bits). The generation of a slot
+ * changes when the slot is freed, so the handle of a freed object is never valid again, even when its slot is reused.
+ * The objects form a tree: an entry belongs to a pipe and a pipe belongs to a port, freeing an object frees everything
+ * under it. Slabs are allocated on demand and released once empty, so the memory use follows the live objects.
+ */
+
+#define FLOW_ID_SLAB_SHIFT 12				/* log2 of the number of slots in a slab */
+#define FLOW_ID_SLAB_SIZE (1U << FLOW_ID_SLAB_SHIFT)	/* Number of slots in a slab */
+#define FLOW_ID_MAX_SLABS (1U << (32 - FLOW_ID_SLAB_SHIFT)) /* Slabs addressable by a 32-bit slot index */
+#define FLOW_ID_NONE UINT32_MAX				/* Invalid slot index, ends the slot lists */
+
+enum flow_id_type {
+	FLOW_ID_TYPE_FREE,  /* The slot is free */
+	FLOW_ID_TYPE_PORT,  /* The slot holds a port, the root of its pipes */
+	FLOW_ID_TYPE_PIPE,  /* The slot holds a pipe, its parent is a port */
+	FLOW_ID_TYPE_ENTRY, /* The slot holds an entry, its parent is a pipe */
+};
+
+struct flow_id_slot {
+	void *object;	      /* DOCA Flow object of the slot */
+	uint32_t generation;  /* Generation of the handle of the object, never 0 */
+	uint32_t type;	      /* enum flow_id_type */
+	uint32_t parent;      /* Slot of the parent object, FLOW_ID_NONE for a port */
+	uint32_t first_child; /* First slot of the children list */
+	uint32_t prev;	      /* Previous slot in the children list of the parent */
+	uint32_t next;	      /* Next slot in the children list of the parent, or in the free list of the slab */
+};
+
+struct flow_id_slab {
+	uint32_t free_head;			      /* First free slot, FLOW_ID_NONE if the slab is full */
+	uint32_t nb_used;			      /* Number of used slots */
+	struct flow_id_slot slots[FLOW_ID_SLAB_SIZE]; /* Slots of the slab */
+};
+
+struct flow_id_registry {
+	struct flow_id_slab **slabs; /* Slabs by index, NULL for a slab that was not allocated or was released */
+	uint64_t *free_map;	     /* Bit per slab, set if the slab is allocated and has free slots */
+	uint32_t nb_slabs;	     /* Size of the slabs array */
+	uint32_t nb_allocated_slabs; /* Number of allocated slabs */
+	uint64_t nb_free;	     /* Number of free slots in the allocated slabs */
+	uint64_t nb_used;	     /* Number of used slots */
+	uint32_t max_generation;     /* Largest generation of a freed slot, slots of a new slab start above it */
+};
+
+/*
+ * Initialize an empty registry
+ *
+ * @registry [out]: Registry to initialize
+ */
+void flow_id_registry_init(struct flow_id_registry *registry);
+
+/*
+ * Free all the slabs of a registry, the handles of the registry are no longer valid
+ *
+ * @registry [in]: Registry to destroy
+ */
+void flow_id_registry_destroy(struct flow_id_registry *registry);
+
+/*
+ * Allocate a slot for an object
+ *
+ * @registry [in]: Registry
+ * @type [in]: Type of the object, FLOW_ID_TYPE_PORT, FLOW_ID_TYPE_PIPE or FLOW_ID_TYPE_ENTRY
+ * @object [in]: Object to keep in the slot
+ * @parent [in]: Handle of the parent object, ignored for a port
+ * @handle [out]: Handle of the object
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t flow_id_alloc(struct flow_id_registry *registry, enum flow_id_type type, void *object, uint64_t parent,
+			   uint64_t *handle);
+
+/*
+ * Find the object of a handle
+ *
+ * @registry [in]: Registry
+ * @handle [in]: Handle of the object
+ * @type [in]: Expected type of the object
+ * @object [out]: The object
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_NOT_FOUND if the handle is not a live object of that type
+ */
+doca_error_t flow_id_lookup(const struct flow_id_registry *registry, uint64_t handle, enum flow_id_type type,
+			    void **object);
+
+/*
+ * Free an object and all the objects under it
+ *
+ * @registry [in]: Registry
+ * @handle [in]: Handle of the object
+ * @type [in]: Expected type of the object
+ * @nb_freed [out]: Number of freed objects, may be NULL
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_NOT_FOUND if the handle is not a live object of that type
+ */
+doca_error_t flow_id_free(struct flow_id_registry *registry, uint64_t handle, enum flow_id_type type,
+			  uint64_t *nb_freed);
+
+/*
+ * Get the memory used by the slabs of a registry
+ *
+ * @registry [in]: Registry
+ * @return: Size of the allocated slabs (bytes)
+ */
+uint64_t flow_id_registry_memory(const struct flow_id_registry *registry);
+
+#endif /* COMMON_FLOW_ID_REGISTRY_H_ */
@@ -48,6 +48,9 @@ DOCA_LOG_REGISTER(FLOW_PARSER);
 #define TYPE_STR_LEN 5					/* Type enable string size */
 #define HEXADECIMAL_BASE 1				/* Hex base */
 #define UINT32_CHANGEABLE_FIELD "0xffffffff"		/* DOCA flow masking for 32 bits value */
+#define RULES_FILE_MAGIC "DFPR"				/* Magic of a compiled rules file */
+#define RULES_FILE_MAGIC_LEN 4				/* Magic length, without the NULL terminator */
+#define RULES_FILE_VERSION 1				/* Version of the compiled rules file format */
 
 #define BE_IPV4_ADDR(a, b, c, d) (RTE_BE32((a << 24) + (b << 16) + (c << 8) + d))	/* Big endian conversion */
 
@@ -71,7 +74,7 @@ static void (*create_pipe_func)(struct doca_flow_pipe_cfg *, uint16_t, struct do
 static void (*add_entry_func)(uint16_t, uint64_t, struct doca_flow_match *, struct doca_flow_actions *,
 			      struct doca_flow_monitor *, struct doca_flow_fwd *, uint64_t,
 			      uint32_t);				/* Callback for add entry command */
-static void (*add_fw_entry_func)(uint16_t, struct doca_flow_match *);	/* Callback for FW add entry command */
+static void (*add_fw_entry_func)(uint16_t, struct doca_flow_match *, uint32_t);	/* Callback for FW add entry command */
 static void (*add_control_pipe_entry_func)(uint16_t, uint8_t, uint64_t, struct doca_flow_match *,
 					   struct doca_flow_match *, struct doca_flow_fwd *,
 					   uint64_t);			/* Callback for add control pipe entry command */
@@ -174,7 +177,7 @@ set_pipe_add_entry(void (*action)(uint16_t, uint64_t, struct doca_flow_match *,
 }
 
 void
-set_pipe_fw_add_entry(void (*action)(uint16_t, struct doca_flow_match *))
+set_pipe_fw_add_entry(void (*action)(uint16_t, struct doca_flow_match *, uint32_t))
 {
 	add_fw_entry_func = action;
 }
@@ -1049,40 +1052,40 @@ static doca_error_t
 parse_struct(char *struct_str, doca_error_t (*fill_struct)(char *, char *, void *), void *struct_ptr)
 {
 	doca_error_t result;
-	char ptr[MAX_CMDLINE_INPUT_LEN];
-	char *tmp;
 	char field_name[MAX_FIELD_INPUT_LEN];
 	char value[MAX_FIELD_INPUT_LEN];
-	char tmp_char;
+	size_t len;
 
-	do {
-		strlcpy(ptr, struct_str, MAX_CMDLINE_INPUT_LEN);
-		tmp = strtok(ptr, "=");
-		if (tmp == NULL) {
+	/* Single pass over the fields: every name and value is copied once, straight from the input */
+	while (true) {
+		len = strcspn(struct_str, "=,");
+		if (len == 0 || struct_str[len] != '=' || len >= MAX_FIELD_INPUT_LEN) {
 			DOCA_LOG_ERR("Invalid format for create struct command");
 			return DOCA_ERROR_INVALID_VALUE;
 		}
-		strlcpy(field_name, tmp, MAX_FIELD_INPUT_LEN);
-		struct_str += strlen(field_name) + 1;
+		memcpy(field_name, struct_str, len);
+		field_name[len] = '\0';
+		struct_str += len + 1;
 
-		strlcpy(ptr, struct_str, MAX_CMDLINE_INPUT_LEN);
-		tmp = strtok(ptr, ",");
-		if (tmp == NULL) {
+		len = strcspn(struct_str, ",");
+		if (len == 0 || len >= MAX_FIELD_INPUT_LEN) {
 			DOCA_LOG_ERR("Invalid format for create struct command");
 			return DOCA_ERROR_INVALID_VALUE;
 		}
-		strlcpy(value, tmp, MAX_FIELD_INPUT_LEN);
+		memcpy(value, struct_str, len);
+		value[len] = '\0';
+		struct_str += len;
 
 		DOCA_LOG_DBG("The parsing result are field_name: %s,  value: %s", field_name, value);
 
-		struct_str += strlen(value);
-		tmp_char = struct_str[0];
-		struct_str++;
 		result = (*fill_struct)(field_name, value, struct_ptr);
 		if (result != DOCA_SUCCESS)
 			return result;
 
-	} while (tmp_char == ',');
+		if (struct_str[0] != ',')
+			break;
+		struct_str++;
+	}
 
 	return DOCA_SUCCESS;
 }
@@ -1255,13 +1258,11 @@ parse_add_entry_params(char *params_str, bool *fwd_action, bool *monitor_action,
 	do {
 		if (strncmp(params_str, "pipe_id=", PIPE_ID_STR_LEN) == 0) {
 			params_str += PIPE_ID_STR_LEN;
-			strlcpy(ptr, params_str, MAX_CMDLINE_INPUT_LEN);
-			*pipe_id = strtoull(ptr, &params_str, 0);
+			*pipe_id = strtoull(params_str, &params_str, 0);
 			has_pipe_id = true;
 		} else if (strncmp(params_str, "pipe_queue=", PIPE_QUEUE_STR_LEN) == 0) {
 			params_str += PIPE_QUEUE_STR_LEN;
-			strlcpy(ptr, params_str, MAX_CMDLINE_INPUT_LEN);
-			*pipe_queue = strtol(ptr, &params_str, 0);
+			*pipe_queue = strtol(params_str, &params_str, 0);
 			has_pipe_queue = true;
 		} else if (strncmp(params_str, "monitor=", MONITOR_STR_LEN) == 0) {
 			result = parse_bool_params_input(&params_str, MONITOR_STR_LEN, monitor_action);
@@ -1314,8 +1315,7 @@ parse_fw_add_entry_params(char *params_str, uint16_t *port_id)
 
 	if (strncmp(params_str, "port_id=", PORT_ID_STR_LEN) == 0) {
 		params_str += PORT_ID_STR_LEN;
-		strlcpy(ptr, params_str, MAX_CMDLINE_INPUT_LEN);
-		*port_id = strtoull(ptr, &params_str, 0);
+		*port_id = strtoull(params_str, &params_str, 0);
 		has_port_id = true;
 	}  else {
 		strlcpy(ptr, params_str, MAX_CMDLINE_INPUT_LEN);
@@ -1563,14 +1563,14 @@ parse_dump_pipe_params(char *params, uint16_t *port_id, FILE **file)
 }
 
 /*
- * Parse create pipe command and call command's callback
+ * Create a pipe
  *
- * @parsed_result [in]: Command line interface input with user input
+ * @params [in]: Command parameters
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-static void
-cmd_create_pipe_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+static doca_error_t
+create_pipe_command(char *params)
 {
-	struct cmd_create_pipe_result *create_pipe_data = (struct cmd_create_pipe_result *)parsed_result;
 	struct doca_flow_fwd *tmp_fwd = NULL;
 	struct doca_flow_fwd *tmp_fwd_miss = NULL;
 	struct doca_flow_pipe_cfg pipe_cfg;
@@ -1583,12 +1583,12 @@ cmd_create_pipe_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __r
 
 	if (create_pipe_func == NULL) {
 		DOCA_LOG_ERR("Pipe creation action was not inserted");
-		return;
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 
-	result = parse_create_pipe_params(create_pipe_data->params, &pipe_cfg, &is_fwd, &is_fwd_miss);
+	result = parse_create_pipe_params(params, &pipe_cfg, &is_fwd, &is_fwd_miss);
 	if (result != DOCA_SUCCESS)
-		return;
+		return result;
 	if (pipe_cfg.attr.type != DOCA_FLOW_PIPE_CONTROL) {
 		actions_arr[0] = &actions;
 		pipe_cfg.actions = actions_arr;
@@ -1602,6 +1602,22 @@ cmd_create_pipe_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __r
 		tmp_fwd_miss = &fwd_miss;
 
 	(*create_pipe_func)(&pipe_cfg, pipe_port_id, tmp_fwd, fwd_next_pipe_id, tmp_fwd_miss, fwd_miss_next_pipe_id);
+	free((void *)pipe_cfg.attr.name);
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Parse create pipe command and call command's callback
+ *
+ * @parsed_result [in]: Command line interface input with user input
+ */
+static void
+cmd_create_pipe_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+{
+	struct cmd_create_pipe_result *create_pipe_data = (struct cmd_create_pipe_result *)parsed_result;
+
+	create_pipe_command(create_pipe_data->params);
 }
 
 /* Define the token of create */
@@ -1630,14 +1646,15 @@ static cmdline_parse_inst_t cmd_create_pipe = {
 };
 
 /*
- * Parse add entry command and call command's callback
+ * Add an entry
  *
- * @parsed_result [in]: Command line interface input with user input
+ * @params [in]: Command parameters
+ * @flags [in]: DOCA Flow flags of the entry
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-static void
-cmd_add_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+static doca_error_t
+add_entry_command(char *params, uint32_t flags)
 {
-	struct cmd_add_entry_result *add_entry_data = (struct cmd_add_entry_result *)parsed_result;
 	struct doca_flow_fwd *tmp_fwd = NULL;
 	struct doca_flow_monitor *tmp_monitor = NULL;
 	bool is_fwd = false;
@@ -1648,12 +1665,12 @@ cmd_add_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte
 
 	if (add_entry_func == NULL) {
 		DOCA_LOG_ERR("Entry creation action was not inserted");
-		return;
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 
-	result = parse_add_entry_params(add_entry_data->params, &is_fwd, &is_monitor, &pipe_id, &pipe_queue);
+	result = parse_add_entry_params(params, &is_fwd, &is_monitor, &pipe_id, &pipe_queue);
 	if (result != DOCA_SUCCESS)
-		return;
+		return result;
 
 	if (is_fwd)
 		tmp_fwd = &fwd;
@@ -1662,31 +1679,62 @@ cmd_add_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte
 		tmp_monitor = &monitor;
 
 	(*add_entry_func)(pipe_queue, pipe_id, &entry_match, &actions, tmp_monitor, tmp_fwd, fwd_next_pipe_id,
-			  DOCA_FLOW_NO_WAIT);
+			  flags);
+
+	return DOCA_SUCCESS;
 }
 
 /*
- * Parse FW add entry command and call command's callback
+ * Parse add entry command and call command's callback
  *
  * @parsed_result [in]: Command line interface input with user input
  */
 static void
-cmd_fw_add_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+cmd_add_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
 {
 	struct cmd_add_entry_result *add_entry_data = (struct cmd_add_entry_result *)parsed_result;
+
+	add_entry_command(add_entry_data->params, DOCA_FLOW_NO_WAIT);
+}
+
+/*
+ * Add a FW entry
+ *
+ * @params [in]: Command parameters
+ * @flags [in]: DOCA Flow flags of the entry
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+fw_add_entry_command(char *params, uint32_t flags)
+{
 	uint16_t port_id = 0;
 	doca_error_t result;
 
 	if (add_fw_entry_func == NULL) {
 		DOCA_LOG_ERR("Entry creation action was not inserted");
-		return;
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 
-	result = parse_fw_add_entry_params(add_entry_data->params, &port_id);
+	result = parse_fw_add_entry_params(params, &port_id);
 	if (result != DOCA_SUCCESS)
-		return;
+		return result;
+
+	(*add_fw_entry_func)(port_id, &entry_match, flags);
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Parse FW add entry command and call command's callback
+ *
+ * @parsed_result [in]: Command line interface input with user input
+ */
+static void
+cmd_fw_add_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+{
+	struct cmd_add_entry_result *add_entry_data = (struct cmd_add_entry_result *)parsed_result;
 
-	(*add_fw_entry_func)(port_id, &entry_match);
+	fw_add_entry_command(add_entry_data->params, DOCA_FLOW_NO_WAIT);
 }
 
 /* Define the token of add */
@@ -1727,15 +1775,14 @@ static cmdline_parse_inst_t cmd_fw_add_entry = {
 };
 
 /*
- * Parse add control pipe entry command and call command's callback
+ * Add a control pipe entry
  *
- * @parsed_result [in]: Command line interface input with user input
+ * @params [in]: Command parameters
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-static void
-cmd_add_control_pipe_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+static doca_error_t
+add_control_pipe_entry_command(char *params)
 {
-	struct cmd_add_control_pipe_entry_result *add_entry_data =
-		(struct cmd_add_control_pipe_entry_result *)parsed_result;
 	struct doca_flow_fwd *tmp_fwd = NULL;
 	struct doca_flow_match *tmp_match_mask = NULL;
 	bool is_fwd = false;
@@ -1747,13 +1794,13 @@ cmd_add_control_pipe_entry_parsed(void *parsed_result, __rte_unused struct cmdli
 
 	if (add_control_pipe_entry_func == NULL) {
 		DOCA_LOG_ERR("Control pipe entry creation action was not inserted");
-		return;
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 
-	result = parse_add_control_pipe_entry_params(add_entry_data->params, &is_fwd, &is_match_mask, &pipe_id,
+	result = parse_add_control_pipe_entry_params(params, &is_fwd, &is_match_mask, &pipe_id,
 						  &pipe_queue, &priority);
 	if (result != DOCA_SUCCESS)
-		return;
+		return result;
 
 	if (is_fwd)
 		tmp_fwd = &fwd;
@@ -1762,6 +1809,21 @@ cmd_add_control_pipe_entry_parsed(void *parsed_result, __rte_unused struct cmdli
 
 	(*add_control_pipe_entry_func)(pipe_queue, priority, pipe_id, &entry_match, tmp_match_mask, tmp_fwd,
 				       fwd_next_pipe_id);
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Parse add control pipe entry command and call command's callback
+ *
+ * @parsed_result [in]: Command line interface input with user input
+ */
+static void
+cmd_add_control_pipe_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+{
+	struct cmd_add_control_pipe_entry_result *add_entry_data = (struct cmd_add_control_pipe_entry_result *)parsed_result;
+
+	add_control_pipe_entry_command(add_entry_data->params);
 }
 
 /* Define the token of add */
@@ -1796,27 +1858,42 @@ static cmdline_parse_inst_t cmd_add_control_pipe_entry = {
 };
 
 /*
- * Parse destroy pipe command and call command's callback
+ * Destroy a pipe
  *
- * @parsed_result [in]: Command line interface input with user input
+ * @params [in]: Command parameters
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-static void
-cmd_destroy_pipe_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+static doca_error_t
+destroy_pipe_command(char *params)
 {
-	struct cmd_destroy_pipe_result *destroy_pipe_data = (struct cmd_destroy_pipe_result *)parsed_result;
 	uint64_t pipe_id;
 	doca_error_t result;
 
 	if (destroy_pipe_func == NULL) {
 		DOCA_LOG_ERR("Pipe destruction action was not inserted");
-		return;
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 
-	result = parse_pipe_id_input(destroy_pipe_data->params, &pipe_id);
+	result = parse_pipe_id_input(params, &pipe_id);
 	if (result != DOCA_SUCCESS)
-		return;
+		return result;
 
 	(*destroy_pipe_func)(pipe_id);
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Parse destroy pipe command and call command's callback
+ *
+ * @parsed_result [in]: Command line interface input with user input
+ */
+static void
+cmd_destroy_pipe_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+{
+	struct cmd_destroy_pipe_result *destroy_pipe_data = (struct cmd_destroy_pipe_result *)parsed_result;
+
+	destroy_pipe_command(destroy_pipe_data->params);
 }
 
 /* Define the token of destroy */
@@ -1845,52 +1922,82 @@ static cmdline_parse_inst_t cmd_destroy_pipe = {
 };
 
 /*
- * Parse remove entry command and call command's callback
+ * Remove an entry
  *
- * @parsed_result [in]: Command line interface input with user input
+ * @params [in]: Command parameters
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-static void
-cmd_rm_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+static doca_error_t
+rm_entry_command(char *params)
 {
-	struct cmd_rm_entry_result *rm_entry_data = (struct cmd_rm_entry_result *)parsed_result;
 	uint64_t entry_id = 0;
 	uint16_t pipe_queue = 0;
 	doca_error_t result;
 
 	if (remove_entry_func == NULL) {
 		DOCA_LOG_ERR("Entry destruction action was not inserted");
-		return;
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 
-	result = parse_entry_params(rm_entry_data->params, true, &pipe_queue, &entry_id);
+	result = parse_entry_params(params, true, &pipe_queue, &entry_id);
 	if (result != DOCA_SUCCESS)
-		return;
+		return result;
 
 	(*remove_entry_func)(pipe_queue, entry_id, DOCA_FLOW_NO_WAIT);
+
+	return DOCA_SUCCESS;
 }
 
 /*
- * Parse FW remove entry command and call command's callback
+ * Parse remove entry command and call command's callback
  *
  * @parsed_result [in]: Command line interface input with user input
  */
 static void
-cmd_fw_rm_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+cmd_rm_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
 {
 	struct cmd_rm_entry_result *rm_entry_data = (struct cmd_rm_entry_result *)parsed_result;
+
+	rm_entry_command(rm_entry_data->params);
+}
+
+/*
+ * Remove a FW entry
+ *
+ * @params [in]: Command parameters
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+fw_rm_entry_command(char *params)
+{
 	uint64_t entry_id = 0;
 	doca_error_t result;
 
 	if (remove_fw_entry_func == NULL) {
 		DOCA_LOG_ERR("Entry destruction action was not inserted");
-		return;
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 
-	result = parse_fw_entry_params(rm_entry_data->params, &entry_id);
+	result = parse_fw_entry_params(params, &entry_id);
 	if (result != DOCA_SUCCESS)
-		return;
+		return result;
 
 	(*remove_fw_entry_func)(entry_id);
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Parse FW remove entry command and call command's callback
+ *
+ * @parsed_result [in]: Command line interface input with user input
+ */
+static void
+cmd_fw_rm_entry_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+{
+	struct cmd_rm_entry_result *rm_entry_data = (struct cmd_rm_entry_result *)parsed_result;
+
+	fw_rm_entry_command(rm_entry_data->params);
 }
 
 /* Define the token of remove */
@@ -1931,27 +2038,42 @@ static cmdline_parse_inst_t cmd_fw_rm_entry = {
 };
 
 /*
- * Parse flush pipes command and call command's callback
+ * Flush the pipes of a port
  *
- * @parsed_result [in]: Command line interface input with user input
+ * @params [in]: Command parameters
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-static void
-cmd_flush_pipes_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+static doca_error_t
+flush_pipes_command(char *params)
 {
-	struct cmd_flush_pipes_result *flush_pipes_data = (struct cmd_flush_pipes_result *)parsed_result;
 	int port_id;
 	doca_error_t result;
 
 	if (port_pipes_flush_func == NULL) {
 		DOCA_LOG_ERR("Pipes flushing action was not inserted");
-		return;
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 
-	result = parse_port_id_input(flush_pipes_data->port_id, &port_id);
+	result = parse_port_id_input(params, &port_id);
 	if (result != DOCA_SUCCESS)
-		return;
+		return result;
 
 	(*port_pipes_flush_func)(port_id);
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Parse flush pipes command and call command's callback
+ *
+ * @parsed_result [in]: Command line interface input with user input
+ */
+static void
+cmd_flush_pipes_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+{
+	struct cmd_flush_pipes_result *flush_pipes_data = (struct cmd_flush_pipes_result *)parsed_result;
+
+	flush_pipes_command(flush_pipes_data->port_id);
 }
 
 /* Define the token of port */
@@ -1985,31 +2107,46 @@ static cmdline_parse_inst_t cmd_flush_pipe = {
 };
 
 /*
- * Parse query command and call command's callback
+ * Query an entry
  *
- * @parsed_result [in]: Command line interface input with user input
+ * @params [in]: Command parameters
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-static void
-cmd_query_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+static doca_error_t
+query_command(char *params)
 {
-	struct cmd_query_result *query_data = (struct cmd_query_result *)parsed_result;
 	struct doca_flow_query query_stats;
 	uint64_t entry_id = 0;
 	doca_error_t result;
 
 	if (query_func == NULL) {
 		DOCA_LOG_ERR("Query action was not inserted");
-		return;
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 
-	result = parse_entry_params(query_data->params, false, NULL, &entry_id);
+	result = parse_entry_params(params, false, NULL, &entry_id);
 	if (result != DOCA_SUCCESS)
-		return;
+		return result;
 
 	(*query_func)(entry_id, &query_stats);
 
 	DOCA_LOG_INFO("Total bytes: %ld", query_stats.total_bytes);
 	DOCA_LOG_INFO("Total packets: %ld", query_stats.total_pkts);
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Parse query command and call command's callback
+ *
+ * @parsed_result [in]: Command line interface input with user input
+ */
+static void
+cmd_query_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+{
+	struct cmd_query_result *query_data = (struct cmd_query_result *)parsed_result;
+
+	query_command(query_data->params);
 }
 
 /* Define the token of query */
@@ -2031,33 +2168,48 @@ static cmdline_parse_inst_t cmd_query = {
 };
 
 /*
- * Parse dump pipe command and call command's callback
+ * Dump the pipes of a port
  *
- * @parsed_result [in]: Command line interface input with user input
+ * @params [in]: Command parameters
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-static void
-cmd_dump_pipe_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+static doca_error_t
+dump_pipe_command(char *params)
 {
-	struct cmd_dump_pipe_result *dump_pipe_data = (struct cmd_dump_pipe_result *)parsed_result;
 	uint16_t port_id = 0;
 	FILE *fd = NULL;
 	doca_error_t result;
 
 	if (port_pipes_dump_func == NULL) {
 		DOCA_LOG_ERR("Pipe dumping action was not inserted");
-		return;
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 
-	result = parse_dump_pipe_params(dump_pipe_data->params, &port_id, &fd);
+	result = parse_dump_pipe_params(params, &port_id, &fd);
 	if (result != DOCA_SUCCESS) {
 		if (fd)
 			fclose(fd);
-		return;
+		return result;
 	}
 
 	(*port_pipes_dump_func)(port_id, fd);
 
 	fclose(fd);
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Parse dump pipe command and call command's callback
+ *
+ * @parsed_result [in]: Command line interface input with user input
+ */
+static void
+cmd_dump_pipe_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+{
+	struct cmd_dump_pipe_result *dump_pipe_data = (struct cmd_dump_pipe_result *)parsed_result;
+
+	dump_pipe_command(dump_pipe_data->params);
 }
 
 /* Define the token of port */
@@ -2090,6 +2242,68 @@ static cmdline_parse_inst_t cmd_dump_pipe = {
 		},
 };
 
+/*
+ * Fill one of the DOCA Flow structures of the parser
+ *
+ * @flow_struct [in]: Name of the structure
+ * @fields [in]: Fields to set
+ * @reset [in]: Reset the structure first, otherwise only the given fields are overridden
+ * @fw_subset [in]: Only the entry match of the FW subset can be filled
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+struct_command(const char *flow_struct, char *fields, bool reset, bool fw_subset)
+{
+	doca_error_t (*fill_struct)(char *, char *, void *);
+	void *struct_ptr;
+	size_t struct_size;
+
+	if (fw_subset) {
+		if (strcmp(flow_struct, "entry_match") != 0) {
+			DOCA_LOG_ERR("The %s is not a valid structure for the FW", flow_struct);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		fill_struct = &parse_fw_match_field;
+		struct_ptr = &entry_match;
+		struct_size = sizeof(entry_match);
+	} else if (strcmp(flow_struct, "pipe_match") == 0) {
+		fill_struct = &parse_match_field;
+		struct_ptr = &pipe_match;
+		struct_size = sizeof(pipe_match);
+	} else if (strcmp(flow_struct, "entry_match") == 0) {
+		fill_struct = &parse_match_field;
+		struct_ptr = &entry_match;
+		struct_size = sizeof(entry_match);
+	} else if (strcmp(flow_struct, "match_mask") == 0) {
+		fill_struct = &parse_match_field;
+		struct_ptr = &match_mask;
+		struct_size = sizeof(match_mask);
+	} else if (strcmp(flow_struct, "actions") == 0) {
+		fill_struct = &parse_actions_field;
+		struct_ptr = &actions;
+		struct_size = sizeof(actions);
+	} else if (strcmp(flow_struct, "monitor") == 0) {
+		fill_struct = &parse_monitor_field;
+		struct_ptr = &monitor;
+		struct_size = sizeof(monitor);
+	} else if (strcmp(flow_struct, "fwd") == 0) {
+		fill_struct = &parse_fwd_field;
+		struct_ptr = &fwd;
+		struct_size = sizeof(fwd);
+	} else if (strcmp(flow_struct, "fwd_miss") == 0) {
+		fill_struct = &parse_fwd_miss_field;
+		struct_ptr = &fwd_miss;
+		struct_size = sizeof(fwd_miss);
+	} else {
+		DOCA_LOG_ERR("The %s is not a valid structure", flow_struct);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (reset)
+		memset(struct_ptr, 0, struct_size);
+	return parse_struct(fields, fill_struct, struct_ptr);
+}
+
 /*
  * Parse create DOCA Flow struct command
  *
@@ -2100,28 +2314,20 @@ cmd_create_struct_parsed(void *parsed_result, __rte_unused struct cmdline *cl, _
 {
 	struct cmd_create_struct_result *struct_data = (struct cmd_create_struct_result *)parsed_result;
 
-	if (strcmp(struct_data->flow_struct, "pipe_match") == 0) {
-		memset(&pipe_match, 0, sizeof(pipe_match));
-		parse_struct(struct_data->flow_struct_input, &parse_match_field, (void *)&pipe_match);
-	} else if (strcmp(struct_data->flow_struct, "entry_match") == 0) {
-		memset(&entry_match, 0, sizeof(entry_match));
-		parse_struct(struct_data->flow_struct_input, &parse_match_field, (void *)&entry_match);
-	} else if (strcmp(struct_data->flow_struct, "match_mask") == 0) {
-		memset(&match_mask, 0, sizeof(match_mask));
-		parse_struct(struct_data->flow_struct_input, &parse_match_field, (void *)&match_mask);
-	} else if (strcmp(struct_data->flow_struct, "actions") == 0) {
-		memset(&actions, 0, sizeof(actions));
-		parse_struct(struct_data->flow_struct_input, &parse_actions_field, (void *)&actions);
-	} else if (strcmp(struct_data->flow_struct, "monitor") == 0) {
-		memset(&monitor, 0, sizeof(monitor));
-		parse_struct(struct_data->flow_struct_input, &parse_monitor_field, (void *)&monitor);
-	} else if (strcmp(struct_data->flow_struct, "fwd") == 0) {
-		memset(&fwd, 0, sizeof(fwd));
-		parse_struct(struct_data->flow_struct_input, &parse_fwd_field, (void *)&fwd);
-	} else if (strcmp(struct_data->flow_struct, "fwd_miss") == 0) {
-		memset(&fwd_miss, 0, sizeof(fwd_miss));
-		parse_struct(struct_data->flow_struct_input, &parse_fwd_miss_field, (void *)&fwd_miss);
-	}
+	struct_command(struct_data->flow_struct, struct_data->flow_struct_input, true, false);
+}
+
+/*
+ * Parse update DOCA Flow struct command, the fields that are not given keep their values
+ *
+ * @parsed_result [in]: Command line interface input with user input
+ */
+static void
+cmd_update_struct_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+{
+	struct cmd_create_struct_result *struct_data = (struct cmd_create_struct_result *)parsed_result;
+
+	struct_command(struct_data->flow_struct, struct_data->flow_struct_input, false, false);
 }
 
 /* Define the token of create */
@@ -2149,6 +2355,23 @@ static cmdline_parse_inst_t cmd_update_struct = {
 		},
 };
 
+/* Define the token of update */
+static cmdline_parse_token_string_t cmd_override_struct_update_tok =
+	TOKEN_STRING_INITIALIZER(struct cmd_create_struct_result, create, "update");
+
+static cmdline_parse_inst_t cmd_override_struct = {
+	.f = cmd_update_struct_parsed,					/* Function to call */
+	.data = NULL,							/* 2nd arg of func */
+	.help_str =							/* Command print usage */
+			"update pipe_match|entry_match|match_mask|actions|monitor|fwd|fwd_miss <struct fields>",
+	.tokens = {							/* Token list, NULL terminated */
+			(void *)&cmd_override_struct_update_tok,
+			(void *)&cmd_create_struct_struct_tok,
+			(void *)&cmd_create_struct_input_tok,
+			NULL,
+		},
+};
+
 
 /*
  * Parse create DOCA Flow struct command for FW app
@@ -2160,8 +2383,20 @@ cmd_fw_create_struct_parsed(void *parsed_result, __rte_unused struct cmdline *cl
 {
 	struct cmd_create_struct_result *struct_data = (struct cmd_create_struct_result *)parsed_result;
 
-	memset(&entry_match, 0, sizeof(entry_match));
-	parse_struct(struct_data->flow_struct_input, &parse_fw_match_field, (void *)&entry_match);
+	struct_command("entry_match", struct_data->flow_struct_input, true, true);
+}
+
+/*
+ * Parse update DOCA Flow struct command for FW app
+ *
+ * @parsed_result [in]: Command line interface input with user input
+ */
+static void
+cmd_fw_update_struct_parsed(void *parsed_result, __rte_unused struct cmdline *cl, __rte_unused void *data)
+{
+	struct cmd_create_struct_result *struct_data = (struct cmd_create_struct_result *)parsed_result;
+
+	struct_command("entry_match", struct_data->flow_struct_input, false, true);
 }
 
 /* Define the token of flow type */
@@ -2185,6 +2420,19 @@ static cmdline_parse_inst_t cmd_fw_create_match_struct = {
 		},
 };
 
+static cmdline_parse_inst_t cmd_fw_override_match_struct = {
+	.f = cmd_fw_update_struct_parsed,				/* Function to call */
+	.data = NULL,							/* 2nd arg of func */
+	.help_str =							/* Command print usage */
+			"update entry_match <struct fields>",
+	.tokens = {							/* Token list, NULL terminated */
+			(void *)&cmd_override_struct_update_tok,
+			(void *)&cmd_fw_create_struct_struct_tok,
+			(void *)&cmd_fw_create_struct_input_tok,
+			NULL,
+		},
+};
+
 /*
  * Quit command line interface
  *
@@ -2214,6 +2462,7 @@ static cmdline_parse_inst_t cmd_quit = {
 static cmdline_parse_ctx_t main_ctx[] = {
 	(cmdline_parse_inst_t *)&cmd_quit,
 	(cmdline_parse_inst_t *)&cmd_update_struct,
+	(cmdline_parse_inst_t *)&cmd_override_struct,
 	(cmdline_parse_inst_t *)&cmd_create_pipe,
 	(cmdline_parse_inst_t *)&cmd_add_entry,
 	(cmdline_parse_inst_t *)&cmd_add_control_pipe_entry,
@@ -2229,6 +2478,7 @@ static cmdline_parse_ctx_t main_ctx[] = {
 static cmdline_parse_ctx_t fw_subset_ctx[] = {
 	(cmdline_parse_inst_t *)&cmd_quit,
 	(cmdline_parse_inst_t *)&cmd_fw_create_match_struct,
+	(cmdline_parse_inst_t *)&cmd_fw_override_match_struct,
 	(cmdline_parse_inst_t *)&cmd_fw_add_entry,
 	(cmdline_parse_inst_t *)&cmd_fw_rm_entry,
 	(cmdline_parse_inst_t *)&cmd_flush_pipe,
@@ -2236,6 +2486,527 @@ static cmdline_parse_ctx_t fw_subset_ctx[] = {
 	NULL,
 };
 
+/* Commands of a rules file */
+enum rules_cmd_type {
+	RULES_CMD_CREATE_STRUCT,	  /* create <struct> <fields> */
+	RULES_CMD_UPDATE_STRUCT,	  /* update <struct> <fields> */
+	RULES_CMD_CREATE_PIPE,		  /* create pipe <params> */
+	RULES_CMD_ADD_ENTRY,		  /* add entry <params> */
+	RULES_CMD_ADD_CONTROL_PIPE_ENTRY, /* add control_pipe entry <params> */
+	RULES_CMD_DESTROY_PIPE,		  /* destroy pipe <params> */
+	RULES_CMD_RM_ENTRY,		  /* rm entry <params> */
+	RULES_CMD_FLUSH_PIPES,		  /* port pipes flush <params> */
+	RULES_CMD_DUMP_PIPES,		  /* port pipes dump <params> */
+	RULES_CMD_QUERY,		  /* query <params> */
+	RULES_NB_CMDS,
+};
+
+/* Structures the create and update commands fill, by the ID a compiled rules file keeps */
+static const char *const rules_struct_names[] = {
+	"pipe_match", "entry_match", "match_mask", "actions", "monitor", "fwd", "fwd_miss",
+};
+
+/* Command of a rules file */
+struct rules_cmd {
+	uint8_t type;		 /* enum rules_cmd_type */
+	uint8_t struct_id;	 /* Structure of create and update commands, index in rules_struct_names */
+	uint32_t line;		 /* Line of the command in a text file, or its number in a compiled file */
+	char *params;		 /* Command parameters, in the buffer of the file */
+};
+
+/* Header of a compiled rules file */
+struct rules_file_hdr {
+	char magic[RULES_FILE_MAGIC_LEN]; /* RULES_FILE_MAGIC */
+	uint16_t version;		  /* RULES_FILE_VERSION */
+	uint16_t reserved;		  /* Zero */
+	uint32_t nb_cmds;		  /* Number of command records */
+};
+
+/* Record of a command in a compiled rules file, followed by its NULL terminated parameters */
+struct rules_file_record {
+	uint8_t type;	     /* enum rules_cmd_type */
+	uint8_t struct_id;   /* Structure of create and update commands */
+	uint16_t params_len; /* Length of the parameters, with the NULL terminator */
+};
+
+/*
+ * Cut the next word of a line
+ *
+ * @cursor [in/out]: Position in the line, moved past the word
+ * @return: The word, NULL at the end of the line
+ */
+static char *
+next_word(char **cursor)
+{
+	char *word = *cursor + strspn(*cursor, " \t");
+
+	if (*word == '\0')
+		return NULL;
+	*cursor = word + strcspn(word, " \t");
+	if (**cursor != '\0') {
+		**cursor = '\0';
+		(*cursor)++;
+	}
+	return word;
+}
+
+/*
+ * Find the ID of a structure the create and update commands fill
+ *
+ * @name [in]: Name of the structure
+ * @fw_subset [in]: Only the entry match is supported in the FW subset
+ * @struct_id [out]: ID of the structure
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+find_rules_struct(const char *name, bool fw_subset, uint8_t *struct_id)
+{
+	uint8_t i;
+
+	if (name == NULL)
+		return DOCA_ERROR_INVALID_VALUE;
+	for (i = 0; i < sizeof(rules_struct_names) / sizeof(rules_struct_names[0]); i++) {
+		if (strcmp(name, rules_struct_names[i]) == 0) {
+			if (fw_subset && strcmp(name, "entry_match") != 0)
+				break;
+			*struct_id = i;
+			return DOCA_SUCCESS;
+		}
+	}
+	DOCA_LOG_ERR("The %s is not a valid structure", name);
+	return DOCA_ERROR_INVALID_VALUE;
+}
+
+/*
+ * Parse a line of a text rules file
+ *
+ * @line [in]: Line to parse, its words are cut in place
+ * @fw_subset [in]: Only the FW subset of the commands is supported
+ * @cmd [out]: The command of the line
+ * @has_cmd [out]: false for an empty or comment line
+ * @quit [out]: true for the quit command, which ends the file
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+parse_rules_line(char *line, bool fw_subset, struct rules_cmd *cmd, bool *has_cmd, bool *quit)
+{
+	char *cursor = line, *word, *second;
+	doca_error_t result;
+	size_t len;
+
+	*has_cmd = false;
+	word = next_word(&cursor);
+	if (word == NULL || word[0] == '#')
+		return DOCA_SUCCESS;
+	if (strcmp(word, "quit") == 0) {
+		*quit = true;
+		return DOCA_SUCCESS;
+	}
+
+	second = next_word(&cursor);
+	if (second == NULL) {
+		DOCA_LOG_ERR("Incomplete command %s", word);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if ((strcmp(word, "create") == 0 && strcmp(second, "pipe") != 0) || strcmp(word, "update") == 0) {
+		result = find_rules_struct(second, fw_subset, &cmd->struct_id);
+		if (result != DOCA_SUCCESS)
+			return result;
+		/* The fields are the rest of the line */
+		cmd->type = word[0] == 'c' ? RULES_CMD_CREATE_STRUCT : RULES_CMD_UPDATE_STRUCT;
+		cmd->params = cursor + strspn(cursor, " \t");
+		len = strlen(cmd->params);
+		while (len > 0 && (cmd->params[len - 1] == ' ' || cmd->params[len - 1] == '\t'))
+			cmd->params[--len] = '\0';
+		if (len == 0) {
+			DOCA_LOG_ERR("Missing fields for %s %s", word, second);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		*has_cmd = true;
+		return DOCA_SUCCESS;
+	}
+
+	if (strcmp(word, "create") == 0 && !fw_subset)
+		cmd->type = RULES_CMD_CREATE_PIPE;
+	else if (strcmp(word, "add") == 0 && strcmp(second, "entry") == 0)
+		cmd->type = RULES_CMD_ADD_ENTRY;
+	else if (strcmp(word, "add") == 0 && strcmp(second, "control_pipe") == 0 && !fw_subset) {
+		word = next_word(&cursor);
+		if (word == NULL || strcmp(word, "entry") != 0) {
+			DOCA_LOG_ERR("Unknown command add control_pipe %s", word != NULL ? word : "");
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		cmd->type = RULES_CMD_ADD_CONTROL_PIPE_ENTRY;
+	} else if (strcmp(word, "destroy") == 0 && strcmp(second, "pipe") == 0 && !fw_subset)
+		cmd->type = RULES_CMD_DESTROY_PIPE;
+	else if (strcmp(word, "rm") == 0 && strcmp(second, "entry") == 0)
+		cmd->type = RULES_CMD_RM_ENTRY;
+	else if (strcmp(word, "query") == 0 && !fw_subset) {
+		cmd->type = RULES_CMD_QUERY;
+		cmd->params = second;
+	} else if (strcmp(word, "port") == 0 && strcmp(second, "pipes") == 0) {
+		word = next_word(&cursor);
+		if (word != NULL && strcmp(word, "flush") == 0)
+			cmd->type = RULES_CMD_FLUSH_PIPES;
+		else if (word != NULL && strcmp(word, "dump") == 0)
+			cmd->type = RULES_CMD_DUMP_PIPES;
+		else {
+			DOCA_LOG_ERR("Unknown command port pipes %s", word != NULL ? word : "");
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+	} else {
+		DOCA_LOG_ERR("Unknown command %s %s", word, second);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (cmd->type != RULES_CMD_QUERY) {
+		cmd->params = next_word(&cursor);
+		if (cmd->params == NULL) {
+			DOCA_LOG_ERR("Missing parameters");
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+	}
+	if (next_word(&cursor) != NULL) {
+		DOCA_LOG_ERR("Unexpected text after the parameters");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	*has_cmd = true;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Check the parameters of the entry commands, so a batch of entries is never stopped halfway by a bad line
+ *
+ * @cmd [in]: Command to check
+ * @fw_subset [in]: Only the FW subset of the commands is supported
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+check_rules_cmd(struct rules_cmd *cmd, bool fw_subset)
+{
+	bool is_fwd = false, is_monitor = false;
+	uint64_t pipe_id;
+	uint16_t port_id;
+	int pipe_queue;
+
+	if (cmd->type != RULES_CMD_ADD_ENTRY)
+		return DOCA_SUCCESS;
+	if (fw_subset)
+		return parse_fw_add_entry_params(cmd->params, &port_id);
+	return parse_add_entry_params(cmd->params, &is_fwd, &is_monitor, &pipe_id, &pipe_queue);
+}
+
+/*
+ * Split a text rules file into its commands, in a single pass over the file
+ *
+ * @text [in]: File content, NULL terminated, its lines are cut in place
+ * @fw_subset [in]: Only the FW subset of the commands is supported
+ * @cmds [out]: Commands of the file, to be freed by the caller
+ * @nb_cmds [out]: Number of commands
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+tokenize_rules_text(char *text, bool fw_subset, struct rules_cmd **cmds, uint32_t *nb_cmds)
+{
+	struct rules_cmd *cmds_arr = NULL, *tmp;
+	uint32_t nb = 0, size = 0, line_nb = 0;
+	char *line = text, *end;
+	bool has_cmd, quit = false;
+	doca_error_t result;
+
+	while (*line != '\0' && !quit) {
+		line_nb++;
+		end = line + strcspn(line, "\r\n");
+		if (*end != '\0')
+			*end++ = '\0';
+		if (*end == '\n')
+			end++;
+
+		if (nb == size) {
+			size = size == 0 ? 1024 : size * 2;
+			tmp = realloc(cmds_arr, size * sizeof(*cmds_arr));
+			if (tmp == NULL) {
+				DOCA_LOG_ERR("Failed to allocate memory for the rules commands");
+				free(cmds_arr);
+				return DOCA_ERROR_NO_MEMORY;
+			}
+			cmds_arr = tmp;
+		}
+
+		result = parse_rules_line(line, fw_subset, &cmds_arr[nb], &has_cmd, &quit);
+		if (result == DOCA_SUCCESS && has_cmd)
+			result = check_rules_cmd(&cmds_arr[nb], fw_subset);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Invalid rule in line %u", line_nb);
+			free(cmds_arr);
+			return result;
+		}
+		if (has_cmd)
+			cmds_arr[nb++].line = line_nb;
+		line = end;
+	}
+
+	*cmds = cmds_arr;
+	*nb_cmds = nb;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Split a compiled rules file into its commands
+ *
+ * @bytes [in]: File content
+ * @size [in]: File size
+ * @fw_subset [in]: Only the FW subset of the commands is supported
+ * @cmds [out]: Commands of the file, to be freed by the caller
+ * @nb_cmds [out]: Number of commands
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+tokenize_rules_compiled(char *bytes, size_t size, bool fw_subset, struct rules_cmd **cmds, uint32_t *nb_cmds)
+{
+	struct rules_file_hdr hdr;
+	struct rules_file_record record;
+	struct rules_cmd *cmds_arr;
+	size_t offset = sizeof(hdr);
+	uint32_t i;
+	doca_error_t result;
+
+	memcpy(&hdr, bytes, sizeof(hdr));
+	if (hdr.version != RULES_FILE_VERSION) {
+		DOCA_LOG_ERR("Unsupported compiled rules file version %u", hdr.version);
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+	if (hdr.nb_cmds > (size - sizeof(hdr)) / sizeof(record)) {
+		DOCA_LOG_ERR("Compiled rules file is truncated");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	cmds_arr = malloc((hdr.nb_cmds > 0 ? hdr.nb_cmds : 1) * sizeof(*cmds_arr));
+	if (cmds_arr == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory for the rules commands");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	for (i = 0; i < hdr.nb_cmds; i++) {
+		result = DOCA_ERROR_INVALID_VALUE;
+		if (size - offset < sizeof(record))
+			goto invalid_record;
+		memcpy(&record, bytes + offset, sizeof(record));
+		offset += sizeof(record);
+		if (record.type >= RULES_NB_CMDS || record.params_len == 0 || size - offset < record.params_len ||
+		    bytes[offset + record.params_len - 1] != '\0')
+			goto invalid_record;
+		if (record.type == RULES_CMD_CREATE_STRUCT || record.type == RULES_CMD_UPDATE_STRUCT) {
+			if (record.struct_id >= sizeof(rules_struct_names) / sizeof(rules_struct_names[0]))
+				goto invalid_record;
+			result = find_rules_struct(rules_struct_names[record.struct_id], fw_subset,
+						   &cmds_arr[i].struct_id);
+			if (result != DOCA_SUCCESS)
+				goto invalid_record;
+		}
+		cmds_arr[i].type = record.type;
+		cmds_arr[i].line = i + 1;
+		cmds_arr[i].params = bytes + offset;
+		offset += record.params_len;
+
+		result = check_rules_cmd(&cmds_arr[i], fw_subset);
+		if (result != DOCA_SUCCESS)
+			goto invalid_record;
+	}
+
+	*cmds = cmds_arr;
+	*nb_cmds = hdr.nb_cmds;
+	return DOCA_SUCCESS;
+
+invalid_record:
+	DOCA_LOG_ERR("Invalid record %u in the compiled rules file", i + 1);
+	free(cmds_arr);
+	return result;
+}
+
+/*
+ * Read a rules file, text or compiled, and split it into its commands
+ *
+ * @rules_path [in]: Path of the rules file
+ * @fw_subset [in]: Only the FW subset of the commands is supported
+ * @bytes [out]: File content the commands point into, to be freed by the caller
+ * @cmds [out]: Commands of the file, to be freed by the caller
+ * @nb_cmds [out]: Number of commands
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+read_rules_file(const char *rules_path, bool fw_subset, char **bytes, struct rules_cmd **cmds, uint32_t *nb_cmds)
+{
+	char *file_bytes, *tmp;
+	size_t size;
+	doca_error_t result;
+
+	result = read_file(rules_path, &file_bytes, &size);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to read rules file %s: %s", rules_path, doca_error_get_descr(result));
+		return result;
+	}
+
+	if (size >= sizeof(struct rules_file_hdr) && memcmp(file_bytes, RULES_FILE_MAGIC, RULES_FILE_MAGIC_LEN) == 0) {
+		result = tokenize_rules_compiled(file_bytes, size, fw_subset, cmds, nb_cmds);
+	} else {
+		tmp = realloc(file_bytes, size + 1);
+		if (tmp == NULL) {
+			DOCA_LOG_ERR("Failed to allocate memory for rules file %s", rules_path);
+			free(file_bytes);
+			return DOCA_ERROR_NO_MEMORY;
+		}
+		file_bytes = tmp;
+		file_bytes[size] = '\0';
+		result = tokenize_rules_text(file_bytes, fw_subset, cmds, nb_cmds);
+	}
+	if (result != DOCA_SUCCESS) {
+		free(file_bytes);
+		return result;
+	}
+
+	*bytes = file_bytes;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Run a command of a rules file
+ *
+ * @cmd [in]: Command to run
+ * @fw_subset [in]: Only the FW subset of the commands is supported
+ * @flags [in]: DOCA Flow flags of an add entry command
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+run_rules_cmd(struct rules_cmd *cmd, bool fw_subset, uint32_t flags)
+{
+	switch (cmd->type) {
+	case RULES_CMD_CREATE_STRUCT:
+		return struct_command(rules_struct_names[cmd->struct_id], cmd->params, true, fw_subset);
+	case RULES_CMD_UPDATE_STRUCT:
+		return struct_command(rules_struct_names[cmd->struct_id], cmd->params, false, fw_subset);
+	case RULES_CMD_CREATE_PIPE:
+		return create_pipe_command(cmd->params);
+	case RULES_CMD_ADD_ENTRY:
+		return fw_subset ? fw_add_entry_command(cmd->params, flags) : add_entry_command(cmd->params, flags);
+	case RULES_CMD_ADD_CONTROL_PIPE_ENTRY:
+		return add_control_pipe_entry_command(cmd->params);
+	case RULES_CMD_DESTROY_PIPE:
+		return destroy_pipe_command(cmd->params);
+	case RULES_CMD_RM_ENTRY:
+		return fw_subset ? fw_rm_entry_command(cmd->params) : rm_entry_command(cmd->params);
+	case RULES_CMD_FLUSH_PIPES:
+		return flush_pipes_command(cmd->params);
+	case RULES_CMD_DUMP_PIPES:
+		return dump_pipe_command(cmd->params);
+	case RULES_CMD_QUERY:
+		return query_command(cmd->params);
+	default:
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+}
+
+doca_error_t
+flow_parser_load_rules(const char *rules_path, bool fw_subset, uint32_t batch_size)
+{
+	struct rules_cmd *cmds;
+	char *bytes;
+	uint32_t nb_cmds, i, nb_batch = 0, nb_entries = 0;
+	uint32_t flags;
+	doca_error_t result;
+
+	if (batch_size == 0) {
+		DOCA_LOG_ERR("Rules batch size must be at least 1");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	/* The whole file is checked before the first command runs */
+	result = read_rules_file(rules_path, fw_subset, &bytes, &cmds, &nb_cmds);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	for (i = 0; i < nb_cmds; i++) {
+		flags = DOCA_FLOW_NO_WAIT;
+		if (cmds[i].type == RULES_CMD_ADD_ENTRY) {
+			/* A run of entries is pushed a batch at a time, by the last entry of the batch */
+			nb_entries++;
+			nb_batch++;
+			if (nb_batch < batch_size && i + 1 < nb_cmds && cmds[i + 1].type == RULES_CMD_ADD_ENTRY)
+				flags = DOCA_FLOW_WAIT_FOR_BATCH;
+			else
+				nb_batch = 0;
+		}
+
+		result = run_rules_cmd(&cmds[i], fw_subset, flags);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to run the rule in line %u of %s", cmds[i].line, rules_path);
+			break;
+		}
+	}
+
+	if (result == DOCA_SUCCESS)
+		DOCA_LOG_INFO("Loaded %u commands, %u of them entries, from %s", nb_cmds, nb_entries, rules_path);
+	free(cmds);
+	free(bytes);
+	return result;
+}
+
+doca_error_t
+flow_parser_compile_rules(const char *rules_path, const char *compiled_path, bool fw_subset)
+{
+	struct rules_file_hdr hdr = {.magic = RULES_FILE_MAGIC, .version = RULES_FILE_VERSION};
+	struct rules_file_record record = {0};
+	struct rules_cmd *cmds;
+	char *bytes;
+	size_t params_len;
+	uint32_t nb_cmds, i;
+	FILE *file;
+	doca_error_t result;
+
+	result = read_rules_file(rules_path, fw_subset, &bytes, &cmds, &nb_cmds);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	file = fopen(compiled_path, "wb");
+	if (file == NULL) {
+		DOCA_LOG_ERR("Failed to open %s", compiled_path);
+		result = DOCA_ERROR_IO_FAILED;
+		goto free_cmds;
+	}
+
+	hdr.nb_cmds = nb_cmds;
+	if (fwrite(&hdr, sizeof(hdr), 1, file) != 1)
+		result = DOCA_ERROR_IO_FAILED;
+	for (i = 0; i < nb_cmds && result == DOCA_SUCCESS; i++) {
+		params_len = strlen(cmds[i].params) + 1;
+		if (params_len > UINT16_MAX) {
+			DOCA_LOG_ERR("Parameters of the rule in line %u are too long", cmds[i].line);
+			result = DOCA_ERROR_INVALID_VALUE;
+			break;
+		}
+		record.type = cmds[i].type;
+		record.struct_id = (cmds[i].type == RULES_CMD_CREATE_STRUCT || cmds[i].type == RULES_CMD_UPDATE_STRUCT) ?
+					   cmds[i].struct_id :
+					   0;
+		record.params_len = params_len;
+		if (fwrite(&record, sizeof(record), 1, file) != 1 ||
+		    fwrite(cmds[i].params, params_len, 1, file) != 1)
+			result = DOCA_ERROR_IO_FAILED;
+	}
+	if (fclose(file) != 0 && result == DOCA_SUCCESS)
+		result = DOCA_ERROR_IO_FAILED;
+	if (result == DOCA_ERROR_IO_FAILED)
+		DOCA_LOG_ERR("Failed to write %s", compiled_path);
+	else if (result == DOCA_SUCCESS)
+		DOCA_LOG_INFO("Compiled %u commands of %s to %s", nb_cmds, rules_path, compiled_path);
+
+free_cmds:
+	free(cmds);
+	free(bytes);
+	return result;
+}
+
 doca_error_t
 flow_parser_init(char *shell_prompt, bool fw_subset)
 {
@@ -70,7 +70,7 @@ void set_pipe_add_entry(void (*action)(uint16_t pipe_queue, uint64_t pipe_id,
  * @action [in]: Function callback
  */
 void set_pipe_fw_add_entry(void (*action)(uint16_t port_id,
-						 struct doca_flow_match *match));
+						 struct doca_flow_match *match, uint32_t flags));
 
 /*
  * Set the function to be called once pipe control add entry command is entered
@@ -132,6 +132,29 @@ void set_port_pipes_dump(void (*action)(uint16_t port_id, FILE *fd));
  */
 doca_error_t flow_parser_init(char *shell_prompt, bool fw_subset);
 
+/*
+ * Run the commands of a rules file, without the command line interface. The file is either text, with a shell command
+ * per line ('#' starts a comment line and "quit" ends the file), or a file compiled by flow_parser_compile_rules().
+ * The whole file is checked before the first command runs. A run of add entry commands is pushed in batches: all the
+ * entries of a batch but the last are added with DOCA_FLOW_WAIT_FOR_BATCH.
+ *
+ * @rules_path [in]: Path of the rules file
+ * @fw_subset [in]: Boolean to decide what commands should be supported
+ * @batch_size [in]: Maximal number of entries in a batch
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t flow_parser_load_rules(const char *rules_path, bool fw_subset, uint32_t batch_size);
+
+/*
+ * Compile a text rules file to the binary format flow_parser_load_rules() reads without parsing the command lines
+ *
+ * @rules_path [in]: Path of the text rules file
+ * @compiled_path [in]: Path of the compiled file to write
+ * @fw_subset [in]: Boolean to decide what commands should be supported
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t flow_parser_compile_rules(const char *rules_path, const char *compiled_path, bool fw_subset);
+
 /*
  * Destroy flow parser structures
  */
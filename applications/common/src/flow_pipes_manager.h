@@ -16,17 +16,17 @@
 
 #include <doca_flow.h>
 
-struct pipe_info {
-	struct doca_flow_pipe *pipe;		 /* DOCA Flow pipe pointer */
-	struct rte_hash *entries_table;		 /* Pipe entries table */
-	struct rte_hash *port_id_to_pipes_table; /* Pipes table for the specific port on which the pipe was created */
-};
+#include "flow_id_registry.h"
 
+/*
+ * The IDs of the pipes and entries are handles of a flow ID registry. An ID is never reused, and looking up, adding
+ * and removing take constant time. A pipe's entries are removed along with the pipe, and a port's pipes when the
+ * port is flushed.
+ */
 struct flow_pipes_manager {
-
-	struct rte_hash *pipe_id_to_pipe_info_table; /* map pipe id to all relevant entries to support doca_flow_destroy_port() */
-	struct rte_hash *entry_id_to_pipe_id_table; /* map entry id to pipe id to support doca_flow_pipe_rm_entry() */
-	struct rte_hash *port_id_to_pipes_id_table; /* map port id to all relevant pipes to support doca_flow_port_pipes_flush() */
+	struct flow_id_registry registry; /* Ports, pipes and entries */
+	uint64_t *port_handles;		  /* Registry handle of every port, 0 for a port without pipes */
+	uint32_t nb_ports;		  /* Size of port_handles */
 };
 
 /*
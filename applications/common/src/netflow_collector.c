@@ -0,0 +1,444 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/types.h>
+
+#include <doca_log.h>
+
+#include "netflow_collector.h"
+
+DOCA_LOG_REGISTER(NETFLOW_COLLECTOR);
+
+#define NETFLOW_V9_VERSION 9			/* Version of the export packets */
+#define NETFLOW_V9_HEADER_LEN 20		/* Length of the export packet header */
+#define NETFLOW_V9_FLOWSET_HEADER_LEN 4		/* Length of a flow set header */
+#define NETFLOW_V9_TEMPLATE_FLOWSET_ID 0	/* Flow set id of the templates */
+#define NETFLOW_V9_MIN_DATA_FLOWSET_ID 256	/* Smallest flow set id of data records, the template id */
+#define NETFLOW_COLLECTOR_MAX_TEMPLATES 16	/* Templates learned by the collector */
+#define NETFLOW_COLLECTOR_MAX_FIELDS 64		/* Fields of a template */
+#define NETFLOW_COLLECTOR_MAX_PACKET 65536	/* Largest export packet */
+#define NETFLOW_COLLECTOR_POLL_MS 100		/* Interval of the stop flag checks */
+#define NETFLOW_COLLECTOR_RCVBUF (16 << 20)	/* Requested socket receive buffer, for bursts of the exporter */
+#define NETFLOW_FIELD_SKIP UINT16_MAX		/* Offset of the fields that are not decoded */
+
+/* Field of struct doca_telemetry_netflow_record */
+struct netflow_record_field {
+	uint16_t type;		/* Netflow field type */
+	uint16_t length;	/* Field length */
+	uint16_t offset;	/* Offset in struct doca_telemetry_netflow_record */
+};
+
+/* Fields decoded by the collector */
+static const struct netflow_record_field record_fields[] = {
+	{DOCA_TELEMETRY_NETFLOW_IPV4_SRC_ADDR, DOCA_TELEMETRY_NETFLOW_IPV4_SRC_ADDR_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, src_addr_v4)},
+	{DOCA_TELEMETRY_NETFLOW_IPV4_DST_ADDR, DOCA_TELEMETRY_NETFLOW_IPV4_DST_ADDR_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, dst_addr_v4)},
+	{DOCA_TELEMETRY_NETFLOW_IPV6_SRC_ADDR, DOCA_TELEMETRY_NETFLOW_IPV6_SRC_ADDR_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, src_addr_v6)},
+	{DOCA_TELEMETRY_NETFLOW_IPV6_DST_ADDR, DOCA_TELEMETRY_NETFLOW_IPV6_DST_ADDR_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, dst_addr_v6)},
+	{DOCA_TELEMETRY_NETFLOW_IPV4_NEXT_HOP, DOCA_TELEMETRY_NETFLOW_IPV4_NEXT_HOP_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, next_hop_v4)},
+	{DOCA_TELEMETRY_NETFLOW_IPV6_NEXT_HOP, DOCA_TELEMETRY_NETFLOW_IPV6_NEXT_HOP_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, next_hop_v6)},
+	{DOCA_TELEMETRY_NETFLOW_INPUT_SNMP, DOCA_TELEMETRY_NETFLOW_INPUT_SNMP_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, input)},
+	{DOCA_TELEMETRY_NETFLOW_OUTPUT_SNMP, DOCA_TELEMETRY_NETFLOW_OUTPUT_SNMP_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, output)},
+	{DOCA_TELEMETRY_NETFLOW_L4_SRC_PORT, DOCA_TELEMETRY_NETFLOW_L4_SRC_PORT_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, src_port)},
+	{DOCA_TELEMETRY_NETFLOW_L4_DST_PORT, DOCA_TELEMETRY_NETFLOW_L4_DST_PORT_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, dst_port)},
+	{DOCA_TELEMETRY_NETFLOW_TCP_FLAGS, DOCA_TELEMETRY_NETFLOW_TCP_FLAGS_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, tcp_flags)},
+	{DOCA_TELEMETRY_NETFLOW_PROTOCOL, DOCA_TELEMETRY_NETFLOW_PROTOCOL_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, protocol)},
+	{DOCA_TELEMETRY_NETFLOW_SRC_TOS, DOCA_TELEMETRY_NETFLOW_SRC_TOS_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, tos)},
+	{DOCA_TELEMETRY_NETFLOW_SRC_AS, DOCA_TELEMETRY_NETFLOW_SRC_AS_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, src_as)},
+	{DOCA_TELEMETRY_NETFLOW_DST_AS, DOCA_TELEMETRY_NETFLOW_DST_AS_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, dst_as)},
+	{DOCA_TELEMETRY_NETFLOW_SRC_MASK, DOCA_TELEMETRY_NETFLOW_SRC_MASK_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, src_mask)},
+	{DOCA_TELEMETRY_NETFLOW_DST_MASK, DOCA_TELEMETRY_NETFLOW_DST_MASK_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, dst_mask)},
+	{DOCA_TELEMETRY_NETFLOW_IN_PKTS, DOCA_TELEMETRY_NETFLOW_IN_PKTS_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, d_pkts)},
+	{DOCA_TELEMETRY_NETFLOW_IN_BYTES, DOCA_TELEMETRY_NETFLOW_IN_BYTES_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, d_octets)},
+	{DOCA_TELEMETRY_NETFLOW_FIRST_SWITCHED, DOCA_TELEMETRY_NETFLOW_FIRST_SWITCHED_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, first)},
+	{DOCA_TELEMETRY_NETFLOW_LAST_SWITCHED, DOCA_TELEMETRY_NETFLOW_LAST_SWITCHED_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, last)},
+	{DOCA_TELEMETRY_NETFLOW_CONNECTION_TRANSACTION_ID, DOCA_TELEMETRY_NETFLOW_CONNECTION_TRANSACTION_ID_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, flow_id)},
+	{DOCA_TELEMETRY_NETFLOW_APPLICATION_NAME, DOCA_TELEMETRY_NETFLOW_APPLICATION_NAME_DEFAULT_LENGTH,
+	 offsetof(struct doca_telemetry_netflow_record, application_name)},
+};
+
+/* Field of a learned template */
+struct netflow_template_field {
+	uint16_t length;	/* Field length in the data records */
+	uint16_t offset;	/* Offset in struct doca_telemetry_netflow_record, NETFLOW_FIELD_SKIP if not decoded */
+};
+
+/* Learned template */
+struct netflow_template {
+	uint16_t id;						/* Template id, 0 if the slot is free */
+	uint16_t nb_fields;					/* Number of fields */
+	uint32_t record_len;					/* Length of a data record */
+	struct netflow_template_field fields[NETFLOW_COLLECTOR_MAX_FIELDS]; /* Fields, in the records order */
+};
+
+/* Netflow collector */
+struct netflow_collector {
+	int fd;								/* UDP socket */
+	uint16_t port;							/* UDP port */
+	pthread_t thread;						/* Receive thread */
+	bool stop;							/* Set to stop the thread */
+	netflow_collector_record_cb record_cb;				/* Record callback, may be NULL */
+	void *user_ctx;							/* Record callback context */
+	bool has_sequence;						/* True once a packet was received */
+	uint32_t next_sequence;						/* Expected sequence number */
+	struct netflow_template templates[NETFLOW_COLLECTOR_MAX_TEMPLATES]; /* Learned templates */
+	pthread_mutex_t stats_lock;					/* Protects stats */
+	struct netflow_collector_stats stats;				/* Counters */
+};
+
+/*
+ * Read a 16 bits big endian value
+ *
+ * @p [in]: value address
+ * @return: value
+ */
+static inline uint16_t
+read_be16(const uint8_t *p)
+{
+	return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+/*
+ * Read a 32 bits big endian value
+ *
+ * @p [in]: value address
+ * @return: value
+ */
+static inline uint32_t
+read_be32(const uint8_t *p)
+{
+	return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+/*
+ * Find a learned template
+ *
+ * @collector [in]: collector
+ * @id [in]: template id
+ * @return: template, NULL if it was not received
+ */
+static struct netflow_template *
+find_template(struct netflow_collector *collector, uint16_t id)
+{
+	int i;
+
+	for (i = 0; i < NETFLOW_COLLECTOR_MAX_TEMPLATES; i++) {
+		if (collector->templates[i].id == id)
+			return &collector->templates[i];
+	}
+	return NULL;
+}
+
+/*
+ * Learn the templates of a template flow set
+ *
+ * @collector [in]: collector
+ * @p [in]: flow set content, after its header
+ * @len [in]: flow set content length
+ * @stats [in/out]: counters of the packet
+ */
+static void
+parse_template_flowset(struct netflow_collector *collector, const uint8_t *p, size_t len,
+		       struct netflow_collector_stats *stats)
+{
+	struct netflow_template *template;
+	uint16_t id, nb_fields, type, length;
+	size_t pos = 0, i, j;
+
+	/* The flow set may end with padding shorter than a template header */
+	while (pos + 4 <= len) {
+		id = read_be16(p + pos);
+		nb_fields = read_be16(p + pos + 2);
+		pos += 4;
+		if (id < NETFLOW_V9_MIN_DATA_FLOWSET_ID || nb_fields > NETFLOW_COLLECTOR_MAX_FIELDS ||
+		    pos + nb_fields * 4 > len) {
+			stats->malformed++;
+			return;
+		}
+		template = find_template(collector, id);
+		if (template == NULL)
+			template = find_template(collector, 0);
+		if (template == NULL) {
+			stats->malformed++;
+			return;
+		}
+
+		template->id = id;
+		template->nb_fields = nb_fields;
+		template->record_len = 0;
+		for (i = 0; i < nb_fields; i++, pos += 4) {
+			type = read_be16(p + pos);
+			length = read_be16(p + pos + 2);
+			template->fields[i].length = length;
+			template->fields[i].offset = NETFLOW_FIELD_SKIP;
+			for (j = 0; j < sizeof(record_fields) / sizeof(record_fields[0]); j++) {
+				if (record_fields[j].type == type && record_fields[j].length == length) {
+					template->fields[i].offset = record_fields[j].offset;
+					break;
+				}
+			}
+			template->record_len += length;
+		}
+		stats->templates++;
+	}
+}
+
+/*
+ * Decode the data records of a data flow set
+ *
+ * @collector [in]: collector
+ * @id [in]: flow set id, the template id
+ * @p [in]: flow set content, after its header
+ * @len [in]: flow set content length
+ * @stats [in/out]: counters of the packet
+ */
+static void
+parse_data_flowset(struct netflow_collector *collector, uint16_t id, const uint8_t *p, size_t len,
+		   struct netflow_collector_stats *stats)
+{
+	struct doca_telemetry_netflow_record record;
+	const struct netflow_template *template;
+	const uint8_t *field;
+	size_t pos;
+	int i;
+
+	template = find_template(collector, id);
+	if (template == NULL) {
+		stats->unknown_template++;
+		return;
+	}
+	if (template->record_len == 0) {
+		stats->malformed++;
+		return;
+	}
+
+	/* The flow set may end with padding shorter than a record */
+	for (pos = 0; pos + template->record_len <= len; pos += template->record_len) {
+		memset(&record, 0, sizeof(record));
+		field = p + pos;
+		for (i = 0; i < template->nb_fields; i++) {
+			if (template->fields[i].offset != NETFLOW_FIELD_SKIP)
+				memcpy((uint8_t *)&record + template->fields[i].offset, field,
+				       template->fields[i].length);
+			field += template->fields[i].length;
+		}
+		stats->records++;
+		stats->pkts += ntohl(record.d_pkts);
+		stats->octets += ntohl(record.d_octets);
+		if (collector->record_cb != NULL && !collector->record_cb(&record, collector->user_ctx))
+			stats->invalid_records++;
+	}
+}
+
+/*
+ * Parse an export packet
+ *
+ * @collector [in]: collector
+ * @p [in]: packet
+ * @len [in]: packet length
+ * @stats [in/out]: counters of the packet
+ */
+static void
+parse_packet(struct netflow_collector *collector, const uint8_t *p, size_t len, struct netflow_collector_stats *stats)
+{
+	uint16_t flowset_id, flowset_len;
+	uint32_t sequence;
+	size_t pos;
+
+	if (len < NETFLOW_V9_HEADER_LEN || read_be16(p) != NETFLOW_V9_VERSION) {
+		stats->malformed++;
+		return;
+	}
+	stats->packets++;
+
+	/* The sequence number counts the export packets of the source */
+	sequence = read_be32(p + 12);
+	if (collector->has_sequence && sequence != collector->next_sequence &&
+	    sequence - collector->next_sequence < (1U << 31))
+		stats->lost_packets += sequence - collector->next_sequence;
+	collector->has_sequence = true;
+	collector->next_sequence = sequence + 1;
+
+	for (pos = NETFLOW_V9_HEADER_LEN; pos + NETFLOW_V9_FLOWSET_HEADER_LEN <= len; pos += flowset_len) {
+		flowset_id = read_be16(p + pos);
+		flowset_len = read_be16(p + pos + 2);
+		if (flowset_len < NETFLOW_V9_FLOWSET_HEADER_LEN || pos + flowset_len > len) {
+			stats->malformed++;
+			return;
+		}
+		if (flowset_id == NETFLOW_V9_TEMPLATE_FLOWSET_ID)
+			parse_template_flowset(collector, p + pos + NETFLOW_V9_FLOWSET_HEADER_LEN,
+					       flowset_len - NETFLOW_V9_FLOWSET_HEADER_LEN, stats);
+		else if (flowset_id >= NETFLOW_V9_MIN_DATA_FLOWSET_ID)
+			parse_data_flowset(collector, flowset_id, p + pos + NETFLOW_V9_FLOWSET_HEADER_LEN,
+					   flowset_len - NETFLOW_V9_FLOWSET_HEADER_LEN, stats);
+		/* The options templates and their data are ignored */
+	}
+}
+
+/*
+ * Collector thread main loop, receives and parses the export packets until the collector is stopped
+ *
+ * @arg [in]: collector
+ * @return: NULL
+ */
+static void *
+collector_main(void *arg)
+{
+	struct netflow_collector *collector = arg;
+	struct netflow_collector_stats packet_stats;
+	struct pollfd pfd = {.fd = collector->fd, .events = POLLIN};
+	uint64_t *total, *delta;
+	uint8_t *buf;
+	ssize_t len;
+	size_t i;
+
+	buf = malloc(NETFLOW_COLLECTOR_MAX_PACKET);
+	if (buf == NULL) {
+		DOCA_LOG_ERR("Failed to allocate the Netflow collector buffer");
+		return NULL;
+	}
+
+	while (!__atomic_load_n(&collector->stop, __ATOMIC_RELAXED)) {
+		if (poll(&pfd, 1, NETFLOW_COLLECTOR_POLL_MS) <= 0)
+			continue;
+		/* Drain the socket before the next poll */
+		while ((len = recv(collector->fd, buf, NETFLOW_COLLECTOR_MAX_PACKET, MSG_DONTWAIT)) >= 0) {
+			memset(&packet_stats, 0, sizeof(packet_stats));
+			parse_packet(collector, buf, len, &packet_stats);
+
+			pthread_mutex_lock(&collector->stats_lock);
+			total = (uint64_t *)&collector->stats;
+			delta = (uint64_t *)&packet_stats;
+			for (i = 0; i < sizeof(packet_stats) / sizeof(uint64_t); i++)
+				total[i] += delta[i];
+			pthread_mutex_unlock(&collector->stats_lock);
+		}
+	}
+	free(buf);
+	return NULL;
+}
+
+doca_error_t
+netflow_collector_create(const char *addr, uint16_t port, netflow_collector_record_cb record_cb, void *user_ctx,
+			 struct netflow_collector **collector)
+{
+	struct sockaddr_in sin = {.sin_family = AF_INET, .sin_port = htons(port)};
+	socklen_t sin_len = sizeof(sin);
+	int rcvbuf = NETFLOW_COLLECTOR_RCVBUF;
+	struct netflow_collector *new_collector;
+	doca_error_t result;
+
+	if (inet_pton(AF_INET, addr, &sin.sin_addr) != 1) {
+		DOCA_LOG_ERR("Netflow collector address \"%s\" is not an IPv4 address", addr);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	new_collector = calloc(1, sizeof(*new_collector));
+	if (new_collector == NULL) {
+		DOCA_LOG_ERR("Failed to allocate the Netflow collector");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	new_collector->record_cb = record_cb;
+	new_collector->user_ctx = user_ctx;
+	pthread_mutex_init(&new_collector->stats_lock, NULL);
+
+	new_collector->fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (new_collector->fd < 0) {
+		DOCA_LOG_ERR("Failed to create the Netflow collector socket: %s", strerror(errno));
+		result = DOCA_ERROR_IO_FAILED;
+		goto free_collector;
+	}
+	/* A smaller buffer only means more lost packets */
+	if (setsockopt(new_collector->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) < 0)
+		DOCA_LOG_WARN("Failed to enlarge the Netflow collector socket buffer: %s", strerror(errno));
+	if (bind(new_collector->fd, (struct sockaddr *)&sin, sizeof(sin)) < 0 ||
+	    getsockname(new_collector->fd, (struct sockaddr *)&sin, &sin_len) < 0) {
+		DOCA_LOG_ERR("Failed to bind the Netflow collector to %s:%u: %s", addr, port, strerror(errno));
+		result = DOCA_ERROR_IO_FAILED;
+		goto close_socket;
+	}
+	new_collector->port = ntohs(sin.sin_port);
+
+	if (pthread_create(&new_collector->thread, NULL, collector_main, new_collector) != 0) {
+		DOCA_LOG_ERR("Failed to create the Netflow collector thread");
+		result = DOCA_ERROR_OPERATING_SYSTEM;
+		goto close_socket;
+	}
+
+	DOCA_LOG_INFO("Netflow collector listening on %s:%u", addr, new_collector->port);
+	*collector = new_collector;
+	return DOCA_SUCCESS;
+
+close_socket:
+	close(new_collector->fd);
+free_collector:
+	pthread_mutex_destroy(&new_collector->stats_lock);
+	free(new_collector);
+	return result;
+}
+
+uint16_t
+netflow_collector_get_port(const struct netflow_collector *collector)
+{
+	return collector->port;
+}
+
+void
+netflow_collector_get_stats(struct netflow_collector *collector, struct netflow_collector_stats *stats)
+{
+	pthread_mutex_lock(&collector->stats_lock);
+	*stats = collector->stats;
+	pthread_mutex_unlock(&collector->stats_lock);
+}
+
+void
+netflow_collector_destroy(struct netflow_collector *collector)
+{
+	__atomic_store_n(&collector->stop, true, __ATOMIC_RELAXED);
+	pthread_join(collector->thread, NULL);
+	close(collector->fd);
+	pthread_mutex_destroy(&collector->stats_lock);
+	free(collector);
+}
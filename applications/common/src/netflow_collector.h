@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef COMMON_NETFLOW_COLLECTOR_H_
+#define COMMON_NETFLOW_COLLECTOR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "telemetry.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Netflow v9 collector stand-in, for tests and benchmarks of the Netflow exporter without a real collector.
+ * It receives the export packets on a UDP socket from its own thread, learns the templates and decodes the data
+ * records of any template into struct doca_telemetry_netflow_record, the fields missing from the template are zero.
+ * Only one exporter (source id) is expected: the sequence numbers of all the packets are checked for gaps.
+ */
+
+struct netflow_collector;
+
+/* Netflow collector counters */
+struct netflow_collector_stats {
+	uint64_t packets;		/* Export packets received */
+	uint64_t templates;		/* Template records received */
+	uint64_t records;		/* Data records decoded */
+	uint64_t pkts;			/* Sum of the packets counters of the data records */
+	uint64_t octets;		/* Sum of the octets counters of the data records */
+	uint64_t invalid_records;	/* Data records refused by the record callback */
+	uint64_t unknown_template;	/* Data flow sets of templates not received yet, not decoded */
+	uint64_t malformed;		/* Packets and flow sets that could not be parsed */
+	uint64_t lost_packets;		/* Export packets missing from the sequence numbers */
+};
+
+/*
+ * Callback called by the collector thread on every decoded data record
+ *
+ * @record [in]: decoded record, the fields are in network byte order
+ * @user_ctx [in]: user context given to netflow_collector_create()
+ * @return: true if the record is valid, false to count it as invalid
+ */
+typedef bool (*netflow_collector_record_cb)(const struct doca_telemetry_netflow_record *record, void *user_ctx);
+
+/*
+ * Create a collector listening on a UDP port and start its thread
+ *
+ * @addr [in]: IPv4 address to listen on, e.g. "127.0.0.1"
+ * @port [in]: UDP port, 0 to let the system choose one
+ * @record_cb [in]: callback called on every data record, may be NULL
+ * @user_ctx [in]: user context of the callback
+ * @collector [out]: collector
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t netflow_collector_create(const char *addr, uint16_t port, netflow_collector_record_cb record_cb,
+				      void *user_ctx, struct netflow_collector **collector);
+
+/*
+ * Get the UDP port a collector listens on
+ *
+ * @collector [in]: collector
+ * @return: UDP port
+ */
+uint16_t netflow_collector_get_port(const struct netflow_collector *collector);
+
+/*
+ * Get the counters of a collector
+ *
+ * @collector [in]: collector
+ * @stats [out]: counters
+ */
+void netflow_collector_get_stats(struct netflow_collector *collector, struct netflow_collector_stats *stats);
+
+/*
+ * Stop the thread of a collector and free it
+ *
+ * @collector [in]: collector
+ */
+void netflow_collector_destroy(struct netflow_collector *collector);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* COMMON_NETFLOW_COLLECTOR_H_ */
@@ -11,14 +11,20 @@
  *
  */
 
-#include <netdb.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <ctype.h>
+#include <inttypes.h>
+#include <stdbool.h>
 #include <sys/queue.h>
 #include <unistd.h>
 #include <linux/types.h>
 
+#include <rte_cycles.h>
+#include <rte_hash_crc.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_spinlock.h>
 #include <rte_string_fns.h>
 
 #include <doca_log.h>
@@ -28,12 +34,77 @@
 
 DOCA_LOG_REGISTER(NETFLOW_TELEMETRY);
 
-/* Queues to hold the telemetry data until sent */
-static struct rte_ring *netflow_pending_ring, *netflow_freelist_ring;
+#define NETFLOW_SCAN_STEP 2		/* Cache slots checked for expiry on each aggregated record */
+#define NETFLOW_POLL_SCAN_STEP 1024	/* Cache slots checked for expiry on each poll */
+#define NETFLOW_SEND_BURST 32		/* Batches dequeued from an lcore at once */
+#define NETFLOW_SHARED_CTX RTE_MAX_LCORE	/* Context of the threads that are not EAL lcores */
+#define NETFLOW_TCP_FIN_RST 0x05	/* TCP flags that end a flow */
+
+/* Key of an aggregated flow */
+struct __attribute__((packed)) netflow_flow_key {
+	__be32 src_addr_v4;	     /* Source IPV4 Address */
+	__be32 dst_addr_v4;	     /* Destination IPV4 Address */
+	struct in6_addr src_addr_v6; /* Source IPV6 Address */
+	struct in6_addr dst_addr_v6; /* Destination IPV6 Address */
+	__be16 src_port;	     /* TCP/UDP source port number or equivalent */
+	__be16 dst_port;	     /* TCP/UDP destination port number or equivalent */
+	uint8_t protocol;	     /* IP protocol type */
+	uint8_t pad[3];		     /* Zero, the key is hashed and compared as bytes */
+};
+
+/* Flow aggregated in an lcore cache */
+struct netflow_flow {
+	struct netflow_flow_key key;			/* Flow key */
+	bool used;					/* True if the slot holds a flow */
+	uint8_t tcp_flags;				/* Cumulative OR of tcp flags */
+	uint64_t pkts;					/* Aggregated packets */
+	uint64_t octets;				/* Aggregated octets */
+	uint64_t first_ms;				/* Exporter uptime of the first record */
+	uint64_t last_ms;				/* Exporter uptime of the last record */
+	struct doca_telemetry_netflow_record record;	/* Last record, its counters and timestamps are not used */
+};
+
+/* Netflow records handed over at once from an lcore to the sender */
+struct netflow_batch {
+	uint32_t nb_records;	/* Records in the batch */
+	const void **ptrs;	/* Records pointers, to send */
+	uint8_t *records;	/* Records of the template, batch_size of them */
+};
 
-/* Netflow records queues */
-static struct doca_telemetry_netflow_record data_to_send[NETFLOW_QUEUE_SIZE];
-static struct doca_telemetry_netflow_record *data_to_send_ptr[NETFLOW_QUEUE_SIZE];
+/*
+ * Flow cache and export queues of an lcore
+ * Only the lcore touches the cache, the batches go to the sender over a single producer single consumer ring and
+ * come back over another one once sent, so the lcore and the sender share no counters nor locks.
+ */
+struct netflow_lcore {
+	struct netflow_flow *flows;		/* Flows, open addressing with linear probing */
+	uint32_t cache_mask;			/* Number of slots - 1 */
+	uint32_t max_flows;			/* Cache load limit, longer probes above it */
+	uint32_t nb_flows;			/* Flows in the cache */
+	uint32_t scan_idx;			/* Next slot checked for expiry */
+	struct netflow_batch *batch;		/* Batch being filled, NULL if none was free */
+	uint64_t batch_ms;			/* Exporter uptime of the first record of the batch */
+	struct netflow_batch *batches;		/* Batches of the lcore */
+	uint32_t nb_batches;			/* Number of batches */
+	const void **batches_ptrs;		/* Records pointers of the batches */
+	uint8_t *batches_records;		/* Records of the batches */
+	struct rte_ring *pending_ring;		/* Batches waiting to be sent */
+	struct rte_ring *free_ring;		/* Sent batches, back to the lcore */
+	rte_spinlock_t lock;			/* Taken by the threads that are not EAL lcores */
+	uint64_t nb_records;			/* Aggregated records */
+	uint64_t nb_exported;			/* Exported flows */
+	uint64_t nb_dropped;			/* Flows dropped because no batch was free */
+} __rte_cache_aligned;
+
+/* Flow caches, indexed by lcore id, NETFLOW_SHARED_CTX for the threads that are not EAL lcores */
+static struct netflow_lcore *netflow_lcores[RTE_MAX_LCORE + 1];
+
+static struct netflow_cfg netflow_cfg;	/* Exporter configuration */
+static size_t netflow_record_size;	/* Size of a record of the template */
+static uint64_t netflow_start_cycles;	/* Timer cycles when the exporter started */
+static uint64_t netflow_cycles_per_ms;	/* Timer cycles per millisecond */
+static uint64_t netflow_sent_records;	/* Records sent, owned by the sender */
+static uint64_t netflow_failed_records;	/* Records that failed to be sent, owned by the sender */
 
 static struct doca_telemetry_netflow_template *netflow_template;	/* Netflow template */
 
@@ -61,16 +132,53 @@ static doca_error_t add_netflow_field(uint16_t type, uint16_t length)
 	return result;
 }
 
+/*
+ * Initialize Netflow template by adding the fields of struct netflow_ipv4_record
+ *
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+init_ipv4_template_fields(void)
+{
+	doca_error_t result = DOCA_SUCCESS;
+
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_IPV4_SRC_ADDR,
+					DOCA_TELEMETRY_NETFLOW_IPV4_SRC_ADDR_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_IPV4_DST_ADDR,
+					DOCA_TELEMETRY_NETFLOW_IPV4_DST_ADDR_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_INPUT_SNMP, DOCA_TELEMETRY_NETFLOW_INPUT_SNMP_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_OUTPUT_SNMP, DOCA_TELEMETRY_NETFLOW_OUTPUT_SNMP_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_L4_SRC_PORT, DOCA_TELEMETRY_NETFLOW_L4_SRC_PORT_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_L4_DST_PORT, DOCA_TELEMETRY_NETFLOW_L4_DST_PORT_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_TCP_FLAGS, DOCA_TELEMETRY_NETFLOW_TCP_FLAGS_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_PROTOCOL, DOCA_TELEMETRY_NETFLOW_PROTOCOL_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_SRC_TOS, DOCA_TELEMETRY_NETFLOW_SRC_TOS_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_IN_PKTS, DOCA_TELEMETRY_NETFLOW_IN_PKTS_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_IN_BYTES, DOCA_TELEMETRY_NETFLOW_IN_BYTES_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_FIRST_SWITCHED,
+					DOCA_TELEMETRY_NETFLOW_FIRST_SWITCHED_DEFAULT_LENGTH);
+	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_LAST_SWITCHED,
+					DOCA_TELEMETRY_NETFLOW_LAST_SWITCHED_DEFAULT_LENGTH);
+	if (result != DOCA_SUCCESS)
+		return DOCA_ERROR_NO_MEMORY;
+
+	return DOCA_SUCCESS;
+}
+
 /*
  * Initialize Netflow template by adding all fields
  *
+ * @template_type [in]: template of the records
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-init_template_fields(void)
+init_template_fields(enum netflow_template_type template_type)
 {
 	doca_error_t result = DOCA_SUCCESS;
 
+	if (template_type == NETFLOW_TEMPLATE_IPV4)
+		return init_ipv4_template_fields();
+
 	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_IPV4_SRC_ADDR,
 					DOCA_TELEMETRY_NETFLOW_IPV4_SRC_ADDR_DEFAULT_LENGTH);
 	result |= add_netflow_field(DOCA_TELEMETRY_NETFLOW_IPV4_DST_ADDR,
@@ -112,16 +220,16 @@ init_template_fields(void)
 
 /*
  * Get host name to be tagged with the telemetry data
+ * The name is not resolved, a DNS lookup may block the initialization for long
  *
- * @host_name [out]: host name
+ * @host_name [out]: host name, 64 bytes
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-get_hostname_ip(char *host_name)
+get_hostname(char *host_name)
 {
 	doca_error_t result = DOCA_SUCCESS;
 	char host[256];
-	struct hostent *host_entry = NULL;
 
 	 /* Find the host name */
 	if (gethostname(host, sizeof(host)) < 0)  {
@@ -136,96 +244,541 @@ get_hostname_ip(char *host_name)
 		DOCA_LOG_ERR("Gethostname failed");
 		return result;
 	}
-	/* Find host information */
-	host_entry = gethostbyname(host);
-	if (host_entry == NULL)
-		strlcpy(host_name, host, 64);
-	else
-		strlcpy(host_name, host_entry->h_name, 64);
+	strlcpy(host_name, host, 64);
 
 	DOCA_LOG_TRC("Host name: %s", host_name);
 	return result;
 }
 
+/*
+ * Get the exporter uptime
+ *
+ * @return: milliseconds since the exporter started
+ */
+static inline uint64_t
+netflow_now_ms(void)
+{
+	return (rte_get_timer_cycles() - netflow_start_cycles) / netflow_cycles_per_ms;
+}
+
+/*
+ * Hand over the batch being filled to the sender
+ *
+ * @ctx [in]: lcore context
+ */
+static void
+netflow_push_batch(struct netflow_lcore *ctx)
+{
+	struct netflow_batch *batch = ctx->batch;
+
+	/* The pending ring can hold all the batches of the lcore */
+	if (rte_ring_sp_enqueue(ctx->pending_ring, batch) != 0) {
+		ctx->nb_dropped += batch->nb_records;
+		batch->nb_records = 0;
+		return;
+	}
+	ctx->batch = NULL;
+}
+
+/*
+ * Write the record of a flow to the batch being filled
+ *
+ * @ctx [in]: lcore context
+ * @flow [in]: flow to export
+ * @now_ms [in]: exporter uptime
+ */
+static void
+netflow_export_flow(struct netflow_lcore *ctx, const struct netflow_flow *flow, uint64_t now_ms)
+{
+	struct doca_telemetry_netflow_record *record;
+	struct netflow_ipv4_record *ipv4_record;
+	struct netflow_batch *batch = ctx->batch;
+	void *dst;
+
+	if (batch == NULL) {
+		if (rte_ring_sc_dequeue(ctx->free_ring, (void **)&batch) != 0) {
+			ctx->nb_dropped++;
+			return;
+		}
+		ctx->batch = batch;
+	}
+	if (batch->nb_records == 0)
+		ctx->batch_ms = now_ms;
+
+	dst = batch->records + batch->nb_records++ * netflow_record_size;
+	if (netflow_cfg.template_type == NETFLOW_TEMPLATE_IPV4) {
+		ipv4_record = dst;
+		ipv4_record->src_addr_v4 = flow->record.src_addr_v4;
+		ipv4_record->dst_addr_v4 = flow->record.dst_addr_v4;
+		ipv4_record->input = flow->record.input;
+		ipv4_record->output = flow->record.output;
+		ipv4_record->src_port = flow->record.src_port;
+		ipv4_record->dst_port = flow->record.dst_port;
+		ipv4_record->tcp_flags = flow->tcp_flags;
+		ipv4_record->protocol = flow->record.protocol;
+		ipv4_record->tos = flow->record.tos;
+		ipv4_record->d_pkts = htonl(RTE_MIN(flow->pkts, (uint64_t)UINT32_MAX));
+		ipv4_record->d_octets = htonl(RTE_MIN(flow->octets, (uint64_t)UINT32_MAX));
+		ipv4_record->first = htonl((uint32_t)flow->first_ms);
+		ipv4_record->last = htonl((uint32_t)flow->last_ms);
+	} else {
+		record = dst;
+		*record = flow->record;
+		record->tcp_flags = flow->tcp_flags;
+		record->d_pkts = htonl(RTE_MIN(flow->pkts, (uint64_t)UINT32_MAX));
+		record->d_octets = htonl(RTE_MIN(flow->octets, (uint64_t)UINT32_MAX));
+		record->first = htonl((uint32_t)flow->first_ms);
+		record->last = htonl((uint32_t)flow->last_ms);
+	}
+	ctx->nb_exported++;
+
+	if (batch->nb_records == netflow_cfg.batch_size)
+		netflow_push_batch(ctx);
+}
+
+/*
+ * Remove a flow from the cache, moving back the flows of its probe sequence
+ *
+ * @ctx [in]: lcore context
+ * @idx [in]: slot of the flow
+ */
+static void
+netflow_remove_flow(struct netflow_lcore *ctx, uint32_t idx)
+{
+	struct netflow_flow *flows = ctx->flows;
+	uint32_t mask = ctx->cache_mask;
+	uint32_t next, home;
+
+	for (next = (idx + 1) & mask; flows[next].used; next = (next + 1) & mask) {
+		home = rte_hash_crc(&flows[next].key, sizeof(flows[next].key), 0) & mask;
+		/* Move the flow back only if its home slot is not between the hole and its slot */
+		if (((next - home) & mask) >= ((next - idx) & mask)) {
+			flows[idx] = flows[next];
+			idx = next;
+		}
+	}
+	flows[idx].used = false;
+	ctx->nb_flows--;
+}
+
+/*
+ * Export and remove the expired flows of a part of the cache, and hand over an old partial batch
+ *
+ * @ctx [in]: lcore context
+ * @nb_slots [in]: number of slots to check
+ * @now_ms [in]: exporter uptime
+ */
+static void
+netflow_expire_flows(struct netflow_lcore *ctx, uint32_t nb_slots, uint64_t now_ms)
+{
+	struct netflow_flow *flow;
+	uint32_t i;
+
+	for (i = 0; i < nb_slots && ctx->nb_flows > 0; i++) {
+		flow = &ctx->flows[ctx->scan_idx];
+		if (flow->used && (now_ms - flow->last_ms >= netflow_cfg.inactive_timeout_ms ||
+				   now_ms - flow->first_ms >= netflow_cfg.active_timeout_ms)) {
+			netflow_export_flow(ctx, flow, now_ms);
+			/* The slot may now hold a flow moved back, check it again */
+			netflow_remove_flow(ctx, ctx->scan_idx);
+			continue;
+		}
+		ctx->scan_idx = (ctx->scan_idx + 1) & ctx->cache_mask;
+	}
+	if (ctx->batch != NULL && ctx->batch->nb_records > 0 &&
+	    now_ms - ctx->batch_ms >= netflow_cfg.batch_timeout_ms)
+		netflow_push_batch(ctx);
+}
+
+/*
+ * Aggregate a record into a flow cache
+ *
+ * @ctx [in]: lcore context
+ * @record [in]: Netflow record
+ */
+static void
+netflow_aggregate_record(struct netflow_lcore *ctx, const struct doca_telemetry_netflow_record *record)
+{
+	struct netflow_flow_key key = {
+		.src_addr_v4 = record->src_addr_v4,
+		.dst_addr_v4 = record->dst_addr_v4,
+		.src_addr_v6 = record->src_addr_v6,
+		.dst_addr_v6 = record->dst_addr_v6,
+		.src_port = record->src_port,
+		.dst_port = record->dst_port,
+		.protocol = record->protocol,
+	};
+	uint64_t now_ms = netflow_now_ms();
+	struct netflow_flow *flow, overflow;
+	uint32_t idx;
+
+	ctx->nb_records++;
+	idx = rte_hash_crc(&key, sizeof(key), 0) & ctx->cache_mask;
+	for (flow = &ctx->flows[idx]; flow->used; flow = &ctx->flows[idx]) {
+		if (memcmp(&flow->key, &key, sizeof(key)) == 0)
+			break;
+		idx = (idx + 1) & ctx->cache_mask;
+	}
+
+	if (!flow->used) {
+		/* A full cache exports the record as is */
+		if (ctx->nb_flows >= ctx->max_flows)
+			flow = &overflow;
+		else
+			ctx->nb_flows++;
+		flow->key = key;
+		flow->used = true;
+		flow->tcp_flags = 0;
+		flow->pkts = 0;
+		flow->octets = 0;
+		flow->first_ms = now_ms;
+	}
+	flow->record = *record;
+	flow->tcp_flags |= record->tcp_flags;
+	flow->pkts += ntohl(record->d_pkts);
+	flow->octets += ntohl(record->d_octets);
+	flow->last_ms = now_ms;
+
+	if (flow == &overflow)
+		netflow_export_flow(ctx, flow, now_ms);
+	else if (record->protocol == IPPROTO_TCP && (record->tcp_flags & NETFLOW_TCP_FIN_RST)) {
+		netflow_export_flow(ctx, flow, now_ms);
+		netflow_remove_flow(ctx, idx);
+	}
+	netflow_expire_flows(ctx, NETFLOW_SCAN_STEP, now_ms);
+}
+
+/*
+ * Get the flow cache of the calling thread, locking the shared cache for threads that are not EAL lcores
+ *
+ * @return: flow cache, NULL if Netflow is not initialized
+ */
+static struct netflow_lcore *
+netflow_get_lcore(void)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	struct netflow_lcore *ctx;
+
+	if (lcore_id >= RTE_MAX_LCORE || netflow_lcores[lcore_id] == NULL) {
+		ctx = netflow_lcores[NETFLOW_SHARED_CTX];
+		if (ctx != NULL)
+			rte_spinlock_lock(&ctx->lock);
+		return ctx;
+	}
+	return netflow_lcores[lcore_id];
+}
+
+/*
+ * Release the flow cache of the calling thread
+ *
+ * @ctx [in]: flow cache returned by netflow_get_lcore()
+ */
+static void
+netflow_put_lcore(struct netflow_lcore *ctx)
+{
+	if (ctx == netflow_lcores[NETFLOW_SHARED_CTX])
+		rte_spinlock_unlock(&ctx->lock);
+}
+
 doca_error_t
 send_netflow_record(void)
 {
-	doca_error_t result;
-	size_t records_to_send = 0;
-	size_t records_sent = 0;
-	size_t records_successfully_sent;
-	int ring_count = rte_ring_count(netflow_pending_ring);
-	static struct doca_telemetry_netflow_record *records[NETFLOW_QUEUE_SIZE];
-	/*
-	 * Sending the record array
-	 * The while loop ensure that all records have been sent, in case just some are sent.
-	 * This section should happen periodically with updated the flows.
-	 */
-	if (ring_count == 0)
-		return 0;
-	/* We need to dequeue only the records that were enqueued with the allocated memory */
-	records_to_send = rte_ring_dequeue_bulk(netflow_pending_ring, (void **)records, ring_count, NULL);
-	while (records_sent < records_to_send) {
-		result = doca_telemetry_netflow_send(netflow_template, (const void **)(records + records_sent),
-				records_to_send - records_sent, &records_successfully_sent);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Failed to send Netflow, error=%d", result);
-			return result;
+	struct netflow_batch *batches[NETFLOW_SEND_BURST];
+	size_t records_sent, records_successfully_sent;
+	doca_error_t result = DOCA_SUCCESS, send_result;
+	struct netflow_lcore *ctx;
+	unsigned int nb_batches, lcore_id, i;
+	size_t total_sent = 0;
+
+	for (lcore_id = 0; lcore_id <= RTE_MAX_LCORE; lcore_id++) {
+		ctx = netflow_lcores[lcore_id];
+		if (ctx == NULL)
+			continue;
+		while ((nb_batches = rte_ring_sc_dequeue_burst(ctx->pending_ring, (void **)batches,
+							       NETFLOW_SEND_BURST, NULL)) > 0) {
+			for (i = 0; i < nb_batches; i++) {
+				/* The while loop ensure that all records have been sent, in case just some are sent */
+				records_sent = 0;
+				while (result == DOCA_SUCCESS && records_sent < batches[i]->nb_records) {
+					send_result = doca_telemetry_netflow_send(netflow_template,
+						batches[i]->ptrs + records_sent, batches[i]->nb_records - records_sent,
+						&records_successfully_sent);
+					if (send_result != DOCA_SUCCESS) {
+						DOCA_LOG_ERR("Failed to send Netflow, error=%d", send_result);
+						result = send_result;
+						break;
+					}
+					records_sent += records_successfully_sent;
+				}
+				total_sent += records_sent;
+				netflow_failed_records += batches[i]->nb_records - records_sent;
+				batches[i]->nb_records = 0;
+			}
+			/* The free ring can hold all the batches of the lcore */
+			rte_ring_sp_enqueue_bulk(ctx->free_ring, (void **)batches, nb_batches, NULL);
 		}
-		records_sent += records_successfully_sent;
 	}
 	/* Flushing the buffer sends it to the collector */
+	if (total_sent == 0)
+		return result;
 	doca_telemetry_netflow_flush();
-	DOCA_LOG_TRC("Successfully sent %lu netflow records with default template", records_sent);
-	if ((size_t)rte_ring_enqueue_bulk(netflow_freelist_ring, (void **)records, records_sent, NULL) != records_sent) {
-		DOCA_LOG_ERR("Placeholder queue mismatch");
-		return DOCA_ERROR_DRIVER;
-	}
-	return DOCA_SUCCESS;
+	netflow_sent_records += total_sent;
+	DOCA_LOG_TRC("Successfully sent %lu netflow records with default template", total_sent);
+	return result;
 }
 
 void
 enqueue_netflow_record_to_ring(const struct doca_telemetry_netflow_record *record)
 {
-	struct doca_telemetry_netflow_record *tmp_record;
-	/* To avoid memory corruption when flows are destroyed, we copy the pointers to a
-	 *	preallocated pointer inside freelist ring and enqueue it so the main thread
-	 *	can send them.
-	 */
-	if (rte_ring_mc_dequeue(netflow_freelist_ring, (void **)&tmp_record) != 0) {
-		DOCA_LOG_DBG("Placeholder queue is empty");
+	struct netflow_lcore *ctx = netflow_get_lcore();
+
+	if (ctx == NULL)
 		return;
-	}
-	*tmp_record = *record;
-	if (rte_ring_mp_enqueue(netflow_pending_ring, tmp_record) != 0) {
-		DOCA_LOG_DBG("Netflow queue is full");
+	netflow_aggregate_record(ctx, record);
+	netflow_put_lcore(ctx);
+}
+
+void
+netflow_lcore_poll(void)
+{
+	struct netflow_lcore *ctx = netflow_get_lcore();
+
+	if (ctx == NULL)
 		return;
+	netflow_expire_flows(ctx, NETFLOW_POLL_SCAN_STEP, netflow_now_ms());
+	netflow_put_lcore(ctx);
+}
+
+doca_error_t
+netflow_lcore_flush(void)
+{
+	struct netflow_lcore *ctx = netflow_get_lcore();
+	doca_error_t result = DOCA_SUCCESS;
+	uint64_t now_ms;
+	uint32_t idx = 0;
+
+	if (ctx == NULL)
+		return DOCA_ERROR_BAD_STATE;
+	now_ms = netflow_now_ms();
+	/* A removal may move a flow back to a slot already passed, go around until the cache is empty */
+	while (ctx->nb_flows > 0) {
+		if (!ctx->flows[idx].used) {
+			idx = (idx + 1) & ctx->cache_mask;
+			continue;
+		}
+		/* Keep the flows until the sender gives back a batch */
+		if (ctx->batch == NULL && rte_ring_sc_dequeue(ctx->free_ring, (void **)&ctx->batch) != 0) {
+			result = DOCA_ERROR_AGAIN;
+			break;
+		}
+		netflow_export_flow(ctx, &ctx->flows[idx], now_ms);
+		netflow_remove_flow(ctx, idx);
 	}
+	if (ctx->batch != NULL && ctx->batch->nb_records > 0)
+		netflow_push_batch(ctx);
+	netflow_put_lcore(ctx);
+	return result;
+}
+
+void
+netflow_get_stats(struct netflow_stats *stats)
+{
+	struct netflow_lcore *ctx;
+	unsigned int lcore_id;
+
+	memset(stats, 0, sizeof(*stats));
+	for (lcore_id = 0; lcore_id <= RTE_MAX_LCORE; lcore_id++) {
+		ctx = netflow_lcores[lcore_id];
+		if (ctx == NULL)
+			continue;
+		stats->records += ctx->nb_records;
+		stats->exported += ctx->nb_exported;
+		stats->dropped += ctx->nb_dropped;
+	}
+	stats->sent = netflow_sent_records;
+	stats->send_failed = netflow_failed_records;
+}
+
+/*
+ * Free the flow caches and log their counters
+ */
+static void
+destroy_netflow_lcores(void)
+{
+	struct netflow_lcore *ctx;
+	unsigned int lcore_id;
+
+	for (lcore_id = 0; lcore_id <= RTE_MAX_LCORE; lcore_id++) {
+		ctx = netflow_lcores[lcore_id];
+		if (ctx == NULL)
+			continue;
+		if (ctx->nb_records > 0)
+			DOCA_LOG_DBG("Netflow lcore %u: %" PRIu64 " records, %" PRIu64 " flows exported, %" PRIu64
+				     " flows dropped", lcore_id,
+				     ctx->nb_records, ctx->nb_exported, ctx->nb_dropped);
+		rte_ring_free(ctx->pending_ring);
+		rte_ring_free(ctx->free_ring);
+		rte_free(ctx->batches_records);
+		rte_free(ctx->batches_ptrs);
+		rte_free(ctx->batches);
+		rte_free(ctx->flows);
+		rte_free(ctx);
+		netflow_lcores[lcore_id] = NULL;
+	}
+	DOCA_LOG_DBG("Netflow records sent: %" PRIu64 ", failed to send: %" PRIu64, netflow_sent_records,
+		     netflow_failed_records);
+}
+
+/*
+ * Allocate the flow cache and export queues of an lcore
+ *
+ * @lcore_id [in]: lcore id, NETFLOW_SHARED_CTX for the threads that are not EAL lcores
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+init_netflow_lcore(unsigned int lcore_id)
+{
+	int socket_id = lcore_id == NETFLOW_SHARED_CTX ? SOCKET_ID_ANY : (int)rte_lcore_to_socket_id(lcore_id);
+	unsigned int ring_flags = RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ;
+	uint32_t batch_size = netflow_cfg.batch_size;
+	char ring_name[RTE_RING_NAMESIZE];
+	struct netflow_batch *batch;
+	struct netflow_lcore *ctx;
+	uint32_t i, j;
+
+	ctx = rte_zmalloc_socket(NULL, sizeof(*ctx), RTE_CACHE_LINE_SIZE, socket_id);
+	if (ctx == NULL)
+		return DOCA_ERROR_NO_MEMORY;
+	netflow_lcores[lcore_id] = ctx;
+	rte_spinlock_init(&ctx->lock);
+	ctx->cache_mask = netflow_cfg.cache_size - 1;
+	ctx->max_flows = netflow_cfg.cache_size / 4 * 3;
+	ctx->nb_batches = netflow_cfg.queue_size / batch_size;
+
+	ctx->flows = rte_zmalloc_socket(NULL, sizeof(*ctx->flows) * netflow_cfg.cache_size, RTE_CACHE_LINE_SIZE,
+					socket_id);
+	ctx->batches = rte_zmalloc_socket(NULL, sizeof(*ctx->batches) * ctx->nb_batches, RTE_CACHE_LINE_SIZE,
+					  socket_id);
+	ctx->batches_ptrs = rte_zmalloc_socket(NULL, sizeof(*ctx->batches_ptrs) * netflow_cfg.queue_size,
+					       RTE_CACHE_LINE_SIZE, socket_id);
+	ctx->batches_records = rte_zmalloc_socket(NULL, netflow_record_size * netflow_cfg.queue_size,
+						  RTE_CACHE_LINE_SIZE, socket_id);
+	snprintf(ring_name, sizeof(ring_name), "netflow_pending_%u", lcore_id);
+	ctx->pending_ring = rte_ring_create(ring_name, ctx->nb_batches, socket_id, ring_flags);
+	snprintf(ring_name, sizeof(ring_name), "netflow_free_%u", lcore_id);
+	ctx->free_ring = rte_ring_create(ring_name, ctx->nb_batches, socket_id, ring_flags);
+	if (ctx->flows == NULL || ctx->batches == NULL || ctx->batches_ptrs == NULL || ctx->batches_records == NULL ||
+	    ctx->pending_ring == NULL || ctx->free_ring == NULL)
+		return DOCA_ERROR_NO_MEMORY;
+
+	for (i = 0; i < ctx->nb_batches; i++) {
+		batch = &ctx->batches[i];
+		batch->ptrs = ctx->batches_ptrs + i * batch_size;
+		batch->records = ctx->batches_records + i * batch_size * netflow_record_size;
+		for (j = 0; j < batch_size; j++)
+			batch->ptrs[j] = batch->records + j * netflow_record_size;
+		if (rte_ring_sp_enqueue(ctx->free_ring, batch) != 0)
+			return DOCA_ERROR_NO_MEMORY;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Check a Netflow exporter configuration
+ *
+ * @cfg [in]: configuration
+ * @return: DOCA_SUCCESS if it is valid and DOCA_ERROR_INVALID_VALUE otherwise
+ */
+static doca_error_t
+check_netflow_cfg(const struct netflow_cfg *cfg)
+{
+	struct in_addr addr;
+
+	/* A host name would need a blocking DNS lookup */
+	if (cfg->collector_addr[0] != '\0' && inet_pton(AF_INET, cfg->collector_addr, &addr) != 1) {
+		DOCA_LOG_ERR("Netflow collector address \"%s\" is not an IPv4 address", cfg->collector_addr);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (cfg->collector_addr[0] == '\0' && !cfg->ipc_enabled) {
+		DOCA_LOG_ERR("Netflow needs a collector or IPC export");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (cfg->template_type != NETFLOW_TEMPLATE_FULL && cfg->template_type != NETFLOW_TEMPLATE_IPV4) {
+		DOCA_LOG_ERR("Invalid Netflow template %d", cfg->template_type);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (cfg->cache_size < NETFLOW_MIN_CACHE_SIZE || cfg->cache_size > NETFLOW_MAX_CACHE_SIZE ||
+	    (cfg->cache_size & (cfg->cache_size - 1)) != 0) {
+		DOCA_LOG_ERR("Netflow cache size must be a power of 2 between %u and %u", NETFLOW_MIN_CACHE_SIZE,
+			     NETFLOW_MAX_CACHE_SIZE);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (cfg->batch_size == 0 || cfg->queue_size > NETFLOW_MAX_QUEUE_SIZE || cfg->queue_size < cfg->batch_size ||
+	    cfg->queue_size % cfg->batch_size != 0) {
+		DOCA_LOG_ERR("Netflow queue size must be a multiple of the batch size, up to %u",
+			     NETFLOW_MAX_QUEUE_SIZE);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (cfg->active_timeout_ms == 0 || cfg->inactive_timeout_ms == 0) {
+		DOCA_LOG_ERR("Netflow timeouts must not be 0");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
 }
 
 void
 destroy_netflow_schema_and_source(void)
 {
-	rte_ring_free(netflow_pending_ring);
-	rte_ring_free(netflow_freelist_ring);
+	destroy_netflow_lcores();
 
 	doca_telemetry_netflow_destroy();
 
 }
 
+void
+netflow_default_cfg(struct netflow_cfg *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	strlcpy(cfg->collector_addr, NETFLOW_COLLECTOR_ADDR, sizeof(cfg->collector_addr));
+	cfg->collector_port = DOCA_NETFLOW_DEFAULT_PORT;
+	cfg->ipc_enabled = true;
+	cfg->template_type = NETFLOW_TEMPLATE_FULL;
+	cfg->queue_size = NETFLOW_QUEUE_SIZE;
+	cfg->batch_size = NETFLOW_EXPORT_BATCH;
+	cfg->cache_size = NETFLOW_CACHE_SIZE;
+	cfg->active_timeout_ms = NETFLOW_ACTIVE_TIMEOUT_MS;
+	cfg->inactive_timeout_ms = NETFLOW_INACTIVE_TIMEOUT_MS;
+	cfg->batch_timeout_ms = NETFLOW_BATCH_TIMEOUT_MS;
+}
+
 doca_error_t
 init_netflow_schema_and_source(uint8_t id, char *source_tag)
+{
+	struct netflow_cfg cfg;
+
+	netflow_default_cfg(&cfg);
+	return init_netflow_exporter(id, source_tag, &cfg);
+}
+
+doca_error_t
+init_netflow_exporter(uint8_t id, char *source_tag, const struct netflow_cfg *cfg)
 {
 	doca_error_t result;
-	int i;
+	unsigned int lcore_id;
 	char hostname[64];
-	char *bluefield_rshim = "192.168.100.1";
+
+	result = check_netflow_cfg(cfg);
+	if (result != DOCA_SUCCESS)
+		return result;
+	netflow_cfg = *cfg;
+	netflow_record_size = cfg->template_type == NETFLOW_TEMPLATE_IPV4 ? sizeof(struct netflow_ipv4_record) :
+									   sizeof(struct doca_telemetry_netflow_record);
 
 	result = doca_telemetry_netflow_template_create(&netflow_template);
 	if (result != DOCA_SUCCESS)
 		return result;
 
-	result = init_template_fields();
+	result = init_template_fields(cfg->template_type);
 	if (result != DOCA_SUCCESS)
 		return result;
 
@@ -235,16 +788,18 @@ init_netflow_schema_and_source(uint8_t id, char *source_tag)
 		return result;
 	}
 
-	doca_telemetry_netflow_set_ipc_enabled();
-
-	/* Setting the Netflow collector is recommended for debugging only - use DTS otherwise,
-	 * Default PORT is 2055
-	 */
-	doca_telemetry_netflow_set_collector_addr(bluefield_rshim);
-
+	if (cfg->ipc_enabled)
+		doca_telemetry_netflow_set_ipc_enabled();
 
+	/* Setting the Netflow collector is recommended for debugging only - use DTS otherwise */
+	if (cfg->collector_addr[0] != '\0') {
+		doca_telemetry_netflow_set_collector_addr(cfg->collector_addr);
+		doca_telemetry_netflow_set_collector_port(cfg->collector_port);
+	}
+	if (cfg->max_packet_size != 0)
+		doca_telemetry_netflow_set_max_packet_size(cfg->max_packet_size);
 
-	result = get_hostname_ip(hostname);
+	result = get_hostname(hostname);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Getting hostname failed");
 		doca_telemetry_netflow_destroy();
@@ -260,23 +815,26 @@ init_netflow_schema_and_source(uint8_t id, char *source_tag)
 		doca_telemetry_netflow_destroy();
 		return result;
 	}
-	/* In the Netflow ring scenario, a producer-consumer solution is given where the dpi_worker threads produce
-	 * records and enqueues them to a rings struct. The records are consumed by the main thread that dequeues
-	 * the records and sends them. This allows avoiding collisions between thread and memory corruption issues.
+	/* In the Netflow ring scenario, a producer-consumer solution is given where the dpi_worker threads aggregate
+	 * records in a flow cache of their lcore and export the flows in batches over single producer single consumer
+	 * rings. The batches are consumed by the main thread that sends them and gives them back to the lcores.
 	 */
-	netflow_pending_ring = rte_ring_create("netflow_queue", NETFLOW_QUEUE_SIZE, SOCKET_ID_ANY, RING_F_SC_DEQ);
-	netflow_freelist_ring =	rte_ring_create("placeholder_netflow_queue", NETFLOW_QUEUE_SIZE, SOCKET_ID_ANY,
-													RING_F_SP_ENQ);
-	if (netflow_pending_ring == NULL || netflow_freelist_ring == NULL) {
-		doca_telemetry_netflow_destroy();
-		return DOCA_ERROR_NO_MEMORY;
+	netflow_start_cycles = rte_get_timer_cycles();
+	netflow_cycles_per_ms = RTE_MAX(rte_get_timer_hz() / 1000, (uint64_t)1);
+	netflow_sent_records = 0;
+	netflow_failed_records = 0;
+	RTE_LCORE_FOREACH(lcore_id) {
+		result = init_netflow_lcore(lcore_id);
+		if (result != DOCA_SUCCESS)
+			break;
 	}
-	for (i = 0; i < NETFLOW_QUEUE_SIZE; i++)
-		data_to_send_ptr[i] = &data_to_send[i];
-	if (rte_ring_enqueue_bulk(netflow_freelist_ring, (void **)data_to_send_ptr, NETFLOW_QUEUE_SIZE - 1, NULL) !=
-					NETFLOW_QUEUE_SIZE - 1) {
+	if (result == DOCA_SUCCESS)
+		result = init_netflow_lcore(NETFLOW_SHARED_CTX);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to allocate the Netflow flow caches");
+		destroy_netflow_lcores();
 		doca_telemetry_netflow_destroy();
-		return DOCA_ERROR_NO_MEMORY;
+		return result;
 	}
 
 	return DOCA_SUCCESS;
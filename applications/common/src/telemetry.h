@@ -14,8 +14,10 @@
 #ifndef COMMON_TELEMETRY_H_
 #define COMMON_TELEMETRY_H_
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <netinet/in.h>
 
 #include <rte_ring.h>
 
@@ -25,7 +27,46 @@
 extern "C" {
 #endif
 
-#define NETFLOW_QUEUE_SIZE 1024		/* Netflow queue size */
+#define NETFLOW_COLLECTOR_ADDR "192.168.100.1" /* Default collector, the host side of the BlueField rshim */
+#define NETFLOW_QUEUE_SIZE 4096		/* Default Netflow records waiting to be sent, per lcore */
+#define NETFLOW_EXPORT_BATCH 128	/* Default Netflow records handed over to the sender at once */
+#define NETFLOW_CACHE_SIZE (1 << 15)	/* Default flows aggregated per lcore, power of 2 */
+#define NETFLOW_ACTIVE_TIMEOUT_MS 60000	/* Default time after which flows are exported even if they are active */
+#define NETFLOW_INACTIVE_TIMEOUT_MS 15000 /* Default time after which flows without records are exported */
+#define NETFLOW_BATCH_TIMEOUT_MS 1000	/* Default time after which a partial batch is handed over to the sender */
+#define NETFLOW_MIN_CACHE_SIZE 64	/* Smallest flow cache */
+#define NETFLOW_MAX_CACHE_SIZE (1 << 24)	/* Largest flow cache */
+#define NETFLOW_MAX_QUEUE_SIZE (1 << 20)	/* Largest number of Netflow records waiting to be sent, per lcore */
+
+/* Netflow template of the exported records */
+enum netflow_template_type {
+	NETFLOW_TEMPLATE_FULL,	/* struct doca_telemetry_netflow_record, IPv4 and IPv6 flows */
+	NETFLOW_TEMPLATE_IPV4,	/* struct netflow_ipv4_record, IPv4 flows, about a third of the export volume */
+};
+
+/* Netflow exporter configuration, see netflow_default_cfg() for the defaults */
+struct netflow_cfg {
+	char collector_addr[INET_ADDRSTRLEN];	/* Collector IPv4 address, empty to export to DTS over IPC only */
+	uint16_t collector_port;		/* Collector UDP port */
+	uint16_t max_packet_size;		/* Largest Netflow packet, 0 for the library default */
+	bool ipc_enabled;			/* Export to DTS over IPC */
+	enum netflow_template_type template_type; /* Template of the exported records */
+	uint32_t queue_size;			/* Records waiting to be sent per lcore, multiple of batch_size */
+	uint32_t batch_size;			/* Records handed over to the sender at once */
+	uint32_t cache_size;			/* Flows aggregated per lcore, power of 2 */
+	uint32_t active_timeout_ms;		/* Flows are exported after this time even if they are active */
+	uint32_t inactive_timeout_ms;		/* Flows are exported after this time without records */
+	uint32_t batch_timeout_ms;		/* A partial batch is handed over to the sender after this time */
+};
+
+/* Netflow exporter counters */
+struct netflow_stats {
+	uint64_t records;	/* Records aggregated by the lcores */
+	uint64_t exported;	/* Flows exported by the lcores */
+	uint64_t dropped;	/* Flows dropped by the lcores because the export queue was full */
+	uint64_t sent;		/* Records sent */
+	uint64_t send_failed;	/* Records dropped because they failed to be sent */
+};
 
 /* Netflow record, should match the fields initialized in doca_telemetry_netflow_init */
 struct __attribute__((packed)) doca_telemetry_netflow_record {
@@ -54,28 +95,79 @@ struct __attribute__((packed)) doca_telemetry_netflow_record {
 	char application_name[DOCA_TELEMETRY_NETFLOW_APPLICATION_NAME_DEFAULT_LENGTH]; /* Name associated with a classification*/
 };
 
+/* Netflow record of the NETFLOW_TEMPLATE_IPV4 template */
+struct __attribute__((packed)) netflow_ipv4_record {
+	__be32 src_addr_v4;	/* Source IPV4 Address */
+	__be32 dst_addr_v4;	/* Destination IPV4 Address */
+	__be16 input;		/* Input interface index */
+	__be16 output;		/* Output interface index */
+	__be16 src_port;	/* TCP/UDP source port number or equivalent */
+	__be16 dst_port;	/* TCP/UDP destination port number or equivalent */
+	uint8_t tcp_flags;	/* Cumulative OR of tcp flags */
+	uint8_t protocol;	/* IP protocol type (for example, TCP = 6;UDP = 17) */
+	uint8_t tos;		/* IP Type-of-Service */
+	__be32 d_pkts;		/* Packets sent in Duration */
+	__be32 d_octets;	/* Octets sent in Duration */
+	__be32 first;		/* SysUptime at start of flow */
+	__be32 last;		/* and of last packet of flow */
+};
+
 /*
- * Send Netflow records available in the pending queue
+ * Send the Netflow records exported by the lcores
+ * Must be called periodically, always from the same thread
  *
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 doca_error_t send_netflow_record(void);
 
 /*
- * Enqueues a single Netflow record to the pending queue
- * This function can be used as callback function to the DPI Worker and is MP safe
+ * Aggregate a Netflow record into the flow cache of the calling lcore
+ * The records of a flow are merged by 5-tuple: d_pkts and d_octets are added, tcp_flags are ORed and first and last
+ * are set from the exporter uptime, the other fields are taken from the last record. A flow is exported when it ends
+ * with a TCP FIN or RST, when it is idle for the inactive timeout or after the active timeout.
+ * This function can be used as callback function to the DPI Worker and is MP safe, threads that are not EAL lcores
+ * share a cache protected by a lock
  *
- * @record [in]: Netflow record to be enqueued
+ * @record [in]: Netflow record to be aggregated
  */
 void enqueue_netflow_record_to_ring(const struct doca_telemetry_netflow_record *record);
 
+/*
+ * Export the expired flows of the calling lcore and hand over its partial batch once it is old enough
+ * Should be called periodically by lcores that may stop aggregating records, e.g. when they are idle
+ */
+void netflow_lcore_poll(void);
+
+/*
+ * Export all the flows of the calling lcore and hand over its partial batch, e.g. before the lcore exits
+ *
+ * @return: DOCA_SUCCESS when the cache is empty, DOCA_ERROR_AGAIN if the export queue is full and the function should
+ * be called again once the records were sent, and DOCA_ERROR otherwise
+ */
+doca_error_t netflow_lcore_flush(void);
+
 /*
  * Destroy the Netflow telemetry resources
  */
 void destroy_netflow_schema_and_source(void);
 
 /*
- * Initialize the Netflow telemetry resources
+ * Get the Netflow exporter counters
+ * The lcores counters are read without synchronization, they are exact only once the lcores stopped
+ *
+ * @stats [out]: counters
+ */
+void netflow_get_stats(struct netflow_stats *stats);
+
+/*
+ * Fill a Netflow exporter configuration with the defaults
+ *
+ * @cfg [out]: configuration
+ */
+void netflow_default_cfg(struct netflow_cfg *cfg);
+
+/*
+ * Initialize the Netflow telemetry resources with the default configuration
  *
  * @id [in]: Netflow source id
  * @source_tag [in]: Netflow source tag
@@ -83,6 +175,16 @@ void destroy_netflow_schema_and_source(void);
  */
 doca_error_t init_netflow_schema_and_source(uint8_t id, char *source_tag);
 
+/*
+ * Initialize the Netflow telemetry resources
+ *
+ * @id [in]: Netflow source id
+ * @source_tag [in]: Netflow source tag
+ * @cfg [in]: exporter configuration
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t init_netflow_exporter(uint8_t id, char *source_tag, const struct netflow_cfg *cfg);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
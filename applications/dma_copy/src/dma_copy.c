@@ -44,6 +44,8 @@ main(int argc, char **argv)
 #ifdef DOCA_ARCH_DPU
 	dma_cfg.mode = DMA_COPY_MODE_DPU;
 #endif
+	dma_cfg.chunk_size = DMA_ENGINE_DEFAULT_CHUNK_SIZE;
+	dma_cfg.nb_tasks = DMA_ENGINE_DEFAULT_TASKS;
 
 	/* Register a logger backend */
 	result = doca_log_backend_create_standard();
@@ -78,6 +80,13 @@ main(int argc, char **argv)
 		goto destroy_argp;
 	}
 
+	if (dma_cfg.loopback_path[0] != '\0') {
+		result = loopback_start_dma_copy(&dma_cfg);
+		if (result != DOCA_SUCCESS)
+			exit_status = EXIT_FAILURE;
+		goto destroy_argp;
+	}
+
 	result = init_cc(&dma_cfg, &ep, &cc_dev, &cc_dev_rep);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to Initiate Comm Channel");
@@ -16,6 +16,7 @@
 #include <time.h>
 #include <netinet/in.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <sys/epoll.h>
 #include <unistd.h>
 
@@ -114,11 +115,21 @@ args_validation_callback(void *config)
 {
 	struct dma_copy_cfg *cfg = (struct dma_copy_cfg *)config;
 
+	if (cfg->loopback_path[0] == '\0' && cfg->cc_dev_pci_addr[0] == '\0') {
+		DOCA_LOG_ERR("Comm Channel device PCI address is required without loopback");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
 	if (access(cfg->file_path, F_OK | R_OK) == 0) {
 		cfg->is_file_found_locally = true;
 		return validate_file_size(cfg->file_path, &cfg->file_size);
 	}
 
+	if (cfg->loopback_path[0] != '\0') {
+		DOCA_LOG_ERR("File %s to copy in loopback was not found", cfg->file_path);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
 	return DOCA_SUCCESS;
 }
 
@@ -169,6 +180,72 @@ file_path_callback(void *param, void *config)
 	return DOCA_SUCCESS;
 }
 
+/*
+ * ARGP Callback - Handle chunk size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+chunk_size_callback(void *param, void *config)
+{
+	struct dma_copy_cfg *cfg = (struct dma_copy_cfg *)config;
+	int *chunk_size = (int *)param;
+
+	if (*chunk_size < DMA_ENGINE_MIN_CHUNK_SIZE || *chunk_size > DMA_ENGINE_MAX_CHUNK_SIZE) {
+		DOCA_LOG_ERR("Chunk size must be between %d and %d bytes", DMA_ENGINE_MIN_CHUNK_SIZE,
+			     DMA_ENGINE_MAX_CHUNK_SIZE);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->chunk_size = *chunk_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle number of DMA tasks parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+tasks_callback(void *param, void *config)
+{
+	struct dma_copy_cfg *cfg = (struct dma_copy_cfg *)config;
+	int *nb_tasks = (int *)param;
+
+	if (*nb_tasks <= 0 || *nb_tasks > DMA_ENGINE_MAX_TASKS) {
+		DOCA_LOG_ERR("Number of DMA tasks must be between 1 and %d", DMA_ENGINE_MAX_TASKS);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->nb_tasks = *nb_tasks;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle loopback path parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+loopback_path_callback(void *param, void *config)
+{
+	struct dma_copy_cfg *cfg = (struct dma_copy_cfg *)config;
+	char *loopback_path = (char *)param;
+
+	if (strnlen(loopback_path, MAX_ARG_SIZE) == MAX_ARG_SIZE) {
+		DOCA_LOG_ERR("Entered loopback path exceeded buffer size - MAX=%d", MAX_ARG_SIZE - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	strlcpy(cfg->loopback_path, loopback_path, MAX_ARG_SIZE);
+
+	return DOCA_SUCCESS;
+}
+
 /*
  * ARGP Callback - Handle Comm Channel DOCA device representor PCI address parameter
  *
@@ -263,59 +340,163 @@ send_status_msg(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr
 }
 
 /*
- * Save remote buffer information into a file
+ * Get the current time
  *
- * @cfg [in]: Application configuration
- * @buffer [in]: Buffer to read information from
+ * @return: monotonic time in nanoseconds
+ */
+static uint64_t
+now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Log the throughput of a copy
+ *
+ * @what [in]: copy description
+ * @bytes [in]: bytes copied
+ * @start [in]: start time of the copy, in nanoseconds
+ */
+static void
+log_throughput(const char *what, uint64_t bytes, uint64_t start)
+{
+	double elapsed = (now_ns() - start) / 1e9;
+
+	DOCA_LOG_INFO("%s %" PRIu64 " bytes in %.3f ms: %.2f GB/s", what, bytes, elapsed * 1e3,
+		      elapsed > 0 ? bytes / elapsed / 1e9 : 0);
+}
+
+/*
+ * Read a chunk of the file
+ *
+ * @fd [in]: file descriptor
+ * @buf [out]: chunk
+ * @len [in]: chunk length
+ * @offset [in]: chunk offset in the file
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-save_buffer_into_a_file(struct dma_copy_cfg *cfg, const char *buffer)
+read_chunk(int fd, uint8_t *buf, size_t len, uint64_t offset)
 {
-	FILE *fp;
-
-	fp = fopen(cfg->file_path, "w");
-	if (fp == NULL) {
-		DOCA_LOG_ERR("Failed to create the DMA copy file");
-		return DOCA_ERROR_IO_FAILED;
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = pread(fd, buf, len, offset);
+		if (ret <= 0) {
+			if (ret < 0 && errno == EINTR)
+				continue;
+			DOCA_LOG_ERR("Failed to read the file at offset %" PRIu64, offset);
+			return DOCA_ERROR_IO_FAILED;
+		}
+		buf += ret;
+		len -= ret;
+		offset += ret;
 	}
+	return DOCA_SUCCESS;
+}
 
-	if (fwrite(buffer, 1, cfg->file_size, fp) != cfg->file_size) {
-		DOCA_LOG_ERR("Failed to write full content into the output file");
-		fclose(fp);
-		return DOCA_ERROR_IO_FAILED;
+/*
+ * Write a chunk of the file
+ *
+ * @fd [in]: file descriptor
+ * @buf [in]: chunk
+ * @len [in]: chunk length
+ * @offset [in]: chunk offset in the file
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+write_chunk(int fd, const uint8_t *buf, size_t len, uint64_t offset)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = pwrite(fd, buf, len, offset);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			DOCA_LOG_ERR("Failed to write the file at offset %" PRIu64 ": %s", offset, strerror(errno));
+			return DOCA_ERROR_IO_FAILED;
+		}
+		buf += ret;
+		len -= ret;
+		offset += ret;
 	}
-
-	fclose(fp);
-
 	return DOCA_SUCCESS;
 }
 
 /*
- * Fill local buffer with file content
+ * Send progress message
  *
- * @cfg [in]: Application configuration
- * @buffer [out]: Buffer to save information into
+ * @ep [in]: Comm Channel endpoint
+ * @peer_addr [in]: Comm Channel peer address
+ * @offset [in]: Bytes ready from the start of the file
+ * @wait [in]: Retry while the send queue is full, otherwise return DOCA_ERROR_AGAIN
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-fill_buffer_with_file_content(struct dma_copy_cfg *cfg, char *buffer)
+send_progress_msg(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr, uint64_t offset,
+		  bool wait)
 {
-	FILE *fp;
+	struct cc_msg_dma_progress progress_msg = {
+		.offset = htonq(offset),
+	};
+	doca_error_t result;
+	struct timespec ts = {
+		.tv_nsec = SLEEP_IN_NANOS,
+	};
 
-	fp = fopen(cfg->file_path, "r");
-	if (fp == NULL) {
-		DOCA_LOG_ERR("Failed to open %s", cfg->file_path);
-		return DOCA_ERROR_IO_FAILED;
+	while ((result = doca_comm_channel_ep_sendto(ep, &progress_msg, sizeof(progress_msg), DOCA_CC_MSG_FLAG_NONE,
+						     *peer_addr)) == DOCA_ERROR_AGAIN && wait)
+		nanosleep(&ts, &ts);
+
+	if (result != DOCA_SUCCESS && result != DOCA_ERROR_AGAIN)
+		DOCA_LOG_ERR("Failed to send progress message: %s", doca_error_get_descr(result));
+
+	return result;
+}
+
+/*
+ * Receive progress message, without waiting
+ *
+ * @ep [in]: Comm Channel endpoint
+ * @peer_addr [in]: Comm Channel peer address
+ * @file_size [in]: File size in bytes, the largest valid offset
+ * @offset [in/out]: Bytes ready from the start of the file, updated when a progress message is received
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_AGAIN when no message is pending and DOCA_ERROR otherwise
+ */
+static doca_error_t
+recv_progress_msg(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr,
+		  uint64_t file_size, uint64_t *offset)
+{
+	struct cc_msg_dma_progress progress_msg;
+	size_t msg_len = sizeof(progress_msg);
+	uint64_t received_offset;
+	doca_error_t result;
+
+	result = doca_comm_channel_ep_recvfrom(ep, (void *)&progress_msg, &msg_len, DOCA_CC_MSG_FLAG_NONE,
+					       peer_addr);
+	if (result == DOCA_ERROR_AGAIN)
+		return result;
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Progress message was not received: %s", doca_error_get_descr(result));
+		return result;
 	}
 
-	/* Read file content and store it in the local buffer which will be exported */
-	if (fread(buffer, 1, cfg->file_size, fp) != cfg->file_size) {
-		DOCA_LOG_ERR("Failed to read content from file: %s", cfg->file_path);
-		fclose(fp);
-		return DOCA_ERROR_IO_FAILED;
+	/* A status message in the middle of the copy means the peer stopped it */
+	if (msg_len == sizeof(struct cc_msg_dma_status)) {
+		DOCA_LOG_ERR("Peer stopped the copy");
+		return DOCA_ERROR_INVALID_VALUE;
 	}
-	fclose(fp);
+
+	received_offset = ntohq(progress_msg.offset);
+	if (msg_len != sizeof(progress_msg) || received_offset < *offset || received_offset > file_size) {
+		DOCA_LOG_ERR("Invalid progress message received");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	*offset = received_offset;
 
 	return DOCA_SUCCESS;
 }
@@ -541,24 +722,165 @@ host_send_addr_and_offset(const char *src_buffer, size_t src_buffer_size, struct
 	return result;
 }
 
+/*
+ * Host side function to exchange progress messages with the DPU until the DPU reported an offset, the Host offset is
+ * sent meanwhile without waiting for room in the send queue
+ *
+ * @ep [in]: Comm Channel endpoint
+ * @peer_addr [in]: Comm Channel peer address
+ * @file_size [in]: File size in bytes, the largest valid offset
+ * @local [in]: Bytes of the file the Host is done with
+ * @sent [in/out]: Host offset last sent to the DPU
+ * @remote [in/out]: Offset last reported by the DPU
+ * @target [in]: DPU offset to wait for
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+host_sync_progress(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr,
+		   uint64_t file_size, uint64_t local, uint64_t *sent, uint64_t *remote, uint64_t target)
+{
+	struct timespec ts = {
+		.tv_nsec = SLEEP_IN_NANOS,
+	};
+	doca_error_t result;
+
+	while (true) {
+		/* The DPU only needs the last offset, it is sent again later when the send queue is full */
+		if (*sent < local) {
+			result = send_progress_msg(ep, peer_addr, local, false);
+			if (result == DOCA_SUCCESS)
+				*sent = local;
+			else if (result != DOCA_ERROR_AGAIN)
+				return result;
+		}
+		if (*remote >= target)
+			return DOCA_SUCCESS;
+
+		result = recv_progress_msg(ep, peer_addr, file_size, remote);
+		if (result == DOCA_ERROR_AGAIN)
+			nanosleep(&ts, &ts);
+		else if (result != DOCA_SUCCESS)
+			return result;
+	}
+}
+
+/*
+ * Host side function to read the file into the ring buffer in chunks, telling the DPU after every chunk that it can
+ * DMA it, a chunk is read once the DPU reported it DMA read the previous content of its ring space
+ *
+ * @cfg [in]: Application configuration
+ * @buffer [out]: Ring buffer exported to the DPU
+ * @ring_len [in]: Ring buffer length
+ * @ep [in]: Comm Channel endpoint
+ * @peer_addr [in]: Comm Channel peer address
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+host_send_file_chunks(struct dma_copy_cfg *cfg, char *buffer, size_t ring_len, struct doca_comm_channel_ep_t *ep,
+		      struct doca_comm_channel_addr_t **peer_addr)
+{
+	uint64_t offset, sent = 0, consumed = 0;
+	size_t len, ring_offset;
+	doca_error_t result = DOCA_SUCCESS;
+	int fd;
+
+	fd = open(cfg->file_path, O_RDONLY);
+	if (fd < 0) {
+		DOCA_LOG_ERR("Failed to open %s", cfg->file_path);
+		send_status_msg(ep, peer_addr, STATUS_FAILURE);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	for (offset = 0; offset < cfg->file_size; offset += len) {
+		ring_offset = offset % ring_len;
+		len = MIN(MIN(cfg->chunk_size, cfg->file_size - offset), ring_len - ring_offset);
+
+		/* The ring space of the chunk is free once the DPU DMA read the chunk a ring length before it */
+		result = host_sync_progress(ep, peer_addr, cfg->file_size, offset, &sent, &consumed,
+					    offset + len > ring_len ? offset + len - ring_len : 0);
+		if (result != DOCA_SUCCESS)
+			goto close_file;
+
+		result = read_chunk(fd, (uint8_t *)buffer + ring_offset, len, offset);
+		if (result != DOCA_SUCCESS) {
+			send_status_msg(ep, peer_addr, STATUS_FAILURE);
+			goto close_file;
+		}
+	}
+
+	/* Wait for the DPU to DMA read the whole file, its status message follows */
+	result = host_sync_progress(ep, peer_addr, cfg->file_size, cfg->file_size, &sent, &consumed, cfg->file_size);
+
+close_file:
+	close(fd);
+	return result;
+}
+
+/*
+ * Host side function to write the ring buffer into the file as the DPU reports the chunks it DMA wrote, telling the
+ * DPU which ring space it can DMA write again
+ *
+ * @cfg [in]: Application configuration
+ * @buffer [in]: Ring buffer exported to the DPU
+ * @ring_len [in]: Ring buffer length
+ * @ep [in]: Comm Channel endpoint
+ * @peer_addr [in]: Comm Channel peer address
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+host_recv_file_chunks(struct dma_copy_cfg *cfg, const char *buffer, size_t ring_len,
+		      struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr)
+{
+	uint64_t written = 0, sent = 0, ready = 0;
+	size_t len, ring_offset;
+	doca_error_t result = DOCA_SUCCESS;
+	int fd;
+
+	fd = open(cfg->file_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		DOCA_LOG_ERR("Failed to create the DMA copy file");
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	DOCA_LOG_INFO("Writing DMA buffer into a file on %s", cfg->file_path);
+	while (written < cfg->file_size) {
+		result = host_sync_progress(ep, peer_addr, cfg->file_size, written, &sent, &ready, written + 1);
+		if (result != DOCA_SUCCESS)
+			break;
+
+		/* The bytes ready may wrap around the end of the ring */
+		while (written < ready) {
+			ring_offset = written % ring_len;
+			len = MIN(ready - written, ring_len - ring_offset);
+			result = write_chunk(fd, (const uint8_t *)buffer + ring_offset, len, written);
+			if (result != DOCA_SUCCESS)
+				break;
+			written += len;
+		}
+		if (result != DOCA_SUCCESS)
+			break;
+	}
+
+	close(fd);
+	if (result != DOCA_SUCCESS)
+		unlink(cfg->file_path);
+	return result;
+}
+
 /*
  * DPU side function for file size and location negotiation
  *
  * @cfg [in]: Application configuration
  * @ep [in]: Comm Channel endpoint
  * @peer_addr [in]: Comm Channel peer address
- * @max_buf_size [in]: Maximum buffer size
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
 dpu_negotiate_dma_direction_and_size(struct dma_copy_cfg *cfg, struct doca_comm_channel_ep_t *ep,
-				     struct doca_comm_channel_addr_t **peer_addr, uint64_t max_buf_size)
+				     struct doca_comm_channel_addr_t **peer_addr)
 {
 	struct cc_msg_dma_direction host_dma_direction = {0};
 	struct cc_msg_dma_direction dpu_dma_direction = {0};
-	struct cc_msg_dma_status status_msg = {
-		.is_success = false
-	};
 	struct timespec ts = {
 		.tv_nsec = SLEEP_IN_NANOS,
 	};
@@ -616,31 +938,13 @@ dpu_negotiate_dma_direction_and_size(struct dma_copy_cfg *cfg, struct doca_comm_
 		cfg->file_size = ntohq(host_dma_direction.file_size);
 	}
 
-	/* Verify file size against the HW limitation */
-	if (cfg->file_size > max_buf_size) {
-		/* Send failure message to Host */
-		DOCA_LOG_ERR("DMA device maximum allowed file size in bytes is %" PRIu64
-			     ", received file size is %" PRIu64 " bytes",
-			     max_buf_size, cfg->file_size);
-		while ((result = doca_comm_channel_ep_sendto(ep, &status_msg, sizeof(struct cc_msg_dma_status),
-							     DOCA_CC_MSG_FLAG_NONE, *peer_addr)) == DOCA_ERROR_AGAIN)
-			nanosleep(&ts, &ts);
-
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Failed to send failure status message to Host: %s", doca_error_get_descr(result));
-			return result;
-		}
-
-		result = DOCA_ERROR_INVALID_VALUE;
-	} else {
-		/* Send direction message to Host to end negotiation */
-		while ((result = doca_comm_channel_ep_sendto(ep, &dpu_dma_direction, sizeof(struct cc_msg_dma_direction),
-							     DOCA_CC_MSG_FLAG_NONE, *peer_addr)) == DOCA_ERROR_AGAIN)
-			nanosleep(&ts, &ts);
+	/* Send direction message to Host to end negotiation, any file size is copied in chunks */
+	while ((result = doca_comm_channel_ep_sendto(ep, &dpu_dma_direction, sizeof(struct cc_msg_dma_direction),
+						     DOCA_CC_MSG_FLAG_NONE, *peer_addr)) == DOCA_ERROR_AGAIN)
+		nanosleep(&ts, &ts);
 
-		if (result != DOCA_SUCCESS)
-			DOCA_LOG_ERR("Failed to send final negotiation message to Host: %s", doca_error_get_descr(result));
-	}
+	if (result != DOCA_SUCCESS)
+		DOCA_LOG_ERR("Failed to send final negotiation message to Host: %s", doca_error_get_descr(result));
 
 	return result;
 }
@@ -766,101 +1070,276 @@ dpu_receive_addr_and_offset(struct doca_comm_channel_ep_t *ep, struct doca_comm_
 	return result;
 }
 
+/* Chunk of the pipeline in a slot of the chunk engine */
+struct pipeline_slot {
+	uint64_t chunk;				/* Index of the last chunk submitted to the slot */
+	uint64_t offset;			/* File offset of the last chunk submitted to the slot */
+	bool busy;				/* True while the chunk is copied */
+};
+
+/*
+ * Pipeline of a file copied in chunks. Every slot of the chunk engine rotates between file I/O and DMA: a chunk is
+ * read into a free slot then DMA written to the Host, or DMA read from the Host then written into the file on
+ * completion, while the other slots are in flight.
+ * The remote region is a ring, a file offset is copied at the same offset modulo the ring length. The peer reports
+ * the bytes it filled in the ring before they are DMA read, and the bytes it wrote from the ring to the file before
+ * their ring space is DMA written again.
+ */
+struct chunk_pipeline {
+	struct dma_engine *engine;			/* Chunk engine */
+	struct doca_comm_channel_ep_t *ep;		/* Comm Channel endpoint, NULL in loopback */
+	struct doca_comm_channel_addr_t **peer_addr;	/* Comm Channel peer address */
+	int fd;						/* File descriptor */
+	bool to_remote;					/* The file is copied to the remote region */
+	uint64_t file_size;				/* File size in bytes */
+	uint32_t chunk_size;				/* Chunk size */
+	size_t ring_len;				/* Remote region length */
+	uint32_t nb_slots;				/* Chunks in flight */
+	struct pipeline_slot *slots;			/* Chunk of every slot */
+	uint64_t nb_submitted;				/* Chunks submitted */
+	uint64_t submitted;				/* Bytes submitted from the start of the file */
+	uint64_t nb_done;				/* Chunks copied from the start of the file */
+	uint64_t peer_offset;				/* Bytes the peer filled in the ring, or wrote from it */
+	uint64_t reported;				/* Bytes reported to the peer as DMA copied */
+};
+
+/*
+ * Chunk engine callback - write the chunk DMA read from the remote region into the file
+ *
+ * @slot [in]: slot of the chunk
+ * @offset [in]: chunk offset in the remote region
+ * @data [in]: chunk
+ * @len [in]: chunk length
+ * @user_ctx [in]: pipeline
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+chunk_copied_cb(uint32_t slot, uint64_t offset, uint8_t *data, size_t len, void *user_ctx)
+{
+	struct chunk_pipeline *pipeline = (struct chunk_pipeline *)user_ctx;
+
+	(void)offset;
+
+	pipeline->slots[slot].busy = false;
+	if (pipeline->to_remote)
+		return DOCA_SUCCESS;
+	return write_chunk(pipeline->fd, data, len, pipeline->slots[slot].offset);
+}
+
 /*
- * DPU side function for submitting DMA task into the progress engine, wait for its completion and save it into a file
- * if needed.
+ * Report to the peer the bytes DMA copied from the start of the file, DMA written to the ring or DMA read from it
  *
- * @cfg [in]: Application configuration
- * @resources [in]: DMA copy resources
- * @bytes_to_copy [in]: Number of bytes to DMA copy
- * @buffer [in]: local DMA buffer
- * @local_doca_buf [in]: local DOCA buffer
- * @remote_doca_buf [in]: remote DOCA buffer
- * @num_remaining_tasks [in]: Number of remaining tasks
+ * @pipeline [in]: pipeline
+ * @wait [in]: wait until the report is sent, otherwise it is retried on the next call when the send queue is full
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-dpu_submit_dma_task(struct dma_copy_cfg *cfg, struct dma_copy_resources *resources, size_t bytes_to_copy, char *buffer,
-		   struct doca_buf *local_doca_buf, struct doca_buf *remote_doca_buf, size_t *num_remaining_tasks)
+report_progress(struct chunk_pipeline *pipeline, bool wait)
+{
+	struct pipeline_slot *slot = NULL;
+	uint64_t done;
+	doca_error_t result;
+
+	/* Chunks complete out of order, a slot that was submitted again completed its previous chunk */
+	while (pipeline->nb_done < pipeline->nb_submitted) {
+		slot = &pipeline->slots[pipeline->nb_done % pipeline->nb_slots];
+		if (slot->busy && slot->chunk == pipeline->nb_done)
+			break;
+		pipeline->nb_done++;
+	}
+	/* Copied up to the first chunk in flight */
+	done = pipeline->nb_done < pipeline->nb_submitted ? slot->offset : pipeline->submitted;
+	if (done == pipeline->reported)
+		return DOCA_SUCCESS;
+
+	if (pipeline->ep != NULL) {
+		result = send_progress_msg(pipeline->ep, pipeline->peer_addr, done, wait);
+		if (result == DOCA_ERROR_AGAIN)
+			return DOCA_SUCCESS;
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+	pipeline->reported = done;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Wait until a chunk can be copied: before a DMA read the peer must have filled the ring up to its end, before a DMA
+ * write the peer must have written the chunk a ring length before it. The chunks in flight are completed and
+ * reported meanwhile.
+ *
+ * @pipeline [in]: pipeline
+ * @end [in]: file offset of the end of the chunk
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+wait_remote_ready(struct chunk_pipeline *pipeline, uint64_t end)
 {
-	struct program_core_objects *state = resources->state;
-	struct doca_dma_task_memcpy *dma_task;
-	struct doca_task *task;
-	union doca_data task_user_data = {0};
-	void *data;
-	struct doca_buf *src_buf;
-	struct doca_buf *dst_buf;
 	struct timespec ts = {
-		.tv_sec = 0,
 		.tv_nsec = SLEEP_IN_NANOS,
 	};
+	uint64_t target = end;
 	doca_error_t result;
-	doca_error_t task_result;
 
-	/* Determine DMA copy direction */
-	if (cfg->is_file_found_locally) {
-		src_buf = local_doca_buf;
-		dst_buf = remote_doca_buf;
-	} else {
-		src_buf = remote_doca_buf;
-		dst_buf = local_doca_buf;
-	}
+	if (pipeline->to_remote)
+		target = end > pipeline->ring_len ? end - pipeline->ring_len : 0;
 
-	/* Set data position in src_buf */
-	result = doca_buf_get_data(src_buf, &data);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to get data address from DOCA buffer: %s", doca_error_get_descr(result));
-		return result;
-	}
-	result = doca_buf_set_data(src_buf, data, bytes_to_copy);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to set data for DOCA buffer: %s", doca_error_get_descr(result));
-		return result;
+	/* In loopback the ring is filled and drained in turns, the peer offset is always ready */
+	while (pipeline->peer_offset < target) {
+		result = recv_progress_msg(pipeline->ep, pipeline->peer_addr, pipeline->file_size,
+					   &pipeline->peer_offset);
+		if (result == DOCA_SUCCESS)
+			continue;
+		if (result != DOCA_ERROR_AGAIN)
+			return result;
+		result = dma_engine_poll(pipeline->engine);
+		if (result != DOCA_SUCCESS)
+			return result;
+		result = report_progress(pipeline, false);
+		if (result != DOCA_SUCCESS)
+			return result;
+		nanosleep(&ts, &ts);
 	}
+	return DOCA_SUCCESS;
+}
 
-	/* Include result in user data of task to be used in the callbacks */
-	task_user_data.ptr = &task_result;
-	/* Allocate and construct DMA task */
-	result = doca_dma_task_memcpy_alloc_init(resources->dma_ctx, src_buf, dst_buf, task_user_data, &dma_task);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to allocate DMA memcpy task: %s", doca_error_get_descr(result));
-		return result;
-	}
+/*
+ * Create the chunk engine of a pipeline
+ *
+ * @pipeline [in]: pipeline with the peer, the file and the peer offset, the rest is set by this function
+ * @engine_cfg [in]: chunk engine configuration, the callback is set by this function
+ * @state [in]: DOCA core objects of the DOCA backend
+ * @dma_ctx [in]: DOCA DMA context of the DOCA backend
+ * @remote_mmap [in]: memory map of the remote region of the DOCA backend
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+pipeline_start(struct chunk_pipeline *pipeline, struct dma_engine_cfg *engine_cfg,
+	       struct program_core_objects *state, struct doca_dma *dma_ctx, struct doca_mmap *remote_mmap)
+{
+	doca_error_t result;
 
-	task = doca_dma_task_memcpy_as_task(dma_task);
+	pipeline->to_remote = engine_cfg->to_remote;
+	pipeline->chunk_size = engine_cfg->chunk_size;
+	pipeline->ring_len = engine_cfg->remote_len;
+	pipeline->nb_slots = engine_cfg->nb_slots;
+	pipeline->nb_submitted = 0;
+	pipeline->submitted = 0;
+	pipeline->nb_done = 0;
+	pipeline->reported = 0;
+	pipeline->slots = calloc(pipeline->nb_slots, sizeof(*pipeline->slots));
+	if (pipeline->slots == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		return DOCA_ERROR_NO_MEMORY;
+	}
 
-	/* Submit DMA task */
-	result = doca_task_submit(task);
+	engine_cfg->chunk_cb = chunk_copied_cb;
+	engine_cfg->user_ctx = pipeline;
+	result = dma_engine_create(engine_cfg, state, dma_ctx, remote_mmap, &pipeline->engine);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to submit DMA task: %s", doca_error_get_descr(result));
-		goto free_task;
+		free(pipeline->slots);
+		pipeline->slots = NULL;
 	}
+	return result;
+}
 
-	/* Wait for all tasks to be completed */
-	while (*num_remaining_tasks > 0) {
-		if (doca_pe_progress(state->pe) == 0)
-			nanosleep(&ts, &ts);
-	}
+/*
+ * Destroy the chunk engine of a pipeline
+ *
+ * @pipeline [in]: pipeline
+ */
+static void
+pipeline_stop(struct chunk_pipeline *pipeline)
+{
+	dma_engine_destroy(pipeline->engine);
+	pipeline->engine = NULL;
+	free(pipeline->slots);
+	pipeline->slots = NULL;
+}
 
-	/* Check result of task according to the result we update in the callbacks */
-	if (task_result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("DMA copy failed: %s", doca_error_get_descr(task_result));
-		result = task_result;
-		goto free_task;
-	}
+/*
+ * Copy the file up to an offset in chunks between the file and the ring, with up to nb_slots DMA tasks in flight.
+ * The chunks are cut at the end of the ring, every chunk is copied to or from a contiguous ring space.
+ *
+ * @pipeline [in]: started pipeline
+ * @end [in]: file offset to copy up to, from the bytes submitted so far
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+pipeline_copy(struct chunk_pipeline *pipeline, uint64_t end)
+{
+	uint64_t offset;
+	uint32_t slot;
+	size_t len;
+	doca_error_t result;
 
-	DOCA_LOG_INFO("DMA copy was done Successfully");
+	for (offset = pipeline->submitted; offset < end; offset += len) {
+		slot = pipeline->nb_submitted % pipeline->nb_slots;
+		len = MIN(MIN(pipeline->chunk_size, end - offset), pipeline->ring_len - offset % pipeline->ring_len);
 
-	/* If the buffer was copied into to DPU, save it as a file */
-	if (!cfg->is_file_found_locally) {
-		DOCA_LOG_INFO("Writing DMA buffer into a file on %s", cfg->file_path);
-		result = save_buffer_into_a_file(cfg, buffer);
+		result = dma_engine_wait_slot(pipeline->engine, slot);
 		if (result != DOCA_SUCCESS)
 			return result;
+		result = report_progress(pipeline, false);
+		if (result != DOCA_SUCCESS)
+			return result;
+
+		result = wait_remote_ready(pipeline, offset + len);
+		if (result != DOCA_SUCCESS)
+			return result;
+		if (pipeline->to_remote) {
+			result = read_chunk(pipeline->fd, dma_engine_buf(pipeline->engine, slot), len, offset);
+			if (result != DOCA_SUCCESS)
+				return result;
+		}
+
+		pipeline->slots[slot].chunk = pipeline->nb_submitted;
+		pipeline->slots[slot].offset = offset;
+		pipeline->slots[slot].busy = true;
+		result = dma_engine_submit(pipeline->engine, slot, offset % pipeline->ring_len, len);
+		if (result != DOCA_SUCCESS) {
+			pipeline->slots[slot].busy = false;
+			return result;
+		}
+		pipeline->nb_submitted++;
+		pipeline->submitted = offset + len;
 	}
 
-free_task:
-	doca_task_free(task);
+	result = dma_engine_wait_all(pipeline->engine);
+	if (result != DOCA_SUCCESS)
+		return result;
+	return report_progress(pipeline, true);
+}
+
+/*
+ * Copy the whole file in chunks between the file and the ring, with up to nb_slots DMA tasks in flight
+ *
+ * @pipeline [in]: pipeline with the peer, the file and the peer offset, the rest is set by this function
+ * @engine_cfg [in]: chunk engine configuration, the callback is set by this function
+ * @state [in]: DOCA core objects of the DOCA backend
+ * @dma_ctx [in]: DOCA DMA context of the DOCA backend
+ * @remote_mmap [in]: memory map of the remote region of the DOCA backend
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+copy_file_chunks(struct chunk_pipeline *pipeline, struct dma_engine_cfg *engine_cfg,
+		 struct program_core_objects *state, struct doca_dma *dma_ctx, struct doca_mmap *remote_mmap)
+{
+	uint64_t start;
+	doca_error_t result;
+
+	result = pipeline_start(pipeline, engine_cfg, state, dma_ctx, remote_mmap);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	DOCA_LOG_INFO("Copying %" PRIu64 " bytes in chunks of %u bytes through a ring of %zu bytes, %u DMA tasks in flight",
+		      pipeline->file_size, pipeline->chunk_size, pipeline->ring_len, pipeline->nb_slots);
+	start = now_ns();
+	result = pipeline_copy(pipeline, pipeline->file_size);
+	if (result == DOCA_SUCCESS)
+		log_throughput("DMA copied", pipeline->file_size, start);
+
+	pipeline_stop(pipeline);
 	return result;
 }
 
@@ -1019,6 +1498,7 @@ register_dma_copy_params(void)
 {
 	doca_error_t result;
 	struct doca_argp_param *file_path_param, *dev_pci_addr_param, *rep_pci_addr_param;
+	struct doca_argp_param *chunk_size_param, *tasks_param, *loopback_param;
 
 	/* Create and register string to dma copy param */
 	result = doca_argp_param_create(&file_path_param);
@@ -1048,10 +1528,9 @@ register_dma_copy_params(void)
 	doca_argp_param_set_short_name(dev_pci_addr_param, "p");
 	doca_argp_param_set_long_name(dev_pci_addr_param, "pci-addr");
 	doca_argp_param_set_description(dev_pci_addr_param,
-					"DOCA Comm Channel device PCI address");
+					"DOCA Comm Channel device PCI address (needed unless in loopback)");
 	doca_argp_param_set_callback(dev_pci_addr_param, dev_pci_addr_callback);
 	doca_argp_param_set_type(dev_pci_addr_param, DOCA_ARGP_TYPE_STRING);
-	doca_argp_param_set_mandatory(dev_pci_addr_param);
 	result = doca_argp_register_param(dev_pci_addr_param);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
@@ -1076,6 +1555,59 @@ register_dma_copy_params(void)
 		return result;
 	}
 
+	/* Create and register chunk size param */
+	result = doca_argp_param_create(&chunk_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(chunk_size_param, "chunk-size");
+	doca_argp_param_set_arguments(chunk_size_param, "<bytes>");
+	doca_argp_param_set_description(chunk_size_param,
+					"Size of the chunks the file is copied in, one per DMA task (default 1MB)");
+	doca_argp_param_set_callback(chunk_size_param, chunk_size_callback);
+	doca_argp_param_set_type(chunk_size_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(chunk_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register number of DMA tasks param */
+	result = doca_argp_param_create(&tasks_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(tasks_param, "tasks");
+	doca_argp_param_set_arguments(tasks_param, "<num>");
+	doca_argp_param_set_description(tasks_param, "Number of DMA tasks in flight (default 16)");
+	doca_argp_param_set_callback(tasks_param, tasks_callback);
+	doca_argp_param_set_type(tasks_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(tasks_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register loopback path param */
+	result = doca_argp_param_create(&loopback_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(loopback_param, "loopback");
+	doca_argp_param_set_arguments(loopback_param, "<path>");
+	doca_argp_param_set_description(loopback_param,
+					"Copy the file to this path with software memcpy, without Comm Channel nor DMA device");
+	doca_argp_param_set_callback(loopback_param, loopback_path_callback);
+	doca_argp_param_set_type(loopback_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(loopback_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
 	/* Register validation callback */
 	result = doca_argp_register_validation_callback(args_validation_callback);
 	if (result != DOCA_SUCCESS) {
@@ -1105,47 +1637,6 @@ open_dma_device(struct doca_dev **dev)
 	return result;
 }
 
-/*
- * DMA Memcpy task completed callback
- *
- * @dma_task [in]: Completed task
- * @task_user_data [in]: doca_data from the task
- * @ctx_user_data [in]: doca_data from the context
- */
-static void
-dma_memcpy_completed_callback(struct doca_dma_task_memcpy *dma_task, union doca_data task_user_data,
-			  union doca_data ctx_user_data)
-{
-	size_t *num_remaining_tasks = (size_t *)ctx_user_data.ptr;
-	doca_error_t *result = (doca_error_t *)task_user_data.ptr;
-
-	(void)dma_task;
-	/* Decrement number of remaining tasks */
-	--*num_remaining_tasks;
-	/* Assign success to the result */
-	*result = DOCA_SUCCESS;
-}
-
-/*
- * Memcpy task error callback
- *
- * @dma_task [in]: failed task
- * @task_user_data [in]: doca_data from the task
- * @ctx_user_data [in]: doca_data from the context
- */
-static void
-dma_memcpy_error_callback(struct doca_dma_task_memcpy *dma_task, union doca_data task_user_data, union doca_data ctx_user_data)
-{
-	size_t *num_remaining_tasks = (size_t *)ctx_user_data.ptr;
-	struct doca_task *task = doca_dma_task_memcpy_as_task(dma_task);
-	doca_error_t *result = (doca_error_t *)task_user_data.ptr;
-
-	/* Decrement number of remaining tasks */
-	--*num_remaining_tasks;
-	/* Get the result of the task */
-	*result = doca_task_get_status(task);
-}
-
 /*
  * Destroy copy resources
  *
@@ -1180,16 +1671,17 @@ destroy_dma_copy_resources(struct dma_copy_resources *resources)
 /*
  * Allocate DMA copy resources
  *
+ * @nb_tasks [in]: Number of DMA tasks in flight
  * @resources [out]: DOCA DMA copy resources
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-allocate_dma_copy_resources(struct dma_copy_resources *resources)
+allocate_dma_copy_resources(uint32_t nb_tasks, struct dma_copy_resources *resources)
 {
 	struct program_core_objects *state = NULL;
 	doca_error_t result, tmp_result;
-	/* Two buffers for source and destination */
-	uint32_t max_bufs = 2;
+	/* Local and remote buffers of every task */
+	uint32_t max_bufs = 2 * nb_tasks;
 
 	resources->state = malloc(sizeof(*(resources->state)));
 	if (resources->state == NULL) {
@@ -1226,8 +1718,7 @@ allocate_dma_copy_resources(struct dma_copy_resources *resources)
 		goto destroy_dma;
 	}
 
-	result = doca_dma_task_memcpy_set_conf(resources->dma_ctx, dma_memcpy_completed_callback,
-					       dma_memcpy_error_callback, NUM_DMA_TASKS);
+	result = dma_engine_set_conf(resources->dma_ctx, nb_tasks);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Unable to set configurations for DMA memcpy task: %s", doca_error_get_descr(result));
 		goto destroy_dma;
@@ -1261,6 +1752,8 @@ host_start_dma_copy(struct dma_copy_cfg *dma_cfg, struct doca_comm_channel_ep_t
 	struct doca_dev *dev = NULL;
 	char *buffer = NULL;
 	const void *export_desc = NULL;
+	size_t ring_len;
+	uint64_t start;
 	doca_error_t result, tmp_result;
 
 	/* Negotiate DMA copy direction with DPU */
@@ -1290,7 +1783,9 @@ host_start_dma_copy(struct dma_copy_cfg *dma_cfg, struct doca_comm_channel_ep_t
 		goto destroy_mmap;
 	}
 
-	result = memory_alloc_and_populate(mmap, dma_cfg->file_size, dpu_access, &buffer);
+	/* The file streams through a ring of a chunk per DMA task, whatever its size */
+	ring_len = (size_t)dma_cfg->nb_tasks * dma_cfg->chunk_size;
+	result = memory_alloc_and_populate(mmap, ring_len, dpu_access, &buffer);
 	if (result != DOCA_SUCCESS)
 		goto destroy_mmap;
 
@@ -1299,15 +1794,16 @@ host_start_dma_copy(struct dma_copy_cfg *dma_cfg, struct doca_comm_channel_ep_t
 	if (result != DOCA_SUCCESS)
 		goto free_buffer;
 
-	/* Fill the buffer before DPU starts DMA operation */
-	if (dma_cfg->is_file_found_locally) {
-		result = fill_buffer_with_file_content(dma_cfg, buffer);
-		if (result != DOCA_SUCCESS)
-			goto free_buffer;
-	}
+	/* Send the ring address and length to enable DMA, the file is then streamed through the ring in chunks */
+	result = host_send_addr_and_offset(buffer, ring_len, ep, peer_addr);
+	if (result != DOCA_SUCCESS)
+		goto free_buffer;
 
-	/* Send source buffer address and offset (entire buffer) to enable DMA and wait until DPU is done */
-	result = host_send_addr_and_offset(buffer, dma_cfg->file_size, ep, peer_addr);
+	start = now_ns();
+	if (dma_cfg->is_file_found_locally)
+		result = host_send_file_chunks(dma_cfg, buffer, ring_len, ep, peer_addr);
+	else
+		result = host_recv_file_chunks(dma_cfg, buffer, ring_len, ep, peer_addr);
 	if (result != DOCA_SUCCESS)
 		goto free_buffer;
 
@@ -1317,12 +1813,7 @@ host_start_dma_copy(struct dma_copy_cfg *dma_cfg, struct doca_comm_channel_ep_t
 		goto free_buffer;
 
 	DOCA_LOG_INFO("Final status message was successfully received");
-
-	if (!dma_cfg->is_file_found_locally) {
-		/*  File was copied successfully into the buffer, save it into file */
-		DOCA_LOG_INFO("Writing DMA buffer into a file on %s", dma_cfg->file_path);
-		result = save_buffer_into_a_file(dma_cfg, buffer);
-	}
+	log_throughput("Copied", dma_cfg->file_size, start);
 
 free_buffer:
 	free(buffer);
@@ -1353,17 +1844,21 @@ dpu_start_dma_copy(struct dma_copy_cfg *dma_cfg, struct doca_comm_channel_ep_t *
 	char *buffer;
 	char *host_dma_addr = NULL;
 	char export_desc_buf[CC_MAX_MSG_SIZE];
-	struct doca_buf *remote_doca_buf = NULL;
-	struct doca_buf *local_doca_buf = NULL;
 	struct doca_mmap *remote_mmap = NULL;
 	size_t host_dma_offset, export_desc_len;
-	union doca_data ctx_user_data = {0};
-	/* Number of tasks submitted to progress engine */
-	size_t num_remaining_tasks = 1;
+	struct dma_engine_cfg engine_cfg = {
+		.backend = DMA_ENGINE_DOCA,
+		.to_remote = dma_cfg->is_file_found_locally,
+		.nb_slots = dma_cfg->nb_tasks,
+	};
+	struct chunk_pipeline pipeline = {
+		.ep = ep,
+		.peer_addr = peer_addr,
+	};
 	doca_error_t result, tmp_result;
 
 	/* Allocate DMA copy resources */
-	result = allocate_dma_copy_resources(&resources);
+	result = allocate_dma_copy_resources(dma_cfg->nb_tasks, &resources);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to allocate DMA copy resources: %s", doca_error_get_descr(result));
 		return result;
@@ -1374,9 +1869,11 @@ dpu_start_dma_copy(struct dma_copy_cfg *dma_cfg, struct doca_comm_channel_ep_t *
 	if (result != DOCA_SUCCESS)
 		goto destroy_dma_resources;
 
-	/* Include tasks counter in user data of context to be decremented in callbacks */
-	ctx_user_data.ptr = &num_remaining_tasks;
-	doca_ctx_set_user_data(state->ctx, ctx_user_data);
+	/* Every DMA task copies one chunk, the chunks must fit the HW limitation */
+	engine_cfg.chunk_size = MIN(dma_cfg->chunk_size, max_buf_size);
+	if (engine_cfg.chunk_size != dma_cfg->chunk_size)
+		DOCA_LOG_WARN("Chunk size lowered to the DMA device maximum buffer size of %u bytes",
+			      engine_cfg.chunk_size);
 
 	result = doca_ctx_start(state->ctx);
 	if (result != DOCA_SUCCESS) {
@@ -1385,13 +1882,16 @@ dpu_start_dma_copy(struct dma_copy_cfg *dma_cfg, struct doca_comm_channel_ep_t *
 	}
 
 	/* Negotiate DMA copy direction with Host */
-	result = dpu_negotiate_dma_direction_and_size(dma_cfg, ep, peer_addr, max_buf_size);
+	result = dpu_negotiate_dma_direction_and_size(dma_cfg, ep, peer_addr);
 	if (result != DOCA_SUCCESS)
 		goto stop_dma;
 
-	result = memory_alloc_and_populate(state->src_mmap, dma_cfg->file_size, access_flags, &buffer);
+	/* The local buffers rotate between file I/O and DMA, one chunk per task */
+	result = memory_alloc_and_populate(state->src_mmap, (size_t)engine_cfg.nb_slots * engine_cfg.chunk_size,
+					   access_flags, &buffer);
 	if (result != DOCA_SUCCESS)
 		goto stop_dma;
+	engine_cfg.local_region = (uint8_t *)buffer;
 
 	/* Receive export descriptor from Host */
 	result = dpu_receive_export_desc(ep, peer_addr, export_desc_buf, &export_desc_len);
@@ -1411,56 +1911,40 @@ dpu_start_dma_copy(struct dma_copy_cfg *dma_cfg, struct doca_comm_channel_ep_t *
 	if (result != DOCA_SUCCESS)
 		goto destroy_remote_mmap;
 
-	/* Construct DOCA buffer for remote (Host) address range */
-	result = doca_buf_inventory_buf_get_by_addr(state->buf_inv, remote_mmap, host_dma_addr, host_dma_offset,
-						    &remote_doca_buf);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to acquire DOCA remote buffer: %s", doca_error_get_descr(result));
+	/* The Host buffer is a ring the file streams through, any non empty ring fits any file */
+	if (host_dma_offset == 0) {
+		DOCA_LOG_ERR("Host ring buffer is empty");
 		send_status_msg(ep, peer_addr, STATUS_FAILURE);
+		result = DOCA_ERROR_INVALID_VALUE;
 		goto destroy_remote_mmap;
 	}
+	engine_cfg.remote_addr = host_dma_addr;
+	engine_cfg.remote_len = host_dma_offset;
 
-	/* Construct DOCA buffer for local (DPU) address range */
-	result = doca_buf_inventory_buf_get_by_addr(state->buf_inv, state->src_mmap, buffer, host_dma_offset,
-						    &local_doca_buf);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to acquire DOCA local buffer: %s", doca_error_get_descr(result));
+	if (dma_cfg->is_file_found_locally)
+		pipeline.fd = open(dma_cfg->file_path, O_RDONLY);
+	else
+		pipeline.fd = open(dma_cfg->file_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (pipeline.fd < 0) {
+		DOCA_LOG_ERR("Failed to open %s", dma_cfg->file_path);
 		send_status_msg(ep, peer_addr, STATUS_FAILURE);
-		goto destroy_remote_buf;
-	}
-
-	/* Fill buffer in file content if relevant */
-	if (dma_cfg->is_file_found_locally) {
-		result = fill_buffer_with_file_content(dma_cfg, buffer);
-		if (result != DOCA_SUCCESS) {
-			send_status_msg(ep, peer_addr, STATUS_FAILURE);
-			goto destroy_local_buf;
-		}
+		result = DOCA_ERROR_IO_FAILED;
+		goto destroy_remote_mmap;
 	}
+	pipeline.file_size = dma_cfg->file_size;
 
-	/* Submit DMA task into the progress engine and wait until task completion */
-	result = dpu_submit_dma_task(dma_cfg, &resources, host_dma_offset, buffer, local_doca_buf, remote_doca_buf,
-				     &num_remaining_tasks);
+	/* Stream the file in chunks, with the DMA tasks in flight on the progress engine */
+	result = copy_file_chunks(&pipeline, &engine_cfg, state, resources.dma_ctx, remote_mmap);
+	close(pipeline.fd);
 	if (result != DOCA_SUCCESS) {
+		if (!dma_cfg->is_file_found_locally)
+			unlink(dma_cfg->file_path);
 		send_status_msg(ep, peer_addr, STATUS_FAILURE);
-		goto destroy_local_buf;
+		goto destroy_remote_mmap;
 	}
 
 	send_status_msg(ep, peer_addr, STATUS_SUCCESS);
 
-
-destroy_local_buf:
-	tmp_result = doca_buf_dec_refcount(local_doca_buf, NULL);
-	if (tmp_result != DOCA_SUCCESS) {
-		DOCA_ERROR_PROPAGATE(result, tmp_result);
-		DOCA_LOG_ERR("Failed to destroy local DOCA buffer: %s", doca_error_get_descr(tmp_result));
-	}
-destroy_remote_buf:
-	tmp_result = doca_buf_dec_refcount(remote_doca_buf, NULL);
-	if (tmp_result != DOCA_SUCCESS) {
-		DOCA_ERROR_PROPAGATE(result, tmp_result);
-		DOCA_LOG_ERR("Failed to destroy remote DOCA buffer: %s", doca_error_get_descr(tmp_result));
-	}
 destroy_remote_mmap:
 	tmp_result = doca_mmap_destroy(remote_mmap);
 	if (tmp_result != DOCA_SUCCESS) {
@@ -1484,3 +1968,96 @@ destroy_dma_resources:
 	}
 	return result;
 }
+
+doca_error_t
+loopback_start_dma_copy(struct dma_copy_cfg *dma_cfg)
+{
+	struct dma_engine_cfg writer_cfg = {
+		.backend = DMA_ENGINE_SW,
+		.to_remote = true,
+		.nb_slots = dma_cfg->nb_tasks,
+		.chunk_size = dma_cfg->chunk_size,
+		.remote_len = (size_t)dma_cfg->nb_tasks * dma_cfg->chunk_size,
+	};
+	struct dma_engine_cfg reader_cfg = writer_cfg;
+	struct chunk_pipeline writer = {
+		.file_size = dma_cfg->file_size,
+		.fd = -1,
+	};
+	struct chunk_pipeline reader = writer;
+	char *host_ring;
+	uint8_t *local_buffer;
+	uint64_t offset, end, start;
+	doca_error_t result;
+
+	/*
+	 * The ring stands for the Host buffer, of a chunk per task as in the Host. The file is DMA written into it and
+	 * DMA read from it to the copy, a ring length at a time.
+	 */
+	host_ring = malloc(writer_cfg.remote_len);
+	local_buffer = malloc(2 * writer_cfg.remote_len);
+	if (host_ring == NULL || local_buffer == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto free_buffers;
+	}
+	writer_cfg.local_region = local_buffer;
+	writer_cfg.remote_addr = host_ring;
+	reader_cfg.to_remote = false;
+	reader_cfg.local_region = local_buffer + writer_cfg.remote_len;
+	reader_cfg.remote_addr = host_ring;
+
+	writer.fd = open(dma_cfg->file_path, O_RDONLY);
+	if (writer.fd < 0) {
+		DOCA_LOG_ERR("Failed to open %s", dma_cfg->file_path);
+		result = DOCA_ERROR_IO_FAILED;
+		goto free_buffers;
+	}
+	reader.fd = open(dma_cfg->loopback_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (reader.fd < 0) {
+		DOCA_LOG_ERR("Failed to create %s", dma_cfg->loopback_path);
+		result = DOCA_ERROR_IO_FAILED;
+		goto close_files;
+	}
+
+	result = pipeline_start(&writer, &writer_cfg, NULL, NULL, NULL);
+	if (result != DOCA_SUCCESS)
+		goto close_files;
+	result = pipeline_start(&reader, &reader_cfg, NULL, NULL, NULL);
+	if (result != DOCA_SUCCESS)
+		goto stop_writer;
+
+	DOCA_LOG_INFO("Copying %s to %s through a loopback Host ring of %zu bytes", dma_cfg->file_path,
+		      dma_cfg->loopback_path, writer.ring_len);
+	start = now_ns();
+	for (offset = 0; offset < dma_cfg->file_size; offset = end) {
+		end = MIN(offset + writer.ring_len, dma_cfg->file_size);
+
+		/* The reader drained the ring up to the offset, the writer fills it up to a ring length ahead */
+		writer.peer_offset = reader.reported;
+		result = pipeline_copy(&writer, end);
+		if (result != DOCA_SUCCESS)
+			goto stop_reader;
+
+		reader.peer_offset = writer.reported;
+		result = pipeline_copy(&reader, end);
+		if (result != DOCA_SUCCESS)
+			goto stop_reader;
+	}
+	log_throughput("DMA copied", dma_cfg->file_size, start);
+
+stop_reader:
+	pipeline_stop(&reader);
+stop_writer:
+	pipeline_stop(&writer);
+close_files:
+	if (reader.fd >= 0)
+		close(reader.fd);
+	close(writer.fd);
+	if (result != DOCA_SUCCESS && reader.fd >= 0)
+		unlink(dma_cfg->loopback_path);
+free_buffers:
+	free(local_buffer);
+	free(host_ring);
+	return result;
+}
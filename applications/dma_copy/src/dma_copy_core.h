@@ -22,11 +22,11 @@
 #include <doca_log.h>
 #include <doca_pe.h>
 
+#include "dma_copy_engine.h"
 
 #define MAX_ARG_SIZE 128					/* PCI address and file path maximum length */
 #define CC_MAX_MSG_SIZE 4080					/* Comm Channel message maximum size */
 #define SERVER_NAME "dma copy server"				/* Comm Channel service name */
-#define NUM_DMA_TASKS (1)					/* DMA tasks number */
 
 enum dma_copy_mode {
 	DMA_COPY_MODE_HOST,					/* Run endpoint in Host */
@@ -42,6 +42,19 @@ struct cc_msg_dma_status {
 	bool is_success;					/* Indicate success or failure for last message sent */
 };
 
+/*
+ * Progress of the copy, sent while the file is streamed in chunks through the Host buffer, a ring of a chunk per
+ * DMA task where a file offset is at the same offset modulo the ring length:
+ * - File in Host: the Host reads the file into the ring and tells the DPU up to which offset it can DMA read, the
+ *   DPU tells the Host up to which offset it DMA read, for the Host to reuse the ring space.
+ * - File in DPU: the DPU tells the Host up to which offset the ring was DMA written, for the Host to write it, the
+ *   Host tells the DPU up to which offset it wrote the file, for the DPU to DMA write the ring space again.
+ * A status message received instead of a progress message means the peer failed.
+ */
+struct cc_msg_dma_progress {
+	uint64_t offset;					/* Bytes done from the start of the file */
+};
+
 struct dma_copy_cfg {
 	enum dma_copy_mode mode;				  /* Node running mode {host, dpu} */
 	char file_path[MAX_ARG_SIZE];				  /* File path to copy from (host) or path the save DMA result (dpu) */
@@ -49,6 +62,9 @@ struct dma_copy_cfg {
 	char cc_dev_rep_pci_addr[DOCA_DEVINFO_REP_PCI_ADDR_SIZE]; /* Comm Channel DOCA device representor PCI address */
 	bool is_file_found_locally;				  /* Indicate DMA copy direction */
 	uint64_t file_size;					  /* File size in bytes */
+	uint32_t chunk_size;					  /* Size of the chunks the file is copied in */
+	uint32_t nb_tasks;					  /* Number of DMA tasks in flight */
+	char loopback_path[MAX_ARG_SIZE];			  /* Path to copy the file to with software memcpy */
 };
 
 struct dma_copy_resources {
@@ -117,4 +133,14 @@ doca_error_t host_start_dma_copy(struct dma_copy_cfg *dma_cfg, struct doca_comm_
 doca_error_t dpu_start_dma_copy(struct dma_copy_cfg *dma_cfg, struct doca_comm_channel_ep_t *ep,
 				struct doca_comm_channel_addr_t **peer_addr);
 
+/*
+ * Copy the file locally through the chunk pipeline with the software memcpy backend, without Comm Channel nor DMA
+ * device: the file is copied to a ring standing for the Host buffer, then from it to the loopback path, a ring length
+ * at a time
+ *
+ * @dma_cfg [in]: App configuration structure
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t loopback_start_dma_copy(struct dma_copy_cfg *dma_cfg);
+
 #endif /* DMA_COPY_CORE_H_ */
@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <doca_buf.h>
+#include <doca_buf_inventory.h>
+#include <doca_ctx.h>
+#include <doca_log.h>
+#include <doca_pe.h>
+
+#include "dma_copy_engine.h"
+
+#define DMA_ENGINE_SLEEP_IN_NANOS (10 * 1000)	/* Sample the tasks every 10 microseconds */
+
+DOCA_LOG_REGISTER(DMA_COPY::Engine);
+
+/* Slot of a chunk in flight */
+struct dma_slot {
+	struct dma_engine *engine;		/* Engine of the slot */
+	bool busy;				/* True while the chunk is copied */
+	bool copied;				/* Software backend: copied, not completed yet */
+	uint8_t *local;				/* Local buffer */
+	uint64_t offset;			/* Chunk offset in the remote region */
+	size_t len;				/* Chunk length */
+	doca_error_t result;			/* Result of the chunk */
+	struct doca_dma_task_memcpy *task;	/* Memcpy task of the DOCA backend */
+	struct doca_buf *local_buf;		/* Local buffer of the DOCA backend */
+	struct doca_buf *remote_buf;		/* Remote region buffer of the DOCA backend */
+};
+
+/* Engine of chunks */
+struct dma_engine {
+	struct dma_engine_cfg cfg;		/* Configuration */
+	struct dma_slot *slots;			/* Slots */
+	uint32_t nb_busy;			/* Slots in flight */
+	uint32_t nb_copied;			/* Software backend: slots copied, not completed yet */
+	doca_error_t result;			/* First chunk failure */
+	struct program_core_objects *state;	/* DOCA core objects of the DOCA backend */
+};
+
+/*
+ * Complete a copied slot: free it and give the chunk to the caller
+ *
+ * @slot [in]: slot
+ */
+static void
+complete_slot(struct dma_slot *slot)
+{
+	struct dma_engine *engine = slot->engine;
+	doca_error_t result;
+
+	slot->busy = false;
+	engine->nb_busy--;
+	if (slot->result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to copy chunk at offset %" PRIu64 ": %s", slot->offset,
+			     doca_error_get_descr(slot->result));
+		if (engine->result == DOCA_SUCCESS)
+			engine->result = slot->result;
+		return;
+	}
+	/* The chunks completed after a failure are dropped */
+	if (engine->result != DOCA_SUCCESS)
+		return;
+	result = engine->cfg.chunk_cb(slot - engine->slots, slot->offset, slot->local, slot->len, engine->cfg.user_ctx);
+	if (result != DOCA_SUCCESS)
+		engine->result = result;
+}
+
+/*
+ * Complete the slots copied by the software backend
+ *
+ * @engine [in]: engine
+ */
+static void
+progress_sw(struct dma_engine *engine)
+{
+	uint32_t i;
+
+	for (i = 0; engine->nb_copied > 0 && i < engine->cfg.nb_slots; i++) {
+		if (!engine->slots[i].copied)
+			continue;
+		engine->slots[i].copied = false;
+		engine->nb_copied--;
+		complete_slot(&engine->slots[i]);
+	}
+}
+
+/*
+ * Complete the copied slots
+ *
+ * @engine [in]: engine
+ * @wait [in]: sleep if nothing was completed
+ */
+static void
+progress(struct dma_engine *engine, bool wait)
+{
+	struct timespec ts = {
+		.tv_nsec = DMA_ENGINE_SLEEP_IN_NANOS,
+	};
+
+	if (engine->cfg.backend == DMA_ENGINE_SW)
+		progress_sw(engine);
+	else if (doca_pe_progress(engine->state->pe) == 0 && wait)
+		nanosleep(&ts, &ts);
+}
+
+/*
+ * DMA memcpy task completed callback of the DOCA backend
+ *
+ * @dma_task [in]: Completed task
+ * @task_user_data [in]: doca_data from the task
+ * @ctx_user_data [in]: doca_data from the context
+ */
+static void
+dma_memcpy_completed_callback(struct doca_dma_task_memcpy *dma_task, union doca_data task_user_data,
+			      union doca_data ctx_user_data)
+{
+	struct dma_slot *slot = (struct dma_slot *)task_user_data.ptr;
+
+	(void)dma_task;
+	(void)ctx_user_data;
+
+	slot->result = DOCA_SUCCESS;
+	complete_slot(slot);
+}
+
+/*
+ * DMA memcpy task error callback of the DOCA backend
+ *
+ * @dma_task [in]: Failed task
+ * @task_user_data [in]: doca_data from the task
+ * @ctx_user_data [in]: doca_data from the context
+ */
+static void
+dma_memcpy_error_callback(struct doca_dma_task_memcpy *dma_task, union doca_data task_user_data,
+			  union doca_data ctx_user_data)
+{
+	struct dma_slot *slot = (struct dma_slot *)task_user_data.ptr;
+
+	(void)ctx_user_data;
+
+	slot->result = doca_task_get_status(doca_dma_task_memcpy_as_task(dma_task));
+	complete_slot(slot);
+}
+
+doca_error_t
+dma_engine_set_conf(struct doca_dma *dma_ctx, uint32_t nb_tasks)
+{
+	return doca_dma_task_memcpy_set_conf(dma_ctx, dma_memcpy_completed_callback, dma_memcpy_error_callback,
+					     nb_tasks);
+}
+
+/*
+ * Allocate the buffers and the task of every slot of the DOCA backend
+ *
+ * @engine [in]: engine
+ * @dma_ctx [in]: started DOCA DMA context
+ * @remote_mmap [in]: memory map of the remote region
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+init_doca_backend(struct dma_engine *engine, struct doca_dma *dma_ctx, struct doca_mmap *remote_mmap)
+{
+	struct program_core_objects *state = engine->state;
+	union doca_data task_user_data = {0};
+	struct dma_slot *slot;
+	doca_error_t result;
+	uint32_t i;
+
+	for (i = 0; i < engine->cfg.nb_slots; i++) {
+		slot = &engine->slots[i];
+		result = doca_buf_inventory_buf_get_by_addr(state->buf_inv, state->src_mmap, slot->local,
+							    engine->cfg.chunk_size, &slot->local_buf);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Unable to acquire DOCA local buffer: %s", doca_error_get_descr(result));
+			return result;
+		}
+		result = doca_buf_inventory_buf_get_by_addr(state->buf_inv, remote_mmap, engine->cfg.remote_addr,
+							    engine->cfg.remote_len, &slot->remote_buf);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Unable to acquire DOCA remote buffer: %s", doca_error_get_descr(result));
+			return result;
+		}
+
+		/* Include the slot in user data of task to be used in the callbacks */
+		task_user_data.ptr = slot;
+		if (engine->cfg.to_remote)
+			result = doca_dma_task_memcpy_alloc_init(dma_ctx, slot->local_buf, slot->remote_buf,
+								 task_user_data, &slot->task);
+		else
+			result = doca_dma_task_memcpy_alloc_init(dma_ctx, slot->remote_buf, slot->local_buf,
+								 task_user_data, &slot->task);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to allocate DMA memcpy task: %s", doca_error_get_descr(result));
+			return result;
+		}
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+dma_engine_create(const struct dma_engine_cfg *cfg, struct program_core_objects *state, struct doca_dma *dma_ctx,
+		  struct doca_mmap *remote_mmap, struct dma_engine **engine)
+{
+	struct dma_engine *new_engine;
+	doca_error_t result = DOCA_SUCCESS;
+	uint32_t i;
+
+	if (cfg->nb_slots == 0 || cfg->nb_slots > DMA_ENGINE_MAX_TASKS) {
+		DOCA_LOG_ERR("Number of DMA tasks must be between 1 and %d", DMA_ENGINE_MAX_TASKS);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	new_engine = calloc(1, sizeof(*new_engine));
+	if (new_engine == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	new_engine->cfg = *cfg;
+	new_engine->state = state;
+	new_engine->result = DOCA_SUCCESS;
+
+	new_engine->slots = calloc(cfg->nb_slots, sizeof(*new_engine->slots));
+	if (new_engine->slots == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto destroy_engine;
+	}
+	for (i = 0; i < cfg->nb_slots; i++) {
+		new_engine->slots[i].engine = new_engine;
+		new_engine->slots[i].local = cfg->local_region + (size_t)i * cfg->chunk_size;
+	}
+
+	if (cfg->backend == DMA_ENGINE_DOCA)
+		result = init_doca_backend(new_engine, dma_ctx, remote_mmap);
+	if (result != DOCA_SUCCESS)
+		goto destroy_engine;
+
+	*engine = new_engine;
+	return DOCA_SUCCESS;
+
+destroy_engine:
+	dma_engine_destroy(new_engine);
+	return result;
+}
+
+uint8_t *
+dma_engine_buf(struct dma_engine *engine, uint32_t slot)
+{
+	return engine->slots[slot].local;
+}
+
+doca_error_t
+dma_engine_wait_slot(struct dma_engine *engine, uint32_t slot)
+{
+	while (engine->slots[slot].busy)
+		progress(engine, true);
+	return engine->result;
+}
+
+doca_error_t
+dma_engine_poll(struct dma_engine *engine)
+{
+	progress(engine, false);
+	return engine->result;
+}
+
+doca_error_t
+dma_engine_submit(struct dma_engine *engine, uint32_t slot_idx, uint64_t offset, size_t len)
+{
+	struct dma_slot *slot = &engine->slots[slot_idx];
+	char *remote = engine->cfg.remote_addr + offset;
+	struct doca_buf *src_buf, *dst_buf;
+	void *src, *dst;
+	doca_error_t result;
+
+	if (len > engine->cfg.chunk_size || offset > engine->cfg.remote_len || len > engine->cfg.remote_len - offset) {
+		DOCA_LOG_ERR("Chunk of %zu bytes at offset %" PRIu64 " is out of the slot buffer or remote region", len,
+			     offset);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	slot->offset = offset;
+	slot->len = len;
+	slot->result = DOCA_SUCCESS;
+
+	if (engine->cfg.backend == DMA_ENGINE_SW) {
+		if (engine->cfg.to_remote)
+			memcpy(remote, slot->local, len);
+		else
+			memcpy(slot->local, remote, len);
+		/* Completed on the next progress, like a task */
+		slot->busy = true;
+		slot->copied = true;
+		engine->nb_busy++;
+		engine->nb_copied++;
+		return DOCA_SUCCESS;
+	}
+
+	/* The task of the slot is reused, only the data of its buffers moves along the remote region */
+	if (engine->cfg.to_remote) {
+		src_buf = slot->local_buf;
+		src = slot->local;
+		dst_buf = slot->remote_buf;
+		dst = remote;
+	} else {
+		src_buf = slot->remote_buf;
+		src = remote;
+		dst_buf = slot->local_buf;
+		dst = slot->local;
+	}
+	result = doca_buf_set_data(src_buf, src, len);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to set data for DOCA source buffer: %s", doca_error_get_descr(result));
+		return result;
+	}
+	result = doca_buf_set_data(dst_buf, dst, 0);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to set data for DOCA destination buffer: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	slot->busy = true;
+	engine->nb_busy++;
+	result = doca_task_submit(doca_dma_task_memcpy_as_task(slot->task));
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to submit DMA task: %s", doca_error_get_descr(result));
+		slot->busy = false;
+		engine->nb_busy--;
+		return result;
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+dma_engine_wait_all(struct dma_engine *engine)
+{
+	while (engine->nb_busy > 0)
+		progress(engine, true);
+	return engine->result;
+}
+
+void
+dma_engine_destroy(struct dma_engine *engine)
+{
+	struct dma_slot *slot;
+	uint32_t i;
+
+	dma_engine_wait_all(engine);
+	for (i = 0; engine->slots != NULL && i < engine->cfg.nb_slots; i++) {
+		slot = &engine->slots[i];
+		if (slot->task != NULL)
+			doca_task_free(doca_dma_task_memcpy_as_task(slot->task));
+		if (slot->local_buf != NULL)
+			doca_buf_dec_refcount(slot->local_buf, NULL);
+		if (slot->remote_buf != NULL)
+			doca_buf_dec_refcount(slot->remote_buf, NULL);
+	}
+	free(engine->slots);
+	free(engine);
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef DMA_COPY_ENGINE_H_
+#define DMA_COPY_ENGINE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_dma.h>
+#include <doca_error.h>
+#include <doca_mmap.h>
+
+#include <samples/common.h>
+
+/*
+ * Chunk engine of the DMA copy application.
+ * The file is copied in chunks of a fixed size between a remote region (the Host buffer) and local buffers, with a
+ * fixed number of slots of chunks in flight. Every slot owns a local buffer of one chunk, and copies it either with
+ * a DOCA DMA memcpy task or with memcpy() when the remote region is in the same process.
+ */
+
+#define DMA_ENGINE_DEFAULT_CHUNK_SIZE (1024 * 1024)	/* Default chunk size */
+#define DMA_ENGINE_MIN_CHUNK_SIZE 4096			/* Smallest chunk size */
+#define DMA_ENGINE_MAX_CHUNK_SIZE (256 * 1024 * 1024)	/* Largest chunk size */
+#define DMA_ENGINE_DEFAULT_TASKS 16			/* Default number of chunks in flight */
+#define DMA_ENGINE_MAX_TASKS 1024			/* Largest number of chunks in flight */
+
+/* Backend of the chunk engine */
+enum dma_engine_backend {
+	DMA_ENGINE_DOCA,	/* DOCA DMA memcpy tasks */
+	DMA_ENGINE_SW,		/* memcpy() in the caller thread */
+};
+
+/*
+ * Callback called on every copied chunk, from the thread that calls the engine functions
+ *
+ * @slot [in]: slot of the chunk
+ * @offset [in]: chunk offset in the remote region
+ * @data [in]: local buffer of the chunk, valid until the slot is submitted again
+ * @len [in]: chunk length
+ * @user_ctx [in]: user context of the configuration
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR to fail the engine
+ */
+typedef doca_error_t (*dma_engine_cb)(uint32_t slot, uint64_t offset, uint8_t *data, size_t len, void *user_ctx);
+
+/* Engine of chunks, with a fixed number of slots of chunks in flight */
+struct dma_engine;
+
+/* Chunk engine configuration */
+struct dma_engine_cfg {
+	enum dma_engine_backend backend;	/* Backend */
+	bool to_remote;				/* Copy the local buffers to the remote region, otherwise the opposite */
+	uint32_t nb_slots;			/* Chunks in flight */
+	uint32_t chunk_size;			/* Local buffer size of a slot */
+	uint8_t *local_region;			/* Local buffers of all the slots, nb_slots * chunk_size bytes */
+	char *remote_addr;			/* Remote region address */
+	size_t remote_len;			/* Remote region length */
+	dma_engine_cb chunk_cb;			/* Called on every copied chunk */
+	void *user_ctx;				/* Context of the callback */
+};
+
+/*
+ * Set the memcpy task configuration of the DOCA backend, before the DMA context is started
+ *
+ * @dma_ctx [in]: DOCA DMA context
+ * @nb_tasks [in]: number of tasks
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t dma_engine_set_conf(struct doca_dma *dma_ctx, uint32_t nb_tasks);
+
+/*
+ * Create a chunk engine
+ * The DOCA backend needs the local region in the local memory map of the core objects, the remote region in the
+ * remote memory map and a started DMA context
+ *
+ * @cfg [in]: engine configuration
+ * @state [in]: DOCA core objects of the DOCA backend, unused by the software backend
+ * @dma_ctx [in]: DOCA DMA context of the DOCA backend, unused by the software backend
+ * @remote_mmap [in]: memory map of the remote region of the DOCA backend, unused by the software backend
+ * @engine [out]: engine
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t dma_engine_create(const struct dma_engine_cfg *cfg, struct program_core_objects *state,
+			       struct doca_dma *dma_ctx, struct doca_mmap *remote_mmap, struct dma_engine **engine);
+
+/*
+ * Get the local buffer of a slot, chunk_size bytes, to fill while the slot is free
+ *
+ * @engine [in]: engine
+ * @slot [in]: slot index
+ * @return: local buffer
+ */
+uint8_t *dma_engine_buf(struct dma_engine *engine, uint32_t slot);
+
+/*
+ * Wait until a slot is free, the chunk callbacks of the chunks copied meanwhile are called
+ *
+ * @engine [in]: engine
+ * @slot [in]: slot index, lower than the number of slots
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR if a chunk failed
+ */
+doca_error_t dma_engine_wait_slot(struct dma_engine *engine, uint32_t slot);
+
+/*
+ * Complete the chunks copied so far without waiting
+ *
+ * @engine [in]: engine
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR if a chunk failed
+ */
+doca_error_t dma_engine_poll(struct dma_engine *engine);
+
+/*
+ * Copy a chunk between the local buffer of a free slot and the remote region
+ *
+ * @engine [in]: engine
+ * @slot [in]: free slot index
+ * @offset [in]: chunk offset in the remote region
+ * @len [in]: chunk length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t dma_engine_submit(struct dma_engine *engine, uint32_t slot, uint64_t offset, size_t len);
+
+/*
+ * Wait until all the chunks submitted are copied
+ *
+ * @engine [in]: engine
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR if a chunk failed
+ */
+doca_error_t dma_engine_wait_all(struct dma_engine *engine);
+
+/*
+ * Wait for the chunks in flight and destroy an engine
+ *
+ * @engine [in]: engine
+ */
+void dma_engine_destroy(struct dma_engine *engine);
+
+#endif /* DMA_COPY_ENGINE_H_ */
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2022-2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef DPA_ALL_TO_ALL_COMMON_H_
+#define DPA_ALL_TO_ALL_COMMON_H_
+
+#include <stdint.h>
+
+/*
+ * Alltoall schedules, shared by the host (which selects and simulates them) and the DPA kernel (which runs them).
+ * A step is one round of RDMA writes; a process waits for the writes it receives in a step before it can reuse
+ * the data, so the number of writers targeting the same process in a step is the incast of that step.
+ */
+enum a2a_schedule {
+	A2A_SCHEDULE_LINEAR = 0,	/* At step s every process writes to process s, so one process takes all writes */
+	A2A_SCHEDULE_PAIRWISE = 1,	/* At step s process r writes to process r + s, every process has a single writer */
+	A2A_SCHEDULE_BRUCK = 2,		/* ceil(log2(n)) steps, at step k blocks move 2^k processes through staging buffers */
+	A2A_SCHEDULE_AUTO = 3,		/* Bruck for blocks up to A2A_BRUCK_MAX_BLOCK_SIZE, pairwise otherwise */
+};
+
+#define A2A_BRUCK_MAX_BLOCK_SIZE (256)	/* Largest block (per process message) size that AUTO runs with Bruck */
+
+/*
+ * Get the number of steps of a schedule
+ *
+ * @schedule [in]: Alltoall schedule, AUTO is not allowed
+ * @num_ranks [in]: Number of processes
+ * @return: Number of steps
+ */
+static inline unsigned int
+a2a_schedule_num_steps(unsigned int schedule, unsigned int num_ranks)
+{
+	unsigned int steps = 0;
+
+	if (schedule != A2A_SCHEDULE_BRUCK)
+		return num_ranks;
+
+	/* ceil(log2(num_ranks)) */
+	while ((1U << steps) < num_ranks)
+		steps++;
+	return steps;
+}
+
+/*
+ * Get the process that the current process writes to in a step
+ *
+ * @schedule [in]: Alltoall schedule, AUTO is not allowed
+ * @my_rank [in]: The rank of the current process
+ * @step [in]: Step number
+ * @num_ranks [in]: Number of processes
+ * @return: Rank of the destination process
+ */
+static inline unsigned int
+a2a_schedule_send_peer(unsigned int schedule, unsigned int my_rank, unsigned int step, unsigned int num_ranks)
+{
+	switch (schedule) {
+	case A2A_SCHEDULE_PAIRWISE:
+		return (my_rank + step) % num_ranks;
+	case A2A_SCHEDULE_BRUCK:
+		return (my_rank + (1U << step)) % num_ranks;
+	default:
+		return step;
+	}
+}
+
+/*
+ * Get the process whose writes the current process waits for in a step
+ *
+ * @schedule [in]: Alltoall schedule, AUTO is not allowed
+ * @my_rank [in]: The rank of the current process
+ * @step [in]: Step number
+ * @num_ranks [in]: Number of processes
+ * @return: Rank of the source process
+ */
+static inline unsigned int
+a2a_schedule_recv_peer(unsigned int schedule, unsigned int my_rank, unsigned int step, unsigned int num_ranks)
+{
+	switch (schedule) {
+	case A2A_SCHEDULE_PAIRWISE:
+		return (my_rank + num_ranks - step) % num_ranks;
+	case A2A_SCHEDULE_BRUCK:
+		return (my_rank + num_ranks - ((1U << step) % num_ranks)) % num_ranks;
+	default:
+		/* The wait order of the linear schedule is the order of the original kernel */
+		return step;
+	}
+}
+
+/*
+ * Bruck blocks are numbered relative to the process that holds them: block b of process r is the data that has
+ * to travel b processes forward. At step k every block with bit k set moves 2^k processes forward. A block that
+ * moves for the last time (bit k is its highest bit) is written directly into the receive buffer of its
+ * destination, otherwise it is written into slot k of the destination staging buffer, from where that process
+ * forwards it in a later step.
+ */
+
+/*
+ * Check if a Bruck block is written into the receive buffer of its destination in a step
+ *
+ * @block [in]: Relative block number, must have bit step set
+ * @step [in]: Step number
+ * @return: Non-zero if the block reaches its final destination in this step
+ */
+static inline unsigned int
+a2a_bruck_is_final(unsigned int block, unsigned int step)
+{
+	return (block >> (step + 1)) == 0;
+}
+
+/*
+ * Get where a Bruck block is read from in a step
+ *
+ * @block [in]: Relative block number, must have bit step set
+ * @step [in]: Step number
+ * @return: -1 if the block is still in the send buffer, otherwise the staging slot it was received into
+ */
+static inline int
+a2a_bruck_src_slot(unsigned int block, unsigned int step)
+{
+	unsigned int moved = block & ((1U << step) - 1);
+	int slot = -1;
+
+	/* The block was last received in the step of the highest bit it has already moved by */
+	while (moved != 0) {
+		slot++;
+		moved >>= 1;
+	}
+	return slot;
+}
+
+/*
+ * Get the process that a Bruck block originates from, which is its offset in the destination receive buffer
+ *
+ * @my_rank [in]: The rank of the process that holds the block
+ * @block [in]: Relative block number
+ * @step [in]: Step number
+ * @num_ranks [in]: Number of processes
+ * @return: Rank of the process that sent the block
+ */
+static inline unsigned int
+a2a_bruck_origin(unsigned int my_rank, unsigned int block, unsigned int step, unsigned int num_ranks)
+{
+	return (my_rank + num_ranks - (block & ((1U << step) - 1))) % num_ranks;
+}
+
+/*
+ * Get the offset of a Bruck block in the staging buffer
+ *
+ * @slot [in]: Staging slot (the step the block was received in)
+ * @block [in]: Relative block number
+ * @num_ranks [in]: Number of processes
+ * @block_size [in]: Size of a block (in bytes)
+ * @return: Offset in the staging buffer (in bytes)
+ */
+static inline uint64_t
+a2a_bruck_staging_offset(unsigned int slot, unsigned int block, unsigned int num_ranks, uint64_t block_size)
+{
+	return ((uint64_t)slot * num_ranks + block) * block_size;
+}
+
+#endif /* DPA_ALL_TO_ALL_COMMON_H_ */
@@ -18,6 +18,103 @@
 
 #define SYNC_EVENT_MASK_FFS (0xFFFFFFFFFFFFFFFF)	/* Mask for doca_dpa_dev_sync_event_wait_gt() wait value */
 
+#include "../common/dpa_all_to_all_common.h"
+
+/*
+ * Wait for the writes that the current process receives in a step and for the completion of the writes it posted
+ * in that step.
+ *
+ * @rdma_handles [in]: DOCA DPA RDMA handlers
+ * @local_events [in]: Communication events that are updated by remote MPI ranks
+ * @schedule [in]: Alltoall schedule
+ * @my_rank [in]: The rank of the current process
+ * @step [in]: Step number
+ * @num_ranks [in]: Number of the MPI ranks
+ * @a2a_seq_num [in]: The number of times we called the alltoall_kernel in iterations
+ */
+static void
+wait_step(doca_dpa_dev_rdma_t *rdma_handles, doca_dpa_dev_sync_event_t *local_events, unsigned int schedule,
+	  unsigned int my_rank, unsigned int step, unsigned int num_ranks, uint64_t a2a_seq_num)
+{
+	unsigned int src = a2a_schedule_recv_peer(schedule, my_rank, step, num_ranks);
+	unsigned int dst = a2a_schedule_send_peer(schedule, my_rank, step, num_ranks);
+
+	doca_dpa_dev_sync_event_wait_gt(local_events[src], a2a_seq_num - 1, SYNC_EVENT_MASK_FFS);
+	doca_dpa_dev_rdma_synchronize(rdma_handles[dst]);
+}
+
+/*
+ * Bruck alltoall, run by a single thread.
+ * At step k the process writes all the blocks with bit k set to process my_rank + 2^k, signals it, and waits for
+ * the blocks of process my_rank - 2^k before forwarding them in the next steps. That is ceil(log2(num_ranks))
+ * signals and waits instead of num_ranks, at the cost of forwarding every block log2 times on average.
+ *
+ * @rdma_handles [in]: DOCA DPA RDMA handlers
+ * @local_buf [in]: DPA handle of the local send buffer
+ * @block_size [in]: Size of the data sent to each process (in bytes)
+ * @num_ranks [in]: Number of the MPI ranks
+ * @my_rank [in]: The rank of the current process
+ * @remote_buf_arr_handles [in]: DPA handles to buf arrays holding the remote receive buffers
+ * @local_events [in]: Communication events that are updated by remote MPI ranks
+ * @remote_events [in]: Communication events on other nodes that are updated by this rank
+ * @a2a_seq_num [in]: The number of times we called the alltoall_kernel in iterations
+ * @staging_buf_arr_handle [in]: DPA handle of buf array holding the local staging buffer, not set for 2 ranks or less
+ * @remote_staging_buf_arr_handles [in]: DPA handles to buf arrays holding the remote staging buffers
+ */
+static void
+bruck_alltoall(doca_dpa_dev_rdma_t *rdma_handles, doca_dpa_dev_buf_t local_buf, uint64_t block_size,
+	       unsigned int num_ranks, unsigned int my_rank, doca_dpa_dev_buf_arr_t *remote_buf_arr_handles,
+	       doca_dpa_dev_sync_event_t *local_events, doca_dpa_dev_sync_event_remote_net_t *remote_events,
+	       uint64_t a2a_seq_num, doca_dpa_dev_buf_arr_t staging_buf_arr_handle,
+	       doca_dpa_dev_buf_arr_t *remote_staging_buf_arr_handles)
+{
+	unsigned int num_steps = a2a_schedule_num_steps(A2A_SCHEDULE_BRUCK, num_ranks);
+	unsigned int step, block, peer;
+	doca_dpa_dev_buf_t src_buf, dst_buf;
+	uint64_t src_offset, dst_offset;
+	int slot;
+
+	/* The block of the current process does not move */
+	doca_dpa_dev_rdma_write(rdma_handles[my_rank],
+				doca_dpa_dev_buf_array_get_buf(remote_buf_arr_handles[my_rank], 0),
+				my_rank * block_size, local_buf, my_rank * block_size, block_size);
+
+	for (step = 0; step < num_steps; step++) {
+		peer = a2a_schedule_send_peer(A2A_SCHEDULE_BRUCK, my_rank, step, num_ranks);
+		for (block = 1U << step; block < num_ranks; block++) {
+			if (!(block & (1U << step)))
+				continue;
+
+			slot = a2a_bruck_src_slot(block, step);
+			if (slot < 0) {
+				src_buf = local_buf;
+				src_offset = ((my_rank + block) % num_ranks) * block_size;
+			} else {
+				src_buf = doca_dpa_dev_buf_array_get_buf(staging_buf_arr_handle, 0);
+				src_offset = a2a_bruck_staging_offset(slot, block, num_ranks, block_size);
+			}
+
+			if (a2a_bruck_is_final(block, step)) {
+				dst_buf = doca_dpa_dev_buf_array_get_buf(remote_buf_arr_handles[peer], 0);
+				dst_offset = a2a_bruck_origin(my_rank, block, step, num_ranks) * block_size;
+			} else {
+				dst_buf = doca_dpa_dev_buf_array_get_buf(remote_staging_buf_arr_handles[peer], 0);
+				dst_offset = a2a_bruck_staging_offset(step, block, num_ranks, block_size);
+			}
+
+			doca_dpa_dev_rdma_write(rdma_handles[peer], dst_buf, dst_offset, src_buf, src_offset,
+						block_size);
+		}
+		/* The signal is ordered after the writes of the step on the same RDMA context */
+		doca_dpa_dev_rdma_signal_set(rdma_handles[peer], remote_events[peer], a2a_seq_num);
+
+		/* The blocks received in this step are forwarded in the next steps */
+		wait_step(rdma_handles, local_events, A2A_SCHEDULE_BRUCK, my_rank, step, num_ranks, a2a_seq_num);
+	}
+
+	doca_dpa_dev_rdma_synchronize(rdma_handles[my_rank]);
+}
+
 /*
  * Alltoall kernel function.
  * Performs RDMA write operations using doca_dpa_dev_rdma_write() from local buffer to remote buffer.
@@ -32,12 +129,18 @@
  * @local_events_dev_ptr [in]: Device pointer of DPA handles to communication events that will be updated by remote MPI ranks
  * @remote_events_dev_ptr [in]: Device pointer of DPA handles to communication events on other nodes that will be updated by this rank
  * @a2a_seq_num [in]: The number of times we called the alltoall_kernel in iterations
+ * @schedule [in]: Alltoall schedule (enum a2a_schedule), AUTO is resolved by the host
+ * @staging_buf_arr_handle [in]: DPA handle of buf array holding the local staging buffer, used by Bruck only
+ * @remote_staging_buf_arr_handles_dev_ptr [in]: Device pointer of DPA handles to buf arrays holding remote staging
+ *	buffers, used by Bruck only
  */
 __dpa_global__ void alltoall_kernel(doca_dpa_dev_uintptr_t rdmas_dev_ptr, doca_dpa_dev_buf_arr_t local_buf_arr_handle,
 				    uint64_t count, uint64_t type_length, uint64_t num_ranks, uint64_t my_rank,
 				    doca_dpa_dev_uintptr_t remote_buf_arr_handles_dev_ptr,
 				    doca_dpa_dev_uintptr_t local_events_dev_ptr,
-				    doca_dpa_dev_uintptr_t remote_events_dev_ptr, uint64_t a2a_seq_num)
+				    doca_dpa_dev_uintptr_t remote_events_dev_ptr, uint64_t a2a_seq_num,
+				    uint64_t schedule, doca_dpa_dev_buf_arr_t staging_buf_arr_handle,
+				    doca_dpa_dev_uintptr_t remote_staging_buf_arr_handles_dev_ptr)
 {
 	/* Convert the remote buf array handles into dpa handle type */
 	doca_dpa_dev_buf_arr_t *remote_buf_arr_handles = (doca_dpa_dev_buf_arr_t *)remote_buf_arr_handles_dev_ptr;
@@ -54,19 +157,40 @@ __dpa_global__ void alltoall_kernel(doca_dpa_dev_uintptr_t rdmas_dev_ptr, doca_d
 	unsigned int num_threads = doca_dpa_dev_num_threads();
 	/* Get the process local buffer DPA handle */
 	doca_dpa_dev_buf_t local_buf = doca_dpa_dev_buf_array_get_buf(local_buf_arr_handle, 0);
-	unsigned int i;
+	unsigned int i, peer;
+
+	/* Bruck steps depend on each other, the host launches it with a single thread */
+	if (schedule == A2A_SCHEDULE_BRUCK) {
+		bruck_alltoall(rdma_handles, local_buf, count * type_length, num_ranks, my_rank,
+			       remote_buf_arr_handles, local_events, remote_events, a2a_seq_num,
+			       staging_buf_arr_handle,
+			       (doca_dpa_dev_buf_arr_t *)remote_staging_buf_arr_handles_dev_ptr);
+		return;
+	}
 
 	/*
 	 * Each process should perform as the number of processes RDMA write operations with local and remote buffers
-	 * according to the rank of the local process and the rank of the remote processes (we iterate over the rank
-	 * of the remote process).
+	 * according to the rank of the local process and the rank of the remote processes (we iterate over the steps
+	 * of the schedule, which give the rank of the remote process).
 	 * Each process runs num_threads threads on this kernel so we divide the number RDMA write operations (which is
 	 * the number of processes) by the number of threads.
 	 */
 	for (i = thread_rank; i < num_ranks; i += num_threads) {
-		doca_dpa_dev_rdma_write(rdma_handles[i], doca_dpa_dev_buf_array_get_buf(remote_buf_arr_handles[i], 0),
-			(count * my_rank * type_length), local_buf, (i * count * type_length), type_length * count);
-		doca_dpa_dev_rdma_signal_set(rdma_handles[i], remote_events[i], a2a_seq_num);
+		peer = a2a_schedule_send_peer(schedule, my_rank, i, num_ranks);
+		doca_dpa_dev_rdma_write(rdma_handles[peer],
+					doca_dpa_dev_buf_array_get_buf(remote_buf_arr_handles[peer], 0),
+					(count * my_rank * type_length), local_buf, (peer * count * type_length),
+					type_length * count);
+		doca_dpa_dev_rdma_signal_set(rdma_handles[peer], remote_events[peer], a2a_seq_num);
+
+		/*
+		 * With the pairwise schedule every process has a single writer per step, so the thread waits for its
+		 * previous step while the writes of the current one are in flight instead of posting all of them
+		 * first.
+		 */
+		if (schedule == A2A_SCHEDULE_PAIRWISE && i >= num_threads)
+			wait_step(rdma_handles, local_events, schedule, my_rank, i - num_threads, num_ranks,
+				  a2a_seq_num);
 	}
 
 	/*
@@ -75,8 +199,15 @@ __dpa_global__ void alltoall_kernel(doca_dpa_dev_uintptr_t rdmas_dev_ptr, doca_d
 	 * Each thread should also synchronize its rdma dpa handles to make sure
 	 * that the local RDMA operation calls has finished
 	 */
-	for (i = thread_rank; i < num_ranks; i += num_threads) {
-		doca_dpa_dev_sync_event_wait_gt(local_events[i], a2a_seq_num - 1, SYNC_EVENT_MASK_FFS);
-		doca_dpa_dev_rdma_synchronize(rdma_handles[i]);
+	if (schedule == A2A_SCHEDULE_PAIRWISE) {
+		/* Only the last step of the thread is left */
+		if (thread_rank < num_ranks)
+			wait_step(rdma_handles, local_events, schedule, my_rank,
+				  thread_rank + ((num_ranks - 1 - thread_rank) / num_threads) * num_threads, num_ranks,
+				  a2a_seq_num);
+		return;
 	}
+
+	for (i = thread_rank; i < num_ranks; i += num_threads)
+		wait_step(rdma_handles, local_events, schedule, my_rank, i, num_ranks, a2a_seq_num);
 }
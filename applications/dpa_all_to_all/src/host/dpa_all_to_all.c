@@ -91,6 +91,79 @@ devices_name_callback(void *param, void *config)
 	return DOCA_SUCCESS;
 }
 
+/*
+ * ARGP Callback - Handle benchmark iterations parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+benchmark_iters_callback(void *param, void *config)
+{
+	struct a2a_config *a2a_cgf = (struct a2a_config *)config;
+	int benchmark_iters = *((int *)param);
+
+	if (benchmark_iters < 0) {
+		DOCA_LOG_ERR("Entered number of benchmark iterations is negative");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	a2a_cgf->benchmark_iters = benchmark_iters;
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle alltoall schedule parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+schedule_callback(void *param, void *config)
+{
+	struct a2a_config *a2a_cgf = (struct a2a_config *)config;
+	char *schedule = (char *)param;
+
+	if (strcmp(schedule, "linear") == 0)
+		a2a_cgf->schedule = A2A_SCHEDULE_LINEAR;
+	else if (strcmp(schedule, "pairwise") == 0)
+		a2a_cgf->schedule = A2A_SCHEDULE_PAIRWISE;
+	else if (strcmp(schedule, "bruck") == 0)
+		a2a_cgf->schedule = A2A_SCHEDULE_BRUCK;
+	else if (strcmp(schedule, "auto") == 0)
+		a2a_cgf->schedule = A2A_SCHEDULE_AUTO;
+	else {
+		DOCA_LOG_ERR("Entered alltoall schedule %s is not one of linear, pairwise, bruck or auto", schedule);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle simulated number of processes parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+simulate_callback(void *param, void *config)
+{
+	struct a2a_config *a2a_cgf = (struct a2a_config *)config;
+	int simulate_ranks = *((int *)param);
+
+	if (simulate_ranks < 0 || simulate_ranks > MAX_SIMULATE_RANKS) {
+		DOCA_LOG_ERR("Entered number of simulated processes is not in range [0, %d]", MAX_SIMULATE_RANKS);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	a2a_cgf->simulate_ranks = simulate_ranks;
+
+	return DOCA_SUCCESS;
+}
+
 /*
  * Register the command line parameters for the All to All application.
  *
@@ -102,6 +175,9 @@ register_all_to_all_params(void)
 	doca_error_t result;
 	struct doca_argp_param *msgsize_param;
 	struct doca_argp_param *devices_param;
+	struct doca_argp_param *benchmark_param;
+	struct doca_argp_param *schedule_param;
+	struct doca_argp_param *simulate_param;
 
 	result = doca_argp_param_create(&msgsize_param);
 	if (result != DOCA_SUCCESS) {
@@ -137,6 +213,56 @@ register_all_to_all_params(void)
 		return result;
 	}
 
+	result = doca_argp_param_create(&benchmark_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(benchmark_param, "b");
+	doca_argp_param_set_long_name(benchmark_param, "benchmark");
+	doca_argp_param_set_arguments(benchmark_param, "<Iterations>");
+	doca_argp_param_set_description(benchmark_param, "Benchmark the persistent alltoall with the given number of steady-state iterations per message size, doubling message sizes up to msgsize (default 1MB) over an increasing number of processes. Default is 0 (run a single alltoall).");
+	doca_argp_param_set_callback(benchmark_param, benchmark_iters_callback);
+	doca_argp_param_set_type(benchmark_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(benchmark_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&schedule_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(schedule_param, "s");
+	doca_argp_param_set_long_name(schedule_param, "schedule");
+	doca_argp_param_set_arguments(schedule_param, "<Schedule>");
+	doca_argp_param_set_description(schedule_param, "Alltoall schedule of the DPA kernel: linear (all processes write to the same process at each step), pairwise (each process has a single writer at each step), bruck (log2 steps through staging buffers) or auto (bruck for blocks up to 256 bytes, pairwise otherwise). Default is auto.");
+	doca_argp_param_set_callback(schedule_param, schedule_callback);
+	doca_argp_param_set_type(schedule_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(schedule_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&simulate_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(simulate_param, "simulate");
+	doca_argp_param_set_arguments(simulate_param, "<Processes>");
+	doca_argp_param_set_description(simulate_param, "Simulate the alltoall schedules for the given number of processes without DPA, and print their rounds, waits, writes and incast. The block size is msgsize divided by the number of processes. Default is 0 (run on DPA).");
+	doca_argp_param_set_callback(simulate_param, simulate_callback);
+	doca_argp_param_set_type(simulate_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(simulate_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
 	return DOCA_SUCCESS;
 }
 
@@ -219,6 +345,13 @@ main(int argc, char **argv)
 	/* Set default value of message size */
 	cfg.msgsize = MESSAGE_SIZE_DEFAULT_LEN;
 
+	/* Set default number of benchmark iterations */
+	cfg.benchmark_iters = BENCHMARK_ITERATIONS_DEFAULT;
+
+	/* Set default schedule and disable the simulation */
+	cfg.schedule = SCHEDULE_DEFAULT;
+	cfg.simulate_ranks = SIMULATE_RANKS_DEFAULT;
+
 	/* Proccess of rank 0 will prepare the parameters and send them to the rest of the processes */
 	if (rank == 0)
 		result = prepare_argp_parameters(argc, argv, &cfg);
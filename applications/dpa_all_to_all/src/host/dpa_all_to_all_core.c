@@ -36,6 +36,9 @@ extern struct doca_dpa_app *dpa_all2all_app;
 char device1_name[MAX_IB_DEVICE_NAME_LEN];
 char device2_name[MAX_IB_DEVICE_NAME_LEN];
 
+/* Alltoall schedule of the DPA kernel */
+enum a2a_schedule a2a_schedule = SCHEDULE_DEFAULT;
+
 /* DOCA DPA all to all kernel function pointer */
 doca_dpa_func_t alltoall_kernel;
 
@@ -813,6 +816,205 @@ destroy_sendbuf_mmap:
 	return result;
 }
 
+/*
+ * Destroy the Bruck staging buffers resources
+ *
+ * @resources [in]: All to all resources
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+destroy_dpa_a2a_staging_memory(struct a2a_resources *resources)
+{
+	doca_error_t result = DOCA_SUCCESS, tmp_result;
+	int i;
+
+	if (resources->staging_buf_size == 0)
+		return DOCA_SUCCESS;
+
+	tmp_result = doca_dpa_mem_free(resources->doca_dpa, resources->devptr_staging_buf_arr_handles);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to free DOCA DPA device memory: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	for (i = 0; i < resources->num_ranks; i++) {
+		if (resources->staging_from_export_buf_arrs[i] != NULL) {
+			tmp_result = doca_buf_arr_destroy(resources->staging_from_export_buf_arrs[i]);
+			if (tmp_result != DOCA_SUCCESS) {
+				DOCA_LOG_ERR("Failed to destroy DOCA buf array: %s", doca_error_get_descr(tmp_result));
+				DOCA_ERROR_PROPAGATE(result, tmp_result);
+			}
+		}
+	}
+	for (i = 0; i < resources->num_ranks; i++) {
+		if (resources->staging_export_mmaps[i] != NULL) {
+			tmp_result = doca_mmap_destroy(resources->staging_export_mmaps[i]);
+			if (tmp_result != DOCA_SUCCESS) {
+				DOCA_LOG_ERR("Failed to destroy DOCA mmap: %s", doca_error_get_descr(tmp_result));
+				DOCA_ERROR_PROPAGATE(result, tmp_result);
+			}
+		}
+	}
+	free(resources->staging_export_mmaps);
+	free(resources->staging_from_export_buf_arrs);
+	free(resources->staging_from_export_dpa_buf_arrs);
+	tmp_result = doca_buf_arr_destroy(resources->staging_buf_arr);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy DOCA buf array: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	tmp_result = doca_mmap_destroy(resources->staging_mmap);
+	if (tmp_result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to destroy DOCA mmap: %s", doca_error_get_descr(tmp_result));
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	free(resources->staging_buf);
+	resources->staging_buf_size = 0;
+
+	return result;
+}
+
+/*
+ * Prepare the staging buffers of the Bruck schedule: a local staging buffer that the remote processes write the
+ * blocks forwarded through this process into, and the staging buffers of the remote processes.
+ * Slot k of the staging buffer holds the blocks received at step k that are not final, so the last step needs no
+ * slot and 2 processes or less need no staging buffer at all.
+ *
+ * @resources [in/out]: All to all resources
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+prepare_dpa_a2a_staging_memory(struct a2a_resources *resources)
+{
+	const unsigned int mem_access_write = DOCA_ACCESS_FLAG_LOCAL_READ_WRITE | DOCA_ACCESS_FLAG_RDMA_WRITE;
+	unsigned int num_steps = a2a_schedule_num_steps(A2A_SCHEDULE_BRUCK, resources->num_ranks);
+	size_t block_size = resources->extent * resources->mesg_count;
+	const void *staging_mmap_export;
+	size_t staging_mmap_export_len;
+	void *staging_mmap_exports = NULL;
+	MPI_Request req;
+	doca_error_t result;
+	int i;
+
+	if (num_steps <= 1)
+		return DOCA_SUCCESS;
+
+	resources->staging_buf_size = (num_steps - 1) * resources->num_ranks * block_size;
+	resources->staging_buf = calloc(1, resources->staging_buf_size);
+	resources->staging_export_mmaps = calloc(resources->num_ranks, sizeof(*(resources->staging_export_mmaps)));
+	resources->staging_from_export_buf_arrs = calloc(resources->num_ranks,
+							 sizeof(*(resources->staging_from_export_buf_arrs)));
+	resources->staging_from_export_dpa_buf_arrs = calloc(resources->num_ranks,
+							     sizeof(*(resources->staging_from_export_dpa_buf_arrs)));
+	if (resources->staging_buf == NULL || resources->staging_export_mmaps == NULL ||
+	    resources->staging_from_export_buf_arrs == NULL || resources->staging_from_export_dpa_buf_arrs == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory for staging buffers");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto free_staging;
+	}
+
+	result = create_mmap(resources->doca_device, mem_access_write, resources->staging_buf,
+			     resources->staging_buf_size, &(resources->staging_mmap));
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create mmap for staging buffer: %s", doca_error_get_descr(result));
+		goto free_staging;
+	}
+
+	/* The local staging buffer is the source of the blocks forwarded by this process */
+	result = create_buf_array_resources(resources->doca_dpa, resources->staging_mmap, resources->staging_buf_size,
+					    1, &(resources->staging_buf_arr), &(resources->staging_dpa_buf_arr));
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create buf array for staging buffer: %s", doca_error_get_descr(result));
+		goto destroy_staging_mmap;
+	}
+
+	result = doca_mmap_export_rdma(resources->staging_mmap, resources->doca_device, &staging_mmap_export,
+				       &staging_mmap_export_len);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to export mmap for staging buffer: %s", doca_error_get_descr(result));
+		goto destroy_staging_buf_arr;
+	}
+
+	/* All the processes have staging buffers of the same size, so their exports have the same length */
+	staging_mmap_exports = calloc(resources->num_ranks, staging_mmap_export_len);
+	if (staging_mmap_exports == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory for staging mmap exports");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto destroy_staging_buf_arr;
+	}
+
+	MPI_Iallgather(staging_mmap_export, staging_mmap_export_len, MPI_BYTE, staging_mmap_exports,
+		       staging_mmap_export_len, MPI_BYTE, resources->comm, &req);
+	result = mpi_request_wait_timeout(&req, MAX_MPI_WAIT_TIME);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Timed out waiting on allgather: %s", doca_error_get_descr(result));
+		goto free_mmap_exports;
+	}
+
+	for (i = 0; i < resources->num_ranks; i++) {
+		result = doca_mmap_create_from_export(NULL,
+			(const void *)&(((char *)staging_mmap_exports)[i * staging_mmap_export_len]),
+			staging_mmap_export_len, resources->doca_device, &(resources->staging_export_mmaps[i]));
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to create mmap from export: %s", doca_error_get_descr(result));
+			goto free_mmap_exports;
+		}
+
+		result = create_buf_array_resources(resources->doca_dpa, resources->staging_export_mmaps[i],
+				resources->staging_buf_size, 1, &(resources->staging_from_export_buf_arrs[i]),
+				&(resources->staging_from_export_dpa_buf_arrs[i]));
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to create buf array for remote staging buffer: %s",
+				     doca_error_get_descr(result));
+			goto free_mmap_exports;
+		}
+	}
+	free(staging_mmap_exports);
+	staging_mmap_exports = NULL;
+
+	/* Allocate DPA memory to hold the staging buf array handles and copy them */
+	result = doca_dpa_mem_alloc(resources->doca_dpa, (resources->num_ranks * sizeof(uint64_t)),
+				    &(resources->devptr_staging_buf_arr_handles));
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to allocate DOCA DPA memory: %s", doca_error_get_descr(result));
+		goto free_mmap_exports;
+	}
+
+	result = doca_dpa_h2d_memcpy(resources->doca_dpa, resources->devptr_staging_buf_arr_handles,
+				     (void *)(resources->staging_from_export_dpa_buf_arrs),
+				     resources->num_ranks * sizeof(uint64_t));
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to copy DOCA DPA memory from host to device: %s", doca_error_get_descr(result));
+		goto destroy_staging;
+	}
+
+	return result;
+
+destroy_staging:
+	/* Frees everything, including the DPA memory */
+	destroy_dpa_a2a_staging_memory(resources);
+	return result;
+free_mmap_exports:
+	free(staging_mmap_exports);
+	for (i = 0; i < resources->num_ranks; i++) {
+		if (resources->staging_from_export_buf_arrs[i] != NULL)
+			doca_buf_arr_destroy(resources->staging_from_export_buf_arrs[i]);
+		if (resources->staging_export_mmaps[i] != NULL)
+			doca_mmap_destroy(resources->staging_export_mmaps[i]);
+	}
+destroy_staging_buf_arr:
+	doca_buf_arr_destroy(resources->staging_buf_arr);
+destroy_staging_mmap:
+	doca_mmap_destroy(resources->staging_mmap);
+free_staging:
+	free(resources->staging_buf);
+	free(resources->staging_export_mmaps);
+	free(resources->staging_from_export_buf_arrs);
+	free(resources->staging_from_export_dpa_buf_arrs);
+	resources->staging_buf_size = 0;
+
+	return result;
+}
+
 /*
  * Connect the local process' DOCA RDMA contexts to the remote processes' DOCA DPA RDMAs.
  * rdma number i in each process would be connected to an rdma in process rank i.
@@ -1317,9 +1519,27 @@ destroy_comp_event:
 	return result;
 }
 
+/*
+ * Resolve the schedule that the kernel runs with, AUTO picks Bruck for small blocks where the number of signals and
+ * waits dominates the latency, and pairwise for the rest
+ *
+ * @schedule [in]: Requested alltoall schedule
+ * @block_size [in]: Size of the data sent to each process (in bytes)
+ * @return: The schedule to run
+ */
+static enum a2a_schedule
+resolve_a2a_schedule(enum a2a_schedule schedule, size_t block_size)
+{
+	if (schedule != A2A_SCHEDULE_AUTO)
+		return schedule;
+
+	return (block_size <= A2A_BRUCK_MAX_BLOCK_SIZE) ? A2A_SCHEDULE_BRUCK : A2A_SCHEDULE_PAIRWISE;
+}
+
 doca_error_t
 dpa_a2a_init(struct a2a_resources *resources)
 {
+	MPI_Aint lb, extent;
 	doca_error_t result, tmp_result;
 	int i;
 
@@ -1349,15 +1569,35 @@ dpa_a2a_init(struct a2a_resources *resources)
 		goto destroy_events;
 	}
 
+	/* Resolve the schedule, all the processes get the same one since they use the same count and datatype */
+	MPI_Type_get_extent(resources->msg_type, &lb, &extent);
+	resources->extent = extent;
+	resources->schedule = resolve_a2a_schedule(a2a_schedule, extent * resources->mesg_count);
+
+	/* Prepare the Bruck staging buffers, the other schedules pass no staging buffers to the kernel */
+	resources->staging_buf_size = 0;
+	resources->staging_dpa_buf_arr = NULL;
+	resources->devptr_staging_buf_arr_handles = 0;
+	if (resources->schedule == A2A_SCHEDULE_BRUCK) {
+		result = prepare_dpa_a2a_staging_memory(resources);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to prepare DOCA DPA staging memory: %s", doca_error_get_descr(result));
+			goto destroy_rdmas;
+		}
+	}
+
 	/* Prepare DOCA DPA all to all memory */
 	result = prepare_dpa_a2a_memory(resources);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to prepare DOCA DPA memory resources: %s", doca_error_get_descr(result));
-		goto destroy_rdmas;
+		goto destroy_staging;
 	}
 
 	return result;
 
+destroy_staging:
+	tmp_result = destroy_dpa_a2a_staging_memory(resources);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
 destroy_rdmas:
 	tmp_result = doca_dpa_mem_free(resources->doca_dpa, resources->devptr_rdmas);
 	if (tmp_result != DOCA_SUCCESS) {
@@ -1437,6 +1677,8 @@ dpa_a2a_destroy(struct a2a_resources *resources)
 	}
 	free(resources->rp_kernel_events_dpa_handles);
 	free(resources->rp_kernel_events);
+	tmp_result = destroy_dpa_a2a_staging_memory(resources);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
 	tmp_result = doca_dpa_mem_free(resources->doca_dpa, resources->devptr_recvbufs_buf_arr_handles);
 	if (tmp_result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to free DOCA DPA device memory: %s", doca_error_get_descr(tmp_result));
@@ -1594,6 +1836,9 @@ dpa_ialltoall(void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf
 		req->resources->comm = comm;
 		req->resources->mesg_count = sendcount;
 		req->resources->msg_type = sendtype;
+		req->resources->recv_count = recvcount;
+		req->resources->recv_type = recvtype;
+		req->resources->comm_tag = 0;
 		req->resources->my_rank = my_rank;
 		req->resources->num_ranks = num_ranks;
 		req->resources->sendbuf = sendbuf;
@@ -1602,12 +1847,20 @@ dpa_ialltoall(void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf
 		if (result != DOCA_SUCCESS) {
 			DOCA_LOG_ERR("Failed to initialize alltoall resources: %s", doca_error_get_descr(result));
 			free(req->resources);
+			req->resources = NULL;
 			return result;
 		}
 	}
 
-	/* The number of threads should be the minimum between the number of processes and the maximum number of threads */
-	num_threads = (req->resources->num_ranks < MAX_NUM_THREADS) ? req->resources->num_ranks : MAX_NUM_THREADS;
+	/*
+	 * The number of threads should be the minimum between the number of processes and the maximum number of threads.
+	 * The Bruck steps depend on each other, so it runs on a single thread.
+	 */
+	if (req->resources->schedule == A2A_SCHEDULE_BRUCK)
+		num_threads = 1;
+	else
+		num_threads = (req->resources->num_ranks < MAX_NUM_THREADS) ? req->resources->num_ranks :
+									       MAX_NUM_THREADS;
 
 	/* Increment the sequence number */
 	req->resources->a2a_seq_num++;
@@ -1621,7 +1874,10 @@ dpa_ialltoall(void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf
 					(uint64_t)num_ranks, (uint64_t)my_rank,
 					(uint64_t)(req->resources->devptr_recvbufs_buf_arr_handles),
 					req->resources->devptr_kernel_events_handle,
-					req->resources->devptr_rp_remote_kernel_events, req->resources->a2a_seq_num);
+					req->resources->devptr_rp_remote_kernel_events, req->resources->a2a_seq_num,
+					(uint64_t)req->resources->schedule,
+					(uint64_t)(req->resources->staging_dpa_buf_arr),
+					req->resources->devptr_staging_buf_arr_handles);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to launch alltoall kernel: %s", doca_error_get_descr(result));
 		return result;
@@ -1664,6 +1920,673 @@ dpa_alltoall(void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
 	return result;
 }
 
+/*
+ * Destroy cached alltoall resources and remove them from the cache.
+ * When drop_comm is set and no other cached resources use the same MPI communicator, its tag attribute is deleted too.
+ *
+ * @a2a_comm [in]: Persistent DPA alltoall communicator
+ * @idx [in]: The index of the cached resources to destroy
+ * @drop_comm [in]: True to delete the tag attribute of the MPI communicator when it has no more cached resources
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+a2a_comm_evict(struct dpa_a2a_comm *a2a_comm, int idx, bool drop_comm)
+{
+	struct dpa_a2a_request req = {.resources = a2a_comm->cache[idx]};
+	MPI_Comm comm = req.resources->comm;
+	uint64_t comm_tag = req.resources->comm_tag;
+	doca_error_t result;
+	int i;
+
+	a2a_comm->nb_cached--;
+	memmove(&a2a_comm->cache[idx], &a2a_comm->cache[idx + 1],
+		(a2a_comm->nb_cached - idx) * sizeof(a2a_comm->cache[0]));
+	memmove(&a2a_comm->cache_ids[idx], &a2a_comm->cache_ids[idx + 1],
+		(a2a_comm->nb_cached - idx) * sizeof(a2a_comm->cache_ids[0]));
+
+	result = dpa_a2a_req_finalize(&req);
+	if (result != DOCA_SUCCESS)
+		DOCA_LOG_ERR("Failed to destroy cached a2a resources: %s", doca_error_get_descr(result));
+
+	if (!drop_comm)
+		return result;
+
+	for (i = 0; i < a2a_comm->nb_cached; i++) {
+		if (a2a_comm->cache[i]->comm_tag == comm_tag)
+			return result;
+	}
+
+	/* The attribute deletion callback finds no resources left to destroy */
+	if (MPI_Comm_delete_attr(comm, a2a_comm->comm_keyval) != MPI_SUCCESS) {
+		DOCA_LOG_ERR("Failed to delete the persistent communicator tag attribute");
+		DOCA_ERROR_PROPAGATE(result, DOCA_ERROR_DRIVER);
+	}
+
+	return result;
+}
+
+/*
+ * MPI attribute deletion callback, called when a communicator with cached resources is freed or when its tag
+ * attribute is deleted. Destroys all the resources cached for the communicator.
+ *
+ * @comm [in]: The MPI communicator
+ * @keyval [in]: The persistent communicator keyval
+ * @attribute_val [in]: The tag of the MPI communicator
+ * @extra_state [in]: Persistent DPA alltoall communicator
+ * @return: MPI_SUCCESS on success and MPI_ERR_OTHER otherwise
+ */
+static int
+a2a_comm_delete_attr(MPI_Comm comm, int keyval, void *attribute_val, void *extra_state)
+{
+	struct dpa_a2a_comm *a2a_comm = extra_state;
+	uint64_t comm_tag = (uintptr_t)attribute_val;
+	doca_error_t result = DOCA_SUCCESS, tmp_result;
+	int i = 0;
+
+	(void)comm;
+	(void)keyval;
+
+	while (i < a2a_comm->nb_cached) {
+		if (a2a_comm->cache[i]->comm_tag != comm_tag) {
+			i++;
+			continue;
+		}
+		tmp_result = a2a_comm_evict(a2a_comm, i, false);
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+
+	return (result == DOCA_SUCCESS) ? MPI_SUCCESS : MPI_ERR_OTHER;
+}
+
+doca_error_t
+dpa_a2a_comm_create(struct dpa_a2a_comm **a2a_comm)
+{
+	struct dpa_a2a_comm *new_comm;
+
+	new_comm = calloc(1, sizeof(*new_comm));
+	if (new_comm == NULL) {
+		DOCA_LOG_ERR("Failed to allocate persistent a2a communicator");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	if (MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, a2a_comm_delete_attr, &new_comm->comm_keyval, new_comm) !=
+	    MPI_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create persistent a2a communicator keyval");
+		free(new_comm);
+		return DOCA_ERROR_DRIVER;
+	}
+	new_comm->next_comm_tag = 1;
+
+	*a2a_comm = new_comm;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+dpa_a2a_comm_destroy(struct dpa_a2a_comm *a2a_comm)
+{
+	doca_error_t result = DOCA_SUCCESS, tmp_result;
+	int nb_cached;
+
+	/* Deleting the tag attribute of a communicator destroys all the resources cached for it */
+	while (a2a_comm->nb_cached > 0) {
+		nb_cached = a2a_comm->nb_cached;
+		if (MPI_Comm_delete_attr(a2a_comm->cache[0]->comm, a2a_comm->comm_keyval) != MPI_SUCCESS) {
+			DOCA_LOG_ERR("Failed to destroy the resources cached for a communicator");
+			DOCA_ERROR_PROPAGATE(result, DOCA_ERROR_DRIVER);
+		}
+		/* The attribute was already deleted, destroy the resources directly */
+		if (a2a_comm->nb_cached == nb_cached) {
+			tmp_result = a2a_comm_evict(a2a_comm, 0, false);
+			DOCA_ERROR_PROPAGATE(result, tmp_result);
+		}
+	}
+	MPI_Comm_free_keyval(&a2a_comm->comm_keyval);
+	free(a2a_comm);
+
+	return result;
+}
+
+doca_error_t
+dpa_a2a_comm_invalidate(struct dpa_a2a_comm *a2a_comm, void *buf)
+{
+	doca_error_t result = DOCA_SUCCESS, tmp_result;
+	int i = 0;
+
+	while (i < a2a_comm->nb_cached) {
+		if (a2a_comm->cache[i]->sendbuf != buf && a2a_comm->cache[i]->recvbuf != buf) {
+			i++;
+			continue;
+		}
+		tmp_result = a2a_comm_evict(a2a_comm, i, true);
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+
+	return result;
+}
+
+/*
+ * Look for cached alltoall resources matching the call arguments
+ *
+ * @a2a_comm [in]: Persistent DPA alltoall communicator
+ * @comm_tag [in]: The tag of the MPI communicator, 0 if it has no cached resources
+ * @sendbuf [in]: The starting address of send buffer
+ * @sendcount [in]: The number of elements to be sent to each process
+ * @sendtype [in]: The datatype of the send buff elements
+ * @recvbuf [in]: The starting address of the receive buffer
+ * @recvcount [in]: The number of elements to be received from each process
+ * @recvtype [in]: The datatype of the receive buff elements
+ * @return: The index of the matching cached resources, -1 if there is none
+ */
+static int
+a2a_comm_cache_lookup(struct dpa_a2a_comm *a2a_comm, uint64_t comm_tag, void *sendbuf, int sendcount,
+		      MPI_Datatype sendtype, void *recvbuf, int recvcount, MPI_Datatype recvtype)
+{
+	struct a2a_resources *resources;
+	int i;
+
+	if (comm_tag == 0)
+		return -1;
+
+	for (i = 0; i < a2a_comm->nb_cached; i++) {
+		resources = a2a_comm->cache[i];
+		if (resources->comm_tag == comm_tag && resources->sendbuf == sendbuf &&
+		    resources->recvbuf == recvbuf && resources->mesg_count == sendcount &&
+		    resources->msg_type == sendtype && resources->recv_count == recvcount &&
+		    resources->recv_type == recvtype)
+			return i;
+	}
+
+	return -1;
+}
+
+/*
+ * Get the alltoall resources to use for a call, either cached ones or newly created ones.
+ * The hit or miss decision is taken collectively: cached resources are reused only if every rank of the
+ * communicator found the same cached entry, otherwise all the ranks create and cache new resources.
+ *
+ * @a2a_comm [in]: Persistent DPA alltoall communicator
+ * @sendbuf [in]: The starting address of send buffer
+ * @sendcount [in]: The number of elements to be sent to each process
+ * @sendtype [in]: The datatype of the send buff elements
+ * @recvbuf [in]: The starting address of the receive buffer
+ * @recvcount [in]: The number of elements to be received from each process
+ * @recvtype [in]: The datatype of the receive buff elements
+ * @comm [in]: The communicator over which the data is to be exchanged
+ * @req [out]: DPA alltoall request holding the resources, launched with the alltoall kernel
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+a2a_comm_launch(struct dpa_a2a_comm *a2a_comm, void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+		int recvcount, MPI_Datatype recvtype, MPI_Comm comm, struct dpa_a2a_request *req)
+{
+	struct a2a_resources *resources;
+	long long local_ids[2], global_ids[2];
+	void *attribute_val;
+	uint64_t id, comm_tag = 0;
+	doca_error_t result;
+	int idx, found;
+
+	if (MPI_Comm_get_attr(comm, a2a_comm->comm_keyval, &attribute_val, &found) != MPI_SUCCESS) {
+		DOCA_LOG_ERR("Failed to get the persistent communicator tag attribute");
+		return DOCA_ERROR_DRIVER;
+	}
+	if (found)
+		comm_tag = (uintptr_t)attribute_val;
+
+	idx = a2a_comm_cache_lookup(a2a_comm, comm_tag, sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype);
+
+	/* Reduce both the minimum and the (negated) maximum cached id over all the ranks */
+	local_ids[0] = (idx < 0) ? -1 : (long long)a2a_comm->cache_ids[idx];
+	local_ids[1] = -local_ids[0];
+	MPI_Allreduce(local_ids, global_ids, 2, MPI_LONG_LONG, MPI_MIN, comm);
+
+	if (global_ids[0] >= 0 && global_ids[0] == -global_ids[1]) {
+		/* Cache hit on all ranks, move the resources to the front and only relaunch the kernel */
+		resources = a2a_comm->cache[idx];
+		id = a2a_comm->cache_ids[idx];
+		memmove(&a2a_comm->cache[1], &a2a_comm->cache[0], idx * sizeof(a2a_comm->cache[0]));
+		memmove(&a2a_comm->cache_ids[1], &a2a_comm->cache_ids[0], idx * sizeof(a2a_comm->cache_ids[0]));
+		a2a_comm->cache[0] = resources;
+		a2a_comm->cache_ids[0] = id;
+		a2a_comm->hits++;
+
+		req->resources = resources;
+		return dpa_ialltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm, req);
+	}
+
+	/* Cache miss on at least one rank, evict the least recently used resources if the cache is full */
+	a2a_comm->misses++;
+	if (a2a_comm->nb_cached == MAX_CACHED_A2A_RESOURCES) {
+		result = a2a_comm_evict(a2a_comm, a2a_comm->nb_cached - 1, true);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to destroy evicted a2a resources: %s", doca_error_get_descr(result));
+			return result;
+		}
+		/* The eviction may have deleted the tag of this communicator */
+		if (MPI_Comm_get_attr(comm, a2a_comm->comm_keyval, &attribute_val, &found) != MPI_SUCCESS) {
+			DOCA_LOG_ERR("Failed to get the persistent communicator tag attribute");
+			return DOCA_ERROR_DRIVER;
+		}
+		comm_tag = found ? (uintptr_t)attribute_val : 0;
+	}
+
+	/* Tag the communicator so that freeing it destroys its cached resources */
+	if (comm_tag == 0) {
+		comm_tag = a2a_comm->next_comm_tag;
+		if (MPI_Comm_set_attr(comm, a2a_comm->comm_keyval, (void *)(uintptr_t)comm_tag) != MPI_SUCCESS) {
+			DOCA_LOG_ERR("Failed to set the persistent communicator tag attribute");
+			return DOCA_ERROR_DRIVER;
+		}
+		a2a_comm->next_comm_tag++;
+	}
+
+	req->resources = NULL;
+	result = dpa_ialltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm, req);
+	if (result != DOCA_SUCCESS) {
+		/* Drop the tag if the communicator has no cached resources */
+		for (idx = 0; idx < a2a_comm->nb_cached; idx++) {
+			if (a2a_comm->cache[idx]->comm_tag == comm_tag)
+				break;
+		}
+		if (idx == a2a_comm->nb_cached)
+			MPI_Comm_delete_attr(comm, a2a_comm->comm_keyval);
+		if (req->resources != NULL) {
+			dpa_a2a_req_finalize(req);
+			req->resources = NULL;
+		}
+		return result;
+	}
+	req->resources->comm_tag = comm_tag;
+
+	/* Ids are assigned in the same order on all the ranks since misses are collective */
+	memmove(&a2a_comm->cache[1], &a2a_comm->cache[0], a2a_comm->nb_cached * sizeof(a2a_comm->cache[0]));
+	memmove(&a2a_comm->cache_ids[1], &a2a_comm->cache_ids[0], a2a_comm->nb_cached * sizeof(a2a_comm->cache_ids[0]));
+	a2a_comm->cache[0] = req->resources;
+	a2a_comm->cache_ids[0] = a2a_comm->next_id++;
+	a2a_comm->nb_cached++;
+
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+dpa_alltoall_persistent(struct dpa_a2a_comm *a2a_comm, void *sendbuf, int sendcount, MPI_Datatype sendtype,
+			void *recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm)
+{
+	struct dpa_a2a_request req = {.resources = NULL};
+	doca_error_t result;
+
+	/* If current process is not part of any communicator then exit */
+	if (comm == MPI_COMM_NULL)
+		return DOCA_SUCCESS;
+
+	/* Run DPA All to All non-blocking, reusing the cached resources when possible */
+	result = a2a_comm_launch(a2a_comm, sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm, &req);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to launch persistent alltoall: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Wait till the DPA All to All finishes */
+	result = dpa_a2a_req_wait(&req);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("dpa_a2a_req_wait() failed: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/*
+	 * Wait until all processes finish waiting, so no rank writes the next call data into a receive buffer that
+	 * is still being consumed. The request resources are kept in the cache and not finalized.
+	 */
+	MPI_Barrier(comm);
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Benchmark the persistent alltoall on a communicator, for message sizes doubling up to max_msg_size.
+ * For every message size, reports the first call latency, which includes the resources creation, and the
+ * steady-state latency of the following calls, which only relaunch the kernel.
+ *
+ * @comm [in]: The communicator to benchmark
+ * @iters [in]: Number of steady-state iterations per message size
+ * @max_msg_size [in]: Largest message size (in bytes)
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+benchmark_comm(MPI_Comm comm, int iters, size_t max_msg_size)
+{
+	struct dpa_a2a_comm *a2a_comm;
+	int my_rank, num_ranks, i;
+	size_t msg_size, msg_count;
+	double start, local_lat[2], max_lat[2];
+	int *send_buf, *recv_buf;
+	doca_error_t result, tmp_result;
+
+	MPI_Comm_rank(comm, &my_rank);
+	MPI_Comm_size(comm, &num_ranks);
+
+	/* The same buffers are used for all the message sizes, each size gets its own cached resources */
+	send_buf = calloc(max_msg_size, 1);
+	recv_buf = calloc(max_msg_size, 1);
+	if (send_buf == NULL || recv_buf == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory for send/recv buffers");
+		free(send_buf);
+		free(recv_buf);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	result = dpa_a2a_comm_create(&a2a_comm);
+	if (result != DOCA_SUCCESS)
+		goto destroy_bufs;
+
+	for (msg_size = num_ranks * sizeof(int); msg_size <= max_msg_size; msg_size *= 2) {
+		msg_count = (msg_size / num_ranks) / sizeof(int);
+
+		MPI_Barrier(comm);
+		start = MPI_Wtime();
+		result = dpa_alltoall_persistent(a2a_comm, send_buf, msg_count, MPI_INT, recv_buf, msg_count, MPI_INT,
+						 comm);
+		if (result != DOCA_SUCCESS)
+			break;
+		local_lat[0] = MPI_Wtime() - start;
+
+		start = MPI_Wtime();
+		for (i = 0; i < iters && result == DOCA_SUCCESS; i++)
+			result = dpa_alltoall_persistent(a2a_comm, send_buf, msg_count, MPI_INT, recv_buf, msg_count,
+							 MPI_INT, comm);
+		if (result != DOCA_SUCCESS)
+			break;
+		local_lat[1] = (MPI_Wtime() - start) / iters;
+
+		/* The alltoall latency is the one of the slowest rank */
+		MPI_Reduce(local_lat, max_lat, 2, MPI_DOUBLE, MPI_MAX, 0, comm);
+		if (my_rank == 0)
+			printf("%8d %12lu %16.2f %16.2f %10.1fx\n", num_ranks, msg_size, max_lat[0] * 1e6, max_lat[1] * 1e6,
+			       max_lat[0] / max_lat[1]);
+	}
+
+	if (my_rank == 0)
+		DOCA_LOG_DBG("Persistent communicator of %d ranks: %lu cache hits, %lu cache misses", num_ranks,
+			     a2a_comm->hits, a2a_comm->misses);
+
+	tmp_result = dpa_a2a_comm_destroy(a2a_comm);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+destroy_bufs:
+	free(send_buf);
+	free(recv_buf);
+
+	return result;
+}
+
+/*
+ * Benchmark the persistent alltoall over communicators of increasing number of ranks, up to all the processes
+ *
+ * @cfg [in]: All to all user configurations
+ * @my_rank [in]: Rank of the current process in MPI_COMM_WORLD
+ * @num_ranks [in]: Number of processes in MPI_COMM_WORLD
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+run_a2a_benchmark(struct a2a_config *cfg, int my_rank, int num_ranks)
+{
+	MPI_Comm comm;
+	size_t max_msg_size;
+	int comm_size, local_result, global_result;
+	doca_error_t result = DOCA_SUCCESS;
+
+	max_msg_size = (cfg->msgsize == MESSAGE_SIZE_DEFAULT_LEN) ? BENCHMARK_MAX_MSG_SIZE : (size_t)cfg->msgsize;
+	if (max_msg_size < num_ranks * sizeof(int)) {
+		if (my_rank == 0)
+			DOCA_LOG_ERR("Message size %lu too small for the number of processes. Should be at least %lu",
+				     max_msg_size, num_ranks * sizeof(int));
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (my_rank == 0)
+		printf("%8s %12s %16s %16s %11s\n", "ranks", "msgsize[B]", "first call[us]", "steady[us]", "speedup");
+
+	comm_size = (num_ranks < 2) ? num_ranks : 2;
+	while (true) {
+		/* The first comm_size ranks take part in this round, the rest get MPI_COMM_NULL */
+		MPI_Comm_split(MPI_COMM_WORLD, (my_rank < comm_size) ? 0 : MPI_UNDEFINED, my_rank, &comm);
+		if (comm != MPI_COMM_NULL) {
+			result = benchmark_comm(comm, cfg->benchmark_iters, max_msg_size);
+			MPI_Comm_free(&comm);
+		}
+
+		/* Stop all the processes if one of them failed */
+		local_result = result;
+		MPI_Allreduce(&local_result, &global_result, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+		if (global_result != DOCA_SUCCESS) {
+			if (my_rank == 0)
+				DOCA_LOG_ERR("DPA alltoall benchmark failed on %d ranks: %s", comm_size,
+					     doca_error_get_descr(global_result));
+			return (doca_error_t)global_result;
+		}
+
+		if (comm_size == num_ranks)
+			break;
+		comm_size = (comm_size * 2 < num_ranks) ? comm_size * 2 : num_ranks;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+/* Names of the alltoall schedules, indexed by enum a2a_schedule */
+static const char *const a2a_schedule_names[] = {"linear", "pairwise", "bruck", "auto"};
+
+/* Per process statistics of a simulated alltoall schedule */
+struct a2a_sim_stats {
+	unsigned int rounds;		/* Rounds of concurrent RDMA writes */
+	unsigned int waits;		/* Signals each process waits for */
+	uint64_t writes;		/* RDMA writes each process posts */
+	uint64_t bytes;			/* Bytes each process writes */
+	unsigned int max_incast;	/* Largest number of processes that write to the same process in a round */
+	double mean_incast;		/* Mean number of processes that write to a process written in a round */
+};
+
+/*
+ * Simulate the linear and pairwise schedules as the kernel runs them: every process runs min(num_ranks,
+ * MAX_NUM_THREADS) threads and thread t posts the steps t, t + num_threads, ... Threads are assumed to progress in
+ * lock step, so round q holds the steps q * num_threads to (q + 1) * num_threads - 1 of all the processes.
+ * Also checks that every process writes exactly once to every process.
+ *
+ * @schedule [in]: A2A_SCHEDULE_LINEAR or A2A_SCHEDULE_PAIRWISE
+ * @num_ranks [in]: Number of simulated processes
+ * @block_size [in]: Size of the data sent to each process (in bytes)
+ * @stats [out]: Statistics of the schedule
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+simulate_direct_schedule(enum a2a_schedule schedule, unsigned int num_ranks, size_t block_size,
+			 struct a2a_sim_stats *stats)
+{
+	unsigned int num_threads = (num_ranks < MAX_NUM_THREADS) ? num_ranks : MAX_NUM_THREADS;
+	unsigned int *incast, round, rank, thread, step, dst, round_max, round_targets;
+	uint64_t nb_targets = 0, nb_writes = 0;
+	uint8_t *written;
+	doca_error_t result = DOCA_SUCCESS;
+
+	incast = calloc(num_ranks, sizeof(*incast));
+	written = calloc((size_t)num_ranks * num_ranks, sizeof(*written));
+	if (incast == NULL || written == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory for schedule simulation");
+		free(incast);
+		free(written);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	stats->rounds = (num_ranks + num_threads - 1) / num_threads;
+	for (round = 0; round < stats->rounds; round++) {
+		memset(incast, 0, num_ranks * sizeof(*incast));
+		for (rank = 0; rank < num_ranks; rank++) {
+			for (thread = 0; thread < num_threads; thread++) {
+				step = round * num_threads + thread;
+				if (step >= num_ranks)
+					break;
+				dst = a2a_schedule_send_peer(schedule, rank, step, num_ranks);
+				incast[dst]++;
+				written[(size_t)rank * num_ranks + dst]++;
+			}
+		}
+
+		round_max = 0;
+		round_targets = 0;
+		for (dst = 0; dst < num_ranks; dst++) {
+			if (incast[dst] == 0)
+				continue;
+			round_targets++;
+			nb_writes += incast[dst];
+			if (incast[dst] > round_max)
+				round_max = incast[dst];
+		}
+		nb_targets += round_targets;
+		if (round_max > stats->max_incast)
+			stats->max_incast = round_max;
+		DOCA_LOG_DBG("%s round %u: %u processes written, max incast %u", a2a_schedule_names[schedule], round,
+			     round_targets, round_max);
+	}
+
+	for (rank = 0; rank < num_ranks * num_ranks; rank++) {
+		if (written[rank] != 1) {
+			DOCA_LOG_ERR("%s schedule: process %u writes %u times to process %u",
+				     a2a_schedule_names[schedule], rank / num_ranks, written[rank], rank % num_ranks);
+			result = DOCA_ERROR_UNEXPECTED;
+			break;
+		}
+	}
+
+	stats->waits = num_ranks;
+	stats->writes = num_ranks;
+	stats->bytes = num_ranks * block_size;
+	stats->mean_incast = (double)nb_writes / nb_targets;
+
+	free(incast);
+	free(written);
+	return result;
+}
+
+/*
+ * Simulate the Bruck schedule with the same block routing as the kernel, moving block ids instead of data through
+ * the receive and staging buffers of all the processes, and check that every process receives the right blocks.
+ *
+ * @num_ranks [in]: Number of simulated processes
+ * @block_size [in]: Size of the data sent to each process (in bytes)
+ * @stats [out]: Statistics of the schedule
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+simulate_bruck_schedule(unsigned int num_ranks, size_t block_size, struct a2a_sim_stats *stats)
+{
+	unsigned int num_steps = a2a_schedule_num_steps(A2A_SCHEDULE_BRUCK, num_ranks);
+	unsigned int nb_slots = (num_steps > 1) ? num_steps - 1 : 1;
+	unsigned int step, rank, block, peer, value, step_writes;
+	uint32_t *recv, *staging;
+	size_t n = num_ranks;
+	doca_error_t result = DOCA_SUCCESS;
+	int slot;
+
+	recv = calloc(n * n, sizeof(*recv));
+	staging = calloc(n * nb_slots * n, sizeof(*staging));
+	if (recv == NULL || staging == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory for schedule simulation");
+		free(recv);
+		free(staging);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	/* The block that process r sends to process d has the id r * n + d, the own block does not move */
+	memset(stats, 0, sizeof(*stats));
+	for (rank = 0; rank < num_ranks; rank++)
+		recv[rank * n + rank] = rank * n + rank;
+	stats->writes = 1;
+
+	for (step = 0; step < num_steps; step++) {
+		step_writes = 0;
+		for (rank = 0; rank < num_ranks; rank++) {
+			peer = a2a_schedule_send_peer(A2A_SCHEDULE_BRUCK, rank, step, num_ranks);
+			for (block = 1U << step; block < num_ranks; block++) {
+				if (!(block & (1U << step)))
+					continue;
+
+				slot = a2a_bruck_src_slot(block, step);
+				if (slot < 0)
+					value = rank * n + (rank + block) % num_ranks;
+				else
+					value = staging[(rank * nb_slots + slot) * n + block];
+
+				if (a2a_bruck_is_final(block, step))
+					recv[peer * n + a2a_bruck_origin(rank, block, step, num_ranks)] = value;
+				else
+					staging[(peer * nb_slots + step) * n + block] = value;
+				if (rank == 0)
+					step_writes++;
+			}
+		}
+		stats->writes += step_writes;
+		DOCA_LOG_DBG("bruck step %u: %u processes written, max incast 1, %u blocks per process", step,
+			     num_ranks, step_writes);
+	}
+
+	for (rank = 0; rank < num_ranks && result == DOCA_SUCCESS; rank++) {
+		for (peer = 0; peer < num_ranks; peer++) {
+			if (recv[rank * n + peer] != peer * n + rank) {
+				DOCA_LOG_ERR("bruck schedule: process %u received block %u instead of %lu from process %u",
+					     rank, recv[rank * n + peer], peer * n + rank, peer);
+				result = DOCA_ERROR_UNEXPECTED;
+				break;
+			}
+		}
+	}
+
+	/* Every process writes to a single process per step, which has a single writer */
+	stats->rounds = num_steps;
+	stats->waits = num_steps;
+	stats->bytes = stats->writes * block_size;
+	stats->max_incast = (num_steps > 0) ? 1 : 0;
+	stats->mean_incast = stats->max_incast;
+
+	free(recv);
+	free(staging);
+	return result;
+}
+
+/*
+ * Simulate all the alltoall schedules without DPA and print their per process costs and their incast, which is
+ * the number of processes writing to the same process concurrently
+ *
+ * @num_ranks [in]: Number of simulated processes
+ * @block_size [in]: Size of the data sent to each process (in bytes)
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+simulate_a2a_schedules(unsigned int num_ranks, size_t block_size)
+{
+	struct a2a_sim_stats stats;
+	enum a2a_schedule schedule;
+	doca_error_t result;
+
+	DOCA_LOG_INFO("Simulating alltoall schedules: number of processes = %u, block size = %lu, auto schedule = %s",
+		      num_ranks, block_size, a2a_schedule_names[resolve_a2a_schedule(A2A_SCHEDULE_AUTO, block_size)]);
+	printf("%10s %8s %8s %10s %14s %12s %12s\n", "schedule", "rounds", "waits", "writes", "bytes", "max incast",
+	       "mean incast");
+
+	for (schedule = A2A_SCHEDULE_LINEAR; schedule < A2A_SCHEDULE_AUTO; schedule++) {
+		if (schedule == A2A_SCHEDULE_BRUCK)
+			result = simulate_bruck_schedule(num_ranks, block_size, &stats);
+		else
+			result = simulate_direct_schedule(schedule, num_ranks, block_size, &stats);
+		if (result != DOCA_SUCCESS)
+			return result;
+
+		printf("%10s %8u %8u %10lu %14lu %12u %12.2f\n", a2a_schedule_names[schedule], stats.rounds,
+		       stats.waits, stats.writes, stats.bytes, stats.max_incast, stats.mean_incast);
+	}
+
+	return DOCA_SUCCESS;
+}
+
 doca_error_t
 dpa_a2a(int argc, char **argv, struct a2a_config *cfg)
 {
@@ -1677,12 +2600,37 @@ dpa_a2a(int argc, char **argv, struct a2a_config *cfg)
 	MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
 	MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
 
+	/* The simulation runs on the host of the first process only */
+	if (cfg->simulate_ranks > 0) {
+		if (my_rank != 0)
+			return DOCA_SUCCESS;
+		msg_size = (cfg->msgsize == MESSAGE_SIZE_DEFAULT_LEN) ? cfg->simulate_ranks * sizeof(int) :
+									  (size_t)cfg->msgsize;
+		if (msg_size / cfg->simulate_ranks == 0) {
+			DOCA_LOG_ERR("Message size %lu too small for the number of simulated processes", msg_size);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		return simulate_a2a_schedules(cfg->simulate_ranks, msg_size / cfg->simulate_ranks);
+	}
+
 	if (num_ranks > MAX_NUM_PROC) {
 		if (my_rank == 0)
 			DOCA_LOG_ERR("Invalid number of processes. Maximum number of processes is %d", MAX_NUM_PROC);
 		return DOCA_ERROR_INVALID_VALUE;
 	}
 
+	/* Set devices names */
+	strcpy(device1_name, cfg->device1_name);
+	if (strncmp(cfg->device2_name, IB_DEVICE_DEFAULT_NAME, strlen(IB_DEVICE_DEFAULT_NAME)) != 0)
+		strcpy(device2_name, cfg->device2_name);
+	else
+		strcpy(device2_name, cfg->device1_name);
+
+	a2a_schedule = cfg->schedule;
+
+	if (cfg->benchmark_iters > 0)
+		return run_a2a_benchmark(cfg, my_rank, num_ranks);
+
 	/*
 	 * Define message size, message count and buffer size
 	 * If it's the default then the message size is the number of processes times size of one integer
@@ -1701,13 +2649,6 @@ dpa_a2a(int argc, char **argv, struct a2a_config *cfg)
 
 	buff_size = msg_size / sizeof(int);
 
-	/* Set devices names */
-	strcpy(device1_name, cfg->device1_name);
-	if (strncmp(cfg->device2_name, IB_DEVICE_DEFAULT_NAME, strlen(IB_DEVICE_DEFAULT_NAME)) != 0)
-		strcpy(device2_name, cfg->device2_name);
-	else
-		strcpy(device2_name, cfg->device1_name);
-
 	if (my_rank == 0)
 		DOCA_LOG_INFO("Number of processes = %d, message size = %lu, message count = %lu, buffer size = %lu"
 				, num_ranks, msg_size, msg_count, buff_size);
@@ -24,6 +24,8 @@
 #include <doca_sync_event.h>
 #include <doca_rdma.h>
 
+#include "../common/dpa_all_to_all_common.h"
+
 #define MAX_DEVICES (2)							/* Max number of IB devices to use*/
 #define MAX_USER_IB_DEVICE_NAME_LEN (256)				/* Maximum user IB device name string length */
 #define MAX_IB_DEVICE_NAME_LEN (MAX_USER_IB_DEVICE_NAME_LEN + 1)	/* Maximum IB device name string length */
@@ -32,12 +34,25 @@
 #define MESSAGE_SIZE_DEFAULT_LEN (-1)					/* Message size default length */
 #define MAX_NUM_PROC (16)						/* Maximum number of processes */
 #define SYNC_EVENT_MASK_FFS (0xFFFFFFFFFFFFFFFF)			/* Mask for doca_sync_event_wait_gt() wait value */
+#define MAX_CACHED_A2A_RESOURCES (4)					/* Maximum number of cached alltoall resources */
+#define BENCHMARK_ITERATIONS_DEFAULT (0)				/* Benchmark iterations default, 0 disables it */
+#define BENCHMARK_MAX_MSG_SIZE (1 << 20)				/* Largest benchmarked message size (in bytes) */
+#define SCHEDULE_DEFAULT (A2A_SCHEDULE_AUTO)				/* Alltoall schedule default */
+#define SIMULATE_RANKS_DEFAULT (0)					/* Simulated number of processes default, 0 disables it */
+#define MAX_SIMULATE_RANKS (1024)					/* Maximum simulated number of processes */
 
 /* Configuration struct */
 struct a2a_config {
 	int msgsize;						/* Message size of sendbuf (in bytes) */
 	char device1_name[MAX_IB_DEVICE_NAME_LEN];		/* Buffer that holds the IB device name */
 	char device2_name[MAX_IB_DEVICE_NAME_LEN];		/* Buffer that holds the IB device name */
+	int benchmark_iters;					/* Number of benchmark iterations per message size,
+								 * 0 to run a single alltoall
+								 */
+	enum a2a_schedule schedule;				/* Alltoall schedule of the DPA kernel */
+	int simulate_ranks;					/* Number of processes to simulate the schedules for
+								 * without DPA, 0 to run on DPA
+								 */
 };
 
 /* A struct that includes all the resources needed for DPA */
@@ -69,12 +84,25 @@ struct a2a_resources {
 	struct doca_buf_arr **from_export_buf_arrs;				/* DOCA buf arrays from exported mmaps */
 	struct doca_dpa_dev_buf_arr **from_export_dpa_buf_arrs;			/* DOCA buf array DPA handles from exported mmaps */
 	doca_dpa_dev_uintptr_t devptr_recvbufs_buf_arr_handles;			/* DOCA DPA recvbuf buf array handles device pointers */
+	enum a2a_schedule schedule;						/* Alltoall schedule resolved for the message size */
+	void *staging_buf;							/* Bruck staging buffer for the blocks forwarded through this process */
+	size_t staging_buf_size;						/* Bruck staging buffer size, 0 for the other schedules */
+	struct doca_mmap *staging_mmap;						/* DOCA mmap for the staging buffer */
+	struct doca_buf_arr *staging_buf_arr;					/* DOCA buf array for the staging buffer */
+	struct doca_dpa_dev_buf_arr *staging_dpa_buf_arr;			/* DOCA buf array DPA handle for the staging buffer */
+	struct doca_mmap **staging_export_mmaps;				/* DOCA mmap export of the staging buffers of remote processes */
+	struct doca_buf_arr **staging_from_export_buf_arrs;			/* DOCA buf arrays from exported staging mmaps */
+	struct doca_dpa_dev_buf_arr **staging_from_export_dpa_buf_arrs;		/* DOCA buf array DPA handles from exported staging mmaps */
+	doca_dpa_dev_uintptr_t devptr_staging_buf_arr_handles;			/* DOCA DPA staging buf array handles device pointers */
 	int num_ranks;								/* Number of running processes */
 	int my_rank;								/* Rank of the current process */
 	int mesg_count;								/* Message count */
 	MPI_Datatype msg_type;							/* MPI Datatype of the message */
+	int recv_count;								/* Receive message count */
+	MPI_Datatype recv_type;							/* MPI Datatype of the received message */
 	MPI_Aint extent;							/* The extent of the message type */
 	MPI_Comm comm;								/* MPI communication group */
+	uint64_t comm_tag;							/* Persistent communicator tag of comm, 0 if not cached */
 };
 
 /* DPA Alltoall request that is used to check the completion of the non-blocking alltoall call */
@@ -82,6 +110,28 @@ struct dpa_a2a_request {
 	struct a2a_resources *resources;			/* Alltoall resources */
 };
 
+/*
+ * Persistent DPA alltoall communicator.
+ * Caches the alltoall resources (mmaps, RDMA contexts, sync events and the exchanged connection details) per
+ * (comm, sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype) so that repeated calls with the same arguments
+ * only relaunch the kernel. Cache hits and evictions are decided collectively, so all the ranks of a communicator
+ * always use matching entries.
+ * MPI communicators are identified by a tag stored as a communicator attribute rather than by their handle, which MPI
+ * may reuse once freed, and freeing a communicator destroys the resources cached for it.
+ * The cached resources keep the send and receive buffers registered, so a buffer must stay allocated until it is
+ * released with dpa_a2a_comm_invalidate() or the communicator is destroyed with dpa_a2a_comm_destroy().
+ */
+struct dpa_a2a_comm {
+	struct a2a_resources *cache[MAX_CACHED_A2A_RESOURCES];	/* Cached resources, most recently used first */
+	uint64_t cache_ids[MAX_CACHED_A2A_RESOURCES];		/* Creation id of the cached resources, same on all ranks */
+	int nb_cached;						/* Number of cached resources */
+	uint64_t next_id;					/* Creation id of the next cached resources */
+	int comm_keyval;					/* MPI attribute keyval holding the tag of a cached comm */
+	uint64_t next_comm_tag;					/* Tag of the next MPI communicator with cached resources */
+	uint64_t hits;						/* Number of calls that reused cached resources */
+	uint64_t misses;					/* Number of calls that created new resources */
+};
+
 /*
  * Check if the provided device name is a name of a valid IB device with DPA capabilities
  *
@@ -156,6 +206,53 @@ doca_error_t dpa_ialltoall(void *sendbuf, int sendcount, MPI_Datatype sendtype,
 doca_error_t dpa_alltoall(void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf, int recvcount,
 				MPI_Datatype recvtype, MPI_Comm comm);
 
+/*
+ * Create a persistent DPA alltoall communicator
+ *
+ * @a2a_comm [out]: The created communicator
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t dpa_a2a_comm_create(struct dpa_a2a_comm **a2a_comm);
+
+/*
+ * Destroy a persistent DPA alltoall communicator and all its cached resources
+ *
+ * @a2a_comm [in]: The communicator to destroy
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t dpa_a2a_comm_destroy(struct dpa_a2a_comm *a2a_comm);
+
+/*
+ * Destroy the cached resources using a buffer, must be called before freeing a buffer passed to
+ * dpa_alltoall_persistent() if the persistent communicator is still in use.
+ * This is a local call: the next alltoall over the same arguments is a collective cache miss and creates new resources.
+ *
+ * @a2a_comm [in]: Persistent DPA alltoall communicator
+ * @buf [in]: The starting address of a send or receive buffer
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t dpa_a2a_comm_invalidate(struct dpa_a2a_comm *a2a_comm, void *buf);
+
+/*
+ * MPI blocking all to all using DOCA DPA and a persistent communicator. The resources of a call are kept in the
+ * communicator cache and reused by the next calls with the same buffers, counts, datatypes and MPI communicator.
+ * The buffers must stay allocated until they are invalidated or the persistent communicator is destroyed.
+ * This is a collective call, all the ranks of comm must call it with the same persistent communicator.
+ *
+ * @a2a_comm [in]: Persistent DPA alltoall communicator
+ * @sendbuf [in]: The starting address of send buffer
+ * @sendcount [in]: The number of elements to be sent to each process
+ * @sendtype [in]: The datatype of the receive buff elements
+ * @recvbuf [in]: The starting address of the receive buffer
+ * @recvcount [in]: The number of elements to be received from each process
+ * @recvtype [in]: The datatype of the send buff elements
+ * @comm [in]: The communicator over which the data is to be exchanged
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t dpa_alltoall_persistent(struct dpa_a2a_comm *a2a_comm, void *sendbuf, int sendcount,
+				     MPI_Datatype sendtype, void *recvbuf, int recvcount, MPI_Datatype recvtype,
+				     MPI_Comm comm);
+
 /*
  * Perform all to all example using DOCA DPA
  *
@@ -14,11 +14,10 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <sys/stat.h>
-#include <sys/mman.h>
 #include <time.h>
 #include <unistd.h>
-#include <zlib.h>
 
 #include <doca_argp.h>
 #include <doca_log.h>
@@ -27,16 +26,65 @@
 #include <utils.h>
 
 #include "file_compression_core.h"
+#include "file_compression_engine.h"
 
 #define MAX_MSG 512				/* Maximum number of messages in CC queue */
-#define SW_MAX_FILE_SIZE 128 * 1024 * 1024	/* 128 MB */
 #define SLEEP_IN_NANOS (10 * 1000)		/* Sample the task every 10 microseconds */
-#define DECOMPRESS_RATIO 1032			/* Maximal decompress ratio size */
 #define DEFAULT_TIMEOUT 10			/* default timeout for receiving messages */
 #define SERVER_NAME "file_compression_server"	/* CC server name */
+#define STREAM_HEADER_MAGIC 0x46435348		/* "FCSH", first field of the stream header message */
+#define STREAM_BLOCK_MAGIC 0x46435342		/* "FCSB", first field of the block header messages */
+#define STREAM_TRAILER_MAGIC 0x46435354		/* "FCST", first field of the stream trailer message */
+#define STREAM_CREDITS_MAGIC 0x46435343		/* "FCSC", first field of the credits messages of the server */
+#define STREAM_FLAG_SINGLE_STREAM (1 << 0)	/* The blocks are the consecutive parts of a single deflate stream */
 
 DOCA_LOG_REGISTER(FILE_COMPRESSION::Core);
 
+/*
+ * The file is streamed in blocks compressed independently, or with STREAM_FLAG_SINGLE_STREAM (zlib, the default without
+ * compress device) in the consecutive parts of a single raw deflate stream, sent in order and inflated one after the
+ * other:
+ *	client: stream header
+ *	server: credits, one per block the server has room for
+ *	client: for every block in the order they are compressed, a block header and the compressed block in
+ *		MAX_MSG_SIZE messages, once it holds a credit
+ *	server: a credit for every block decompressed and written
+ *	client: stream trailer
+ *	server: finish message
+ * The client holds at most the credits it was given, so the memory of both sides is bounded by the blocks in flight
+ * and not by the file size.
+ */
+
+/* First message of the client */
+struct __attribute__((packed)) stream_header {
+	uint32_t magic;			/* STREAM_HEADER_MAGIC, big endian */
+	uint32_t block_size;		/* Uncompressed block size, big endian */
+	uint64_t file_size;		/* File size, big endian */
+	uint32_t nb_blocks;		/* Number of blocks, big endian */
+	uint32_t flags;			/* STREAM_FLAG_* bits, big endian */
+};
+
+/* Block header message, followed by the compressed block */
+struct __attribute__((packed)) stream_block_header {
+	uint32_t magic;			/* STREAM_BLOCK_MAGIC, big endian */
+	uint32_t block_idx;		/* Block index, big endian */
+	uint32_t raw_len;		/* Uncompressed block length, big endian */
+	uint32_t compressed_len;	/* Compressed block length, big endian */
+	uint64_t checksum;		/* Checksum of the uncompressed block, big endian */
+};
+
+/* Last message of the client */
+struct __attribute__((packed)) stream_trailer {
+	uint32_t magic;			/* STREAM_TRAILER_MAGIC, big endian */
+	uint64_t checksum;		/* Checksum of the file, big endian */
+};
+
+/* Credits message of the server */
+struct __attribute__((packed)) stream_credits {
+	uint32_t magic;			/* STREAM_CREDITS_MAGIC, big endian */
+	uint32_t credits;		/* Blocks the client may send, big endian */
+};
+
 /*
  * Get DOCA compress maximum buffer size allowed
  *
@@ -64,17 +112,18 @@ get_compress_max_buf_size(struct compress_resources *resources, uint64_t *max_bu
 }
 
 /*
- * Allocate DOCA compress needed resources with 2 buffers
+ * Allocate DOCA compress needed resources with 2 buffers and a task for every block in flight
  *
  * @mode [in]: Running mode
+ * @nb_tasks [in]: Number of blocks in flight
  * @resources [out]: DOCA compress resources pointer
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-get_compress_resources(enum file_compression_mode mode, struct compress_resources *resources)
+get_compress_resources(enum file_compression_mode mode, uint32_t nb_tasks, struct compress_resources *resources)
 {
-	uint32_t max_bufs = 2;
-	doca_error_t result;
+	uint32_t max_bufs = 2 * nb_tasks;
+	doca_error_t result, tmp_result;
 
 	if (mode == CLIENT)
 		resources->mode = COMPRESS_MODE_COMPRESS_DEFLATE;
@@ -82,8 +131,20 @@ get_compress_resources(enum file_compression_mode mode, struct compress_resource
 		resources->mode = COMPRESS_MODE_DECOMPRESS_DEFLATE;
 
 	result = allocate_compress_resources(NULL, max_bufs, resources);
-	if (result != DOCA_SUCCESS)
+	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to allocate compress resources: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* The blocks engine replaces the single task configuration of the compress resources */
+	result = block_engine_set_conf(resources->compress, resources->mode, nb_tasks);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to set configurations for compress tasks: %s", doca_error_get_descr(result));
+		tmp_result = destroy_compress_resources(resources);
+		if (tmp_result != DOCA_SUCCESS)
+			DOCA_LOG_ERR("Failed to destroy DOCA compress resources: %s", doca_error_get_descr(tmp_result));
+		resources->compress = NULL;
+	}
 
 	return result;
 }
@@ -107,15 +168,17 @@ init_compress_resources(struct file_compression_config *app_cfg, struct compress
 	*method = COMPRESS_DEFLATE_HW;
 
 	/* Allocate compress resources */
-	result = get_compress_resources(app_cfg->mode, resources);
+	result = get_compress_resources(app_cfg->mode, app_cfg->nb_tasks, resources);
 	if (result != DOCA_SUCCESS) {
-		if (resources->mode == COMPRESS_MODE_COMPRESS_DEFLATE) {
-			DOCA_LOG_INFO("Failed to find device for compress task, running SW compress with zlib");
-			*method = COMPRESS_DEFLATE_SW;
-			*max_buf_size = SW_MAX_FILE_SIZE;
-			result = DOCA_SUCCESS;
-		} else if (resources->mode == COMPRESS_MODE_DECOMPRESS_DEFLATE)
-			DOCA_LOG_ERR("Failed to allocate compress resources: %s", doca_error_get_descr(result));
+		DOCA_LOG_INFO("Failed to find device for %s task, running SW %s with zlib",
+			      resources->mode == COMPRESS_MODE_COMPRESS_DEFLATE ? "compress" : "decompress",
+			      resources->mode == COMPRESS_MODE_COMPRESS_DEFLATE ? "compress" : "decompress");
+		*method = COMPRESS_DEFLATE_SW;
+		/* zlib has no buffer size limit */
+		*max_buf_size = UINT64_MAX;
+		/* The compress context was released with the resources */
+		resources->compress = NULL;
+		result = DOCA_SUCCESS;
 	} else {
 		result = get_compress_max_buf_size(resources, max_buf_size);
 		if (result != DOCA_SUCCESS) {
@@ -179,342 +242,356 @@ set_endpoint_properties(enum file_compression_mode mode, struct doca_comm_channe
 }
 
 /*
- * Unmap callback - free doca_buf allocated pointer
+ * Get the time of a monotonic clock
  *
- * @addr [in]: Memory range pointer
- * @len [in]: Memory range length
- * @opaque [in]: An opaque pointer passed to iterator
+ * @return: Current time (nanoseconds)
  */
-static void
-unmap_cb(void *addr, size_t len, void *opaque)
+static uint64_t
+now_ns(void)
 {
-	(void)opaque;
+	struct timespec ts;
 
-	if (addr != NULL)
-		munmap(addr, len);
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
 }
 
 /*
- * Populate destination doca buffer for compress tasks
+ * Send a message to the peer, retrying while the send queue is full
  *
- * @state [in]: application configuration struct
- * @dst_buffer [in]: destination buffer
- * @dst_buf_size [in]: destination buffer size
- * @dst_doca_buf [out]: created doca buffer
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the send operation
+ * @msg [in]: message
+ * @len [in]: message length
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-populate_dst_buf(struct program_core_objects *state, uint8_t *dst_buffer, size_t dst_buf_size,
-			struct doca_buf **dst_doca_buf)
+send_msg(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr, const void *msg,
+	 size_t len)
 {
 	doca_error_t result;
+	struct timespec ts = {
+		.tv_nsec = SLEEP_IN_NANOS,
+	};
 
-	result = doca_mmap_set_memrange(state->dst_mmap, dst_buffer, dst_buf_size);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to set memory range destination memory map: %s", doca_error_get_descr(result));
-		return result;
-	}
-
-	result = doca_mmap_start(state->dst_mmap);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to start destination memory map: %s", doca_error_get_descr(result));
-		return result;
-	}
-
-	result = doca_buf_inventory_buf_get_by_addr(state->buf_inv, state->dst_mmap, dst_buffer, dst_buf_size,
-						    dst_doca_buf);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to acquire DOCA buffer representing destination buffer: %s",
-			     doca_error_get_descr(result));
-		return result;
-	}
+	while ((result = doca_comm_channel_ep_sendto(ep, msg, len, DOCA_CC_MSG_FLAG_NONE, *peer_addr)) ==
+	       DOCA_ERROR_AGAIN)
+		nanosleep(&ts, &ts);
+	if (result != DOCA_SUCCESS)
+		DOCA_LOG_ERR("Message was not sent: %s", doca_error_get_descr(result));
 	return result;
 }
 
 /*
- * Allocate DOCA compress resources and submit compress/decompress task
+ * Receive a message from the peer, completing the blocks of an engine while waiting
  *
- * @file_data [in]: file data to the source buffer
- * @file_size [in]: file size
- * @dst_buf_size [in]: allocated destination buffer length
- * @resources [in]: DOCA compress resources
- * @compressed_file [out]: destination buffer with the result
- * @compressed_file_len [out]: destination buffer size
- * @output_chksum [out]: the returned checksum
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the receive operation
+ * @msg [out]: MAX_MSG_SIZE bytes message
+ * @msg_len [out]: message length
+ * @timeout [in]: timeout in seconds, 0 to wait forever
+ * @engine [in]: engine to progress while waiting, may be NULL
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-compress_file_hw(char *file_data, size_t file_size, size_t dst_buf_size, struct compress_resources *resources,
-		 uint8_t *compressed_file, size_t *compressed_file_len, uint64_t *output_chksum)
+recv_msg(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr, void *msg,
+	 size_t *msg_len, int timeout, struct block_engine *engine)
 {
-	struct doca_buf *dst_doca_buf;
-	struct doca_buf *src_doca_buf;
-	uint8_t *resp_head;
-	struct program_core_objects *state = resources->state;
-	doca_error_t result, tmp_result;
-
-	/* Start compress context */
-	result = doca_ctx_start(state->ctx);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to start context: %s", doca_error_get_descr(result));
-		return result;
-	}
-
-	result = doca_mmap_set_memrange(state->src_mmap, file_data, file_size);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to set memory range of source memory map: %s", doca_error_get_descr(result));
-		return result;
-	}
-	result = doca_mmap_set_free_cb(state->src_mmap, &unmap_cb, NULL);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to set free callback of source memory map: %s", doca_error_get_descr(result));
-		munmap(file_data, file_size);
-		return result;
-
-	}
-	result = doca_mmap_start(state->src_mmap);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to start source memory map: %s", doca_error_get_descr(result));
-		return result;
-	}
-
-	result = doca_buf_inventory_buf_get_by_addr(state->buf_inv, state->src_mmap, file_data, file_size, &src_doca_buf);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Unable to acquire DOCA buffer representing source buffer: %s", doca_error_get_descr(result));
-		return result;
-	}
-
-	doca_buf_get_data(src_doca_buf, (void **)&resp_head);
-	doca_buf_set_data(src_doca_buf, resp_head, file_size);
-
-	result = populate_dst_buf(state, compressed_file, dst_buf_size, &dst_doca_buf);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to populate destination buffer: %s", doca_error_get_descr(result));
-		goto dec_src_buf;
-	}
-
-	if (resources->mode == COMPRESS_MODE_COMPRESS_DEFLATE)
-		result = submit_compress_deflate_task(resources, src_doca_buf, dst_doca_buf, output_chksum);
-	else
-		result = submit_decompress_deflate_task(resources, src_doca_buf, dst_doca_buf, output_chksum);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to submit %s task: %s", (resources->mode == COMPRESS_MODE_COMPRESS_DEFLATE) ? "compress" : "decompress",
-								doca_error_get_descr(result));
-		goto dec_dst_buf;
-	}
-
-	doca_buf_get_data_len(dst_doca_buf, compressed_file_len);
+	uint64_t num_of_iterations = (uint64_t)timeout * 1000 * 1000 / (SLEEP_IN_NANOS / 1000);
+	uint64_t counter = 0;
+	doca_error_t result;
+	struct timespec ts = {
+		.tv_nsec = SLEEP_IN_NANOS,
+	};
 
-dec_dst_buf:
-	tmp_result = doca_buf_dec_refcount(dst_doca_buf, NULL);
-	if (tmp_result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to decrease DOCA destination buffer count: %s", doca_error_get_descr(tmp_result));
-		DOCA_ERROR_PROPAGATE(result, tmp_result);
-	}
-dec_src_buf:
-	tmp_result = doca_buf_dec_refcount(src_doca_buf, NULL);
-	if (tmp_result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to decrease DOCA source buffer count: %s", doca_error_get_descr(tmp_result));
-		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	*msg_len = MAX_MSG_SIZE;
+	while ((result = doca_comm_channel_ep_recvfrom(ep, msg, msg_len, DOCA_CC_MSG_FLAG_NONE, peer_addr)) ==
+	       DOCA_ERROR_AGAIN) {
+		*msg_len = MAX_MSG_SIZE;
+		if (engine != NULL) {
+			result = block_engine_poll(engine);
+			if (result != DOCA_SUCCESS)
+				return result;
+		}
+		nanosleep(&ts, &ts);
+		counter++;
+		if (timeout != 0 && counter == num_of_iterations) {
+			DOCA_LOG_ERR("Message was not received at the given timeout");
+			return DOCA_ERROR_TIME_OUT;
+		}
 	}
-
+	if (result != DOCA_SUCCESS)
+		DOCA_LOG_ERR("Message was not received: %s", doca_error_get_descr(result));
 	return result;
 }
 
 /*
- * Compress the input file in SW
+ * Get the uncompressed length of a block of the stream
  *
- * @file_data [in]: file data to the source buffer
  * @file_size [in]: file size
- * @dst_buf_size [in]: allocated destination buffer length
- * @compressed_file [out]: destination buffer with the result
- * @compressed_file_len [out]: destination buffer size
- * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ * @block_size [in]: block size
+ * @block_idx [in]: block index
+ * @return: block length
  */
-static doca_error_t
-compress_file_sw(char *file_data, size_t file_size, size_t dst_buf_size, Byte **compressed_file, uLong *compressed_file_len)
+static size_t
+stream_block_len(uint64_t file_size, uint32_t block_size, uint32_t block_idx)
 {
-	z_stream c_stream; /* compression stream */
-	int err;
-
-	memset(&c_stream, 0, sizeof(c_stream));
-
-	c_stream.zalloc = NULL;
-	c_stream.zfree = NULL;
-
-	err = deflateInit2(&c_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
-	if (err < 0) {
-		DOCA_LOG_ERR("Failed to initialize compression system");
-		return DOCA_ERROR_BAD_STATE;
-	}
-
-	c_stream.next_in  = (z_const unsigned char *)file_data;
-	c_stream.next_out = *compressed_file;
-
-	c_stream.avail_in = file_size;
-	c_stream.avail_out = dst_buf_size;
-	err = deflate(&c_stream, Z_NO_FLUSH);
-	if (err < 0) {
-		DOCA_LOG_ERR("Failed to compress file");
-		return DOCA_ERROR_BAD_STATE;
-	}
-
-	/* Finish the stream */
-	err = deflate(&c_stream, Z_FINISH);
-	if (err < 0 || err != Z_STREAM_END) {
-		DOCA_LOG_ERR("Failed to compress file");
-		return DOCA_ERROR_BAD_STATE;
-	}
-
-	err = deflateEnd(&c_stream);
-	if (err < 0) {
-		DOCA_LOG_ERR("Failed to compress file");
-		return DOCA_ERROR_BAD_STATE;
-	}
-	*compressed_file_len = c_stream.total_out;
-	return DOCA_SUCCESS;
+	return MIN(block_size, file_size - (uint64_t)block_idx * block_size);
 }
 
 /*
- * Calculate file checksum with zlib, where the lower 32 bits contain the CRC checksum result
- * and the upper 32 bits contain the Adler checksum result.
+ * Combine the checksums of the blocks of a stream in order
  *
- * @file_data [in]: file data to the source buffer
+ * @checksums [in]: checksum of every block
+ * @nb_blocks [in]: number of blocks
  * @file_size [in]: file size
- * @output_chksum [out]: the calculated checksum
+ * @block_size [in]: block size
+ * @return: checksum of the file
  */
-static void
-calculate_checksum_sw(char *file_data, size_t file_size, uint64_t *output_chksum)
+static uint64_t
+stream_checksum(const uint64_t *checksums, uint32_t nb_blocks, uint64_t file_size, uint32_t block_size)
 {
-	uint32_t crc;
-	uint32_t adler;
-	uint64_t result_checksum;
+	uint64_t checksum = BLOCK_ENGINE_EMPTY_CHECKSUM;
+	uint32_t i;
 
-	crc = crc32(0L, Z_NULL, 0);
-	crc = crc32(crc, (const unsigned char *)file_data, file_size);
-	adler = adler32(0L, Z_NULL, 0);
-	adler = adler32(adler, (const unsigned char *)file_data, file_size);
+	for (i = 0; i < nb_blocks; i++)
+		checksum = block_checksum_combine(checksum, checksums[i], stream_block_len(file_size, block_size, i));
+	return checksum;
+}
 
-	result_checksum = adler;
-	result_checksum <<= 32;
-	result_checksum += crc;
+/*
+ * Log the throughput of a transfer
+ *
+ * @what [in]: what was transferred
+ * @file_size [in]: uncompressed size
+ * @compressed_size [in]: compressed size
+ * @start [in]: start time (nanoseconds)
+ * @first_block [in]: time of the first block (nanoseconds), 0 if there was none
+ */
+static void
+log_throughput(const char *what, uint64_t file_size, uint64_t compressed_size, uint64_t start, uint64_t first_block)
+{
+	double elapsed = (now_ns() - start) / 1e9;
 
-	*output_chksum = result_checksum;
+	DOCA_LOG_INFO("%s %" PRIu64 " bytes, %" PRIu64 " compressed, in %.3f ms: %.1f MB/s", what, file_size,
+		      compressed_size, elapsed * 1e3, elapsed > 0 ? file_size / elapsed / 1e6 : 0);
+	if (first_block != 0)
+		DOCA_LOG_INFO("Time to first block: %.3f ms", (first_block - start) / 1e6);
 }
 
 /*
- * Compress / decompress the input file data
+ * Get the size of the buffers of the compressed blocks
  *
- * @file_data [in]: file data to the source buffer
- * @file_size [in]: file size
+ * @block_size [in]: block size
  * @max_buf_size [in]: maximum compress buffer size allowed
- * @resources [in]: DOCA compress resources
- * @method [in]: Compression method to be used
- * @compressed_file [out]: destination buffer with the result
- * @compressed_file_len [out]: destination buffer size
- * @output_chksum [out]: the calculated checksum
- * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ * @return: compressed block buffer size
  */
-static doca_error_t
-compress_file(char *file_data, size_t file_size, uint64_t max_buf_size, struct compress_resources *resources,
-	      enum file_compression_compress_method method, uint8_t **compressed_file, size_t *compressed_file_len,
-	      uint64_t *output_chksum)
+static size_t
+compressed_block_size(uint32_t block_size, uint64_t max_buf_size)
 {
-	size_t dst_buf_size = 0;
+	return MIN(block_engine_compress_bound(block_size), max_buf_size);
+}
 
-	enum compress_mode;
+/* State of the client stream */
+struct client_stream {
+	struct doca_comm_channel_ep_t *ep;		/* Comm channel endpoint */
+	struct doca_comm_channel_addr_t **peer_addr;	/* Server address */
+	int timeout;					/* Timeout of the credits in seconds */
+	uint32_t credits;				/* Blocks the server can receive */
+	uint64_t file_size;				/* File size */
+	uint32_t block_size;				/* Block size */
+	bool single_stream;				/* The blocks are the parts of a single deflate stream */
+	uint64_t *checksums;				/* Checksum of every block */
+	uint64_t compressed_size;			/* Compressed bytes sent */
+	uint64_t first_block;				/* Time the first block was sent (nanoseconds) */
+};
 
-	if (resources->mode == COMPRESS_MODE_COMPRESS_DEFLATE) {
-		dst_buf_size = MAX(file_size + 16, file_size * 2);
-		if (dst_buf_size > max_buf_size)
-			dst_buf_size = max_buf_size;
-	} else if (resources->mode == COMPRESS_MODE_DECOMPRESS_DEFLATE)
-		dst_buf_size = MIN(max_buf_size, DECOMPRESS_RATIO * file_size);
+/*
+ * Wait for credits from the server
+ *
+ * @stream [in]: client stream
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+wait_credits(struct client_stream *stream)
+{
+	char msg[MAX_MSG_SIZE];
+	struct stream_credits *credits = (struct stream_credits *)msg;
+	size_t msg_len;
+	doca_error_t result;
 
-	*compressed_file = calloc(1, dst_buf_size);
-	if (*compressed_file == NULL) {
-		DOCA_LOG_ERR("Failed to allocate memory");
-		return DOCA_ERROR_NO_MEMORY;
+	while (stream->credits == 0) {
+		result = recv_msg(stream->ep, stream->peer_addr, msg, &msg_len, stream->timeout, NULL);
+		if (result != DOCA_SUCCESS)
+			return result;
+		if (msg_len != sizeof(*credits) || ntohl(credits->magic) != STREAM_CREDITS_MAGIC) {
+			/* The server stops the stream with its finish message */
+			msg[MIN(msg_len, MAX_MSG_SIZE - 1)] = '\0';
+			DOCA_LOG_ERR("Server stopped the stream: %s", msg);
+			return DOCA_ERROR_BAD_STATE;
+		}
+		stream->credits += ntohl(credits->credits);
 	}
-
-	if (method == COMPRESS_DEFLATE_SW) {
-		calculate_checksum_sw(file_data, file_size, output_chksum);
-		return compress_file_sw(file_data, file_size, dst_buf_size, compressed_file, compressed_file_len);
-	} else
-		return compress_file_hw(file_data, file_size, dst_buf_size, resources, *compressed_file,
-					compressed_file_len, output_chksum);
+	return DOCA_SUCCESS;
 }
 
 /*
- * Send the input file with comm channel to the server in segments of MAX_MSG_SIZE
+ * Block callback of the client - send a compressed block once the server has room for it
  *
- * @ep [in]: handle for comm channel local endpoint
- * @peer_addr [in]: destination address handle of the send operation
- * @file_data [in]: file data to the source buffer
- * @file_size [in]: file size
+ * @block_idx [in]: block index
+ * @data [in]: compressed block
+ * @len [in]: compressed block length
+ * @checksum [in]: checksum of the uncompressed block
+ * @user_ctx [in]: client stream
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-send_file(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr,
-	 char *file_data, size_t file_size)
+send_block_cb(uint32_t block_idx, const uint8_t *data, size_t len, uint64_t checksum, void *user_ctx)
 {
-	uint32_t total_msgs;
-	uint32_t total_msgs_msg;
-	uint32_t i;
+	struct client_stream *stream = (struct client_stream *)user_ctx;
+	struct stream_block_header header;
 	size_t msg_len;
 	doca_error_t result;
-	struct timespec ts = {
-		.tv_nsec = SLEEP_IN_NANOS,
-	};
 
-	/* Send to the server the number of messages needed for receiving the file */
-	total_msgs = (file_size + MAX_MSG_SIZE - 1) / MAX_MSG_SIZE;
-	total_msgs_msg = htonl(total_msgs);
-	while ((result = doca_comm_channel_ep_sendto(ep, &total_msgs_msg, sizeof(uint32_t), DOCA_CC_MSG_FLAG_NONE,
-						     *peer_addr)) == DOCA_ERROR_AGAIN)
-		nanosleep(&ts, &ts);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Message was not sent: %s", doca_error_get_descr(result));
+	result = wait_credits(stream);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	header.magic = htonl(STREAM_BLOCK_MAGIC);
+	header.block_idx = htonl(block_idx);
+	header.raw_len = htonl(stream_block_len(stream->file_size, stream->block_size, block_idx));
+	header.compressed_len = htonl(len);
+	header.checksum = htonq(checksum);
+	result = send_msg(stream->ep, stream->peer_addr, &header, sizeof(header));
+	if (result != DOCA_SUCCESS)
 		return result;
+	stream->compressed_size += len;
+	while (len > 0) {
+		msg_len = MIN(len, MAX_MSG_SIZE);
+		result = send_msg(stream->ep, stream->peer_addr, data, msg_len);
+		if (result != DOCA_SUCCESS)
+			return result;
+		data += msg_len;
+		len -= msg_len;
 	}
 
+	stream->credits--;
+	stream->checksums[block_idx] = checksum;
+	if (stream->first_block == 0)
+		stream->first_block = now_ns();
+	DOCA_LOG_TRC("Sent block %u", block_idx);
+	return DOCA_SUCCESS;
+}
 
-	/* Send file to the server */
-	for (i = 0; i < total_msgs; i++) {
-		msg_len = MIN(file_size, MAX_MSG_SIZE);
-		while ((result = doca_comm_channel_ep_sendto(ep, file_data, msg_len, DOCA_CC_MSG_FLAG_NONE,
-							     *peer_addr)) == DOCA_ERROR_AGAIN)
-			nanosleep(&ts, &ts);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Message was not sent: %s", doca_error_get_descr(result));
-			return result;
+/*
+ * Read a block of the file
+ *
+ * @fd [in]: file descriptor
+ * @buf [out]: block
+ * @len [in]: block length
+ * @offset [in]: block offset in the file
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+read_block(int fd, uint8_t *buf, size_t len, uint64_t offset)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = pread(fd, buf, len, offset);
+		if (ret <= 0) {
+			if (ret < 0 && errno == EINTR)
+				continue;
+			DOCA_LOG_ERR("Failed to read the file at offset %" PRIu64, offset);
+			return DOCA_ERROR_IO_FAILED;
 		}
-		file_data += msg_len;
-		file_size -= msg_len;
+		buf += ret;
+		len -= ret;
+		offset += ret;
 	}
 	return DOCA_SUCCESS;
 }
 
+/*
+ * Compress the file in blocks and send every block as soon as it is compressed, the blocks of a single stream are
+ * sent in stream order
+ *
+ * @stream [in]: client stream
+ * @app_cfg [in]: application config struct
+ * @resources [in]: DOCA compress resources pointer
+ * @max_buf_size [in]: Maximum buffer size allowed for compress operations
+ * @method [in]: Compression method to be used
+ * @fd [in]: file descriptor
+ * @nb_blocks [in]: number of blocks
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+compress_blocks(struct client_stream *stream, struct file_compression_config *app_cfg,
+		struct compress_resources *resources, uint64_t max_buf_size,
+		enum file_compression_compress_method method, int fd, uint32_t nb_blocks)
+{
+	struct block_engine_cfg cfg = {
+		.backend = method == COMPRESS_DEFLATE_HW ? BLOCK_ENGINE_DOCA : BLOCK_ENGINE_SW,
+		.mode = COMPRESS_MODE_COMPRESS_DEFLATE,
+		.nb_slots = app_cfg->nb_tasks,
+		.nb_threads = app_cfg->nb_sw_threads,
+		.src_size = stream->block_size,
+		.dst_size = compressed_block_size(stream->block_size, max_buf_size),
+		.primed = stream->single_stream,
+		.nb_blocks = nb_blocks,
+		.block_cb = send_block_cb,
+		.user_ctx = stream,
+	};
+	struct block_engine *engine;
+	uint32_t i, slot;
+	size_t len;
+	doca_error_t result;
+
+	result = block_engine_create(&cfg, resources, &engine);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	/* The file is read while the blocks before it are compressed and sent */
+	for (i = 0; i < nb_blocks; i++) {
+		slot = i % cfg.nb_slots;
+		result = block_engine_wait_slot(engine, slot);
+		if (result != DOCA_SUCCESS)
+			goto destroy_engine;
+		len = stream_block_len(stream->file_size, stream->block_size, i);
+		result = read_block(fd, block_engine_src(engine, slot), len, (uint64_t)i * stream->block_size);
+		if (result != DOCA_SUCCESS)
+			goto destroy_engine;
+		result = block_engine_submit(engine, slot, i, len);
+		if (result != DOCA_SUCCESS)
+			goto destroy_engine;
+	}
+	result = block_engine_wait_all(engine);
+
+destroy_engine:
+	block_engine_destroy(engine);
+	return result;
+}
+
 doca_error_t
 file_compression_client(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr,
 			struct file_compression_config *app_cfg, struct compress_resources *resources,
 			uint64_t max_buf_size, enum file_compression_compress_method method)
 {
-	char *file_data;
+	struct client_stream stream = {
+		.ep = ep,
+		.peer_addr = peer_addr,
+		.timeout = app_cfg->timeout,
+	};
+	struct stream_header header;
+	struct stream_trailer trailer;
+	struct stream_credits *credits;
 	char msg[MAX_MSG_SIZE] = {0};
 	size_t msg_len;
 	struct stat statbuf;
+	uint64_t nb_blocks, start;
 	int fd;
-	uint8_t *compressed_file;
-	size_t compressed_file_len;
-	uint64_t checksum;
-	uint64_t checksum_msg;
 	doca_error_t result;
-	struct timespec ts = {
-		.tv_nsec = SLEEP_IN_NANOS,
-	};
 
-	fd = open(app_cfg->file_path, O_RDWR);
+	fd = open(app_cfg->file_path, O_RDONLY);
 	if (fd < 0) {
 		DOCA_LOG_ERR("Failed to open %s", app_cfg->file_path);
 		return DOCA_ERROR_IO_FAILED;
@@ -526,65 +603,272 @@ file_compression_client(struct doca_comm_channel_ep_t *ep, struct doca_comm_chan
 		return DOCA_ERROR_IO_FAILED;
 	}
 
-	if (statbuf.st_size == 0 || (uint64_t)statbuf.st_size > max_buf_size) {
-		DOCA_LOG_ERR("Invalid file size. Should be greater then zero and smaller than %" PRIu64 " bytes",
-			     max_buf_size);
+	/*
+	 * A block is a single compress task, the file size is not limited. zlib primes every block with the data before
+	 * it, so the stream is a single standard deflate stream, unless the server should inflate the blocks in parallel.
+	 */
+	stream.file_size = statbuf.st_size;
+	stream.single_stream = method == COMPRESS_DEFLATE_SW && !app_cfg->independent_blocks;
+	stream.block_size = MIN(app_cfg->block_size, max_buf_size);
+	if (stream.block_size != app_cfg->block_size)
+		DOCA_LOG_WARN("Block size is limited to the DOCA compress maximum buffer size of %u bytes",
+			      stream.block_size);
+	nb_blocks = (stream.file_size + stream.block_size - 1) / stream.block_size;
+	if (nb_blocks > UINT32_MAX) {
+		DOCA_LOG_ERR("File of %" PRIu64 " bytes has too many blocks of %u bytes", stream.file_size,
+			     stream.block_size);
 		close(fd);
 		return DOCA_ERROR_INVALID_VALUE;
 	}
-
-	file_data = mmap(NULL, statbuf.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-	if (file_data == MAP_FAILED) {
-		DOCA_LOG_ERR("Unable to map file content: %s", strerror(errno));
+	stream.checksums = calloc(MAX(nb_blocks, 1), sizeof(*stream.checksums));
+	if (stream.checksums == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
 		close(fd);
 		return DOCA_ERROR_NO_MEMORY;
 	}
+	DOCA_LOG_INFO("Sending %" PRIu64 " bytes in %" PRIu64 " blocks of %u bytes, %u blocks in flight with %s compress",
+		      stream.file_size, nb_blocks, stream.block_size, app_cfg->nb_tasks,
+		      method == COMPRESS_DEFLATE_HW ? "DOCA" : stream.single_stream ? "zlib single stream" : "zlib");
+
+	start = now_ns();
+	header.magic = htonl(STREAM_HEADER_MAGIC);
+	header.block_size = htonl(stream.block_size);
+	header.file_size = htonq(stream.file_size);
+	header.nb_blocks = htonl(nb_blocks);
+	header.flags = htonl(stream.single_stream ? STREAM_FLAG_SINGLE_STREAM : 0);
+	result = send_msg(ep, peer_addr, &header, sizeof(header));
+	if (result != DOCA_SUCCESS)
+		goto free_checksums;
 
-	DOCA_LOG_TRC("File size: %ld", statbuf.st_size);
-	/* Send compress task */
-	result = compress_file(file_data, statbuf.st_size, max_buf_size,
-			       resources, method, &compressed_file, &compressed_file_len, &checksum);
-	if (result != DOCA_SUCCESS) {
-		close(fd);
-		free(compressed_file);
-		return result;
-	}
+	result = compress_blocks(&stream, app_cfg, resources, max_buf_size, method, fd, nb_blocks);
+	if (result != DOCA_SUCCESS)
+		goto free_checksums;
+
+	trailer.magic = htonl(STREAM_TRAILER_MAGIC);
+	trailer.checksum = htonq(stream_checksum(stream.checksums, nb_blocks, stream.file_size, stream.block_size));
+	result = send_msg(ep, peer_addr, &trailer, sizeof(trailer));
+	if (result != DOCA_SUCCESS)
+		goto free_checksums;
+
+	/* Receive finish message when file was completely written by the server, after the last credits */
+	credits = (struct stream_credits *)msg;
+	do {
+		result = recv_msg(ep, peer_addr, msg, &msg_len, 0, NULL);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Finish message was not received: %s", doca_error_get_descr(result));
+			goto free_checksums;
+		}
+	} while (msg_len == sizeof(*credits) && ntohl(credits->magic) == STREAM_CREDITS_MAGIC);
+	msg[MIN(msg_len, MAX_MSG_SIZE - 1)] = '\0';
+	DOCA_LOG_INFO("%s", msg);
+	log_throughput("Sent", stream.file_size, stream.compressed_size, start, stream.first_block);
+
+free_checksums:
+	free(stream.checksums);
 	close(fd);
-	DOCA_LOG_TRC("Compressed file size: %ld", compressed_file_len);
+	return result;
+}
 
-	/* send source file checksum */
-	checksum_msg = htonq(checksum);
-	while ((result = doca_comm_channel_ep_sendto(ep, &checksum_msg, sizeof(uint64_t), DOCA_CC_MSG_FLAG_NONE,
-						     *peer_addr)) == DOCA_ERROR_AGAIN)
-		nanosleep(&ts, &ts);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Message was not sent: %s", doca_error_get_descr(result));
-		free(compressed_file);
-		return result;
+/* State of the server stream */
+struct server_stream {
+	struct doca_comm_channel_ep_t *ep;		/* Comm channel endpoint */
+	struct doca_comm_channel_addr_t **peer_addr;	/* Client address */
+	int fd;						/* Output file descriptor */
+	uint64_t file_size;				/* File size */
+	uint32_t block_size;				/* Block size */
+	uint32_t nb_blocks;				/* Number of blocks */
+	bool single_stream;				/* The blocks are the parts of a single deflate stream */
+	uint64_t *checksums;				/* Checksum of every block, sent by the client */
+	uint8_t *received;				/* Set for every block received */
+	uint32_t nb_written;				/* Blocks written */
+	uint64_t compressed_size;			/* Compressed bytes received */
+	uint64_t first_block;				/* Time the first block was written (nanoseconds) */
+};
+
+/*
+ * Send credits to the client
+ *
+ * @stream [in]: server stream
+ * @nb_credits [in]: number of credits
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+send_credits(struct server_stream *stream, uint32_t nb_credits)
+{
+	struct stream_credits credits = {
+		.magic = htonl(STREAM_CREDITS_MAGIC),
+		.credits = htonl(nb_credits),
+	};
+
+	return send_msg(stream->ep, stream->peer_addr, &credits, sizeof(credits));
+}
+
+/*
+ * Block callback of the server - verify and write a decompressed block, and give its buffer back to the client
+ *
+ * @block_idx [in]: block index
+ * @data [in]: decompressed block
+ * @len [in]: decompressed block length
+ * @checksum [in]: checksum of the decompressed block
+ * @user_ctx [in]: server stream
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+write_block_cb(uint32_t block_idx, const uint8_t *data, size_t len, uint64_t checksum, void *user_ctx)
+{
+	struct server_stream *stream = (struct server_stream *)user_ctx;
+	uint64_t offset = (uint64_t)block_idx * stream->block_size;
+	ssize_t ret;
+
+	if (len != stream_block_len(stream->file_size, stream->block_size, block_idx)) {
+		DOCA_LOG_ERR("Block %u was decompressed to %zu bytes instead of %zu", block_idx, len,
+			     stream_block_len(stream->file_size, stream->block_size, block_idx));
+		return DOCA_ERROR_BAD_STATE;
+	}
+	if (checksum != stream->checksums[block_idx]) {
+		DOCA_LOG_ERR("ERROR: block %u checksum is different. received: 0x%lx, calculated: 0x%lx", block_idx,
+			     stream->checksums[block_idx], checksum);
+		return DOCA_ERROR_BAD_STATE;
 	}
 
-	/* Send the file content to the server */
-	result = send_file(ep, peer_addr, (char *)compressed_file, compressed_file_len);
-	if (result != DOCA_SUCCESS) {
-		free(compressed_file);
+	while (len > 0) {
+		ret = pwrite(stream->fd, data, len, offset);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0) {
+			DOCA_LOG_ERR("Failed to write block %u into the file", block_idx);
+			return DOCA_ERROR_IO_FAILED;
+		}
+		data += ret;
+		len -= ret;
+		offset += ret;
+	}
+
+	stream->nb_written++;
+	if (stream->first_block == 0)
+		stream->first_block = now_ns();
+	DOCA_LOG_TRC("Wrote block %u", block_idx);
+	return send_credits(stream, 1);
+}
+
+/*
+ * Receive a block into the source buffer of a free slot
+ *
+ * @stream [in]: server stream
+ * @engine [in]: decompress engine
+ * @slot [in]: free slot
+ * @src_size [in]: source buffer size of the slot
+ * @timeout [in]: timeout in seconds
+ * @block_idx [out]: block index
+ * @compressed_len [out]: compressed block length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+recv_block(struct server_stream *stream, struct block_engine *engine, uint32_t slot, size_t src_size,
+	   int timeout, uint32_t *block_idx, size_t *compressed_len)
+{
+	char msg[MAX_MSG_SIZE];
+	struct stream_block_header *header = (struct stream_block_header *)msg;
+	uint8_t *dst = block_engine_src(engine, slot);
+	size_t msg_len, len, received;
+	uint32_t idx;
+	doca_error_t result;
+
+	result = recv_msg(stream->ep, stream->peer_addr, msg, &msg_len, timeout, engine);
+	if (result != DOCA_SUCCESS)
 		return result;
+	if (msg_len != sizeof(*header) || ntohl(header->magic) != STREAM_BLOCK_MAGIC) {
+		DOCA_LOG_ERR("Received wrong message, expected a block header");
+		return DOCA_ERROR_BAD_STATE;
+	}
+	idx = ntohl(header->block_idx);
+	len = ntohl(header->compressed_len);
+	if (idx >= stream->nb_blocks || stream->received[idx]) {
+		DOCA_LOG_ERR("Received unexpected block %u", idx);
+		return DOCA_ERROR_BAD_STATE;
 	}
-	free(compressed_file);
+	if (ntohl(header->raw_len) != stream_block_len(stream->file_size, stream->block_size, idx) || len == 0 ||
+	    len > src_size) {
+		DOCA_LOG_ERR("Received block %u of wrong size", idx);
+		return DOCA_ERROR_BAD_STATE;
+	}
+	stream->received[idx] = 1;
+	stream->checksums[idx] = ntohq(header->checksum);
 
-	/* Receive finish message when file was completely read by the server */
-	msg_len = MAX_MSG_SIZE;
-	while ((result = doca_comm_channel_ep_recvfrom(ep, msg, &msg_len, DOCA_CC_MSG_FLAG_NONE, peer_addr)) ==
-	       DOCA_ERROR_AGAIN) {
-		nanosleep(&ts, &ts);
-		msg_len = MAX_MSG_SIZE;
+	for (received = 0; received < len; received += msg_len) {
+		result = recv_msg(stream->ep, stream->peer_addr, msg, &msg_len, timeout, engine);
+		if (result != DOCA_SUCCESS)
+			return result;
+		if (msg_len > len - received) {
+			DOCA_LOG_ERR("Received block %u exceeded its size", idx);
+			return DOCA_ERROR_BAD_STATE;
+		}
+		memcpy(dst + received, msg, msg_len);
 	}
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Finish message was not received: %s", doca_error_get_descr(result));
+
+	stream->compressed_size += len;
+	*block_idx = idx;
+	*compressed_len = len;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Receive the blocks of the stream, decompress and write them while the next ones are received
+ *
+ * @stream [in]: server stream
+ * @app_cfg [in]: application config struct
+ * @resources [in]: DOCA compress resources pointer
+ * @max_buf_size [in]: Maximum buffer size allowed for compress operations
+ * @method [in]: Compression method to be used
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+decompress_blocks(struct server_stream *stream, struct file_compression_config *app_cfg,
+		  struct compress_resources *resources, uint64_t max_buf_size,
+		  enum file_compression_compress_method method)
+{
+	struct block_engine_cfg cfg = {
+		/* A single stream is inflated by zlib, block after block */
+		.backend = method == COMPRESS_DEFLATE_HW && !stream->single_stream ? BLOCK_ENGINE_DOCA : BLOCK_ENGINE_SW,
+		.mode = COMPRESS_MODE_DECOMPRESS_DEFLATE,
+		.nb_slots = app_cfg->nb_tasks,
+		.nb_threads = app_cfg->nb_sw_threads,
+		.src_size = compressed_block_size(stream->block_size, max_buf_size),
+		.dst_size = stream->block_size,
+		.primed = stream->single_stream,
+		.nb_blocks = stream->nb_blocks,
+		.block_cb = write_block_cb,
+		.user_ctx = stream,
+	};
+	struct block_engine *engine;
+	uint32_t i, slot, block_idx;
+	size_t len;
+	doca_error_t result;
+
+	result = block_engine_create(&cfg, resources, &engine);
+	if (result != DOCA_SUCCESS)
 		return result;
-	}
-	msg[MAX_MSG_SIZE - 1] = '\0';
-	DOCA_LOG_INFO("%s", msg);
 
+	/* The client sends a block only for a credit, so a slot is free for every block it sends */
+	result = send_credits(stream, cfg.nb_slots);
+	if (result != DOCA_SUCCESS)
+		goto destroy_engine;
+	for (i = 0; i < stream->nb_blocks; i++) {
+		slot = i % cfg.nb_slots;
+		result = block_engine_wait_slot(engine, slot);
+		if (result != DOCA_SUCCESS)
+			goto destroy_engine;
+		result = recv_block(stream, engine, slot, cfg.src_size, app_cfg->timeout, &block_idx, &len);
+		if (result != DOCA_SUCCESS)
+			goto destroy_engine;
+		result = block_engine_submit(engine, slot, block_idx, len);
+		if (result != DOCA_SUCCESS)
+			goto destroy_engine;
+	}
+	result = block_engine_wait_all(engine);
+
+destroy_engine:
+	block_engine_destroy(engine);
 	return result;
 }
 
@@ -593,147 +877,107 @@ file_compression_server(struct doca_comm_channel_ep_t *ep, struct doca_comm_chan
 			struct file_compression_config *app_cfg, struct compress_resources *resources,
 			uint64_t max_buf_size, enum file_compression_compress_method method)
 {
+	struct server_stream stream = {
+		.ep = ep,
+		.peer_addr = peer_addr,
+		.fd = -1,
+	};
 	char received_msg[MAX_MSG_SIZE] = {0};
-	uint32_t i, total_msgs;
-	size_t msg_len;
-	int fd;
+	struct stream_header *header = (struct stream_header *)received_msg;
+	struct stream_trailer *trailer = (struct stream_trailer *)received_msg;
 	char finish_msg[] = "Server was done receiving messages";
-	char *compressed_file = NULL;
-	char *tmp_compressed_file;
-	uint8_t *resp_head;
-	uint64_t checksum;
-	size_t data_len;
-	uint64_t received_checksum;
-	int counter;
-	int num_of_iterations = (app_cfg->timeout * 1000 * 1000) / (SLEEP_IN_NANOS / 1000);
-	struct timespec ts = {
-		.tv_nsec = SLEEP_IN_NANOS,
-	};
+	uint64_t checksum, received_checksum, start;
+	size_t msg_len;
 	doca_error_t result;
 	doca_error_t tmp_result;
 
-	/* receive file checksum from the client */
-	msg_len = MAX_MSG_SIZE;
-	while ((result = doca_comm_channel_ep_recvfrom(ep, received_msg, &msg_len, DOCA_CC_MSG_FLAG_NONE,
-						       peer_addr)) == DOCA_ERROR_AGAIN) {
-		nanosleep(&ts, &ts);
-		msg_len = MAX_MSG_SIZE;
-	}
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Message was not received: %s", doca_error_get_descr(result));
+	/* receive the stream header from the client */
+	result = recv_msg(ep, peer_addr, received_msg, &msg_len, 0, NULL);
+	if (result != DOCA_SUCCESS)
 		goto finish_msg;
-	}
-	if (msg_len != sizeof(uint64_t)) {
-		DOCA_LOG_ERR("Received wrong message size, required %ld, got %ld", sizeof(uint64_t), msg_len);
+	start = now_ns();
+	if (msg_len != sizeof(*header) || ntohl(header->magic) != STREAM_HEADER_MAGIC) {
+		DOCA_LOG_ERR("Received wrong message, expected a stream header");
+		result = DOCA_ERROR_BAD_STATE;
 		goto finish_msg;
 	}
-	received_checksum = ntohq(*(uint64_t *)received_msg);
-
-	/* receive number of total msgs from the client */
-	msg_len = MAX_MSG_SIZE;
-	counter = 0;
-	while ((result = doca_comm_channel_ep_recvfrom(ep, received_msg, &msg_len, DOCA_CC_MSG_FLAG_NONE,
-						       peer_addr)) == DOCA_ERROR_AGAIN) {
-		msg_len = MAX_MSG_SIZE;
-		nanosleep(&ts, &ts);
-		counter++;
-		if (counter == num_of_iterations) {
-			DOCA_LOG_ERR("Message was not received at the given timeout");
-			goto finish_msg;
-		}
+	stream.block_size = ntohl(header->block_size);
+	stream.file_size = ntohq(header->file_size);
+	stream.nb_blocks = ntohl(header->nb_blocks);
+	if ((ntohl(header->flags) & ~STREAM_FLAG_SINGLE_STREAM) != 0) {
+		DOCA_LOG_ERR("Unsupported stream flags 0x%x", ntohl(header->flags));
+		result = DOCA_ERROR_NOT_SUPPORTED;
+		goto finish_msg;
 	}
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Message was not received: %s", doca_error_get_descr(result));
+	stream.single_stream = ntohl(header->flags) & STREAM_FLAG_SINGLE_STREAM;
+	if (stream.block_size < BLOCK_ENGINE_MIN_BLOCK_SIZE || stream.block_size > BLOCK_ENGINE_MAX_BLOCK_SIZE ||
+	    stream.block_size > max_buf_size) {
+		DOCA_LOG_ERR("Unsupported block size %u", stream.block_size);
+		result = DOCA_ERROR_NOT_SUPPORTED;
 		goto finish_msg;
 	}
-	if (msg_len != sizeof(uint32_t)) {
-		DOCA_LOG_ERR("Received wrong message size, required %ld, got %ld", sizeof(uint32_t), msg_len);
+	if (stream.nb_blocks != (stream.file_size + stream.block_size - 1) / stream.block_size) {
+		DOCA_LOG_ERR("Wrong number of blocks %u for a file of %" PRIu64 " bytes", stream.nb_blocks,
+			     stream.file_size);
+		result = DOCA_ERROR_BAD_STATE;
 		goto finish_msg;
 	}
-	total_msgs = ntohl(*(uint32_t *)received_msg);
 
-	compressed_file = calloc(1, max_buf_size);
-	if (compressed_file == NULL) {
+	stream.checksums = calloc(MAX(stream.nb_blocks, 1), sizeof(*stream.checksums));
+	stream.received = calloc(MAX(stream.nb_blocks, 1), sizeof(*stream.received));
+	if (stream.checksums == NULL || stream.received == NULL) {
 		DOCA_LOG_ERR("Failed to allocate memory");
 		result = DOCA_ERROR_NO_MEMORY;
 		goto finish_msg;
 	}
-	tmp_compressed_file = compressed_file;
-
-	/* receive file */
-	for (i = 0; i < total_msgs; i++) {
-		memset(received_msg, 0, sizeof(received_msg));
-		msg_len = MAX_MSG_SIZE;
-		counter = 0;
-		while ((result = doca_comm_channel_ep_recvfrom(ep, received_msg, &msg_len, DOCA_CC_MSG_FLAG_NONE,
-							       peer_addr)) == DOCA_ERROR_AGAIN) {
-			msg_len = MAX_MSG_SIZE;
-			nanosleep(&ts, &ts);
-			counter++;
-			if (counter == num_of_iterations) {
-				DOCA_LOG_ERR("Message was not received at the given timeout");
-				goto finish_msg;
-			}
-		}
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Message was not received: %s", doca_error_get_descr(result));
-			goto finish_msg;
-		}
 
-		DOCA_LOG_TRC("Received message #%d", i+1);
-		if (tmp_compressed_file - compressed_file + msg_len > max_buf_size) {
-			DOCA_LOG_ERR("Received file exceeded maximum file size");
-			goto finish_msg;
-		}
-		memcpy(tmp_compressed_file, received_msg, msg_len);
-		tmp_compressed_file += msg_len;
+	stream.fd = open(app_cfg->file_path, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IRGRP);
+	if (stream.fd < 0) {
+		DOCA_LOG_ERR("Failed to open %s", app_cfg->file_path);
+		result = DOCA_ERROR_IO_FAILED;
+		goto finish_msg;
 	}
 
-	result = compress_file(compressed_file, tmp_compressed_file - compressed_file, max_buf_size,
-			       resources, method, &resp_head, &data_len, &checksum);
+	result = decompress_blocks(&stream, app_cfg, resources, max_buf_size, method);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to decompress the received file");
-		free(resp_head);
 		goto finish_msg;
 	}
+
+	/* receive the file checksum from the client */
+	result = recv_msg(ep, peer_addr, received_msg, &msg_len, app_cfg->timeout, NULL);
+	if (result != DOCA_SUCCESS)
+		goto finish_msg;
+	if (msg_len != sizeof(*trailer) || ntohl(trailer->magic) != STREAM_TRAILER_MAGIC) {
+		DOCA_LOG_ERR("Received wrong message, expected a stream trailer");
+		result = DOCA_ERROR_BAD_STATE;
+		goto finish_msg;
+	}
+	received_checksum = ntohq(trailer->checksum);
+	checksum = stream_checksum(stream.checksums, stream.nb_blocks, stream.file_size, stream.block_size);
 	if (checksum == received_checksum)
 		DOCA_LOG_INFO("SUCCESS: file was received and decompressed successfully");
 	else {
 		DOCA_LOG_ERR("ERROR: file checksum is different. received: 0x%lx, calculated: 0x%lx", received_checksum, checksum);
-		free(resp_head);
 		result = DOCA_ERROR_BAD_STATE;
 		goto finish_msg;
 	}
-
-	fd = open(app_cfg->file_path, O_CREAT | O_WRONLY, S_IRUSR | S_IRGRP);
-	if (fd < 0) {
-		DOCA_LOG_ERR("Failed to open %s", app_cfg->file_path);
-		free(resp_head);
-		result = DOCA_ERROR_IO_FAILED;
-		goto finish_msg;
-	}
-
-	if ((size_t)write(fd, resp_head, data_len) != data_len) {
-		DOCA_LOG_ERR("Failed to write the decompressed into the input file");
-		free(resp_head);
-		close(fd);
-		result = DOCA_ERROR_IO_FAILED;
-		goto finish_msg;
-	}
-	free(resp_head);
-	close(fd);
+	log_throughput("Received", stream.file_size, stream.compressed_size, start, stream.first_block);
 
 finish_msg:
-	if (compressed_file != NULL)
-		free(compressed_file);
+	if (stream.fd >= 0) {
+		close(stream.fd);
+		/* A file that failed to be received is not left partially written */
+		if (result != DOCA_SUCCESS)
+			unlink(app_cfg->file_path);
+	}
+	free(stream.received);
+	free(stream.checksums);
 
 	/* Send finish message to the client */
-	while ((tmp_result = doca_comm_channel_ep_sendto(ep, finish_msg, sizeof(finish_msg), DOCA_CC_MSG_FLAG_NONE,
-						     *peer_addr)) == DOCA_ERROR_AGAIN)
-		nanosleep(&ts, &ts);
-
+	tmp_result = send_msg(ep, peer_addr, finish_msg, sizeof(finish_msg));
 	if (tmp_result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to send finish message: %s", doca_error_get_descr(result));
+		DOCA_LOG_ERR("Failed to send finish message: %s", doca_error_get_descr(tmp_result));
 		if (result == DOCA_SUCCESS)
 			result = tmp_result;
 	}
@@ -750,12 +994,23 @@ file_compression_init(struct doca_comm_channel_ep_t **ep, struct doca_comm_chann
 	struct timespec ts = {
 		.tv_nsec = SLEEP_IN_NANOS,
 	};
+	long nb_cpus;
 	doca_error_t result;
 
 	/* set default timeout */
 	if (app_cfg->timeout == 0)
 		app_cfg->timeout = DEFAULT_TIMEOUT;
 
+	/* set default stream parameters */
+	if (app_cfg->nb_sw_threads == 0) {
+		nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		app_cfg->nb_sw_threads = nb_cpus > 0 ? nb_cpus : 1;
+	}
+	if (app_cfg->block_size == 0)
+		app_cfg->block_size = BLOCK_ENGINE_DEFAULT_BLOCK_SIZE;
+	if (app_cfg->nb_tasks == 0)
+		app_cfg->nb_tasks = BLOCK_ENGINE_DEFAULT_TASKS;
+
 	/* Create Comm Channel endpoint */
 	result = doca_comm_channel_ep_create(ep);
 	if (result != DOCA_SUCCESS) {
@@ -975,6 +1230,86 @@ timeout_callback(void *param, void *config)
 	return DOCA_SUCCESS;
 }
 
+/*
+ * ARGP Callback - Handle number of compress tasks parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+tasks_callback(void *param, void *config)
+{
+	struct file_compression_config *app_cfg = (struct file_compression_config *)config;
+	int *nb_tasks = (int *)param;
+
+	if (*nb_tasks <= 0 || *nb_tasks > BLOCK_ENGINE_MAX_TASKS) {
+		DOCA_LOG_ERR("Number of compress tasks must be between 1 and %d", BLOCK_ENGINE_MAX_TASKS);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	app_cfg->nb_tasks = *nb_tasks;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle number of SW compress threads parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+sw_threads_callback(void *param, void *config)
+{
+	struct file_compression_config *app_cfg = (struct file_compression_config *)config;
+	int *nb_threads = (int *)param;
+
+	if (*nb_threads <= 0) {
+		DOCA_LOG_ERR("Number of SW compress threads must be positive value");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	app_cfg->nb_sw_threads = *nb_threads;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle block size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+block_size_callback(void *param, void *config)
+{
+	struct file_compression_config *app_cfg = (struct file_compression_config *)config;
+	int *block_size = (int *)param;
+
+	if (*block_size < BLOCK_ENGINE_MIN_BLOCK_SIZE || *block_size > BLOCK_ENGINE_MAX_BLOCK_SIZE) {
+		DOCA_LOG_ERR("Block size must be between %d and %d bytes", BLOCK_ENGINE_MIN_BLOCK_SIZE,
+			     BLOCK_ENGINE_MAX_BLOCK_SIZE);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	app_cfg->block_size = *block_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle independent blocks parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+independent_blocks_callback(void *param, void *config)
+{
+	struct file_compression_config *app_cfg = (struct file_compression_config *)config;
+
+	app_cfg->independent_blocks = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
 /*
  * ARGP validation Callback - check if the running mode is valid and that the input file exists in client mode
  *
@@ -1002,6 +1337,7 @@ register_file_compression_params(void)
 	doca_error_t result;
 
 	struct doca_argp_param *dev_pci_addr_param, *rep_pci_addr_param, *file_param, *timeout_param;
+	struct doca_argp_param *tasks_param, *sw_threads_param, *block_size_param, *independent_blocks_param;
 
 	/* Create and register pci param */
 	result = doca_argp_param_create(&dev_pci_addr_param);
@@ -1073,6 +1409,74 @@ register_file_compression_params(void)
 		return result;
 	}
 
+	/* Create and register number of compress tasks */
+	result = doca_argp_param_create(&tasks_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(tasks_param, "tasks");
+	doca_argp_param_set_description(tasks_param,
+					"Number of blocks compressed, sent and decompressed at once, default is 16");
+	doca_argp_param_set_callback(tasks_param, tasks_callback);
+	doca_argp_param_set_type(tasks_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(tasks_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register number of SW compress threads */
+	result = doca_argp_param_create(&sw_threads_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(sw_threads_param, "sw-threads");
+	doca_argp_param_set_description(sw_threads_param,
+					"Number of threads of the SW compress used without compress device, default is one per CPU");
+	doca_argp_param_set_callback(sw_threads_param, sw_threads_callback);
+	doca_argp_param_set_type(sw_threads_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(sw_threads_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register block size */
+	result = doca_argp_param_create(&block_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(block_size_param, "block-size");
+	doca_argp_param_set_description(block_size_param,
+					"Uncompressed size of the blocks the file is streamed in, in bytes, default is 131072");
+	doca_argp_param_set_callback(block_size_param, block_size_callback);
+	doca_argp_param_set_type(block_size_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(block_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register independent blocks flag */
+	result = doca_argp_param_create(&independent_blocks_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(independent_blocks_param, "independent-blocks");
+	doca_argp_param_set_description(independent_blocks_param,
+					"Client only - with zlib, compress the blocks independently instead of a single deflate stream primed across blocks, the server inflates them in parallel at the cost of the compression ratio");
+	doca_argp_param_set_callback(independent_blocks_param, independent_blocks_callback);
+	doca_argp_param_set_type(independent_blocks_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(independent_blocks_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
 	/* Register version callback for DOCA SDK & RUNTIME */
 	result = doca_argp_register_version_callback(sdk_version_callback);
 	if (result != DOCA_SUCCESS) {
@@ -46,6 +46,10 @@ struct file_compression_config {
 	char cc_dev_rep_pci_addr[DOCA_DEVINFO_REP_PCI_ADDR_SIZE]; /* Comm Channel DOCA device representor PCI address */
 	int timeout;						  /* Application timeout in seconds */
 	enum file_compression_compress_method compress_method;	  /* Whether to run compress with HW or SW */
+	uint32_t nb_tasks;					  /* Blocks in flight, compress tasks and credits */
+	uint32_t nb_sw_threads;					  /* SW compress threads, 0 for one per CPU */
+	uint32_t block_size;					  /* Uncompressed block size of the stream */
+	bool independent_blocks;				  /* Client: zlib compresses the blocks independently */
 };
 
 /*
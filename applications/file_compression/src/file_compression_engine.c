@@ -0,0 +1,871 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <zlib.h>
+
+#include <doca_buf.h>
+#include <doca_buf_inventory.h>
+#include <doca_ctx.h>
+#include <doca_log.h>
+#include <doca_pe.h>
+
+#include <utils.h>
+
+#include "file_compression_engine.h"
+
+#define BLOCK_ENGINE_SLEEP_IN_NANOS (10 * 1000)	/* Sample the tasks every 10 microseconds */
+#define BLOCK_ENGINE_FLUSH_SIZE 16			/* Room for the empty stored block of a sync flush */
+
+DOCA_LOG_REGISTER(FILE_COMPRESSION::Engine);
+
+/* Slot of a block in flight */
+struct block_slot {
+	struct block_engine *engine;				/* Engine of the slot */
+	uint32_t block_idx;					/* Index of the block in the slot */
+	bool busy;						/* True while the block is processed */
+	uint8_t *src;						/* Source buffer */
+	uint8_t *dst;						/* Destination buffer */
+	size_t len;						/* Block length in the source buffer */
+	size_t out_len;						/* Block length in the destination buffer */
+	uint8_t *dict;						/* Primed mode: dictionary of the block */
+	size_t dict_len;					/* Primed mode: dictionary length */
+	bool last;						/* Primed mode: the block ends the stream */
+	bool processed;						/* Primed mode: processed, waits for the blocks before it */
+	uint64_t checksum;					/* Checksum of the uncompressed block */
+	doca_error_t result;					/* Result of the block */
+	struct doca_compress_task_compress_deflate *compress_task;	/* Compress task of the DOCA backend */
+	struct doca_compress_task_decompress_deflate *decompress_task;	/* Decompress task of the DOCA backend */
+	struct doca_buf *src_buf;				/* Source buffer of the DOCA backend */
+	struct doca_buf *dst_buf;				/* Destination buffer of the DOCA backend */
+};
+
+/* Engine of blocks */
+struct block_engine {
+	struct block_engine_cfg cfg;		/* Configuration */
+	struct block_slot *slots;		/* Slots */
+	uint8_t *src_region;			/* Source buffers of all the slots */
+	uint8_t *dst_region;			/* Destination buffers of all the slots */
+	uint32_t nb_busy;			/* Slots in flight */
+	doca_error_t result;			/* First block failure */
+	/* Primed mode */
+	uint8_t *dict_region;			/* Dictionaries of all the slots */
+	uint8_t window[BLOCK_ENGINE_WINDOW_SIZE];	/* End of the blocks submitted so far */
+	size_t window_len;			/* Bytes in the window */
+	uint32_t next_block;			/* Index of the next block of the stream */
+	uint32_t *order;			/* Slots in flight in stream order, a ring of nb_slots entries */
+	uint32_t order_head;			/* First slot in stream order */
+	/* DOCA backend */
+	struct compress_resources *resources;	/* DOCA compress resources */
+	/* Software backend, the slots indexes are queued in rings of nb_slots entries */
+	z_stream strm;				/* Stream of the caller thread when there is no thread */
+	bool strm_ready;			/* The stream of the caller thread is initialized */
+	pthread_t *threads;			/* zlib threads */
+	uint32_t nb_threads;			/* zlib threads started */
+	pthread_mutex_t lock;			/* Protects the rings and stop */
+	pthread_cond_t job_cond;		/* Signaled when a job is queued or on stop */
+	pthread_cond_t done_cond;		/* Signaled when a job is done */
+	uint32_t *jobs;				/* Slots to process */
+	uint32_t jobs_head;			/* First job */
+	uint32_t nb_jobs;			/* Queued jobs */
+	uint32_t *done;				/* Slots processed, not completed yet */
+	uint32_t nb_done;			/* Slots processed */
+	bool stop;				/* Set to stop the threads */
+};
+
+/*
+ * Free callback - free the slots buffers of the DOCA backend
+ *
+ * @addr [in]: Memory range pointer
+ * @len [in]: Memory range length
+ * @opaque [in]: An opaque pointer passed to iterator
+ */
+static void
+free_region_cb(void *addr, size_t len, void *opaque)
+{
+	(void)len;
+	(void)opaque;
+
+	free(addr);
+}
+
+/*
+ * Complete a processed slot: free it and give the output to the caller
+ *
+ * @slot [in]: slot
+ */
+static void
+complete_slot(struct block_slot *slot)
+{
+	struct block_engine *engine = slot->engine;
+	doca_error_t result;
+
+	slot->busy = false;
+	engine->nb_busy--;
+	if (slot->result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to %s block %u: %s",
+			     engine->cfg.mode == COMPRESS_MODE_COMPRESS_DEFLATE ? "compress" : "decompress",
+			     slot->block_idx, doca_error_get_descr(slot->result));
+		if (engine->result == DOCA_SUCCESS)
+			engine->result = slot->result;
+		return;
+	}
+	/* The blocks completed after a failure are dropped */
+	if (engine->result != DOCA_SUCCESS)
+		return;
+	result = engine->cfg.block_cb(slot->block_idx, slot->dst, slot->out_len, slot->checksum, engine->cfg.user_ctx);
+	if (result != DOCA_SUCCESS)
+		engine->result = result;
+}
+
+/*
+ * Get the checksum of a buffer
+ *
+ * @data [in]: buffer
+ * @len [in]: buffer length
+ * @return: checksum
+ */
+static uint64_t
+sw_checksum(const uint8_t *data, size_t len)
+{
+	uint64_t adler = adler32(adler32(0L, Z_NULL, 0), data, len);
+
+	return (adler << 32) | crc32(crc32(0L, Z_NULL, 0), data, len);
+}
+
+/*
+ * Initialize the zlib stream of a thread
+ *
+ * @strm [out]: stream
+ * @mode [in]: compress or decompress
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+init_stream(z_stream *strm, enum compress_mode mode)
+{
+	int err;
+
+	memset(strm, 0, sizeof(*strm));
+	if (mode == COMPRESS_MODE_COMPRESS_DEFLATE)
+		err = deflateInit2(strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, MAX_MEM_LEVEL,
+				   Z_DEFAULT_STRATEGY);
+	else
+		err = inflateInit2(strm, -MAX_WBITS);
+	if (err != Z_OK) {
+		DOCA_LOG_ERR("Failed to initialize %s system",
+			     mode == COMPRESS_MODE_COMPRESS_DEFLATE ? "compression" : "decompression");
+		return DOCA_ERROR_BAD_STATE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Release the zlib stream of a thread
+ *
+ * @strm [in]: stream
+ * @mode [in]: compress or decompress
+ */
+static void
+end_stream(z_stream *strm, enum compress_mode mode)
+{
+	if (mode == COMPRESS_MODE_COMPRESS_DEFLATE)
+		deflateEnd(strm);
+	else
+		inflateEnd(strm);
+}
+
+/*
+ * Compress or decompress a block of a primed stream with zlib
+ * A block is compressed with its dictionary and ends with a sync flush, so it ends on a byte boundary and joins the
+ * blocks around it to a single stream. The inflater is not reset between the blocks, it decompresses the stream.
+ *
+ * @strm [in]: stream of the thread
+ * @mode [in]: compress or decompress
+ * @slot [in/out]: slot
+ * @dst_size [in]: destination buffer size
+ */
+static void
+run_primed_block_sw(z_stream *strm, enum compress_mode mode, struct block_slot *slot, size_t dst_size)
+{
+	int flush = slot->last ? Z_FINISH : Z_SYNC_FLUSH;
+	int err;
+
+	if (mode == COMPRESS_MODE_COMPRESS_DEFLATE) {
+		if (deflateReset(strm) != Z_OK ||
+		    (slot->dict_len > 0 && deflateSetDictionary(strm, slot->dict, slot->dict_len) != Z_OK)) {
+			slot->result = DOCA_ERROR_BAD_STATE;
+			return;
+		}
+	}
+	strm->next_in = slot->src;
+	strm->avail_in = slot->len;
+	strm->next_out = slot->dst;
+	strm->avail_out = dst_size;
+	err = mode == COMPRESS_MODE_COMPRESS_DEFLATE ? deflate(strm, flush) : inflate(strm, flush);
+	/* A compressed block that fills the destination buffer may miss the end of its flush */
+	if (slot->last ? err != Z_STREAM_END :
+			 (err != Z_OK || strm->avail_in != 0 ||
+			  (mode == COMPRESS_MODE_COMPRESS_DEFLATE && strm->avail_out == 0))) {
+		slot->result = (err == Z_OK || err == Z_BUF_ERROR) && strm->avail_out == 0 ? DOCA_ERROR_TOO_BIG :
+											     DOCA_ERROR_INVALID_VALUE;
+		return;
+	}
+	slot->out_len = dst_size - strm->avail_out;
+	if (mode == COMPRESS_MODE_COMPRESS_DEFLATE)
+		slot->checksum = sw_checksum(slot->src, slot->len);
+	else
+		slot->checksum = sw_checksum(slot->dst, slot->out_len);
+	slot->result = DOCA_SUCCESS;
+}
+
+/*
+ * Compress or decompress the block of a slot with zlib
+ *
+ * @strm [in]: stream of the thread
+ * @mode [in]: compress or decompress
+ * @slot [in/out]: slot
+ * @dst_size [in]: destination buffer size
+ */
+static void
+run_block_sw(z_stream *strm, enum compress_mode mode, struct block_slot *slot, size_t dst_size)
+{
+	int err;
+
+	if (slot->engine->cfg.primed) {
+		run_primed_block_sw(strm, mode, slot, dst_size);
+		return;
+	}
+
+	err = mode == COMPRESS_MODE_COMPRESS_DEFLATE ? deflateReset(strm) : inflateReset(strm);
+	if (err != Z_OK) {
+		slot->result = DOCA_ERROR_BAD_STATE;
+		return;
+	}
+	strm->next_in = slot->src;
+	strm->avail_in = slot->len;
+	strm->next_out = slot->dst;
+	strm->avail_out = dst_size;
+	err = mode == COMPRESS_MODE_COMPRESS_DEFLATE ? deflate(strm, Z_FINISH) : inflate(strm, Z_FINISH);
+	if (err != Z_STREAM_END) {
+		/* The block is a single stream that fits the destination buffer */
+		slot->result = (err == Z_OK || err == Z_BUF_ERROR) && strm->avail_out == 0 ? DOCA_ERROR_TOO_BIG :
+											     DOCA_ERROR_INVALID_VALUE;
+		return;
+	}
+	slot->out_len = dst_size - strm->avail_out;
+	if (mode == COMPRESS_MODE_COMPRESS_DEFLATE)
+		slot->checksum = sw_checksum(slot->src, slot->len);
+	else
+		slot->checksum = sw_checksum(slot->dst, slot->out_len);
+	slot->result = DOCA_SUCCESS;
+}
+
+/*
+ * zlib thread of the software backend
+ *
+ * @arg [in]: engine
+ * @return: NULL
+ */
+static void *
+block_thread(void *arg)
+{
+	struct block_engine *engine = arg;
+	struct block_slot *slot;
+	uint32_t slot_idx, nb_slots = engine->cfg.nb_slots;
+	doca_error_t init_result;
+	z_stream strm;
+
+	init_result = init_stream(&strm, engine->cfg.mode);
+
+	pthread_mutex_lock(&engine->lock);
+	for (;;) {
+		while (!engine->stop && engine->nb_jobs == 0)
+			pthread_cond_wait(&engine->job_cond, &engine->lock);
+		if (engine->nb_jobs == 0)
+			break;
+		slot_idx = engine->jobs[engine->jobs_head];
+		engine->jobs_head = (engine->jobs_head + 1) % nb_slots;
+		engine->nb_jobs--;
+		pthread_mutex_unlock(&engine->lock);
+
+		slot = &engine->slots[slot_idx];
+		slot->result = init_result;
+		if (init_result == DOCA_SUCCESS)
+			run_block_sw(&strm, engine->cfg.mode, slot, engine->cfg.dst_size);
+
+		pthread_mutex_lock(&engine->lock);
+		engine->done[engine->nb_done++] = slot_idx;
+		pthread_cond_signal(&engine->done_cond);
+	}
+	pthread_mutex_unlock(&engine->lock);
+
+	if (init_result == DOCA_SUCCESS)
+		end_stream(&strm, engine->cfg.mode);
+	return NULL;
+}
+
+/*
+ * Complete the slots processed by the software threads
+ *
+ * @engine [in]: engine
+ * @wait [in]: wait for a slot if none is processed yet
+ */
+static void
+progress_sw(struct block_engine *engine, bool wait)
+{
+	uint32_t done[BLOCK_ENGINE_MAX_TASKS];
+	uint32_t nb_done, i;
+
+	pthread_mutex_lock(&engine->lock);
+	while (wait && engine->nb_done == 0)
+		pthread_cond_wait(&engine->done_cond, &engine->lock);
+	nb_done = engine->nb_done;
+	memcpy(done, engine->done, nb_done * sizeof(*done));
+	engine->nb_done = 0;
+	pthread_mutex_unlock(&engine->lock);
+
+	/* The callbacks run without the lock, in the caller thread */
+	for (i = 0; i < nb_done; i++) {
+		if (engine->cfg.primed)
+			engine->slots[done[i]].processed = true;
+		else
+			complete_slot(&engine->slots[done[i]]);
+	}
+
+	/* The blocks of a primed stream are given to the callback in stream order */
+	while (engine->cfg.primed && engine->nb_busy > 0 && engine->slots[engine->order[engine->order_head]].processed) {
+		engine->slots[engine->order[engine->order_head]].processed = false;
+		complete_slot(&engine->slots[engine->order[engine->order_head]]);
+		engine->order_head = (engine->order_head + 1) % engine->cfg.nb_slots;
+	}
+}
+
+/*
+ * Complete the processed slots
+ *
+ * @engine [in]: engine
+ * @wait [in]: sleep if nothing was completed
+ */
+static void
+progress(struct block_engine *engine, bool wait)
+{
+	struct timespec ts = {
+		.tv_nsec = BLOCK_ENGINE_SLEEP_IN_NANOS,
+	};
+
+	if (engine->cfg.backend == BLOCK_ENGINE_SW) {
+		if (engine->nb_threads > 0)
+			progress_sw(engine, wait);
+	} else if (doca_pe_progress(engine->resources->state->pe) == 0 && wait)
+		nanosleep(&ts, &ts);
+}
+
+/*
+ * Stop the threads of the software backend
+ *
+ * @engine [in]: engine
+ */
+static void
+stop_threads(struct block_engine *engine)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&engine->lock);
+	engine->stop = true;
+	pthread_cond_broadcast(&engine->job_cond);
+	pthread_mutex_unlock(&engine->lock);
+	for (i = 0; i < engine->nb_threads; i++)
+		pthread_join(engine->threads[i], NULL);
+	engine->nb_threads = 0;
+}
+
+/*
+ * Start the threads of the software backend
+ *
+ * @engine [in]: engine
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+start_threads(struct block_engine *engine)
+{
+	uint32_t i;
+
+	engine->jobs = calloc(engine->cfg.nb_slots, sizeof(*engine->jobs));
+	engine->done = calloc(engine->cfg.nb_slots, sizeof(*engine->done));
+	engine->threads = calloc(engine->cfg.nb_threads, sizeof(*engine->threads));
+	if (engine->jobs == NULL || engine->done == NULL || engine->threads == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	for (i = 0; i < engine->cfg.nb_threads; i++) {
+		if (pthread_create(&engine->threads[i], NULL, block_thread, engine) != 0) {
+			DOCA_LOG_ERR("Failed to create zlib thread");
+			stop_threads(engine);
+			return DOCA_ERROR_OPERATING_SYSTEM;
+		}
+		engine->nb_threads++;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Compress deflate task completed callback of the DOCA backend
+ *
+ * @compress_task [in]: Completed task
+ * @task_user_data [in]: doca_data from the task
+ * @ctx_user_data [in]: doca_data from the context
+ */
+static void
+block_compress_completed_callback(struct doca_compress_task_compress_deflate *compress_task,
+				  union doca_data task_user_data, union doca_data ctx_user_data)
+{
+	struct block_slot *slot = (struct block_slot *)task_user_data.ptr;
+	uint64_t adler = doca_compress_task_compress_deflate_get_adler_cs(compress_task);
+
+	(void)ctx_user_data;
+
+	slot->checksum = (adler << 32) | doca_compress_task_compress_deflate_get_crc_cs(compress_task);
+	slot->result = doca_buf_get_data_len(slot->dst_buf, &slot->out_len);
+	complete_slot(slot);
+}
+
+/*
+ * Compress deflate task error callback of the DOCA backend
+ *
+ * @compress_task [in]: Failed task
+ * @task_user_data [in]: doca_data from the task
+ * @ctx_user_data [in]: doca_data from the context
+ */
+static void
+block_compress_error_callback(struct doca_compress_task_compress_deflate *compress_task,
+			      union doca_data task_user_data, union doca_data ctx_user_data)
+{
+	struct block_slot *slot = (struct block_slot *)task_user_data.ptr;
+
+	(void)ctx_user_data;
+
+	slot->result = doca_task_get_status(doca_compress_task_compress_deflate_as_task(compress_task));
+	complete_slot(slot);
+}
+
+/*
+ * Decompress deflate task completed callback of the DOCA backend
+ *
+ * @decompress_task [in]: Completed task
+ * @task_user_data [in]: doca_data from the task
+ * @ctx_user_data [in]: doca_data from the context
+ */
+static void
+block_decompress_completed_callback(struct doca_compress_task_decompress_deflate *decompress_task,
+				    union doca_data task_user_data, union doca_data ctx_user_data)
+{
+	struct block_slot *slot = (struct block_slot *)task_user_data.ptr;
+	uint64_t adler = doca_compress_task_decompress_deflate_get_adler_cs(decompress_task);
+
+	(void)ctx_user_data;
+
+	slot->checksum = (adler << 32) | doca_compress_task_decompress_deflate_get_crc_cs(decompress_task);
+	slot->result = doca_buf_get_data_len(slot->dst_buf, &slot->out_len);
+	complete_slot(slot);
+}
+
+/*
+ * Decompress deflate task error callback of the DOCA backend
+ *
+ * @decompress_task [in]: Failed task
+ * @task_user_data [in]: doca_data from the task
+ * @ctx_user_data [in]: doca_data from the context
+ */
+static void
+block_decompress_error_callback(struct doca_compress_task_decompress_deflate *decompress_task,
+				union doca_data task_user_data, union doca_data ctx_user_data)
+{
+	struct block_slot *slot = (struct block_slot *)task_user_data.ptr;
+
+	(void)ctx_user_data;
+
+	slot->result = doca_task_get_status(doca_compress_task_decompress_deflate_as_task(decompress_task));
+	complete_slot(slot);
+}
+
+doca_error_t
+block_engine_set_conf(struct doca_compress *compress, enum compress_mode mode, uint32_t nb_tasks)
+{
+	if (mode == COMPRESS_MODE_COMPRESS_DEFLATE)
+		return doca_compress_task_compress_deflate_set_conf(compress, block_compress_completed_callback,
+								    block_compress_error_callback, nb_tasks);
+	return doca_compress_task_decompress_deflate_set_conf(compress, block_decompress_completed_callback,
+							      block_decompress_error_callback, nb_tasks);
+}
+
+size_t
+block_engine_compress_bound(size_t block_size)
+{
+	/* Bound of zlib for any level, the DOCA engine falls back to stored blocks as well */
+	return compressBound(block_size) + BLOCK_ENGINE_FLUSH_SIZE;
+}
+
+/*
+ * Register a region in a memory map, the memory map releases it
+ *
+ * @mmap [in]: memory map
+ * @region [in/out]: region, set to NULL once owned by the memory map
+ * @len [in]: region length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+register_region(struct doca_mmap *mmap, uint8_t **region, size_t len)
+{
+	doca_error_t result;
+
+	result = doca_mmap_set_memrange(mmap, *region, len);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to set memory range of memory map: %s", doca_error_get_descr(result));
+		return result;
+	}
+	result = doca_mmap_set_free_cb(mmap, &free_region_cb, NULL);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to set free callback of memory map: %s", doca_error_get_descr(result));
+		return result;
+	}
+	*region = NULL;
+	result = doca_mmap_start(mmap);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to start memory map: %s", doca_error_get_descr(result));
+		return result;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Prepare the DOCA backend: register the slots buffers, start the compress context and allocate a task per slot
+ *
+ * @engine [in]: engine
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+init_doca_backend(struct block_engine *engine)
+{
+	struct program_core_objects *state = engine->resources->state;
+	struct doca_compress *compress = engine->resources->compress;
+	union doca_data task_user_data = {0};
+	struct block_slot *slot;
+	doca_error_t result;
+	uint32_t i;
+
+	result = register_region(state->src_mmap, &engine->src_region, engine->cfg.nb_slots * engine->cfg.src_size);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_region(state->dst_mmap, &engine->dst_region, engine->cfg.nb_slots * engine->cfg.dst_size);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	result = doca_ctx_start(state->ctx);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to start DOCA context: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	for (i = 0; i < engine->cfg.nb_slots; i++) {
+		slot = &engine->slots[i];
+		result = doca_buf_inventory_buf_get_by_addr(state->buf_inv, state->src_mmap, slot->src,
+							    engine->cfg.src_size, &slot->src_buf);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Unable to acquire DOCA buffer representing source buffer: %s",
+				     doca_error_get_descr(result));
+			return result;
+		}
+		result = doca_buf_inventory_buf_get_by_addr(state->buf_inv, state->dst_mmap, slot->dst,
+							    engine->cfg.dst_size, &slot->dst_buf);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Unable to acquire DOCA buffer representing destination buffer: %s",
+				     doca_error_get_descr(result));
+			return result;
+		}
+
+		/* Include the slot in user data of task to be used in the callbacks */
+		task_user_data.ptr = slot;
+		if (engine->cfg.mode == COMPRESS_MODE_COMPRESS_DEFLATE)
+			result = doca_compress_task_compress_deflate_alloc_init(compress, slot->src_buf,
+										slot->dst_buf, task_user_data,
+										&slot->compress_task);
+		else
+			result = doca_compress_task_decompress_deflate_alloc_init(compress, slot->src_buf,
+										  slot->dst_buf, task_user_data,
+										  &slot->decompress_task);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to allocate compress task: %s", doca_error_get_descr(result));
+			return result;
+		}
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+block_engine_create(const struct block_engine_cfg *cfg, struct compress_resources *resources,
+		    struct block_engine **engine)
+{
+	struct block_engine *new_engine;
+	doca_error_t result;
+	uint32_t i;
+
+	if (cfg->nb_slots == 0 || cfg->nb_slots > BLOCK_ENGINE_MAX_TASKS) {
+		DOCA_LOG_ERR("Number of compress tasks must be between 1 and %d", BLOCK_ENGINE_MAX_TASKS);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (cfg->primed && cfg->backend != BLOCK_ENGINE_SW) {
+		DOCA_LOG_ERR("A primed stream is only supported by the software backend");
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+
+	new_engine = calloc(1, sizeof(*new_engine));
+	if (new_engine == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	new_engine->cfg = *cfg;
+	/* The blocks of a primed stream are decompressed one after the other by a single inflater */
+	if (cfg->primed && cfg->mode != COMPRESS_MODE_COMPRESS_DEFLATE)
+		new_engine->cfg.nb_threads = 0;
+	new_engine->resources = resources;
+	new_engine->result = DOCA_SUCCESS;
+	pthread_mutex_init(&new_engine->lock, NULL);
+	pthread_cond_init(&new_engine->job_cond, NULL);
+	pthread_cond_init(&new_engine->done_cond, NULL);
+
+	new_engine->slots = calloc(cfg->nb_slots, sizeof(*new_engine->slots));
+	new_engine->src_region = malloc(cfg->nb_slots * cfg->src_size);
+	new_engine->dst_region = malloc(cfg->nb_slots * cfg->dst_size);
+	if (new_engine->slots == NULL || new_engine->src_region == NULL || new_engine->dst_region == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto destroy_engine;
+	}
+	if (cfg->primed && cfg->mode == COMPRESS_MODE_COMPRESS_DEFLATE) {
+		new_engine->dict_region = malloc(cfg->nb_slots * BLOCK_ENGINE_WINDOW_SIZE);
+		new_engine->order = calloc(cfg->nb_slots, sizeof(*new_engine->order));
+		if (new_engine->dict_region == NULL || new_engine->order == NULL) {
+			DOCA_LOG_ERR("Failed to allocate memory");
+			result = DOCA_ERROR_NO_MEMORY;
+			goto destroy_engine;
+		}
+	}
+	for (i = 0; i < cfg->nb_slots; i++) {
+		new_engine->slots[i].engine = new_engine;
+		new_engine->slots[i].src = new_engine->src_region + i * cfg->src_size;
+		new_engine->slots[i].dst = new_engine->dst_region + i * cfg->dst_size;
+		if (new_engine->dict_region != NULL)
+			new_engine->slots[i].dict = new_engine->dict_region + i * BLOCK_ENGINE_WINDOW_SIZE;
+	}
+
+	if (cfg->backend == BLOCK_ENGINE_DOCA)
+		result = init_doca_backend(new_engine);
+	else if (new_engine->cfg.nb_threads > 0)
+		result = start_threads(new_engine);
+	else {
+		result = init_stream(&new_engine->strm, cfg->mode);
+		new_engine->strm_ready = result == DOCA_SUCCESS;
+	}
+	if (result != DOCA_SUCCESS)
+		goto destroy_engine;
+
+	*engine = new_engine;
+	return DOCA_SUCCESS;
+
+destroy_engine:
+	block_engine_destroy(new_engine);
+	return result;
+}
+
+uint8_t *
+block_engine_src(struct block_engine *engine, uint32_t slot)
+{
+	return engine->slots[slot].src;
+}
+
+doca_error_t
+block_engine_wait_slot(struct block_engine *engine, uint32_t slot)
+{
+	while (engine->slots[slot].busy)
+		progress(engine, true);
+	return engine->result;
+}
+
+doca_error_t
+block_engine_poll(struct block_engine *engine)
+{
+	progress(engine, false);
+	return engine->result;
+}
+
+/*
+ * Prepare the next block of a primed stream: copy its dictionary, the window, and slide the window over the block
+ *
+ * @engine [in]: engine
+ * @slot_idx [in]: free slot of the block, its block index and length are set
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+prime_block(struct block_engine *engine, uint32_t slot_idx)
+{
+	struct block_slot *slot = &engine->slots[slot_idx];
+	size_t keep;
+
+	if (slot->block_idx != engine->next_block || slot->block_idx >= engine->cfg.nb_blocks) {
+		DOCA_LOG_ERR("Block %u is not the next block %u of the primed stream", slot->block_idx,
+			     engine->next_block);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	engine->next_block++;
+	slot->last = engine->next_block == engine->cfg.nb_blocks;
+	if (engine->cfg.mode != COMPRESS_MODE_COMPRESS_DEFLATE)
+		return DOCA_SUCCESS;
+
+	/* The slot keeps its own dictionary, the source buffer of the block before it may be refilled meanwhile */
+	memcpy(slot->dict, engine->window, engine->window_len);
+	slot->dict_len = engine->window_len;
+	if (slot->len >= BLOCK_ENGINE_WINDOW_SIZE) {
+		memcpy(engine->window, slot->src + slot->len - BLOCK_ENGINE_WINDOW_SIZE, BLOCK_ENGINE_WINDOW_SIZE);
+		engine->window_len = BLOCK_ENGINE_WINDOW_SIZE;
+	} else {
+		keep = MIN(engine->window_len, BLOCK_ENGINE_WINDOW_SIZE - slot->len);
+		memmove(engine->window, engine->window + engine->window_len - keep, keep);
+		memcpy(engine->window + keep, slot->src, slot->len);
+		engine->window_len = keep + slot->len;
+	}
+
+	if (engine->nb_threads > 0)
+		engine->order[(engine->order_head + engine->nb_busy) % engine->cfg.nb_slots] = slot_idx;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+block_engine_submit(struct block_engine *engine, uint32_t slot_idx, uint32_t block_idx, size_t len)
+{
+	struct block_slot *slot = &engine->slots[slot_idx];
+	struct doca_task *task;
+	doca_error_t result;
+
+	if (len > engine->cfg.src_size) {
+		DOCA_LOG_ERR("Block of %zu bytes is larger than the slot buffer of %zu bytes", len,
+			     engine->cfg.src_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	slot->block_idx = block_idx;
+	slot->len = len;
+	slot->out_len = 0;
+	if (engine->cfg.primed) {
+		result = prime_block(engine, slot_idx);
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+
+	if (engine->cfg.backend == BLOCK_ENGINE_SW) {
+		slot->busy = true;
+		engine->nb_busy++;
+		if (engine->nb_threads == 0) {
+			run_block_sw(&engine->strm, engine->cfg.mode, slot, engine->cfg.dst_size);
+			complete_slot(slot);
+			return engine->result;
+		}
+		pthread_mutex_lock(&engine->lock);
+		engine->jobs[(engine->jobs_head + engine->nb_jobs++) % engine->cfg.nb_slots] = slot_idx;
+		pthread_cond_signal(&engine->job_cond);
+		pthread_mutex_unlock(&engine->lock);
+		return DOCA_SUCCESS;
+	}
+
+	/* The task of the slot is reused, only the lengths of its buffers change */
+	result = doca_buf_set_data(slot->src_buf, slot->src, len);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to set the source buffer data: %s", doca_error_get_descr(result));
+		return result;
+	}
+	result = doca_buf_reset_data_len(slot->dst_buf);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to reset the destination buffer: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	if (engine->cfg.mode == COMPRESS_MODE_COMPRESS_DEFLATE)
+		task = doca_compress_task_compress_deflate_as_task(slot->compress_task);
+	else
+		task = doca_compress_task_decompress_deflate_as_task(slot->decompress_task);
+	slot->busy = true;
+	engine->nb_busy++;
+	result = doca_task_submit(task);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to submit compress task: %s", doca_error_get_descr(result));
+		slot->busy = false;
+		engine->nb_busy--;
+		return result;
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+block_engine_wait_all(struct block_engine *engine)
+{
+	while (engine->nb_busy > 0)
+		progress(engine, true);
+	return engine->result;
+}
+
+void
+block_engine_destroy(struct block_engine *engine)
+{
+	struct block_slot *slot;
+	uint32_t i;
+
+	block_engine_wait_all(engine);
+	stop_threads(engine);
+	if (engine->strm_ready)
+		end_stream(&engine->strm, engine->cfg.mode);
+	for (i = 0; engine->slots != NULL && i < engine->cfg.nb_slots; i++) {
+		slot = &engine->slots[i];
+		if (slot->compress_task != NULL)
+			doca_task_free(doca_compress_task_compress_deflate_as_task(slot->compress_task));
+		if (slot->decompress_task != NULL)
+			doca_task_free(doca_compress_task_decompress_deflate_as_task(slot->decompress_task));
+		if (slot->src_buf != NULL)
+			doca_buf_dec_refcount(slot->src_buf, NULL);
+		if (slot->dst_buf != NULL)
+			doca_buf_dec_refcount(slot->dst_buf, NULL);
+	}
+	pthread_cond_destroy(&engine->done_cond);
+	pthread_cond_destroy(&engine->job_cond);
+	pthread_mutex_destroy(&engine->lock);
+	/* The regions registered by the DOCA backend are released with the memory maps */
+	free(engine->src_region);
+	free(engine->dst_region);
+	free(engine->threads);
+	free(engine->dict_region);
+	free(engine->order);
+	free(engine->done);
+	free(engine->jobs);
+	free(engine->slots);
+	free(engine);
+}
+
+uint64_t
+block_checksum_combine(uint64_t checksum, uint64_t next_checksum, size_t next_len)
+{
+	uint64_t adler = adler32_combine(checksum >> 32, next_checksum >> 32, next_len);
+	uint32_t crc = crc32_combine(checksum & UINT32_MAX, next_checksum & UINT32_MAX, next_len);
+
+	return (adler << 32) | crc;
+}
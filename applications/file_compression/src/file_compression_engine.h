@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef FILE_COMPRESSION_ENGINE_H_
+#define FILE_COMPRESSION_ENGINE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_compress.h>
+#include <doca_error.h>
+
+#include <samples/common.h>
+#include <samples/doca_compress/compress_common.h>
+
+/*
+ * Block engine of the file compression application.
+ * The file is split in blocks of a fixed size, every block is compressed to an independent raw deflate stream, so
+ * many blocks are compressed and decompressed at once and each one is sent as soon as it is ready.
+ * The engine has a fixed number of slots, every slot owns a source and a destination buffer, and runs the blocks
+ * either as DOCA compress tasks or with zlib on CPU threads.
+ * The checksum of a block is the Adler32 of its uncompressed data in the upper 32 bits and its CRC32 in the lower
+ * 32 bits, as computed by DOCA compress.
+ *
+ * In primed mode, available with the software backend only, the blocks are instead the parts of a single raw deflate
+ * stream: every block is compressed with the last 32KB of the blocks before it as dictionary and ends with a sync
+ * flush, and the last block ends the stream. The blocks are still compressed at once, but they are submitted and
+ * given to the block callback in stream order, and they are decompressed one after the other by a single inflater in
+ * the caller thread.
+ */
+
+#define BLOCK_ENGINE_DEFAULT_BLOCK_SIZE (128 * 1024)	/* Default uncompressed block size */
+#define BLOCK_ENGINE_MIN_BLOCK_SIZE 4096		/* Smallest uncompressed block size */
+#define BLOCK_ENGINE_MAX_BLOCK_SIZE (64 * 1024 * 1024)	/* Largest uncompressed block size */
+#define BLOCK_ENGINE_DEFAULT_TASKS 16			/* Default number of blocks in flight */
+#define BLOCK_ENGINE_MAX_TASKS 1024			/* Largest number of blocks in flight */
+#define BLOCK_ENGINE_EMPTY_CHECKSUM (1ULL << 32)	/* Checksum of no data, Adler32 is 1 and CRC32 is 0 */
+#define BLOCK_ENGINE_WINDOW_SIZE (32 * 1024)		/* Deflate window, the dictionary of a primed block */
+
+/* Backend of the block engine */
+enum block_engine_backend {
+	BLOCK_ENGINE_DOCA,	/* DOCA compress engine */
+	BLOCK_ENGINE_SW,	/* zlib on CPU threads */
+};
+
+/*
+ * Callback called on every processed block, from the thread that calls the engine functions
+ *
+ * @block_idx [in]: block index given to block_engine_submit()
+ * @data [in]: output of the block, valid until the callback returns
+ * @len [in]: output length
+ * @checksum [in]: checksum of the uncompressed block
+ * @user_ctx [in]: user context of the configuration
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR to fail the engine
+ */
+typedef doca_error_t (*block_engine_cb)(uint32_t block_idx, const uint8_t *data, size_t len, uint64_t checksum,
+					void *user_ctx);
+
+/* Engine of blocks, with a fixed number of slots of blocks in flight */
+struct block_engine;
+
+/* Block engine configuration */
+struct block_engine_cfg {
+	enum block_engine_backend backend;	/* Backend */
+	enum compress_mode mode;		/* Compress or decompress the blocks */
+	uint32_t nb_slots;			/* Blocks in flight */
+	uint32_t nb_threads;			/* Software backend threads, 0 to run in the caller thread */
+	size_t src_size;			/* Source buffer size of a slot */
+	size_t dst_size;			/* Destination buffer size of a slot */
+	bool primed;				/* The blocks are the parts of a single deflate stream, software only */
+	uint32_t nb_blocks;			/* Primed mode: number of blocks of the stream, the last one ends it */
+	block_engine_cb block_cb;		/* Called on every processed block */
+	void *user_ctx;				/* Context of the callback */
+};
+
+/*
+ * Set the task configuration of the DOCA backend, before the compress context is started
+ *
+ * @compress [in]: DOCA compress context
+ * @mode [in]: compress or decompress
+ * @nb_tasks [in]: number of tasks
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t block_engine_set_conf(struct doca_compress *compress, enum compress_mode mode, uint32_t nb_tasks);
+
+/*
+ * Get the size of the buffer that holds a compressed block
+ *
+ * @block_size [in]: uncompressed block size
+ * @return: largest compressed size of a block
+ */
+size_t block_engine_compress_bound(size_t block_size);
+
+/*
+ * Create a block engine
+ * The DOCA backend registers the slots buffers in the memory maps of the core objects and starts the compress
+ * context, the buffers are then released with the memory maps
+ *
+ * @cfg [in]: engine configuration
+ * @resources [in]: DOCA compress resources of the DOCA backend, unused by the software backend
+ * @engine [out]: engine
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t block_engine_create(const struct block_engine_cfg *cfg, struct compress_resources *resources,
+				 struct block_engine **engine);
+
+/*
+ * Get the source buffer of a slot, src_size bytes, to fill while the slot is free
+ *
+ * @engine [in]: engine
+ * @slot [in]: slot index
+ * @return: source buffer
+ */
+uint8_t *block_engine_src(struct block_engine *engine, uint32_t slot);
+
+/*
+ * Wait until a slot is free, the block callbacks of the blocks processed meanwhile are called
+ *
+ * @engine [in]: engine
+ * @slot [in]: slot index, lower than the number of slots
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR if a block failed
+ */
+doca_error_t block_engine_wait_slot(struct block_engine *engine, uint32_t slot);
+
+/*
+ * Complete the blocks processed so far without waiting
+ *
+ * @engine [in]: engine
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR if a block failed
+ */
+doca_error_t block_engine_poll(struct block_engine *engine);
+
+/*
+ * Process the block in the source buffer of a free slot, in primed mode the blocks are submitted in stream order
+ *
+ * @engine [in]: engine
+ * @slot [in]: free slot index
+ * @block_idx [in]: block index, given back to the block callback
+ * @len [in]: length of the block in the source buffer
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t block_engine_submit(struct block_engine *engine, uint32_t slot, uint32_t block_idx, size_t len);
+
+/*
+ * Wait until all the blocks submitted are processed
+ *
+ * @engine [in]: engine
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR if a block failed
+ */
+doca_error_t block_engine_wait_all(struct block_engine *engine);
+
+/*
+ * Wait for the blocks in flight and destroy an engine
+ *
+ * @engine [in]: engine
+ */
+void block_engine_destroy(struct block_engine *engine);
+
+/*
+ * Combine the checksums of two consecutive parts of a file
+ *
+ * @checksum [in]: checksum of the first part
+ * @next_checksum [in]: checksum of the second part
+ * @next_len [in]: length of the second part
+ * @return: checksum of the two parts
+ */
+uint64_t block_checksum_combine(uint64_t checksum, uint64_t next_checksum, size_t next_len);
+
+#endif /* FILE_COMPRESSION_ENGINE_H_ */
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Benchmark of the Merkle mode software hashing.
+ * A file, or generated data, is hashed as a single SHA256 stream the way the classic mode does, then as a Merkle tree
+ * with the software backend on a growing number of threads. Every software SHA256 implementation the CPU supports is
+ * measured. All the runs must compute the same tree root.
+ */
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "file_integrity_merkle.h"
+
+#define BENCH_SIZE_DEFAULT 256	     /* Default size of the generated data (MB) */
+#define BENCH_MAX_THREADS 256	     /* Maximal number of threads */
+
+/* Benchmark input */
+struct bench_input {
+	uint8_t *data;		/* Data to hash */
+	uint64_t size;		/* Data size */
+	uint32_t chunk_size;	/* Chunk size */
+	uint32_t nb_chunks;	/* Number of chunks */
+	uint8_t *leaves;	/* Leaves of the last run */
+};
+
+/*
+ * Get the time of a monotonic clock
+ *
+ * @return: Current time (nanoseconds)
+ */
+static inline uint64_t
+bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Merkle chunk callback - store the leaf of the chunk
+ *
+ * @chunk_idx [in]: chunk index
+ * @digest [in]: chunk digest
+ * @user_ctx [in]: benchmark input
+ */
+static void
+bench_leaf_cb(uint32_t chunk_idx, const uint8_t *digest, void *user_ctx)
+{
+	struct bench_input *input = user_ctx;
+
+	memcpy(input->leaves + (size_t)chunk_idx * MERKLE_DIGEST_SIZE, digest, MERKLE_DIGEST_SIZE);
+}
+
+/*
+ * Hash the input as a Merkle tree with the software backend
+ *
+ * @input [in]: benchmark input
+ * @nb_threads [in]: hash threads, 0 to hash in the caller thread
+ * @nb_slots [in]: chunks hashed at once
+ * @root [out]: tree root
+ * @elapsed_ns [out]: time of the chunks hashing and of the root
+ * @return: 0 on success and -1 otherwise
+ */
+static int
+bench_merkle(struct bench_input *input, uint32_t nb_threads, uint32_t nb_slots, uint8_t *root, uint64_t *elapsed_ns)
+{
+	struct merkle_hasher_cfg cfg = {
+		.backend = MERKLE_SHA_SW,
+		.nb_slots = nb_slots,
+		.nb_threads = nb_threads,
+		.region = input->data,
+		.region_len = input->size,
+		.chunk_cb = bench_leaf_cb,
+		.user_ctx = input,
+	};
+	struct merkle_hasher *hasher;
+	uint64_t start, offset;
+	uint32_t i, len;
+	int ret = -1;
+
+	if (merkle_hasher_create(&cfg, NULL, NULL, &hasher) != DOCA_SUCCESS) {
+		fprintf(stderr, "Failed to create the hasher\n");
+		return -1;
+	}
+	memset(input->leaves, 0, (size_t)input->nb_chunks * MERKLE_DIGEST_SIZE);
+
+	start = bench_now();
+	for (i = 0, offset = 0; i < input->nb_chunks; i++, offset += len) {
+		len = input->size - offset < input->chunk_size ? input->size - offset : input->chunk_size;
+		if (merkle_hasher_wait_slot(hasher, i % nb_slots) != DOCA_SUCCESS ||
+		    merkle_hasher_submit(hasher, i % nb_slots, i, input->data + offset, len) != DOCA_SUCCESS)
+			goto destroy_hasher;
+	}
+	if (merkle_hasher_wait_all(hasher) != DOCA_SUCCESS ||
+	    merkle_root(input->leaves, input->nb_chunks, input->size, input->chunk_size, root) != DOCA_SUCCESS)
+		goto destroy_hasher;
+	*elapsed_ns = bench_now() - start;
+	ret = 0;
+
+destroy_hasher:
+	merkle_hasher_destroy(hasher);
+	if (ret != 0)
+		fprintf(stderr, "Failed to hash the chunks with %u threads\n", nb_threads);
+	return ret;
+}
+
+/*
+ * Run the benchmark of the software SHA256 implementation in use
+ *
+ * @input [in]: benchmark input
+ * @max_threads [in]: largest number of hash threads
+ * @nb_slots [in]: chunks hashed at once
+ * @ref_root [in/out]: root of the first run, set by it, compared by the others
+ * @has_ref [in/out]: set once the first run computed the root
+ * @return: 0 on success and -1 otherwise
+ */
+static int
+bench_impl(struct bench_input *input, uint32_t max_threads, uint32_t nb_slots, uint8_t *ref_root, int *has_ref)
+{
+	uint8_t digest[SHA256_DIGEST_SIZE], root[MERKLE_DIGEST_SIZE];
+	uint64_t start, elapsed_ns, single_ns;
+	uint32_t nb_threads, next_threads;
+
+	start = bench_now();
+	sha256_digest(input->data, input->size, digest);
+	single_ns = bench_now() - start;
+	printf("%-8s single stream:  %8.1f MB/s\n", sha256_impl_name(), input->size * 1000.0 / single_ns);
+
+	/* 0 threads hashes in the caller thread, then 1, 2, 4... threads up to max_threads */
+	for (nb_threads = 0;; nb_threads = next_threads) {
+		if (bench_merkle(input, nb_threads, nb_slots, root, &elapsed_ns) != 0)
+			return -1;
+		printf("%-8s merkle %3u thr: %8.1f MB/s, %.2fx the single stream\n", sha256_impl_name(), nb_threads,
+		       input->size * 1000.0 / elapsed_ns, (double)single_ns / elapsed_ns);
+		if (!*has_ref) {
+			memcpy(ref_root, root, MERKLE_DIGEST_SIZE);
+			*has_ref = 1;
+		} else if (memcmp(ref_root, root, MERKLE_DIGEST_SIZE) != 0) {
+			fprintf(stderr, "Root of %s with %u threads differs from the first run\n", sha256_impl_name(),
+				nb_threads);
+			return -1;
+		}
+		if (nb_threads == max_threads)
+			break;
+		next_threads = nb_threads == 0 ? 1 : nb_threads * 2;
+		if (next_threads > max_threads)
+			next_threads = max_threads;
+	}
+	return 0;
+}
+
+/*
+ * Print the usage of the benchmark
+ *
+ * @prog [in]: Program name
+ */
+static void
+usage(const char *prog)
+{
+	printf("Usage: %s [-f <file>] [-s <MB>] [-c <chunk size>] [-t <threads>] [-n <chunks>]\n"
+	       "  -f, --file        file to hash (default generated data)\n"
+	       "  -s, --size        size of the generated data in MB (default %d)\n"
+	       "  -c, --chunk-size  chunk size in bytes (default %d)\n"
+	       "  -t, --threads     largest number of hash threads (default one per CPU)\n"
+	       "  -n, --sha-tasks   chunks hashed at once (default twice the threads, at least %d)\n",
+	       prog, BENCH_SIZE_DEFAULT, MERKLE_DEFAULT_CHUNK_SIZE, MERKLE_DEFAULT_SHA_TASKS);
+}
+
+int
+main(int argc, char **argv)
+{
+	static const struct option long_options[] = {
+		{"file", required_argument, NULL, 'f'},
+		{"size", required_argument, NULL, 's'},
+		{"chunk-size", required_argument, NULL, 'c'},
+		{"threads", required_argument, NULL, 't'},
+		{"sha-tasks", required_argument, NULL, 'n'},
+		{"help", no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0},
+	};
+	struct bench_input input = {0};
+	const char *file_path = NULL;
+	uint8_t ref_root[MERKLE_DIGEST_SIZE];
+	long long size_mb = BENCH_SIZE_DEFAULT, chunk_size = MERKLE_DEFAULT_CHUNK_SIZE;
+	long nb_threads = sysconf(_SC_NPROCESSORS_ONLN), nb_slots = 0;
+	uint64_t i, rng = 1, nb_chunks;
+	struct stat statbuf;
+	int opt, fd, mapped = 0, has_ref = 0, exit_status = EXIT_FAILURE;
+
+	while ((opt = getopt_long(argc, argv, "f:s:c:t:n:h", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'f':
+			file_path = optarg;
+			break;
+		case 's':
+			size_mb = strtoll(optarg, NULL, 0);
+			break;
+		case 'c':
+			chunk_size = strtoll(optarg, NULL, 0);
+			break;
+		case 't':
+			nb_threads = strtol(optarg, NULL, 0);
+			break;
+		case 'n':
+			nb_slots = strtol(optarg, NULL, 0);
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (nb_slots == 0)
+		nb_slots = 2 * nb_threads > MERKLE_DEFAULT_SHA_TASKS ? 2 * nb_threads : MERKLE_DEFAULT_SHA_TASKS;
+	if (nb_threads <= 0 || nb_threads > BENCH_MAX_THREADS || size_mb <= 0 || chunk_size < MERKLE_MIN_CHUNK_SIZE ||
+	    chunk_size > MERKLE_MAX_CHUNK_SIZE || nb_slots <= 0 || nb_slots > MERKLE_MAX_SHA_TASKS) {
+		fprintf(stderr, "Invalid arguments: at most %d threads and %d chunks at once, chunks of %d to %d bytes\n",
+			BENCH_MAX_THREADS, MERKLE_MAX_SHA_TASKS, MERKLE_MIN_CHUNK_SIZE, MERKLE_MAX_CHUNK_SIZE);
+		return EXIT_FAILURE;
+	}
+
+	if (file_path != NULL) {
+		fd = open(file_path, O_RDONLY);
+		if (fd < 0 || fstat(fd, &statbuf) < 0 || statbuf.st_size == 0) {
+			fprintf(stderr, "Failed to open %s or it is empty\n", file_path);
+			if (fd >= 0)
+				close(fd);
+			return EXIT_FAILURE;
+		}
+		input.size = statbuf.st_size;
+		input.data = mmap(NULL, input.size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+		close(fd);
+		if (input.data == MAP_FAILED) {
+			fprintf(stderr, "Failed to map %s\n", file_path);
+			return EXIT_FAILURE;
+		}
+		mapped = 1;
+	} else {
+		input.size = size_mb << 20;
+		input.data = malloc(input.size);
+		if (input.data == NULL) {
+			fprintf(stderr, "Failed to allocate %lld MB\n", size_mb);
+			return EXIT_FAILURE;
+		}
+		for (i = 0; i < input.size; i++) {
+			/* xorshift64 */
+			rng ^= rng << 13;
+			rng ^= rng >> 7;
+			rng ^= rng << 17;
+			input.data[i] = rng;
+		}
+	}
+
+	nb_chunks = merkle_nb_chunks(input.size, chunk_size);
+	if (nb_chunks > UINT32_MAX) {
+		fprintf(stderr, "Too many chunks, use larger chunks\n");
+		goto free_data;
+	}
+	input.chunk_size = chunk_size;
+	input.nb_chunks = nb_chunks;
+	input.leaves = malloc(nb_chunks * MERKLE_DIGEST_SIZE);
+	if (input.leaves == NULL) {
+		fprintf(stderr, "Failed to allocate the leaves\n");
+		goto free_data;
+	}
+
+	printf("Input:    %" PRIu64 " bytes in %u chunks of %u bytes, %ld chunks at once\n", input.size, input.nb_chunks,
+	       input.chunk_size, nb_slots);
+
+	/* The generic implementation first, then the fastest one if it is another */
+	sha256_select_impl(SHA256_IMPL_GENERIC);
+	if (bench_impl(&input, nb_threads, nb_slots, ref_root, &has_ref) != 0)
+		goto free_leaves;
+	sha256_select_impl(SHA256_IMPL_AUTO);
+	if (strcmp(sha256_impl_name(), "generic") != 0 &&
+	    bench_impl(&input, nb_threads, nb_slots, ref_root, &has_ref) != 0)
+		goto free_leaves;
+
+	printf("Root:     ");
+	for (i = 0; i < MERKLE_DIGEST_SIZE; i++)
+		printf("%02x", ref_root[i]);
+	printf(", identical in all the runs\n");
+	exit_status = EXIT_SUCCESS;
+
+free_leaves:
+	free(input.leaves);
+free_data:
+	if (mapped)
+		munmap(input.data, input.size);
+	else
+		free(input.data);
+	return exit_status;
+}
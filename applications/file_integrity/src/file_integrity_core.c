@@ -14,6 +14,8 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <fts.h>
+#include <limits.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <time.h>
@@ -26,6 +28,7 @@
 #include <utils.h>
 
 #include "file_integrity_core.h"
+#include "file_integrity_manifest.h"
 
 #define MAX_MSG			(512)				/* Maximum number of messages in CC queue */
 #define SLEEP_IN_NANOS		(10 * 1000)			/* Sample the task every 10 microseconds */
@@ -536,6 +539,1319 @@ send_file(struct doca_dev *dev, struct doca_comm_channel_ep_t *ep, struct doca_c
 	return DOCA_SUCCESS;
 }
 
+/*
+ * Send a message with comm channel, retrying while the send queue is full
+ *
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the send operation
+ * @msg [in]: message
+ * @msg_len [in]: message length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+send_msg(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr, const void *msg,
+	 size_t msg_len)
+{
+	struct timespec ts = {
+		.tv_nsec = SLEEP_IN_NANOS,
+	};
+	doca_error_t result;
+
+	while ((result = doca_comm_channel_ep_sendto(ep, msg, msg_len, DOCA_CC_MSG_FLAG_NONE, *peer_addr)) ==
+	       DOCA_ERROR_AGAIN)
+		nanosleep(&ts, &ts);
+	if (result != DOCA_SUCCESS)
+		DOCA_LOG_ERR("Message was not sent: %s", doca_error_get_descr(result));
+	return result;
+}
+
+/*
+ * Receive a message with comm channel
+ *
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the receive operation
+ * @msg [out]: MAX_MSG_SIZE bytes message buffer
+ * @msg_len [out]: message length
+ * @timeout [in]: timeout in seconds, 0 to wait forever
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+recv_msg(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr, void *msg, size_t *msg_len,
+	 int timeout)
+{
+	int counter = 0;
+	int num_of_iterations = (timeout * 1000 * 1000) / (SLEEP_IN_NANOS / 1000);
+	struct timespec ts = {
+		.tv_nsec = SLEEP_IN_NANOS,
+	};
+	doca_error_t result;
+
+	*msg_len = MAX_MSG_SIZE;
+	while ((result = doca_comm_channel_ep_recvfrom(ep, msg, msg_len, DOCA_CC_MSG_FLAG_NONE, peer_addr)) ==
+	       DOCA_ERROR_AGAIN) {
+		*msg_len = MAX_MSG_SIZE;
+		nanosleep(&ts, &ts);
+		counter++;
+		if (counter == num_of_iterations) {
+			DOCA_LOG_ERR("Message was not received at the given timeout");
+			return DOCA_ERROR_TIME_OUT;
+		}
+	}
+	if (result != DOCA_SUCCESS)
+		DOCA_LOG_ERR("Message was not received: %s", doca_error_get_descr(result));
+	return result;
+}
+
+/*
+ * Send an array with comm channel, in as few messages as possible that never split an element
+ *
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the send operation
+ * @array [in]: array
+ * @len [in]: array length in bytes
+ * @elem_size [in]: size of an element of the array
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+send_array(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr, const void *array,
+	   size_t len, size_t elem_size)
+{
+	size_t offset, msg_len, max_msg_len = MAX_MSG_SIZE - MAX_MSG_SIZE % elem_size;
+	doca_error_t result;
+
+	for (offset = 0; offset < len; offset += msg_len) {
+		msg_len = MIN(max_msg_len, len - offset);
+		result = send_msg(ep, peer_addr, (const uint8_t *)array + offset, msg_len);
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Receive an array sent by send_array()
+ *
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the receive operation
+ * @array [out]: array
+ * @len [in]: array length in bytes
+ * @elem_size [in]: size of an element of the array
+ * @timeout [in]: timeout in seconds of every message, 0 to wait forever
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+recv_array(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr, void *array, size_t len,
+	   size_t elem_size, int timeout)
+{
+	char msg[MAX_MSG_SIZE];
+	size_t offset, msg_len;
+	doca_error_t result;
+
+	for (offset = 0; offset < len; offset += msg_len) {
+		result = recv_msg(ep, peer_addr, msg, &msg_len, timeout);
+		if (result != DOCA_SUCCESS)
+			return result;
+		if (msg_len == 0 || msg_len % elem_size != 0 || msg_len > len - offset) {
+			DOCA_LOG_ERR("Received wrong message size %zu", msg_len);
+			return DOCA_ERROR_UNEXPECTED;
+		}
+		memcpy((uint8_t *)array + offset, msg, msg_len);
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Log a digest in hex format
+ *
+ * @what [in]: name of the digest
+ * @digest [in]: MERKLE_DIGEST_SIZE bytes digest
+ */
+static void
+log_digest(const char *what, const uint8_t *digest)
+{
+	char hex[MERKLE_DIGEST_SIZE * 2 + 1];
+	int i;
+
+	for (i = 0; i < MERKLE_DIGEST_SIZE; i++)
+		snprintf(hex + (2 * i), 3, "%02x", digest[i]);
+	DOCA_LOG_INFO("%s is: %s", what, hex);
+}
+
+/*
+ * Get the time of a monotonic clock
+ *
+ * @return: Current time (nanoseconds)
+ */
+static uint64_t
+now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Create the chunk hasher of the Merkle mode
+ *
+ * @cfg [in]: application config struct
+ * @state [in]: application core object struct
+ * @sha_ctx [in]: context of SHA library
+ * @nb_slots [in]: chunks hashed at once
+ * @region [in]: memory of the chunks
+ * @region_len [in]: length of the memory of the chunks
+ * @region_free_cb [in]: releases the memory of the chunks
+ * @chunk_cb [in]: called on every hashed chunk
+ * @user_ctx [in]: context of the callback
+ * @hasher [out]: chunk hasher
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+create_merkle_hasher(struct file_integrity_config *cfg, struct program_core_objects *state, struct doca_sha *sha_ctx,
+		     uint32_t nb_slots, void *region, size_t region_len, doca_mmap_memrange_free_cb_t *region_free_cb,
+		     merkle_chunk_cb chunk_cb, void *user_ctx, struct merkle_hasher **hasher)
+{
+	struct merkle_hasher_cfg hasher_cfg = {
+		.backend = cfg->sha_backend,
+		.nb_slots = nb_slots,
+		.nb_threads = cfg->nb_sw_threads,
+		.region = region,
+		.region_len = region_len,
+		.region_free_cb = region_free_cb,
+		.chunk_cb = chunk_cb,
+		.user_ctx = user_ctx,
+	};
+
+	if (cfg->sha_backend == MERKLE_SHA_SW)
+		DOCA_LOG_INFO("Hashing chunks with software SHA256 (%s) on %u threads", sha256_impl_name(),
+			      cfg->nb_sw_threads);
+	else
+		DOCA_LOG_INFO("Hashing chunks with DOCA SHA, %u tasks in flight", nb_slots);
+	return merkle_hasher_create(&hasher_cfg, state, sha_ctx, hasher);
+}
+
+/*
+ * Merkle chunk callback of the client - store the leaf of the chunk
+ *
+ * @chunk_idx [in]: chunk index
+ * @digest [in]: chunk digest
+ * @user_ctx [in]: leaves
+ */
+static void
+store_leaf_cb(uint32_t chunk_idx, const uint8_t *digest, void *user_ctx)
+{
+	uint8_t *leaves = (uint8_t *)user_ctx;
+
+	memcpy(leaves + (size_t)chunk_idx * MERKLE_DIGEST_SIZE, digest, MERKLE_DIGEST_SIZE);
+}
+
+/* File of a Merkle session */
+struct merkle_file {
+	char *path;		/* File path */
+	const char *rel_path;	/* Path relative to the directory, within path, empty out of a directory */
+	uint64_t size;		/* File size */
+	uint32_t nb_chunks;	/* Number of chunks */
+	uint32_t first_leaf;	/* Index of the first leaf of the file in the leaves of the session */
+};
+
+/* Files of a Merkle session on the client */
+struct merkle_file_list {
+	struct merkle_file *files;	/* Files */
+	uint32_t nb_files;		/* Number of files */
+	uint32_t max_files;		/* Allocated files */
+	uint64_t nb_chunks;		/* Chunks of all the files */
+};
+
+/*
+ * Add a file to the files of a session
+ *
+ * @list [in/out]: files of the session
+ * @path [in]: file path
+ * @rel_offset [in]: offset of the path relative to the directory in path
+ * @size [in]: file size
+ * @chunk_size [in]: chunk size
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+add_session_file(struct merkle_file_list *list, const char *path, size_t rel_offset, uint64_t size,
+		 uint32_t chunk_size)
+{
+	uint64_t nb_chunks = merkle_nb_chunks(size, chunk_size);
+	struct merkle_file *files, *file;
+
+	if (list->nb_chunks + nb_chunks > UINT32_MAX) {
+		DOCA_LOG_ERR("Too many chunks in the session at %s, use larger chunks", path);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (strlen(path + rel_offset) > MAX_MSG_SIZE - sizeof(struct merkle_file_header)) {
+		DOCA_LOG_ERR("Path %s is too long", path);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (list->nb_files == list->max_files) {
+		files = realloc(list->files, (list->max_files * 2 + 16) * sizeof(*files));
+		if (files == NULL) {
+			DOCA_LOG_ERR("Failed to allocate memory");
+			return DOCA_ERROR_NO_MEMORY;
+		}
+		list->files = files;
+		list->max_files = list->max_files * 2 + 16;
+	}
+	file = &list->files[list->nb_files];
+	file->path = strdup(path);
+	if (file->path == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	file->rel_path = file->path + rel_offset;
+	file->size = size;
+	file->nb_chunks = nb_chunks;
+	file->first_leaf = list->nb_chunks;
+	list->nb_chunks += nb_chunks;
+	list->nb_files++;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Compare the names of two directory entries
+ *
+ * @a [in]: first entry
+ * @b [in]: second entry
+ * @return: result of strcmp() on the names
+ */
+static int
+compare_entries(const FTSENT **a, const FTSENT **b)
+{
+	return strcmp((*a)->fts_name, (*b)->fts_name);
+}
+
+/*
+ * List the regular files of a directory tree, in a stable order. Symbolic links and manifests are skipped
+ *
+ * @dir_path [in]: directory path
+ * @chunk_size [in]: chunk size
+ * @list [out]: files of the session
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+list_directory(const char *dir_path, uint32_t chunk_size, struct merkle_file_list *list)
+{
+	char root[MAX_FILE_NAME];
+	char *paths[] = {root, NULL};
+	size_t root_len;
+	FTSENT *entry;
+	FTS *fts;
+	doca_error_t result = DOCA_SUCCESS;
+
+	/* The paths relative to the directory start after its trailing '/' */
+	strlcpy(root, dir_path, sizeof(root));
+	root_len = strlen(root);
+	while (root_len > 1 && root[root_len - 1] == '/')
+		root[--root_len] = '\0';
+
+	fts = fts_open(paths, FTS_PHYSICAL | FTS_NOCHDIR, compare_entries);
+	if (fts == NULL) {
+		DOCA_LOG_ERR("Failed to open directory %s: %s", dir_path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	while (result == DOCA_SUCCESS && (entry = fts_read(fts)) != NULL) {
+		switch (entry->fts_info) {
+		case FTS_F:
+			if (manifest_is_manifest_name(entry->fts_name))
+				break;
+			result = add_session_file(list, entry->fts_path, root_len + 1, entry->fts_statp->st_size,
+						  chunk_size);
+			break;
+		case FTS_DNR:
+		case FTS_ERR:
+		case FTS_NS:
+			DOCA_LOG_ERR("Failed to read %s: %s", entry->fts_path, strerror(entry->fts_errno));
+			result = DOCA_ERROR_IO_FAILED;
+			break;
+		case FTS_SL:
+		case FTS_SLNONE:
+			DOCA_LOG_WARN("Skipping symbolic link %s", entry->fts_path);
+			break;
+		default:
+			break;
+		}
+	}
+	fts_close(fts);
+	return result;
+}
+
+/*
+ * Free the files of a session
+ *
+ * @list [in]: files of the session
+ */
+static void
+free_file_list(struct merkle_file_list *list)
+{
+	uint32_t i;
+
+	for (i = 0; i < list->nb_files; i++)
+		free(list->files[i].path);
+	free(list->files);
+}
+
+/*
+ * Read a whole buffer from a file at an offset
+ *
+ * @fd [in]: file descriptor
+ * @buf [out]: buffer
+ * @len [in]: length to read
+ * @offset [in]: offset in the file
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+read_chunk(int fd, void *buf, size_t len, uint64_t offset)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = pread(fd, buf, len, offset);
+		if (ret <= 0) {
+			DOCA_LOG_ERR("Failed to read the file, it was truncated or can not be read");
+			return DOCA_ERROR_IO_FAILED;
+		}
+		buf = (uint8_t *)buf + ret;
+		len -= ret;
+		offset += ret;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Hash all the chunks of all the files of a session. The chunks of all the files share the same queue of SHA tasks,
+ * so many small files keep as many tasks in flight as a large one
+ *
+ * @app_cfg [in]: application config struct
+ * @state [in]: application core object struct
+ * @sha_ctx [in]: context of SHA library
+ * @list [in]: files of the session
+ * @leaves [out]: leaves of all the files
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+hash_session_files(struct file_integrity_config *app_cfg, struct program_core_objects *state, struct doca_sha *sha_ctx,
+		   struct merkle_file_list *list, uint8_t *leaves)
+{
+	struct merkle_hasher *hasher;
+	struct merkle_file *file;
+	uint8_t *region, *chunk;
+	uint64_t submitted = 0, offset;
+	uint32_t i, j, nb_slots, slot, chunk_len;
+	int fd;
+	doca_error_t result, tmp_result;
+
+	/* Every slot reads its chunk in its own part of the region */
+	nb_slots = MIN(app_cfg->nb_sha_tasks, list->nb_chunks);
+	region = malloc((size_t)nb_slots * app_cfg->chunk_size);
+	if (region == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	result = create_merkle_hasher(app_cfg, state, sha_ctx, nb_slots, region,
+				      (size_t)nb_slots * app_cfg->chunk_size, &free_cb, store_leaf_cb, leaves, &hasher);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	for (i = 0; i < list->nb_files; i++) {
+		file = &list->files[i];
+		/* The chunk of an empty file is empty, it is not worth a task */
+		if (file->size == 0) {
+			sha256_digest(NULL, 0, leaves + (size_t)file->first_leaf * MERKLE_DIGEST_SIZE);
+			continue;
+		}
+		fd = open(file->path, O_RDONLY);
+		if (fd < 0) {
+			DOCA_LOG_ERR("Failed to open %s", file->path);
+			result = DOCA_ERROR_IO_FAILED;
+			goto destroy_hasher;
+		}
+		for (j = 0, offset = 0; j < file->nb_chunks; j++, offset += chunk_len) {
+			chunk_len = MIN(app_cfg->chunk_size, file->size - offset);
+			slot = submitted++ % nb_slots;
+			chunk = region + (size_t)slot * app_cfg->chunk_size;
+			result = merkle_hasher_wait_slot(hasher, slot);
+			if (result == DOCA_SUCCESS)
+				result = read_chunk(fd, chunk, chunk_len, offset);
+			if (result == DOCA_SUCCESS)
+				result = merkle_hasher_submit(hasher, slot, file->first_leaf + j, chunk, chunk_len);
+			if (result != DOCA_SUCCESS) {
+				DOCA_LOG_ERR("Failed to hash %s", file->path);
+				close(fd);
+				goto destroy_hasher;
+			}
+		}
+		close(fd);
+	}
+
+destroy_hasher:
+	tmp_result = merkle_hasher_wait_all(hasher);
+	if (result == DOCA_SUCCESS)
+		result = tmp_result;
+	merkle_hasher_destroy(hasher);
+	return result;
+}
+
+/*
+ * Send a file of a session: its header and leaves, then the chunks the server needs
+ *
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the send operation
+ * @app_cfg [in]: application config struct
+ * @file [in]: file
+ * @leaves [in]: leaves of the file
+ * @incremental [in]: the server tells which chunks it needs
+ * @nb_sent [out]: number of chunks sent
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+send_session_file(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr,
+		  struct file_integrity_config *app_cfg, struct merkle_file *file, const uint8_t *leaves,
+		  bool incremental, uint32_t *nb_sent)
+{
+	char msg[MAX_MSG_SIZE];
+	struct merkle_file_header *header = (struct merkle_file_header *)msg;
+	size_t path_len = strlen(file->rel_path), bitmap_len = (file->nb_chunks + 7) / 8;
+	uint64_t offset, chunk_end;
+	uint8_t *needed;
+	uint32_t i;
+	size_t msg_len;
+	int fd;
+	doca_error_t result;
+
+	header->magic = htonl(MERKLE_FILE_MAGIC);
+	header->nb_chunks = htonl(file->nb_chunks);
+	header->file_size = htobe64(file->size);
+	header->path_len = htons(path_len);
+	memcpy(header->path, file->rel_path, path_len);
+	result = merkle_root(leaves, file->nb_chunks, file->size, app_cfg->chunk_size, header->root);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = send_msg(ep, peer_addr, msg, sizeof(*header) + path_len);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = send_array(ep, peer_addr, leaves, (size_t)file->nb_chunks * MERKLE_DIGEST_SIZE, MERKLE_DIGEST_SIZE);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	/* Without a bitmap the server needs all the chunks */
+	needed = malloc(bitmap_len);
+	if (needed == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	if (incremental)
+		result = recv_array(ep, peer_addr, needed, bitmap_len, 1, 0);
+	else
+		memset(needed, 0xff, bitmap_len);
+	if (result != DOCA_SUCCESS)
+		goto free_needed;
+
+	fd = open(file->path, O_RDONLY);
+	if (fd < 0) {
+		DOCA_LOG_ERR("Failed to open %s", file->path);
+		result = DOCA_ERROR_IO_FAILED;
+		goto free_needed;
+	}
+	*nb_sent = 0;
+	for (i = 0; i < file->nb_chunks; i++) {
+		if (!(needed[i / 8] & (1 << (i % 8))))
+			continue;
+		offset = (uint64_t)i * app_cfg->chunk_size;
+		chunk_end = MIN(offset + app_cfg->chunk_size, file->size);
+		for (; offset < chunk_end; offset += msg_len) {
+			msg_len = MIN(MAX_MSG_SIZE, chunk_end - offset);
+			result = read_chunk(fd, msg, msg_len, offset);
+			if (result == DOCA_SUCCESS)
+				result = send_msg(ep, peer_addr, msg, msg_len);
+			if (result != DOCA_SUCCESS)
+				goto close_fd;
+		}
+		(*nb_sent)++;
+	}
+
+close_fd:
+	close(fd);
+free_needed:
+	free(needed);
+	return result;
+}
+
+/*
+ * Run client logic of a Merkle session: hash all the files at once, then send every file, only the chunks the server
+ * needs in incremental mode
+ *
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the send operation
+ * @app_cfg [in]: application config struct
+ * @state [in]: application core object struct
+ * @sha_ctx [in]: context of SHA library
+ * @directory [in]: the file path is a directory
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+merkle_session_client(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr,
+		      struct file_integrity_config *app_cfg, struct program_core_objects *state,
+		      struct doca_sha *sha_ctx, bool directory)
+{
+	struct merkle_file_list list = {0};
+	struct merkle_session_header header;
+	char msg[MAX_MSG_SIZE] = {0};
+	uint8_t *leaves = NULL;
+	struct stat statbuf;
+	uint64_t start, nb_sent = 0;
+	uint32_t i, nb_file_sent;
+	size_t msg_len;
+	doca_error_t result;
+
+	if (directory)
+		result = list_directory(app_cfg->file_path, app_cfg->chunk_size, &list);
+	else if (stat(app_cfg->file_path, &statbuf) < 0) {
+		DOCA_LOG_ERR("Failed to get information of %s", app_cfg->file_path);
+		result = DOCA_ERROR_IO_FAILED;
+	} else
+		result = add_session_file(&list, app_cfg->file_path, strlen(app_cfg->file_path), statbuf.st_size,
+					  app_cfg->chunk_size);
+	if (result != DOCA_SUCCESS)
+		goto free_list;
+	if (list.nb_files == 0) {
+		DOCA_LOG_ERR("No file to verify in %s", app_cfg->file_path);
+		result = DOCA_ERROR_NOT_FOUND;
+		goto free_list;
+	}
+
+	leaves = calloc(list.nb_chunks, MERKLE_DIGEST_SIZE);
+	if (leaves == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto free_list;
+	}
+	start = now_ns();
+	result = hash_session_files(app_cfg, state, sha_ctx, &list, leaves);
+	if (result != DOCA_SUCCESS)
+		goto free_leaves;
+	DOCA_LOG_INFO("Hashed %u files, %lu chunks of %u bytes in %.3f ms", list.nb_files, list.nb_chunks,
+		      app_cfg->chunk_size, (now_ns() - start) / 1e6);
+
+	header.magic = htonl(MERKLE_SESSION_MAGIC);
+	header.flags = htonl((app_cfg->incremental ? MERKLE_SESSION_INCREMENTAL : 0) |
+			     (directory ? MERKLE_SESSION_DIRECTORY : 0));
+	header.chunk_size = htonl(app_cfg->chunk_size);
+	header.nb_files = htonl(list.nb_files);
+	result = send_msg(ep, peer_addr, &header, sizeof(header));
+	if (result != DOCA_SUCCESS)
+		goto free_leaves;
+	for (i = 0; i < list.nb_files; i++) {
+		result = send_session_file(ep, peer_addr, app_cfg, &list.files[i],
+					   leaves + (size_t)list.files[i].first_leaf * MERKLE_DIGEST_SIZE,
+					   app_cfg->incremental, &nb_file_sent);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to send %s", list.files[i].path);
+			goto free_leaves;
+		}
+		DOCA_LOG_DBG("Sent %u of the %u chunks of %s", nb_file_sent, list.files[i].nb_chunks,
+			     list.files[i].path);
+		nb_sent += nb_file_sent;
+	}
+	DOCA_LOG_INFO("Sent %lu of the %lu chunks of %u files", nb_sent, list.nb_chunks, list.nb_files);
+
+	/* Receive finish message when the files were completely verified by the server */
+	result = recv_msg(ep, peer_addr, msg, &msg_len, 0);
+	if (result != DOCA_SUCCESS)
+		goto free_leaves;
+	msg[MAX_MSG_SIZE - 1] = '\0';
+	DOCA_LOG_INFO("%s", msg);
+
+free_leaves:
+	free(leaves);
+free_list:
+	free_file_list(&list);
+	return result;
+}
+
+/*
+ * Run client logic of the Merkle mode: hash the chunks of the file at once, then send the tree root, the leaves and
+ * the file content so the server verifies every chunk as it is received
+ *
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the send operation
+ * @app_cfg [in]: application config struct
+ * @state [in]: application core object struct
+ * @sha_ctx [in]: context of SHA library
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+merkle_client(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr,
+	      struct file_integrity_config *app_cfg, struct program_core_objects *state, struct doca_sha *sha_ctx)
+{
+	struct merkle_hasher *hasher = NULL;
+	struct merkle_header header;
+	char msg[MAX_MSG_SIZE] = {0};
+	uint8_t *leaves = NULL;
+	char *file_data;
+	struct stat statbuf;
+	uint64_t nb_chunks, file_size, offset, start;
+	uint32_t i, nb_slots, chunk_len;
+	size_t msg_len;
+	int fd;
+	doca_error_t result, tmp_result;
+
+	/* Incremental and directory modes run a session of files */
+	if (stat(app_cfg->file_path, &statbuf) == 0 && S_ISDIR(statbuf.st_mode))
+		return merkle_session_client(ep, peer_addr, app_cfg, state, sha_ctx, true);
+	if (app_cfg->incremental)
+		return merkle_session_client(ep, peer_addr, app_cfg, state, sha_ctx, false);
+
+	fd = open(app_cfg->file_path, O_RDWR);
+	if (fd < 0) {
+		DOCA_LOG_ERR("Failed to open %s", app_cfg->file_path);
+		return DOCA_ERROR_IO_FAILED;
+	}
+	if (fstat(fd, &statbuf) < 0) {
+		DOCA_LOG_ERR("Failed to get file information");
+		close(fd);
+		return DOCA_ERROR_IO_FAILED;
+	}
+	file_size = statbuf.st_size;
+	nb_chunks = merkle_nb_chunks(file_size, app_cfg->chunk_size);
+	if (file_size == 0 || nb_chunks > UINT32_MAX) {
+		DOCA_LOG_ERR("Invalid file size. Should be greater then zero and have less than %u chunks", UINT32_MAX);
+		close(fd);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	file_data = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (file_data == MAP_FAILED) {
+		DOCA_LOG_ERR("Unable to map file content: %s", strerror(errno));
+		close(fd);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	close(fd);
+
+	leaves = calloc(nb_chunks, MERKLE_DIGEST_SIZE);
+	if (leaves == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		munmap(file_data, file_size);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	/* The file mapping is released by the hasher or by the source mmap */
+	nb_slots = MIN(app_cfg->nb_sha_tasks, nb_chunks);
+	result = create_merkle_hasher(app_cfg, state, sha_ctx, nb_slots, file_data, file_size, &unmap_cb,
+				      store_leaf_cb, leaves, &hasher);
+	if (result != DOCA_SUCCESS) {
+		free(leaves);
+		return result;
+	}
+
+	/* Hash all the chunks, up to nb_slots at once */
+	start = now_ns();
+	for (i = 0, offset = 0; i < nb_chunks; i++, offset += chunk_len) {
+		chunk_len = MIN(app_cfg->chunk_size, file_size - offset);
+		result = merkle_hasher_wait_slot(hasher, i % nb_slots);
+		if (result != DOCA_SUCCESS)
+			goto destroy_hasher;
+		result = merkle_hasher_submit(hasher, i % nb_slots, i, file_data + offset, chunk_len);
+		if (result != DOCA_SUCCESS)
+			goto destroy_hasher;
+	}
+	result = merkle_hasher_wait_all(hasher);
+	if (result != DOCA_SUCCESS)
+		goto destroy_hasher;
+	DOCA_LOG_INFO("Hashed %lu chunks of %u bytes in %.3f ms", nb_chunks, app_cfg->chunk_size,
+		      (now_ns() - start) / 1e6);
+
+	header.magic = htonl(MERKLE_HEADER_MAGIC);
+	header.chunk_size = htonl(app_cfg->chunk_size);
+	header.file_size = htobe64(file_size);
+	header.nb_chunks = htonl(nb_chunks);
+	result = merkle_root(leaves, nb_chunks, file_size, app_cfg->chunk_size, header.root);
+	if (result != DOCA_SUCCESS)
+		goto destroy_hasher;
+	log_digest("Merkle root", header.root);
+
+	/* Send the root, then the leaves, then the file, a message never crosses a chunk boundary */
+	result = send_msg(ep, peer_addr, &header, sizeof(header));
+	if (result != DOCA_SUCCESS)
+		goto destroy_hasher;
+	result = send_array(ep, peer_addr, leaves, nb_chunks * MERKLE_DIGEST_SIZE, MERKLE_DIGEST_SIZE);
+	if (result != DOCA_SUCCESS)
+		goto destroy_hasher;
+	for (offset = 0; offset < file_size; offset += msg_len) {
+		chunk_len = app_cfg->chunk_size - offset % app_cfg->chunk_size;
+		msg_len = MIN(MIN(MAX_MSG_SIZE, chunk_len), file_size - offset);
+		result = send_msg(ep, peer_addr, file_data + offset, msg_len);
+		if (result != DOCA_SUCCESS)
+			goto destroy_hasher;
+	}
+
+	/* Receive finish message when file was completely read by the server */
+	result = recv_msg(ep, peer_addr, msg, &msg_len, 0);
+	if (result != DOCA_SUCCESS)
+		goto destroy_hasher;
+	msg[MAX_MSG_SIZE - 1] = '\0';
+	DOCA_LOG_INFO("%s", msg);
+
+destroy_hasher:
+	tmp_result = merkle_hasher_wait_all(hasher);
+	if (result == DOCA_SUCCESS)
+		result = tmp_result;
+	merkle_hasher_destroy(hasher);
+	free(leaves);
+	return result;
+}
+
+/* Verification state of the server in Merkle mode */
+struct merkle_verify {
+	const uint8_t *leaves;		/* Leaves received from the client */
+	uint32_t nb_verified;		/* Chunks identical to their leaf */
+	bool compromised;		/* A chunk is not identical to its leaf */
+};
+
+/*
+ * Merkle chunk callback of the server - compare the chunk digest with its leaf
+ *
+ * @chunk_idx [in]: chunk index
+ * @digest [in]: chunk digest
+ * @user_ctx [in]: verification state
+ */
+static void
+verify_leaf_cb(uint32_t chunk_idx, const uint8_t *digest, void *user_ctx)
+{
+	struct merkle_verify *verify = (struct merkle_verify *)user_ctx;
+
+	if (memcmp(digest, verify->leaves + (size_t)chunk_idx * MERKLE_DIGEST_SIZE, MERKLE_DIGEST_SIZE) == 0) {
+		verify->nb_verified++;
+		return;
+	}
+	if (!verify->compromised)
+		DOCA_LOG_ERR("ERROR: SHA of chunk %u is not identical to its leaf, file was compromised", chunk_idx);
+	verify->compromised = true;
+}
+
+/* Verification counters of a Merkle session on the server */
+struct merkle_session_stats {
+	uint32_t nb_updated;		/* Files verified, with chunks received */
+	uint32_t nb_up_to_date;		/* Files identical to their manifest, no chunk received */
+	uint32_t nb_compromised;	/* Files compromised, removed */
+	uint64_t nb_chunks;		/* Chunks of all the files */
+	uint64_t nb_received;		/* Chunks received */
+};
+
+/*
+ * Check that a path received from the client stays within the directory: relative, without "." or ".." components
+ * and not a manifest
+ *
+ * @path [in]: path relative to the directory
+ * @return: true if the path is valid
+ */
+static bool
+is_valid_session_path(const char *path)
+{
+	const char *component = path, *end;
+	size_t len;
+
+	if (path[0] == '\0' || path[0] == '/')
+		return false;
+	for (;;) {
+		end = strchr(component, '/');
+		len = end == NULL ? strlen(component) : (size_t)(end - component);
+		if (len == 0 || (len == 1 && component[0] == '.') ||
+		    (len == 2 && component[0] == '.' && component[1] == '.'))
+			return false;
+		if (end == NULL)
+			return !manifest_is_manifest_name(component);
+		component = end + 1;
+	}
+}
+
+/*
+ * Create the missing parent directories of a file
+ *
+ * @path [in]: file path
+ * @root_len [in]: length of the part of the path that already exists
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+create_parent_dirs(char *path, size_t root_len)
+{
+	char *sep;
+
+	for (sep = strchr(path + root_len + 1, '/'); sep != NULL; sep = strchr(sep + 1, '/')) {
+		*sep = '\0';
+		if (mkdir(path, S_IRWXU | S_IRGRP | S_IXGRP) < 0 && errno != EEXIST) {
+			DOCA_LOG_ERR("Failed to create directory %s: %s", path, strerror(errno));
+			*sep = '/';
+			return DOCA_ERROR_IO_FAILED;
+		}
+		*sep = '/';
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Receive and verify a file of a session. In incremental mode the chunks whose leaf is identical to the manifest of
+ * the file are neither received nor hashed
+ *
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the receive operation
+ * @app_cfg [in]: application config struct
+ * @hasher [in]: chunk hasher, with a slot per chunk_size bytes of region
+ * @nb_slots [in]: number of slots of the hasher
+ * @region [in]: memory of the chunks
+ * @verify [in]: verification state of the hasher callback
+ * @flags [in]: MERKLE_SESSION_* flags
+ * @chunk_size [in]: chunk size
+ * @stats [in/out]: verification counters
+ * @return: DOCA_SUCCESS on success, even if the file was compromised, and DOCA_ERROR otherwise
+ */
+static doca_error_t
+recv_session_file(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr,
+		  struct file_integrity_config *app_cfg, struct merkle_hasher *hasher, uint32_t nb_slots,
+		  uint8_t *region, struct merkle_verify *verify, uint32_t flags, uint32_t chunk_size,
+		  struct merkle_session_stats *stats)
+{
+	char received_msg[MAX_MSG_SIZE];
+	struct merkle_file_header *header = (struct merkle_file_header *)received_msg;
+	struct file_manifest *manifest = NULL;
+	char path[PATH_MAX];
+	uint8_t root[MERKLE_DIGEST_SIZE], digest[MERKLE_DIGEST_SIZE];
+	uint8_t *leaves = NULL, *needed = NULL, *chunk;
+	uint64_t file_size, offset, nb_chunks;
+	uint32_t i, nb_needed = 0, nb_submitted = 0, slot, chunk_len, chunk_offset;
+	size_t msg_len, path_len, bitmap_len, root_len;
+	int fd = -1;
+	doca_error_t result, tmp_result;
+
+	result = recv_msg(ep, peer_addr, received_msg, &msg_len, app_cfg->timeout);
+	if (result != DOCA_SUCCESS)
+		return result;
+	if (msg_len < sizeof(*header) || ntohl(header->magic) != MERKLE_FILE_MAGIC) {
+		DOCA_LOG_ERR("Received wrong file header");
+		return DOCA_ERROR_UNEXPECTED;
+	}
+	file_size = be64toh(header->file_size);
+	nb_chunks = ntohl(header->nb_chunks);
+	path_len = ntohs(header->path_len);
+	if (nb_chunks != merkle_nb_chunks(file_size, chunk_size) || path_len != msg_len - sizeof(*header) ||
+	    memchr(header->path, '\0', path_len) != NULL) {
+		DOCA_LOG_ERR("Received wrong file header: file of %lu bytes in %lu chunks", file_size, nb_chunks);
+		return DOCA_ERROR_UNEXPECTED;
+	}
+
+	/* The files of a directory are relative to the directory of the server */
+	if (flags & MERKLE_SESSION_DIRECTORY) {
+		root_len = strlen(app_cfg->file_path);
+		if (root_len + 1 + path_len >= sizeof(path)) {
+			DOCA_LOG_ERR("Received path is too long");
+			return DOCA_ERROR_UNEXPECTED;
+		}
+		snprintf(path, sizeof(path), "%s/%.*s", app_cfg->file_path, (int)path_len, header->path);
+		if (!is_valid_session_path(path + root_len + 1)) {
+			DOCA_LOG_ERR("Received path %s is out of the directory", path + root_len + 1);
+			return DOCA_ERROR_UNEXPECTED;
+		}
+		result = create_parent_dirs(path, root_len);
+		if (result != DOCA_SUCCESS)
+			return result;
+	} else if (path_len != 0) {
+		DOCA_LOG_ERR("Received a path out of directory mode");
+		return DOCA_ERROR_UNEXPECTED;
+	} else
+		strlcpy(path, app_cfg->file_path, sizeof(path));
+
+	leaves = malloc(nb_chunks * MERKLE_DIGEST_SIZE);
+	bitmap_len = (nb_chunks + 7) / 8;
+	needed = calloc(bitmap_len, 1);
+	if (leaves == NULL || needed == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto free_leaves;
+	}
+	result = recv_array(ep, peer_addr, leaves, nb_chunks * MERKLE_DIGEST_SIZE, MERKLE_DIGEST_SIZE,
+			    app_cfg->timeout);
+	if (result != DOCA_SUCCESS)
+		goto free_leaves;
+	result = merkle_root(leaves, nb_chunks, file_size, chunk_size, root);
+	if (result != DOCA_SUCCESS)
+		goto free_leaves;
+	verify->leaves = leaves;
+	verify->nb_verified = 0;
+	verify->compromised = memcmp(root, header->root, MERKLE_DIGEST_SIZE) != 0;
+	if (verify->compromised)
+		DOCA_LOG_ERR("ERROR: Merkle leaves of %s are not identical to the root, file was compromised", path);
+
+	/* A chunk is needed unless the manifest proves the server copy already holds it */
+	if ((flags & MERKLE_SESSION_INCREMENTAL) && !verify->compromised) {
+		result = manifest_load(path, chunk_size, &manifest);
+		if (result != DOCA_SUCCESS && result != DOCA_ERROR_NOT_FOUND)
+			DOCA_LOG_WARN("Failed to load the manifest of %s, receiving the whole file", path);
+	}
+	for (i = 0; i < nb_chunks && !verify->compromised; i++) {
+		if (manifest != NULL && i < manifest->nb_chunks &&
+		    memcmp(leaves + (size_t)i * MERKLE_DIGEST_SIZE, manifest->leaves + (size_t)i * MERKLE_DIGEST_SIZE,
+			   MERKLE_DIGEST_SIZE) == 0)
+			continue;
+		needed[i / 8] |= 1 << (i % 8);
+		nb_needed++;
+	}
+	if (flags & MERKLE_SESSION_INCREMENTAL) {
+		result = send_array(ep, peer_addr, needed, bitmap_len, 1);
+		if (result != DOCA_SUCCESS)
+			goto free_leaves;
+	} else
+		memset(needed, 0xff, bitmap_len);
+	stats->nb_chunks += nb_chunks;
+
+	if (manifest != NULL && nb_needed == 0 && manifest->file_size == file_size) {
+		DOCA_LOG_INFO("%s is up to date", path);
+		stats->nb_up_to_date++;
+		goto free_leaves;
+	}
+
+	/* The unchanged chunks of an up to date manifest are kept in place */
+	if (!verify->compromised) {
+		fd = open(path, O_CREAT | O_WRONLY | (manifest != NULL ? 0 : O_TRUNC), S_IRUSR | S_IWUSR | S_IRGRP);
+		if (fd < 0) {
+			DOCA_LOG_ERR("Failed to open %s", path);
+			result = DOCA_ERROR_IO_FAILED;
+			goto free_leaves;
+		}
+	}
+
+	/* Receive the needed chunks and hash every chunk once it is complete */
+	for (i = 0; i < nb_chunks; i++) {
+		if (!(needed[i / 8] & (1 << (i % 8))))
+			continue;
+		offset = (uint64_t)i * chunk_size;
+		chunk_len = MIN(chunk_size, file_size - offset);
+		slot = nb_submitted % nb_slots;
+		chunk = region + (size_t)slot * chunk_size;
+		result = merkle_hasher_wait_slot(hasher, slot);
+		if (result != DOCA_SUCCESS)
+			goto close_fd;
+		for (chunk_offset = 0; chunk_offset < chunk_len; chunk_offset += msg_len) {
+			result = recv_msg(ep, peer_addr, received_msg, &msg_len, app_cfg->timeout);
+			if (result != DOCA_SUCCESS)
+				goto close_fd;
+			if (msg_len == 0 || msg_len > chunk_len - chunk_offset) {
+				DOCA_LOG_ERR("Received message of %zu bytes crossing the end of chunk %u", msg_len, i);
+				result = DOCA_ERROR_UNEXPECTED;
+				goto close_fd;
+			}
+			if (!verify->compromised)
+				memcpy(chunk + chunk_offset, received_msg, msg_len);
+		}
+		stats->nb_received++;
+		if (verify->compromised)
+			continue;
+		if (pwrite(fd, chunk, chunk_len, offset) != (ssize_t)chunk_len) {
+			DOCA_LOG_ERR("Failed to write chunk %u of %s", i, path);
+			result = DOCA_ERROR_IO_FAILED;
+			goto close_fd;
+		}
+		/* The chunk of an empty file is empty, it is not worth a task */
+		if (chunk_len == 0) {
+			sha256_digest(NULL, 0, digest);
+			verify_leaf_cb(i, digest, verify);
+			continue;
+		}
+		result = merkle_hasher_submit(hasher, slot, i, chunk, chunk_len);
+		nb_submitted++;
+		if (result != DOCA_SUCCESS)
+			goto close_fd;
+	}
+	result = merkle_hasher_wait_all(hasher);
+	if (result != DOCA_SUCCESS)
+		goto close_fd;
+
+	if (!verify->compromised && ftruncate(fd, file_size) < 0) {
+		DOCA_LOG_ERR("Failed to truncate %s", path);
+		result = DOCA_ERROR_IO_FAILED;
+		goto close_fd;
+	}
+	if (verify->compromised) {
+		stats->nb_compromised++;
+	} else {
+		DOCA_LOG_INFO("SUCCESS: %s is identical to the received Merkle root, %u chunks received", path,
+			      verify->nb_verified);
+		stats->nb_updated++;
+		/* The header was overwritten by the chunks, the root is the computed one */
+		if (flags & MERKLE_SESSION_INCREMENTAL) {
+			result = manifest_store(path, fd, chunk_size, nb_chunks, root, leaves);
+			if (result != DOCA_SUCCESS)
+				goto close_fd;
+		}
+	}
+
+close_fd:
+	/* The chunks in flight use the leaves of the file */
+	tmp_result = merkle_hasher_wait_all(hasher);
+	if (result == DOCA_SUCCESS)
+		result = tmp_result;
+	if (fd >= 0)
+		close(fd);
+	if (verify->compromised || result != DOCA_SUCCESS) {
+		if (remove(path) < 0 && errno != ENOENT)
+			DOCA_LOG_ERR("Failed to remove %s", path);
+		manifest_remove(path);
+	}
+free_leaves:
+	verify->leaves = NULL;
+	free(manifest);
+	free(needed);
+	free(leaves);
+	return result;
+}
+
+/*
+ * Run server logic of a Merkle session: receive and verify every file of the client, in incremental mode only the
+ * chunks that changed since the manifest of the file was stored
+ *
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the send operation
+ * @app_cfg [in]: application config struct
+ * @state [in]: application core object struct
+ * @sha_ctx [in]: context of SHA library
+ * @header [in]: session header received from the client
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+merkle_session_server(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr,
+		      struct file_integrity_config *app_cfg, struct program_core_objects *state,
+		      struct doca_sha *sha_ctx, const struct merkle_session_header *header)
+{
+	struct merkle_session_stats stats = {0};
+	struct merkle_verify verify = {0};
+	struct merkle_hasher *hasher = NULL;
+	char finish_msg[MAX_MSG_SIZE];
+	uint32_t i, flags, chunk_size, nb_files, nb_slots;
+	uint64_t start;
+	uint8_t *region;
+	doca_error_t result, tmp_result;
+
+	flags = ntohl(header->flags);
+	chunk_size = ntohl(header->chunk_size);
+	nb_files = ntohl(header->nb_files);
+	if ((flags & ~(MERKLE_SESSION_INCREMENTAL | MERKLE_SESSION_DIRECTORY)) != 0 ||
+	    chunk_size < MERKLE_MIN_CHUNK_SIZE || chunk_size > MERKLE_MAX_CHUNK_SIZE || nb_files == 0 ||
+	    (!(flags & MERKLE_SESSION_DIRECTORY) && nb_files != 1)) {
+		DOCA_LOG_ERR("Received wrong session header: %u files in chunks of %u bytes, flags 0x%x", nb_files,
+			     chunk_size, flags);
+		result = DOCA_ERROR_UNEXPECTED;
+		goto finish_msg;
+	}
+	DOCA_LOG_INFO("Receiving %u files in chunks of %u bytes%s", nb_files, chunk_size,
+		      (flags & MERKLE_SESSION_INCREMENTAL) ? ", only the changed chunks" : "");
+	if ((flags & MERKLE_SESSION_DIRECTORY) && mkdir(app_cfg->file_path, S_IRWXU | S_IRGRP | S_IXGRP) < 0 &&
+	    errno != EEXIST) {
+		DOCA_LOG_ERR("Failed to create directory %s: %s", app_cfg->file_path, strerror(errno));
+		result = DOCA_ERROR_IO_FAILED;
+		goto finish_msg;
+	}
+
+	/* The slots are shared by all the files, so small files keep as many chunks in flight as a large one */
+	nb_slots = app_cfg->nb_sha_tasks;
+	region = malloc((size_t)nb_slots * chunk_size);
+	if (region == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto finish_msg;
+	}
+	result = create_merkle_hasher(app_cfg, state, sha_ctx, nb_slots, region, (size_t)nb_slots * chunk_size,
+				      &free_cb, verify_leaf_cb, &verify, &hasher);
+	if (result != DOCA_SUCCESS)
+		goto finish_msg;
+
+	start = now_ns();
+	for (i = 0; i < nb_files; i++) {
+		result = recv_session_file(ep, peer_addr, app_cfg, hasher, nb_slots, region, &verify, flags,
+					   chunk_size, &stats);
+		if (result != DOCA_SUCCESS)
+			goto destroy_hasher;
+	}
+	DOCA_LOG_INFO("Received and hashed %lu of %lu chunks in %.3f ms", stats.nb_received, stats.nb_chunks,
+		      (now_ns() - start) / 1e6);
+
+destroy_hasher:
+	tmp_result = merkle_hasher_wait_all(hasher);
+	if (result == DOCA_SUCCESS)
+		result = tmp_result;
+	merkle_hasher_destroy(hasher);
+finish_msg:
+	/* Send the summary of the session to the client */
+	snprintf(finish_msg, sizeof(finish_msg),
+		 "Server verified %u files: %u updated, %u up to date, %u compromised, received %lu of %lu chunks",
+		 stats.nb_updated + stats.nb_up_to_date + stats.nb_compromised, stats.nb_updated,
+		 stats.nb_up_to_date, stats.nb_compromised, stats.nb_received, stats.nb_chunks);
+	DOCA_LOG_INFO("%s", finish_msg);
+	tmp_result = send_msg(ep, peer_addr, finish_msg, strlen(finish_msg) + 1);
+	if (result == DOCA_SUCCESS)
+		result = tmp_result;
+	return result;
+}
+
+/*
+ * Run server logic of the Merkle mode: receive the tree root and the leaves, then verify every chunk as soon as it is
+ * received. Once a chunk is compromised the rest of the file is received but neither written nor hashed
+ *
+ * @ep [in]: handle for comm channel local endpoint
+ * @peer_addr [in]: destination address handle of the send operation
+ * @app_cfg [in]: application config struct
+ * @state [in]: application core object struct
+ * @sha_ctx [in]: context of SHA library
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+merkle_server(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr,
+	      struct file_integrity_config *app_cfg, struct program_core_objects *state, struct doca_sha *sha_ctx)
+{
+	struct merkle_verify verify = {0};
+	struct merkle_hasher *hasher = NULL;
+	struct merkle_session_header session_header;
+	struct merkle_header header;
+	char received_msg[MAX_MSG_SIZE];
+	char finish_msg[] = "Server was done receiving messages";
+	uint8_t root[MERKLE_DIGEST_SIZE];
+	uint8_t *leaves = NULL, *region, *chunk;
+	uint64_t nb_chunks = 0, file_size, offset, start;
+	uint32_t i, nb_slots, chunk_size, chunk_len, chunk_offset;
+	size_t msg_len, leaves_len;
+	int fd = -1;
+	doca_error_t result, tmp_result;
+
+	/* Receive the tree root from the client */
+	result = recv_msg(ep, peer_addr, received_msg, &msg_len, 0);
+	if (result != DOCA_SUCCESS)
+		goto finish_msg;
+	memcpy(&header, received_msg, MIN(msg_len, sizeof(header)));
+	if (msg_len == sizeof(session_header) && ntohl(header.magic) == MERKLE_SESSION_MAGIC) {
+		memcpy(&session_header, received_msg, sizeof(session_header));
+		return merkle_session_server(ep, peer_addr, app_cfg, state, sha_ctx, &session_header);
+	}
+	if (msg_len != sizeof(header) || ntohl(header.magic) != MERKLE_HEADER_MAGIC) {
+		DOCA_LOG_ERR("Received wrong Merkle header, the client must run in Merkle mode as well");
+		result = DOCA_ERROR_UNEXPECTED;
+		goto finish_msg;
+	}
+	chunk_size = ntohl(header.chunk_size);
+	file_size = be64toh(header.file_size);
+	nb_chunks = ntohl(header.nb_chunks);
+	if (chunk_size < MERKLE_MIN_CHUNK_SIZE || chunk_size > MERKLE_MAX_CHUNK_SIZE || file_size == 0 ||
+	    nb_chunks != merkle_nb_chunks(file_size, chunk_size)) {
+		DOCA_LOG_ERR("Received wrong Merkle header: file of %lu bytes in %lu chunks of %u bytes", file_size,
+			     nb_chunks, chunk_size);
+		result = DOCA_ERROR_UNEXPECTED;
+		goto finish_msg;
+	}
+	if (chunk_size != app_cfg->chunk_size)
+		DOCA_LOG_INFO("Using the chunk size of the client: %u bytes", chunk_size);
+
+	/* Receive the leaves and check them against the root */
+	leaves_len = nb_chunks * MERKLE_DIGEST_SIZE;
+	leaves = malloc(leaves_len);
+	if (leaves == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto finish_msg;
+	}
+	result = recv_array(ep, peer_addr, leaves, leaves_len, MERKLE_DIGEST_SIZE, app_cfg->timeout);
+	if (result != DOCA_SUCCESS)
+		goto free_leaves;
+	result = merkle_root(leaves, nb_chunks, file_size, chunk_size, root);
+	if (result != DOCA_SUCCESS)
+		goto free_leaves;
+	log_digest("Merkle root", header.root);
+	if (memcmp(root, header.root, MERKLE_DIGEST_SIZE) != 0) {
+		DOCA_LOG_ERR("ERROR: Merkle leaves are not identical to the root, file was compromised");
+		verify.compromised = true;
+	}
+	verify.leaves = leaves;
+
+	fd = open(app_cfg->file_path, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IRGRP);
+	if (fd < 0) {
+		DOCA_LOG_ERR("Failed to open %s", app_cfg->file_path);
+		result = DOCA_ERROR_IO_FAILED;
+		goto free_leaves;
+	}
+
+	/* Every slot receives its chunk in its own part of the region */
+	nb_slots = MIN(app_cfg->nb_sha_tasks, nb_chunks);
+	region = malloc((size_t)nb_slots * chunk_size);
+	if (region == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto close_fd;
+	}
+	result = create_merkle_hasher(app_cfg, state, sha_ctx, nb_slots, region, (size_t)nb_slots * chunk_size,
+				      &free_cb, verify_leaf_cb, &verify, &hasher);
+	if (result != DOCA_SUCCESS)
+		goto close_fd;
+
+	/* Receive the file and hash every chunk once it is complete */
+	start = now_ns();
+	for (i = 0, offset = 0; i < nb_chunks; i++, offset += chunk_len) {
+		chunk_len = MIN(chunk_size, file_size - offset);
+		result = merkle_hasher_wait_slot(hasher, i % nb_slots);
+		if (result != DOCA_SUCCESS)
+			goto destroy_hasher;
+		chunk = region + (size_t)(i % nb_slots) * chunk_size;
+		for (chunk_offset = 0; chunk_offset < chunk_len; chunk_offset += msg_len) {
+			result = recv_msg(ep, peer_addr, received_msg, &msg_len, app_cfg->timeout);
+			if (result != DOCA_SUCCESS)
+				goto destroy_hasher;
+			if (msg_len == 0 || msg_len > chunk_len - chunk_offset) {
+				DOCA_LOG_ERR("Received message of %zu bytes crossing the end of chunk %u", msg_len, i);
+				result = DOCA_ERROR_UNEXPECTED;
+				goto destroy_hasher;
+			}
+			DOCA_LOG_TRC("Received %zu bytes of chunk %u", msg_len, i);
+			if (verify.compromised)
+				continue;
+			memcpy(chunk + chunk_offset, received_msg, msg_len);
+			if ((size_t)write(fd, received_msg, msg_len) != msg_len) {
+				DOCA_LOG_ERR("Failed to write the received message into the input file");
+				result = DOCA_ERROR_IO_FAILED;
+				goto destroy_hasher;
+			}
+		}
+		if (verify.compromised)
+			continue;
+		result = merkle_hasher_submit(hasher, i % nb_slots, i, chunk, chunk_len);
+		if (result != DOCA_SUCCESS)
+			goto destroy_hasher;
+	}
+	result = merkle_hasher_wait_all(hasher);
+	if (result != DOCA_SUCCESS)
+		goto destroy_hasher;
+	DOCA_LOG_INFO("Received and hashed %lu chunks in %.3f ms", nb_chunks, (now_ns() - start) / 1e6);
+
+	if (!verify.compromised && verify.nb_verified == nb_chunks)
+		DOCA_LOG_INFO("SUCCESS: the %lu chunks of the file are identical to the received Merkle root",
+			      nb_chunks);
+	else if (remove(app_cfg->file_path) < 0)
+		DOCA_LOG_ERR("Failed to remove %s", app_cfg->file_path);
+
+destroy_hasher:
+	tmp_result = merkle_hasher_wait_all(hasher);
+	if (result == DOCA_SUCCESS)
+		result = tmp_result;
+	merkle_hasher_destroy(hasher);
+close_fd:
+	close(fd);
+free_leaves:
+	free(leaves);
+finish_msg:
+	/* Send finish message to the client */
+	tmp_result = send_msg(ep, peer_addr, finish_msg, sizeof(finish_msg));
+	if (result == DOCA_SUCCESS)
+		result = tmp_result;
+	return result;
+}
+
 doca_error_t
 file_integrity_client(struct doca_comm_channel_ep_t *ep, struct doca_comm_channel_addr_t **peer_addr,
 		      struct file_integrity_config *app_cfg, struct program_core_objects *state, struct doca_sha *sha_ctx)
@@ -553,6 +1869,9 @@ file_integrity_client(struct doca_comm_channel_ep_t *ep, struct doca_comm_channe
 	uint64_t max_source_buffer_size;
 	doca_error_t result;
 
+	if (app_cfg->merkle)
+		return merkle_client(ep, peer_addr, app_cfg, state, sha_ctx);
+
 	fd = open(app_cfg->file_path, O_RDWR);
 	if (fd < 0) {
 		DOCA_LOG_ERR("Failed to open %s", app_cfg->file_path);
@@ -685,6 +2004,9 @@ file_integrity_server(struct doca_comm_channel_ep_t *ep, struct doca_comm_channe
 	};
 	doca_error_t result, tmp_result;
 
+	if (app_cfg->merkle)
+		return merkle_server(ep, peer_addr, app_cfg, state, sha_ctx);
+
 	/* Get size of SHA output */
 	result = doca_sha_cap_get_min_dst_buffer_size(doca_dev_as_devinfo(state->dev), SHA_ALGORITHM, &received_sha_msg_size);
 	if (result != DOCA_SUCCESS) {
@@ -948,15 +2270,113 @@ sha_partial_hash_error_callback(struct doca_sha_task_partial_hash *sha_partial_h
 }
 
 /*
- * Check if given device is capable of executing a SHA partial hash task.
+ * Check if given device is capable of executing a SHA partial hash task.
+ *
+ * @devinfo [in]: The DOCA device information
+ * @return: DOCA_SUCCESS if the device supports SHA hash task and DOCA_ERROR otherwise.
+ */
+static doca_error_t
+sha_partial_hash_is_supported(struct doca_devinfo *devinfo)
+{
+	return doca_sha_cap_task_partial_hash_get_supported(devinfo, SHA_ALGORITHM);
+}
+
+/*
+ * Check if given device is capable of executing a SHA hash task.
  *
  * @devinfo [in]: The DOCA device information
  * @return: DOCA_SUCCESS if the device supports SHA hash task and DOCA_ERROR otherwise.
  */
 static doca_error_t
-sha_partial_hash_is_supported(struct doca_devinfo *devinfo)
+sha_hash_is_supported(struct doca_devinfo *devinfo)
 {
-	return doca_sha_cap_task_partial_hash_get_supported(devinfo, SHA_ALGORITHM);
+	return doca_sha_cap_task_hash_get_supported(devinfo, SHA_ALGORITHM);
+}
+
+/*
+ * Open the SHA device and create the SHA context with its core objects and tasks configuration
+ *
+ * @app_cfg [in]: application config struct
+ * @state [out]: application core object struct
+ * @sha_ctx [out]: context of SHA library
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+init_sha(struct file_integrity_config *app_cfg, struct program_core_objects *state, struct doca_sha **sha_ctx)
+{
+	uint32_t max_bufs = 2;    /* The app will use 2 doca buffers */
+	doca_error_t result;
+
+	/* Merkle mode hashes whole chunks, the classic mode needs partial SHA tasks */
+	if (app_cfg->merkle) {
+		result = open_doca_device_with_capabilities(&sha_hash_is_supported, &state->dev);
+		/* Every task in flight has a source and a destination buffer */
+		max_bufs = 2 * app_cfg->nb_sha_tasks;
+	} else
+		result = open_doca_device_with_capabilities(&sha_partial_hash_is_supported, &state->dev);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to init DOCA device with SHA capabilities: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_sha_create(state->dev, sha_ctx);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to init sha library: %s", doca_error_get_descr(result));
+		goto destroy_core_objs;
+	}
+
+	state->ctx = doca_sha_as_ctx(*sha_ctx);
+
+	result = create_core_objects(state, max_bufs);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to init DOCA core objects: %s", doca_error_get_descr(result));
+		goto destroy_core_objs;
+	}
+
+	/* Connect context to progress engine */
+	result = doca_pe_connect_ctx(state->pe, state->ctx);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to connect progress engine to context: %s", doca_error_get_descr(result));
+		goto destroy_core_objs;
+	}
+
+	if (app_cfg->merkle) {
+		/* Set SHA hash task configuration of the Merkle mode, one task per chunk in flight */
+		result = merkle_hasher_set_conf(*sha_ctx, app_cfg->nb_sha_tasks);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to set configuration for SHA hash task: %s", doca_error_get_descr(result));
+			goto destroy_core_objs;
+		}
+		return DOCA_SUCCESS;
+	}
+
+	result = doca_sha_task_hash_set_conf(*sha_ctx, sha_hash_completed_callback, sha_hash_error_callback,
+					     LOG_NUM_SHA_TASKS);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to set configuration for SHA hash task: %s", doca_error_get_descr(result));
+		goto destroy_core_objs;
+	}
+
+	if (app_cfg->mode == SERVER) {
+		/* Set SHA partial hash task configuration for the server */
+		result = doca_sha_task_partial_hash_set_conf(*sha_ctx, sha_partial_hash_completed_callback,
+							sha_partial_hash_error_callback, LOG_NUM_SHA_TASKS);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to set configuration for SHA partial hash task: %s", doca_error_get_descr(result));
+			goto destroy_core_objs;
+		}
+	}
+
+	return DOCA_SUCCESS;
+
+destroy_core_objs:
+	if (*sha_ctx != NULL) {
+		doca_sha_destroy(*sha_ctx);
+		*sha_ctx = NULL;
+		state->ctx = NULL;
+	}
+	destroy_core_objects(state);
+	return result;
 }
 
 doca_error_t
@@ -967,13 +2387,23 @@ file_integrity_init(struct doca_comm_channel_ep_t **ep, struct doca_comm_channel
 	struct doca_dev *cc_doca_dev;
 	struct doca_dev_rep *cc_doca_dev_rep = NULL;
 	struct timespec ts = {0};
-	uint32_t max_bufs = 2;    /* The app will use 2 doca buffers */
+	long nb_cpus;
 	doca_error_t result;
 
 	/* set default timeout */
 	if (app_cfg->timeout == 0)
 		app_cfg->timeout = DEFAULT_TIMEOUT;
 
+	/* set Merkle mode defaults */
+	if (app_cfg->chunk_size == 0)
+		app_cfg->chunk_size = MERKLE_DEFAULT_CHUNK_SIZE;
+	if (app_cfg->nb_sha_tasks == 0)
+		app_cfg->nb_sha_tasks = MERKLE_DEFAULT_SHA_TASKS;
+	if (app_cfg->nb_sw_threads == 0) {
+		nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		app_cfg->nb_sw_threads = nb_cpus > 0 ? nb_cpus : 1;
+	}
+
 	/* Create Comm Channel endpoint */
 	result = doca_comm_channel_ep_create(ep);
 	if (result != DOCA_SUCCESS) {
@@ -1003,44 +2433,14 @@ file_integrity_init(struct doca_comm_channel_ep_t **ep, struct doca_comm_channel
 		goto rep_dev_close;
 	}
 
-	/* Open device for partial SHA tasks */
-	result = open_doca_device_with_capabilities(&sha_partial_hash_is_supported, &state->dev);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to init DOCA device with SHA capabilities: %s", doca_error_get_descr(result));
-		goto rep_dev_close;
-	}
-
-	result = doca_sha_create(state->dev, sha_ctx);
-	if (result != DOCA_SUCCESS) {
-		doca_comm_channel_ep_destroy(*ep);
-		DOCA_LOG_ERR("Failed to init sha library: %s", doca_error_get_descr(result));
-		goto destroy_core_objs;
-	}
-
-	state->ctx = doca_sha_as_ctx(*sha_ctx);
-
-	result = create_core_objects(state, max_bufs);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to init DOCA core objects: %s", doca_error_get_descr(result));
-		goto destroy_core_objs;
-	}
-
-	/* Connect context to progress engine */
-	result = doca_pe_connect_ctx(state->pe, state->ctx);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to connect progress engine to context: %s", doca_error_get_descr(result));
-		goto destroy_core_objs;
+	/* The software backend of the Merkle mode does not use DOCA SHA */
+	if (!app_cfg->merkle || app_cfg->sha_backend == MERKLE_SHA_DOCA) {
+		result = init_sha(app_cfg, state, sha_ctx);
+		if (result != DOCA_SUCCESS)
+			goto rep_dev_close;
 	}
 
 	if (app_cfg->mode == CLIENT) {
-		/* Set SHA hash task configuration for the client */
-		result = doca_sha_task_hash_set_conf(*sha_ctx, sha_hash_completed_callback, sha_hash_error_callback,
-						     LOG_NUM_SHA_TASKS);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Failed to set configuration for SHA hash task: %s", doca_error_get_descr(result));
-			goto destroy_core_objs;
-		}
-
 		result = doca_comm_channel_ep_connect(*ep, SERVER_NAME, peer_addr);
 		if (result != DOCA_SUCCESS) {
 			DOCA_LOG_ERR("Couldn't establish a connection with the server node: %s", doca_error_get_descr(result));
@@ -1057,21 +2457,6 @@ file_integrity_init(struct doca_comm_channel_ep_t **ep, struct doca_comm_channel
 
 		DOCA_LOG_INFO("Connection to DPU was established successfully");
 	} else {
-		result = doca_sha_task_hash_set_conf(*sha_ctx, sha_hash_completed_callback, sha_hash_error_callback,
-						     LOG_NUM_SHA_TASKS);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Failed to set configuration for SHA hash task: %s", doca_error_get_descr(result));
-			goto destroy_core_objs;
-		}
-
-		/* Set SHA partial hash task configuration for the client */
-		result = doca_sha_task_partial_hash_set_conf(*sha_ctx, sha_partial_hash_completed_callback,
-							sha_partial_hash_error_callback, LOG_NUM_SHA_TASKS);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Failed to set configuration for SHA partial hash task: %s", doca_error_get_descr(result));
-			goto destroy_core_objs;
-		}
-
 		result = doca_comm_channel_ep_listen(*ep, SERVER_NAME);
 		if (result != DOCA_SUCCESS) {
 			DOCA_LOG_ERR("Comm channel server couldn't start listening: %s", doca_error_get_descr(result));
@@ -1232,6 +2617,128 @@ timeout_callback(void *param, void *config)
 	return DOCA_SUCCESS;
 }
 
+/*
+ * ARGP Callback - Handle Merkle mode parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+merkle_callback(void *param, void *config)
+{
+	struct file_integrity_config *app_cfg = (struct file_integrity_config *)config;
+
+	app_cfg->merkle = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle incremental mode parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+incremental_callback(void *param, void *config)
+{
+	struct file_integrity_config *app_cfg = (struct file_integrity_config *)config;
+
+	/* The manifests hold Merkle leaves */
+	app_cfg->incremental = *(bool *)param;
+	if (app_cfg->incremental)
+		app_cfg->merkle = true;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle chunk size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+chunk_size_callback(void *param, void *config)
+{
+	struct file_integrity_config *app_cfg = (struct file_integrity_config *)config;
+	int *chunk_size = (int *)param;
+
+	if (*chunk_size < MERKLE_MIN_CHUNK_SIZE || *chunk_size > MERKLE_MAX_CHUNK_SIZE) {
+		DOCA_LOG_ERR("Chunk size must be between %d and %d bytes", MERKLE_MIN_CHUNK_SIZE, MERKLE_MAX_CHUNK_SIZE);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	app_cfg->chunk_size = *chunk_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle SHA backend parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+sha_backend_callback(void *param, void *config)
+{
+	struct file_integrity_config *app_cfg = (struct file_integrity_config *)config;
+	const char *backend = (char *)param;
+
+	if (strcmp(backend, "doca") == 0)
+		app_cfg->sha_backend = MERKLE_SHA_DOCA;
+	else if (strcmp(backend, "sw") == 0)
+		app_cfg->sha_backend = MERKLE_SHA_SW;
+	else {
+		DOCA_LOG_ERR("Illegal SHA backend = [%s], should be doca or sw", backend);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle number of SHA tasks parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+sha_tasks_callback(void *param, void *config)
+{
+	struct file_integrity_config *app_cfg = (struct file_integrity_config *)config;
+	int *nb_tasks = (int *)param;
+
+	if (*nb_tasks <= 0 || *nb_tasks > MERKLE_MAX_SHA_TASKS) {
+		DOCA_LOG_ERR("Number of SHA tasks must be between 1 and %d", MERKLE_MAX_SHA_TASKS);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	app_cfg->nb_sha_tasks = *nb_tasks;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle number of software SHA threads parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+sw_threads_callback(void *param, void *config)
+{
+	struct file_integrity_config *app_cfg = (struct file_integrity_config *)config;
+	int *nb_threads = (int *)param;
+
+	if (*nb_threads <= 0) {
+		DOCA_LOG_ERR("Number of software SHA threads must be positive value");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	app_cfg->nb_sw_threads = *nb_threads;
+	return DOCA_SUCCESS;
+}
+
 /*
  * ARGP validation Callback - check if the running mode is valid and that the input file exists in client mode
  *
@@ -1242,6 +2749,7 @@ static doca_error_t
 args_validation_callback(void *cfg)
 {
 	struct file_integrity_config *app_cfg = (struct file_integrity_config *)cfg;
+	struct stat statbuf;
 
 	if (app_cfg->mode == CLIENT && (access(app_cfg->file_path, F_OK) == -1)) {
 		DOCA_LOG_ERR("File was not found %s", app_cfg->file_path);
@@ -1249,6 +2757,13 @@ args_validation_callback(void *cfg)
 	} else if (app_cfg->mode == SERVER && strlen(app_cfg->cc_dev_rep_pci_addr) == 0) {
 		DOCA_LOG_ERR("Missing PCI address for server");
 		return DOCA_ERROR_NOT_FOUND;
+	} else if (app_cfg->mode == CLIENT && !app_cfg->merkle && stat(app_cfg->file_path, &statbuf) == 0 &&
+		   S_ISDIR(statbuf.st_mode)) {
+		DOCA_LOG_ERR("Verifying a directory is supported only in Merkle mode");
+		return DOCA_ERROR_NOT_SUPPORTED;
+	} else if (!app_cfg->merkle && app_cfg->sha_backend == MERKLE_SHA_SW) {
+		DOCA_LOG_ERR("Software SHA backend is supported only in Merkle mode");
+		return DOCA_ERROR_NOT_SUPPORTED;
 	}
 	return DOCA_SUCCESS;
 }
@@ -1259,6 +2774,8 @@ register_file_integrity_params(void)
 	doca_error_t result;
 
 	struct doca_argp_param *dev_pci_addr_param, *rep_pci_addr_param, *file_param, *timeout_param;
+	struct doca_argp_param *merkle_param, *chunk_size_param, *sha_backend_param, *sha_tasks_param;
+	struct doca_argp_param *sw_threads_param, *incremental_param;
 
 	/* Create and register Comm Channel DOCA device PCI address */
 	result = doca_argp_param_create(&dev_pci_addr_param);
@@ -1303,7 +2820,7 @@ register_file_integrity_params(void)
 	}
 	doca_argp_param_set_short_name(file_param, "f");
 	doca_argp_param_set_long_name(file_param, "file");
-	doca_argp_param_set_description(file_param, "File to send by the client / File to write by the server");
+	doca_argp_param_set_description(file_param, "File to send by the client / File to write by the server, a directory in Merkle mode");
 	doca_argp_param_set_callback(file_param, file_callback);
 	doca_argp_param_set_type(file_param, DOCA_ARGP_TYPE_STRING);
 	doca_argp_param_set_mandatory(file_param);
@@ -1330,6 +2847,112 @@ register_file_integrity_params(void)
 		return result;
 	}
 
+	/* Create and register Merkle mode */
+	result = doca_argp_param_create(&merkle_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(merkle_param, "m");
+	doca_argp_param_set_long_name(merkle_param, "merkle");
+	doca_argp_param_set_description(merkle_param,
+					"Hash the file in chunks and verify every chunk against a Merkle tree, both sides must set it");
+	doca_argp_param_set_callback(merkle_param, merkle_callback);
+	doca_argp_param_set_type(merkle_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(merkle_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register chunk size */
+	result = doca_argp_param_create(&chunk_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(chunk_size_param, "c");
+	doca_argp_param_set_long_name(chunk_size_param, "chunk-size");
+	doca_argp_param_set_description(chunk_size_param,
+					"Merkle mode chunk size in bytes, set by the client, default is 1MB");
+	doca_argp_param_set_callback(chunk_size_param, chunk_size_callback);
+	doca_argp_param_set_type(chunk_size_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(chunk_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register SHA backend */
+	result = doca_argp_param_create(&sha_backend_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(sha_backend_param, "b");
+	doca_argp_param_set_long_name(sha_backend_param, "sha-backend");
+	doca_argp_param_set_description(sha_backend_param,
+					"Merkle mode SHA backend: doca or sw for software SHA256 on CPU threads, default is doca");
+	doca_argp_param_set_callback(sha_backend_param, sha_backend_callback);
+	doca_argp_param_set_type(sha_backend_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(sha_backend_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register number of SHA tasks */
+	result = doca_argp_param_create(&sha_tasks_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(sha_tasks_param, "n");
+	doca_argp_param_set_long_name(sha_tasks_param, "sha-tasks");
+	doca_argp_param_set_description(sha_tasks_param, "Merkle mode number of chunks hashed at once, default is 16");
+	doca_argp_param_set_callback(sha_tasks_param, sha_tasks_callback);
+	doca_argp_param_set_type(sha_tasks_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(sha_tasks_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register number of software SHA threads */
+	result = doca_argp_param_create(&sw_threads_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(sw_threads_param, "sw-threads");
+	doca_argp_param_set_description(sw_threads_param,
+					"Number of threads of the software SHA backend, default is one per CPU");
+	doca_argp_param_set_callback(sw_threads_param, sw_threads_callback);
+	doca_argp_param_set_type(sw_threads_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(sw_threads_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register incremental mode */
+	result = doca_argp_param_create(&incremental_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(incremental_param, "i");
+	doca_argp_param_set_long_name(incremental_param, "incremental");
+	doca_argp_param_set_description(incremental_param,
+					"Client only - send only the chunks changed since the last verification, implies Merkle mode");
+	doca_argp_param_set_callback(incremental_param, incremental_callback);
+	doca_argp_param_set_type(incremental_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(incremental_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
 	/* Register version callback for DOCA SDK & RUNTIME */
 	result = doca_argp_register_version_callback(sdk_version_callback);
 	if (result != DOCA_SUCCESS) {
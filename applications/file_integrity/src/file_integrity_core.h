@@ -14,6 +14,8 @@
 #ifndef FILE_INTEGRITY_CORE_H_
 #define FILE_INTEGRITY_CORE_H_
 
+#include <stdbool.h>
+
 #include <doca_comm_channel.h>
 #include <doca_buf.h>
 #include <doca_buf_inventory.h>
@@ -22,6 +24,8 @@
 
 #include <samples/common.h>
 
+#include "file_integrity_merkle.h"
+
 #define MAX_MSG_SIZE 4032			/* Max comm channel message size */
 #define MAX_FILE_NAME 255			/* Max file name */
 
@@ -39,6 +43,12 @@ struct file_integrity_config {
 	char cc_dev_pci_addr[DOCA_DEVINFO_PCI_ADDR_SIZE];	  /* Comm Channel DOCA device PCI address */
 	char cc_dev_rep_pci_addr[DOCA_DEVINFO_REP_PCI_ADDR_SIZE]; /* Comm Channel DOCA device representor PCI address */
 	int timeout;						  /* Application timeout in seconds */
+	bool merkle;						  /* Verify the file with a Merkle tree of chunks */
+	uint32_t chunk_size;					  /* Merkle chunk size, set by the client */
+	enum merkle_sha_backend sha_backend;			  /* SHA backend of the Merkle mode */
+	uint32_t nb_sha_tasks;					  /* SHA tasks in flight in Merkle mode */
+	uint32_t nb_sw_threads;					  /* Software SHA threads, 0 for one per CPU */
+	bool incremental;					  /* Send only the chunks changed since the last verification */
 };
 
 /*
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <doca_log.h>
+
+#include "file_integrity_manifest.h"
+
+DOCA_LOG_REGISTER(FILE_INTEGRITY::Manifest);
+
+/* Header of the manifest files, followed by the leaves */
+struct __attribute__((packed)) manifest_file_header {
+	uint32_t magic;				/* MANIFEST_MAGIC, big endian */
+	uint32_t version;			/* MANIFEST_VERSION, big endian */
+	uint32_t chunk_size;			/* Chunk size, big endian */
+	uint32_t nb_chunks;			/* Number of leaves, big endian */
+	uint64_t file_size;			/* File size once verified, big endian */
+	uint64_t mtime_ns;			/* File modification time once verified, big endian */
+	uint8_t root[MERKLE_DIGEST_SIZE];	/* Tree root */
+};
+
+/*
+ * Get the path of the manifest of a file
+ *
+ * @file_path [in]: file path
+ * @path [out]: PATH_MAX bytes manifest path
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+manifest_path(const char *file_path, char *path)
+{
+	const char *name = strrchr(file_path, '/');
+	int len;
+
+	if (name == NULL)
+		len = snprintf(path, PATH_MAX, ".%s" MANIFEST_SUFFIX, file_path);
+	else
+		len = snprintf(path, PATH_MAX, "%.*s/.%s" MANIFEST_SUFFIX, (int)(name - file_path), file_path,
+			       name + 1);
+	if (len < 0 || len >= PATH_MAX) {
+		DOCA_LOG_ERR("Manifest path of %s is too long", file_path);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Get the modification time of a file
+ *
+ * @statbuf [in]: file information
+ * @return: modification time (nanoseconds)
+ */
+static uint64_t
+mtime_ns(const struct stat *statbuf)
+{
+	return statbuf->st_mtim.tv_sec * 1000000000ULL + statbuf->st_mtim.tv_nsec;
+}
+
+bool
+manifest_is_manifest_name(const char *name)
+{
+	size_t len = strlen(name), suffix_len = strlen(MANIFEST_SUFFIX);
+
+	return name[0] == '.' && len > suffix_len + 1 && strcmp(name + len - suffix_len, MANIFEST_SUFFIX) == 0;
+}
+
+doca_error_t
+manifest_load(const char *file_path, uint32_t chunk_size, struct file_manifest **manifest)
+{
+	struct manifest_file_header header;
+	struct file_manifest *new_manifest;
+	uint8_t root[MERKLE_DIGEST_SIZE];
+	char path[PATH_MAX];
+	struct stat statbuf;
+	size_t leaves_len;
+	int fd;
+	doca_error_t result;
+
+	result = manifest_path(file_path, path);
+	if (result != DOCA_SUCCESS)
+		return result;
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		if (errno == ENOENT)
+			return DOCA_ERROR_NOT_FOUND;
+		DOCA_LOG_ERR("Failed to open manifest %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	if (read(fd, &header, sizeof(header)) != sizeof(header) || be32toh(header.magic) != MANIFEST_MAGIC ||
+	    be32toh(header.version) != MANIFEST_VERSION) {
+		DOCA_LOG_WARN("Ignoring manifest %s of unknown format", path);
+		result = DOCA_ERROR_NOT_FOUND;
+		goto close_fd;
+	}
+	if (be32toh(header.chunk_size) != chunk_size || be32toh(header.nb_chunks) !=
+	    merkle_nb_chunks(be64toh(header.file_size), chunk_size)) {
+		DOCA_LOG_DBG("Ignoring manifest %s of another chunk size", path);
+		result = DOCA_ERROR_NOT_FOUND;
+		goto close_fd;
+	}
+
+	/* The leaves describe the file only if it was not modified since */
+	if (stat(file_path, &statbuf) < 0 || (uint64_t)statbuf.st_size != be64toh(header.file_size) ||
+	    mtime_ns(&statbuf) != be64toh(header.mtime_ns)) {
+		DOCA_LOG_DBG("Ignoring manifest %s, the file changed since it was verified", path);
+		result = DOCA_ERROR_NOT_FOUND;
+		goto close_fd;
+	}
+
+	leaves_len = (size_t)be32toh(header.nb_chunks) * MERKLE_DIGEST_SIZE;
+	new_manifest = malloc(sizeof(*new_manifest) + leaves_len);
+	if (new_manifest == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto close_fd;
+	}
+	new_manifest->chunk_size = chunk_size;
+	new_manifest->nb_chunks = be32toh(header.nb_chunks);
+	new_manifest->file_size = be64toh(header.file_size);
+	new_manifest->mtime_ns = be64toh(header.mtime_ns);
+	memcpy(new_manifest->root, header.root, MERKLE_DIGEST_SIZE);
+	if (read(fd, new_manifest->leaves, leaves_len) != (ssize_t)leaves_len) {
+		DOCA_LOG_WARN("Ignoring truncated manifest %s", path);
+		result = DOCA_ERROR_NOT_FOUND;
+		goto free_manifest;
+	}
+
+	/* A damaged manifest must not hide a changed chunk */
+	result = merkle_root(new_manifest->leaves, new_manifest->nb_chunks, new_manifest->file_size, chunk_size, root);
+	if (result != DOCA_SUCCESS)
+		goto free_manifest;
+	if (memcmp(root, new_manifest->root, MERKLE_DIGEST_SIZE) != 0) {
+		DOCA_LOG_WARN("Ignoring manifest %s, its leaves are not identical to its root", path);
+		result = DOCA_ERROR_NOT_FOUND;
+		goto free_manifest;
+	}
+
+	close(fd);
+	*manifest = new_manifest;
+	return DOCA_SUCCESS;
+
+free_manifest:
+	free(new_manifest);
+close_fd:
+	close(fd);
+	return result;
+}
+
+doca_error_t
+manifest_store(const char *file_path, int fd, uint32_t chunk_size, uint32_t nb_chunks, const uint8_t *root,
+	       const uint8_t *leaves)
+{
+	struct manifest_file_header header;
+	char path[PATH_MAX], tmp_path[PATH_MAX];
+	size_t leaves_len = (size_t)nb_chunks * MERKLE_DIGEST_SIZE;
+	struct stat statbuf;
+	int tmp_fd;
+	doca_error_t result;
+
+	result = manifest_path(file_path, path);
+	if (result != DOCA_SUCCESS)
+		return result;
+	if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+		DOCA_LOG_ERR("Manifest path of %s is too long", file_path);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (fstat(fd, &statbuf) < 0) {
+		DOCA_LOG_ERR("Failed to get information of %s", file_path);
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	header.magic = htobe32(MANIFEST_MAGIC);
+	header.version = htobe32(MANIFEST_VERSION);
+	header.chunk_size = htobe32(chunk_size);
+	header.nb_chunks = htobe32(nb_chunks);
+	header.file_size = htobe64(statbuf.st_size);
+	header.mtime_ns = htobe64(mtime_ns(&statbuf));
+	memcpy(header.root, root, MERKLE_DIGEST_SIZE);
+
+	/* Readers see either the previous manifest or the new one */
+	tmp_fd = open(tmp_path, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP);
+	if (tmp_fd < 0) {
+		DOCA_LOG_ERR("Failed to open %s: %s", tmp_path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	if (write(tmp_fd, &header, sizeof(header)) != sizeof(header) ||
+	    write(tmp_fd, leaves, leaves_len) != (ssize_t)leaves_len) {
+		DOCA_LOG_ERR("Failed to write manifest %s", tmp_path);
+		close(tmp_fd);
+		unlink(tmp_path);
+		return DOCA_ERROR_IO_FAILED;
+	}
+	close(tmp_fd);
+	if (rename(tmp_path, path) < 0) {
+		DOCA_LOG_ERR("Failed to rename %s to %s: %s", tmp_path, path, strerror(errno));
+		unlink(tmp_path);
+		return DOCA_ERROR_IO_FAILED;
+	}
+	return DOCA_SUCCESS;
+}
+
+void
+manifest_remove(const char *file_path)
+{
+	char path[PATH_MAX];
+
+	if (manifest_path(file_path, path) == DOCA_SUCCESS && unlink(path) < 0 && errno != ENOENT)
+		DOCA_LOG_ERR("Failed to remove manifest %s: %s", path, strerror(errno));
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef FILE_INTEGRITY_MANIFEST_H_
+#define FILE_INTEGRITY_MANIFEST_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "file_integrity_merkle.h"
+
+/*
+ * Manifest of a verified file, kept by the server next to the file as ".<file name>.fim".
+ * It holds the Merkle leaves of the file together with the size and the modification time the file had once verified.
+ * While the file keeps them, the leaves are trusted and only the chunks whose leaf changed are transferred again.
+ */
+
+#define MANIFEST_SUFFIX ".fim"		/* Suffix of the manifest files */
+#define MANIFEST_MAGIC 0x46494d4d	/* "FIMM", first field of the manifest files */
+#define MANIFEST_VERSION 1		/* Version of the manifest format */
+
+/* Manifest of a file */
+struct file_manifest {
+	uint32_t chunk_size;			/* Chunk size of the leaves */
+	uint32_t nb_chunks;			/* Number of leaves */
+	uint64_t file_size;			/* File size once verified */
+	uint64_t mtime_ns;			/* File modification time once verified */
+	uint8_t root[MERKLE_DIGEST_SIZE];	/* Tree root */
+	uint8_t leaves[];			/* nb_chunks * MERKLE_DIGEST_SIZE bytes leaves */
+};
+
+/*
+ * Check if a file name is the name of a manifest
+ *
+ * @name [in]: file name, without the directory
+ * @return: true if it is the name of a manifest
+ */
+bool manifest_is_manifest_name(const char *name);
+
+/*
+ * Load the manifest of a file, only if the file did not change since it was stored
+ *
+ * @file_path [in]: file path
+ * @chunk_size [in]: expected chunk size of the leaves
+ * @manifest [out]: manifest, to free with free()
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_NOT_FOUND if there is no valid manifest and DOCA_ERROR otherwise
+ */
+doca_error_t manifest_load(const char *file_path, uint32_t chunk_size, struct file_manifest **manifest);
+
+/*
+ * Store the manifest of a verified file, with the current size and modification time of the file
+ *
+ * @file_path [in]: file path
+ * @fd [in]: file descriptor of the file, after the last write
+ * @chunk_size [in]: chunk size of the leaves
+ * @nb_chunks [in]: number of leaves
+ * @root [in]: tree root
+ * @leaves [in]: leaves
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t manifest_store(const char *file_path, int fd, uint32_t chunk_size, uint32_t nb_chunks, const uint8_t *root,
+			    const uint8_t *leaves);
+
+/*
+ * Remove the manifest of a file, if any
+ *
+ * @file_path [in]: file path
+ */
+void manifest_remove(const char *file_path);
+
+#endif /* FILE_INTEGRITY_MANIFEST_H_ */
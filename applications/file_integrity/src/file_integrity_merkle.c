@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <doca_buf.h>
+#include <doca_buf_inventory.h>
+#include <doca_ctx.h>
+#include <doca_log.h>
+#include <doca_pe.h>
+
+#include "file_integrity_merkle.h"
+
+#define MERKLE_SHA_ALGORITHM (DOCA_SHA_ALGORITHM_SHA256)	/* doca_sha_algorithm of the tree */
+#define MERKLE_SLEEP_IN_NANOS (10 * 1000)			/* Sample the tasks every 10 microseconds */
+#define MERKLE_NODE_PREFIX 0x01					/* First byte hashed in the inner nodes */
+#define MERKLE_ROOT_PREFIX 0x02					/* First byte hashed in the root */
+
+DOCA_LOG_REGISTER(FILE_INTEGRITY::Merkle);
+
+/* Slot of a chunk in flight */
+struct merkle_slot {
+	struct merkle_hasher *hasher;		/* Hasher of the slot */
+	uint32_t chunk_idx;			/* Index of the chunk in the slot */
+	bool busy;				/* True while the chunk is hashed, owned by the caller thread */
+	const uint8_t *data;			/* Chunk */
+	size_t len;				/* Chunk length */
+	doca_error_t result;			/* Result of the hash */
+	uint8_t digest[MERKLE_DIGEST_SIZE];	/* Chunk digest */
+	struct doca_sha_task_hash *task;	/* Task of the DOCA backend, reused by the chunks of the slot */
+	struct doca_buf *src_buf;		/* Source buffer of the DOCA backend */
+	struct doca_buf *dst_buf;		/* Destination buffer of the DOCA backend */
+};
+
+/* Hasher of chunks */
+struct merkle_hasher {
+	struct merkle_hasher_cfg cfg;		/* Configuration */
+	struct merkle_slot *slots;		/* Slots */
+	uint32_t nb_busy;			/* Slots in flight */
+	doca_error_t result;			/* First hash failure */
+	/* DOCA backend */
+	struct program_core_objects *state;	/* Core objects */
+	struct doca_sha *sha_ctx;		/* SHA context */
+	uint64_t max_src_size;			/* Largest chunk the SHA engine hashes */
+	/* Software backend, the slots indexes are queued in rings of nb_slots entries */
+	pthread_t *threads;			/* Hash threads */
+	uint32_t nb_threads;			/* Hash threads started */
+	pthread_mutex_t lock;			/* Protects the rings and stop */
+	pthread_cond_t job_cond;		/* Signaled when a job is queued or on stop */
+	pthread_cond_t done_cond;		/* Signaled when a job is done */
+	uint32_t *jobs;				/* Slots to hash */
+	uint32_t jobs_head;			/* First job */
+	uint32_t nb_jobs;			/* Queued jobs */
+	uint32_t *done;				/* Slots hashed, not completed yet */
+	uint32_t nb_done;			/* Slots hashed */
+	bool stop;				/* Set to stop the threads */
+};
+
+/*
+ * Free callback - free the destination digests of the DOCA backend
+ *
+ * @addr [in]: Memory range pointer
+ * @len [in]: Memory range length
+ * @opaque [in]: An opaque pointer passed to iterator
+ */
+static void
+free_dst_cb(void *addr, size_t len, void *opaque)
+{
+	(void)len;
+	(void)opaque;
+
+	free(addr);
+}
+
+/*
+ * Complete a hashed slot: free it and give the digest to the caller
+ *
+ * @slot [in]: slot
+ */
+static void
+complete_slot(struct merkle_slot *slot)
+{
+	struct merkle_hasher *hasher = slot->hasher;
+
+	slot->busy = false;
+	hasher->nb_busy--;
+	if (slot->result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to hash chunk %u: %s", slot->chunk_idx, doca_error_get_descr(slot->result));
+		if (hasher->result == DOCA_SUCCESS)
+			hasher->result = slot->result;
+		return;
+	}
+	hasher->cfg.chunk_cb(slot->chunk_idx, slot->digest, hasher->cfg.user_ctx);
+}
+
+/*
+ * SHA hash task completed callback of the DOCA backend
+ *
+ * @sha_hash_task [in]: Completed task
+ * @task_user_data [in]: doca_data from the task
+ * @ctx_user_data [in]: doca_data from the context
+ */
+static void
+merkle_hash_completed_callback(struct doca_sha_task_hash *sha_hash_task, union doca_data task_user_data,
+			       union doca_data ctx_user_data)
+{
+	struct merkle_slot *slot = (struct merkle_slot *)task_user_data.ptr;
+	size_t digest_len;
+	void *digest;
+
+	(void)sha_hash_task;
+	(void)ctx_user_data;
+
+	slot->result = doca_buf_get_data(slot->dst_buf, &digest);
+	if (slot->result == DOCA_SUCCESS)
+		slot->result = doca_buf_get_data_len(slot->dst_buf, &digest_len);
+	if (slot->result == DOCA_SUCCESS && digest_len < MERKLE_DIGEST_SIZE)
+		slot->result = DOCA_ERROR_UNEXPECTED;
+	if (slot->result == DOCA_SUCCESS)
+		memcpy(slot->digest, digest, MERKLE_DIGEST_SIZE);
+	doca_buf_dec_refcount(slot->src_buf, NULL);
+	slot->src_buf = NULL;
+	complete_slot(slot);
+}
+
+/*
+ * SHA hash task error callback of the DOCA backend
+ *
+ * @sha_hash_task [in]: Failed task
+ * @task_user_data [in]: doca_data from the task
+ * @ctx_user_data [in]: doca_data from the context
+ */
+static void
+merkle_hash_error_callback(struct doca_sha_task_hash *sha_hash_task, union doca_data task_user_data,
+			   union doca_data ctx_user_data)
+{
+	struct merkle_slot *slot = (struct merkle_slot *)task_user_data.ptr;
+
+	(void)ctx_user_data;
+
+	slot->result = doca_task_get_status(doca_sha_task_hash_as_task(sha_hash_task));
+	doca_buf_dec_refcount(slot->src_buf, NULL);
+	slot->src_buf = NULL;
+	complete_slot(slot);
+}
+
+doca_error_t
+merkle_hasher_set_conf(struct doca_sha *sha_ctx, uint32_t nb_tasks)
+{
+	uint8_t log_num_tasks = 0;
+
+	while ((1U << log_num_tasks) < nb_tasks)
+		log_num_tasks++;
+	return doca_sha_task_hash_set_conf(sha_ctx, merkle_hash_completed_callback, merkle_hash_error_callback,
+					   log_num_tasks);
+}
+
+/*
+ * Hash thread of the software backend
+ *
+ * @arg [in]: hasher
+ * @return: NULL
+ */
+static void *
+hash_thread(void *arg)
+{
+	struct merkle_hasher *hasher = arg;
+	struct merkle_slot *slot;
+	uint32_t slot_idx, nb_slots = hasher->cfg.nb_slots;
+
+	pthread_mutex_lock(&hasher->lock);
+	for (;;) {
+		while (!hasher->stop && hasher->nb_jobs == 0)
+			pthread_cond_wait(&hasher->job_cond, &hasher->lock);
+		if (hasher->nb_jobs == 0)
+			break;
+		slot_idx = hasher->jobs[hasher->jobs_head];
+		hasher->jobs_head = (hasher->jobs_head + 1) % nb_slots;
+		hasher->nb_jobs--;
+		pthread_mutex_unlock(&hasher->lock);
+
+		slot = &hasher->slots[slot_idx];
+		sha256_digest(slot->data, slot->len, slot->digest);
+		slot->result = DOCA_SUCCESS;
+
+		pthread_mutex_lock(&hasher->lock);
+		hasher->done[hasher->nb_done++] = slot_idx;
+		pthread_cond_signal(&hasher->done_cond);
+	}
+	pthread_mutex_unlock(&hasher->lock);
+	return NULL;
+}
+
+/*
+ * Complete the slots hashed by the software threads, waiting for one if none is hashed yet
+ *
+ * @hasher [in]: hasher
+ */
+static void
+progress_sw(struct merkle_hasher *hasher)
+{
+	uint32_t done[MERKLE_MAX_SHA_TASKS];
+	uint32_t nb_done, i;
+
+	pthread_mutex_lock(&hasher->lock);
+	while (hasher->nb_done == 0)
+		pthread_cond_wait(&hasher->done_cond, &hasher->lock);
+	nb_done = hasher->nb_done;
+	memcpy(done, hasher->done, nb_done * sizeof(*done));
+	hasher->nb_done = 0;
+	pthread_mutex_unlock(&hasher->lock);
+
+	/* The callbacks run without the lock, in the caller thread */
+	for (i = 0; i < nb_done; i++)
+		complete_slot(&hasher->slots[done[i]]);
+}
+
+/*
+ * Complete the hashed slots
+ *
+ * @hasher [in]: hasher
+ */
+static void
+progress(struct merkle_hasher *hasher)
+{
+	struct timespec ts = {
+		.tv_nsec = MERKLE_SLEEP_IN_NANOS,
+	};
+
+	if (hasher->cfg.backend == MERKLE_SHA_SW)
+		progress_sw(hasher);
+	else if (doca_pe_progress(hasher->state->pe) == 0)
+		nanosleep(&ts, &ts);
+}
+
+/*
+ * Stop the threads of the software backend
+ *
+ * @hasher [in]: hasher
+ */
+static void
+stop_threads(struct merkle_hasher *hasher)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&hasher->lock);
+	hasher->stop = true;
+	pthread_cond_broadcast(&hasher->job_cond);
+	pthread_mutex_unlock(&hasher->lock);
+	for (i = 0; i < hasher->nb_threads; i++)
+		pthread_join(hasher->threads[i], NULL);
+	hasher->nb_threads = 0;
+}
+
+/*
+ * Start the threads of the software backend
+ *
+ * @hasher [in]: hasher
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+start_threads(struct merkle_hasher *hasher)
+{
+	uint32_t i;
+
+	hasher->jobs = calloc(hasher->cfg.nb_slots, sizeof(*hasher->jobs));
+	hasher->done = calloc(hasher->cfg.nb_slots, sizeof(*hasher->done));
+	hasher->threads = calloc(hasher->cfg.nb_threads, sizeof(*hasher->threads));
+	if (hasher->jobs == NULL || hasher->done == NULL || hasher->threads == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	for (i = 0; i < hasher->cfg.nb_threads; i++) {
+		if (pthread_create(&hasher->threads[i], NULL, hash_thread, hasher) != 0) {
+			DOCA_LOG_ERR("Failed to create SHA thread");
+			stop_threads(hasher);
+			return DOCA_ERROR_OPERATING_SYSTEM;
+		}
+		hasher->nb_threads++;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Prepare the DOCA backend: register the chunks and the digests memory and start the SHA context
+ *
+ * @hasher [in]: hasher
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+init_doca_backend(struct merkle_hasher *hasher)
+{
+	struct program_core_objects *state = hasher->state;
+	uint32_t dst_size, i;
+	uint8_t *dst_region;
+	doca_error_t result;
+
+	result = doca_sha_cap_get_max_src_buffer_size(doca_dev_as_devinfo(state->dev), &hasher->max_src_size);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to get maximum source buffer size for DOCA SHA: %s", doca_error_get_descr(result));
+		return result;
+	}
+	result = doca_sha_cap_get_min_dst_buffer_size(doca_dev_as_devinfo(state->dev), MERKLE_SHA_ALGORITHM, &dst_size);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to get minimum destination buffer size for DOCA SHA: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_mmap_set_memrange(state->src_mmap, hasher->cfg.region, hasher->cfg.region_len);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to set memory range of source memory map: %s", doca_error_get_descr(result));
+		return result;
+	}
+	if (hasher->cfg.region_free_cb != NULL) {
+		result = doca_mmap_set_free_cb(state->src_mmap, hasher->cfg.region_free_cb, NULL);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Unable to set free callback of source memory map: %s", doca_error_get_descr(result));
+			return result;
+		}
+	}
+	result = doca_mmap_start(state->src_mmap);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to start source memory map: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Every slot has its own digest */
+	dst_region = calloc(hasher->cfg.nb_slots, dst_size);
+	if (dst_region == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	result = doca_mmap_set_memrange(state->dst_mmap, dst_region, (size_t)hasher->cfg.nb_slots * dst_size);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to set memory range destination memory map: %s", doca_error_get_descr(result));
+		free(dst_region);
+		return result;
+	}
+	result = doca_mmap_set_free_cb(state->dst_mmap, &free_dst_cb, NULL);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to set free callback of destination memory map: %s", doca_error_get_descr(result));
+		free(dst_region);
+		return result;
+	}
+	result = doca_mmap_start(state->dst_mmap);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to start destination memory map: %s", doca_error_get_descr(result));
+		return result;
+	}
+	for (i = 0; i < hasher->cfg.nb_slots; i++) {
+		result = doca_buf_inventory_buf_get_by_addr(state->buf_inv, state->dst_mmap, dst_region + i * dst_size,
+							    dst_size, &hasher->slots[i].dst_buf);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Unable to acquire DOCA buffer representing destination buffer: %s",
+				     doca_error_get_descr(result));
+			return result;
+		}
+	}
+
+	result = doca_ctx_start(state->ctx);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to start DOCA context: %s", doca_error_get_descr(result));
+		return result;
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+merkle_hasher_create(const struct merkle_hasher_cfg *cfg, struct program_core_objects *state,
+		     struct doca_sha *sha_ctx, struct merkle_hasher **hasher)
+{
+	struct merkle_hasher *new_hasher;
+	doca_error_t result;
+	uint32_t i;
+
+	if (cfg->nb_slots == 0 || cfg->nb_slots > MERKLE_MAX_SHA_TASKS) {
+		DOCA_LOG_ERR("Number of SHA tasks must be between 1 and %d", MERKLE_MAX_SHA_TASKS);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	new_hasher = calloc(1, sizeof(*new_hasher));
+	if (new_hasher == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	new_hasher->cfg = *cfg;
+	new_hasher->state = state;
+	new_hasher->sha_ctx = sha_ctx;
+	new_hasher->result = DOCA_SUCCESS;
+	pthread_mutex_init(&new_hasher->lock, NULL);
+	pthread_cond_init(&new_hasher->job_cond, NULL);
+	pthread_cond_init(&new_hasher->done_cond, NULL);
+
+	new_hasher->slots = calloc(cfg->nb_slots, sizeof(*new_hasher->slots));
+	if (new_hasher->slots == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		result = DOCA_ERROR_NO_MEMORY;
+		goto destroy_hasher;
+	}
+	for (i = 0; i < cfg->nb_slots; i++)
+		new_hasher->slots[i].hasher = new_hasher;
+
+	if (cfg->backend == MERKLE_SHA_DOCA)
+		result = init_doca_backend(new_hasher);
+	else if (cfg->nb_threads > 0)
+		result = start_threads(new_hasher);
+	else
+		result = DOCA_SUCCESS;
+	if (result != DOCA_SUCCESS)
+		goto destroy_hasher;
+
+	*hasher = new_hasher;
+	return DOCA_SUCCESS;
+
+destroy_hasher:
+	merkle_hasher_destroy(new_hasher);
+	return result;
+}
+
+doca_error_t
+merkle_hasher_wait_slot(struct merkle_hasher *hasher, uint32_t slot)
+{
+	while (hasher->slots[slot].busy)
+		progress(hasher);
+	return hasher->result;
+}
+
+doca_error_t
+merkle_hasher_submit(struct merkle_hasher *hasher, uint32_t slot_idx, uint32_t chunk_idx, const void *data,
+		     size_t len)
+{
+	struct merkle_slot *slot = &hasher->slots[slot_idx];
+	union doca_data task_user_data = {0};
+	doca_error_t result;
+
+	slot->chunk_idx = chunk_idx;
+	slot->data = data;
+	slot->len = len;
+
+	if (hasher->cfg.backend == MERKLE_SHA_SW) {
+		slot->busy = true;
+		hasher->nb_busy++;
+		if (hasher->nb_threads == 0) {
+			sha256_digest(data, len, slot->digest);
+			slot->result = DOCA_SUCCESS;
+			complete_slot(slot);
+			return hasher->result;
+		}
+		pthread_mutex_lock(&hasher->lock);
+		hasher->jobs[(hasher->jobs_head + hasher->nb_jobs++) % hasher->cfg.nb_slots] = slot_idx;
+		pthread_cond_signal(&hasher->job_cond);
+		pthread_mutex_unlock(&hasher->lock);
+		return DOCA_SUCCESS;
+	}
+
+	if (len > hasher->max_src_size) {
+		DOCA_LOG_ERR("Chunk of %zu bytes is larger than DOCA SHA maximum buffer size: %" PRIu64, len,
+			     hasher->max_src_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	result = doca_buf_inventory_buf_get_by_data(hasher->state->buf_inv, hasher->state->src_mmap, (void *)data, len,
+						    &slot->src_buf);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to acquire DOCA buffer representing source buffer: %s",
+			     doca_error_get_descr(result));
+		return result;
+	}
+	result = doca_buf_reset_data_len(slot->dst_buf);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to reset the destination buffer: %s", doca_error_get_descr(result));
+		goto destroy_src_buf;
+	}
+
+	if (slot->task == NULL) {
+		/* Include the slot in user data of task to be used in the callbacks */
+		task_user_data.ptr = slot;
+		result = doca_sha_task_hash_alloc_init(hasher->sha_ctx, MERKLE_SHA_ALGORITHM, slot->src_buf,
+						       slot->dst_buf, task_user_data, &slot->task);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to allocate SHA hash task: %s", doca_error_get_descr(result));
+			slot->task = NULL;
+			goto destroy_src_buf;
+		}
+	} else {
+		result = doca_sha_task_hash_set_src(slot->task, slot->src_buf);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to set source buffer of SHA hash task: %s", doca_error_get_descr(result));
+			goto destroy_src_buf;
+		}
+	}
+
+	slot->busy = true;
+	hasher->nb_busy++;
+	result = doca_task_submit(doca_sha_task_hash_as_task(slot->task));
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to submit SHA hash task: %s", doca_error_get_descr(result));
+		slot->busy = false;
+		hasher->nb_busy--;
+		goto destroy_src_buf;
+	}
+	return DOCA_SUCCESS;
+
+destroy_src_buf:
+	doca_buf_dec_refcount(slot->src_buf, NULL);
+	slot->src_buf = NULL;
+	return result;
+}
+
+doca_error_t
+merkle_hasher_wait_all(struct merkle_hasher *hasher)
+{
+	while (hasher->nb_busy > 0)
+		progress(hasher);
+	return hasher->result;
+}
+
+void
+merkle_hasher_destroy(struct merkle_hasher *hasher)
+{
+	uint32_t i;
+
+	merkle_hasher_wait_all(hasher);
+	if (hasher->cfg.backend == MERKLE_SHA_SW) {
+		stop_threads(hasher);
+		if (hasher->cfg.region_free_cb != NULL)
+			hasher->cfg.region_free_cb(hasher->cfg.region, hasher->cfg.region_len, NULL);
+	}
+	for (i = 0; hasher->slots != NULL && i < hasher->cfg.nb_slots; i++) {
+		if (hasher->slots[i].task != NULL)
+			doca_task_free(doca_sha_task_hash_as_task(hasher->slots[i].task));
+		if (hasher->slots[i].dst_buf != NULL)
+			doca_buf_dec_refcount(hasher->slots[i].dst_buf, NULL);
+	}
+	pthread_cond_destroy(&hasher->done_cond);
+	pthread_cond_destroy(&hasher->job_cond);
+	pthread_mutex_destroy(&hasher->lock);
+	free(hasher->threads);
+	free(hasher->done);
+	free(hasher->jobs);
+	free(hasher->slots);
+	free(hasher);
+}
+
+uint64_t
+merkle_nb_chunks(uint64_t file_size, uint32_t chunk_size)
+{
+	if (file_size == 0)
+		return 1;
+	return 1 + (file_size - 1) / chunk_size;
+}
+
+doca_error_t
+merkle_root(const uint8_t *leaves, uint32_t nb_leaves, uint64_t file_size, uint32_t chunk_size, uint8_t *root)
+{
+	uint8_t prefix = MERKLE_NODE_PREFIX, sizes[12];
+	struct sha256_ctx ctx;
+	uint32_t nb_nodes, i, j;
+	uint8_t *nodes;
+
+	if (nb_leaves == 0 || nb_leaves != merkle_nb_chunks(file_size, chunk_size)) {
+		DOCA_LOG_ERR("Wrong number of leaves %u for a file of %" PRIu64 " bytes", nb_leaves, file_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	nodes = malloc((size_t)nb_leaves * MERKLE_DIGEST_SIZE);
+	if (nodes == NULL) {
+		DOCA_LOG_ERR("Failed to allocate memory");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	memcpy(nodes, leaves, (size_t)nb_leaves * MERKLE_DIGEST_SIZE);
+
+	/* Every level is computed in place over the level below it */
+	for (nb_nodes = nb_leaves; nb_nodes > 1; nb_nodes = j) {
+		for (i = 0, j = 0; i < nb_nodes; i += 2, j++) {
+			if (i + 1 == nb_nodes) {
+				memmove(nodes + j * MERKLE_DIGEST_SIZE, nodes + i * MERKLE_DIGEST_SIZE,
+					MERKLE_DIGEST_SIZE);
+				continue;
+			}
+			sha256_init(&ctx);
+			sha256_update(&ctx, &prefix, sizeof(prefix));
+			sha256_update(&ctx, nodes + i * MERKLE_DIGEST_SIZE, 2 * MERKLE_DIGEST_SIZE);
+			sha256_final(&ctx, nodes + j * MERKLE_DIGEST_SIZE);
+		}
+	}
+
+	for (i = 0; i < 8; i++)
+		sizes[i] = file_size >> (56 - 8 * i);
+	for (i = 0; i < 4; i++)
+		sizes[8 + i] = chunk_size >> (24 - 8 * i);
+	prefix = MERKLE_ROOT_PREFIX;
+	sha256_init(&ctx);
+	sha256_update(&ctx, &prefix, sizeof(prefix));
+	sha256_update(&ctx, sizes, sizeof(sizes));
+	sha256_update(&ctx, nodes, MERKLE_DIGEST_SIZE);
+	sha256_final(&ctx, root);
+
+	free(nodes);
+	return DOCA_SUCCESS;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef FILE_INTEGRITY_MERKLE_H_
+#define FILE_INTEGRITY_MERKLE_H_
+
+#include <stdint.h>
+
+#include <doca_error.h>
+#include <doca_mmap.h>
+#include <doca_sha.h>
+
+#include <samples/common.h>
+
+#include "file_integrity_sha256.h"
+
+/*
+ * Merkle mode of the file integrity application.
+ * The file is split in chunks of a fixed size that are hashed independently, so many SHA tasks run at once and every
+ * chunk can be verified as soon as it is received. The chunk digests are the leaves of a binary tree:
+ *	leaf = SHA256(chunk)
+ *	node = SHA256(0x01 || left || right), a node without a right child is promoted as is
+ *	root = SHA256(0x02 || file size (be64) || chunk size (be32) || top node)
+ * The root binds the file and chunk sizes, so a file cannot be verified with the leaves of another chunking.
+ */
+
+#define MERKLE_DIGEST_SIZE SHA256_DIGEST_SIZE	/* Size of the digests of the tree */
+#define MERKLE_DEFAULT_CHUNK_SIZE (1 << 20)	/* Default chunk size */
+#define MERKLE_MIN_CHUNK_SIZE 4096		/* Smallest chunk size */
+#define MERKLE_MAX_CHUNK_SIZE (1 << 30)		/* Largest chunk size */
+#define MERKLE_DEFAULT_SHA_TASKS 16		/* Default number of SHA tasks in flight */
+#define MERKLE_MAX_SHA_TASKS 1024		/* Largest number of SHA tasks in flight */
+#define MERKLE_HEADER_MAGIC 0x46494d54		/* "FIMT", first field of the Merkle header message */
+#define MERKLE_SESSION_MAGIC 0x46494d53		/* "FIMS", first field of the session header message */
+#define MERKLE_FILE_MAGIC 0x46494d46		/* "FIMF", first field of the file header message of a session */
+#define MERKLE_SESSION_INCREMENTAL (1 << 0)	/* Session flag: the server sends only the chunks it needs */
+#define MERKLE_SESSION_DIRECTORY (1 << 1)	/* Session flag: the files are relative to a directory */
+
+/* SHA backend of the Merkle mode */
+enum merkle_sha_backend {
+	MERKLE_SHA_DOCA,	/* DOCA SHA engine */
+	MERKLE_SHA_SW,		/* Software SHA256 on CPU threads, SHA-NI when available */
+};
+
+/* First message of the client in Merkle mode, followed by the leaves and then the file content */
+struct __attribute__((packed)) merkle_header {
+	uint32_t magic;				/* MERKLE_HEADER_MAGIC, big endian */
+	uint32_t chunk_size;			/* Chunk size, big endian */
+	uint64_t file_size;			/* File size, big endian */
+	uint32_t nb_chunks;			/* Number of chunks and leaves, big endian */
+	uint8_t root[MERKLE_DIGEST_SIZE];	/* Tree root */
+};
+
+/*
+ * First message of the client in a session, used by the incremental and the directory modes.
+ * Every file of the session is then sent as a file header, its leaves, in incremental mode the bitmap of the chunks
+ * the server needs (sent by the server), and the content of the needed chunks.
+ */
+struct __attribute__((packed)) merkle_session_header {
+	uint32_t magic;				/* MERKLE_SESSION_MAGIC, big endian */
+	uint32_t flags;				/* MERKLE_SESSION_* flags, big endian */
+	uint32_t chunk_size;			/* Chunk size of all the files, big endian */
+	uint32_t nb_files;			/* Number of files, big endian */
+};
+
+/* File header message of a session, followed in the same message by the path of the file */
+struct __attribute__((packed)) merkle_file_header {
+	uint32_t magic;				/* MERKLE_FILE_MAGIC, big endian */
+	uint32_t nb_chunks;			/* Number of chunks and leaves, big endian */
+	uint64_t file_size;			/* File size, big endian */
+	uint8_t root[MERKLE_DIGEST_SIZE];	/* Tree root */
+	uint16_t path_len;			/* Path length, relative to the directory, empty out of it, big endian */
+	char path[];				/* Path, not null terminated */
+};
+
+/*
+ * Callback called on every hashed chunk, from the thread that calls the hasher functions
+ *
+ * @chunk_idx [in]: chunk index given to merkle_hasher_submit()
+ * @digest [in]: MERKLE_DIGEST_SIZE bytes chunk digest
+ * @user_ctx [in]: user context given to merkle_hasher_create()
+ */
+typedef void (*merkle_chunk_cb)(uint32_t chunk_idx, const uint8_t *digest, void *user_ctx);
+
+/* Hasher of chunks, with a fixed number of slots of chunks in flight */
+struct merkle_hasher;
+
+/* Merkle hasher configuration */
+struct merkle_hasher_cfg {
+	enum merkle_sha_backend backend;	/* SHA backend */
+	uint32_t nb_slots;			/* Chunks hashed at once, power of 2 for the DOCA backend */
+	uint32_t nb_threads;			/* Software backend threads, 0 to hash in the caller thread */
+	void *region;				/* Memory of all the chunks submitted */
+	size_t region_len;			/* Length of the memory of the chunks */
+	doca_mmap_memrange_free_cb_t *region_free_cb; /* Releases the memory once not used anymore, may be NULL */
+	merkle_chunk_cb chunk_cb;		/* Called on every hashed chunk */
+	void *user_ctx;				/* Context of the callback */
+};
+
+/*
+ * Set the SHA hash task configuration of the DOCA backend, before the SHA context is started
+ *
+ * @sha_ctx [in]: SHA context
+ * @nb_tasks [in]: number of tasks, power of 2
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t merkle_hasher_set_conf(struct doca_sha *sha_ctx, uint32_t nb_tasks);
+
+/*
+ * Create a chunk hasher
+ * The DOCA backend registers the region in the source mmap of the core objects and starts the SHA context, the
+ * region is then released with the mmap
+ *
+ * @cfg [in]: hasher configuration
+ * @state [in]: core objects of the DOCA backend, unused by the software backend
+ * @sha_ctx [in]: SHA context of the DOCA backend, unused by the software backend
+ * @hasher [out]: hasher
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t merkle_hasher_create(const struct merkle_hasher_cfg *cfg, struct program_core_objects *state,
+				  struct doca_sha *sha_ctx, struct merkle_hasher **hasher);
+
+/*
+ * Wait until a slot is free, the chunk callbacks of the chunks hashed meanwhile are called
+ *
+ * @hasher [in]: hasher
+ * @slot [in]: slot index, lower than the number of slots
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR if a chunk failed to be hashed
+ */
+doca_error_t merkle_hasher_wait_slot(struct merkle_hasher *hasher, uint32_t slot);
+
+/*
+ * Hash a chunk in a free slot
+ *
+ * @hasher [in]: hasher
+ * @slot [in]: free slot index
+ * @chunk_idx [in]: chunk index, given back to the chunk callback
+ * @data [in]: chunk, within the region of the hasher, must not change until the slot is free again
+ * @len [in]: chunk length
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t merkle_hasher_submit(struct merkle_hasher *hasher, uint32_t slot, uint32_t chunk_idx, const void *data,
+				  size_t len);
+
+/*
+ * Wait until all the chunks submitted are hashed
+ *
+ * @hasher [in]: hasher
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR if a chunk failed to be hashed
+ */
+doca_error_t merkle_hasher_wait_all(struct merkle_hasher *hasher);
+
+/*
+ * Wait for the chunks in flight and destroy a hasher
+ * The software backend releases the region, the DOCA backend leaves it to the source mmap
+ *
+ * @hasher [in]: hasher
+ */
+void merkle_hasher_destroy(struct merkle_hasher *hasher);
+
+/*
+ * Get the number of chunks of a file
+ *
+ * @file_size [in]: file size
+ * @chunk_size [in]: chunk size
+ * @return: number of chunks, an empty file has one empty chunk
+ */
+uint64_t merkle_nb_chunks(uint64_t file_size, uint32_t chunk_size);
+
+/*
+ * Compute the root of the tree of a file
+ *
+ * @leaves [in]: chunk digests, nb_leaves * MERKLE_DIGEST_SIZE bytes
+ * @nb_leaves [in]: number of chunks
+ * @file_size [in]: file size
+ * @chunk_size [in]: chunk size
+ * @root [out]: MERKLE_DIGEST_SIZE bytes root
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t merkle_root(const uint8_t *leaves, uint32_t nb_leaves, uint64_t file_size, uint32_t chunk_size,
+			 uint8_t *root);
+
+#endif /* FILE_INTEGRITY_MERKLE_H_ */
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA256_HAVE_SHA_NI 1
+#endif
+
+#include "file_integrity_sha256.h"
+
+/* Compresses whole blocks into the hash value */
+typedef void (*sha256_blocks_fn)(uint32_t *state, const uint8_t *data, size_t nb_blocks);
+
+static const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t sha256_h0[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static sha256_blocks_fn sha256_blocks;	/* Implementation in use, resolved on first use */
+static const char *sha256_name;		/* Name of the implementation in use */
+
+/*
+ * Rotate a 32 bits value right
+ *
+ * @x [in]: value
+ * @n [in]: number of bits, between 1 and 31
+ * @return: rotated value
+ */
+static inline uint32_t
+ror32(uint32_t x, unsigned int n)
+{
+	return (x >> n) | (x << (32 - n));
+}
+
+/*
+ * Compress blocks with the portable implementation
+ *
+ * @state [in/out]: hash value
+ * @data [in]: blocks
+ * @nb_blocks [in]: number of blocks
+ */
+static void
+sha256_blocks_generic(uint32_t *state, const uint8_t *data, size_t nb_blocks)
+{
+	uint32_t w[64], a, b, c, d, e, f, g, h, t1, t2;
+	int i;
+
+	for (; nb_blocks > 0; nb_blocks--, data += SHA256_BLOCK_SIZE) {
+		for (i = 0; i < 16; i++)
+			w[i] = (uint32_t)data[4 * i] << 24 | (uint32_t)data[4 * i + 1] << 16 |
+			       (uint32_t)data[4 * i + 2] << 8 | data[4 * i + 3];
+		for (i = 16; i < 64; i++)
+			w[i] = w[i - 16] + (ror32(w[i - 15], 7) ^ ror32(w[i - 15], 18) ^ (w[i - 15] >> 3)) + w[i - 7] +
+			       (ror32(w[i - 2], 17) ^ ror32(w[i - 2], 19) ^ (w[i - 2] >> 10));
+
+		a = state[0];
+		b = state[1];
+		c = state[2];
+		d = state[3];
+		e = state[4];
+		f = state[5];
+		g = state[6];
+		h = state[7];
+		for (i = 0; i < 64; i++) {
+			t1 = h + (ror32(e, 6) ^ ror32(e, 11) ^ ror32(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+			t2 = (ror32(a, 2) ^ ror32(a, 13) ^ ror32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+	}
+}
+
+#ifdef SHA256_HAVE_SHA_NI
+
+/*
+ * Compress blocks with the x86 SHA extensions
+ * The hash value is kept as the ABEF and CDGH register pairs the sha256rnds2 instruction works on
+ *
+ * @state [in/out]: hash value
+ * @data [in]: blocks
+ * @nb_blocks [in]: number of blocks
+ */
+__attribute__((target("sha,sse4.1"))) static void
+sha256_blocks_sha_ni(uint32_t *state, const uint8_t *data, size_t nb_blocks)
+{
+	const __m128i bswap_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i state0, state1, abef_save, cdgh_save, msg, tmp, w[4];
+	int i;
+
+	tmp = _mm_loadu_si128((const __m128i *)&state[0]);
+	state1 = _mm_loadu_si128((const __m128i *)&state[4]);
+	tmp = _mm_shuffle_epi32(tmp, 0xb1);		/* CDAB */
+	state1 = _mm_shuffle_epi32(state1, 0x1b);	/* EFGH */
+	state0 = _mm_alignr_epi8(tmp, state1, 8);	/* ABEF */
+	state1 = _mm_blend_epi16(state1, tmp, 0xf0);	/* CDGH */
+
+	for (; nb_blocks > 0; nb_blocks--, data += SHA256_BLOCK_SIZE) {
+		abef_save = state0;
+		cdgh_save = state1;
+		for (i = 0; i < 4; i++)
+			w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * i)), bswap_mask);
+
+		/* Every iteration runs 4 rounds and schedules the message words of the rounds 16 later */
+#pragma GCC unroll 16
+		for (i = 0; i < 16; i++) {
+			msg = _mm_add_epi32(w[i & 3], _mm_loadu_si128((const __m128i *)&sha256_k[4 * i]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg = _mm_shuffle_epi32(msg, 0x0e);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+			if (i < 12) {
+				tmp = _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4);
+				w[i & 3] = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+				w[i & 3] = _mm_add_epi32(w[i & 3], tmp);
+				w[i & 3] = _mm_sha256msg2_epu32(w[i & 3], w[(i + 3) & 3]);
+			}
+		}
+
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1b);		/* FEBA */
+	state1 = _mm_shuffle_epi32(state1, 0xb1);	/* DCHG */
+	state0 = _mm_blend_epi16(tmp, state1, 0xf0);	/* DCBA */
+	state1 = _mm_alignr_epi8(state1, tmp, 8);	/* HGFE */
+	_mm_storeu_si128((__m128i *)&state[0], state0);
+	_mm_storeu_si128((__m128i *)&state[4], state1);
+}
+
+/*
+ * Check if the CPU supports the x86 SHA extensions and the SSE4.1 instructions used with them
+ *
+ * @return: 1 if supported and 0 otherwise
+ */
+static int
+cpu_has_sha_ni(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0 || (ecx & bit_SSE4_1) == 0)
+		return 0;
+	if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0)
+		return 0;
+	return (ebx & (1U << 29)) != 0;
+}
+
+#endif /* SHA256_HAVE_SHA_NI */
+
+void
+sha256_select_impl(enum sha256_impl impl)
+{
+	sha256_blocks_fn blocks = sha256_blocks_generic;
+	const char *name = "generic";
+
+#ifdef SHA256_HAVE_SHA_NI
+	if (impl != SHA256_IMPL_GENERIC && cpu_has_sha_ni()) {
+		blocks = sha256_blocks_sha_ni;
+		name = "sha-ni";
+	}
+#else
+	(void)impl;
+#endif
+	__atomic_store_n(&sha256_name, name, __ATOMIC_RELAXED);
+	__atomic_store_n(&sha256_blocks, blocks, __ATOMIC_RELEASE);
+}
+
+/*
+ * Get the implementation in use, resolving it on first use
+ *
+ * @return: block compression function
+ */
+static inline sha256_blocks_fn
+get_sha256_blocks(void)
+{
+	sha256_blocks_fn blocks = __atomic_load_n(&sha256_blocks, __ATOMIC_ACQUIRE);
+
+	/* Concurrent first uses resolve the same implementation */
+	if (blocks == NULL) {
+		sha256_select_impl(SHA256_IMPL_AUTO);
+		blocks = __atomic_load_n(&sha256_blocks, __ATOMIC_ACQUIRE);
+	}
+	return blocks;
+}
+
+const char *
+sha256_impl_name(void)
+{
+	get_sha256_blocks();
+	return __atomic_load_n(&sha256_name, __ATOMIC_RELAXED);
+}
+
+void
+sha256_init(struct sha256_ctx *ctx)
+{
+	memcpy(ctx->state, sha256_h0, sizeof(ctx->state));
+	ctx->len = 0;
+	ctx->buf_len = 0;
+}
+
+void
+sha256_update(struct sha256_ctx *ctx, const void *data, size_t len)
+{
+	sha256_blocks_fn blocks = get_sha256_blocks();
+	const uint8_t *p = data;
+	size_t n;
+
+	ctx->len += len;
+	if (ctx->buf_len > 0) {
+		n = SHA256_BLOCK_SIZE - ctx->buf_len;
+		if (n > len)
+			n = len;
+		memcpy(ctx->buf + ctx->buf_len, p, n);
+		ctx->buf_len += n;
+		p += n;
+		len -= n;
+		if (ctx->buf_len < SHA256_BLOCK_SIZE)
+			return;
+		blocks(ctx->state, ctx->buf, 1);
+		ctx->buf_len = 0;
+	}
+	/* Whole blocks are hashed in place */
+	n = len / SHA256_BLOCK_SIZE;
+	if (n > 0) {
+		blocks(ctx->state, p, n);
+		p += n * SHA256_BLOCK_SIZE;
+		len -= n * SHA256_BLOCK_SIZE;
+	}
+	memcpy(ctx->buf, p, len);
+	ctx->buf_len = len;
+}
+
+void
+sha256_final(struct sha256_ctx *ctx, uint8_t *digest)
+{
+	sha256_blocks_fn blocks = get_sha256_blocks();
+	uint64_t bits = ctx->len * 8;
+	int i;
+
+	/* Padding: a one bit, zeros up to 8 bytes before the end of a block, then the length in bits */
+	ctx->buf[ctx->buf_len++] = 0x80;
+	if (ctx->buf_len > SHA256_BLOCK_SIZE - 8) {
+		memset(ctx->buf + ctx->buf_len, 0, SHA256_BLOCK_SIZE - ctx->buf_len);
+		blocks(ctx->state, ctx->buf, 1);
+		ctx->buf_len = 0;
+	}
+	memset(ctx->buf + ctx->buf_len, 0, SHA256_BLOCK_SIZE - 8 - ctx->buf_len);
+	for (i = 0; i < 8; i++)
+		ctx->buf[SHA256_BLOCK_SIZE - 1 - i] = bits >> (8 * i);
+	blocks(ctx->state, ctx->buf, 1);
+
+	for (i = 0; i < 8; i++) {
+		digest[4 * i] = ctx->state[i] >> 24;
+		digest[4 * i + 1] = ctx->state[i] >> 16;
+		digest[4 * i + 2] = ctx->state[i] >> 8;
+		digest[4 * i + 3] = ctx->state[i];
+	}
+}
+
+void
+sha256_digest(const void *data, size_t len, uint8_t *digest)
+{
+	struct sha256_ctx ctx;
+
+	sha256_init(&ctx);
+	sha256_update(&ctx, data, len);
+	sha256_final(&ctx, digest);
+}
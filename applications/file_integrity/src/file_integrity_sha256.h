@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef FILE_INTEGRITY_SHA256_H_
+#define FILE_INTEGRITY_SHA256_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_DIGEST_SIZE 32	/* Size of a SHA256 digest */
+#define SHA256_BLOCK_SIZE 64	/* Size of a SHA256 block */
+
+/* Software SHA256 implementations */
+enum sha256_impl {
+	SHA256_IMPL_AUTO,	/* The fastest implementation the CPU supports */
+	SHA256_IMPL_GENERIC,	/* Portable C implementation */
+	SHA256_IMPL_SHA_NI,	/* x86 SHA extensions, only if the CPU supports them */
+};
+
+/* Software SHA256 streaming context */
+struct sha256_ctx {
+	uint32_t state[8];			/* Intermediate hash value */
+	uint64_t len;				/* Bytes hashed so far */
+	uint8_t buf[SHA256_BLOCK_SIZE];		/* Partial block */
+	size_t buf_len;				/* Bytes in the partial block */
+};
+
+/*
+ * Select the software SHA256 implementation of the process, e.g. to compare them
+ * Should be called before any hashing starts
+ *
+ * @impl [in]: implementation, SHA256_IMPL_SHA_NI falls back to the generic one if the CPU does not support it
+ */
+void sha256_select_impl(enum sha256_impl impl);
+
+/*
+ * Get the name of the software SHA256 implementation in use
+ *
+ * @return: implementation name
+ */
+const char *sha256_impl_name(void);
+
+/*
+ * Start a SHA256 computation
+ *
+ * @ctx [out]: context
+ */
+void sha256_init(struct sha256_ctx *ctx);
+
+/*
+ * Hash data
+ *
+ * @ctx [in/out]: context
+ * @data [in]: data
+ * @len [in]: data length
+ */
+void sha256_update(struct sha256_ctx *ctx, const void *data, size_t len);
+
+/*
+ * End a SHA256 computation
+ *
+ * @ctx [in/out]: context, should be initialized again to be reused
+ * @digest [out]: SHA256_DIGEST_SIZE bytes digest
+ */
+void sha256_final(struct sha256_ctx *ctx, uint8_t *digest);
+
+/*
+ * Compute the SHA256 of a buffer
+ *
+ * @data [in]: data
+ * @len [in]: data length
+ * @digest [out]: SHA256_DIGEST_SIZE bytes digest
+ */
+void sha256_digest(const void *data, size_t len, uint8_t *digest);
+
+#endif /* FILE_INTEGRITY_SHA256_H_ */
@@ -130,6 +130,14 @@ main(int argc, char **argv)
 			sleep(1);
 	} else if (firewall_cfg.mode == FIREWALL_MODE_INTERACTIVE) {
 		register_actions_on_flow_parser();
+		if (firewall_cfg.has_cli_rules) {
+			result = flow_parser_load_rules(firewall_cfg.cli_rules_path, true, DROP_ENTRIES_BATCH_SIZE);
+			if (result != DOCA_SUCCESS) {
+				DOCA_LOG_ERR("Failed to load CLI rules file");
+				exit_status = EXIT_FAILURE;
+				goto ports_destroy;
+			}
+		}
 		result = flow_parser_init("FIREWALL>> ", true);
 		if (result != DOCA_SUCCESS) {
 			DOCA_LOG_ERR("Failed to open CLI");
@@ -30,6 +30,8 @@ DOCA_LOG_REGISTER(FIREWALL_CORE);
 #define NB_PORTS 2			/* number of ports */
 
 static struct port_pipe_ids fw_ports_pipes_ids[NB_PORTS];
+static uint64_t pending_entry_ids[NB_PORTS][DROP_ENTRIES_BATCH_SIZE]; /* CLI entries added and not yet processed */
+static int nb_pending_entries[NB_PORTS];			      /* Number of pending CLI entries per port */
 
 /*
  * ARGP Callback - Handle running mode parameter
@@ -82,6 +84,32 @@ firewall_rules_callback(void *param, void *config)
 	return DOCA_SUCCESS;
 }
 
+/*
+ * ARGP Callback - Handle CLI rules file parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+firewall_cli_rules_callback(void *param, void *config)
+{
+	struct firewall_cfg *firewall_cfg = (struct firewall_cfg *)config;
+	const char *cli_rules_path = (char *)param;
+
+	if (strnlen(cli_rules_path, MAX_FILE_NAME) == MAX_FILE_NAME) {
+		DOCA_LOG_ERR("CLI rules file name is too long - MAX=%d", MAX_FILE_NAME - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (access(cli_rules_path, F_OK) == -1) {
+		DOCA_LOG_ERR("CLI rules file was not found %s", cli_rules_path);
+		return DOCA_ERROR_NOT_FOUND;
+	}
+	strlcpy(firewall_cfg->cli_rules_path, cli_rules_path, MAX_FILE_NAME);
+	firewall_cfg->has_cli_rules = true;
+	return DOCA_SUCCESS;
+}
+
 /*
  * ARGP validation Callback - check if there is an input file in static mode
  *
@@ -97,6 +125,10 @@ firewall_args_validation_callback(void *config)
 		DOCA_LOG_ERR("Missing rules file path for static mode");
 		return DOCA_ERROR_INVALID_VALUE;
 	}
+	if (firewall_cfg->mode != FIREWALL_MODE_INTERACTIVE && firewall_cfg->has_cli_rules) {
+		DOCA_LOG_ERR("CLI rules file is supported in interactive mode only");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
 	return DOCA_SUCCESS;
 }
 
@@ -104,7 +136,7 @@ doca_error_t
 register_firewall_params(void)
 {
 	doca_error_t result;
-	struct doca_argp_param *mode_param,  *rules_param;
+	struct doca_argp_param *mode_param,  *rules_param, *cli_rules_param;
 
 	/* Create and register firewall running mode param */
 	result = doca_argp_param_create(&mode_param);
@@ -142,6 +174,23 @@ register_firewall_params(void)
 		return result;
 	}
 
+	/* Create and register CLI rules file param */
+	result = doca_argp_param_create(&cli_rules_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(cli_rules_param, "cli-rules");
+	doca_argp_param_set_arguments(cli_rules_param, "<path>");
+	doca_argp_param_set_description(cli_rules_param, "Path to a file of CLI commands to run before opening the CLI");
+	doca_argp_param_set_callback(cli_rules_param, firewall_cli_rules_callback);
+	doca_argp_param_set_type(cli_rules_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(cli_rules_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
 	/* Register version callback for DOCA SDK & RUNTIME */
 	result = doca_argp_register_version_callback(sdk_version_callback);
 	if (result != DOCA_SUCCESS) {
@@ -558,6 +607,46 @@ build_drop_pipe(uint16_t port_id, uint64_t next_pipe_id, uint64_t *pipe_id)
 	return DOCA_SUCCESS;
 }
 
+/*
+ * Process added entries and check their status
+ *
+ * @port_id [in]: port ID for which process entries should be called
+ * @entry_ids [in]: IDs of the added entries
+ * @nb_entries [in]: number of added entries
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise.
+ */
+static doca_error_t
+process_entries(uint16_t port_id, uint64_t *entry_ids, int nb_entries)
+{
+	enum doca_flow_entry_status status;
+	int processed, total_processed = 0;
+	doca_error_t result;
+	int i;
+
+	while (total_processed < nb_entries) {
+		result = doca_flow_grpc_entries_process(port_id, 0, DEFAULT_TIMEOUT_US, nb_entries - total_processed,
+							&processed);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Entry process function failed with error");
+			return result;
+		}
+		if (processed == 0) {
+			DOCA_LOG_ERR("Timed out processing %d entries", nb_entries - total_processed);
+			return DOCA_ERROR_TIME_OUT;
+		}
+		total_processed += processed;
+	}
+
+	for (i = 0; i < nb_entries; i++) {
+		result = doca_flow_grpc_pipe_entry_get_status(entry_ids[i], &status);
+		if (result != DOCA_SUCCESS || status != DOCA_FLOW_ENTRY_STATUS_SUCCESS) {
+			DOCA_LOG_ERR("Failed to process entry %" PRIu64, entry_ids[i]);
+			return DOCA_ERROR_BAD_STATE;
+		}
+	}
+	return DOCA_SUCCESS;
+}
+
 /*
  * Add the entries to the drop pipes according to the json file rules.
  *
@@ -575,10 +664,9 @@ add_drop_entries(uint16_t port_id, uint64_t transport_pipe_id, struct rule_match
 	struct doca_flow_fwd fwd;
 	struct doca_flow_actions actions;
 	doca_error_t result;
-	uint64_t entry_id;
-	int i;
-	enum doca_flow_entry_status status;
-	int processed, num_of_entries = 1;
+	uint64_t entry_ids[DROP_ENTRIES_BATCH_SIZE];
+	uint32_t flags;
+	int i, j, nb_batch;
 
 	memset(&match, 0, sizeof(match));
 	memset(&actions, 0, sizeof(actions));
@@ -587,32 +675,30 @@ add_drop_entries(uint16_t port_id, uint64_t transport_pipe_id, struct rule_match
 	fwd.type = DOCA_FLOW_FWD_DROP;
 	client_fwd.fwd = &fwd;
 
-	for (i = 0; i < n_rules; i++) {
-		match.outer.l4_type_ext = drop_rules[i].protocol;
-		match.outer.ip4.dst_ip = drop_rules[i].dst_ip;
-		match.outer.ip4.src_ip = drop_rules[i].src_ip;
-		match.outer.transport.src_port = rte_cpu_to_be_16(drop_rules[i].dst_port);
-		match.outer.transport.dst_port = rte_cpu_to_be_16(drop_rules[i].src_port);
-
-		/* add entry to drop pipe*/
-		result = doca_flow_grpc_pipe_add_entry(0, transport_pipe_id, &match, &actions, NULL,
-							&client_fwd, DOCA_FLOW_NO_WAIT, &entry_id);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Failed to add entry: %s", doca_error_get_descr(result));
-			return result;
+	/* The rules are added in batches, so a batch is pushed and processed once instead of once per rule */
+	for (i = 0; i < n_rules; i += nb_batch) {
+		nb_batch = n_rules - i < DROP_ENTRIES_BATCH_SIZE ? n_rules - i : DROP_ENTRIES_BATCH_SIZE;
+
+		for (j = 0; j < nb_batch; j++) {
+			match.outer.l4_type_ext = drop_rules[i + j].protocol;
+			match.outer.ip4.dst_ip = drop_rules[i + j].dst_ip;
+			match.outer.ip4.src_ip = drop_rules[i + j].src_ip;
+			match.outer.transport.src_port = rte_cpu_to_be_16(drop_rules[i + j].dst_port);
+			match.outer.transport.dst_port = rte_cpu_to_be_16(drop_rules[i + j].src_port);
+
+			/* add entry to drop pipe, the last entry of the batch pushes the whole batch */
+			flags = (j == nb_batch - 1) ? DOCA_FLOW_NO_WAIT : DOCA_FLOW_WAIT_FOR_BATCH;
+			result = doca_flow_grpc_pipe_add_entry(0, transport_pipe_id, &match, &actions, NULL,
+								&client_fwd, flags, &entry_ids[j]);
+			if (result != DOCA_SUCCESS) {
+				DOCA_LOG_ERR("Failed to add entry: %s", doca_error_get_descr(result));
+				return result;
+			}
 		}
 
-		result = doca_flow_grpc_entries_process(port_id, 0, DEFAULT_TIMEOUT_US, num_of_entries, &processed);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Entry process function failed with error");
+		result = process_entries(port_id, entry_ids, nb_batch);
+		if (result != DOCA_SUCCESS)
 			return result;
-		}
-
-		result = doca_flow_grpc_pipe_entry_get_status(entry_id, &status);
-		if (result != DOCA_SUCCESS || status != DOCA_FLOW_ENTRY_STATUS_SUCCESS) {
-			DOCA_LOG_ERR("Failed to process entry");
-			return DOCA_ERROR_BAD_STATE;
-		}
 	}
 	return DOCA_SUCCESS;
 }
@@ -622,34 +708,45 @@ add_drop_entries(uint16_t port_id, uint64_t transport_pipe_id, struct rule_match
  *
  * @port_id [in]: port ID of the entry; should use it upon calling process entries
  * @match [in]: pointer to match, indicates a specific packet match information
+ * @flags [in]: DOCA_FLOW_WAIT_FOR_BATCH to keep the entry pending until an entry added with DOCA_FLOW_NO_WAIT
  */
 static void
-pipe_add_entry(uint16_t port_id, struct doca_flow_match *match)
+pipe_add_entry(uint16_t port_id, struct doca_flow_match *match, uint32_t flags)
 {
 	uint64_t entry_id;
 	doca_error_t result;
-	enum doca_flow_entry_status status;
-	int processed, num_of_entries = 1;
 	uint16_t pipe_queue = 0;
+	int nb_pending;
 
-	result = doca_flow_grpc_pipe_add_entry(pipe_queue, fw_ports_pipes_ids[port_id].transport_pipe_id, match, NULL, NULL, NULL, 0, &entry_id);
-	if (result != DOCA_SUCCESS)
+	if (port_id >= NB_PORTS) {
+		DOCA_LOG_ERR("Invalid port id %u", port_id);
+		return;
+	}
+
+	/* A full batch is pushed even if more entries are on the way */
+	nb_pending = nb_pending_entries[port_id];
+	if (nb_pending == DROP_ENTRIES_BATCH_SIZE - 1)
+		flags = DOCA_FLOW_NO_WAIT;
+
+	result = doca_flow_grpc_pipe_add_entry(pipe_queue, fw_ports_pipes_ids[port_id].transport_pipe_id, match, NULL,
+						NULL, NULL, flags, &entry_id);
+	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to add entry: %s", doca_error_get_descr(result));
-	else {
+		/* Entries already waiting for this batch are processed without it */
+		flags = DOCA_FLOW_NO_WAIT;
+	} else {
+		pending_entry_ids[port_id][nb_pending++] = entry_id;
+		nb_pending_entries[port_id] = nb_pending;
 		DOCA_LOG_INFO("Entry created successfully, entry id: %" PRIu64, entry_id);
 		/* Add an additional new line for output readability */
 		DOCA_LOG_INFO("");
 	}
 
-	result = doca_flow_grpc_entries_process(0, port_id, DEFAULT_TIMEOUT_US, num_of_entries, &processed);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Entry process function failed with error");
+	if (flags != DOCA_FLOW_NO_WAIT || nb_pending == 0)
 		return;
-	}
 
-	result = doca_flow_grpc_pipe_entry_get_status(entry_id, &status);
-	if (result != DOCA_SUCCESS || status != DOCA_FLOW_ENTRY_STATUS_SUCCESS)
-		DOCA_LOG_ERR("Failed to process entry");
+	nb_pending_entries[port_id] = 0;
+	process_entries(port_id, pending_entry_ids[port_id], nb_pending);
 }
 
 /*
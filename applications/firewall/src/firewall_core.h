@@ -25,6 +25,7 @@ extern "C" {
 #endif
 
 #define MAX_FILE_NAME 255	/* Maximum file name length */
+#define DROP_ENTRIES_BATCH_SIZE 64	/* drop entries added before they are processed, below the default queue depth */
 
 /* Firewall running mode */
 enum firewall_running_mode {
@@ -38,6 +39,8 @@ struct firewall_cfg {
 	enum firewall_running_mode mode;	/* Application running mode */
 	char json_path[MAX_FILE_NAME];		/* Path to the JSON file with 5-tuple rules to drop */
 	bool has_json;				/* true when a json file path was given */
+	char cli_rules_path[MAX_FILE_NAME];	/* Path to a file of CLI commands to run in interactive mode */
+	bool has_cli_rules;			/* true when a CLI rules file path was given */
 };
 
 /* rule 5 tuple match struct */
@@ -28,6 +28,19 @@
 #define L2_SQ_IDX_MASK ((1 << (L2_LOG_SQ_RING_DEPTH + LOG_SQE_NUM_SEGS)) - 1)
 #define L2_DATA_IDX_MASK ((1 << (L2_LOG_SQ_RING_DEPTH)) - 1)
 
+/* Number of CQEs the device handles before ringing the doorbells once for all of them */
+#define L2_BATCH_SIZE_DEFAULT 32
+#define L2_MAX_BATCH_SIZE (1 << L2_LOG_RQ_RING_DEPTH)
+
+/* Maximal number of device threads, each one runs the event handler of its own RQ/SQ/CQs set */
+#define L2_MAX_THREADS 64
+
+/* RSS indirection table entries, filled with the RQs in a round robin so that every RQ gets within one entry of the
+ * others whatever the number of threads
+ */
+#define L2_LOG_RSS_RQT_SIZE 7
+#define L2_RSS_RQT_SIZE (1 << L2_LOG_RSS_RQT_SIZE)
+
 struct app_transfer_cq {
 	uint32_t cq_num;
 	uint32_t log_cq_depth;
@@ -50,6 +63,9 @@ struct l2_reflector_data {
 	struct app_transfer_wq rq_data;	/* device RQ */
 	struct app_transfer_cq sq_cq_data; /* device SQ's CQ */
 	struct app_transfer_wq sq_data;	/* device SQ */
+	uint32_t batch_size;		/* Maximal number of packets handled per doorbell */
+	uint32_t zero_copy;		/* Send the packets from the RQ buffers instead of copying them to the SQ buffers */
+	uint32_t thread_idx;		/* Index of the queue set, the argument of its event handler */
 } __attribute__((__packed__, aligned(8)));
 
 #endif
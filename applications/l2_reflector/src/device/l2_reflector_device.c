@@ -40,6 +40,8 @@ struct rq_ctx_t {
 	uint32_t rq_number;				/* RQ number */
 	struct flexio_dev_wqe_rcv_data_seg *rq_ring;	/* WQEs buffer */
 	uint32_t *rq_dbr;				/* RQ doorbell record */
+	uint32_t rq_pi;					/* RQ producer index */
+	uint32_t lkey;					/* RQ data memory key */
 };
 
 /* SQ Context */
@@ -49,6 +51,7 @@ struct sq_ctx_t {
 	union flexio_dev_sqe_seg *sq_ring;	/* SQEs buffer */
 	uint32_t *sq_dbr;			/* SQ doorbell record */
 	uint32_t sq_pi;				/* SQ producer index */
+	uint32_t sq_ci;				/* SQ consumer index, the WQEs before it were sent */
 };
 
 /* SQ data buffer */
@@ -57,8 +60,8 @@ struct dt_ctx_t {
 	uint32_t tx_buff_idx;	/* TX buffer index */
 };
 
-/* Device context */
-static struct {
+/* Device context of a queue set, one per thread, aligned to not share cache lines between threads */
+struct dev_ctx_t {
 	uint32_t lkey;			/* Local memory key */
 	uint32_t is_initalized;		/* Initialization flag */
 	struct cq_ctx_t rqcq_ctx;	/* RQ CQ context */
@@ -66,8 +69,12 @@ static struct {
 	struct rq_ctx_t rq_ctx;		/* RQ context */
 	struct sq_ctx_t sq_ctx;		/* SQ context */
 	struct dt_ctx_t dt_ctx;		/* DT context */
+	uint32_t batch_size;		/* Maximal number of packets handled per doorbell */
+	uint32_t zero_copy;		/* Send the packets from the RQ buffers */
 	uint32_t packets_count;		/* Number of processed packets */
-} dev_ctx = {0};
+} __attribute__((aligned(64)));
+
+static struct dev_ctx_t dev_ctxs[L2_MAX_THREADS] = {0};
 
 /*
  * Initialize the CQ context
@@ -99,6 +106,10 @@ init_rq(const struct app_transfer_wq app_rq, struct rq_ctx_t *ctx)
 	ctx->rq_number = app_rq.wq_num;
 	ctx->rq_ring = (struct flexio_dev_wqe_rcv_data_seg *)app_rq.wq_ring_daddr;
 	ctx->rq_dbr = (uint32_t *)app_rq.wq_dbr_daddr;
+	ctx->lkey = app_rq.wqd_mkey_id;
+
+	/* The host posts all the RQ WQEs */
+	ctx->rq_pi = 1 << L2_LOG_RQ_RING_DEPTH;
 }
 
 /*
@@ -115,6 +126,8 @@ init_sq(const struct app_transfer_wq app_sq, struct sq_ctx_t *ctx)
 	ctx->sq_dbr = (uint32_t *)app_sq.wq_dbr_daddr;
 
 	ctx->sq_wqe_seg_idx = 0;
+	ctx->sq_pi = 0;
+	ctx->sq_ci = 0;
 	ctx->sq_dbr++;
 }
 
@@ -152,6 +165,7 @@ get_next_sqe(struct sq_ctx_t *sq_ctx, uint32_t sq_idx_mask)
  * Increase consumer index of the CQ,
  * Once a CQE is polled, the consumer index is increased.
  * Upon completing a CQ epoch, the HW owner bit is flipped.
+ * The CQ doorbell record is not updated, see update_cq_dbr().
  *
  * @cq_ctx [in]: CQ context
  * @cq_idx_mask [in]: CQ index mask which indicates when the CQ is full
@@ -164,127 +178,271 @@ step_cq(struct cq_ctx_t *cq_ctx, uint32_t cq_idx_mask)
 	/* check for wrap around */
 	if (!(cq_ctx->cq_idx & cq_idx_mask))
 		cq_ctx->cq_hw_owner_bit = !cq_ctx->cq_hw_owner_bit;
+}
 
+/*
+ * Give the polled CQEs back to the HW by writing the consumer index to the CQ doorbell record
+ *
+ * @cq_ctx [in]: CQ context
+ */
+static void
+update_cq_dbr(struct cq_ctx_t *cq_ctx)
+{
 	__dpa_thread_fence(__DPA_MEMORY, __DPA_W, __DPA_W);
 	flexio_dev_dbr_cq_set_ci(cq_ctx->cq_dbr, cq_ctx->cq_idx);
 }
 
 /*
- * This is the main function of the L2 reflector device, called on each packet from l2_reflector_device_event_handler()
- * Packet are received from the RQ, processed by changing MAC addresses and transmitted to the SQ.
+ * Give RQ WQEs back to the HW by writing the producer index to the RQ doorbell record.
+ * This is flexio_dev_dbr_rq_inc_pi() for several WQEs at once, the record holds a big endian 16 bits counter.
  *
- * @dtctx [in]: This thread context
+ * @rq_ctx [in]: RQ context
+ * @nb_wqes [in]: Number of WQEs to give back
+ */
+static void
+post_rq_wqes(struct rq_ctx_t *rq_ctx, uint32_t nb_wqes)
+{
+	rq_ctx->rq_pi += nb_wqes;
+	__dpa_thread_fence(__DPA_MEMORY, __DPA_W, __DPA_W);
+	*rq_ctx->rq_dbr = __builtin_bswap32(rq_ctx->rq_pi & 0xffff);
+}
+
+/*
+ * Swap the destination and source MAC addresses of a packet
+ *
+ * @data [in]: Packet data
  */
 static void
-process_packet(struct flexio_dev_thread_ctx *dtctx)
+swap_macs(char *data)
+{
+	char tmp;
+	/* MAC address has 6 bytes: ff:ff:ff:ff:ff:ff */
+	const int nb_mac_address_bytes = 6;
+
+	for (int byte = 0; byte < nb_mac_address_bytes; byte++) {
+		tmp = data[byte];
+		data[byte] = data[byte + nb_mac_address_bytes];
+		/* dst and src MACs are aligned one after the other in the ether header */
+		data[byte + nb_mac_address_bytes] = tmp;
+	}
+}
+
+/*
+ * This is the main function of the L2 reflector device, called on each packet from l2_reflector_device_event_handler()
+ * Packet are received from the RQ, processed by changing MAC addresses and posted to the SQ.
+ * The SQ doorbell is not rung, see ring_doorbells().
+ *
+ * @ctx [in]: Device context of the queue set
+ * @return: The first segment (control) of the posted SQ WQE
+ */
+static union flexio_dev_sqe_seg *
+process_packet(struct dev_ctx_t *ctx)
 {
 	uint32_t rq_wqe_idx;
 	struct flexio_dev_wqe_rcv_data_seg *rwqe;
 	uint32_t data_sz;
 	char *rq_data;
 	char *sq_data;
-	union flexio_dev_sqe_seg *swqe;
+	uint32_t lkey;
+	union flexio_dev_sqe_seg *swqe, *ctrl;
 	const uint16_t mss = 0, checksum = 0;
-	char tmp;
-	/* MAC address has 6 bytes: ff:ff:ff:ff:ff:ff */
-	const int nb_mac_address_bytes = 6;
-
 
 	/* Extract relevant data from CQE */
-	rq_wqe_idx = flexio_dev_cqe_get_wqe_counter(dev_ctx.rqcq_ctx.cqe);
-	data_sz = flexio_dev_cqe_get_byte_cnt(dev_ctx.rqcq_ctx.cqe);
+	rq_wqe_idx = flexio_dev_cqe_get_wqe_counter(ctx->rqcq_ctx.cqe);
+	data_sz = flexio_dev_cqe_get_byte_cnt(ctx->rqcq_ctx.cqe);
 
 	/* Get RQ WQE pointed by CQE */
-	rwqe = &dev_ctx.rq_ctx.rq_ring[rq_wqe_idx & L2_RQ_IDX_MASK];
+	rwqe = &ctx->rq_ctx.rq_ring[rq_wqe_idx & L2_RQ_IDX_MASK];
 
 	/* Extract data (whole packet) pointed by RQ WQE */
 	rq_data = flexio_dev_rwqe_get_addr(rwqe);
 
-	/* Take next entry from data ring */
-	sq_data = get_next_dte(&dev_ctx.dt_ctx, L2_DATA_IDX_MASK, L2_LOG_WQ_DATA_ENTRY_BSIZE);
-
-	/* Copy received packet to sq_data as is */
-	memcpy(sq_data, rq_data, data_sz);
-
-	/* swap mac addresses */
-	for (int byte = 0; byte < nb_mac_address_bytes; byte++) {
-		tmp = sq_data[byte];
-		sq_data[byte] = sq_data[byte + nb_mac_address_bytes];
-		/* dst and src MACs are aligned one after the other in the ether header */
-		sq_data[byte + nb_mac_address_bytes] = tmp;
+	if (ctx->zero_copy) {
+		/* Send the packet from the RQ buffer, the RQ WQE is given back once the send completes */
+		sq_data = rq_data;
+		lkey = ctx->rq_ctx.lkey;
+	} else {
+		/* Take next entry from data ring */
+		sq_data = get_next_dte(&ctx->dt_ctx, L2_DATA_IDX_MASK, L2_LOG_WQ_DATA_ENTRY_BSIZE);
+
+		/* Copy received packet to sq_data as is */
+		memcpy(sq_data, rq_data, data_sz);
+		lkey = ctx->lkey;
 	}
 
+	swap_macs(sq_data);
+
 	/* Take first segment for SQ WQE (3 segments will be used) */
-	swqe = get_next_sqe(&dev_ctx.sq_ctx, L2_SQ_IDX_MASK);
+	ctrl = get_next_sqe(&ctx->sq_ctx, L2_SQ_IDX_MASK);
 
 	/* Fill out 1-st segment (Control) */
-	flexio_dev_swqe_seg_ctrl_set(swqe, dev_ctx.sq_ctx.sq_pi, dev_ctx.sq_ctx.sq_number,
+	flexio_dev_swqe_seg_ctrl_set(ctrl, ctx->sq_ctx.sq_pi, ctx->sq_ctx.sq_number,
 				     MLX5_CTRL_SEG_CE_CQE_ON_CQE_ERROR, FLEXIO_CTRL_SEG_SEND_EN);
 
 	/* Fill out 2-nd segment (Ethernet) */
-	swqe = get_next_sqe(&dev_ctx.sq_ctx, L2_SQ_IDX_MASK);
+	swqe = get_next_sqe(&ctx->sq_ctx, L2_SQ_IDX_MASK);
 	flexio_dev_swqe_seg_eth_set(swqe, mss, checksum, 0, NULL);
 
 	/* Fill out 3-rd segment (Data) */
-	swqe = get_next_sqe(&dev_ctx.sq_ctx, L2_SQ_IDX_MASK);
-	flexio_dev_swqe_seg_mem_ptr_data_set(swqe, data_sz, dev_ctx.lkey, (uint64_t)sq_data);
+	swqe = get_next_sqe(&ctx->sq_ctx, L2_SQ_IDX_MASK);
+	flexio_dev_swqe_seg_mem_ptr_data_set(swqe, data_sz, lkey, (uint64_t)sq_data);
 
 	/* Send WQE is 4 WQEBBs need to skip the 4-th segment */
-	swqe = get_next_sqe(&dev_ctx.sq_ctx, L2_SQ_IDX_MASK);
+	swqe = get_next_sqe(&ctx->sq_ctx, L2_SQ_IDX_MASK);
+
+	ctx->sq_ctx.sq_pi++;
+	return ctrl;
+}
+
+/*
+ * Ring the doorbells once for a batch of processed packets: send all the posted SQ WQEs, give the polled RQ CQEs
+ * back and, when copying, the RQ WQEs too.
+ * In zero copy mode the last WQE of the batch requests a CQE, the RQ WQEs are given back by
+ * release_sent_rq_wqes() once it is seen, as sends complete in order.
+ *
+ * @ctx [in]: Device context of the queue set
+ * @dtctx [in]: This thread context
+ * @last_ctrl [in]: Control segment of the last posted SQ WQE
+ * @nb_packets [in]: Number of packets in the batch
+ */
+static void
+ring_doorbells(struct dev_ctx_t *ctx, struct flexio_dev_thread_ctx *dtctx, union flexio_dev_sqe_seg *last_ctrl, uint32_t nb_packets)
+{
+	if (ctx->zero_copy)
+		flexio_dev_swqe_seg_ctrl_set(last_ctrl, ctx->sq_ctx.sq_pi - 1, ctx->sq_ctx.sq_number,
+					     MLX5_CTRL_SEG_CE_CQE_ALWAYS, FLEXIO_CTRL_SEG_SEND_EN);
 
 	/* Ring DB */
 	__dpa_thread_fence(__DPA_MEMORY, __DPA_W, __DPA_W);
-	dev_ctx.sq_ctx.sq_pi++;
-	flexio_dev_qp_sq_ring_db(dtctx, dev_ctx.sq_ctx.sq_pi, dev_ctx.sq_ctx.sq_number);
-	__dpa_thread_fence(__DPA_MEMORY, __DPA_W, __DPA_W);
-	flexio_dev_dbr_rq_inc_pi(dev_ctx.rq_ctx.rq_dbr);
+	flexio_dev_qp_sq_ring_db(dtctx, ctx->sq_ctx.sq_pi, ctx->sq_ctx.sq_number);
+	update_cq_dbr(&ctx->rqcq_ctx);
+	if (!ctx->zero_copy)
+		post_rq_wqes(&ctx->rq_ctx, nb_packets);
+
+	ctx->packets_count += nb_packets;
 }
 
 /*
- * Called by host to initialize the device context
+ * Poll the SQ CQ and give back the RQ WQEs of the packets that were sent (zero copy mode).
+ * Packets are received and sent in the same order, so the RQ WQEs are released in order as well.
+ *
+ * @ctx [in]: Device context of the queue set
+ */
+static void
+release_sent_rq_wqes(struct dev_ctx_t *ctx)
+{
+	uint32_t sent = 0, completed;
+	uint16_t wqe_counter;
+
+	while (flexio_dev_cqe_get_owner(ctx->sqcq_ctx.cqe) != ctx->sqcq_ctx.cq_hw_owner_bit) {
+		__dpa_thread_fence(__DPA_MEMORY, __DPA_R, __DPA_R);
+		/* The CQE completes its WQE and all the WQEs posted before it, the counter has 16 bits */
+		wqe_counter = flexio_dev_cqe_get_wqe_counter(ctx->sqcq_ctx.cqe);
+		completed = (uint16_t)(wqe_counter + 1 - ctx->sq_ctx.sq_ci);
+		ctx->sq_ctx.sq_ci += completed;
+		sent += completed;
+		step_cq(&ctx->sqcq_ctx, L2_CQ_IDX_MASK);
+	}
+	if (sent == 0)
+		return;
+
+	update_cq_dbr(&ctx->sqcq_ctx);
+	post_rq_wqes(&ctx->rq_ctx, sent);
+}
+
+/*
+ * Called by host to initialize the device context of a queue set
  *
  * @data [in]: pointer to the device context from the host
- * @return: This function always returns 0
+ * @return: 0 on success and -1 if the queue set index is out of range
  */
 __dpa_rpc__ uint64_t
 l2_reflector_device_init(uint64_t data)
 {
 	struct l2_reflector_data *shared_data = (struct l2_reflector_data *)data;
+	struct dev_ctx_t *ctx;
+
+	if (shared_data->thread_idx >= L2_MAX_THREADS)
+		return -1;
+	ctx = &dev_ctxs[shared_data->thread_idx];
+
+	ctx->lkey = shared_data->sq_data.wqd_mkey_id;
+	ctx->batch_size = shared_data->batch_size;
+	if (ctx->batch_size == 0 || ctx->batch_size > L2_MAX_BATCH_SIZE)
+		ctx->batch_size = L2_BATCH_SIZE_DEFAULT;
+	ctx->zero_copy = shared_data->zero_copy;
+	init_cq(shared_data->rq_cq_data, &ctx->rqcq_ctx);
+	init_rq(shared_data->rq_data, &ctx->rq_ctx);
+	init_cq(shared_data->sq_cq_data, &ctx->sqcq_ctx);
+	init_sq(shared_data->sq_data, &ctx->sq_ctx);
+
+	ctx->dt_ctx.sq_tx_buff = (void *)shared_data->sq_data.wqd_daddr;
+	ctx->dt_ctx.tx_buff_idx = 0;
+
+	ctx->packets_count = 0;
+	ctx->is_initalized = 1;
+	return 0;
+}
 
-	dev_ctx.lkey = shared_data->sq_data.wqd_mkey_id;
-	init_cq(shared_data->rq_cq_data, &dev_ctx.rqcq_ctx);
-	init_rq(shared_data->rq_data, &dev_ctx.rq_ctx);
-	init_cq(shared_data->sq_cq_data, &dev_ctx.sqcq_ctx);
-	init_sq(shared_data->sq_data, &dev_ctx.sq_ctx);
-
-	dev_ctx.dt_ctx.sq_tx_buff = (void *)shared_data->sq_data.wqd_daddr;
-	dev_ctx.dt_ctx.tx_buff_idx = 0;
+/*
+ * Called by host to read the number of reflected packets
+ *
+ * @arg [in]: Unused
+ * @return: Number of packets sent by all the threads since the initialization, wraps around at 32 bits
+ */
+__dpa_rpc__ uint64_t
+l2_reflector_device_packets_count(uint64_t __unused arg)
+{
+	uint32_t packets_count = 0;
 
-	dev_ctx.is_initalized = 1;
-	return 0;
+	for (int i = 0; i < L2_MAX_THREADS; i++)
+		packets_count += dev_ctxs[i].packets_count;
+	return packets_count;
 }
 
 /*
- * This function is called when a new packet is received to RQ's CQ.
- * Upon receiving a packet, the function will iterate over all received packets and process them.
- * Once all packets in the CQ are processed, the CQ will be rearmed to receive new packets events.
+ * This function is called when a new packet is received to RQ's CQ, or in zero copy mode when sends complete.
+ * Upon receiving a packet, the function will iterate over all received packets and process them in batches of up
+ * to batch_size packets, ringing the doorbells once per batch.
+ * Once all packets in the CQ are processed, the CQ will be rearmed to receive new packets events. In zero copy mode
+ * the SQ CQ is rearmed as well while sends are outstanding, since their RQ WQEs are only given back when they
+ * complete.
+ *
+ * @thread_idx [in]: Index of the queue set of this event handler
  */
 void
-__dpa_global__ l2_reflector_device_event_handler(uint64_t __unused arg0)
+__dpa_global__ l2_reflector_device_event_handler(uint64_t thread_idx)
 {
+	struct dev_ctx_t *ctx = &dev_ctxs[thread_idx];
 	struct flexio_dev_thread_ctx *dtctx;
+	union flexio_dev_sqe_seg *last_ctrl = NULL;
+	uint32_t nb_packets;
 
 	flexio_dev_get_thread_ctx(&dtctx);
 
-	if (dev_ctx.is_initalized == 0)
+	if (ctx->is_initalized == 0)
 		flexio_dev_thread_reschedule();
 
-	while (flexio_dev_cqe_get_owner(dev_ctx.rqcq_ctx.cqe) != dev_ctx.rqcq_ctx.cq_hw_owner_bit) {
-		__dpa_thread_fence(__DPA_MEMORY, __DPA_R, __DPA_R);
-		process_packet(dtctx);
-		step_cq(&dev_ctx.rqcq_ctx, L2_CQ_IDX_MASK);
+	while (1) {
+		if (ctx->zero_copy)
+			release_sent_rq_wqes(ctx);
+
+		nb_packets = 0;
+		while (nb_packets < ctx->batch_size &&
+		       flexio_dev_cqe_get_owner(ctx->rqcq_ctx.cqe) != ctx->rqcq_ctx.cq_hw_owner_bit) {
+			__dpa_thread_fence(__DPA_MEMORY, __DPA_R, __DPA_R);
+			last_ctrl = process_packet(ctx);
+			step_cq(&ctx->rqcq_ctx, L2_CQ_IDX_MASK);
+			nb_packets++;
+		}
+		if (nb_packets == 0)
+			break;
+
+		ring_doorbells(ctx, dtctx, last_ctrl, nb_packets);
 	}
 	__dpa_thread_fence(__DPA_MEMORY, __DPA_W, __DPA_W);
-	flexio_dev_cq_arm(dtctx, dev_ctx.rqcq_ctx.cq_idx, dev_ctx.rqcq_ctx.cq_number);
+	flexio_dev_cq_arm(dtctx, ctx->rqcq_ctx.cq_idx, ctx->rqcq_ctx.cq_number);
+	if (ctx->zero_copy && ctx->sq_ctx.sq_ci != ctx->sq_ctx.sq_pi)
+		flexio_dev_cq_arm(dtctx, ctx->sqcq_ctx.cq_idx, ctx->sqcq_ctx.cq_number);
 	flexio_dev_thread_reschedule();
 }
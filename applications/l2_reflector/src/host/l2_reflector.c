@@ -30,6 +30,7 @@ DOCA_LOG_REGISTER(L2_REFLECTOR);
 
 static bool force_quit; /* Set to true to terminate the application */
 extern flexio_func_t l2_reflector_device_init;
+extern flexio_func_t l2_reflector_device_packets_count;
 
 /*
  * Signals handler function to handle SIGINT and SIGTERM signals
@@ -60,12 +61,16 @@ main(int argc, char **argv)
 {
 	int ret = 0;
 	uint64_t rpc_ret_val;
+	uint32_t packets_count, last_packets_count = 0;
+	uint32_t i;
 	struct l2_reflector_config app_cfg;
 	struct doca_log_backend *sdk_log;
 	doca_error_t result;
 
 	force_quit = false;
 	memset(&app_cfg, 0, sizeof(app_cfg));
+	app_cfg.batch_size = L2_BATCH_SIZE_DEFAULT;
+	app_cfg.nb_threads = 1;
 
 	/* Register a logger backend */
 	result = doca_log_backend_create_standard();
@@ -116,12 +121,14 @@ main(int argc, char **argv)
 	if (result != DOCA_SUCCESS)
 		goto device_cleanup;
 
-	/* Run init function on device */
-	ret = flexio_process_call(app_cfg.flexio_process, &l2_reflector_device_init, &rpc_ret_val,
-				  app_cfg.dev_data_daddr);
-	if (ret != FLEXIO_STATUS_SUCCESS) {
-		DOCA_LOG_ERR("Failed to call init function on device");
-		goto device_resources_cleanup;
+	/* Run init function on device, once per queue set */
+	for (i = 0; i < app_cfg.nb_threads; i++) {
+		ret = flexio_process_call(app_cfg.flexio_process, &l2_reflector_device_init, &rpc_ret_val,
+					  app_cfg.queues[i].dev_data_daddr);
+		if (ret != FLEXIO_STATUS_SUCCESS || rpc_ret_val != 0) {
+			DOCA_LOG_ERR("Failed to call init function on device for queue set %u", i);
+			goto device_resources_cleanup;
+		}
 	}
 
 	/* Steering rule */
@@ -137,10 +144,13 @@ main(int argc, char **argv)
 		goto rule_cleanup;
 	}
 
-	ret = flexio_event_handler_run(app_cfg.event_handler, 0);
-	if (ret != FLEXIO_STATUS_SUCCESS) {
-		DOCA_LOG_ERR("Failed to run event handler on device");
-		goto rule_cleanup;
+	/* The argument of each event handler is the index of its queue set */
+	for (i = 0; i < app_cfg.nb_threads; i++) {
+		ret = flexio_event_handler_run(app_cfg.queues[i].event_handler, i);
+		if (ret != FLEXIO_STATUS_SUCCESS) {
+			DOCA_LOG_ERR("Failed to run event handler %u on device", i);
+			goto rule_cleanup;
+		}
 	}
 
 	signal(SIGINT, signal_handler);
@@ -149,8 +159,16 @@ main(int argc, char **argv)
 	/* Add an additional new line for output readability */
 	DOCA_LOG_INFO("");
 	DOCA_LOG_INFO("Press Ctrl+C to terminate");
-	while (!force_quit)
+	while (!force_quit) {
 		sleep(1);
+		/* The device counter has 32 bits, the difference of two reads is right across a wrap around */
+		if (flexio_process_call(app_cfg.flexio_process, &l2_reflector_device_packets_count, &rpc_ret_val, 0) !=
+		    FLEXIO_STATUS_SUCCESS)
+			continue;
+		packets_count = (uint32_t)rpc_ret_val;
+		DOCA_LOG_INFO("Reflected %u packets per second", packets_count - last_packets_count);
+		last_packets_count = packets_count;
+	}
 
 	l2_reflector_destroy(&app_cfg);
 	return EXIT_SUCCESS;
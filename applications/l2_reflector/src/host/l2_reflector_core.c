@@ -92,6 +92,7 @@ l2_reflector_setup_device(struct l2_reflector_config *app_cfg)
 {
 	flexio_status result;
 	struct flexio_event_handler_attr event_handler_attr = {0};
+	uint32_t i;
 
 	/* Create FlexIO Process and mkey */
 	result = flexio_process_create(app_cfg->ibv_ctx, l2_reflector_device, NULL, &app_cfg->flexio_process);
@@ -102,13 +103,27 @@ l2_reflector_setup_device(struct l2_reflector_config *app_cfg)
 
 	app_cfg->flexio_uar = flexio_process_get_uar(app_cfg->flexio_process);
 
+	app_cfg->queues = calloc(app_cfg->nb_threads, sizeof(*app_cfg->queues));
+	if (app_cfg->queues == NULL) {
+		DOCA_LOG_ERR("Could not allocate queue sets");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	/* One event handler per queue set, each one pinned to its own execution unit */
 	event_handler_attr.host_stub_func = l2_reflector_device_event_handler;
 	event_handler_attr.affinity.type = FLEXIO_AFFINITY_STRICT;
-	event_handler_attr.affinity.id = 0;
-	result = flexio_event_handler_create(app_cfg->flexio_process, &event_handler_attr, &app_cfg->event_handler);
-	if (result != FLEXIO_STATUS_SUCCESS) {
-		DOCA_LOG_ERR("Could not create event handler (%d)", result);
-		return DOCA_ERROR_DRIVER;
+	for (i = 0; i < app_cfg->nb_threads; i++) {
+		event_handler_attr.affinity.id = i;
+		result = flexio_event_handler_create(app_cfg->flexio_process, &event_handler_attr,
+						     &app_cfg->queues[i].event_handler);
+		if (result != FLEXIO_STATUS_SUCCESS) {
+			DOCA_LOG_ERR("Could not create event handler %u (%d)", i, result);
+			while (i-- > 0)
+				flexio_event_handler_destroy(app_cfg->queues[i].event_handler);
+			free(app_cfg->queues);
+			app_cfg->queues = NULL;
+			return DOCA_ERROR_DRIVER;
+		}
 	}
 	return DOCA_SUCCESS;
 }
@@ -252,10 +267,11 @@ create_dpa_mkey(struct flexio_process *process, struct ibv_pd *pd,
  * Allocate SQ and CQ for the device
  *
  * @app_cfg [in]: application configuration
+ * @queues [in/out]: queue set to allocate the SQ of
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-allocate_sq(struct l2_reflector_config *app_cfg)
+allocate_sq(struct l2_reflector_config *app_cfg, struct l2_reflector_queues *queues)
 {
 	doca_error_t result;
 	flexio_status ret;
@@ -275,48 +291,54 @@ allocate_sq(struct l2_reflector_config *app_cfg)
 		.uar_id = flexio_uar_get_id(app_cfg->flexio_uar),
 		.pd = app_cfg->pd};
 
+	/* In zero copy mode the RQ buffers are given back when their sends complete, which has to wake the device */
+	if (app_cfg->zero_copy) {
+		sqcq_attr.element_type = FLEXIO_CQ_ELEMENT_TYPE_DPA_THREAD;
+		sqcq_attr.thread = flexio_event_handler_get_thread(queues->event_handler);
+	}
+
 	/* Allocate memory for SQ's CQ */
-	result = allocate_cq_memory(app_cfg->flexio_process, L2_LOG_CQ_RING_DEPTH, &app_cfg->sq_cq_transf);
+	result = allocate_cq_memory(app_cfg->flexio_process, L2_LOG_CQ_RING_DEPTH, &queues->sq_cq_transf);
 	if (result != DOCA_SUCCESS)
 		return result;
 
-	sqcq_attr.cq_dbr_daddr = app_cfg->sq_cq_transf.cq_dbr_daddr;
-	sqcq_attr.cq_ring_qmem.daddr = app_cfg->sq_cq_transf.cq_ring_daddr;
+	sqcq_attr.cq_dbr_daddr = queues->sq_cq_transf.cq_dbr_daddr;
+	sqcq_attr.cq_ring_qmem.daddr = queues->sq_cq_transf.cq_ring_daddr;
 
 	/* Create SQ's CQ */
 	ret = flexio_cq_create(app_cfg->flexio_process, app_cfg->ibv_ctx, &sqcq_attr,
-			       &app_cfg->flexio_sq_cq_ptr);
+			       &queues->flexio_sq_cq_ptr);
 	if (ret != FLEXIO_STATUS_SUCCESS) {
 		DOCA_LOG_ERR("Failed to create FlexIO SQ's CQ");
 		return DOCA_ERROR_DRIVER;
 	}
 
-	cq_num = flexio_cq_get_cq_num(app_cfg->flexio_sq_cq_ptr);
-	app_cfg->sq_cq_transf.cq_num = cq_num;
-	app_cfg->sq_cq_transf.log_cq_depth = L2_LOG_CQ_RING_DEPTH;
+	cq_num = flexio_cq_get_cq_num(queues->flexio_sq_cq_ptr);
+	queues->sq_cq_transf.cq_num = cq_num;
+	queues->sq_cq_transf.log_cq_depth = L2_LOG_CQ_RING_DEPTH;
 
 	/* Allocate memory for SQ */
 	log_sqd_bsize = L2_LOG_WQ_DATA_ENTRY_BSIZE + L2_LOG_SQ_RING_DEPTH;
-	result = allocate_sq_memory(app_cfg->flexio_process, L2_LOG_SQ_RING_DEPTH, log_sqd_bsize, &app_cfg->sq_transf);
+	result = allocate_sq_memory(app_cfg->flexio_process, L2_LOG_SQ_RING_DEPTH, log_sqd_bsize, &queues->sq_transf);
 	if (result != DOCA_SUCCESS)
 		return result;
 
-	sq_attr.wq_ring_qmem.daddr = app_cfg->sq_transf.wq_ring_daddr;
+	sq_attr.wq_ring_qmem.daddr = queues->sq_transf.wq_ring_daddr;
 
-	ret =  flexio_sq_create(app_cfg->flexio_process, NULL, cq_num, &sq_attr, &app_cfg->flexio_sq_ptr);
+	ret =  flexio_sq_create(app_cfg->flexio_process, NULL, cq_num, &sq_attr, &queues->flexio_sq_ptr);
 	if (ret != FLEXIO_STATUS_SUCCESS) {
 		DOCA_LOG_ERR("Failed to create FlexIO SQ");
 		return DOCA_ERROR_DRIVER;
 	}
 
-	app_cfg->sq_transf.wq_num = flexio_sq_get_wq_num(app_cfg->flexio_sq_ptr);
+	queues->sq_transf.wq_num = flexio_sq_get_wq_num(queues->flexio_sq_ptr);
 	/* Create SQ TX MKey */
-	result = create_dpa_mkey(app_cfg->flexio_process, app_cfg->pd, app_cfg->sq_transf.wqd_daddr,
-			  log_sqd_bsize, IBV_ACCESS_LOCAL_WRITE, &app_cfg->sqd_mkey);
+	result = create_dpa_mkey(app_cfg->flexio_process, app_cfg->pd, queues->sq_transf.wqd_daddr,
+			  log_sqd_bsize, IBV_ACCESS_LOCAL_WRITE, &queues->sqd_mkey);
 	if (result != DOCA_SUCCESS)
 		return result;
 
-	app_cfg->sq_transf.wqd_mkey_id = flexio_mkey_get_id(app_cfg->sqd_mkey);
+	queues->sq_transf.wqd_mkey_id = flexio_mkey_get_id(queues->sqd_mkey);
 
 	return DOCA_SUCCESS;
 
@@ -376,10 +398,11 @@ init_dpa_rq_ring(struct flexio_process *process, flexio_uintptr_t ring_daddr,
  * Allocate RQ and CQ for the device
  *
  * @app_cfg [in]: application configuration
+ * @queues [in/out]: queue set to allocate the RQ of
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-allocate_rq(struct l2_reflector_config *app_cfg)
+allocate_rq(struct l2_reflector_config *app_cfg, struct l2_reflector_queues *queues)
 {
 	doca_error_t result;
 	flexio_status ret;
@@ -392,7 +415,7 @@ allocate_rq(struct l2_reflector_config *app_cfg)
 	struct flexio_cq_attr rqcq_attr = {
 		.log_cq_depth = L2_LOG_CQ_RING_DEPTH,
 		.element_type = FLEXIO_CQ_ELEMENT_TYPE_DPA_THREAD,
-		.thread = flexio_event_handler_get_thread(app_cfg->event_handler),
+		.thread = flexio_event_handler_get_thread(queues->event_handler),
 		.uar_id = flexio_uar_get_id(app_cfg->flexio_uar),
 		.uar_base_addr = 0};
 	/* RQ attributes */
@@ -401,74 +424,74 @@ allocate_rq(struct l2_reflector_config *app_cfg)
 		.pd = app_cfg->pd};
 
 	/* Allocate memory for RQ's CQ */
-	result = allocate_cq_memory(app_cfg->flexio_process, L2_LOG_CQ_RING_DEPTH, &app_cfg->rq_cq_transf);
+	result = allocate_cq_memory(app_cfg->flexio_process, L2_LOG_CQ_RING_DEPTH, &queues->rq_cq_transf);
 	if (result != DOCA_SUCCESS)
 		return result;
 
-	rqcq_attr.cq_dbr_daddr = app_cfg->rq_cq_transf.cq_dbr_daddr;
-	rqcq_attr.cq_ring_qmem.daddr = app_cfg->rq_cq_transf.cq_ring_daddr;
+	rqcq_attr.cq_dbr_daddr = queues->rq_cq_transf.cq_dbr_daddr;
+	rqcq_attr.cq_ring_qmem.daddr = queues->rq_cq_transf.cq_ring_daddr;
 
 	/* Create CQ and RQ */
-	ret = flexio_cq_create(app_cfg->flexio_process, NULL, &rqcq_attr, &app_cfg->flexio_rq_cq_ptr);
+	ret = flexio_cq_create(app_cfg->flexio_process, NULL, &rqcq_attr, &queues->flexio_rq_cq_ptr);
 	if (ret != FLEXIO_STATUS_SUCCESS) {
 		DOCA_LOG_ERR("Failed to create FlexIO RQ's CQ");
 		return DOCA_ERROR_DRIVER;
 	}
 
-	cq_num = flexio_cq_get_cq_num(app_cfg->flexio_rq_cq_ptr);
-	app_cfg->rq_cq_transf.cq_num = cq_num;
-	app_cfg->rq_cq_transf.log_cq_depth = L2_LOG_RQ_RING_DEPTH;
+	cq_num = flexio_cq_get_cq_num(queues->flexio_rq_cq_ptr);
+	queues->rq_cq_transf.cq_num = cq_num;
+	queues->rq_cq_transf.log_cq_depth = L2_LOG_RQ_RING_DEPTH;
 
 	log_rqd_bsize = L2_LOG_RQ_RING_DEPTH + L2_LOG_WQ_DATA_ENTRY_BSIZE;
 
-	flexio_buf_dev_alloc(app_cfg->flexio_process, LOG2VALUE(log_rqd_bsize), &app_cfg->rq_transf.wqd_daddr);
-	if (app_cfg->rq_transf.wqd_daddr == 0) {
+	flexio_buf_dev_alloc(app_cfg->flexio_process, LOG2VALUE(log_rqd_bsize), &queues->rq_transf.wqd_daddr);
+	if (queues->rq_transf.wqd_daddr == 0) {
 		DOCA_LOG_ERR("Failed to allocate memory for RQ data buffer");
 		return DOCA_ERROR_DRIVER;
 	}
 
 	flexio_buf_dev_alloc(app_cfg->flexio_process, LOG2VALUE(L2_LOG_CQ_RING_DEPTH) * sizeof(struct mlx5_wqe_data_seg),
-				&app_cfg->rq_transf.wq_ring_daddr);
-	if (app_cfg->rq_transf.wq_ring_daddr == 0x0) {
+				&queues->rq_transf.wq_ring_daddr);
+	if (queues->rq_transf.wq_ring_daddr == 0x0) {
 		DOCA_LOG_ERR("Failed to allocate memory for RQ ring buffer");
 		return DOCA_ERROR_DRIVER;
 	}
 
-	result = allocate_dbr(app_cfg->flexio_process, &app_cfg->rq_transf.wq_dbr_daddr);
+	result = allocate_dbr(app_cfg->flexio_process, &queues->rq_transf.wq_dbr_daddr);
 	if (result != DOCA_SUCCESS)
 		return result;
 
 	/* Create an MKey for RX buffer */
 	result = create_dpa_mkey(app_cfg->flexio_process,
 						app_cfg->pd,
-						app_cfg->rq_transf.wqd_daddr,
+						queues->rq_transf.wqd_daddr,
 						log_rqd_bsize,
 						IBV_ACCESS_LOCAL_WRITE,
-						&app_cfg->rqd_mkey);
+						&queues->rqd_mkey);
 	if (result != DOCA_SUCCESS)
 		return result;
 
-	mkey_id = flexio_mkey_get_id(app_cfg->rqd_mkey);
+	mkey_id = flexio_mkey_get_id(queues->rqd_mkey);
 
-	result = init_dpa_rq_ring(app_cfg->flexio_process, app_cfg->rq_transf.wq_ring_daddr,
-				  L2_LOG_CQ_RING_DEPTH, app_cfg->rq_transf.wqd_daddr,
+	result = init_dpa_rq_ring(app_cfg->flexio_process, queues->rq_transf.wq_ring_daddr,
+				  L2_LOG_CQ_RING_DEPTH, queues->rq_transf.wqd_daddr,
 				  L2_LOG_WQ_DATA_ENTRY_BSIZE, mkey_id);
 	if (result != DOCA_SUCCESS)
 		return result;
 
 	rq_attr.wq_dbr_qmem.memtype = FLEXIO_MEMTYPE_DPA;
-	rq_attr.wq_dbr_qmem.daddr = app_cfg->rq_transf.wq_dbr_daddr;
-	rq_attr.wq_ring_qmem.daddr = app_cfg->rq_transf.wq_ring_daddr;
+	rq_attr.wq_dbr_qmem.daddr = queues->rq_transf.wq_dbr_daddr;
+	rq_attr.wq_ring_qmem.daddr = queues->rq_transf.wq_ring_daddr;
 
-	ret = flexio_rq_create(app_cfg->flexio_process, NULL, cq_num, &rq_attr, &app_cfg->flexio_rq_ptr);
+	ret = flexio_rq_create(app_cfg->flexio_process, NULL, cq_num, &rq_attr, &queues->flexio_rq_ptr);
 	if (ret != FLEXIO_STATUS_SUCCESS) {
 		DOCA_LOG_ERR("Failed to create FlexIO SQ");
 		return DOCA_ERROR_DRIVER;
 	}
 
-	wq_num = flexio_rq_get_wq_num(app_cfg->flexio_rq_ptr);
-	app_cfg->rq_transf.wqd_mkey_id = mkey_id;
-	app_cfg->rq_transf.wq_num = wq_num;
+	wq_num = flexio_rq_get_wq_num(queues->flexio_rq_ptr);
+	queues->rq_transf.wqd_mkey_id = mkey_id;
+	queues->rq_transf.wq_num = wq_num;
 
 	/* Modify RQ's DBR record to count for the number of WQEs */
 	__be32 dbr[2];
@@ -478,7 +501,7 @@ allocate_rq(struct l2_reflector_config *app_cfg)
 	dbr[0] = htobe32(rcv_counter & 0xffff);
 	dbr[1] = htobe32(send_counter & 0xffff);
 
-	ret = flexio_host2dev_memcpy(app_cfg->flexio_process, dbr, sizeof(dbr), app_cfg->rq_transf.wq_dbr_daddr);
+	ret = flexio_host2dev_memcpy(app_cfg->flexio_process, dbr, sizeof(dbr), queues->rq_transf.wq_dbr_daddr);
 	if (ret != FLEXIO_STATUS_SUCCESS) {
 		DOCA_LOG_ERR("Failed to modify RQ's DBR");
 		return DOCA_ERROR_DRIVER;
@@ -491,17 +514,18 @@ allocate_rq(struct l2_reflector_config *app_cfg)
  * Destroy RQ
  *
  * @app_cfg [in]: application configuration
+ * @queues [in]: queue set to destroy the RQ of
  */
 static void
-l2_reflector_rq_destroy(struct l2_reflector_config *app_cfg)
+l2_reflector_rq_destroy(struct l2_reflector_config *app_cfg, struct l2_reflector_queues *queues)
 {
 	flexio_status ret = FLEXIO_STATUS_SUCCESS;
 
-	ret |= flexio_rq_destroy(app_cfg->flexio_rq_ptr);
-	ret |= flexio_device_mkey_destroy(app_cfg->rqd_mkey);
-	ret |= flexio_buf_dev_free(app_cfg->flexio_process, app_cfg->rq_transf.wq_dbr_daddr);
-	ret |= flexio_buf_dev_free(app_cfg->flexio_process, app_cfg->rq_transf.wq_ring_daddr);
-	ret |= flexio_buf_dev_free(app_cfg->flexio_process, app_cfg->rq_transf.wqd_daddr);
+	ret |= flexio_rq_destroy(queues->flexio_rq_ptr);
+	ret |= flexio_device_mkey_destroy(queues->rqd_mkey);
+	ret |= flexio_buf_dev_free(app_cfg->flexio_process, queues->rq_transf.wq_dbr_daddr);
+	ret |= flexio_buf_dev_free(app_cfg->flexio_process, queues->rq_transf.wq_ring_daddr);
+	ret |= flexio_buf_dev_free(app_cfg->flexio_process, queues->rq_transf.wqd_daddr);
 
 	if (ret != FLEXIO_STATUS_SUCCESS)
 		DOCA_LOG_ERR("Failed to destroy RQ");
@@ -511,17 +535,18 @@ l2_reflector_rq_destroy(struct l2_reflector_config *app_cfg)
  * Destroy SQ
  *
  * @app_cfg [in]: application configuration
+ * @queues [in]: queue set to destroy the SQ of
  */
 static void
-l2_reflector_sq_destroy(struct l2_reflector_config *app_cfg)
+l2_reflector_sq_destroy(struct l2_reflector_config *app_cfg, struct l2_reflector_queues *queues)
 {
 	flexio_status ret = FLEXIO_STATUS_SUCCESS;
 
-	ret |= flexio_sq_destroy(app_cfg->flexio_sq_ptr);
-	ret |= flexio_device_mkey_destroy(app_cfg->sqd_mkey);
-	ret |= flexio_buf_dev_free(app_cfg->flexio_process, app_cfg->sq_transf.wq_dbr_daddr);
-	ret |= flexio_buf_dev_free(app_cfg->flexio_process, app_cfg->sq_transf.wq_ring_daddr);
-	ret |= flexio_buf_dev_free(app_cfg->flexio_process, app_cfg->sq_transf.wqd_daddr);
+	ret |= flexio_sq_destroy(queues->flexio_sq_ptr);
+	ret |= flexio_device_mkey_destroy(queues->sqd_mkey);
+	ret |= flexio_buf_dev_free(app_cfg->flexio_process, queues->sq_transf.wq_dbr_daddr);
+	ret |= flexio_buf_dev_free(app_cfg->flexio_process, queues->sq_transf.wq_ring_daddr);
+	ret |= flexio_buf_dev_free(app_cfg->flexio_process, queues->sq_transf.wqd_daddr);
 
 	if (ret != FLEXIO_STATUS_SUCCESS)
 		DOCA_LOG_ERR("Failed to destroy SQ");
@@ -551,53 +576,97 @@ l2_reflector_cq_destroy(struct flexio_process *flexio_process, struct flexio_cq
  * Destroy WQs and CQs
  *
  * @app_cfg [in]: application configuration
+ * @queues [in]: queue set to destroy
  */
 static void
-dev_queues_destroy(struct l2_reflector_config *app_cfg)
+dev_queues_destroy(struct l2_reflector_config *app_cfg, struct l2_reflector_queues *queues)
 {
-	l2_reflector_rq_destroy(app_cfg);
-	l2_reflector_sq_destroy(app_cfg);
-	l2_reflector_cq_destroy(app_cfg->flexio_process, app_cfg->flexio_rq_cq_ptr, app_cfg->rq_cq_transf);
-	l2_reflector_cq_destroy(app_cfg->flexio_process, app_cfg->flexio_sq_cq_ptr, app_cfg->sq_cq_transf);
+	l2_reflector_rq_destroy(app_cfg, queues);
+	l2_reflector_sq_destroy(app_cfg, queues);
+	l2_reflector_cq_destroy(app_cfg->flexio_process, queues->flexio_rq_cq_ptr, queues->rq_cq_transf);
+	l2_reflector_cq_destroy(app_cfg->flexio_process, queues->flexio_sq_cq_ptr, queues->sq_cq_transf);
 }
 
-doca_error_t
-l2_reflector_allocate_device_resources(struct l2_reflector_config *app_cfg)
+/*
+ * Allocate the WQs and CQs of a queue set and copy their description to the device
+ *
+ * @app_cfg [in]: application configuration
+ * @queues [in/out]: queue set
+ * @thread_idx [in]: index of the queue set
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+allocate_queue_set(struct l2_reflector_config *app_cfg, struct l2_reflector_queues *queues, uint32_t thread_idx)
 {
 	doca_error_t result;
 	flexio_status ret;
 
-	result = allocate_sq(app_cfg);
+	result = allocate_sq(app_cfg, queues);
 	if (result != DOCA_SUCCESS)
 		return result;
 
-	result = allocate_rq(app_cfg);
+	result = allocate_rq(app_cfg, queues);
 	if (result != DOCA_SUCCESS)
 		return result;
 
-	app_cfg->dev_data = (struct l2_reflector_data *) calloc(1, sizeof(*app_cfg->dev_data));
-	if (app_cfg->dev_data == NULL) {
+	queues->dev_data = (struct l2_reflector_data *) calloc(1, sizeof(*queues->dev_data));
+	if (queues->dev_data == NULL) {
 		DOCA_LOG_ERR("Could not allocate application data memory");
-		dev_queues_destroy(app_cfg);
+		dev_queues_destroy(app_cfg, queues);
 		return DOCA_ERROR_NO_MEMORY;
 	}
 
-	app_cfg->dev_data->sq_cq_data = app_cfg->sq_cq_transf;
-	app_cfg->dev_data->sq_data = app_cfg->sq_transf;
-	app_cfg->dev_data->rq_cq_data = app_cfg->rq_cq_transf;
-	app_cfg->dev_data->rq_data = app_cfg->rq_transf;
+	queues->dev_data->sq_cq_data = queues->sq_cq_transf;
+	queues->dev_data->sq_data = queues->sq_transf;
+	queues->dev_data->rq_cq_data = queues->rq_cq_transf;
+	queues->dev_data->rq_data = queues->rq_transf;
+	queues->dev_data->batch_size = app_cfg->batch_size;
+	queues->dev_data->zero_copy = app_cfg->zero_copy;
+	queues->dev_data->thread_idx = thread_idx;
 
-	ret = flexio_copy_from_host(app_cfg->flexio_process, app_cfg->dev_data, sizeof(*app_cfg->dev_data),
-				     &app_cfg->dev_data_daddr);
+	ret = flexio_copy_from_host(app_cfg->flexio_process, queues->dev_data, sizeof(*queues->dev_data),
+				     &queues->dev_data_daddr);
 	if (ret != FLEXIO_STATUS_SUCCESS) {
 		DOCA_LOG_ERR("Could not copy data to device");
-		dev_queues_destroy(app_cfg);
-		free(app_cfg->dev_data);
+		dev_queues_destroy(app_cfg, queues);
+		free(queues->dev_data);
 		return DOCA_ERROR_DRIVER;
 	}
 	return DOCA_SUCCESS;
 }
 
+/*
+ * Destroy the WQs and CQs of a queue set and free its device data
+ *
+ * @app_cfg [in]: application configuration
+ * @queues [in]: queue set
+ */
+static void
+destroy_queue_set(struct l2_reflector_config *app_cfg, struct l2_reflector_queues *queues)
+{
+	dev_queues_destroy(app_cfg, queues);
+	flexio_buf_dev_free(app_cfg->flexio_process, queues->dev_data_daddr);
+	free(queues->dev_data);
+}
+
+doca_error_t
+l2_reflector_allocate_device_resources(struct l2_reflector_config *app_cfg)
+{
+	doca_error_t result;
+	uint32_t i;
+
+	for (i = 0; i < app_cfg->nb_threads; i++) {
+		result = allocate_queue_set(app_cfg, &app_cfg->queues[i], i);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to allocate queue set %u", i);
+			while (i-- > 0)
+				destroy_queue_set(app_cfg, &app_cfg->queues[i]);
+			return result;
+		}
+	}
+	return DOCA_SUCCESS;
+}
+
 /*
  * Create flow table with single matcher
  *
@@ -682,6 +751,141 @@ destroy_rule(struct dr_flow_rule *rule)
 }
 
 
+/*
+ * Destroy the RSS TIR, RQT and transport domain
+ *
+ * @app_cfg [in]: application configuration
+ */
+static void
+destroy_rss_tir(struct l2_reflector_config *app_cfg)
+{
+	if (app_cfg->rss_tir) {
+		mlx5dv_devx_obj_destroy(app_cfg->rss_tir);
+		app_cfg->rss_tir = NULL;
+	}
+	if (app_cfg->rss_rqt) {
+		mlx5dv_devx_obj_destroy(app_cfg->rss_rqt);
+		app_cfg->rss_rqt = NULL;
+	}
+	if (app_cfg->rss_td) {
+		mlx5dv_devx_obj_destroy(app_cfg->rss_td);
+		app_cfg->rss_td = NULL;
+	}
+}
+
+/*
+ * Get the number of entries of the RSS indirection table: L2_RSS_RQT_SIZE, capped by the device maximum RQT size
+ *
+ * @app_cfg [in]: application configuration
+ * @rqt_size [out]: number of RQT entries
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+get_rss_rqt_size(struct l2_reflector_config *app_cfg, uint32_t *rqt_size)
+{
+	uint32_t cap_in[DEVX_ST_SZ_DW(query_hca_cap_in)] = {0};
+	uint32_t cap_out[DEVX_ST_SZ_DW(query_hca_cap_out)] = {0};
+	uint32_t log_max_rqt_size;
+
+	DEVX_SET(query_hca_cap_in, cap_in, opcode, MLX5_CMD_OP_QUERY_HCA_CAP);
+	DEVX_SET(query_hca_cap_in, cap_in, op_mod, MLX5_HCA_CAP_OP_MOD_GENERAL_DEVICE_CURRENT);
+	if (mlx5dv_devx_general_cmd(app_cfg->ibv_ctx, cap_in, sizeof(cap_in), cap_out, sizeof(cap_out)) != 0) {
+		DOCA_LOG_ERR("Failed to query device capabilities [%d]", errno);
+		return DOCA_ERROR_DRIVER;
+	}
+
+	log_max_rqt_size = DEVX_GET(query_hca_cap_out, cap_out, capability.log_max_rqt_size);
+	*rqt_size = 1 << MIN(log_max_rqt_size, L2_LOG_RSS_RQT_SIZE);
+	if (*rqt_size < app_cfg->nb_threads) {
+		DOCA_LOG_ERR("Device RQT of %u entries is too small for %u threads", *rqt_size, app_cfg->nb_threads);
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Create a TIR that spreads the packets over the RQs of all queue sets with a Toeplitz hash of the IPv4 addresses.
+ * The RQT has a fixed number of entries, much larger than the number of RQs, filled with the RQs in a round robin
+ * so that the share of every RQ is within one entry of the others. Packets that are not IPv4 all go to the first RQ.
+ *
+ * @app_cfg [in/out]: application configuration
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+create_rss_tir(struct l2_reflector_config *app_cfg)
+{
+	static const uint8_t toeplitz_key[] = {
+		0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2, 0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,
+		0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4, 0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,
+		0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,
+	};
+	uint32_t td_in[DEVX_ST_SZ_DW(alloc_transport_domain_in)] = {0};
+	uint32_t td_out[DEVX_ST_SZ_DW(alloc_transport_domain_out)] = {0};
+	uint32_t rqt_out[DEVX_ST_SZ_DW(create_rqt_out)] = {0};
+	uint32_t tir_in[DEVX_ST_SZ_DW(create_tir_in)] = {0};
+	uint32_t tir_out[DEVX_ST_SZ_DW(create_tir_out)] = {0};
+	uint32_t rqt_size, rqt_in_bsize, i;
+	doca_error_t result;
+	uint32_t *rqt_in;
+	void *rqtc, *tirc, *hash_sel;
+
+	/* Transport domain of the TIR */
+	DEVX_SET(alloc_transport_domain_in, td_in, opcode, MLX5_CMD_OP_ALLOC_TRANSPORT_DOMAIN);
+	app_cfg->rss_td = mlx5dv_devx_obj_create(app_cfg->ibv_ctx, td_in, sizeof(td_in), td_out, sizeof(td_out));
+	if (app_cfg->rss_td == NULL) {
+		DOCA_LOG_ERR("Failed to allocate transport domain [%d]", errno);
+		return DOCA_ERROR_DRIVER;
+	}
+
+	/* Indirection table */
+	result = get_rss_rqt_size(app_cfg, &rqt_size);
+	if (result != DOCA_SUCCESS) {
+		destroy_rss_tir(app_cfg);
+		return result;
+	}
+	rqt_in_bsize = DEVX_ST_SZ_BYTES(create_rqt_in) + rqt_size * DEVX_ST_SZ_BYTES(rq_num);
+	rqt_in = calloc(1, rqt_in_bsize);
+	if (rqt_in == NULL) {
+		DOCA_LOG_ERR("Failed to allocate RQT command");
+		destroy_rss_tir(app_cfg);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	DEVX_SET(create_rqt_in, rqt_in, opcode, MLX5_CMD_OP_CREATE_RQT);
+	rqtc = DEVX_ADDR_OF(create_rqt_in, rqt_in, rqt_context);
+	DEVX_SET(rqtc, rqtc, rqt_max_size, rqt_size);
+	DEVX_SET(rqtc, rqtc, rqt_actual_size, rqt_size);
+	for (i = 0; i < rqt_size; i++)
+		DEVX_SET(rqtc, rqtc, rq_num[i], app_cfg->queues[i % app_cfg->nb_threads].rq_transf.wq_num);
+	app_cfg->rss_rqt = mlx5dv_devx_obj_create(app_cfg->ibv_ctx, rqt_in, rqt_in_bsize, rqt_out, sizeof(rqt_out));
+	free(rqt_in);
+	if (app_cfg->rss_rqt == NULL) {
+		DOCA_LOG_ERR("Failed to create RQT [%d]", errno);
+		destroy_rss_tir(app_cfg);
+		return DOCA_ERROR_DRIVER;
+	}
+
+	/* Indirect TIR hashing over the RQT */
+	DEVX_SET(create_tir_in, tir_in, opcode, MLX5_CMD_OP_CREATE_TIR);
+	tirc = DEVX_ADDR_OF(create_tir_in, tir_in, tir_context);
+	DEVX_SET(tirc, tirc, disp_type, MLX5_TIRC_DISP_TYPE_INDIRECT);
+	DEVX_SET(tirc, tirc, indirect_table, DEVX_GET(create_rqt_out, rqt_out, rqtn));
+	DEVX_SET(tirc, tirc, transport_domain, DEVX_GET(alloc_transport_domain_out, td_out, transport_domain));
+	DEVX_SET(tirc, tirc, rx_hash_fn, MLX5_RX_HASH_FN_TOEPLITZ);
+	memcpy(DEVX_ADDR_OF(tirc, tirc, rx_hash_toeplitz_key), toeplitz_key, sizeof(toeplitz_key));
+	hash_sel = DEVX_ADDR_OF(tirc, tirc, rx_hash_field_selector_outer);
+	DEVX_SET(rx_hash_field_select, hash_sel, l3_prot_type, MLX5_L3_PROT_TYPE_IPV4);
+	DEVX_SET(rx_hash_field_select, hash_sel, selected_fields,
+		 MLX5_HASH_FIELD_SEL_SRC_IP | MLX5_HASH_FIELD_SEL_DST_IP);
+	app_cfg->rss_tir = mlx5dv_devx_obj_create(app_cfg->ibv_ctx, tir_in, sizeof(tir_in), tir_out, sizeof(tir_out));
+	if (app_cfg->rss_tir == NULL) {
+		DOCA_LOG_ERR("Failed to create RSS TIR [%d]", errno);
+		destroy_rss_tir(app_cfg);
+		return DOCA_ERROR_DRIVER;
+	}
+
+	return DOCA_SUCCESS;
+}
+
 doca_error_t
 l2_reflector_create_steering_rule_rx(struct l2_reflector_config *app_cfg)
 {
@@ -729,9 +933,16 @@ l2_reflector_create_steering_rule_rx(struct l2_reflector_config *app_cfg)
 		goto exit_with_error;
 	}
 
-	/* Action = forward to FlexIO RQ */
-	app_cfg->rx_rule->dr_action =
-		mlx5dv_dr_action_create_dest_devx_tir(flexio_rq_get_tir(app_cfg->flexio_rq_ptr));
+	/* Action = forward to FlexIO RQ, or to the RQs of all queue sets with RSS */
+	if (app_cfg->nb_threads > 1) {
+		result = create_rss_tir(app_cfg);
+		if (result != DOCA_SUCCESS)
+			goto exit_with_error;
+		app_cfg->rx_rule->dr_action = mlx5dv_dr_action_create_dest_devx_tir(app_cfg->rss_tir);
+	} else {
+		app_cfg->rx_rule->dr_action =
+			mlx5dv_dr_action_create_dest_devx_tir(flexio_rq_get_tir(app_cfg->queues[0].flexio_rq_ptr));
+	}
 	if (app_cfg->rx_rule->dr_action == NULL) {
 		DOCA_LOG_ERR("Failed to create RX rule action [%d]", errno);
 		result = DOCA_ERROR_DRIVER;
@@ -758,6 +969,7 @@ exit_with_error:
 		destroy_rule(app_cfg->rx_rule);
 		app_cfg->rx_rule = NULL;
 	}
+	destroy_rss_tir(app_cfg);
 	destroy_table(app_cfg->rx_flow_table);
 	app_cfg->rx_flow_table = NULL;
 	mlx5dv_dr_domain_destroy(app_cfg->rx_domain);
@@ -895,9 +1107,10 @@ exit_with_error:
 void
 l2_reflector_device_resources_destroy(struct l2_reflector_config *app_cfg)
 {
-	dev_queues_destroy(app_cfg);
-	flexio_buf_dev_free(app_cfg->flexio_process, app_cfg->dev_data_daddr);
-	free(app_cfg->dev_data);
+	uint32_t i;
+
+	for (i = 0; i < app_cfg->nb_threads; i++)
+		destroy_queue_set(app_cfg, &app_cfg->queues[i]);
 }
 
 void
@@ -915,6 +1128,7 @@ l2_reflector_steering_rules_destroy(struct l2_reflector_config *app_cfg)
 		destroy_rule(app_cfg->tx_root_rule);
 		app_cfg->tx_root_rule = NULL;
 	}
+	destroy_rss_tir(app_cfg);
 	if (app_cfg->rx_flow_table) {
 		destroy_table(app_cfg->rx_flow_table);
 		app_cfg->rx_flow_table = NULL;
@@ -937,8 +1151,12 @@ void
 l2_reflector_device_destroy(struct l2_reflector_config *app_cfg)
 {
 	flexio_status ret = FLEXIO_STATUS_SUCCESS;
+	uint32_t i;
 
-	ret |= flexio_event_handler_destroy(app_cfg->event_handler);
+	for (i = 0; i < app_cfg->nb_threads; i++)
+		ret |= flexio_event_handler_destroy(app_cfg->queues[i].event_handler);
+	free(app_cfg->queues);
+	app_cfg->queues = NULL;
 
 	if (ret != FLEXIO_STATUS_SUCCESS)
 		DOCA_LOG_ERR("Failed to destroy FlexIO device");
@@ -998,10 +1216,71 @@ device_callback(void *param, void *config)
 	return DOCA_SUCCESS;
 }
 
+/*
+ * ARGP Callback - Handle batch size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+batch_size_callback(void *param, void *config)
+{
+	struct l2_reflector_config *app_cfg = (struct l2_reflector_config *)config;
+	int batch_size = *(int *)param;
+
+	if (batch_size < 1 || batch_size > L2_MAX_BATCH_SIZE) {
+		DOCA_LOG_ERR("Batch size must be between 1 and %d", L2_MAX_BATCH_SIZE);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	app_cfg->batch_size = batch_size;
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle zero copy parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+zero_copy_callback(void *param, void *config)
+{
+	struct l2_reflector_config *app_cfg = (struct l2_reflector_config *)config;
+
+	app_cfg->zero_copy = *(bool *)param;
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle threads parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+threads_callback(void *param, void *config)
+{
+	struct l2_reflector_config *app_cfg = (struct l2_reflector_config *)config;
+	int nb_threads = *(int *)param;
+
+	if (nb_threads < 1 || nb_threads > L2_MAX_THREADS) {
+		DOCA_LOG_ERR("Number of threads must be between 1 and %d", L2_MAX_THREADS);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	app_cfg->nb_threads = nb_threads;
+
+	return DOCA_SUCCESS;
+}
+
 doca_error_t
 register_l2_reflector_params(void)
 {
-	struct doca_argp_param *device_param;
+	struct doca_argp_param *device_param, *batch_size_param, *zero_copy_param, *threads_param;
 	doca_error_t result;
 
 	result = doca_argp_param_create(&device_param);
@@ -1022,6 +1301,59 @@ register_l2_reflector_params(void)
 		return result;
 	}
 
+	result = doca_argp_param_create(&batch_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(batch_size_param, "b");
+	doca_argp_param_set_long_name(batch_size_param, "batch");
+	doca_argp_param_set_arguments(batch_size_param, "<size>");
+	doca_argp_param_set_description(batch_size_param,
+					"Maximal number of packets handled per doorbell, 1 to 128 (default 32)");
+	doca_argp_param_set_callback(batch_size_param, batch_size_callback);
+	doca_argp_param_set_type(batch_size_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(batch_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&zero_copy_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(zero_copy_param, "z");
+	doca_argp_param_set_long_name(zero_copy_param, "zero-copy");
+	doca_argp_param_set_description(zero_copy_param,
+					"Send the packets from the RX buffers instead of copying them to the TX buffers");
+	doca_argp_param_set_callback(zero_copy_param, zero_copy_callback);
+	doca_argp_param_set_type(zero_copy_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(zero_copy_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_param_create(&threads_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(threads_param, "t");
+	doca_argp_param_set_long_name(threads_param, "threads");
+	doca_argp_param_set_arguments(threads_param, "<num>");
+	doca_argp_param_set_description(threads_param,
+					"Number of device threads, each with its own queues, packets are spread with RSS (default 1)");
+	doca_argp_param_set_callback(threads_param, threads_callback);
+	doca_argp_param_set_type(threads_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(threads_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
 	result = doca_argp_register_version_callback(sdk_version_callback);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to register version callback: %s", doca_error_get_descr(result));
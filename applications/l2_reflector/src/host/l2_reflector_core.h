@@ -14,6 +14,8 @@
 #ifndef L2_REFLECTOR_CORE_H_
 #define L2_REFLECTOR_CORE_H_
 
+#include <stdbool.h>
+
 #include <doca_error.h>
 #include <infiniband/mlx5dv.h>
 #include <libflexio/flexio.h>
@@ -74,6 +76,192 @@ struct mlx5_ifc_dr_match_spec_bits {
 	uint8_t dst_ip_31_0[0x20];
 };
 
+/* PRM commands used to spread the received packets over the RQs with RSS */
+#define MLX5_CMD_OP_QUERY_HCA_CAP (0x100)
+#define MLX5_CMD_OP_ALLOC_TRANSPORT_DOMAIN (0x816)
+#define MLX5_CMD_OP_CREATE_TIR (0x900)
+#define MLX5_CMD_OP_CREATE_RQT (0x916)
+
+#define MLX5_HCA_CAP_OP_MOD_GENERAL_DEVICE_CURRENT (0x1)
+#define MLX5_TIRC_DISP_TYPE_INDIRECT (0x1)
+#define MLX5_RX_HASH_FN_TOEPLITZ (0x2)
+#define MLX5_L3_PROT_TYPE_IPV4 (0x0)
+#define MLX5_HASH_FIELD_SEL_SRC_IP (1 << 0)
+#define MLX5_HASH_FIELD_SEL_DST_IP (1 << 1)
+
+struct mlx5_ifc_query_hca_cap_in_bits {
+	uint8_t opcode[0x10];
+	uint8_t uid[0x10];
+
+	uint8_t reserved_at_20[0x10];
+	uint8_t op_mod[0x10];
+
+	uint8_t other_function[0x1];
+	uint8_t reserved_at_41[0xf];
+	uint8_t function_id[0x10];
+
+	uint8_t reserved_at_60[0x20];
+};
+
+/* General device capabilities, only the fields used by the application are named */
+struct mlx5_ifc_cmd_hca_cap_bits {
+	uint8_t reserved_at_0[0x1a8];
+
+	uint8_t reserved_at_1a8[0x3];
+	uint8_t log_max_rqt_size[0x5];
+	uint8_t reserved_at_1b0[0x650];
+};
+
+struct mlx5_ifc_query_hca_cap_out_bits {
+	uint8_t status[0x8];
+	uint8_t reserved_at_8[0x18];
+
+	uint8_t syndrome[0x20];
+
+	uint8_t reserved_at_40[0x40];
+
+	struct mlx5_ifc_cmd_hca_cap_bits capability;
+
+	uint8_t reserved_at_880[0x7800];
+};
+
+struct mlx5_ifc_alloc_transport_domain_out_bits {
+	uint8_t status[0x8];
+	uint8_t reserved_at_8[0x18];
+
+	uint8_t syndrome[0x20];
+
+	uint8_t reserved_at_40[0x8];
+	uint8_t transport_domain[0x18];
+
+	uint8_t reserved_at_60[0x20];
+};
+
+struct mlx5_ifc_alloc_transport_domain_in_bits {
+	uint8_t opcode[0x10];
+	uint8_t uid[0x10];
+
+	uint8_t reserved_at_20[0x10];
+	uint8_t op_mod[0x10];
+
+	uint8_t reserved_at_40[0x40];
+};
+
+struct mlx5_ifc_rq_num_bits {
+	uint8_t reserved_at_0[0x8];
+	uint8_t rq_num[0x18];
+};
+
+struct mlx5_ifc_rqtc_bits {
+	uint8_t reserved_at_0[0xa0];
+
+	uint8_t reserved_at_a0[0x5];
+	uint8_t list_q_type[0x3];
+	uint8_t reserved_at_a8[0x8];
+	uint8_t rqt_max_size[0x10];
+
+	uint8_t rq_vhca_id_format[0x1];
+	uint8_t reserved_at_c1[0xf];
+	uint8_t rqt_actual_size[0x10];
+
+	uint8_t reserved_at_e0[0x6a0];
+
+	struct mlx5_ifc_rq_num_bits rq_num[];
+};
+
+struct mlx5_ifc_create_rqt_out_bits {
+	uint8_t status[0x8];
+	uint8_t reserved_at_8[0x18];
+
+	uint8_t syndrome[0x20];
+
+	uint8_t reserved_at_40[0x8];
+	uint8_t rqtn[0x18];
+
+	uint8_t reserved_at_60[0x20];
+};
+
+struct mlx5_ifc_create_rqt_in_bits {
+	uint8_t opcode[0x10];
+	uint8_t uid[0x10];
+
+	uint8_t reserved_at_20[0x10];
+	uint8_t op_mod[0x10];
+
+	uint8_t reserved_at_40[0xc0];
+
+	struct mlx5_ifc_rqtc_bits rqt_context;
+};
+
+struct mlx5_ifc_rx_hash_field_select_bits {
+	uint8_t l3_prot_type[0x1];
+	uint8_t l4_prot_type[0x1];
+	uint8_t selected_fields[0x1e];
+};
+
+struct mlx5_ifc_tirc_bits {
+	uint8_t reserved_at_0[0x20];
+
+	uint8_t disp_type[0x4];
+	uint8_t tls_en[0x1];
+	uint8_t reserved_at_25[0x1b];
+
+	uint8_t reserved_at_40[0x40];
+
+	uint8_t reserved_at_80[0x4];
+	uint8_t lro_timeout_period_usecs[0x10];
+	uint8_t packet_merge_mask[0x4];
+	uint8_t lro_max_ip_payload_size[0x8];
+
+	uint8_t reserved_at_a0[0x40];
+
+	uint8_t reserved_at_e0[0x8];
+	uint8_t inline_rqn[0x18];
+
+	uint8_t rx_hash_symmetric[0x1];
+	uint8_t reserved_at_101[0x1];
+	uint8_t tunneled_offload_en[0x1];
+	uint8_t reserved_at_103[0x5];
+	uint8_t indirect_table[0x18];
+
+	uint8_t rx_hash_fn[0x4];
+	uint8_t reserved_at_124[0x2];
+	uint8_t self_lb_block[0x2];
+	uint8_t transport_domain[0x18];
+
+	uint8_t rx_hash_toeplitz_key[10][0x20];
+
+	struct mlx5_ifc_rx_hash_field_select_bits rx_hash_field_selector_outer;
+
+	struct mlx5_ifc_rx_hash_field_select_bits rx_hash_field_selector_inner;
+
+	uint8_t reserved_at_2c0[0x4c0];
+};
+
+struct mlx5_ifc_create_tir_out_bits {
+	uint8_t status[0x8];
+	uint8_t reserved_at_8[0x18];
+
+	uint8_t syndrome[0x20];
+
+	uint8_t reserved_at_40[0x8];
+	uint8_t tirn[0x18];
+
+	uint8_t reserved_at_60[0x20];
+};
+
+struct mlx5_ifc_create_tir_in_bits {
+	uint8_t opcode[0x10];
+	uint8_t uid[0x10];
+
+	uint8_t reserved_at_20[0x10];
+	uint8_t op_mod[0x10];
+
+	uint8_t reserved_at_40[0xc0];
+
+	struct mlx5_ifc_tirc_bits tir_context;
+};
+
 struct dr_flow_table {
 	struct mlx5dv_dr_table		*dr_table;		/* DR table in the domain at specific level */
 	struct mlx5dv_dr_matcher	*dr_matcher;		/* DR matcher object in the table. One matcher per table */
@@ -84,19 +272,10 @@ struct dr_flow_rule {
 	struct mlx5dv_dr_rule		*dr_rule;		/* Steering rule */
 };
 
-/* L2 Reflector configuration structure */
-struct l2_reflector_config {
-	char 			device_name[DOCA_DEVINFO_IBDEV_NAME_SIZE];	/* IB device name */
+/* Queue set handled by one device thread */
+struct l2_reflector_queues {
 	struct l2_reflector_data	*dev_data;		/* device data */
-
-	/* IB Verbs resources */
-	struct ibv_context		*ibv_ctx;		/* IB device context */
-	struct ibv_pd			*pd;			/* Protection domain */
-
-	/* FlexIO resources */
 	flexio_uintptr_t		dev_data_daddr;		/* Data address accessible by the device */
-	struct flexio_process		*flexio_process;	/* FlexIO process */
-	struct flexio_uar		*flexio_uar;		/* FlexIO UAR */
 	struct flexio_event_handler	*event_handler;		/* Event handler on device */
 
 	struct app_transfer_cq		rq_cq_transf;
@@ -112,6 +291,28 @@ struct l2_reflector_config {
 	struct flexio_cq		*flexio_sq_cq_ptr;	/* FlexIO SQ CQ */
 	struct flexio_rq		*flexio_rq_ptr;		/* FlexIO RQ */
 	struct flexio_sq		*flexio_sq_ptr;		/* FlexIO SQ */
+};
+
+/* L2 Reflector configuration structure */
+struct l2_reflector_config {
+	char 			device_name[DOCA_DEVINFO_IBDEV_NAME_SIZE];	/* IB device name */
+	uint32_t			batch_size;		/* Maximal number of packets handled per doorbell */
+	bool				zero_copy;		/* Send the packets from the RQ buffers */
+	uint32_t			nb_threads;		/* Number of device threads, one queue set each */
+
+	/* IB Verbs resources */
+	struct ibv_context		*ibv_ctx;		/* IB device context */
+	struct ibv_pd			*pd;			/* Protection domain */
+
+	/* FlexIO resources */
+	struct flexio_process		*flexio_process;	/* FlexIO process */
+	struct flexio_uar		*flexio_uar;		/* FlexIO UAR */
+	struct l2_reflector_queues	*queues;		/* Queue sets, nb_threads entries */
+
+	/* RSS resources, used when there is more than one queue set */
+	struct mlx5dv_devx_obj		*rss_td;		/* Transport domain of the TIR */
+	struct mlx5dv_devx_obj		*rss_rqt;		/* Indirection table of the RQs */
+	struct mlx5dv_devx_obj		*rss_tir;		/* TIR hashing the packets over the RQT */
 
 	/* mlx5dv direct rules resources, used for steering rules */
 	struct mlx5dv_dr_domain		*rx_domain;
@@ -136,7 +337,7 @@ struct l2_reflector_config {
 doca_error_t l2_reflector_setup_ibv_device(struct l2_reflector_config *app_cfg);
 
 /*
- * Allocate FlexIO process and device resources
+ * Allocate FlexIO process and one event handler per queue set
  *
  * @app_cfg [in]: application configuration structure
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
@@ -144,7 +345,7 @@ doca_error_t l2_reflector_setup_ibv_device(struct l2_reflector_config *app_cfg);
 doca_error_t l2_reflector_setup_device(struct l2_reflector_config *app_cfg);
 
 /*
- * Allocate device memory and WQs
+ * Allocate device memory and WQs of every queue set
  *
  * @app_cfg [in]: application configuration structure
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
@@ -152,7 +353,7 @@ doca_error_t l2_reflector_setup_device(struct l2_reflector_config *app_cfg);
 doca_error_t l2_reflector_allocate_device_resources(struct l2_reflector_config *app_cfg);
 
 /*
- * Create steering rule that sends all packets to the device
+ * Create steering rule that sends all packets to the device, spread over the queue sets with RSS
  *
  * @app_cfg [in]: application configuration structure
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <endian.h>
+#include <setjmp.h>
+#include <stddef.h>
+
+#include <libflexio-dev/flexio_dev.h>
+#include <libflexio-dev/flexio_dev_queue_access.h>
+
+#include "flexio_dev_model.h"
+
+#define MLX5_OPCODE_SEND (0x0a)		/* mlx5 send WQE opcode */
+#define CTRL_SEG_CE_SHIFT (2)		/* Completion request mode offset in the control segment */
+#define SEND_WQE_NUM_DS (3)		/* Control, Ethernet and data segments */
+#define DBR_PI_MASK (0xffff)		/* RQ doorbell record producer index mask */
+#define DBR_CI_MASK (0xffffff)		/* CQ doorbell record consumer index mask */
+
+/* Thread context, the model runs a single device thread */
+struct flexio_dev_thread_ctx {
+	jmp_buf reschedule;				/* Where flexio_dev_thread_reschedule() returns to */
+	const struct flexio_dev_model_nic_ops *nic;	/* NIC the doorbells go to */
+};
+
+static struct flexio_dev_thread_ctx thread_ctx;
+
+void
+flexio_dev_model_set_nic(const struct flexio_dev_model_nic_ops *ops)
+{
+	thread_ctx.nic = ops;
+}
+
+void
+flexio_dev_model_run_event_handler(flexio_dev_event_handler_t *handler, uint64_t arg)
+{
+	if (setjmp(thread_ctx.reschedule) == 0)
+		handler(arg);
+}
+
+int
+flexio_dev_get_thread_ctx(struct flexio_dev_thread_ctx **dtctx)
+{
+	*dtctx = &thread_ctx;
+	return 0;
+}
+
+void
+flexio_dev_thread_reschedule(void)
+{
+	longjmp(thread_ctx.reschedule, 1);
+}
+
+uint8_t
+flexio_dev_cqe_get_owner(struct flexio_dev_cqe64 *cqe)
+{
+	return cqe->op_own & 0x1;
+}
+
+uint16_t
+flexio_dev_cqe_get_wqe_counter(struct flexio_dev_cqe64 *cqe)
+{
+	return be16toh(cqe->wqe_counter);
+}
+
+uint32_t
+flexio_dev_cqe_get_byte_cnt(struct flexio_dev_cqe64 *cqe)
+{
+	return be32toh(cqe->byte_cnt);
+}
+
+void *
+flexio_dev_rwqe_get_addr(struct flexio_dev_wqe_rcv_data_seg *rwqe)
+{
+	return (void *)(uintptr_t)be64toh(rwqe->addr);
+}
+
+flexio_dev_status_t
+flexio_dev_swqe_seg_ctrl_set(union flexio_dev_sqe_seg *swqe, uint32_t sq_pi, uint32_t sq_number, uint32_t ce,
+			     enum flexio_ctrl_seg_t ctrl_seg_type)
+{
+	if (ctrl_seg_type != FLEXIO_CTRL_SEG_SEND_EN)
+		return FLEXIO_DEV_STATUS_FAILED;
+
+	swqe->ctrl.idx_opcode = htobe32(((sq_pi & 0xffff) << 8) | MLX5_OPCODE_SEND);
+	swqe->ctrl.qpn_ds = htobe32((sq_number << 8) | SEND_WQE_NUM_DS);
+	swqe->ctrl.signature_fm_ce_se = htobe32(ce << CTRL_SEG_CE_SHIFT);
+	swqe->ctrl.general_id = 0;
+	return FLEXIO_DEV_STATUS_SUCCESS;
+}
+
+flexio_dev_status_t
+flexio_dev_swqe_seg_eth_set(union flexio_dev_sqe_seg *swqe, uint16_t mss, uint16_t cs_swp_flags,
+			    uint16_t inline_hdr_bsize, uint8_t *inline_hdr_bytes)
+{
+	(void)inline_hdr_bytes;
+
+	if (inline_hdr_bsize != 0)
+		return FLEXIO_DEV_STATUS_FAILED;
+
+	swqe->eth.rsvd0 = 0;
+	swqe->eth.cs_swp_flags = cs_swp_flags;
+	swqe->eth.rsvd1 = 0;
+	swqe->eth.mss = htobe16(mss);
+	swqe->eth.rsvd2 = 0;
+	swqe->eth.inline_hdr_bsz = 0;
+	return FLEXIO_DEV_STATUS_SUCCESS;
+}
+
+void
+flexio_dev_swqe_seg_mem_ptr_data_set(union flexio_dev_sqe_seg *swqe, uint32_t data_sz, uint32_t lkey,
+				     uint64_t data_addr)
+{
+	swqe->mem_ptr_send_data.byte_count = htobe32(data_sz);
+	swqe->mem_ptr_send_data.lkey = htobe32(lkey);
+	swqe->mem_ptr_send_data.addr = htobe64(data_addr);
+}
+
+void
+flexio_dev_qp_sq_ring_db(struct flexio_dev_thread_ctx *dtctx, uint16_t sq_pi, uint32_t qp_qpn)
+{
+	dtctx->nic->sq_ring_db(dtctx->nic->ctx, sq_pi, qp_qpn);
+}
+
+void
+flexio_dev_dbr_cq_set_ci(uint32_t *cq_dbr, uint32_t ci)
+{
+	*cq_dbr = htobe32(ci & DBR_CI_MASK);
+}
+
+void
+flexio_dev_dbr_rq_inc_pi(uint32_t *rq_dbr)
+{
+	*rq_dbr = htobe32((be32toh(*rq_dbr) + 1) & DBR_PI_MASK);
+}
+
+void
+flexio_dev_cq_arm(struct flexio_dev_thread_ctx *dtctx, uint32_t ci, uint32_t cq_num)
+{
+	dtctx->nic->cq_arm(dtctx->nic->ctx, ci, cq_num);
+}
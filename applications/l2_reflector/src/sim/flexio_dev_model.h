@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef FLEXIO_DEV_MODEL_H_
+#define FLEXIO_DEV_MODEL_H_
+
+#include <stdint.h>
+
+#include <libflexio-dev/flexio_dev.h>
+
+/* NIC side of the device API, implemented by the simulator */
+struct flexio_dev_model_nic_ops {
+	void (*sq_ring_db)(void *ctx, uint16_t sq_pi, uint32_t sq_number);	/* SQ doorbell was rung */
+	void (*cq_arm)(void *ctx, uint32_t ci, uint32_t cq_number);		/* CQ was armed */
+	void *ctx;								/* Simulator context */
+};
+
+/*
+ * Set the NIC that the device API doorbells go to
+ *
+ * @ops [in]: NIC callbacks, must stay valid while the device code runs
+ */
+void flexio_dev_model_set_nic(const struct flexio_dev_model_nic_ops *ops);
+
+/*
+ * Run a device event handler until it reschedules its thread
+ *
+ * @handler [in]: Device event handler
+ * @arg [in]: Handler argument
+ */
+void flexio_dev_model_run_event_handler(flexio_dev_event_handler_t *handler, uint64_t arg);
+
+#endif /* FLEXIO_DEV_MODEL_H_ */
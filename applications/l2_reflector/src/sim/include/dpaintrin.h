@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Host model of the DPA intrinsics.
+ * DPA fences order the device memory accesses against the NIC, on the host the NIC model runs on the same thread,
+ * so a compiler barrier keeps the order the device code relies on without adding x86 fences to the measured cycles.
+ */
+
+#ifndef L2_REFLECTOR_SIM_DPAINTRIN_H_
+#define L2_REFLECTOR_SIM_DPAINTRIN_H_
+
+#define __DPA_HEAP (1 << 0)	/* Heap memory space */
+#define __DPA_MEMORY (1 << 1)	/* Device memory space */
+#define __DPA_MMIO (1 << 2)	/* MMIO space */
+#define __DPA_SYSTEM (__DPA_HEAP | __DPA_MEMORY | __DPA_MMIO)
+
+#define __DPA_R (1 << 0)	/* Read accesses */
+#define __DPA_W (1 << 1)	/* Write accesses */
+#define __DPA_RW (__DPA_R | __DPA_W)
+
+#define __dpa_thread_fence(memory_space, pred_op, succ_op) __atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+#endif
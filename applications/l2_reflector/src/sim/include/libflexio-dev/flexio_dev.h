@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Host model of the FlexIO device API.
+ * Only what the l2_reflector device code uses is modeled. Thread rescheduling returns to the simulator that
+ * invoked the event handler, see flexio_dev_model.h.
+ */
+
+#ifndef L2_REFLECTOR_SIM_FLEXIO_DEV_H_
+#define L2_REFLECTOR_SIM_FLEXIO_DEV_H_
+
+#include <stdint.h>
+
+#define __dpa_rpc__		/* RPC handlers are plain functions on the host */
+#define __dpa_global__		/* Event handlers are plain functions on the host */
+#ifndef __unused
+#define __unused __attribute__((__unused__))
+#endif
+
+typedef uint64_t flexio_uintptr_t;
+
+/* Device API status */
+typedef enum {
+	FLEXIO_DEV_STATUS_SUCCESS = 0,
+	FLEXIO_DEV_STATUS_FAILED = 1,
+} flexio_dev_status_t;
+
+/* Thread context, opaque to the device code */
+struct flexio_dev_thread_ctx;
+
+typedef flexio_uintptr_t (flexio_dev_rpc_handler_t)(uint64_t arg1);
+typedef void (flexio_dev_event_handler_t)(uint64_t thread_arg);
+
+/*
+ * Get the context of the running thread
+ *
+ * @dtctx [out]: Thread context
+ * @return: 0 on success
+ */
+int flexio_dev_get_thread_ctx(struct flexio_dev_thread_ctx **dtctx);
+
+/*
+ * End the event handler, the thread runs again on the next event
+ */
+void flexio_dev_thread_reschedule(void) __attribute__((__noreturn__));
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/* Host model of the FlexIO device error API, the l2_reflector device code does not use it */
+
+#ifndef L2_REFLECTOR_SIM_FLEXIO_DEV_ERR_H_
+#define L2_REFLECTOR_SIM_FLEXIO_DEV_ERR_H_
+
+#include "flexio_dev.h"
+
+#endif
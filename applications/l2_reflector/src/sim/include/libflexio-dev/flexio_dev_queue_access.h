@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Host model of the FlexIO device queue access API.
+ * CQEs, RQ WQEs and SQ WQE segments have the mlx5 layouts and are big endian, like the ones the NIC reads and
+ * writes, so the device code runs on the same memory the host application sets up for it.
+ */
+
+#ifndef L2_REFLECTOR_SIM_FLEXIO_DEV_QUEUE_ACCESS_H_
+#define L2_REFLECTOR_SIM_FLEXIO_DEV_QUEUE_ACCESS_H_
+
+#include <stdint.h>
+
+#include "flexio_dev.h"
+
+#define LOG_SQE_NUM_SEGS 2	/* Log of the number of 16B segments in a 64B SQ WQE basic block */
+
+/* CQE completion request modes of the SQ WQE control segment */
+enum cq_ce_mode {
+	MLX5_CTRL_SEG_CE_CQE_ON_CQE_ERROR = 0x0,
+	MLX5_CTRL_SEG_CE_CQE_ON_FIRST_CQE_ERROR = 0x1,
+	MLX5_CTRL_SEG_CE_CQE_ALWAYS = 0x2,
+	MLX5_CTRL_SEG_CE_CQE_AND_EQE = 0x3,
+};
+
+/* SQ WQE types */
+enum flexio_ctrl_seg_t {
+	FLEXIO_CTRL_SEG_SEND_EN = 0,
+};
+
+/* 64B CQE */
+struct flexio_dev_cqe64 {
+	uint8_t rsvd0[44];
+	uint32_t byte_cnt;	/* Received bytes, big endian */
+	uint8_t rsvd48[12];
+	uint16_t wqe_counter;	/* Index of the completed WQE, big endian */
+	uint8_t signature;
+	uint8_t op_own;		/* Opcode (4 high bits) and owner bit (bit 0) */
+} __attribute__((__packed__));
+
+/* RQ WQE data segment */
+struct flexio_dev_wqe_rcv_data_seg {
+	uint32_t byte_count;	/* Buffer size, big endian */
+	uint32_t lkey;		/* Buffer memory key, big endian */
+	uint64_t addr;		/* Buffer address, big endian */
+} __attribute__((__packed__));
+
+/* SQ WQE control segment */
+struct flexio_dev_wqe_ctrl_seg {
+	uint32_t idx_opcode;		/* WQE index (bits 8-23) and opcode (bits 0-7), big endian */
+	uint32_t qpn_ds;		/* SQ number (bits 8-31) and number of 16B segments (bits 0-5), big endian */
+	uint32_t signature_fm_ce_se;	/* Completion request mode (bits 2-3), big endian */
+	uint32_t general_id;
+} __attribute__((__packed__));
+
+/* SQ WQE Ethernet segment */
+struct flexio_dev_wqe_eth_seg {
+	uint32_t rsvd0;
+	uint8_t cs_swp_flags;
+	uint8_t rsvd1;
+	uint16_t mss;
+	uint32_t rsvd2;
+	uint16_t inline_hdr_bsz;
+	uint8_t inline_hdr_bytes[2];
+} __attribute__((__packed__));
+
+/* SQ WQE data segment pointing to the data to send */
+struct flexio_dev_wqe_mem_ptr_send_data_seg {
+	uint32_t byte_count;	/* Data size, big endian */
+	uint32_t lkey;		/* Data memory key, big endian */
+	uint64_t addr;		/* Data address, big endian */
+} __attribute__((__packed__));
+
+/* 16B SQ WQE segment */
+union flexio_dev_sqe_seg {
+	struct flexio_dev_wqe_ctrl_seg ctrl;
+	struct flexio_dev_wqe_eth_seg eth;
+	struct flexio_dev_wqe_mem_ptr_send_data_seg mem_ptr_send_data;
+};
+
+/*
+ * Get the owner bit of a CQE
+ *
+ * @cqe [in]: CQE
+ * @return: Owner bit
+ */
+uint8_t flexio_dev_cqe_get_owner(struct flexio_dev_cqe64 *cqe);
+
+/*
+ * Get the index of the WQE that a CQE completes
+ *
+ * @cqe [in]: CQE
+ * @return: WQE index
+ */
+uint16_t flexio_dev_cqe_get_wqe_counter(struct flexio_dev_cqe64 *cqe);
+
+/*
+ * Get the number of bytes a CQE completes
+ *
+ * @cqe [in]: CQE
+ * @return: Number of bytes
+ */
+uint32_t flexio_dev_cqe_get_byte_cnt(struct flexio_dev_cqe64 *cqe);
+
+/*
+ * Get the buffer address of a RQ WQE
+ *
+ * @rwqe [in]: RQ WQE data segment
+ * @return: Buffer address
+ */
+void *flexio_dev_rwqe_get_addr(struct flexio_dev_wqe_rcv_data_seg *rwqe);
+
+/*
+ * Fill a SQ WQE control segment
+ *
+ * @swqe [in]: SQ WQE segment
+ * @sq_pi [in]: SQ producer index of the WQE
+ * @sq_number [in]: SQ number
+ * @ce [in]: Completion request mode (enum cq_ce_mode)
+ * @ctrl_seg_type [in]: WQE type
+ * @return: FLEXIO_DEV_STATUS_SUCCESS on success and FLEXIO_DEV_STATUS_FAILED otherwise
+ */
+flexio_dev_status_t flexio_dev_swqe_seg_ctrl_set(union flexio_dev_sqe_seg *swqe, uint32_t sq_pi, uint32_t sq_number,
+						 uint32_t ce, enum flexio_ctrl_seg_t ctrl_seg_type);
+
+/*
+ * Fill a SQ WQE Ethernet segment
+ *
+ * @swqe [in]: SQ WQE segment
+ * @mss [in]: Maximum segment size, 0 for no LSO
+ * @cs_swp_flags [in]: Checksum offload flags
+ * @inline_hdr_bsize [in]: Size of the inline header, only 0 is modeled
+ * @inline_hdr_bytes [in]: Inline header
+ * @return: FLEXIO_DEV_STATUS_SUCCESS on success and FLEXIO_DEV_STATUS_FAILED otherwise
+ */
+flexio_dev_status_t flexio_dev_swqe_seg_eth_set(union flexio_dev_sqe_seg *swqe, uint16_t mss, uint16_t cs_swp_flags,
+						uint16_t inline_hdr_bsize, uint8_t *inline_hdr_bytes);
+
+/*
+ * Fill a SQ WQE data segment
+ *
+ * @swqe [in]: SQ WQE segment
+ * @data_sz [in]: Data size
+ * @lkey [in]: Data memory key
+ * @data_addr [in]: Data address
+ */
+void flexio_dev_swqe_seg_mem_ptr_data_set(union flexio_dev_sqe_seg *swqe, uint32_t data_sz, uint32_t lkey,
+					  uint64_t data_addr);
+
+/*
+ * Ring the SQ doorbell, the NIC sends the WQEs up to sq_pi
+ *
+ * @dtctx [in]: Thread context
+ * @sq_pi [in]: SQ producer index
+ * @qp_qpn [in]: SQ number
+ */
+void flexio_dev_qp_sq_ring_db(struct flexio_dev_thread_ctx *dtctx, uint16_t sq_pi, uint32_t qp_qpn);
+
+/*
+ * Set the consumer index in a CQ doorbell record
+ *
+ * @cq_dbr [in]: CQ doorbell record
+ * @ci [in]: CQ consumer index
+ */
+void flexio_dev_dbr_cq_set_ci(uint32_t *cq_dbr, uint32_t ci);
+
+/*
+ * Increment the producer index in a RQ doorbell record, giving a WQE back to the NIC
+ *
+ * @rq_dbr [in]: RQ doorbell record
+ */
+void flexio_dev_dbr_rq_inc_pi(uint32_t *rq_dbr);
+
+/*
+ * Arm a CQ, the NIC raises an event on the next CQE after ci
+ *
+ * @dtctx [in]: Thread context
+ * @ci [in]: CQ consumer index
+ * @cq_num [in]: CQ number
+ */
+void flexio_dev_cq_arm(struct flexio_dev_thread_ctx *dtctx, uint32_t ci, uint32_t cq_num);
+
+#endif
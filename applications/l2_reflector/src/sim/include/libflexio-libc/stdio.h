@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/* Host model of the FlexIO device libc, the device code runs on the host libc */
+
+#ifndef L2_REFLECTOR_SIM_FLEXIO_LIBC_STDIO_H_
+#define L2_REFLECTOR_SIM_FLEXIO_LIBC_STDIO_H_
+
+#include <stdio.h>
+
+#endif
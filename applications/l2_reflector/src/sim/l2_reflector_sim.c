@@ -0,0 +1,841 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Host simulator of the L2 reflector device code.
+ * The device code is built for the host against a software model of the FlexIO device API (see include/), and
+ * this file models the NIC side: it receives the packets of a pcap file into the RQ, writes the RQ CQEs with their
+ * owner bits, raises an event when the CQ is armed, and sends the SQ WQEs when the SQ doorbell is rung, completing
+ * the ones that request it on the SQ CQ.
+ * Every sent packet is checked against its received packet with swapped MAC addresses and may be written to a pcap
+ * file, and the cycles spent in the device event handler are reported per packet.
+ * With several threads every thread has its own queue set and the packets are spread over them like the RSS TIR
+ * of the host application does, with a Toeplitz hash of the IPv4 addresses.
+ */
+
+#include <byteswap.h>
+#include <endian.h>
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <libflexio-dev/flexio_dev.h>
+#include <libflexio-dev/flexio_dev_queue_access.h>
+
+#include "../common/l2_reflector_common.h"
+#include "flexio_dev_model.h"
+
+#define SIM_RQ_CQ_NUM (0x100)			/* RQ CQ number of the first queue set */
+#define SIM_RQ_NUM (0x200)			/* RQ number of the first queue set */
+#define SIM_SQ_CQ_NUM (0x300)			/* SQ CQ number of the first queue set */
+#define SIM_SQ_NUM (0x400)			/* SQ number of the first queue set */
+#define SIM_RQ_MKEY (0x1111)			/* RQ data memory key */
+#define SIM_SQ_MKEY (0x2222)			/* SQ data memory key */
+#define SIM_DATA_ENTRY_BSIZE (1 << L2_LOG_WQ_DATA_ENTRY_BSIZE)	/* Size of a RQ/SQ data entry */
+#define SIM_CQ_DEPTH (1 << L2_LOG_CQ_RING_DEPTH)	/* Number of CQEs */
+#define SIM_RQ_DEPTH (1 << L2_LOG_RQ_RING_DEPTH)	/* Number of RQ WQEs */
+#define SIM_SQ_DEPTH (1 << L2_LOG_SQ_RING_DEPTH)	/* Number of SQ WQEs */
+#define SIM_SQ_NUM_SEGS (SIM_SQ_DEPTH << LOG_SQE_NUM_SEGS)	/* Number of 16B SQ WQE segments */
+#define SIM_CQE_OPCODE_REQ (0x0)		/* mlx5 requester CQE opcode */
+#define SIM_CQE_OPCODE_RESP_SEND (0x2)		/* mlx5 responder send CQE opcode */
+#define SIM_MLX5_OPCODE_SEND (0x0a)		/* mlx5 send WQE opcode */
+#define SIM_CTRL_SEG_CE_SHIFT (2)		/* Completion request mode offset in the control segment */
+#define SIM_INFLIGHT_DEPTH (2 * SIM_RQ_DEPTH)	/* Received packets that were not sent yet */
+#define SIM_BURST_DEFAULT (32)			/* Packets the NIC receives between two events */
+#define SIM_ITERATIONS_DEFAULT (1)		/* Number of times the pcap file is replayed */
+#define SIM_THREADS_DEFAULT (1)			/* Number of device threads */
+#define ETHER_ADDR_LEN (6)			/* Size of a MAC address */
+#define ETHER_HDR_LEN (14)			/* Size of the Ethernet header */
+#define ETHER_TYPE_IPV4 (0x0800)		/* IPv4 ethertype */
+#define IPV4_SRC_ADDR_OFFSET (12)		/* Offset of the source address in the IPv4 header */
+
+#define PCAP_MAGIC (0xa1b2c3d4)			/* pcap file magic, microsecond timestamps */
+#define PCAP_MAGIC_NSEC (0xa1b23c4d)		/* pcap file magic, nanosecond timestamps */
+
+/* Device code entry points */
+uint64_t l2_reflector_device_init(uint64_t data);
+uint64_t l2_reflector_device_packets_count(uint64_t arg);
+void l2_reflector_device_event_handler(uint64_t arg0);
+
+/* pcap file header */
+struct pcap_file_hdr {
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+/* pcap packet header */
+struct pcap_pkt_hdr {
+	uint32_t ts_sec;
+	uint32_t ts_frac;
+	uint32_t caplen;
+	uint32_t len;
+};
+
+/* Packet of the input pcap file */
+struct sim_packet {
+	struct pcap_pkt_hdr hdr;	/* pcap header, in host order */
+	uint8_t *data;			/* Packet data */
+};
+
+/* Input pcap file */
+struct sim_pcap {
+	struct pcap_file_hdr hdr;	/* pcap file header, in host order */
+	struct sim_packet *packets;	/* Packets */
+	size_t nb_packets;		/* Number of packets */
+};
+
+/* NIC model and the device memory it shares with the device code */
+struct sim_nic {
+	/* Device memory */
+	struct flexio_dev_cqe64 *rq_cq_ring;		/* RQ CQ ring */
+	struct flexio_dev_cqe64 *sq_cq_ring;		/* SQ CQ ring */
+	struct flexio_dev_wqe_rcv_data_seg *rq_ring;	/* RQ ring */
+	union flexio_dev_sqe_seg *sq_ring;		/* SQ ring */
+	uint8_t *rq_data;				/* RQ data buffers */
+	uint8_t *sq_data;				/* SQ data buffers */
+	uint32_t *rq_cq_dbr;				/* RQ CQ doorbell record */
+	uint32_t *sq_cq_dbr;				/* SQ CQ doorbell record */
+	uint32_t *rq_dbr;				/* RQ doorbell record (receive and send counters) */
+	uint32_t *sq_dbr;				/* SQ doorbell record (receive and send counters) */
+	struct l2_reflector_data dev_data;		/* Queues description passed to the device init */
+
+	/* Queue numbers */
+	uint32_t rq_cq_num;		/* RQ CQ number */
+	uint32_t sq_cq_num;		/* SQ CQ number */
+	uint32_t sq_num;		/* SQ number */
+	struct flexio_dev_model_nic_ops ops;	/* Device API callbacks of this queue set */
+
+	/* NIC state */
+	uint16_t rq_ci;			/* Next RQ WQE to receive into */
+	uint32_t rq_cq_pi;		/* Next RQ CQE to write */
+	uint16_t sq_ci;			/* Next SQ WQE to send */
+	uint32_t sq_cq_pi;		/* Next SQ CQE to write */
+	bool cq_armed;			/* The RQ CQ raises an event on the next CQE */
+	bool sq_cq_armed;		/* The SQ CQ raises an event on the next CQE */
+	bool event_pending;		/* An event was raised and the handler did not run yet */
+
+	/* Received packets waiting to be sent, in order */
+	const struct sim_packet *inflight[SIM_INFLIGHT_DEPTH];
+	uint32_t inflight_head;		/* Oldest received packet */
+	uint32_t inflight_tail;		/* Next received packet slot */
+
+	/* Output */
+	FILE *out;			/* Output pcap file, NULL to not write the sent packets */
+
+	/* Statistics */
+	uint64_t rx_packets;		/* Packets received into the RQ */
+	uint64_t rx_drops;		/* Packets dropped for lack of RQ WQEs or CQEs */
+	uint64_t rx_oversize;		/* Packets larger than a RQ data entry */
+	uint64_t tx_packets;		/* Packets sent from the SQ */
+	uint64_t tx_errors;		/* Malformed SQ WQEs */
+	uint64_t mismatches;		/* Sent packets that are not the reflected received packet */
+	uint64_t events;		/* Event handler invocations */
+	uint64_t doorbells;		/* SQ doorbells */
+	uint64_t sq_cqes;		/* SQ CQEs written */
+	uint64_t nic_cycles;		/* Cycles spent in the NIC model while the event handler runs */
+};
+
+/*
+ * Read the cycle counter, or a nanosecond clock where there is no cycle counter
+ *
+ * @return: Current cycle count
+ */
+static inline uint64_t
+sim_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/*
+ * Load a pcap file in memory
+ *
+ * @path [in]: pcap file path
+ * @pcap [out]: Loaded pcap file
+ * @return: 0 on success and -1 otherwise
+ */
+static int
+load_pcap(const char *path, struct sim_pcap *pcap)
+{
+	struct pcap_pkt_hdr hdr;
+	struct sim_packet *packets;
+	size_t capacity = 0;
+	bool swapped;
+	FILE *file;
+
+	memset(pcap, 0, sizeof(*pcap));
+	file = fopen(path, "rb");
+	if (file == NULL) {
+		fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	if (fread(&pcap->hdr, sizeof(pcap->hdr), 1, file) != 1) {
+		fprintf(stderr, "Failed to read pcap header of %s\n", path);
+		goto close_file;
+	}
+	swapped = (pcap->hdr.magic == bswap_32(PCAP_MAGIC) || pcap->hdr.magic == bswap_32(PCAP_MAGIC_NSEC));
+	if (swapped) {
+		pcap->hdr.magic = bswap_32(pcap->hdr.magic);
+		pcap->hdr.version_major = bswap_16(pcap->hdr.version_major);
+		pcap->hdr.version_minor = bswap_16(pcap->hdr.version_minor);
+		pcap->hdr.snaplen = bswap_32(pcap->hdr.snaplen);
+		pcap->hdr.linktype = bswap_32(pcap->hdr.linktype);
+	}
+	if (pcap->hdr.magic != PCAP_MAGIC && pcap->hdr.magic != PCAP_MAGIC_NSEC) {
+		fprintf(stderr, "%s is not a pcap file (pcapng is not supported)\n", path);
+		goto close_file;
+	}
+
+	while (fread(&hdr, sizeof(hdr), 1, file) == 1) {
+		if (swapped) {
+			hdr.ts_sec = bswap_32(hdr.ts_sec);
+			hdr.ts_frac = bswap_32(hdr.ts_frac);
+			hdr.caplen = bswap_32(hdr.caplen);
+			hdr.len = bswap_32(hdr.len);
+		}
+		if (pcap->nb_packets == capacity) {
+			capacity = capacity ? capacity * 2 : 1024;
+			packets = realloc(pcap->packets, capacity * sizeof(*packets));
+			if (packets == NULL) {
+				fprintf(stderr, "Failed to allocate memory for packets\n");
+				goto free_packets;
+			}
+			pcap->packets = packets;
+		}
+		pcap->packets[pcap->nb_packets].hdr = hdr;
+		pcap->packets[pcap->nb_packets].data = malloc(hdr.caplen ? hdr.caplen : 1);
+		if (pcap->packets[pcap->nb_packets].data == NULL) {
+			fprintf(stderr, "Failed to allocate memory for packet\n");
+			goto free_packets;
+		}
+		pcap->nb_packets++;
+		if (hdr.caplen != 0 && fread(pcap->packets[pcap->nb_packets - 1].data, hdr.caplen, 1, file) != 1) {
+			fprintf(stderr, "Truncated packet %zu in %s\n", pcap->nb_packets, path);
+			goto free_packets;
+		}
+	}
+
+	fclose(file);
+	return 0;
+
+free_packets:
+	while (pcap->nb_packets > 0)
+		free(pcap->packets[--pcap->nb_packets].data);
+	free(pcap->packets);
+	pcap->packets = NULL;
+close_file:
+	fclose(file);
+	return -1;
+}
+
+/*
+ * Free a loaded pcap file
+ *
+ * @pcap [in]: Loaded pcap file
+ */
+static void
+free_pcap(struct sim_pcap *pcap)
+{
+	size_t i;
+
+	for (i = 0; i < pcap->nb_packets; i++)
+		free(pcap->packets[i].data);
+	free(pcap->packets);
+}
+
+/*
+ * Allocate the device memory and set it up like the host application does: CQEs owned by HW, RQ WQEs pointing to
+ * the RQ data buffers and all of them given to the NIC
+ *
+ * @nic [out]: NIC model
+ * @thread_idx [in]: Index of the queue set
+ * @return: 0 on success and -1 otherwise
+ */
+static int
+sim_nic_init(struct sim_nic *nic, uint32_t thread_idx)
+{
+	uint32_t *dbrs;
+	int i;
+
+	memset(nic, 0, sizeof(*nic));
+	nic->rq_cq_ring = aligned_alloc(64, SIM_CQ_DEPTH * sizeof(*nic->rq_cq_ring));
+	nic->sq_cq_ring = aligned_alloc(64, SIM_CQ_DEPTH * sizeof(*nic->sq_cq_ring));
+	nic->rq_ring = aligned_alloc(64, SIM_RQ_DEPTH * sizeof(*nic->rq_ring));
+	nic->sq_ring = aligned_alloc(64, SIM_SQ_NUM_SEGS * sizeof(*nic->sq_ring));
+	nic->rq_data = aligned_alloc(64, (size_t)SIM_RQ_DEPTH * SIM_DATA_ENTRY_BSIZE);
+	nic->sq_data = aligned_alloc(64, (size_t)SIM_SQ_DEPTH * SIM_DATA_ENTRY_BSIZE);
+	dbrs = aligned_alloc(64, 64);
+	if (nic->rq_cq_ring == NULL || nic->sq_cq_ring == NULL || nic->rq_ring == NULL || nic->sq_ring == NULL ||
+	    nic->rq_data == NULL || nic->sq_data == NULL || dbrs == NULL) {
+		fprintf(stderr, "Failed to allocate device memory\n");
+		free(dbrs);
+		return -1;
+	}
+	memset(dbrs, 0, 64);
+	memset(nic->sq_ring, 0, SIM_SQ_NUM_SEGS * sizeof(*nic->sq_ring));
+	nic->rq_cq_dbr = &dbrs[0];
+	nic->sq_cq_dbr = &dbrs[2];
+	nic->rq_dbr = &dbrs[4];
+	nic->sq_dbr = &dbrs[6];
+
+	/* CQEs start owned by HW, the NIC writes owner 0 on the first pass */
+	memset(nic->rq_cq_ring, 0, SIM_CQ_DEPTH * sizeof(*nic->rq_cq_ring));
+	memset(nic->sq_cq_ring, 0, SIM_CQ_DEPTH * sizeof(*nic->sq_cq_ring));
+	for (i = 0; i < SIM_CQ_DEPTH; i++) {
+		nic->rq_cq_ring[i].op_own = 0x1;
+		nic->sq_cq_ring[i].op_own = 0x1;
+	}
+
+	for (i = 0; i < SIM_RQ_DEPTH; i++) {
+		nic->rq_ring[i].byte_count = htobe32(SIM_DATA_ENTRY_BSIZE);
+		nic->rq_ring[i].lkey = htobe32(SIM_RQ_MKEY);
+		nic->rq_ring[i].addr = htobe64((uintptr_t)(nic->rq_data + (size_t)i * SIM_DATA_ENTRY_BSIZE));
+	}
+	nic->rq_dbr[0] = htobe32(SIM_RQ_DEPTH & 0xffff);
+
+	nic->rq_cq_num = SIM_RQ_CQ_NUM + thread_idx;
+	nic->sq_cq_num = SIM_SQ_CQ_NUM + thread_idx;
+	nic->sq_num = SIM_SQ_NUM + thread_idx;
+	nic->dev_data.thread_idx = thread_idx;
+	nic->dev_data.rq_cq_data.cq_num = nic->rq_cq_num;
+	nic->dev_data.rq_cq_data.log_cq_depth = L2_LOG_CQ_RING_DEPTH;
+	nic->dev_data.rq_cq_data.cq_ring_daddr = (uintptr_t)nic->rq_cq_ring;
+	nic->dev_data.rq_cq_data.cq_dbr_daddr = (uintptr_t)nic->rq_cq_dbr;
+	nic->dev_data.rq_data.wq_num = SIM_RQ_NUM + thread_idx;
+	nic->dev_data.rq_data.wqd_mkey_id = SIM_RQ_MKEY;
+	nic->dev_data.rq_data.wq_ring_daddr = (uintptr_t)nic->rq_ring;
+	nic->dev_data.rq_data.wq_dbr_daddr = (uintptr_t)nic->rq_dbr;
+	nic->dev_data.rq_data.wqd_daddr = (uintptr_t)nic->rq_data;
+	nic->dev_data.sq_cq_data.cq_num = nic->sq_cq_num;
+	nic->dev_data.sq_cq_data.log_cq_depth = L2_LOG_CQ_RING_DEPTH;
+	nic->dev_data.sq_cq_data.cq_ring_daddr = (uintptr_t)nic->sq_cq_ring;
+	nic->dev_data.sq_cq_data.cq_dbr_daddr = (uintptr_t)nic->sq_cq_dbr;
+	nic->dev_data.sq_data.wq_num = nic->sq_num;
+	nic->dev_data.sq_data.wqd_mkey_id = SIM_SQ_MKEY;
+	nic->dev_data.sq_data.wq_ring_daddr = (uintptr_t)nic->sq_ring;
+	nic->dev_data.sq_data.wq_dbr_daddr = (uintptr_t)nic->sq_dbr;
+	nic->dev_data.sq_data.wqd_daddr = (uintptr_t)nic->sq_data;
+
+	/* The host arms the RQ CQ when it creates it */
+	nic->cq_armed = true;
+	return 0;
+}
+
+/*
+ * Free the device memory
+ *
+ * @nic [in]: NIC model
+ */
+static void
+sim_nic_destroy(struct sim_nic *nic)
+{
+	free(nic->rq_cq_ring);
+	free(nic->sq_cq_ring);
+	free(nic->rq_ring);
+	free(nic->sq_ring);
+	free(nic->rq_data);
+	free(nic->sq_data);
+	free(nic->rq_cq_dbr);
+}
+
+/*
+ * Write a packet to the output pcap file
+ *
+ * @out [in]: Output pcap file
+ * @ts [in]: pcap header of the received packet, for the timestamp
+ * @data [in]: Packet data
+ * @len [in]: Packet length
+ */
+static void
+write_pcap_packet(FILE *out, const struct pcap_pkt_hdr *ts, const void *data, uint32_t len)
+{
+	struct pcap_pkt_hdr hdr = {.ts_sec = ts->ts_sec, .ts_frac = ts->ts_frac, .caplen = len, .len = len};
+
+	fwrite(&hdr, sizeof(hdr), 1, out);
+	fwrite(data, len, 1, out);
+}
+
+/*
+ * Receive a packet into the next RQ WQE and complete it on the RQ CQ, like the NIC does
+ *
+ * @nic [in]: NIC model
+ * @packet [in]: Packet to receive
+ */
+static void
+sim_nic_receive(struct sim_nic *nic, const struct sim_packet *packet)
+{
+	uint16_t rq_pi = be32toh(nic->rq_dbr[0]) & 0xffff;
+	uint32_t cq_ci = be32toh(nic->rq_cq_dbr[0]);
+	struct flexio_dev_wqe_rcv_data_seg *rwqe;
+	struct flexio_dev_cqe64 *cqe;
+	uint32_t len = packet->hdr.caplen;
+
+	if (len > SIM_DATA_ENTRY_BSIZE) {
+		nic->rx_oversize++;
+		return;
+	}
+	/* No posted RQ WQE, or no room in the CQ */
+	if (rq_pi == nic->rq_ci || (uint32_t)(nic->rq_cq_pi - cq_ci) >= SIM_CQ_DEPTH ||
+	    nic->inflight_tail - nic->inflight_head == SIM_INFLIGHT_DEPTH) {
+		nic->rx_drops++;
+		return;
+	}
+
+	rwqe = &nic->rq_ring[nic->rq_ci & L2_RQ_IDX_MASK];
+	memcpy((void *)(uintptr_t)be64toh(rwqe->addr), packet->data, len);
+
+	cqe = &nic->rq_cq_ring[nic->rq_cq_pi & L2_CQ_IDX_MASK];
+	cqe->byte_cnt = htobe32(len);
+	cqe->wqe_counter = htobe16(nic->rq_ci);
+	/* The owner bit is written last, it hands the CQE to the device */
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	cqe->op_own = (SIM_CQE_OPCODE_RESP_SEND << 4) | ((nic->rq_cq_pi >> L2_LOG_CQ_RING_DEPTH) & 0x1);
+
+	nic->inflight[nic->inflight_tail++ % SIM_INFLIGHT_DEPTH] = packet;
+	nic->rq_ci++;
+	nic->rq_cq_pi++;
+	nic->rx_packets++;
+	if (nic->cq_armed) {
+		nic->cq_armed = false;
+		nic->event_pending = true;
+	}
+}
+
+/*
+ * Check that a sent packet is the oldest received packet with swapped MAC addresses
+ *
+ * @nic [in]: NIC model
+ * @data [in]: Sent packet
+ * @len [in]: Sent packet length
+ */
+static void
+sim_nic_check_sent(struct sim_nic *nic, const uint8_t *data, uint32_t len)
+{
+	const struct sim_packet *packet;
+
+	if (nic->inflight_head == nic->inflight_tail) {
+		fprintf(stderr, "Packet %" PRIu64 " was sent but not received\n", nic->tx_packets);
+		nic->mismatches++;
+		return;
+	}
+	packet = nic->inflight[nic->inflight_head++ % SIM_INFLIGHT_DEPTH];
+
+	if (nic->out != NULL)
+		write_pcap_packet(nic->out, &packet->hdr, data, len);
+
+	if (len != packet->hdr.caplen || (len >= 2 * ETHER_ADDR_LEN &&
+	    (memcmp(data, packet->data + ETHER_ADDR_LEN, ETHER_ADDR_LEN) != 0 ||
+	     memcmp(data + ETHER_ADDR_LEN, packet->data, ETHER_ADDR_LEN) != 0 ||
+	     memcmp(data + 2 * ETHER_ADDR_LEN, packet->data + 2 * ETHER_ADDR_LEN, len - 2 * ETHER_ADDR_LEN) != 0))) {
+		if (nic->mismatches++ == 0)
+			fprintf(stderr, "Sent packet %" PRIu64 " is not the reflected received packet\n",
+				nic->tx_packets);
+	}
+}
+
+/*
+ * Complete a sent SQ WQE on the SQ CQ
+ *
+ * @nic [in]: NIC model
+ * @wqe_counter [in]: Index of the completed SQ WQE
+ */
+static void
+sim_nic_complete_send(struct sim_nic *nic, uint16_t wqe_counter)
+{
+	uint32_t cq_ci = be32toh(nic->sq_cq_dbr[0]);
+	struct flexio_dev_cqe64 *cqe;
+
+	if ((uint32_t)(nic->sq_cq_pi - cq_ci) >= SIM_CQ_DEPTH) {
+		if (nic->tx_errors++ == 0)
+			fprintf(stderr, "SQ CQ overrun on SQ WQE %u\n", wqe_counter);
+		return;
+	}
+
+	cqe = &nic->sq_cq_ring[nic->sq_cq_pi & L2_CQ_IDX_MASK];
+	cqe->byte_cnt = 0;
+	cqe->wqe_counter = htobe16(wqe_counter);
+	__atomic_signal_fence(__ATOMIC_SEQ_CST);
+	cqe->op_own = (SIM_CQE_OPCODE_REQ << 4) | ((nic->sq_cq_pi >> L2_LOG_CQ_RING_DEPTH) & 0x1);
+	nic->sq_cq_pi++;
+	nic->sq_cqes++;
+	if (nic->sq_cq_armed) {
+		nic->sq_cq_armed = false;
+		nic->event_pending = true;
+	}
+}
+
+/*
+ * SQ doorbell: send the SQ WQEs up to sq_pi, like the NIC does
+ *
+ * @ctx [in]: NIC model
+ * @sq_pi [in]: SQ producer index
+ * @sq_number [in]: SQ number
+ */
+static void
+sim_nic_sq_ring_db(void *ctx, uint16_t sq_pi, uint32_t sq_number)
+{
+	struct sim_nic *nic = (struct sim_nic *)ctx;
+	uint64_t start = sim_cycles();
+	union flexio_dev_sqe_seg *ctrl, *data;
+	uint32_t idx_opcode, qpn_ds, len;
+	uint8_t *addr;
+
+	nic->doorbells++;
+	if (sq_number != nic->sq_num) {
+		fprintf(stderr, "Doorbell rung on unknown SQ 0x%x\n", sq_number);
+		nic->tx_errors++;
+		goto out;
+	}
+
+	for (; nic->sq_ci != sq_pi; nic->sq_ci++) {
+		ctrl = &nic->sq_ring[(nic->sq_ci << LOG_SQE_NUM_SEGS) & L2_SQ_IDX_MASK];
+		idx_opcode = be32toh(ctrl->ctrl.idx_opcode);
+		qpn_ds = be32toh(ctrl->ctrl.qpn_ds);
+		if ((idx_opcode & 0xff) != SIM_MLX5_OPCODE_SEND || ((idx_opcode >> 8) & 0xffff) != nic->sq_ci ||
+		    (qpn_ds >> 8) != nic->sq_num || (qpn_ds & 0x3f) < 3) {
+			if (nic->tx_errors++ == 0)
+				fprintf(stderr, "Malformed SQ WQE %u: opcode/index 0x%x, qpn/ds 0x%x\n", nic->sq_ci,
+					idx_opcode, qpn_ds);
+			continue;
+		}
+
+		/* Control, Ethernet, then the data segment */
+		data = &nic->sq_ring[((nic->sq_ci << LOG_SQE_NUM_SEGS) + 2) & L2_SQ_IDX_MASK];
+		len = be32toh(data->mem_ptr_send_data.byte_count);
+		addr = (uint8_t *)(uintptr_t)be64toh(data->mem_ptr_send_data.addr);
+		if (be32toh(data->mem_ptr_send_data.lkey) == SIM_SQ_MKEY) {
+			if (addr < nic->sq_data || addr + len > nic->sq_data + (size_t)SIM_SQ_DEPTH * SIM_DATA_ENTRY_BSIZE)
+				addr = NULL;
+		} else if (be32toh(data->mem_ptr_send_data.lkey) == SIM_RQ_MKEY) {
+			if (addr < nic->rq_data || addr + len > nic->rq_data + (size_t)SIM_RQ_DEPTH * SIM_DATA_ENTRY_BSIZE)
+				addr = NULL;
+		} else {
+			addr = NULL;
+		}
+		if (addr == NULL) {
+			if (nic->tx_errors++ == 0)
+				fprintf(stderr, "SQ WQE %u points outside of its memory key\n", nic->sq_ci);
+			continue;
+		}
+
+		sim_nic_check_sent(nic, addr, len);
+		nic->tx_packets++;
+		if (((be32toh(ctrl->ctrl.signature_fm_ce_se) >> SIM_CTRL_SEG_CE_SHIFT) & 0x3) ==
+		    MLX5_CTRL_SEG_CE_CQE_ALWAYS)
+			sim_nic_complete_send(nic, nic->sq_ci);
+	}
+out:
+	nic->nic_cycles += sim_cycles() - start;
+}
+
+/*
+ * CQ arm: raise an event on the next CQE, or now if CQEs were written after ci
+ *
+ * @ctx [in]: NIC model
+ * @ci [in]: CQ consumer index
+ * @cq_number [in]: CQ number
+ */
+static void
+sim_nic_cq_arm(void *ctx, uint32_t ci, uint32_t cq_number)
+{
+	struct sim_nic *nic = (struct sim_nic *)ctx;
+
+	if (cq_number == nic->rq_cq_num) {
+		if (nic->rq_cq_pi != ci)
+			nic->event_pending = true;
+		else
+			nic->cq_armed = true;
+	} else if (cq_number == nic->sq_cq_num && nic->dev_data.zero_copy) {
+		/* The host attaches the SQ CQ to the event handler in zero copy mode only */
+		if (nic->sq_cq_pi != ci)
+			nic->event_pending = true;
+		else
+			nic->sq_cq_armed = true;
+	} else {
+		fprintf(stderr, "Armed unknown CQ 0x%x\n", cq_number);
+		nic->tx_errors++;
+	}
+}
+
+/*
+ * Run the device event handler of a queue set while its NIC has an event pending
+ *
+ * @nic [in]: NIC model
+ * @handler_cycles [in/out]: Cycles spent in the event handler
+ */
+static void
+sim_nic_dispatch_events(struct sim_nic *nic, uint64_t *handler_cycles)
+{
+	uint64_t start;
+
+	/* The device code only rings the doorbells of the queue set whose handler runs */
+	flexio_dev_model_set_nic(&nic->ops);
+	while (nic->event_pending) {
+		nic->event_pending = false;
+		nic->events++;
+		start = sim_cycles();
+		flexio_dev_model_run_event_handler(l2_reflector_device_event_handler, nic->dev_data.thread_idx);
+		*handler_cycles += sim_cycles() - start;
+	}
+}
+
+/*
+ * Select the queue set of a packet like the RSS TIR of the host application: a Toeplitz hash of the IPv4 source
+ * and destination addresses indexes an indirection table of L2_RSS_RQT_SIZE entries, filled with the queue sets in
+ * a round robin. Other packets go to the first queue set.
+ *
+ * @packet [in]: Received packet
+ * @nb_threads [in]: Number of queue sets
+ * @return: Index of the queue set
+ */
+static uint32_t
+sim_rss_queue(const struct sim_packet *packet, uint32_t nb_threads)
+{
+	static const uint8_t toeplitz_key[] = {
+		0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2, 0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,
+		0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4, 0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,
+		0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,
+	};
+	const uint8_t *input = packet->data + ETHER_HDR_LEN + IPV4_SRC_ADDR_OFFSET;
+	uint32_t hash = 0, window;
+	int byte, bit;
+
+	if (nb_threads == 1 || packet->hdr.caplen < ETHER_HDR_LEN + IPV4_SRC_ADDR_OFFSET + 8 ||
+	    ((packet->data[2 * ETHER_ADDR_LEN] << 8) | packet->data[2 * ETHER_ADDR_LEN + 1]) != ETHER_TYPE_IPV4)
+		return 0;
+
+	/* Source then destination address, 8 bytes in network order */
+	window = ((uint32_t)toeplitz_key[0] << 24) | (toeplitz_key[1] << 16) | (toeplitz_key[2] << 8) | toeplitz_key[3];
+	for (byte = 0; byte < 8; byte++) {
+		for (bit = 7; bit >= 0; bit--) {
+			if (input[byte] & (1 << bit))
+				hash ^= window;
+			window = (window << 1) | ((toeplitz_key[byte + 4] >> bit) & 0x1);
+		}
+	}
+
+	return (hash & (L2_RSS_RQT_SIZE - 1)) % nb_threads;
+}
+
+/*
+ * Print the usage of the simulator
+ *
+ * @prog [in]: Program name
+ */
+static void
+usage(const char *prog)
+{
+	printf("Usage: %s -i <input pcap> [-o <output pcap>] [-b <burst>] [-n <iterations>] [-B <batch>] [-z] "
+	       "[-t <threads>]\n"
+	       "  -i, --input       pcap file of the packets to receive\n"
+	       "  -o, --output      pcap file to write the sent packets to\n"
+	       "  -b, --burst       packets received between two events, 1 to %d (default %d)\n"
+	       "  -n, --iterations  number of times the input is replayed (default %d)\n"
+	       "  -B, --batch       packets the device handles per doorbell, 1 to %d (default %d)\n"
+	       "  -z, --zero-copy   send the packets from the RQ buffers\n"
+	       "  -t, --threads     device threads, one queue set each, 1 to %d (default %d)\n",
+	       prog, SIM_RQ_DEPTH, SIM_BURST_DEFAULT, SIM_ITERATIONS_DEFAULT, L2_MAX_BATCH_SIZE,
+	       L2_BATCH_SIZE_DEFAULT, L2_MAX_THREADS, SIM_THREADS_DEFAULT);
+}
+
+/*
+ * Simulator main function
+ *
+ * @argc [in]: command line arguments size
+ * @argv [in]: array of command line arguments
+ * @return: EXIT_SUCCESS when every received packet was reflected and EXIT_FAILURE otherwise
+ */
+int
+main(int argc, char **argv)
+{
+	static const struct option long_options[] = {
+		{"input", required_argument, NULL, 'i'},
+		{"output", required_argument, NULL, 'o'},
+		{"burst", required_argument, NULL, 'b'},
+		{"iterations", required_argument, NULL, 'n'},
+		{"batch", required_argument, NULL, 'B'},
+		{"zero-copy", no_argument, NULL, 'z'},
+		{"threads", required_argument, NULL, 't'},
+		{"help", no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0},
+	};
+	const char *input = NULL, *output = NULL;
+	long burst = SIM_BURST_DEFAULT, iterations = SIM_ITERATIONS_DEFAULT, batch = L2_BATCH_SIZE_DEFAULT, iter;
+	long threads = SIM_THREADS_DEFAULT, t;
+	bool zero_copy = false;
+	struct pcap_file_hdr out_hdr;
+	struct sim_pcap pcap;
+	struct sim_nic *nics, total;
+	long nb_nics = 0;
+	FILE *out = NULL;
+	uint64_t handler_cycles = 0, device_cycles;
+	size_t i, next;
+	int opt, exit_status = EXIT_FAILURE;
+
+	while ((opt = getopt_long(argc, argv, "i:o:b:n:B:zt:h", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'i':
+			input = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'b':
+			burst = strtol(optarg, NULL, 0);
+			break;
+		case 'n':
+			iterations = strtol(optarg, NULL, 0);
+			break;
+		case 'B':
+			batch = strtol(optarg, NULL, 0);
+			break;
+		case 'z':
+			zero_copy = true;
+			break;
+		case 't':
+			threads = strtol(optarg, NULL, 0);
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (input == NULL || burst < 1 || burst > SIM_RQ_DEPTH || iterations < 1 || batch < 1 ||
+	    batch > L2_MAX_BATCH_SIZE || threads < 1 || threads > L2_MAX_THREADS) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (load_pcap(input, &pcap) != 0)
+		return EXIT_FAILURE;
+
+	nics = calloc(threads, sizeof(*nics));
+	if (nics == NULL) {
+		fprintf(stderr, "Failed to allocate NIC models\n");
+		goto free_pcap;
+	}
+	for (t = 0; t < threads; t++) {
+		if (sim_nic_init(&nics[t], t) != 0)
+			goto destroy_nics;
+		nb_nics++;
+	}
+
+	if (output != NULL) {
+		out = fopen(output, "wb");
+		if (out == NULL) {
+			fprintf(stderr, "Failed to open %s: %s\n", output, strerror(errno));
+			goto destroy_nics;
+		}
+		out_hdr = pcap.hdr;
+		fwrite(&out_hdr, sizeof(out_hdr), 1, out);
+	}
+
+	for (t = 0; t < threads; t++) {
+		nics[t].out = out;
+		nics[t].dev_data.batch_size = batch;
+		nics[t].dev_data.zero_copy = zero_copy;
+		nics[t].ops.sq_ring_db = sim_nic_sq_ring_db;
+		nics[t].ops.cq_arm = sim_nic_cq_arm;
+		nics[t].ops.ctx = &nics[t];
+		flexio_dev_model_set_nic(&nics[t].ops);
+		l2_reflector_device_init((uint64_t)(uintptr_t)&nics[t].dev_data);
+	}
+
+	/* The NIC receives a burst of packets, then the device handles the events it raised */
+	for (iter = 0; iter < iterations; iter++) {
+		for (i = 0; i < pcap.nb_packets; i = next) {
+			next = (i + burst < pcap.nb_packets) ? i + burst : pcap.nb_packets;
+			for (; i < next; i++)
+				sim_nic_receive(&nics[sim_rss_queue(&pcap.packets[i], threads)], &pcap.packets[i]);
+			for (t = 0; t < threads; t++)
+				sim_nic_dispatch_events(&nics[t], &handler_cycles);
+		}
+	}
+
+	memset(&total, 0, sizeof(total));
+	for (t = 0; t < threads; t++) {
+		total.rx_packets += nics[t].rx_packets;
+		total.rx_drops += nics[t].rx_drops;
+		total.rx_oversize += nics[t].rx_oversize;
+		total.tx_packets += nics[t].tx_packets;
+		total.tx_errors += nics[t].tx_errors;
+		total.mismatches += nics[t].mismatches;
+		total.events += nics[t].events;
+		total.doorbells += nics[t].doorbells;
+		total.sq_cqes += nics[t].sq_cqes;
+		total.nic_cycles += nics[t].nic_cycles;
+	}
+
+	device_cycles = handler_cycles - total.nic_cycles;
+	printf("Received packets:  %" PRIu64 " (%" PRIu64 " dropped, %" PRIu64 " larger than %d bytes)\n",
+	       total.rx_packets, total.rx_drops, total.rx_oversize, SIM_DATA_ENTRY_BSIZE);
+	printf("Sent packets:      %" PRIu64 " (%" PRIu64 " malformed WQEs, %" PRIu64 " not reflected)\n",
+	       total.tx_packets, total.tx_errors, total.mismatches);
+	if (threads > 1) {
+		printf("Packets by thread:");
+		for (t = 0; t < threads; t++)
+			printf(" %" PRIu64, nics[t].tx_packets);
+		printf("\n");
+	}
+	printf("Events:            %" PRIu64 " (%.1f packets per event)\n", total.events,
+	       total.events ? (double)total.tx_packets / total.events : 0.0);
+	printf("SQ doorbells:      %" PRIu64 " (%.1f packets per doorbell)\n", total.doorbells,
+	       total.doorbells ? (double)total.tx_packets / total.doorbells : 0.0);
+	printf("SQ CQEs:           %" PRIu64 "\n", total.sq_cqes);
+	printf("Device count:      %" PRIu64 " packets\n", l2_reflector_device_packets_count(0));
+#if defined(__x86_64__) || defined(__i386__)
+	printf("Device cycles:     %.1f per packet\n",
+	       total.tx_packets ? (double)device_cycles / total.tx_packets : 0.0);
+#else
+	printf("Device time:       %.1f ns per packet\n",
+	       total.tx_packets ? (double)device_cycles / total.tx_packets : 0.0);
+#endif
+
+	if (total.rx_packets == total.tx_packets && total.tx_errors == 0 && total.mismatches == 0 &&
+	    l2_reflector_device_packets_count(0) == (uint32_t)total.tx_packets)
+		exit_status = EXIT_SUCCESS;
+
+	if (out != NULL)
+		fclose(out);
+destroy_nics:
+	while (nb_nics > 0)
+		sim_nic_destroy(&nics[--nb_nics]);
+	free(nics);
+free_pcap:
+	free_pcap(&pcap);
+	return exit_status;
+}
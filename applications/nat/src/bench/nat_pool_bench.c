@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Benchmark of the dynamic NAT pool and session table.
+ * Every thread plays an lcore: it owns a pool, fills it with live sessions, then runs connection cycles. A cycle ages
+ * out the oldest session and opens a new connection (a lookup that misses, then a session created with a global IP and
+ * port), the way the lcore handles traffic at a steady number of sessions. The lookups of packets that reach software
+ * before the entries of their session are measured apart. At the end every live session must be found again and the
+ * global IP/port tuples of all the threads must be unique.
+ */
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "nat_pool.h"
+
+#define BENCH_THREADS_DEFAULT 1	     /* Default number of threads */
+#define BENCH_LIVE_DEFAULT (1 << 20) /* Default number of live sessions of all the threads */
+#define BENCH_CYCLES_DEFAULT 4000000 /* Default number of connection cycles of a thread */
+#define BENCH_IPS_DEFAULT 32	     /* Default number of global IPs */
+#define BENCH_MAX_THREADS 256	     /* Maximal number of threads */
+
+struct bench_thread {
+	pthread_t thread;		 /* Thread of the lcore */
+	uint32_t idx;			 /* Index of the lcore */
+	uint32_t nb_threads;		 /* Number of lcores */
+	const struct nat_pool_cfg *cfg;	 /* Pool configuration */
+	uint32_t nb_live;		 /* Live sessions of the lcore */
+	uint64_t nb_cycles;		 /* Connection cycles to run */
+	uint64_t rng;			 /* Random state, never 0 */
+	struct nat_pool *pool;		 /* Pool of the lcore */
+	struct nat_session **live;	 /* FIFO of the live sessions, oldest first */
+	uint64_t fill_ns;		 /* Time of the fill */
+	uint64_t cycles_ns;		 /* Time of the connection cycles */
+	uint64_t lookups_ns;		 /* Time of the lookups */
+	int error;			 /* Set on failure */
+};
+
+/*
+ * Get the time of a monotonic clock
+ *
+ * @return: Current time (nanoseconds)
+ */
+static inline uint64_t
+bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Get a random number
+ *
+ * @rng [in/out]: Random state, never 0
+ * @return: Random number
+ */
+static inline uint64_t
+bench_random(uint64_t *rng)
+{
+	/* xorshift64* */
+	*rng ^= *rng >> 12;
+	*rng ^= *rng << 25;
+	*rng ^= *rng >> 27;
+	return *rng * 0x2545F4914F6CDD1DULL;
+}
+
+/*
+ * Make the flow of a new LAN connection
+ *
+ * @rng [in/out]: Random state
+ * @key [out]: Flow of the connection
+ */
+static inline void
+bench_key(uint64_t *rng, struct nat_session_key *key)
+{
+	uint64_t r = bench_random(rng);
+
+	memset(key, 0, sizeof(*key));
+	key->local_ip[0] = htonl(0xC0A80000 | (r & 0xFFFF));	/* 192.168.0.0/16 */
+	key->remote_ip = (uint32_t)(r >> 32);
+	key->local_port = (uint16_t)(r >> 16);
+	key->remote_port = htons((r & 1) ? 443 : 53);
+	key->proto = (r & 1) ? IPPROTO_TCP : IPPROTO_UDP;
+}
+
+/*
+ * Open a new connection: look its flow up and create its session
+ *
+ * @t [in]: Thread
+ * @return: The session of the connection, NULL on failure
+ */
+static struct nat_session *
+bench_connect(struct bench_thread *t)
+{
+	struct nat_session_key key;
+	struct nat_session *session;
+
+	do {
+		bench_key(&t->rng, &key);
+	} while (nat_session_lookup(t->pool, &key) != NULL);
+	if (nat_session_create(t->pool, &key, &session) != DOCA_SUCCESS)
+		return NULL;
+	return session;
+}
+
+/*
+ * Run the benchmark of an lcore
+ *
+ * @arg [in]: Thread
+ * @return: NULL
+ */
+static void *
+bench_thread_run(void *arg)
+{
+	struct bench_thread *t = arg;
+	struct nat_session *session;
+	uint64_t start, i, oldest = 0;
+	uint32_t k;
+
+	if (nat_pool_create(t->cfg, t->idx, t->nb_threads, &t->pool) != DOCA_SUCCESS) {
+		t->error = 1;
+		return NULL;
+	}
+	if (t->nb_live > t->pool->max_sessions) {
+		fprintf(stderr, "Thread %u: %u live sessions do not fit a pool of %u sessions\n", t->idx, t->nb_live,
+			t->pool->max_sessions);
+		t->error = 1;
+		return NULL;
+	}
+
+	start = bench_now();
+	for (k = 0; k < t->nb_live; k++) {
+		t->live[k] = bench_connect(t);
+		if (t->live[k] == NULL) {
+			fprintf(stderr, "Thread %u: fill failed after %u sessions\n", t->idx, k);
+			t->error = 1;
+			return NULL;
+		}
+	}
+	t->fill_ns = bench_now() - start;
+
+	start = bench_now();
+	for (i = 0; i < t->nb_cycles; i++) {
+		k = oldest++ % t->nb_live;
+		nat_session_unlink(t->pool, t->live[k]);
+		nat_session_release(t->pool, t->live[k]);
+		t->live[k] = bench_connect(t);
+		if (t->live[k] == NULL) {
+			fprintf(stderr, "Thread %u: connection cycle %" PRIu64 " failed\n", t->idx, i);
+			t->error = 1;
+			return NULL;
+		}
+	}
+	t->cycles_ns = bench_now() - start;
+
+	start = bench_now();
+	for (i = 0; i < t->nb_cycles; i++) {
+		session = t->live[bench_random(&t->rng) % t->nb_live];
+		if (nat_session_lookup(t->pool, &session->key) != session) {
+			fprintf(stderr, "Thread %u: live session not found\n", t->idx);
+			t->error = 1;
+			return NULL;
+		}
+	}
+	t->lookups_ns = bench_now() - start;
+	return NULL;
+}
+
+/*
+ * Check that the live sessions of all the threads have unique global IP/port tuples
+ *
+ * @threads [in]: Threads
+ * @nb_threads [in]: Number of threads
+ * @cfg [in]: Pool configuration
+ * @return: 0 on success and -1 otherwise
+ */
+static int
+bench_check_tuples(struct bench_thread *threads, uint32_t nb_threads, const struct nat_pool_cfg *cfg)
+{
+	uint64_t nb_tuples = (uint64_t)cfg->nb_global_ips * (cfg->max_port - cfg->min_port + 1);
+	struct nat_session *session;
+	uint8_t *used;
+	uint32_t i, k, port;
+	int ret = 0;
+
+	used = calloc((nb_tuples + 7) / 8, 1);
+	if (used == NULL)
+		return -1;
+	for (i = 0; i < nb_threads && ret == 0; i++) {
+		for (k = 0; k < threads[i].nb_live; k++) {
+			session = threads[i].live[k];
+			port = ntohs(session->global_port);
+			if (session->tuple >= nb_tuples || used[session->tuple / 8] & (1 << session->tuple % 8) ||
+			    session->global_ip != cfg->global_ips[session->tuple % cfg->nb_global_ips] ||
+			    port != cfg->min_port + session->tuple / cfg->nb_global_ips) {
+				fprintf(stderr, "Thread %u: tuple %u is invalid or allocated twice\n", i, session->tuple);
+				ret = -1;
+				break;
+			}
+			used[session->tuple / 8] |= 1 << session->tuple % 8;
+		}
+	}
+	free(used);
+	return ret;
+}
+
+/*
+ * Print the usage of the benchmark
+ *
+ * @prog [in]: Program name
+ */
+static void
+usage(const char *prog)
+{
+	printf("Usage: %s [-t <threads>] [-l <sessions>] [-c <cycles>] [-i <ips>] [-S <seed>]\n"
+	       "  -t, --threads  threads, one pool per thread (default %d)\n"
+	       "  -l, --live     live sessions of all the threads (default %d)\n"
+	       "  -c, --cycles   connection cycles per thread (default %d)\n"
+	       "  -i, --ips      global IPs, with ports %d-%d (default %d)\n"
+	       "  -S, --seed     random seed\n",
+	       prog, BENCH_THREADS_DEFAULT, BENCH_LIVE_DEFAULT, BENCH_CYCLES_DEFAULT, NAT_POOL_DEFAULT_MIN_PORT,
+	       NAT_POOL_DEFAULT_MAX_PORT, BENCH_IPS_DEFAULT);
+}
+
+int
+main(int argc, char **argv)
+{
+	static const struct option long_options[] = {
+		{"threads", required_argument, NULL, 't'},
+		{"live", required_argument, NULL, 'l'},
+		{"cycles", required_argument, NULL, 'c'},
+		{"ips", required_argument, NULL, 'i'},
+		{"seed", required_argument, NULL, 'S'},
+		{"help", no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0},
+	};
+	static struct nat_pool_cfg cfg;
+	struct bench_thread *threads;
+	long nb_threads = BENCH_THREADS_DEFAULT, nb_ips = BENCH_IPS_DEFAULT;
+	long long nb_live = BENCH_LIVE_DEFAULT, nb_cycles = BENCH_CYCLES_DEFAULT;
+	uint64_t seed = 1, fill_ns = 0, cycles_ns = 0, lookups_ns = 0, memory;
+	long i, nb_started;
+	int opt, exit_status = EXIT_FAILURE;
+
+	while ((opt = getopt_long(argc, argv, "t:l:c:i:S:h", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 't':
+			nb_threads = strtol(optarg, NULL, 0);
+			break;
+		case 'l':
+			nb_live = strtoll(optarg, NULL, 0);
+			break;
+		case 'c':
+			nb_cycles = strtoll(optarg, NULL, 0);
+			break;
+		case 'i':
+			nb_ips = strtol(optarg, NULL, 0);
+			break;
+		case 'S':
+			seed = strtoull(optarg, NULL, 0);
+			if (seed == 0)
+				seed = 1;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (nb_threads <= 0 || nb_threads > BENCH_MAX_THREADS || nb_ips <= 0 || nb_ips > NAT_POOL_MAX_GLOBAL_IPS ||
+	    nb_live < nb_threads || nb_live > NAT_POOL_MAX_SESSIONS || nb_cycles < 0) {
+		fprintf(stderr, "Invalid arguments: at most %d threads and %d IPs, and a live session per thread\n",
+			BENCH_MAX_THREADS, NAT_POOL_MAX_GLOBAL_IPS);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < nb_ips; i++)
+		cfg.global_ips[i] = htonl(0xD2303400 + i); /* 210.48.52.0/24 and up */
+	cfg.nb_global_ips = nb_ips;
+	cfg.min_port = NAT_POOL_DEFAULT_MIN_PORT;
+	cfg.max_port = NAT_POOL_DEFAULT_MAX_PORT;
+	cfg.max_sessions = nb_live;
+	cfg.aging_sec = NAT_POOL_DEFAULT_AGING_SEC;
+
+	threads = calloc(nb_threads, sizeof(*threads));
+	if (threads == NULL) {
+		fprintf(stderr, "Failed to allocate the threads\n");
+		return EXIT_FAILURE;
+	}
+	for (i = 0; i < nb_threads; i++) {
+		threads[i].idx = i;
+		threads[i].nb_threads = nb_threads;
+		threads[i].cfg = &cfg;
+		threads[i].nb_live = nb_live / nb_threads;
+		threads[i].nb_cycles = nb_cycles;
+		threads[i].rng = seed + i * 0x9E3779B97F4A7C15ULL;
+		if (threads[i].rng == 0)
+			threads[i].rng = 1;
+		threads[i].live = malloc(threads[i].nb_live * sizeof(*threads[i].live));
+		if (threads[i].live == NULL) {
+			fprintf(stderr, "Failed to allocate the live sessions\n");
+			goto free_threads;
+		}
+	}
+
+	for (nb_started = 0; nb_started < nb_threads; nb_started++) {
+		if (pthread_create(&threads[nb_started].thread, NULL, bench_thread_run, &threads[nb_started]) != 0) {
+			fprintf(stderr, "Failed to create thread %ld\n", nb_started);
+			break;
+		}
+	}
+	for (i = 0; i < nb_started; i++)
+		pthread_join(threads[i].thread, NULL);
+	if (nb_started < nb_threads)
+		goto free_threads;
+	for (i = 0; i < nb_threads; i++) {
+		if (threads[i].error)
+			goto free_threads;
+		fill_ns = threads[i].fill_ns > fill_ns ? threads[i].fill_ns : fill_ns;
+		cycles_ns = threads[i].cycles_ns > cycles_ns ? threads[i].cycles_ns : cycles_ns;
+		lookups_ns = threads[i].lookups_ns > lookups_ns ? threads[i].lookups_ns : lookups_ns;
+	}
+
+	memory = 0;
+	for (i = 0; i < nb_threads; i++)
+		memory += sizeof(*threads[i].pool) +
+			  ((uint64_t)threads[i].pool->tuples_mask + 1) * sizeof(*threads[i].pool->free_tuples) +
+			  (uint64_t)threads[i].pool->max_sessions * sizeof(*threads[i].pool->sessions) +
+			  ((uint64_t)threads[i].pool->table_mask + 1) * sizeof(*threads[i].pool->table);
+
+	printf("Pool:      %ld global IPs, ports %u-%u, %ld threads\n", nb_ips, cfg.min_port, cfg.max_port, nb_threads);
+	printf("Fill:      %lld sessions, %.1f ns per session per thread\n", nb_live,
+	       (double)fill_ns * nb_threads / nb_live);
+	if (nb_cycles > 0) {
+		printf("Cycles:    %lld connection cycles per thread, %.1f ns per cycle, %.2f M new connections/sec\n",
+		       nb_cycles, (double)cycles_ns / nb_cycles, nb_cycles * nb_threads * 1000.0 / cycles_ns);
+		printf("Lookups:   %.1f ns per lookup, %.2f M lookups/sec\n", (double)lookups_ns / nb_cycles,
+		       nb_cycles * nb_threads * 1000.0 / lookups_ns);
+	}
+	printf("Memory:    %" PRIu64 " MB, %.1f bytes per session\n", memory >> 20, (double)memory / nb_live);
+
+	if (bench_check_tuples(threads, nb_threads, &cfg) != 0)
+		goto free_threads;
+	exit_status = EXIT_SUCCESS;
+
+free_threads:
+	for (i = 0; i < nb_threads; i++) {
+		nat_pool_destroy(threads[i].pool);
+		free(threads[i].live);
+	}
+	free(threads);
+	return exit_status;
+}
@@ -0,0 +1,982 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Correctness check of the NPTv6 and NAT64 translators against a reference translator.
+ * The packets are read from a pcap file, or generated with the edge cases of the translators: expiring hop limits,
+ * zero UDP checksums, IPv4 options and fragments, ICMP types that are not translated and NPTv6 subnets whose
+ * adjusted word is 0xffff.
+ * NAT64: every IPv6 packet is translated to IPv4 and the result back to IPv6, every IPv4 packet is translated to IPv6.
+ * The reference rebuilds the headers field by field and computes the checksums from scratch, the translated bytes
+ * must be the same. Packets with a wrong L4 checksum are skipped: the incremental update keeps the error.
+ * NPTv6: the source of every IPv6 packet is translated to the external prefix. The prefix bits must be the external
+ * prefix, the other bits must be kept except the subnet word, the L4 checksum must stay valid and the inbound
+ * translation must give back the packet.
+ * The translated packets can be written to a pcap file.
+ */
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "nat_xlat.h"
+
+#define XLAT_PACKETS_DEFAULT 1000000	/* Default number of generated packets */
+#define XLAT_MAX_FRAME 2048		/* Largest frame */
+#define XLAT_HEADROOM 64		/* Room before a frame, the NAT64 translation may move the headers back */
+#define XLAT_ETH_HDR_LEN 14		/* Length of an Ethernet header */
+#define XLAT_ETH_MIN_FRAME 60		/* Shortest Ethernet frame, shorter packets are padded */
+#define XLAT_MAX_PAYLOAD 1400		/* Largest generated L4 payload */
+#define XLAT_ETHER_TYPE_IPV4 0x0800	/* Ethernet type of IPv4 */
+#define XLAT_ETHER_TYPE_IPV6 0x86dd	/* Ethernet type of IPv6 */
+#define XLAT_GLOBAL_IP 0xC6336401	/* NAT64 global IPv4: 198.51.100.1 */
+#define XLAT_MAX_REPORTS 10		/* Mismatches printed */
+#define PCAP_MAGIC 0xa1b2c3d4		/* pcap file magic, microseconds timestamps */
+#define PCAP_MAGIC_SWAPPED 0xd4c3b2a1	/* pcap file magic of the other byte order */
+#define PCAP_LINKTYPE_ETHERNET 1	/* pcap link type of Ethernet */
+
+/* pcap file header */
+struct pcap_file_hdr {
+	uint32_t magic;		/* PCAP_MAGIC */
+	uint16_t version_major;	/* Major version, 2 */
+	uint16_t version_minor;	/* Minor version, 4 */
+	int32_t thiszone;	/* GMT offset, 0 */
+	uint32_t sigfigs;	/* Timestamps accuracy, 0 */
+	uint32_t snaplen;	/* Largest captured length */
+	uint32_t linktype;	/* Link type of the packets */
+};
+
+/* pcap packet header */
+struct pcap_pkt_hdr {
+	uint32_t ts_sec;	/* Timestamp seconds */
+	uint32_t ts_usec;	/* Timestamp microseconds */
+	uint32_t caplen;	/* Captured length */
+	uint32_t len;		/* Length on the wire */
+};
+
+/* Check state */
+struct xlat_check {
+	bool is_nat64;				/* NAT64 check, NPTv6 check otherwise */
+	struct nat_nptv6 npt;			/* NPTv6 prefixes */
+	uint8_t prefix[NAT_XLAT_IPV6_ADDR_LEN];	/* NAT64 prefix */
+	uint64_t rng;				/* Random state, never 0 */
+	FILE *out;				/* pcap file of the translated packets, NULL if none */
+	uint64_t nb_pkts;			/* Checked packets */
+	uint64_t nb_translated;			/* Translations that succeeded */
+	uint64_t nb_rejected;			/* Packets both translators refused */
+	uint64_t nb_skipped;			/* Packets with a wrong L4 checksum */
+	uint64_t nb_mismatch;			/* Packets translated differently */
+	uint64_t xlat_ns;			/* Time of the translations */
+};
+
+/*
+ * Get the time of a monotonic clock
+ *
+ * @return: Current time (nanoseconds)
+ */
+static inline uint64_t
+xlat_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Get a random number
+ *
+ * @rng [in/out]: Random state, never 0
+ * @return: Random number
+ */
+static inline uint64_t
+xlat_random(uint64_t *rng)
+{
+	/* xorshift64* */
+	*rng ^= *rng >> 12;
+	*rng ^= *rng << 25;
+	*rng ^= *rng >> 27;
+	return *rng * 0x2545F4914F6CDD1DULL;
+}
+
+/*
+ * Read a 16 bits big endian value
+ *
+ * @p [in]: value address
+ * @return: the value
+ */
+static inline uint16_t
+rd16(const uint8_t *p)
+{
+	return p[0] << 8 | p[1];
+}
+
+/*
+ * Write a 16 bits big endian value
+ *
+ * @p [in]: value address
+ * @value [in]: the value
+ */
+static inline void
+wr16(uint8_t *p, uint16_t value)
+{
+	p[0] = value >> 8;
+	p[1] = value & 0xff;
+}
+
+/*
+ * Add big endian words to a one's complement sum
+ *
+ * @sum [in]: current sum
+ * @p [in]: words
+ * @len [in]: length in bytes, an odd length is padded with zero
+ * @return: new sum, not folded
+ */
+static uint32_t
+ref_sum(uint32_t sum, const uint8_t *p, size_t len)
+{
+	for (; len > 1; p += 2, len -= 2)
+		sum += rd16(p);
+	if (len > 0)
+		sum += p[0] << 8;
+	return sum;
+}
+
+/*
+ * Fold a one's complement sum to 16 bits
+ *
+ * @sum [in]: sum
+ * @return: folded sum
+ */
+static uint16_t
+ref_fold(uint32_t sum)
+{
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return sum;
+}
+
+/*
+ * Get the offset of the checksum of a L4 header
+ *
+ * @proto [in]: L4 protocol
+ * @return: offset of the checksum
+ */
+static size_t
+ref_csum_offset(uint8_t proto)
+{
+	return proto == IPPROTO_TCP ? 16 : proto == IPPROTO_UDP ? 6 : 2;
+}
+
+/*
+ * Compute the sum of a L4 header and payload with the pseudo header, if the protocol has one
+ *
+ * @src [in]: source address
+ * @dst [in]: destination address
+ * @addr_len [in]: address length
+ * @proto [in]: L4 protocol
+ * @l4 [in]: L4 header
+ * @l4_len [in]: L4 header and payload length
+ * @return: folded sum
+ */
+static uint16_t
+ref_l4_sum(const uint8_t *src, const uint8_t *dst, size_t addr_len, uint8_t proto, const uint8_t *l4, size_t l4_len)
+{
+	uint32_t sum = 0;
+
+	if (proto != IPPROTO_ICMP) {
+		sum = ref_sum(sum, src, addr_len);
+		sum = ref_sum(sum, dst, addr_len);
+		sum += proto + l4_len;
+	}
+	return ref_fold(ref_sum(sum, l4, l4_len));
+}
+
+/*
+ * Compute and write the checksum of a L4 header
+ *
+ * @src [in]: source address
+ * @dst [in]: destination address
+ * @addr_len [in]: address length
+ * @proto [in]: L4 protocol
+ * @l4 [in/out]: L4 header
+ * @l4_len [in]: L4 header and payload length
+ */
+static void
+ref_set_l4_csum(const uint8_t *src, const uint8_t *dst, size_t addr_len, uint8_t proto, uint8_t *l4, size_t l4_len)
+{
+	uint16_t csum;
+
+	wr16(l4 + ref_csum_offset(proto), 0);
+	csum = ~ref_l4_sum(src, dst, addr_len, proto, l4, l4_len);
+	if (proto == IPPROTO_UDP && csum == 0)
+		csum = 0xffff;
+	wr16(l4 + ref_csum_offset(proto), csum);
+}
+
+/*
+ * Check the L4 checksum of an IP packet
+ *
+ * @l3 [in]: IP header
+ * @len [in]: length from the IP header
+ * @return: false if the packet has a L4 checksum and it is wrong
+ */
+static bool
+ref_l4_valid(const uint8_t *l3, size_t len)
+{
+	size_t hdr_len, l4_len;
+	uint8_t proto;
+
+	if ((l3[0] >> 4) == 6) {
+		if (len < NAT_XLAT_IPV6_HDR_LEN || NAT_XLAT_IPV6_HDR_LEN + (size_t)rd16(l3 + 4) > len)
+			return true;
+		hdr_len = NAT_XLAT_IPV6_HDR_LEN;
+		l4_len = rd16(l3 + 4);
+		proto = l3[6];
+		if ((proto != IPPROTO_TCP && proto != IPPROTO_UDP && proto != IPPROTO_ICMPV6) ||
+		    l4_len < ref_csum_offset(proto) + 2)
+			return true;
+		/* Not allowed by IPv6 but both translators drop it */
+		if (proto == IPPROTO_UDP && rd16(l3 + hdr_len + 6) == 0)
+			return true;
+		return ref_l4_sum(l3 + 8, l3 + 24, NAT_XLAT_IPV6_ADDR_LEN, proto, l3 + hdr_len, l4_len) == 0xffff;
+	}
+	if (len < NAT_XLAT_IPV4_HDR_LEN)
+		return true;
+	hdr_len = (l3[0] & 0x0f) * 4;
+	if (hdr_len < NAT_XLAT_IPV4_HDR_LEN || rd16(l3 + 2) < hdr_len || rd16(l3 + 2) > len)
+		return true;
+	l4_len = rd16(l3 + 2) - hdr_len;
+	proto = l3[9];
+	if ((proto != IPPROTO_TCP && proto != IPPROTO_UDP && proto != IPPROTO_ICMP) ||
+	    l4_len < ref_csum_offset(proto) + 2)
+		return true;
+	if (proto == IPPROTO_UDP && rd16(l3 + hdr_len + 6) == 0)
+		return true;
+	return ref_l4_sum(l3 + 12, l3 + 16, 4, proto, l3 + hdr_len, l4_len) == 0xffff;
+}
+
+/*
+ * Reference NAT64 translation of an IPv6 packet to IPv4
+ *
+ * @in [in]: IPv6 header
+ * @len [in]: length from the IPv6 header
+ * @src_ip [in]: IPv4 source, host byte order
+ * @src_port [in]: source port or ICMP echo identifier, host byte order
+ * @ip_id [in]: IPv4 identification, host byte order
+ * @out [out]: IPv4 packet
+ * @out_len [out]: IPv4 packet length
+ * @return: true if the packet is translated
+ */
+static bool
+ref_ipv6_to_ipv4(const uint8_t *in, size_t len, uint32_t src_ip, uint16_t src_port, uint16_t ip_id, uint8_t *out,
+		 size_t *out_len)
+{
+	const uint8_t *l4 = in + NAT_XLAT_IPV6_HDR_LEN;
+	uint16_t l4_len, total_len;
+	uint8_t proto, *out_l4;
+
+	if (len < NAT_XLAT_IPV6_HDR_LEN || (in[0] >> 4) != 6)
+		return false;
+	l4_len = rd16(in + 4);
+	if (NAT_XLAT_IPV6_HDR_LEN + (size_t)l4_len > len || in[7] <= 1)
+		return false;
+	switch (in[6]) {
+	case IPPROTO_TCP:
+		if (l4_len < 20)
+			return false;
+		proto = IPPROTO_TCP;
+		break;
+	case IPPROTO_UDP:
+		if (l4_len < 8 || rd16(l4 + 6) == 0)
+			return false;
+		proto = IPPROTO_UDP;
+		break;
+	case IPPROTO_ICMPV6:
+		if (l4_len < 8 || (l4[0] != 128 && l4[0] != 129))
+			return false;
+		proto = IPPROTO_ICMP;
+		break;
+	default:
+		return false;
+	}
+
+	total_len = NAT_XLAT_IPV4_HDR_LEN + l4_len;
+	memset(out, 0, NAT_XLAT_IPV4_HDR_LEN);
+	out[0] = 0x45;
+	out[1] = (in[0] << 4) | (in[1] >> 4);
+	wr16(out + 2, total_len);
+	if (total_len > 1260)
+		wr16(out + 6, 0x4000);
+	else
+		wr16(out + 4, ip_id);
+	out[8] = in[7] - 1;
+	out[9] = proto;
+	wr16(out + 12, src_ip >> 16);
+	wr16(out + 14, src_ip & 0xffff);
+	memcpy(out + 16, in + 24 + NAT_XLAT_NAT64_PREFIX_LEN, 4);
+	wr16(out + 10, ~ref_fold(ref_sum(0, out, NAT_XLAT_IPV4_HDR_LEN)));
+
+	out_l4 = out + NAT_XLAT_IPV4_HDR_LEN;
+	memcpy(out_l4, l4, l4_len);
+	if (proto == IPPROTO_ICMP) {
+		out_l4[0] = l4[0] == 128 ? 8 : 0;
+		wr16(out_l4 + 4, src_port);
+	} else
+		wr16(out_l4, src_port);
+	ref_set_l4_csum(out + 12, out + 16, 4, proto, out_l4, l4_len);
+	*out_len = total_len;
+	return true;
+}
+
+/*
+ * Reference NAT64 translation of an IPv4 packet to IPv6
+ *
+ * @in [in]: IPv4 header
+ * @len [in]: length from the IPv4 header
+ * @prefix [in]: NAT64 prefix
+ * @dst_ip [in]: IPv6 destination
+ * @dst_port [in]: destination port or ICMP echo identifier, host byte order
+ * @out [out]: IPv6 packet
+ * @out_len [out]: IPv6 packet length
+ * @return: true if the packet is translated
+ */
+static bool
+ref_ipv4_to_ipv6(const uint8_t *in, size_t len, const uint8_t *prefix, const uint8_t *dst_ip, uint16_t dst_port,
+		 uint8_t *out, size_t *out_len)
+{
+	size_t hdr_len, total_len, l4_len;
+	const uint8_t *l4;
+	uint8_t proto, *out_l4;
+
+	if (len < NAT_XLAT_IPV4_HDR_LEN || (in[0] >> 4) != 4)
+		return false;
+	hdr_len = (in[0] & 0x0f) * 4;
+	total_len = rd16(in + 2);
+	if (hdr_len < NAT_XLAT_IPV4_HDR_LEN || total_len < hdr_len || total_len > len || (rd16(in + 6) & 0x3fff) ||
+	    in[8] <= 1)
+		return false;
+	l4 = in + hdr_len;
+	l4_len = total_len - hdr_len;
+	proto = in[9];
+	if ((proto == IPPROTO_TCP && l4_len < 20) || (proto == IPPROTO_UDP && l4_len < 8) ||
+	    (proto == IPPROTO_ICMP && (l4_len < 8 || (l4[0] != 0 && l4[0] != 8))) ||
+	    (proto != IPPROTO_TCP && proto != IPPROTO_UDP && proto != IPPROTO_ICMP))
+		return false;
+
+	out[0] = 0x60 | (in[1] >> 4);
+	out[1] = (in[1] & 0x0f) << 4;
+	out[2] = 0;
+	out[3] = 0;
+	wr16(out + 4, l4_len);
+	out[6] = proto == IPPROTO_ICMP ? IPPROTO_ICMPV6 : proto;
+	out[7] = in[8] - 1;
+	memcpy(out + 8, prefix, NAT_XLAT_NAT64_PREFIX_LEN);
+	memcpy(out + 8 + NAT_XLAT_NAT64_PREFIX_LEN, in + 12, 4);
+	memcpy(out + 24, dst_ip, NAT_XLAT_IPV6_ADDR_LEN);
+
+	out_l4 = out + NAT_XLAT_IPV6_HDR_LEN;
+	memcpy(out_l4, l4, l4_len);
+	if (proto == IPPROTO_ICMP) {
+		out_l4[0] = l4[0] == 8 ? 128 : 129;
+		wr16(out_l4 + 4, dst_port);
+	} else
+		wr16(out_l4 + 2, dst_port);
+	ref_set_l4_csum(out + 8, out + 24, NAT_XLAT_IPV6_ADDR_LEN, out[6], out_l4, l4_len);
+	*out_len = NAT_XLAT_IPV6_HDR_LEN + l4_len;
+	return true;
+}
+
+/*
+ * Write a packet to the output pcap file
+ *
+ * @check [in]: check state
+ * @eth [in]: Ethernet header of the packet, its type is replaced
+ * @ether_type [in]: Ethernet type of the packet
+ * @l3 [in]: IP packet
+ * @len [in]: IP packet length
+ */
+static void
+write_packet(struct xlat_check *check, const uint8_t *eth, uint16_t ether_type, const uint8_t *l3, size_t len)
+{
+	struct pcap_pkt_hdr pkt_hdr = {0};
+	uint8_t eth_hdr[XLAT_ETH_HDR_LEN];
+
+	if (check->out == NULL)
+		return;
+	memcpy(eth_hdr, eth, XLAT_ETH_HDR_LEN - 2);
+	wr16(eth_hdr + XLAT_ETH_HDR_LEN - 2, ether_type);
+	pkt_hdr.ts_sec = check->nb_pkts / 1000000;
+	pkt_hdr.ts_usec = check->nb_pkts % 1000000;
+	pkt_hdr.caplen = XLAT_ETH_HDR_LEN + len;
+	pkt_hdr.len = pkt_hdr.caplen;
+	fwrite(&pkt_hdr, sizeof(pkt_hdr), 1, check->out);
+	fwrite(eth_hdr, XLAT_ETH_HDR_LEN, 1, check->out);
+	fwrite(l3, len, 1, check->out);
+}
+
+/*
+ * Report a packet translated differently
+ *
+ * @check [in]: check state
+ * @what [in]: failed check
+ * @frame [in]: checked frame
+ * @len [in]: frame length
+ */
+static void
+report_mismatch(struct xlat_check *check, const char *what, const uint8_t *frame, size_t len)
+{
+	size_t i;
+
+	if (check->nb_mismatch++ >= XLAT_MAX_REPORTS)
+		return;
+	printf("Packet %" PRIu64 ": %s\n ", check->nb_pkts, what);
+	for (i = 0; i < len && i < 80; i++)
+		printf(" %02x", frame[i]);
+	printf("\n");
+}
+
+/*
+ * Check the NAT64 translation of an IPv4 packet to IPv6
+ *
+ * @check [in]: check state
+ * @frame [in]: Ethernet frame
+ * @len [in]: frame length
+ * @dst_ip [in]: IPv6 destination of the session
+ * @dst_port [in]: destination port of the session, host byte order
+ * @write [in]: true to write the translated packet
+ */
+static void
+check_ipv4_to_ipv6(struct xlat_check *check, const uint8_t *frame, size_t len, const uint8_t *dst_ip,
+		   uint16_t dst_port, bool write)
+{
+	uint8_t buf[XLAT_HEADROOM + XLAT_MAX_FRAME], ref[XLAT_MAX_FRAME];
+	uint8_t *l3 = buf + XLAT_HEADROOM + XLAT_ETH_HDR_LEN, *new_l3;
+	struct nat_xlat_flow flow;
+	size_t new_len, ref_len;
+	bool translated, ref_translated;
+	uint64_t start;
+
+	if (!ref_l4_valid(frame + XLAT_ETH_HDR_LEN, len - XLAT_ETH_HDR_LEN)) {
+		check->nb_skipped++;
+		return;
+	}
+	memcpy(buf + XLAT_HEADROOM, frame, len);
+	start = xlat_now();
+	translated = nat_xlat_parse_ipv4(l3, len - XLAT_ETH_HDR_LEN, &flow) == DOCA_SUCCESS &&
+		     nat64_ipv4_to_ipv6(l3, &flow, check->prefix, dst_ip, htons(dst_port), &new_l3, &new_len) ==
+			     DOCA_SUCCESS;
+	check->xlat_ns += xlat_now() - start;
+	ref_translated = ref_ipv4_to_ipv6(frame + XLAT_ETH_HDR_LEN, len - XLAT_ETH_HDR_LEN, check->prefix, dst_ip,
+					  dst_port, ref, &ref_len);
+
+	if (translated != ref_translated)
+		report_mismatch(check, translated ? "IPv4 packet translated, the reference drops it" :
+				"IPv4 packet dropped, the reference translates it", frame, len);
+	else if (!translated)
+		check->nb_rejected++;
+	else if (new_len != ref_len || memcmp(new_l3, ref, ref_len) != 0)
+		report_mismatch(check, "IPv4 to IPv6 translation differs from the reference", frame, len);
+	else {
+		check->nb_translated++;
+		if (write)
+			write_packet(check, frame, XLAT_ETHER_TYPE_IPV6, new_l3, new_len);
+	}
+}
+
+/*
+ * Check the NAT64 translation of an IPv6 packet to IPv4, and of the result back to IPv6
+ *
+ * @check [in]: check state
+ * @frame [in]: Ethernet frame
+ * @len [in]: frame length
+ */
+static void
+check_ipv6_to_ipv4(struct xlat_check *check, const uint8_t *frame, size_t len)
+{
+	uint8_t buf[XLAT_HEADROOM + XLAT_MAX_FRAME], ref[XLAT_MAX_FRAME], ipv4_frame[XLAT_MAX_FRAME];
+	uint8_t *l3 = buf + XLAT_HEADROOM + XLAT_ETH_HDR_LEN, *new_l3;
+	uint16_t src_port = 1024 + xlat_random(&check->rng) % 64512, ip_id = xlat_random(&check->rng);
+	struct nat_xlat_flow flow;
+	size_t new_len, ref_len;
+	bool translated, ref_translated;
+	uint64_t start;
+
+	if (!ref_l4_valid(frame + XLAT_ETH_HDR_LEN, len - XLAT_ETH_HDR_LEN)) {
+		check->nb_skipped++;
+		return;
+	}
+	memcpy(buf + XLAT_HEADROOM, frame, len);
+	start = xlat_now();
+	translated = nat_xlat_parse_ipv6(l3, len - XLAT_ETH_HDR_LEN, &flow) == DOCA_SUCCESS &&
+		     nat64_ipv6_to_ipv4(l3, &flow, htonl(XLAT_GLOBAL_IP), htons(src_port), htons(ip_id), &new_l3,
+					&new_len) == DOCA_SUCCESS;
+	check->xlat_ns += xlat_now() - start;
+	ref_translated = ref_ipv6_to_ipv4(frame + XLAT_ETH_HDR_LEN, len - XLAT_ETH_HDR_LEN, XLAT_GLOBAL_IP, src_port,
+					  ip_id, ref, &ref_len);
+
+	if (translated != ref_translated) {
+		report_mismatch(check, translated ? "IPv6 packet translated, the reference drops it" :
+				"IPv6 packet dropped, the reference translates it", frame, len);
+		return;
+	}
+	if (!translated) {
+		check->nb_rejected++;
+		return;
+	}
+	if (new_len != ref_len || memcmp(new_l3, ref, ref_len) != 0) {
+		report_mismatch(check, "IPv6 to IPv4 translation differs from the reference", frame, len);
+		return;
+	}
+	check->nb_translated++;
+	write_packet(check, frame, XLAT_ETHER_TYPE_IPV4, new_l3, new_len);
+
+	/* Translate the IPv4 packet back, to the source of the IPv6 packet */
+	memcpy(ipv4_frame, frame, XLAT_ETH_HDR_LEN);
+	memcpy(ipv4_frame + XLAT_ETH_HDR_LEN, new_l3, new_len);
+	check_ipv4_to_ipv6(check, ipv4_frame, XLAT_ETH_HDR_LEN + new_len, frame + XLAT_ETH_HDR_LEN + 8,
+			   rd16(frame + XLAT_ETH_HDR_LEN + NAT_XLAT_IPV6_HDR_LEN), false);
+}
+
+/*
+ * Check the NPTv6 translation of the source of an IPv6 packet
+ *
+ * @check [in]: check state
+ * @frame [in]: Ethernet frame
+ * @len [in]: frame length
+ */
+static void
+check_nptv6(struct xlat_check *check, const uint8_t *frame, size_t len)
+{
+	uint8_t buf[XLAT_MAX_FRAME], back[NAT_XLAT_IPV6_ADDR_LEN];
+	const uint8_t *in_addr = frame + XLAT_ETH_HDR_LEN + 8;
+	uint8_t *addr = buf + XLAT_ETH_HDR_LEN + 8;
+	const struct nat_nptv6 *npt = &check->npt;
+	doca_error_t result;
+	uint16_t in_sum, out_sum;
+	uint64_t start;
+	int i;
+
+	if (len < XLAT_ETH_HDR_LEN + NAT_XLAT_IPV6_HDR_LEN || !nat_nptv6_match(npt, in_addr, true)) {
+		check->nb_rejected++;
+		return;
+	}
+	memcpy(buf, frame, len);
+	start = xlat_now();
+	result = nat_nptv6_translate(npt, addr, true);
+	check->xlat_ns += xlat_now() - start;
+	if (rd16(in_addr + 6) == 0xffff) {
+		if (result != DOCA_ERROR_NOT_SUPPORTED)
+			report_mismatch(check, "The 0xffff subnet is translated", frame, len);
+		else
+			check->nb_rejected++;
+		return;
+	}
+	if (result != DOCA_SUCCESS) {
+		report_mismatch(check, "NPTv6 translation failed", frame, len);
+		return;
+	}
+
+	for (i = 0; i < NAT_XLAT_IPV6_ADDR_LEN; i++) {
+		if ((i < 6 && ((addr[i] & npt->mask[i]) != npt->external[i] ||
+			       (addr[i] & ~npt->mask[i]) != (in_addr[i] & ~npt->mask[i]))) ||
+		    (i >= 8 && addr[i] != in_addr[i])) {
+			report_mismatch(check, "NPTv6 translation changed the wrong bits", frame, len);
+			return;
+		}
+	}
+	/* 0 and 0xffff are the same one's complement value */
+	in_sum = ref_fold(ref_sum(0, in_addr, NAT_XLAT_IPV6_ADDR_LEN)) % 0xffff;
+	out_sum = ref_fold(ref_sum(0, addr, NAT_XLAT_IPV6_ADDR_LEN)) % 0xffff;
+	if (in_sum != out_sum || rd16(addr + 6) == 0xffff) {
+		report_mismatch(check, "NPTv6 translation is not checksum neutral", frame, len);
+		return;
+	}
+	if (ref_l4_valid(frame + XLAT_ETH_HDR_LEN, len - XLAT_ETH_HDR_LEN) &&
+	    !ref_l4_valid(buf + XLAT_ETH_HDR_LEN, len - XLAT_ETH_HDR_LEN)) {
+		report_mismatch(check, "NPTv6 translation broke the L4 checksum", frame, len);
+		return;
+	}
+	memcpy(back, addr, sizeof(back));
+	if (nat_nptv6_translate(npt, back, false) != DOCA_SUCCESS || memcmp(back, in_addr, sizeof(back)) != 0) {
+		report_mismatch(check, "NPTv6 inbound translation does not give back the address", frame, len);
+		return;
+	}
+	check->nb_translated++;
+	write_packet(check, frame, XLAT_ETHER_TYPE_IPV6, buf + XLAT_ETH_HDR_LEN, len - XLAT_ETH_HDR_LEN);
+}
+
+/*
+ * Check the translation of a frame
+ *
+ * @check [in]: check state
+ * @frame [in]: Ethernet frame
+ * @len [in]: frame length
+ */
+static void
+check_frame(struct xlat_check *check, const uint8_t *frame, size_t len)
+{
+	static const uint8_t local_ip[NAT_XLAT_IPV6_ADDR_LEN] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+								 0, 0, 0, 0, 0, 0, 0x12, 0x34};
+	uint16_t ether_type;
+
+	if (len < XLAT_ETH_HDR_LEN || len > XLAT_MAX_FRAME)
+		return;
+	check->nb_pkts++;
+	ether_type = rd16(frame + XLAT_ETH_HDR_LEN - 2);
+	if (!check->is_nat64) {
+		if (ether_type == XLAT_ETHER_TYPE_IPV6)
+			check_nptv6(check, frame, len);
+		else
+			check->nb_rejected++;
+	} else if (ether_type == XLAT_ETHER_TYPE_IPV6)
+		check_ipv6_to_ipv4(check, frame, len);
+	else if (ether_type == XLAT_ETHER_TYPE_IPV4)
+		check_ipv4_to_ipv6(check, frame, len, local_ip, 1024 + xlat_random(&check->rng) % 64512, true);
+	else
+		check->nb_rejected++;
+}
+
+/*
+ * Fill the L4 header and payload of a generated packet
+ *
+ * @rng [in/out]: random state
+ * @proto [in]: L4 protocol
+ * @l4 [out]: L4 header
+ * @l4_len [in]: L4 header and payload length
+ */
+static void
+gen_l4(uint64_t *rng, uint8_t proto, uint8_t *l4, size_t l4_len)
+{
+	uint64_t r;
+	size_t i;
+
+	for (i = 0; i < l4_len; i += sizeof(r)) {
+		r = xlat_random(rng);
+		memcpy(l4 + i, &r, l4_len - i < sizeof(r) ? l4_len - i : sizeof(r));
+	}
+	r = xlat_random(rng);
+	if (proto == IPPROTO_TCP)
+		l4[12] = 5 << 4;
+	else if (proto == IPPROTO_UDP)
+		wr16(l4 + 4, l4_len);
+	else if (proto == IPPROTO_ICMP)
+		l4[0] = r % 16 == 0 ? 3 : (r & 1) ? 8 : 0;
+	else
+		l4[0] = r % 16 == 0 ? 1 : (r & 1) ? 128 : 129;
+	if (proto == IPPROTO_ICMP || proto == IPPROTO_ICMPV6)
+		l4[1] = 0;
+}
+
+/*
+ * Pick a generated L4 protocol and length
+ *
+ * @rng [in/out]: random state
+ * @icmp [in]: ICMP protocol of the IP version
+ * @l4_len [out]: L4 header and payload length
+ * @return: L4 protocol
+ */
+static uint8_t
+gen_proto(uint64_t *rng, uint8_t icmp, size_t *l4_len)
+{
+	uint64_t r = xlat_random(rng);
+	uint8_t proto = r % 3 == 0 ? IPPROTO_TCP : r % 3 == 1 ? IPPROTO_UDP : icmp;
+
+	*l4_len = (proto == IPPROTO_TCP ? 20 : 8) + (r >> 8) % (XLAT_MAX_PAYLOAD + 1);
+	return proto;
+}
+
+/*
+ * Generate an IPv6 frame
+ *
+ * @check [in]: check state
+ * @frame [out]: Ethernet frame
+ * @return: frame length
+ */
+static size_t
+gen_ipv6(struct xlat_check *check, uint8_t *frame)
+{
+	uint8_t *l3 = frame + XLAT_ETH_HDR_LEN, *l4 = l3 + NAT_XLAT_IPV6_HDR_LEN;
+	uint64_t r = xlat_random(&check->rng), r2 = xlat_random(&check->rng);
+	uint16_t subnet;
+	size_t l4_len, len;
+	uint8_t proto;
+	int i;
+
+	memset(frame, 0, XLAT_ETH_MIN_FRAME);
+	frame[0] = 0x02;
+	frame[5] = 0x01;
+	frame[6] = 0x02;
+	frame[11] = 0x02;
+	wr16(frame + 12, XLAT_ETHER_TYPE_IPV6);
+
+	proto = gen_proto(&check->rng, IPPROTO_ICMPV6, &l4_len);
+	l3[0] = 0x60 | (r & 0x0f);
+	l3[1] = (r >> 8) & 0xff;
+	wr16(l3 + 2, r >> 16);
+	wr16(l3 + 4, l4_len);
+	l3[6] = proto;
+	l3[7] = r % 16 == 0 ? (r >> 32) % 3 : 64;
+	memcpy(l3 + 8, &r, sizeof(r));
+	memcpy(l3 + 16, &r2, sizeof(r2));
+	r = xlat_random(&check->rng);
+	r2 = xlat_random(&check->rng);
+	memcpy(l3 + 24, &r, sizeof(r));
+	memcpy(l3 + 32, &r2, sizeof(r2));
+	if (check->is_nat64) {
+		memcpy(l3 + 24, check->prefix, NAT_XLAT_NAT64_PREFIX_LEN);
+	} else {
+		for (i = 0; i < 6; i++)
+			l3[8 + i] = (l3[8 + i] & ~check->npt.mask[i]) | check->npt.internal[i];
+		/* The subnets without a translation and the subnets translated to the 0 word */
+		if (r % 32 == 0) {
+			wr16(l3 + 8 + 6, 0xffff);
+		} else if (r % 32 == 1) {
+			subnet = ~check->npt.adjustment;
+			memcpy(l3 + 8 + 6, &subnet, sizeof(subnet));
+		}
+	}
+
+	gen_l4(&check->rng, proto, l4, l4_len);
+	ref_set_l4_csum(l3 + 8, l3 + 24, NAT_XLAT_IPV6_ADDR_LEN, proto, l4, l4_len);
+	if (proto == IPPROTO_UDP && r % 32 == 2)
+		wr16(l4 + 6, 0);
+
+	len = XLAT_ETH_HDR_LEN + NAT_XLAT_IPV6_HDR_LEN + l4_len;
+	return len < XLAT_ETH_MIN_FRAME ? XLAT_ETH_MIN_FRAME : len;
+}
+
+/*
+ * Generate an IPv4 frame for NAT64, with options, fragments and zero UDP checksums
+ *
+ * @check [in]: check state
+ * @frame [out]: Ethernet frame
+ * @return: frame length
+ */
+static size_t
+gen_ipv4(struct xlat_check *check, uint8_t *frame)
+{
+	uint8_t *l3 = frame + XLAT_ETH_HDR_LEN, *l4;
+	uint64_t r = xlat_random(&check->rng);
+	size_t hdr_len, l4_len, len;
+	uint8_t proto;
+
+	memset(frame, 0, XLAT_ETH_MIN_FRAME);
+	frame[0] = 0x02;
+	frame[5] = 0x02;
+	frame[6] = 0x02;
+	frame[11] = 0x01;
+	wr16(frame + 12, XLAT_ETHER_TYPE_IPV4);
+
+	proto = gen_proto(&check->rng, IPPROTO_ICMP, &l4_len);
+	hdr_len = NAT_XLAT_IPV4_HDR_LEN + (r % 4 == 0 ? 4 * ((r >> 2) % 4) : 0);
+	l4 = l3 + hdr_len;
+	memset(l3, 1, hdr_len);
+	l3[0] = 0x40 | (hdr_len / 4);
+	l3[1] = r >> 8;
+	wr16(l3 + 2, hdr_len + l4_len);
+	wr16(l3 + 4, r >> 16);
+	wr16(l3 + 6, r % 16 == 1 ? 0x2000 : r % 16 == 2 ? 0x0010 : (r & 0x100) ? 0x4000 : 0);
+	l3[8] = r % 16 == 3 ? (r >> 32) % 3 : 64;
+	l3[9] = proto;
+	wr16(l3 + 10, 0);
+	r = xlat_random(&check->rng);
+	memcpy(l3 + 12, &r, 4);
+	wr16(l3 + 16, XLAT_GLOBAL_IP >> 16);
+	wr16(l3 + 18, XLAT_GLOBAL_IP & 0xffff);
+	wr16(l3 + 10, ~ref_fold(ref_sum(0, l3, hdr_len)));
+
+	gen_l4(&check->rng, proto, l4, l4_len);
+	ref_set_l4_csum(l3 + 12, l3 + 16, 4, proto, l4, l4_len);
+	if (proto == IPPROTO_UDP && (r >> 32) % 4 == 0)
+		wr16(l4 + 6, 0);
+
+	len = XLAT_ETH_HDR_LEN + hdr_len + l4_len;
+	return len < XLAT_ETH_MIN_FRAME ? XLAT_ETH_MIN_FRAME : len;
+}
+
+/*
+ * Check the packets of a pcap file
+ *
+ * @check [in]: check state
+ * @path [in]: pcap file path
+ * @return: 0 on success, -1 if the file can not be read
+ */
+static int
+check_pcap(struct xlat_check *check, const char *path)
+{
+	uint8_t frame[XLAT_MAX_FRAME];
+	struct pcap_file_hdr file_hdr;
+	struct pcap_pkt_hdr pkt_hdr;
+	bool swapped;
+	FILE *in;
+
+	in = fopen(path, "rb");
+	if (in == NULL) {
+		fprintf(stderr, "Failed to open %s\n", path);
+		return -1;
+	}
+	if (fread(&file_hdr, sizeof(file_hdr), 1, in) != 1 ||
+	    (file_hdr.magic != PCAP_MAGIC && file_hdr.magic != PCAP_MAGIC_SWAPPED)) {
+		fprintf(stderr, "%s is not a pcap file\n", path);
+		fclose(in);
+		return -1;
+	}
+	swapped = file_hdr.magic == PCAP_MAGIC_SWAPPED;
+	if ((swapped ? __builtin_bswap32(file_hdr.linktype) : file_hdr.linktype) != PCAP_LINKTYPE_ETHERNET) {
+		fprintf(stderr, "%s is not an Ethernet capture\n", path);
+		fclose(in);
+		return -1;
+	}
+
+	while (fread(&pkt_hdr, sizeof(pkt_hdr), 1, in) == 1) {
+		if (swapped)
+			pkt_hdr.caplen = __builtin_bswap32(pkt_hdr.caplen);
+		if (pkt_hdr.caplen > XLAT_MAX_FRAME) {
+			fseek(in, pkt_hdr.caplen, SEEK_CUR);
+			continue;
+		}
+		if (fread(frame, pkt_hdr.caplen, 1, in) != 1)
+			break;
+		check_frame(check, frame, pkt_hdr.caplen);
+	}
+	fclose(in);
+	return 0;
+}
+
+/*
+ * Print the usage of the check
+ *
+ * @prog [in]: Program name
+ */
+static void
+usage(const char *prog)
+{
+	printf("Usage: %s [-m <mode>] [-r <pcap>] [-w <pcap>] [-n <packets>] [-p <length>] [-S <seed>]\n"
+	       "  -m, --mode     nat64 or nptv6 (default nat64)\n"
+	       "  -r, --read     pcap file of the packets to translate, generated packets otherwise\n"
+	       "  -w, --write    pcap file of the translated packets\n"
+	       "  -n, --packets  generated packets (default %d)\n"
+	       "  -p, --prefix   NPTv6 prefix length, 1 to %d (default %d)\n"
+	       "  -S, --seed     random seed\n",
+	       prog, XLAT_PACKETS_DEFAULT, NAT_XLAT_NPTV6_MAX_PREFIX, NAT_XLAT_NPTV6_MAX_PREFIX);
+}
+
+int
+main(int argc, char **argv)
+{
+	static const struct option long_options[] = {
+		{"mode", required_argument, NULL, 'm'},
+		{"read", required_argument, NULL, 'r'},
+		{"write", required_argument, NULL, 'w'},
+		{"packets", required_argument, NULL, 'n'},
+		{"prefix", required_argument, NULL, 'p'},
+		{"seed", required_argument, NULL, 'S'},
+		{"help", no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0},
+	};
+	static const uint8_t internal[NAT_XLAT_IPV6_ADDR_LEN] = {0xfd, 0x01, 0x02, 0x03, 0x04, 0x05};
+	static const uint8_t external[NAT_XLAT_IPV6_ADDR_LEN] = {0x20, 0x01, 0x0d, 0xb8, 0x00, 0x01};
+	static const uint8_t nat64_prefix[NAT_XLAT_IPV6_ADDR_LEN] = {0x00, 0x64, 0xff, 0x9b};
+	struct pcap_file_hdr file_hdr = {PCAP_MAGIC, 2, 4, 0, 0, XLAT_MAX_FRAME, PCAP_LINKTYPE_ETHERNET};
+	struct xlat_check check = {.is_nat64 = true, .rng = 1};
+	uint8_t frame[XLAT_MAX_FRAME];
+	const char *read_path = NULL, *write_path = NULL;
+	long long nb_packets = XLAT_PACKETS_DEFAULT, i;
+	long prefix_len = NAT_XLAT_NPTV6_MAX_PREFIX;
+	size_t len;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "m:r:w:n:p:S:h", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'm':
+			if (strcmp(optarg, "nat64") != 0 && strcmp(optarg, "nptv6") != 0) {
+				usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			check.is_nat64 = strcmp(optarg, "nat64") == 0;
+			break;
+		case 'r':
+			read_path = optarg;
+			break;
+		case 'w':
+			write_path = optarg;
+			break;
+		case 'n':
+			nb_packets = strtoll(optarg, NULL, 0);
+			break;
+		case 'p':
+			prefix_len = strtol(optarg, NULL, 0);
+			break;
+		case 'S':
+			check.rng = strtoull(optarg, NULL, 0);
+			if (check.rng == 0)
+				check.rng = 1;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (nb_packets < 0 || prefix_len < 1 || prefix_len > NAT_XLAT_NPTV6_MAX_PREFIX ||
+	    nat_nptv6_init(internal, external, prefix_len, &check.npt) != DOCA_SUCCESS) {
+		fprintf(stderr, "Invalid arguments\n");
+		return EXIT_FAILURE;
+	}
+	memcpy(check.prefix, nat64_prefix, sizeof(check.prefix));
+
+	if (write_path != NULL) {
+		check.out = fopen(write_path, "wb");
+		if (check.out == NULL || fwrite(&file_hdr, sizeof(file_hdr), 1, check.out) != 1) {
+			fprintf(stderr, "Failed to create %s\n", write_path);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (read_path != NULL) {
+		if (check_pcap(&check, read_path) != 0) {
+			if (check.out != NULL)
+				fclose(check.out);
+			return EXIT_FAILURE;
+		}
+	} else {
+		for (i = 0; i < nb_packets; i++) {
+			if (check.is_nat64 && xlat_random(&check.rng) % 4 == 0)
+				len = gen_ipv4(&check, frame);
+			else
+				len = gen_ipv6(&check, frame);
+			check_frame(&check, frame, len);
+		}
+	}
+	if (check.out != NULL)
+		fclose(check.out);
+
+	printf("Mode:        %s\n", check.is_nat64 ? "NAT64" : "NPTv6");
+	printf("Packets:     %" PRIu64 "\n", check.nb_pkts);
+	printf("Translated:  %" PRIu64 ", %.1f ns per translation\n", check.nb_translated,
+	       check.nb_translated ? (double)check.xlat_ns / check.nb_translated : 0.0);
+	printf("Rejected:    %" PRIu64 " by both translators\n", check.nb_rejected);
+	printf("Skipped:     %" PRIu64 " with a wrong L4 checksum\n", check.nb_skipped);
+	printf("Mismatches:  %" PRIu64 "\n", check.nb_mismatch);
+	return check.nb_mismatch == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -13,6 +13,8 @@
 
 #include <signal.h>
 
+#include <rte_lcore.h>
+
 #include <doca_argp.h>
 #include <doca_log.h>
 
@@ -21,9 +23,10 @@
 DOCA_LOG_REGISTER(NAT);
 
 static bool force_quit;		/* Set when signal is received */
+static volatile bool reload_rules;	/* Set when SIGHUP is received */
 
 /*
- * Signals handler function to handle SIGINT and SIGTERM signals
+ * Signals handler function to handle SIGINT and SIGTERM signals, and SIGHUP to reload the NAT rules
  *
  * @signum [in]: signal number
  */
@@ -33,7 +36,10 @@ signal_handler(int signum)
 	if (signum == SIGINT || signum == SIGTERM) {
 		DOCA_LOG_INFO("Signal %d received, preparing to exit", signum);
 		force_quit = true;
-	}
+		nat_dynamic_stop();
+		nat_ipv6_stop();
+	} else if (signum == SIGHUP)
+		reload_rules = true;
 }
 
 /*
@@ -55,8 +61,6 @@ main(int argc, char **argv)
 	doca_error_t result;
 	int exit_status = EXIT_SUCCESS;
 	struct nat_cfg app_cfg = {0};
-	struct nat_rule_match *nat_rules = NULL;
-	int nat_num_rules;
 	struct doca_log_backend *sdk_log;
 
 	force_quit = false;
@@ -94,6 +98,12 @@ main(int argc, char **argv)
 		return EXIT_FAILURE;
 	}
 
+	/* In dynamic, NPTV6 and NAT64 modes every lcore polls its own queue for the packets translated in software */
+	if (app_cfg.mode == DYNAMIC || app_cfg.mode == NPTV6 || app_cfg.mode == NAT64) {
+		dpdk_config.port_config.nb_queues = rte_lcore_count();
+		dpdk_config.port_config.rss_support = 1;
+	}
+
 	result = dpdk_queues_and_ports_init(&dpdk_config);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to update application ports and queues: %s", doca_error_get_descr(result));
@@ -101,6 +111,23 @@ main(int argc, char **argv)
 		goto dpdk_destroy;
 	}
 
+	/* parse the dynamic mode pool from json, its size sets the flow resources */
+	if (app_cfg.mode == DYNAMIC) {
+		result = parsing_nat_pool(app_cfg.json_path, &app_cfg.pool_cfg);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to parse NAT pool from JSON: %s", doca_error_get_descr(result));
+			exit_status = EXIT_FAILURE;
+			goto dpdk_cleanup;
+		}
+	} else if (app_cfg.mode == NPTV6 || app_cfg.mode == NAT64) {
+		result = parsing_nat_ipv6(app_cfg.json_path, &app_cfg);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to parse NAT IPv6 configuration from JSON: %s", doca_error_get_descr(result));
+			exit_status = EXIT_FAILURE;
+			goto dpdk_cleanup;
+		}
+	}
+
 	/* init doca flows and ports */
 	result = nat_init(&app_cfg, &dpdk_config);
 	if (result != DOCA_SUCCESS) {
@@ -108,29 +135,48 @@ main(int argc, char **argv)
 		goto dpdk_cleanup;
 	}
 
-	/* parse nat rule from json and add to internal struct */
-	result = parsing_nat_rules(app_cfg.json_path, app_cfg.mode, &nat_num_rules, &nat_rules);
+	/* create nat pipes */
+	result = nat_pipes_init(&app_cfg, dpdk_config.port_config.nb_ports);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to parse NAT rules from JSON: %s", doca_error_get_descr(result));
 		exit_status = EXIT_FAILURE;
 		goto nat_cleanup;
 	}
 
-	/* set nat rules to pipes */
-	result = nat_pipes_init(nat_rules, nat_num_rules, &app_cfg, dpdk_config.port_config.nb_ports);
-	if (result != DOCA_SUCCESS) {
-		exit_status = EXIT_FAILURE;
-		goto nat_cleanup;
+	/* stream nat rules from json to the pipes */
+	if (app_cfg.mode == STATIC || app_cfg.mode == PAT) {
+		result = nat_rules_load(&app_cfg);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to load NAT rules from JSON: %s", doca_error_get_descr(result));
+			exit_status = EXIT_FAILURE;
+			goto nat_cleanup;
+		}
 	}
 	signal(SIGINT, signal_handler);
 	signal(SIGTERM, signal_handler);
+	signal(SIGHUP, signal_handler);
 	DOCA_LOG_INFO("Waiting for traffic, press Ctrl+C for termination");
-	while (!force_quit)
-		sleep(1);
+	if (app_cfg.mode == DYNAMIC) {
+		rte_eal_mp_remote_launch(nat_dynamic_process_pkts, NULL, CALL_MAIN);
+		rte_eal_mp_wait_lcore();
+	} else if (app_cfg.mode == NPTV6 || app_cfg.mode == NAT64) {
+		rte_eal_mp_remote_launch(nat_ipv6_process_pkts, NULL, CALL_MAIN);
+		rte_eal_mp_wait_lcore();
+	} else {
+		while (!force_quit) {
+			sleep(1);
+			if (!reload_rules)
+				continue;
+			reload_rules = false;
+			DOCA_LOG_INFO("Reloading NAT rules from %s", app_cfg.json_path);
+			result = nat_rules_load(&app_cfg);
+			if (result != DOCA_SUCCESS)
+				DOCA_LOG_ERR("Failed to reload NAT rules: %s", doca_error_get_descr(result));
+		}
+	}
 
 nat_cleanup:
 	/* cleanup app resources */
-	nat_destroy(dpdk_config.port_config.nb_ports, nat_rules);
+	nat_destroy(dpdk_config.port_config.nb_ports);
 
 dpdk_cleanup:
 	/* cleanup resources */
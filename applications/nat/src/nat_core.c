@@ -11,11 +11,21 @@
  *
  */
 
+#include <arpa/inet.h>
+#include <inttypes.h>
 #include <unistd.h>
 
 #include <json-c/json.h>
 #include <rte_byteorder.h>
+#include <rte_cycles.h>
 #include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
 
 #include <doca_argp.h>
 #include <doca_log.h>
@@ -23,6 +33,7 @@
 #include <utils.h>
 
 #include "nat_core.h"
+#include "nat_rules.h"
 
 DOCA_LOG_REGISTER(NAT_CORE);
 
@@ -35,8 +46,64 @@ DOCA_LOG_REGISTER(NAT_CORE);
 #define NB_ACTIONS_ARR (1)									/* default number of actions in pipe */
 #define MAX_PORT_NAME 30									/* Maximal length of port name */
 #define QUEUE_DEPTH 256										/* DOCA Flow queue depth */
+#define NAT_RX_BURST_SIZE 32									/* Packets received at once in dynamic mode */
+#define NAT_AGING_QUOTA_US 100									/* Time quota of an aging handling (microseconds) */
+#define NAT_AGING_PER_SEC 10									/* Aging handlings per second of an lcore */
+#define NAT_SESSION_FAILED (1 << 0)								/* An entry of the session failed */
+#define NAT_SESSION_RETIRED (1 << 1)								/* The entries of the session are removed */
+#define NAT_RULES_BATCH (QUEUE_DEPTH / 4)							/* Rule entries pushed to the hardware at once */
+
+enum nat_l4_pipe {
+	NAT_L4_TCP = 0,		/* Pipe of the TCP flows */
+	NAT_L4_UDP = 1,		/* Pipe of the UDP flows */
+};
+
+/* Dynamic mode context of an lcore, only accessed by its lcore */
+struct nat_lcore_ctx {
+	struct nat_pool *pool;		/* Global IPs/ports and sessions of the lcore */
+	uint32_t nb_pending;		/* Entry operations not completed yet */
+	uint64_t nb_created;		/* Created sessions */
+	uint64_t nb_aged;		/* Aged out sessions */
+	uint64_t nb_failed;		/* Sessions whose entries failed */
+	uint64_t nb_exhausted;		/* New flows dropped on an empty pool */
+	uint64_t nb_sw_pkts;		/* Packets translated in software */
+} __rte_cache_aligned;
+
+/* Dynamic mode state */
+struct nat_dynamic_state {
+	uint16_t lan_port_id;					/* Port of the LAN */
+	uint16_t wan_port_id;					/* Port of the WAN */
+	struct doca_flow_pipe *lan_pipes[NUM_OF_SUPPORTED_PROTOCOLS];	/* LAN to WAN session pipes */
+	struct doca_flow_pipe *wan_pipes[NUM_OF_SUPPORTED_PROTOCOLS];	/* WAN to LAN session pipes */
+	uint32_t aging_sec;					/* Idle time of a session before it is removed */
+	uint16_t nb_queues;					/* Number of queues, one per lcore */
+	struct nat_lcore_ctx *lcores;				/* Context of the lcores, by queue */
+	volatile bool force_quit;				/* Set to stop the lcores */
+};
+
+/* Rule entry operations of one port, their completions are counted by check_for_valid_entry() */
+struct nat_entry_queue {
+	struct entries_status status;	/* Completions of the operations, user context of all the entries */
+	int nb_ops;			/* Submitted operations */
+	int nb_unpushed;		/* Operations waiting for the end of their batch */
+	uint32_t nb_failed;		/* Operations that failed to be submitted */
+	bool stalled;			/* Set when the operations stopped completing */
+};
+
+/* Static and PAT modes state */
+struct nat_rules_state {
+	enum nat_mode mode;						/* NAT mode of the rules */
+	uint16_t lan_port_id;						/* Port of the LAN */
+	uint16_t wan_port_id;						/* Port of the WAN */
+	struct doca_flow_pipe *lan_pipes[NUM_OF_SUPPORTED_PROTOCOLS];	/* LAN to WAN pipes, static mode uses the first */
+	struct doca_flow_pipe *wan_pipes[NUM_OF_SUPPORTED_PROTOCOLS];	/* WAN to LAN pipes, static mode uses the first */
+	struct nat_entry_queue queues[NAT_PORTS_NUM];			/* Entry operations, by port */
+	struct nat_rule_set rules;					/* Installed rules */
+};
 
 static struct doca_flow_port *ports[NAT_PORTS_NUM];
+static struct nat_dynamic_state dynamic_state;
+static struct nat_rules_state rules_state;
 
 /*
  * ARGP Callback - Handle nat mode parameter
@@ -53,8 +120,14 @@ nat_mode_callback(void *param, void *config)
 
 	if (strcmp(mode, "static") == 0)
 		nat_cfg->mode = STATIC;
+	else if (strcmp(mode, "dynamic") == 0)
+		nat_cfg->mode = DYNAMIC;
 	else if (strcmp(mode, "pat") == 0)
 		nat_cfg->mode = PAT;
+	else if (strcmp(mode, "nptv6") == 0)
+		nat_cfg->mode = NPTV6;
+	else if (strcmp(mode, "nat64") == 0)
+		nat_cfg->mode = NAT64;
 	else {
 		nat_cfg->mode = NAT_INVALID_MODE;
 		DOCA_LOG_ERR("Illegal nat mode = %s", mode);
@@ -178,7 +251,7 @@ register_nat_params(void)
 	doca_argp_param_set_short_name(nat_mode, "m");
 	doca_argp_param_set_long_name(nat_mode, "mode");
 	doca_argp_param_set_arguments(nat_mode, "<mode>");
-	doca_argp_param_set_description(nat_mode, "set NAT mode");
+	doca_argp_param_set_description(nat_mode, "set NAT mode: static, dynamic, pat, nptv6 or nat64");
 	doca_argp_param_set_callback(nat_mode, nat_mode_callback);
 	doca_argp_param_set_type(nat_mode, DOCA_ARGP_TYPE_STRING);
 	result = doca_argp_register_param(nat_mode);
@@ -258,111 +331,6 @@ register_nat_params(void)
 	return result;
 }
 
-/*
- * parse and set local ip from json file to nat rule struct
- *
- * @cur_rule [in]: rule in json object format
- * @rule [out]: rule in app structure format.
- * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
- */
-static doca_error_t
-create_local_ip(struct json_object *cur_rule, struct nat_rule_match *rule)
-{
-	doca_error_t result;
-	struct json_object *local_ip;
-
-	if (!json_object_object_get_ex(cur_rule, "local ip", &local_ip)) {
-		DOCA_LOG_ERR("Missing local IP");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-	if (json_object_get_type(local_ip) != json_type_string) {
-		DOCA_LOG_ERR("Expecting a string value for \"local ip\"");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-
-	result = parse_ipv4_str(json_object_get_string(local_ip), &rule->local_ip);
-	if (result != DOCA_SUCCESS)
-		return result;
-	return DOCA_SUCCESS;
-}
-/*
- * parse and set global ip from json file to nat rule struct
- *
- * @cur_rule [in]: rule in json object format
- * @rule [out]: rule in app structure format.
- * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
- */
-static doca_error_t
-create_global_ip(struct json_object *cur_rule, struct nat_rule_match *rule)
-{
-	doca_error_t result;
-	struct json_object *global_ip;
-
-	if (!json_object_object_get_ex(cur_rule, "global ip", &global_ip)) {
-		DOCA_LOG_ERR("Missing global IP");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-	if (json_object_get_type(global_ip) != json_type_string) {
-		DOCA_LOG_ERR("Expecting a string value for \"global ip\"");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-
-	result = parse_ipv4_str(json_object_get_string(global_ip), &rule->global_ip);
-	if (result != DOCA_SUCCESS)
-		return result;
-	return DOCA_SUCCESS;
-}
-
-/*
- * parse and set local port from json file to nat rule struct
- *
- * @cur_rule [in]: rule in json object format
- * @rule [out]: rule in app structure format.
- * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
- */
-static doca_error_t
-create_local_port(struct json_object *cur_rule, struct nat_rule_match *rule)
-{
-	struct json_object *local_port;
-
-	if (!json_object_object_get_ex(cur_rule, "local port", &local_port)) {
-		DOCA_LOG_ERR("Missing local port");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-	if (json_object_get_type(local_port) != json_type_int) {
-		DOCA_LOG_ERR("Expecting an int value for \"local port\"");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-
-	rule->local_port = json_object_get_int(local_port);
-	return DOCA_SUCCESS;
-}
-
-/*
- * parse and set global port from json file to nat rule struct
- *
- * @cur_rule [in]: rule in json object format
- * @rule [out]: rule in app structure format.
- * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
- */
-static doca_error_t
-create_global_port(struct json_object *cur_rule, struct nat_rule_match *rule)
-{
-	struct json_object *global_port;
-
-	if (!json_object_object_get_ex(cur_rule, "global port", &global_port)) {
-		DOCA_LOG_ERR("Missing global port");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-	if (json_object_get_type(global_port) != json_type_int) {
-		DOCA_LOG_ERR("Expecting an int value for \"global port\"");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-
-	rule->global_port = json_object_get_int(global_port);
-	return DOCA_SUCCESS;
-}
-
 /*
  * Create doca flow ports
  *
@@ -389,6 +357,31 @@ nat_port_create(uint8_t portid, struct doca_flow_port **port)
 	return DOCA_SUCCESS;
 }
 
+/*
+ * Free the pools of the lcores in NAT dynamic mode and log their counters
+ */
+static void
+destroy_dynamic_pools(void)
+{
+	struct nat_lcore_ctx *lcore;
+	uint16_t queue;
+
+	if (dynamic_state.lcores == NULL)
+		return;
+	for (queue = 0; queue < dynamic_state.nb_queues; queue++) {
+		lcore = &dynamic_state.lcores[queue];
+		if (lcore->pool == NULL)
+			continue;
+		DOCA_LOG_INFO("Queue %u: %" PRIu64 " sessions created, %" PRIu64 " aged, %" PRIu64 " failed, %u live, %"
+			      PRIu64 " new flows dropped on an empty pool, %" PRIu64 " packets translated in software",
+			      queue, lcore->nb_created, lcore->nb_aged, lcore->nb_failed, lcore->pool->nb_sessions,
+			      lcore->nb_exhausted, lcore->nb_sw_pkts);
+		nat_pool_destroy(lcore->pool);
+	}
+	rte_free(dynamic_state.lcores);
+	dynamic_state.lcores = NULL;
+}
+
 /*
  * stop doca ports
  *
@@ -406,132 +399,13 @@ nat_stop_ports(int nb_ports)
 }
 
 void
-nat_destroy(int nb_ports, struct nat_rule_match *nat_rules)
+nat_destroy(int nb_ports)
 {
 	nat_stop_ports(nb_ports);
 	doca_flow_destroy();
-	if (nat_rules != NULL)
-		free(nat_rules);
-}
-
-/*
- * Create and update rules array for static mode
- *
- * @parsed_json [in]: rules in json object format
- * @nat_num_rules [out]: num of rules to configure
- * @nat_rules [out]: array of rules
- * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
- */
-static doca_error_t
-create_static_mode_rules(struct json_object *parsed_json, int *nat_num_rules, struct nat_rule_match **nat_rules)
-{
-	int i;
-	doca_error_t result;
-	struct json_object *rules;
-	struct json_object *cur_rule;
-	struct nat_rule_match *rules_arr = NULL;
-
-	if (!json_object_object_get_ex(parsed_json, "rules", &rules)) {
-		DOCA_LOG_ERR("Missing \"rules\" parameter");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-
-	*nat_num_rules = json_object_array_length(rules);
-
-	DOCA_LOG_INFO("Number of rules in input file: %d", *nat_num_rules);
-
-	rules_arr = (struct nat_rule_match *)calloc(*nat_num_rules, sizeof(struct nat_rule_match));
-	if (rules_arr == NULL) {
-		DOCA_LOG_ERR("calloc() function failed");
-		return DOCA_ERROR_NO_MEMORY;
-	}
-
-	for (i = 0; i < *nat_num_rules; i++) {
-		cur_rule = json_object_array_get_idx(rules, i);
-		result = create_local_ip(cur_rule, &rules_arr[i]);
-		if (result != DOCA_SUCCESS) {
-			free(rules_arr);
-			return result;
-		}
-		result = create_global_ip(cur_rule, &rules_arr[i]);
-		if (result != DOCA_SUCCESS) {
-			free(rules_arr);
-			return result;
-		}
-	}
-	*nat_rules = rules_arr;
-	return DOCA_SUCCESS;
-}
-
-/*
- * Create and update rules array for pat mode
- *
- * @parsed_json [in]: rules in json object format
- * @nat_num_rules [out]: num of rules to configure
- * @nat_rules [out]: array of rules
- * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
- */
-static doca_error_t
-create_pat_mode_rules(struct json_object *parsed_json, int *nat_num_rules, struct nat_rule_match **nat_rules)
-{
-	int i;
-	doca_error_t result;
-	struct json_object *cur_rule;
-	struct json_object *global_ip;
-	struct json_object *rules;
-	struct nat_rule_match *rules_arr = NULL;
-	doca_be32_t parsed_global_ip;
-
-	if (!json_object_object_get_ex(parsed_json, "global ip", &global_ip)) {
-		DOCA_LOG_ERR("Missing global IP");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-	if (json_object_get_type(global_ip) != json_type_string) {
-		DOCA_LOG_ERR("Expecting a string value for \"global ip\"");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-
-	result = parse_ipv4_str(json_object_get_string(global_ip), &parsed_global_ip);
-	if (result != DOCA_SUCCESS)
-		return result;
-	DOCA_LOG_DBG("PAT global IP = %d.%d.%d.%d", (parsed_global_ip & 0xff), (parsed_global_ip >> 8 & 0xff), (parsed_global_ip >> 16 & 0xff), (parsed_global_ip >> 24 & 0xff));
-
-	if (!json_object_object_get_ex(parsed_json, "rules", &rules)) {
-		DOCA_LOG_ERR("Missing \"rules\" parameter");
-		return DOCA_ERROR_INVALID_VALUE;
-	}
-
-	*nat_num_rules = json_object_array_length(rules);
-
-	DOCA_LOG_DBG("Number of rules in input file: %d", *nat_num_rules);
-
-	rules_arr = (struct nat_rule_match *)calloc(*nat_num_rules, sizeof(struct nat_rule_match));
-	if (rules_arr == NULL) {
-		DOCA_LOG_ERR("calloc() function failed");
-		return DOCA_ERROR_NO_MEMORY;
-	}
-
-	for (i = 0; i < *nat_num_rules; i++) {
-		cur_rule = json_object_array_get_idx(rules, i);
-		result = create_local_ip(cur_rule, &rules_arr[i]);
-		if (result != DOCA_SUCCESS) {
-			free(rules_arr);
-			return result;
-		}
-		result = create_local_port(cur_rule, &rules_arr[i]);
-		if (result != DOCA_SUCCESS) {
-			free(rules_arr);
-			return result;
-		}
-		result = create_global_port(cur_rule, &rules_arr[i]);
-		if (result != DOCA_SUCCESS) {
-			free(rules_arr);
-			return result;
-		}
-		rules_arr[i].global_ip = parsed_global_ip;
-	}
-	*nat_rules = rules_arr;
-	return DOCA_SUCCESS;
+	destroy_dynamic_pools();
+	nat_ipv6_destroy();
+	nat_rule_set_free(&rules_state.rules);
 }
 
 /*
@@ -574,13 +448,19 @@ allocate_json_buffer_dynamic(FILE *fp, size_t *file_length, char **json_data)
 	return DOCA_SUCCESS;
 }
 
-doca_error_t
-parsing_nat_rules(char *file_path, enum nat_mode mode, int *nat_num_rules, struct nat_rule_match **nat_rules)
+/*
+ * Read and parse a json rules file
+ *
+ * @file_path [in]: json file path
+ * @parsed_json [out]: parsed json object, to release with json_object_put()
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+parse_json_file(char *file_path, struct json_object **parsed_json)
 {
 	FILE *json_fp;
 	size_t file_length;
 	char *json_data = NULL;
-	struct json_object *parsed_json;
 	doca_error_t result;
 
 	json_fp = fopen(file_path, "r");
@@ -599,129 +479,452 @@ parsing_nat_rules(char *file_path, enum nat_mode mode, int *nat_num_rules, struc
 	if (fread(json_data, file_length, 1, json_fp) < file_length)
 		DOCA_LOG_DBG("EOF reached");
 	fclose(json_fp);
-	parsed_json = json_tokener_parse(json_data);
+	json_data[file_length] = '\0';
+	*parsed_json = json_tokener_parse(json_data);
 
 	free(json_data);
-
-	switch (mode) {
-	case STATIC:
-		result = create_static_mode_rules(parsed_json, nat_num_rules, nat_rules);
-		break;
-	case PAT:
-		result = create_pat_mode_rules(parsed_json, nat_num_rules, nat_rules);
-		break;
-	default:
-		DOCA_LOG_ERR("Invalid NAT mode");
+	if (*parsed_json == NULL) {
+		DOCA_LOG_ERR("Failed to parse JSON file %s", file_path);
 		return DOCA_ERROR_INVALID_VALUE;
 	}
-	return result;
+	return DOCA_SUCCESS;
 }
 
 /*
- * Entry processing callback
+ * Get an optional int value of the dynamic pool configuration
  *
- * @entry [in]: DOCA Flow entry
- * @pipe_queue [in]: queue identifier
- * @status [in]: DOCA Flow entry status
- * @op [in]: DOCA Flow entry operation
- * @user_ctx [out]: user context
+ * @parsed_json [in]: pool in json object format
+ * @name [in]: name of the value
+ * @def_value [in]: value to use when the name is missing
+ * @min_value [in]: lowest valid value
+ * @max_value [in]: highest valid value
+ * @value [out]: the value
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-static void
-check_for_valid_entry(struct doca_flow_pipe_entry *entry, uint16_t pipe_queue,
-		      enum doca_flow_entry_status status, enum doca_flow_entry_op op, void *user_ctx)
+static doca_error_t
+get_pool_int(struct json_object *parsed_json, const char *name, int64_t def_value, int64_t min_value,
+	     int64_t max_value, int64_t *value)
 {
-	(void)entry;
-	(void)pipe_queue;
-
-	struct entries_status *entry_status = (struct entries_status *)user_ctx;
+	struct json_object *json_value;
 
-	if (entry_status == NULL || op != DOCA_FLOW_ENTRY_OP_ADD)
-		return;
-	if (status != DOCA_FLOW_ENTRY_STATUS_SUCCESS) {
-		DOCA_LOG_ERR("Entry processing failed. entry_op=%d", op);
-		entry_status->is_failure = true; /* Set is_failure to true if processing failed */
+	if (!json_object_object_get_ex(parsed_json, name, &json_value)) {
+		*value = def_value;
+		return DOCA_SUCCESS;
 	}
-	entry_status->nb_processed++;
+	if (json_object_get_type(json_value) != json_type_int) {
+		DOCA_LOG_ERR("Expecting an int value for \"%s\"", name);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	*value = json_object_get_int64(json_value);
+	if (*value < min_value || *value > max_value) {
+		DOCA_LOG_ERR("\"%s\" must be between %" PRId64 " and %" PRId64, name, min_value, max_value);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
 }
 
-doca_error_t
-nat_init(struct nat_cfg *app_cfg, struct application_dpdk_config *app_dpdk_config)
+/*
+ * Create the global address pool for dynamic mode
+ *
+ * @parsed_json [in]: pool in json object format
+ * @pool_cfg [out]: global address pool configuration
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+create_dynamic_mode_pool(struct json_object *parsed_json, struct nat_pool_cfg *pool_cfg)
 {
-	(void)app_cfg;
-
-	uint16_t nb_ports;
-	struct doca_flow_cfg nat_flow_cfg = {0};
+	struct json_object *global_ips;
+	struct json_object *global_ip;
+	int64_t min_port, max_port, aging_sec, max_sessions;
 	doca_error_t result;
-	int portid;
-
-	/* Initialize doca framework */
-	nat_flow_cfg.queues = app_dpdk_config->port_config.nb_queues;
-	nat_flow_cfg.mode_args = "vnf,hws";
-	nat_flow_cfg.cb = check_for_valid_entry;
-	nat_flow_cfg.queue_depth = QUEUE_DEPTH;
-
-	nb_ports = app_dpdk_config->port_config.nb_ports;
+	int i, nb_global_ips;
 
-	result = doca_flow_init(&nat_flow_cfg);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to init doca flow ports: %s", doca_error_get_descr(result));
-		return result;
+	if (!json_object_object_get_ex(parsed_json, "global ips", &global_ips)) {
+		DOCA_LOG_ERR("Missing \"global ips\" parameter");
+		return DOCA_ERROR_INVALID_VALUE;
 	}
-
-	for (portid = 0; portid < nb_ports; portid++) {
-		/* Create doca flow port */
-		result = nat_port_create(portid, &ports[portid]);
-		if (result != DOCA_SUCCESS) {
-			nat_stop_ports(portid);
-			doca_flow_destroy();
-			return result;
+	if (json_object_get_type(global_ips) != json_type_array) {
+		DOCA_LOG_ERR("Expecting an array value for \"global ips\"");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	nb_global_ips = json_object_array_length(global_ips);
+	if (nb_global_ips == 0 || nb_global_ips > NAT_POOL_MAX_GLOBAL_IPS) {
+		DOCA_LOG_ERR("Expecting 1 to %d global IPs, got %d", NAT_POOL_MAX_GLOBAL_IPS, nb_global_ips);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	for (i = 0; i < nb_global_ips; i++) {
+		global_ip = json_object_array_get_idx(global_ips, i);
+		if (json_object_get_type(global_ip) != json_type_string) {
+			DOCA_LOG_ERR("Expecting string values in \"global ips\"");
+			return DOCA_ERROR_INVALID_VALUE;
 		}
-		/* Pair ports should be the same as DPDK hairpin binding order */
-		if (!portid || !(portid % 2))
-			continue;
-		result = doca_flow_port_pair(ports[portid], ports[portid ^ 1]);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Pair port %u %u fail", portid, portid ^ 1);
-			nat_stop_ports(portid + 1);
-			doca_flow_destroy();
+		result = parse_ipv4_str(json_object_get_string(global_ip), &pool_cfg->global_ips[i]);
+		if (result != DOCA_SUCCESS)
 			return result;
-		}
 	}
+	pool_cfg->nb_global_ips = nb_global_ips;
 
-	DOCA_LOG_DBG("Application configuration and rules offload done");
+	result = get_pool_int(parsed_json, "min port", NAT_POOL_DEFAULT_MIN_PORT, 1, UINT16_MAX, &min_port);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = get_pool_int(parsed_json, "max port", NAT_POOL_DEFAULT_MAX_PORT, min_port, UINT16_MAX, &max_port);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = get_pool_int(parsed_json, "aging timeout", NAT_POOL_DEFAULT_AGING_SEC, 1, UINT32_MAX, &aging_sec);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = get_pool_int(parsed_json, "max sessions", NAT_POOL_DEFAULT_MAX_SESSIONS, 1, NAT_POOL_MAX_SESSIONS,
+			      &max_sessions);
+	if (result != DOCA_SUCCESS)
+		return result;
+	pool_cfg->min_port = min_port;
+	pool_cfg->max_port = max_port;
+	pool_cfg->aging_sec = aging_sec;
+	pool_cfg->max_sessions = max_sessions;
+
+	DOCA_LOG_INFO("Dynamic pool of %d global IPs, ports %u-%u, up to %u sessions aged after %u seconds",
+		      nb_global_ips, pool_cfg->min_port, pool_cfg->max_port, pool_cfg->max_sessions, pool_cfg->aging_sec);
 	return DOCA_SUCCESS;
 }
 
+doca_error_t
+parsing_nat_pool(char *file_path, struct nat_pool_cfg *pool_cfg)
+{
+	struct json_object *parsed_json;
+	doca_error_t result;
+
+	result = parse_json_file(file_path, &parsed_json);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	result = create_dynamic_mode_pool(parsed_json, pool_cfg);
+	json_object_put(parsed_json);
+	return result;
+}
+
 /*
- * build pipe for data come from LAN in NAT static mode
+ * Get an IPv6 prefix written as address/length from json
  *
- * @port_id [in]: port id to build the pipe for
- * @nat_rules [in]: rules defintion to configure
- * @nat_num_rules [in]: number of rules to configure
+ * @parsed_json [in]: configuration in json object format
+ * @name [in]: name of the prefix
+ * @addr [out]: prefix address
+ * @prefix_len [out]: prefix length in bits
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-build_static_local_pipe(uint16_t port_id, struct nat_rule_match *nat_rules, int nat_num_rules)
+get_ipv6_prefix(struct json_object *parsed_json, const char *name, uint8_t *addr, uint8_t *prefix_len)
 {
-	struct doca_flow_match match;
-	struct doca_flow_fwd fwd;
-	struct doca_flow_fwd miss_fwd;
-	struct doca_flow_actions actions, *actions_arr[NB_ACTIONS_ARR];
-	struct doca_flow_pipe_cfg pipe_cfg;
-	struct doca_flow_pipe *nat_pipe;
-	struct doca_flow_pipe_entry *entry;
-	struct entries_status status;
-	uint32_t flags;
-	uint16_t ruleid;
-	int nb_entries = 0;
-	doca_error_t result;
-
+	struct json_object *json_prefix;
+	char addr_str[INET6_ADDRSTRLEN];
+	const char *prefix_str, *len_str;
+	char *end;
+	long len;
+
+	if (!json_object_object_get_ex(parsed_json, name, &json_prefix)) {
+		DOCA_LOG_ERR("Missing \"%s\" parameter", name);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (json_object_get_type(json_prefix) != json_type_string) {
+		DOCA_LOG_ERR("Expecting a string value for \"%s\"", name);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	prefix_str = json_object_get_string(json_prefix);
+	len_str = strchr(prefix_str, '/');
+	if (len_str == NULL || len_str - prefix_str >= INET6_ADDRSTRLEN) {
+		DOCA_LOG_ERR("Invalid IPv6 prefix \"%s\", expecting address/length", prefix_str);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	memcpy(addr_str, prefix_str, len_str - prefix_str);
+	addr_str[len_str - prefix_str] = '\0';
+	len = strtol(len_str + 1, &end, 10);
+	if (inet_pton(AF_INET6, addr_str, addr) != 1 || end == len_str + 1 || *end != '\0' || len < 0 || len > 128) {
+		DOCA_LOG_ERR("Invalid IPv6 prefix \"%s\", expecting address/length", prefix_str);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	*prefix_len = len;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Create the prefixes of NPTV6 mode
+ *
+ * @parsed_json [in]: configuration in json object format
+ * @ipv6_cfg [out]: NPTV6 configuration
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+create_nptv6_mode_prefixes(struct json_object *parsed_json, struct nat_ipv6_cfg *ipv6_cfg)
+{
+	uint8_t internal[NAT_XLAT_IPV6_ADDR_LEN], external[NAT_XLAT_IPV6_ADDR_LEN];
+	uint8_t internal_len, external_len;
+	int64_t max_subnets;
+	doca_error_t result;
+
+	result = get_ipv6_prefix(parsed_json, "internal prefix", internal, &internal_len);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = get_ipv6_prefix(parsed_json, "external prefix", external, &external_len);
+	if (result != DOCA_SUCCESS)
+		return result;
+	if (internal_len != external_len) {
+		DOCA_LOG_ERR("The internal and external prefixes must have the same length");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	result = nat_nptv6_init(internal, external, internal_len, &ipv6_cfg->npt);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("NPTv6 prefixes must be 1 to %d bits long", NAT_XLAT_NPTV6_MAX_PREFIX);
+		return result;
+	}
+	result = get_pool_int(parsed_json, "max subnets", NAT_IPV6_DEFAULT_MAX_SUBNETS, 1, NAT_IPV6_MAX_SUBNETS,
+			      &max_subnets);
+	if (result != DOCA_SUCCESS)
+		return result;
+	ipv6_cfg->max_subnets = max_subnets;
+
+	DOCA_LOG_INFO("NPTv6 of /%u prefixes, up to %u subnets translated by the hardware", internal_len,
+		      ipv6_cfg->max_subnets);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Create the prefix of NAT64 mode, the IPv4 addresses of the WAN hosts are its last 32 bits
+ *
+ * @parsed_json [in]: configuration in json object format
+ * @ipv6_cfg [out]: NAT64 configuration
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+create_nat64_mode_prefix(struct json_object *parsed_json, struct nat_ipv6_cfg *ipv6_cfg)
+{
+	uint8_t prefix[NAT_XLAT_IPV6_ADDR_LEN];
+	uint8_t prefix_len;
+	doca_error_t result;
+
+	result = get_ipv6_prefix(parsed_json, "nat64 prefix", prefix, &prefix_len);
+	if (result != DOCA_SUCCESS)
+		return result;
+	if (prefix_len != NAT_XLAT_NAT64_PREFIX_LEN * 8) {
+		DOCA_LOG_ERR("Only a /%d NAT64 prefix is supported", NAT_XLAT_NAT64_PREFIX_LEN * 8);
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+	memcpy(ipv6_cfg->nat64_prefix, prefix, NAT_XLAT_NAT64_PREFIX_LEN);
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+parsing_nat_ipv6(char *file_path, struct nat_cfg *app_cfg)
+{
+	struct json_object *parsed_json;
+	doca_error_t result;
+
+	result = parse_json_file(file_path, &parsed_json);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	if (app_cfg->mode == NAT64) {
+		result = create_dynamic_mode_pool(parsed_json, &app_cfg->pool_cfg);
+		if (result == DOCA_SUCCESS)
+			result = create_nat64_mode_prefix(parsed_json, &app_cfg->ipv6_cfg);
+	} else
+		result = create_nptv6_mode_prefixes(parsed_json, &app_cfg->ipv6_cfg);
+	json_object_put(parsed_json);
+	return result;
+}
+
+/*
+ * Entry processing callback
+ *
+ * @entry [in]: DOCA Flow entry
+ * @pipe_queue [in]: queue identifier
+ * @status [in]: DOCA Flow entry status
+ * @op [in]: DOCA Flow entry operation
+ * @user_ctx [out]: user context
+ */
+static void
+check_for_valid_entry(struct doca_flow_pipe_entry *entry, uint16_t pipe_queue,
+		      enum doca_flow_entry_status status, enum doca_flow_entry_op op, void *user_ctx)
+{
+	(void)entry;
+	(void)pipe_queue;
+
+	struct entries_status *entry_status = (struct entries_status *)user_ctx;
+
+	if (entry_status == NULL || (op != DOCA_FLOW_ENTRY_OP_ADD && op != DOCA_FLOW_ENTRY_OP_DEL))
+		return;
+	if (status != DOCA_FLOW_ENTRY_STATUS_SUCCESS) {
+		DOCA_LOG_ERR("Entry processing failed. entry_op=%d", op);
+		entry_status->is_failure = true; /* Set is_failure to true if processing failed */
+	}
+	entry_status->nb_processed++;
+}
+
+/*
+ * Free the global IP and port of a session and remove its entries, the session is released once they are removed
+ *
+ * @lcore [in]: context of the lcore of the session
+ * @pipe_queue [in]: queue of the lcore
+ * @session [in]: session to retire
+ */
+static void
+retire_dynamic_session(struct nat_lcore_ctx *lcore, uint16_t pipe_queue, struct nat_session *session)
+{
+	struct doca_flow_pipe_entry *entries[] = {session->fwd_entry, session->rev_entry};
+	doca_error_t result;
+	size_t i;
+
+	session->flags |= NAT_SESSION_RETIRED;
+	session->fwd_entry = NULL;
+	session->rev_entry = NULL;
+	nat_session_unlink(lcore->pool, session);
+
+	for (i = 0; i < sizeof(entries) / sizeof(entries[0]); i++) {
+		if (entries[i] == NULL)
+			continue;
+		result = doca_flow_pipe_rm_entry(pipe_queue, DOCA_FLOW_NO_WAIT, entries[i]);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to remove dynamic NAT entry: %s", doca_error_get_descr(result));
+			continue;
+		}
+		session->nb_pending++;
+		lcore->nb_pending++;
+	}
+	if (session->nb_pending == 0)
+		nat_session_release(lcore->pool, session);
+}
+
+/*
+ * Entry processing callback of the dynamic mode, the user context of an entry is its session
+ *
+ * @entry [in]: DOCA Flow entry
+ * @pipe_queue [in]: queue identifier
+ * @status [in]: DOCA Flow entry status
+ * @op [in]: DOCA Flow entry operation
+ * @user_ctx [in]: session of the entry, NULL for the entries that are not of a session
+ */
+static void
+check_for_dynamic_entry(struct doca_flow_pipe_entry *entry, uint16_t pipe_queue,
+			enum doca_flow_entry_status status, enum doca_flow_entry_op op, void *user_ctx)
+{
+	struct nat_session *session = (struct nat_session *)user_ctx;
+	struct nat_lcore_ctx *lcore;
+
+	if (session == NULL || pipe_queue >= dynamic_state.nb_queues)
+		return;
+	lcore = &dynamic_state.lcores[pipe_queue];
+
+	switch (op) {
+	case DOCA_FLOW_ENTRY_OP_ADD:
+		session->nb_pending--;
+		lcore->nb_pending--;
+		if (status != DOCA_FLOW_ENTRY_STATUS_SUCCESS) {
+			session->flags |= NAT_SESSION_FAILED;
+			if (entry == session->fwd_entry)
+				session->fwd_entry = NULL;
+			else if (entry == session->rev_entry)
+				session->rev_entry = NULL;
+		}
+		/* Remove the other entry of a failed session once both are done */
+		if ((session->flags & (NAT_SESSION_FAILED | NAT_SESSION_RETIRED)) == NAT_SESSION_FAILED &&
+		    session->nb_pending == 0) {
+			lcore->nb_failed++;
+			retire_dynamic_session(lcore, pipe_queue, session);
+		}
+		break;
+	case DOCA_FLOW_ENTRY_OP_AGED:
+		if (!(session->flags & NAT_SESSION_RETIRED)) {
+			lcore->nb_aged++;
+			retire_dynamic_session(lcore, pipe_queue, session);
+		}
+		break;
+	case DOCA_FLOW_ENTRY_OP_DEL:
+		session->nb_pending--;
+		lcore->nb_pending--;
+		if (session->nb_pending == 0)
+			nat_session_release(lcore->pool, session);
+		break;
+	default:
+		break;
+	}
+}
+
+doca_error_t
+nat_init(struct nat_cfg *app_cfg, struct application_dpdk_config *app_dpdk_config)
+{
+	uint16_t nb_ports;
+	struct doca_flow_cfg nat_flow_cfg = {0};
+	doca_error_t result;
+	int portid;
+
+	/* Initialize doca framework */
+	nat_flow_cfg.queues = app_dpdk_config->port_config.nb_queues;
+	nat_flow_cfg.mode_args = "vnf,hws";
+	nat_flow_cfg.cb = check_for_valid_entry;
+	nat_flow_cfg.queue_depth = QUEUE_DEPTH;
+	if (app_cfg->mode == DYNAMIC) {
+		/* Every session entry from the LAN has a counter for its aging */
+		nat_flow_cfg.cb = check_for_dynamic_entry;
+		nat_flow_cfg.resource.nb_counters = app_cfg->pool_cfg.max_sessions;
+		dynamic_state.nb_queues = app_dpdk_config->port_config.nb_queues;
+		dynamic_state.aging_sec = app_cfg->pool_cfg.aging_sec;
+	} else if (app_cfg->mode == NPTV6 || app_cfg->mode == NAT64) {
+		nat_flow_cfg.cb = nat_ipv6_entry_cb;
+		nat_ipv6_configure(app_cfg->mode == NAT64, &app_cfg->ipv6_cfg, &app_cfg->pool_cfg,
+				   app_dpdk_config->port_config.nb_queues);
+	}
+
+	nb_ports = app_dpdk_config->port_config.nb_ports;
+
+	result = doca_flow_init(&nat_flow_cfg);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to init doca flow ports: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	for (portid = 0; portid < nb_ports; portid++) {
+		/* Create doca flow port */
+		result = nat_port_create(portid, &ports[portid]);
+		if (result != DOCA_SUCCESS) {
+			nat_stop_ports(portid);
+			doca_flow_destroy();
+			return result;
+		}
+		/* Pair ports should be the same as DPDK hairpin binding order */
+		if (!portid || !(portid % 2))
+			continue;
+		result = doca_flow_port_pair(ports[portid], ports[portid ^ 1]);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Pair port %u %u fail", portid, portid ^ 1);
+			nat_stop_ports(portid + 1);
+			doca_flow_destroy();
+			return result;
+		}
+	}
+
+	DOCA_LOG_DBG("Application configuration and rules offload done");
+	return DOCA_SUCCESS;
+}
+
+/*
+ * build pipe for data come from LAN in NAT static mode, its entries are added by nat_rules_load()
+ *
+ * @port_id [in]: port id to build the pipe for
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+build_static_local_pipe(uint16_t port_id)
+{
+	struct doca_flow_match match;
+	struct doca_flow_fwd fwd;
+	struct doca_flow_fwd miss_fwd;
+	struct doca_flow_actions actions, *actions_arr[NB_ACTIONS_ARR];
+	struct doca_flow_pipe_cfg pipe_cfg;
+	doca_error_t result;
+
 	memset(&match, 0, sizeof(match));
 	memset(&actions, 0, sizeof(actions));
 	memset(&fwd, 0, sizeof(fwd));
 	memset(&miss_fwd, 0, sizeof(miss_fwd));
 	memset(&pipe_cfg, 0, sizeof(pipe_cfg));
-	memset(&status, 0, sizeof(status));
 
 	pipe_cfg.attr.name = "NAT_STATIC_PIPE";
 	pipe_cfg.match = &match;
@@ -743,94 +946,36 @@ build_static_local_pipe(uint16_t port_id, struct nat_rule_match *nat_rules, int
 
 	miss_fwd.type = DOCA_FLOW_FWD_DROP;
 
-	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, &nat_pipe);
+	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, &rules_state.lan_pipes[0]);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to create nat pipe: %s", doca_error_get_descr(result));
 		return result;
 	}
-
-	for (ruleid = 0; ruleid < nat_num_rules; ruleid++) {
-		memset(&match, 0, sizeof(match));
-		memset(&actions, 0, sizeof(actions));
-
-		match.outer.ip4.src_ip = nat_rules[ruleid].local_ip;
-		actions.outer.ip4.src_ip = nat_rules[ruleid].global_ip;
-
-		/* Last entry in a batch should be with NO_WAIT flag */
-		if (nb_entries == (QUEUE_DEPTH - 1))
-			flags = DOCA_FLOW_NO_WAIT;
-		else
-			flags = DOCA_FLOW_WAIT_FOR_BATCH;
-
-		result = doca_flow_pipe_add_entry(0, nat_pipe, &match, &actions, NULL, NULL, flags, &status, &entry);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Entry creation FAILED: %s", doca_error_get_descr(result));
-			continue;
-		}
-		nb_entries++;
-
-		/* Process entries to make a space for the next entries */
-		if (nb_entries == QUEUE_DEPTH) {
-			result = doca_flow_entries_process(ports[port_id], 0, DEFAULT_TIMEOUT_US, nb_entries);
-			if (result != DOCA_SUCCESS) {
-				DOCA_LOG_ERR("Failed to process entries");
-				return result;
-			}
-			if (status.is_failure || status.nb_processed == 0) {
-				DOCA_LOG_ERR("Failed to process entries");
-				return DOCA_ERROR_BAD_STATE;
-			}
-			nb_entries -= status.nb_processed;
-			status.nb_processed = 0;
-		}
-	}
-
-	/* Processing pipes entries */
-	while (nb_entries - status.nb_processed > 0) {
-		result = doca_flow_entries_process(ports[port_id], 0, DEFAULT_TIMEOUT_US, nb_entries - status.nb_processed);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Failed to process entries");
-			return result;
-		}
-		if (status.is_failure) {
-			DOCA_LOG_ERR("Failed to process entries");
-			return DOCA_ERROR_BAD_STATE;
-		}
-	}
-
+	rules_state.lan_port_id = port_id;
 	return DOCA_SUCCESS;
 }
 
 /*
- * build pipe for data come from WAN in NAT static mode
+ * build pipe for data come from WAN in NAT static mode, its entries are added by nat_rules_load()
  *
  * @port_id [in]: port id to build the pipe for
- * @nat_rules [in]: rules defintion to configure
- * @nat_num_rules [in]: number of rules to configure
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-build_static_global_pipe(uint16_t port_id, struct nat_rule_match *nat_rules, int nat_num_rules)
+build_static_global_pipe(uint16_t port_id)
 {
 	struct doca_flow_match match;
 	struct doca_flow_fwd fwd;
 	struct doca_flow_fwd miss_fwd;
 	struct doca_flow_actions actions, *actions_arr[NB_ACTIONS_ARR];
 	struct doca_flow_pipe_cfg pipe_cfg;
-	struct doca_flow_pipe *nat_pipe;
-	struct doca_flow_pipe_entry *entry;
-	struct entries_status status;
-	uint32_t flags;
-	uint16_t ruleid;
-	int nb_entries = 0;
 	doca_error_t result;
 
 	memset(&match, 0, sizeof(match));
 	memset(&actions, 0, sizeof(actions));
 	memset(&fwd, 0, sizeof(fwd));
-	memset(&fwd, 0, sizeof(miss_fwd));
+	memset(&miss_fwd, 0, sizeof(miss_fwd));
 	memset(&pipe_cfg, 0, sizeof(pipe_cfg));
-	memset(&status, 0, sizeof(status));
 
 	pipe_cfg.attr.name = "NAT_STATIC_PIPE";
 	pipe_cfg.match = &match;
@@ -852,174 +997,560 @@ build_static_global_pipe(uint16_t port_id, struct nat_rule_match *nat_rules, int
 
 	miss_fwd.type = DOCA_FLOW_FWD_DROP;
 
-	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, &nat_pipe);
+	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, &rules_state.wan_pipes[0]);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to create nat pipe: %s", doca_error_get_descr(result));
 		return result;
 	}
+	rules_state.wan_port_id = port_id;
+	return DOCA_SUCCESS;
+}
 
-	for (ruleid = 0; ruleid < nat_num_rules; ruleid++) {
-		memset(&match, 0, sizeof(match));
-		memset(&actions, 0, sizeof(actions));
+/*
+ * Create control pipe as root pipe
+ *
+ * @port [in]: port to configure the pipe for
+ * @pipe [out]: created control pipe
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+create_control_pipe(struct doca_flow_port *port, struct doca_flow_pipe **pipe)
+{
+	struct doca_flow_pipe_cfg pipe_cfg;
+	doca_error_t result;
 
-		match.outer.ip4.dst_ip = nat_rules[ruleid].global_ip;
-		actions.outer.ip4.dst_ip = nat_rules[ruleid].local_ip;
+	memset(&pipe_cfg, 0, sizeof(pipe_cfg));
 
-		/* Last entry in a batch should be with NO_WAIT flag */
-		if (nb_entries == (QUEUE_DEPTH - 1))
-			flags = DOCA_FLOW_NO_WAIT;
-		else
-			flags = DOCA_FLOW_WAIT_FOR_BATCH;
+	pipe_cfg.attr.name = "CONTROL_PIPE";
+	pipe_cfg.attr.type = DOCA_FLOW_PIPE_CONTROL;
+	pipe_cfg.port = port;
+	pipe_cfg.attr.is_root = true;
 
-		result = doca_flow_pipe_add_entry(0, nat_pipe, &match, &actions, NULL, NULL, flags, &status, &entry);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Entry creation FAILED: %s", doca_error_get_descr(result));
-			continue;
-		}
-		nb_entries++;
-
-		/* Process entries to make a space for the next entries */
-		if (nb_entries == QUEUE_DEPTH) {
-			result = doca_flow_entries_process(ports[port_id], 0, DEFAULT_TIMEOUT_US, nb_entries);
-			if (result != DOCA_SUCCESS) {
-				DOCA_LOG_ERR("Failed to process entries");
-				return result;
-			}
-			if (status.is_failure || status.nb_processed == 0) {
-				DOCA_LOG_ERR("Failed to process entries");
-				return DOCA_ERROR_BAD_STATE;
-			}
-			nb_entries -= status.nb_processed;
-			status.nb_processed = 0;
+	result = doca_flow_pipe_create(&pipe_cfg, NULL, NULL, pipe);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create pipe: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Add the entries to the control pipe. One entry that matches TCP traffic, and one that matches UDP traffic.
+ *
+ *
+ * @control_pipe [in]: control pipe ID
+ * @udp_pipe [in]: UDP pipe to forward UDP traffic to
+ * @tcp_pipe [in]: TCP pipe to forward TCP traffic to
+ * @port [in]: port to configure the pipe for
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+add_control_pipe_entries(struct doca_flow_pipe *control_pipe,  struct doca_flow_pipe *udp_pipe,  struct doca_flow_pipe *tcp_pipe, struct doca_flow_port *port)
+{
+	(void)port;
+
+	struct doca_flow_match match;
+	struct doca_flow_fwd fwd;
+	uint8_t priority = 0;
+	doca_error_t result;
+
+	memset(&match, 0, sizeof(match));
+	memset(&fwd, 0, sizeof(fwd));
+
+	match.parser_meta.outer_l3_type = DOCA_FLOW_L3_META_IPV4;
+	match.parser_meta.outer_l4_type = DOCA_FLOW_L4_META_UDP;
+
+	fwd.type = DOCA_FLOW_FWD_PIPE;
+	fwd.next_pipe = udp_pipe;
+	result = doca_flow_pipe_control_add_entry(0, priority, control_pipe, &match,
+						  NULL, NULL, NULL, NULL, NULL, &fwd, NULL, NULL);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to add control pipe entry: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	match.parser_meta.outer_l3_type = DOCA_FLOW_L3_META_IPV4;
+	match.parser_meta.outer_l4_type = DOCA_FLOW_L4_META_TCP;
+
+	fwd.type = DOCA_FLOW_FWD_PIPE;
+	fwd.next_pipe = tcp_pipe;
+	result = doca_flow_pipe_control_add_entry(0, priority, control_pipe, &match,
+						  NULL, NULL, NULL, NULL, NULL, &fwd, NULL, NULL);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to add control pipe entry: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * build pipes for data come from LAN or from WAN in NAT PAT mode, their entries are added by nat_rules_load()
+ *
+ * @port_id [in]: port id to build the pipes for
+ * @is_lan [in]: true for the LAN port, false for the WAN port
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+build_pat_pipes(uint16_t port_id, bool is_lan)
+{
+	struct doca_flow_match match;
+	struct doca_flow_fwd fwd;
+	struct doca_flow_fwd miss_fwd;
+	struct doca_flow_actions actions, *actions_arr[NB_ACTIONS_ARR];
+	struct doca_flow_pipe_cfg pipe_cfg;
+	struct doca_flow_pipe **nat_pipes = is_lan ? rules_state.lan_pipes : rules_state.wan_pipes;
+	struct doca_flow_pipe *control_pipe;
+	doca_error_t result;
+
+	memset(&match, 0, sizeof(match));
+	memset(&actions, 0, sizeof(actions));
+	memset(&fwd, 0, sizeof(fwd));
+	memset(&miss_fwd, 0, sizeof(miss_fwd));
+	memset(&pipe_cfg, 0, sizeof(pipe_cfg));
+
+	pipe_cfg.attr.name = "NAT_PAT_PIPE";
+	pipe_cfg.match = &match;
+	actions_arr[0] = &actions;
+	pipe_cfg.actions = actions_arr;
+	pipe_cfg.attr.nb_actions = NB_ACTIONS_ARR;
+	pipe_cfg.attr.is_root = false;
+	pipe_cfg.port = ports[port_id];
+
+	/* first - set tcp pipe with outer.l4_type_ext */
+	match.outer.l3_type = DOCA_FLOW_L3_TYPE_IP4;
+	match.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_TCP;
+	actions.outer.l3_type = DOCA_FLOW_L3_TYPE_IP4;
+	actions.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_TCP;
+	if (is_lan) {
+		match.outer.ip4.src_ip = 0xffffffff;
+		match.outer.tcp.l4_port.src_port = 0xffff;
+		actions.outer.ip4.src_ip = 0xffffffff;
+		actions.outer.tcp.l4_port.src_port = 0xffff;
+	} else {
+		match.outer.ip4.dst_ip = 0xffffffff;
+		match.outer.tcp.l4_port.dst_port = 0xffff;
+		actions.outer.ip4.dst_ip = 0xffffffff;
+		actions.outer.tcp.l4_port.dst_port = 0xffff;
+	}
+
+	fwd.type = DOCA_FLOW_FWD_PORT;
+	fwd.port_id = port_id ^ 1;
+
+	miss_fwd.type = DOCA_FLOW_FWD_DROP;
+
+	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, &nat_pipes[NAT_L4_TCP]);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create NAT TCP pipe: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* now - set udp pipe, the udp and tcp ports share the same place in the match */
+	match.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_UDP;
+	actions.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_UDP;
+
+	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, &nat_pipes[NAT_L4_UDP]);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create NAT UDP pipe: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = create_control_pipe(ports[port_id], &control_pipe);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create control pipe: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = add_control_pipe_entries(control_pipe, nat_pipes[NAT_L4_UDP], nat_pipes[NAT_L4_TCP], ports[port_id]);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to add control pipe entries: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	if (is_lan)
+		rules_state.lan_port_id = port_id;
+	else
+		rules_state.wan_port_id = port_id;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Wait until an entry queue has room for one more operation. The completions are collected without waiting while
+ * the queue is not full, so the hardware processes a batch while the next one is prepared.
+ *
+ * @port_id [in]: port of the queue
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+entry_queue_reserve(uint16_t port_id)
+{
+	struct nat_entry_queue *queue = &rules_state.queues[port_id];
+	int nb_processed;
+	doca_error_t result;
+
+	if (queue->stalled)
+		return DOCA_ERROR_BAD_STATE;
+	while (queue->nb_ops - queue->status.nb_processed >= QUEUE_DEPTH) {
+		nb_processed = queue->status.nb_processed;
+		result = doca_flow_entries_process(ports[port_id], 0, DEFAULT_TIMEOUT_US, NAT_RULES_BATCH);
+		if (result != DOCA_SUCCESS || queue->status.nb_processed == nb_processed) {
+			DOCA_LOG_ERR("Failed to process entries");
+			queue->stalled = true;
+			return result != DOCA_SUCCESS ? result : DOCA_ERROR_BAD_STATE;
 		}
 	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Get the flags of the next operation of an entry queue, the last operation of a batch pushes the batch
+ *
+ * @port_id [in]: port of the queue
+ * @return: DOCA Flow entry flags
+ */
+static uint32_t
+entry_queue_flags(uint16_t port_id)
+{
+	/* Last entry in a batch should be with NO_WAIT flag */
+	if (rules_state.queues[port_id].nb_unpushed == NAT_RULES_BATCH - 1)
+		return DOCA_FLOW_NO_WAIT;
+	return DOCA_FLOW_WAIT_FOR_BATCH;
+}
+
+/*
+ * Account an operation submitted to an entry queue
+ *
+ * @port_id [in]: port of the queue
+ * @flags [in]: flags of the operation
+ */
+static void
+entry_queue_submitted(uint16_t port_id, uint32_t flags)
+{
+	struct nat_entry_queue *queue = &rules_state.queues[port_id];
+
+	queue->nb_ops++;
+	if (flags == DOCA_FLOW_WAIT_FOR_BATCH) {
+		queue->nb_unpushed++;
+		return;
+	}
+	queue->nb_unpushed = 0;
+	/* Collect what is already completed, without waiting for the batch that was just pushed */
+	doca_flow_entries_process(ports[port_id], 0, 0, 0);
+}
 
-	/* Processing pipes entries */
-	while (nb_entries - status.nb_processed > 0) {
-		result = doca_flow_entries_process(ports[port_id], 0, DEFAULT_TIMEOUT_US, nb_entries - status.nb_processed);
+/*
+ * Wait for all the operations of an entry queue
+ *
+ * @port_id [in]: port of the queue
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+entry_queue_drain(uint16_t port_id)
+{
+	struct nat_entry_queue *queue = &rules_state.queues[port_id];
+	doca_error_t result;
+
+	while (queue->nb_ops - queue->status.nb_processed > 0) {
+		result = doca_flow_entries_process(ports[port_id], 0, DEFAULT_TIMEOUT_US,
+						   queue->nb_ops - queue->status.nb_processed);
 		if (result != DOCA_SUCCESS) {
 			DOCA_LOG_ERR("Failed to process entries");
 			return result;
 		}
-		if (status.is_failure) {
-			DOCA_LOG_ERR("Failed to process entries");
-			return DOCA_ERROR_BAD_STATE;
+	}
+	queue->nb_unpushed = 0;
+	if (queue->status.is_failure) {
+		DOCA_LOG_ERR("Failed to process entries");
+		return DOCA_ERROR_BAD_STATE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Add an entry of a rule
+ *
+ * @port_id [in]: port of the pipe
+ * @pipe [in]: pipe to add the entry to
+ * @match [in]: match of the entry
+ * @actions [in]: actions of the entry
+ * @entry [out]: the entry, NULL if it could not be added
+ */
+static void
+add_rule_entry(uint16_t port_id, struct doca_flow_pipe *pipe, struct doca_flow_match *match,
+	       struct doca_flow_actions *actions, struct doca_flow_pipe_entry **entry)
+{
+	struct nat_entry_queue *queue = &rules_state.queues[port_id];
+	uint32_t flags;
+	doca_error_t result;
+
+	*entry = NULL;
+	result = entry_queue_reserve(port_id);
+	if (result != DOCA_SUCCESS) {
+		queue->nb_failed++;
+		return;
+	}
+	flags = entry_queue_flags(port_id);
+	result = doca_flow_pipe_add_entry(0, pipe, match, actions, NULL, NULL, flags, &queue->status, entry);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Entry creation FAILED: %s", doca_error_get_descr(result));
+		*entry = NULL;
+		queue->nb_failed++;
+		return;
+	}
+	entry_queue_submitted(port_id, flags);
+}
+
+/*
+ * Remove an entry of a rule
+ *
+ * @port_id [in]: port of the entry
+ * @entry [in/out]: the entry, set to NULL
+ */
+static void
+remove_rule_entry(uint16_t port_id, struct doca_flow_pipe_entry **entry)
+{
+	struct nat_entry_queue *queue = &rules_state.queues[port_id];
+	uint32_t flags;
+	doca_error_t result;
+
+	if (*entry == NULL)
+		return;
+	result = entry_queue_reserve(port_id);
+	if (result != DOCA_SUCCESS) {
+		queue->nb_failed++;
+		return;
+	}
+	flags = entry_queue_flags(port_id);
+	result = doca_flow_pipe_rm_entry(0, flags, *entry);
+	*entry = NULL;
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Entry removal FAILED: %s", doca_error_get_descr(result));
+		queue->nb_failed++;
+		return;
+	}
+	entry_queue_submitted(port_id, flags);
+}
+
+/*
+ * nat_rule_set_foreach_missing() callback - add the entries of a new rule
+ *
+ * @rule [in]: the new rule
+ * @ctx [in]: number of added rules
+ */
+static void
+add_rule_entries(struct nat_rule *rule, void *ctx)
+{
+	struct doca_flow_match match;
+	struct doca_flow_actions actions;
+	int l4_pipe, nb_pipes = rules_state.mode == PAT ? NUM_OF_SUPPORTED_PROTOCOLS : 1;
+
+	for (l4_pipe = 0; l4_pipe < nb_pipes; l4_pipe++) {
+		memset(&match, 0, sizeof(match));
+		memset(&actions, 0, sizeof(actions));
+		match.outer.ip4.src_ip = rule->match.local_ip;
+		actions.outer.ip4.src_ip = rule->match.global_ip;
+		if (rules_state.mode == PAT) {
+			match.outer.transport.src_port = rte_cpu_to_be_16(rule->match.local_port);
+			actions.outer.transport.src_port = rte_cpu_to_be_16(rule->match.global_port);
+		}
+		add_rule_entry(rules_state.lan_port_id, rules_state.lan_pipes[l4_pipe], &match, &actions,
+			       &rule->entries[NAT_RULE_LAN_ENTRY + l4_pipe]);
+
+		memset(&match, 0, sizeof(match));
+		memset(&actions, 0, sizeof(actions));
+		match.outer.ip4.dst_ip = rule->match.global_ip;
+		actions.outer.ip4.dst_ip = rule->match.local_ip;
+		if (rules_state.mode == PAT) {
+			match.outer.transport.dst_port = rte_cpu_to_be_16(rule->match.global_port);
+			actions.outer.transport.dst_port = rte_cpu_to_be_16(rule->match.local_port);
 		}
+		add_rule_entry(rules_state.wan_port_id, rules_state.wan_pipes[l4_pipe], &match, &actions,
+			       &rule->entries[NAT_RULE_WAN_ENTRY + l4_pipe]);
 	}
+	(*(uint32_t *)ctx)++;
+}
 
-	return DOCA_SUCCESS;
+/*
+ * nat_rule_set_foreach_missing() callback - remove the entries of a rule that is no longer in the rules file
+ *
+ * @rule [in]: the removed rule
+ * @ctx [in]: number of removed rules
+ */
+static void
+remove_rule_entries(struct nat_rule *rule, void *ctx)
+{
+	int l4_pipe;
+
+	for (l4_pipe = 0; l4_pipe < NUM_OF_SUPPORTED_PROTOCOLS; l4_pipe++) {
+		remove_rule_entry(rules_state.lan_port_id, &rule->entries[NAT_RULE_LAN_ENTRY + l4_pipe]);
+		remove_rule_entry(rules_state.wan_port_id, &rule->entries[NAT_RULE_WAN_ENTRY + l4_pipe]);
+	}
+	(*(uint32_t *)ctx)++;
+}
+
+/*
+ * nat_rules_stream() callback - append a rule of the rules file to a set
+ *
+ * @rule [in]: the rule
+ * @ctx [in]: rule set
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+append_rule(const struct nat_rule_match *rule, void *ctx)
+{
+	return nat_rule_set_append((struct nat_rule_set *)ctx, rule);
 }
 
 /*
- * Create control pipe as root pipe
+ * Wait for the entry operations of both ports
  *
- * @port [in]: port to configure the pipe for
- * @pipe [out]: created control pipe
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-create_control_pipe(struct doca_flow_port *port, struct doca_flow_pipe **pipe)
+drain_rules_queues(void)
 {
-	struct doca_flow_pipe_cfg pipe_cfg;
-	doca_error_t result;
+	doca_error_t lan_result, wan_result;
 
-	memset(&pipe_cfg, 0, sizeof(pipe_cfg));
+	lan_result = entry_queue_drain(rules_state.lan_port_id);
+	wan_result = entry_queue_drain(rules_state.wan_port_id);
+	return lan_result != DOCA_SUCCESS ? lan_result : wan_result;
+}
 
-	pipe_cfg.attr.name = "CONTROL_PIPE";
-	pipe_cfg.attr.type = DOCA_FLOW_PIPE_CONTROL;
-	pipe_cfg.port = port;
-	pipe_cfg.attr.is_root = true;
+doca_error_t
+nat_rules_load(struct nat_cfg *app_cfg)
+{
+	struct nat_rule_set new_rules = {0};
+	uint32_t nb_added = 0, nb_removed = 0, nb_failed;
+	doca_error_t result, drain_result;
+	int portid;
 
-	result = doca_flow_pipe_create(&pipe_cfg, NULL, NULL, pipe);
+	result = nat_rules_stream(app_cfg->json_path, app_cfg->mode, append_rule, &new_rules);
+	if (result == DOCA_SUCCESS)
+		result = nat_rule_set_sort(&new_rules, app_cfg->mode);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create pipe: %s", doca_error_get_descr(result));
+		nat_rule_set_free(&new_rules);
 		return result;
 	}
 
-	return DOCA_SUCCESS;
+	for (portid = 0; portid < NAT_PORTS_NUM; portid++) {
+		rules_state.queues[portid].status.is_failure = false;
+		rules_state.queues[portid].nb_failed = 0;
+		rules_state.queues[portid].stalled = false;
+	}
+
+	/* The removed rules go first, a changed rule frees its LAN and WAN match before the new rule takes it */
+	nat_rule_set_foreach_missing(&rules_state.rules, &new_rules, remove_rule_entries, &nb_removed);
+	result = drain_rules_queues();
+
+	nat_rule_set_move_entries(&rules_state.rules, &new_rules);
+	nat_rule_set_foreach_missing(&new_rules, &rules_state.rules, add_rule_entries, &nb_added);
+	drain_result = drain_rules_queues();
+	if (result == DOCA_SUCCESS)
+		result = drain_result;
+
+	nat_rule_set_free(&rules_state.rules);
+	rules_state.rules = new_rules;
+
+	nb_failed = rules_state.queues[rules_state.lan_port_id].nb_failed +
+		    rules_state.queues[rules_state.wan_port_id].nb_failed;
+	if (nb_failed > 0 && result == DOCA_SUCCESS)
+		result = DOCA_ERROR_BAD_STATE;
+	DOCA_LOG_INFO("NAT rules loaded: %u rules, %u added, %u removed, %u failed entry operations",
+		      rules_state.rules.nb_rules, nb_added, nb_removed, nb_failed);
+	return result;
 }
 
 /*
- * Add the entries to the control pipe. One entry that matches TCP traffic, and one that matches UDP traffic.
+ * build the pipe that sends the packets of new LAN flows to the software queues in NAT dynamic mode
  *
- *
- * @control_pipe [in]: control pipe ID
- * @udp_pipe [in]: UDP pipe to forward UDP traffic to
- * @tcp_pipe [in]: TCP pipe to forward TCP traffic to
- * @port [in]: port to configure the pipe for
+ * @port_id [in]: port id to build the pipe for
+ * @rss_pipe [out]: created pipe
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-add_control_pipe_entries(struct doca_flow_pipe *control_pipe,  struct doca_flow_pipe *udp_pipe,  struct doca_flow_pipe *tcp_pipe, struct doca_flow_port *port)
+build_dynamic_rss_pipe(uint16_t port_id, struct doca_flow_pipe **rss_pipe)
 {
-	(void)port;
-
 	struct doca_flow_match match;
 	struct doca_flow_fwd fwd;
-	uint8_t priority = 0;
+	struct doca_flow_pipe_cfg pipe_cfg;
+	struct doca_flow_pipe_entry *entry;
+	uint16_t rss_queues[dynamic_state.nb_queues];
+	uint16_t queue;
 	doca_error_t result;
 
 	memset(&match, 0, sizeof(match));
 	memset(&fwd, 0, sizeof(fwd));
+	memset(&pipe_cfg, 0, sizeof(pipe_cfg));
 
-	match.parser_meta.outer_l3_type = DOCA_FLOW_L3_META_IPV4;
-	match.parser_meta.outer_l4_type = DOCA_FLOW_L4_META_UDP;
+	pipe_cfg.attr.name = "NAT_RSS_PIPE";
+	pipe_cfg.match = &match;
+	pipe_cfg.attr.is_root = false;
+	pipe_cfg.port = ports[port_id];
 
-	fwd.type = DOCA_FLOW_FWD_PIPE;
-	fwd.next_pipe = udp_pipe;
-	result = doca_flow_pipe_control_add_entry(0, priority, control_pipe, &match,
-						  NULL, NULL, NULL, NULL, NULL, &fwd, NULL, NULL);
+	for (queue = 0; queue < dynamic_state.nb_queues; queue++)
+		rss_queues[queue] = queue;
+
+	fwd.type = DOCA_FLOW_FWD_RSS;
+	fwd.rss_outer_flags = DOCA_FLOW_RSS_IPV4 | DOCA_FLOW_RSS_TCP | DOCA_FLOW_RSS_UDP;
+	fwd.rss_queues = rss_queues;
+	fwd.num_of_queues = dynamic_state.nb_queues;
+
+	result = doca_flow_pipe_create(&pipe_cfg, &fwd, NULL, rss_pipe);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to add control pipe entry: %s", doca_error_get_descr(result));
+		DOCA_LOG_ERR("Failed to create NAT RSS pipe: %s", doca_error_get_descr(result));
 		return result;
 	}
 
-	match.parser_meta.outer_l3_type = DOCA_FLOW_L3_META_IPV4;
-	match.parser_meta.outer_l4_type = DOCA_FLOW_L4_META_TCP;
-
-	fwd.type = DOCA_FLOW_FWD_PIPE;
-	fwd.next_pipe = tcp_pipe;
-	result = doca_flow_pipe_control_add_entry(0, priority, control_pipe, &match,
-						  NULL, NULL, NULL, NULL, NULL, &fwd, NULL, NULL);
+	result = doca_flow_pipe_add_entry(0, *rss_pipe, &match, NULL, NULL, NULL, DOCA_FLOW_NO_WAIT, NULL, &entry);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to add control pipe entry: %s", doca_error_get_descr(result));
+		DOCA_LOG_ERR("Failed to add NAT RSS pipe entry: %s", doca_error_get_descr(result));
 		return result;
 	}
-
+	result = doca_flow_entries_process(ports[port_id], 0, DEFAULT_TIMEOUT_US, 1);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to process entries");
+		return result;
+	}
+	if (doca_flow_pipe_entry_get_status(entry) != DOCA_FLOW_ENTRY_STATUS_SUCCESS) {
+		DOCA_LOG_ERR("Failed to process entries");
+		return DOCA_ERROR_BAD_STATE;
+	}
 	return DOCA_SUCCESS;
 }
 
 /*
- * build pipe for data come from LAN in NAT PAT mode
+ * build the pipe of the sessions of a L4 protocol in NAT dynamic mode. The LAN pipe matches the 5-tuple of the
+ * sessions and translates their source, the flows it misses go to software. The WAN pipe matches the translated
+ * 5-tuple of the replies and translates their destination back, the flows it misses are dropped.
  *
  * @port_id [in]: port id to build the pipe for
- * @nat_rules [in]: rules defintion to configure
- * @nat_num_rules [in]: number of rules to configure
+ * @is_lan [in]: true for the LAN port, false for the WAN port
+ * @l4_type [in]: L4 protocol of the pipe
+ * @miss_pipe [in]: pipe of the flows the LAN pipe misses, ignored for the WAN port
+ * @nat_pipe [out]: created pipe
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-build_pat_local_pipe(uint16_t port_id, struct nat_rule_match *nat_rules, int nat_num_rules)
+build_dynamic_pipe(uint16_t port_id, bool is_lan, enum doca_flow_l4_type_ext l4_type,
+		   struct doca_flow_pipe *miss_pipe, struct doca_flow_pipe **nat_pipe)
 {
 	struct doca_flow_match match;
 	struct doca_flow_fwd fwd;
 	struct doca_flow_fwd miss_fwd;
 	struct doca_flow_actions actions, *actions_arr[NB_ACTIONS_ARR];
+	struct doca_flow_monitor monitor;
 	struct doca_flow_pipe_cfg pipe_cfg;
-	struct doca_flow_pipe *nat_tcp_pipe, *nat_udp_pipe, *control_pipe;
-	struct entries_status status;
 	doca_error_t result;
-	uint16_t ruleid;
-	uint32_t flags;
-	int nb_entries = 0;
 
 	memset(&match, 0, sizeof(match));
 	memset(&actions, 0, sizeof(actions));
+	memset(&monitor, 0, sizeof(monitor));
 	memset(&fwd, 0, sizeof(fwd));
 	memset(&miss_fwd, 0, sizeof(miss_fwd));
 	memset(&pipe_cfg, 0, sizeof(pipe_cfg));
-	memset(&status, 0, sizeof(status));
 
-	pipe_cfg.attr.name = "NAT_PAT_PIPE";
+	pipe_cfg.attr.name = is_lan ? "NAT_DYNAMIC_LAN_PIPE" : "NAT_DYNAMIC_WAN_PIPE";
 	pipe_cfg.match = &match;
 	actions_arr[0] = &actions;
 	pipe_cfg.actions = actions_arr;
@@ -1027,94 +1558,70 @@ build_pat_local_pipe(uint16_t port_id, struct nat_rule_match *nat_rules, int nat
 	pipe_cfg.attr.is_root = false;
 	pipe_cfg.port = ports[port_id];
 
-	/* first - set tcp pipe with outer.l4_type_ext */
 	match.outer.l3_type = DOCA_FLOW_L3_TYPE_IP4;
 	match.outer.ip4.src_ip = 0xffffffff;
-	match.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_TCP;
-	match.outer.tcp.l4_port.src_port = 0xffff;
+	match.outer.ip4.dst_ip = 0xffffffff;
+	match.outer.l4_type_ext = l4_type;
+	match.outer.transport.src_port = 0xffff;
+	match.outer.transport.dst_port = 0xffff;
 
 	actions.outer.l3_type = DOCA_FLOW_L3_TYPE_IP4;
-	actions.outer.ip4.src_ip = 0xffffffff;
-	actions.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_TCP;
-	actions.outer.tcp.l4_port.src_port = 0xffff;
+	actions.outer.l4_type_ext = l4_type;
 
 	fwd.type = DOCA_FLOW_FWD_PORT;
 	fwd.port_id = port_id ^ 1;
 
-	miss_fwd.type = DOCA_FLOW_FWD_DROP;
-
-	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, &nat_tcp_pipe);
+	if (is_lan) {
+		actions.outer.ip4.src_ip = 0xffffffff;
+		actions.outer.transport.src_port = 0xffff;
+		/* Sessions are aged out by their LAN entry, the mapping is refreshed by outbound traffic */
+		monitor.counter_type = DOCA_FLOW_RESOURCE_TYPE_NON_SHARED;
+		monitor.aging_enabled = true;
+		pipe_cfg.monitor = &monitor;
+		miss_fwd.type = DOCA_FLOW_FWD_PIPE;
+		miss_fwd.next_pipe = miss_pipe;
+	} else {
+		actions.outer.ip4.dst_ip = 0xffffffff;
+		actions.outer.transport.dst_port = 0xffff;
+		miss_fwd.type = DOCA_FLOW_FWD_DROP;
+	}
+
+	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, nat_pipe);
 	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create NAT TCP pipe: %s", doca_error_get_descr(result));
+		DOCA_LOG_ERR("Failed to create NAT dynamic pipe: %s", doca_error_get_descr(result));
 		return result;
 	}
+	return DOCA_SUCCESS;
+}
 
-	/* add udp pipe */
-	match.outer.tcp.l4_port.src_port = 0;
-	match.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_UDP;
-	match.outer.udp.l4_port.src_port = 0xffff;
+/*
+ * build the pipes of a port in NAT dynamic mode, the entries are added by the lcores for every new flow
+ *
+ * @port_id [in]: port id to build the pipes for
+ * @is_lan [in]: true for the LAN port, false for the WAN port
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+build_dynamic_pipes(uint16_t port_id, bool is_lan)
+{
+	struct doca_flow_pipe **nat_pipes = is_lan ? dynamic_state.lan_pipes : dynamic_state.wan_pipes;
+	struct doca_flow_pipe *rss_pipe = NULL, *control_pipe;
+	doca_error_t result;
 
-	actions.outer.tcp.l4_port.src_port = 0;
-	actions.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_UDP;
-	actions.outer.udp.l4_port.src_port = 0xffff;
+	if (is_lan) {
+		result = build_dynamic_rss_pipe(port_id, &rss_pipe);
+		if (result != DOCA_SUCCESS)
+			return result;
+		dynamic_state.lan_port_id = port_id;
+	} else
+		dynamic_state.wan_port_id = port_id;
 
-	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, &nat_udp_pipe);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create NAT UDP pipe: %s", doca_error_get_descr(result));
+	result = build_dynamic_pipe(port_id, is_lan, DOCA_FLOW_L4_TYPE_EXT_TCP, rss_pipe, &nat_pipes[NAT_L4_TCP]);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = build_dynamic_pipe(port_id, is_lan, DOCA_FLOW_L4_TYPE_EXT_UDP, rss_pipe, &nat_pipes[NAT_L4_UDP]);
+	if (result != DOCA_SUCCESS)
 		return result;
-	}
-
-	for (ruleid = 0; ruleid < nat_num_rules; ruleid++) {
-		memset(&match, 0, sizeof(match));
-		memset(&actions, 0, sizeof(actions));
-		match.outer.ip4.src_ip = nat_rules[ruleid].local_ip;
-		match.outer.tcp.l4_port.src_port = rte_cpu_to_be_16(nat_rules[ruleid].local_port);
-		actions.outer.ip4.src_ip = nat_rules[ruleid].global_ip;
-		actions.outer.tcp.l4_port.src_port = rte_cpu_to_be_16(nat_rules[ruleid].global_port);
-
-		/* Last entry in a batch should be with NO_WAIT flag */
-		if (nb_entries == (QUEUE_DEPTH - 2))
-			flags = DOCA_FLOW_NO_WAIT;
-		else
-			flags = DOCA_FLOW_WAIT_FOR_BATCH;
-
-		doca_flow_pipe_add_entry(0, nat_tcp_pipe, &match, &actions, NULL, NULL, DOCA_FLOW_WAIT_FOR_BATCH, &status, NULL);
-
-		match.outer.udp.l4_port.src_port = rte_cpu_to_be_16(nat_rules[ruleid].local_port);
-		actions.outer.udp.l4_port.src_port = rte_cpu_to_be_16(nat_rules[ruleid].global_port);
-
-		doca_flow_pipe_add_entry(0, nat_udp_pipe, &match, &actions, NULL, NULL, flags, &status, NULL);
-
-		nb_entries += 2;
-
-		/* Process entries to make a space for the next entries */
-		if (nb_entries == QUEUE_DEPTH) {
-			result = doca_flow_entries_process(ports[port_id], 0, DEFAULT_TIMEOUT_US, nb_entries);
-			if (result != DOCA_SUCCESS) {
-				DOCA_LOG_ERR("Failed to process entries");
-				return result;
-			}
-			if (status.is_failure || status.nb_processed == 0) {
-				DOCA_LOG_ERR("Failed to process entries");
-				return DOCA_ERROR_BAD_STATE;
-			}
-			nb_entries -= status.nb_processed;
-			status.nb_processed = 0;
-		}
-	}
-
-	/* Processing pipes entries */
-	while (nb_entries - status.nb_processed > 0) {
-		result = doca_flow_entries_process(ports[port_id], 0, DEFAULT_TIMEOUT_US, nb_entries - status.nb_processed);
-		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Failed to process entries");
-			return result;
-		}
-		if (status.is_failure) {
-			DOCA_LOG_ERR("Failed to process entries");
-			return DOCA_ERROR_BAD_STATE;
-		}
-	}
 
 	result = create_control_pipe(ports[port_id], &control_pipe);
 	if (result != DOCA_SUCCESS) {
@@ -1122,159 +1629,317 @@ build_pat_local_pipe(uint16_t port_id, struct nat_rule_match *nat_rules, int nat
 		return result;
 	}
 
-	result = add_control_pipe_entries(control_pipe, nat_udp_pipe, nat_tcp_pipe, ports[port_id]);
+	result = add_control_pipe_entries(control_pipe, nat_pipes[NAT_L4_UDP], nat_pipes[NAT_L4_TCP], ports[port_id]);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to add control pipe entries: %s", doca_error_get_descr(result));
 		return result;
 	}
-
 	return DOCA_SUCCESS;
 }
 
 /*
- * build pipe for data come from WAN in NAT PAT mode
+ * Create the global IP/port pools of the lcores in NAT dynamic mode
  *
- * @port_id [in]: port id to build the pipe for
- * @nat_rules [in]: rules defintion to configure
- * @nat_num_rules [in]: number of rules to configure
+ * @pool_cfg [in]: global address pool configuration
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 static doca_error_t
-build_pat_global_pipe(uint16_t port_id, struct nat_rule_match *nat_rules, int nat_num_rules)
+init_dynamic_pools(const struct nat_pool_cfg *pool_cfg)
 {
-	struct doca_flow_match match;
-	struct doca_flow_fwd fwd;
-	struct doca_flow_fwd miss_fwd;
-	struct doca_flow_actions actions, *actions_arr[NB_ACTIONS_ARR];
-	struct doca_flow_pipe_cfg pipe_cfg;
-	struct doca_flow_pipe *nat_tcp_pipe, *nat_udp_pipe, *control_pipe;
-	struct entries_status status;
 	doca_error_t result;
-	uint16_t ruleid;
-	uint32_t flags;
-	int nb_entries = 0;
-
-	memset(&match, 0, sizeof(match));
-	memset(&actions, 0, sizeof(actions));
-	memset(&fwd, 0, sizeof(fwd));
-	memset(&fwd, 0, sizeof(miss_fwd));
-	memset(&pipe_cfg, 0, sizeof(pipe_cfg));
-	memset(&status, 0, sizeof(status));
-
-	pipe_cfg.attr.name = "NAT_PAT_PIPE";
-	pipe_cfg.match = &match;
-	actions_arr[0] = &actions;
-	pipe_cfg.actions = actions_arr;
-	pipe_cfg.attr.nb_actions = NB_ACTIONS_ARR;
-	pipe_cfg.attr.is_root = false;
-	pipe_cfg.port = ports[port_id];
+	uint16_t queue;
 
-	match.outer.ip4.dst_ip = 0xffffffff;
-	match.outer.l3_type = DOCA_FLOW_L3_TYPE_IP4;
-	match.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_TCP;
-	match.outer.tcp.l4_port.dst_port = 0xffff;
+	dynamic_state.lcores = rte_zmalloc(NULL, dynamic_state.nb_queues * sizeof(*dynamic_state.lcores),
+					   RTE_CACHE_LINE_SIZE);
+	if (dynamic_state.lcores == NULL) {
+		DOCA_LOG_ERR("Failed to allocate the lcores context");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	for (queue = 0; queue < dynamic_state.nb_queues; queue++) {
+		result = nat_pool_create(pool_cfg, queue, dynamic_state.nb_queues, &dynamic_state.lcores[queue].pool);
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+	return DOCA_SUCCESS;
+}
 
-	actions.outer.l3_type = DOCA_FLOW_L3_TYPE_IP4;
-	actions.outer.ip4.dst_ip = 0xffffffff;
-	actions.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_TCP;
-	actions.outer.tcp.l4_port.dst_port = 0xffff;
+/*
+ * Parse the flow of a packet received from the LAN
+ *
+ * @mbuf [in]: packet
+ * @key [out]: flow of the packet
+ * @ipv4_hdr [out]: IPv4 header of the packet
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_NOT_SUPPORTED for a packet that is not translated
+ */
+static doca_error_t
+parse_dynamic_packet(struct rte_mbuf *mbuf, struct nat_session_key *key, struct rte_ipv4_hdr **ipv4_hdr)
+{
+	struct rte_ether_hdr *eth_hdr = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+	struct rte_ipv4_hdr *ip_hdr = (struct rte_ipv4_hdr *)(eth_hdr + 1);
+	uint32_t ip_hdr_len, l4_hdr_len;
+	uint16_t *l4_ports;
+
+	if (rte_pktmbuf_data_len(mbuf) < sizeof(*eth_hdr) + sizeof(*ip_hdr) ||
+	    eth_hdr->ether_type != RTE_BE16(RTE_ETHER_TYPE_IPV4))
+		return DOCA_ERROR_NOT_SUPPORTED;
+
+	/* Only the first fragment has the L4 ports */
+	if (ip_hdr->fragment_offset & RTE_BE16(RTE_IPV4_HDR_OFFSET_MASK))
+		return DOCA_ERROR_NOT_SUPPORTED;
+	if (ip_hdr->next_proto_id == IPPROTO_TCP)
+		l4_hdr_len = sizeof(struct rte_tcp_hdr);
+	else if (ip_hdr->next_proto_id == IPPROTO_UDP)
+		l4_hdr_len = sizeof(struct rte_udp_hdr);
+	else
+		return DOCA_ERROR_NOT_SUPPORTED;
+	ip_hdr_len = (ip_hdr->version_ihl & RTE_IPV4_HDR_IHL_MASK) * RTE_IPV4_IHL_MULTIPLIER;
+	if (rte_pktmbuf_data_len(mbuf) < sizeof(*eth_hdr) + ip_hdr_len + l4_hdr_len)
+		return DOCA_ERROR_NOT_SUPPORTED;
+
+	l4_ports = (uint16_t *)((uint8_t *)ip_hdr + ip_hdr_len);
+	memset(key, 0, sizeof(*key));
+	key->local_ip[0] = ip_hdr->src_addr;
+	key->remote_ip = ip_hdr->dst_addr;
+	key->local_port = l4_ports[0];
+	key->remote_port = l4_ports[1];
+	key->proto = ip_hdr->next_proto_id;
+	*ipv4_hdr = ip_hdr;
+	return DOCA_SUCCESS;
+}
 
-	fwd.type = DOCA_FLOW_FWD_PORT;
-	fwd.port_id = port_id ^ 1;
+/*
+ * Update an internet checksum for a replaced 32 bits value (RFC 1624)
+ *
+ * @csum [in]: checksum to update
+ * @old_value [in]: replaced value
+ * @new_value [in]: new value
+ * @return: updated checksum
+ */
+static inline uint16_t
+update_checksum(uint16_t csum, uint32_t old_value, uint32_t new_value)
+{
+	uint32_t sum = (uint16_t)~csum;
 
-	miss_fwd.type = DOCA_FLOW_FWD_DROP;
+	sum += (uint16_t)~(old_value >> 16) + (uint16_t)~old_value;
+	sum += (new_value >> 16) + (new_value & 0xffff);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)~sum;
+}
 
-	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, &nat_tcp_pipe);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create NAT TCP pipe: %s", doca_error_get_descr(result));
-		return result;
+/*
+ * Translate the source of a LAN packet to the global IP and port of its session
+ *
+ * @ip_hdr [in]: IPv4 header of the packet
+ * @session [in]: session of the packet
+ */
+static void
+translate_dynamic_packet(struct rte_ipv4_hdr *ip_hdr, const struct nat_session *session)
+{
+	uint8_t *l4_hdr = (uint8_t *)ip_hdr + (ip_hdr->version_ihl & RTE_IPV4_HDR_IHL_MASK) * RTE_IPV4_IHL_MULTIPLIER;
+	struct rte_tcp_hdr *tcp_hdr;
+	struct rte_udp_hdr *udp_hdr;
+	uint16_t csum;
+
+	if (ip_hdr->next_proto_id == IPPROTO_TCP) {
+		tcp_hdr = (struct rte_tcp_hdr *)l4_hdr;
+		csum = update_checksum(tcp_hdr->cksum, ip_hdr->src_addr, session->global_ip);
+		tcp_hdr->cksum = update_checksum(csum, tcp_hdr->src_port, session->global_port);
+		tcp_hdr->src_port = session->global_port;
+	} else {
+		udp_hdr = (struct rte_udp_hdr *)l4_hdr;
+		/* A zero UDP checksum is not computed and stays zero */
+		if (udp_hdr->dgram_cksum != 0) {
+			csum = update_checksum(udp_hdr->dgram_cksum, ip_hdr->src_addr, session->global_ip);
+			csum = update_checksum(csum, udp_hdr->src_port, session->global_port);
+			udp_hdr->dgram_cksum = csum == 0 ? 0xffff : csum;
+		}
+		udp_hdr->src_port = session->global_port;
 	}
+	ip_hdr->hdr_checksum = update_checksum(ip_hdr->hdr_checksum, ip_hdr->src_addr, session->global_ip);
+	ip_hdr->src_addr = session->global_ip;
+}
 
-	/* now - set udp pipe */
-	match.outer.tcp.l4_port.dst_port = 0;
-	match.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_UDP;
-	match.outer.udp.l4_port.dst_port = 0xffff;
-
-	actions.outer.tcp.l4_port.dst_port = 0;
-	actions.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_UDP;
-	actions.outer.udp.l4_port.dst_port = 0xffff;
+/*
+ * Add the LAN to WAN and WAN to LAN entries of new sessions, as one batch per port
+ *
+ * @lcore [in]: context of the lcore
+ * @pipe_queue [in]: queue of the lcore
+ * @sessions [in]: new sessions
+ * @nb_sessions [in]: number of new sessions
+ */
+static void
+add_dynamic_entries(struct nat_lcore_ctx *lcore, uint16_t pipe_queue, struct nat_session **sessions,
+		    int nb_sessions)
+{
+	struct doca_flow_match match;
+	struct doca_flow_actions actions;
+	struct doca_flow_monitor monitor;
+	struct nat_session *session;
+	enum nat_l4_pipe l4_pipe;
+	uint32_t flags;
+	doca_error_t result;
+	int i;
 
-	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, &nat_udp_pipe);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create NAT UDP pipe: %s", doca_error_get_descr(result));
-		return result;
-	}
+	memset(&monitor, 0, sizeof(monitor));
+	monitor.counter_type = DOCA_FLOW_RESOURCE_TYPE_NON_SHARED;
+	monitor.aging_enabled = true;
+	monitor.aging_sec = dynamic_state.aging_sec;
 
-	for (ruleid = 0; ruleid < nat_num_rules; ruleid++) {
+	for (i = 0; i < nb_sessions; i++) {
+		session = sessions[i];
+		l4_pipe = session->key.proto == IPPROTO_TCP ? NAT_L4_TCP : NAT_L4_UDP;
 		memset(&match, 0, sizeof(match));
 		memset(&actions, 0, sizeof(actions));
-
-		match.outer.ip4.dst_ip = nat_rules[ruleid].global_ip;
-		match.outer.tcp.l4_port.dst_port = rte_cpu_to_be_16(nat_rules[ruleid].global_port);
-		actions.outer.ip4.dst_ip = nat_rules[ruleid].local_ip;
-		actions.outer.tcp.l4_port.dst_port = rte_cpu_to_be_16(nat_rules[ruleid].local_port);
+		match.outer.ip4.src_ip = session->key.local_ip[0];
+		match.outer.ip4.dst_ip = session->key.remote_ip;
+		match.outer.transport.src_port = session->key.local_port;
+		match.outer.transport.dst_port = session->key.remote_port;
+		actions.outer.ip4.src_ip = session->global_ip;
+		actions.outer.transport.src_port = session->global_port;
 
 		/* Last entry in a batch should be with NO_WAIT flag */
-		if (nb_entries == (QUEUE_DEPTH - 2))
-			flags = DOCA_FLOW_NO_WAIT;
-		else
-			flags = DOCA_FLOW_WAIT_FOR_BATCH;
-
-		doca_flow_pipe_add_entry(0, nat_tcp_pipe, &match, &actions, NULL, NULL, DOCA_FLOW_WAIT_FOR_BATCH, &status, NULL);
-		/* add the same entry also to UDP pipe */
-
-		match.outer.udp.l4_port.dst_port = rte_cpu_to_be_16(nat_rules[ruleid].local_port);
-		actions.outer.udp.l4_port.dst_port = rte_cpu_to_be_16(nat_rules[ruleid].global_port);
-
-		doca_flow_pipe_add_entry(0, nat_udp_pipe, &match, &actions, NULL, NULL, flags, &status, NULL);
-		nb_entries += 2;
-
-		/* Process entries to make a space for the next entries */
-		if (nb_entries == QUEUE_DEPTH) {
-			result = doca_flow_entries_process(ports[port_id], 0, DEFAULT_TIMEOUT_US, nb_entries);
-			if (result != DOCA_SUCCESS) {
-				DOCA_LOG_ERR("Failed to process entries");
-				return result;
-			}
-			if (status.is_failure || status.nb_processed == 0) {
-				DOCA_LOG_ERR("Failed to process entries");
-				return DOCA_ERROR_BAD_STATE;
-			}
-			nb_entries -= status.nb_processed;
-			status.nb_processed = 0;
+		flags = i == nb_sessions - 1 ? DOCA_FLOW_NO_WAIT : DOCA_FLOW_WAIT_FOR_BATCH;
+		result = doca_flow_pipe_add_entry(pipe_queue, dynamic_state.lan_pipes[l4_pipe], &match, &actions,
+						  &monitor, NULL, flags, session, &session->fwd_entry);
+		if (result != DOCA_SUCCESS) {
+			session->fwd_entry = NULL;
+			session->flags |= NAT_SESSION_FAILED;
+			continue;
 		}
+		session->nb_pending++;
+		lcore->nb_pending++;
 	}
 
-	/* Processing pipes entries */
-	while (nb_entries - status.nb_processed > 0) {
-		result = doca_flow_entries_process(ports[port_id], 0, DEFAULT_TIMEOUT_US, nb_entries - status.nb_processed);
+	for (i = 0; i < nb_sessions; i++) {
+		session = sessions[i];
+		l4_pipe = session->key.proto == IPPROTO_TCP ? NAT_L4_TCP : NAT_L4_UDP;
+		memset(&match, 0, sizeof(match));
+		memset(&actions, 0, sizeof(actions));
+		match.outer.ip4.src_ip = session->key.remote_ip;
+		match.outer.ip4.dst_ip = session->global_ip;
+		match.outer.transport.src_port = session->key.remote_port;
+		match.outer.transport.dst_port = session->global_port;
+		actions.outer.ip4.dst_ip = session->key.local_ip[0];
+		actions.outer.transport.dst_port = session->key.local_port;
+
+		flags = i == nb_sessions - 1 ? DOCA_FLOW_NO_WAIT : DOCA_FLOW_WAIT_FOR_BATCH;
+		result = doca_flow_pipe_add_entry(pipe_queue, dynamic_state.wan_pipes[l4_pipe], &match, &actions, NULL,
+						  NULL, flags, session, &session->rev_entry);
 		if (result != DOCA_SUCCESS) {
-			DOCA_LOG_ERR("Failed to process entries");
-			return result;
+			session->rev_entry = NULL;
+			session->flags |= NAT_SESSION_FAILED;
+			continue;
 		}
-		if (status.is_failure) {
-			DOCA_LOG_ERR("Failed to process entries");
-			return DOCA_ERROR_BAD_STATE;
+		session->nb_pending++;
+		lcore->nb_pending++;
+	}
+
+	/* Sessions with a failed entry and no pending one are removed now, the others on their completion */
+	for (i = 0; i < nb_sessions; i++) {
+		session = sessions[i];
+		if ((session->flags & NAT_SESSION_FAILED) && session->nb_pending == 0) {
+			lcore->nb_failed++;
+			retire_dynamic_session(lcore, pipe_queue, session);
 		}
 	}
+}
 
-	result = create_control_pipe(ports[port_id], &control_pipe);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to create control pipe: %s", doca_error_get_descr(result));
-		return result;
+/*
+ * Handle a burst of LAN packets that missed the session entries: find or create their sessions, add the entries of
+ * the new sessions and translate the packets in software
+ *
+ * @lcore [in]: context of the lcore
+ * @pipe_queue [in]: queue of the lcore
+ * @mbufs [in/out]: received packets, replaced by the packets to send to the WAN
+ * @nb_pkts [in]: number of received packets
+ * @return: number of packets to send to the WAN
+ */
+static uint16_t
+handle_dynamic_burst(struct nat_lcore_ctx *lcore, uint16_t pipe_queue, struct rte_mbuf **mbufs, uint16_t nb_pkts)
+{
+	struct nat_session *new_sessions[NAT_RX_BURST_SIZE];
+	struct nat_session_key key;
+	struct nat_session *session;
+	struct rte_ipv4_hdr *ip_hdr;
+	uint16_t i, nb_tx = 0;
+	int nb_new = 0;
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (parse_dynamic_packet(mbufs[i], &key, &ip_hdr) != DOCA_SUCCESS) {
+			rte_pktmbuf_free(mbufs[i]);
+			continue;
+		}
+		/* Packets of a new session can reach software until its entries are added */
+		session = nat_session_lookup(lcore->pool, &key);
+		if (session == NULL) {
+			if (nat_session_create(lcore->pool, &key, &session) != DOCA_SUCCESS) {
+				lcore->nb_exhausted++;
+				rte_pktmbuf_free(mbufs[i]);
+				continue;
+			}
+			lcore->nb_created++;
+			new_sessions[nb_new++] = session;
+		}
+		translate_dynamic_packet(ip_hdr, session);
+		mbufs[nb_tx++] = mbufs[i];
 	}
 
-	result = add_control_pipe_entries(control_pipe, nat_udp_pipe, nat_tcp_pipe, ports[port_id]);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Failed to add control pipe entries: %s", doca_error_get_descr(result));
-		return result;
+	if (nb_new > 0)
+		add_dynamic_entries(lcore, pipe_queue, new_sessions, nb_new);
+	lcore->nb_sw_pkts += nb_tx;
+	return nb_tx;
+}
+
+int
+nat_dynamic_process_pkts(void *arg)
+{
+	(void)arg;
+
+	struct rte_mbuf *mbufs[NAT_RX_BURST_SIZE];
+	struct nat_lcore_ctx *lcore;
+	int lcore_index = rte_lcore_index(rte_lcore_id());
+	uint64_t aging_period = rte_get_timer_hz() / NAT_AGING_PER_SEC, next_aging;
+	uint16_t pipe_queue, nb_rx, nb_tx, nb_sent;
+
+	if (lcore_index < 0 || lcore_index >= dynamic_state.nb_queues || dynamic_state.lcores == NULL) {
+		DOCA_LOG_DBG("Core %u nothing need to do", rte_lcore_id());
+		return 0;
+	}
+	pipe_queue = lcore_index;
+	lcore = &dynamic_state.lcores[pipe_queue];
+	next_aging = rte_get_timer_cycles() + aging_period;
+
+	while (!dynamic_state.force_quit) {
+		nb_rx = rte_eth_rx_burst(dynamic_state.lan_port_id, pipe_queue, mbufs, NAT_RX_BURST_SIZE);
+		if (nb_rx > 0) {
+			nb_tx = handle_dynamic_burst(lcore, pipe_queue, mbufs, nb_rx);
+			nb_sent = rte_eth_tx_burst(dynamic_state.wan_port_id, pipe_queue, mbufs, nb_tx);
+			while (nb_sent < nb_tx)
+				rte_pktmbuf_free(mbufs[nb_sent++]);
+		}
+
+		if (lcore->nb_pending > 0) {
+			doca_flow_entries_process(ports[dynamic_state.lan_port_id], pipe_queue, 0, 0);
+			doca_flow_entries_process(ports[dynamic_state.wan_port_id], pipe_queue, 0, 0);
+		}
+
+		if (rte_get_timer_cycles() >= next_aging) {
+			doca_flow_aging_handle(ports[dynamic_state.lan_port_id], pipe_queue, NAT_AGING_QUOTA_US, 0);
+			next_aging = rte_get_timer_cycles() + aging_period;
+		}
 	}
+	return 0;
+}
 
-	return DOCA_SUCCESS;
+void
+nat_dynamic_stop(void)
+{
+	dynamic_state.force_quit = true;
 }
 
 doca_error_t
-nat_pipes_init(struct nat_rule_match *nat_rules, int nat_num_rules, struct nat_cfg *app_cfg, int nb_ports)
+nat_pipes_init(struct nat_cfg *app_cfg, int nb_ports)
 {
 
 	uint16_t portid;
@@ -1284,6 +1949,7 @@ nat_pipes_init(struct nat_rule_match *nat_rules, int nat_num_rules, struct nat_c
 	char wan_port_intf_name[MAX_PORT_NAME] = {0};
 	doca_error_t result;
 
+	rules_state.mode = app_cfg->mode;
 	for (portid = 0; portid < nb_ports; portid++) {
 		ret = rte_eth_dev_info_get(portid, &dev_info);
 		if (ret < 0) {
@@ -1296,12 +1962,12 @@ nat_pipes_init(struct nat_rule_match *nat_rules, int nat_num_rules, struct nat_c
 		case STATIC:
 			if (dev_info.switch_info.name != NULL &&
 				strstr(dev_info.switch_info.name, lan_port_intf_name) != 0) {
-				result = build_static_local_pipe(portid, nat_rules, nat_num_rules);
+				result = build_static_local_pipe(portid);
 				if (result != DOCA_SUCCESS)
 					return result;
 			} else if (dev_info.switch_info.name != NULL &&
 				strstr(dev_info.switch_info.name, wan_port_intf_name) != 0) {
-				result = build_static_global_pipe(portid, nat_rules, nat_num_rules);
+				result = build_static_global_pipe(portid);
 				if (result != DOCA_SUCCESS)
 					return result;
 			} else {
@@ -1310,16 +1976,47 @@ nat_pipes_init(struct nat_rule_match *nat_rules, int nat_num_rules, struct nat_c
 			}
 			break;
 		case DYNAMIC:
+			if (dev_info.switch_info.name != NULL &&
+				strstr(dev_info.switch_info.name, lan_port_intf_name) != 0) {
+				result = build_dynamic_pipes(portid, true);
+				if (result != DOCA_SUCCESS)
+					return result;
+			} else if (dev_info.switch_info.name != NULL &&
+				strstr(dev_info.switch_info.name, wan_port_intf_name) != 0) {
+				result = build_dynamic_pipes(portid, false);
+				if (result != DOCA_SUCCESS)
+					return result;
+			} else {
+				DOCA_LOG_ERR("Getting interface index (%d) which isn't match to any configured port: %s", portid, strerror(-ret));
+				return DOCA_ERROR_INVALID_VALUE;
+			}
 			break;
 		case PAT:
 			if (dev_info.switch_info.name != NULL &&
 				strstr(dev_info.switch_info.name, lan_port_intf_name) != 0) {
-				result = build_pat_local_pipe(portid, nat_rules, nat_num_rules);
+				result = build_pat_pipes(portid, true);
+				if (result != DOCA_SUCCESS)
+					return result;
+			} else if (dev_info.switch_info.name != NULL &&
+				strstr(dev_info.switch_info.name, wan_port_intf_name) != 0) {
+				result = build_pat_pipes(portid, false);
+				if (result != DOCA_SUCCESS)
+					return result;
+			} else {
+				DOCA_LOG_ERR("Getting interface index (%d) which isn't match to any configured port: %s", portid, strerror(-ret));
+				return DOCA_ERROR_INVALID_VALUE;
+			}
+			break;
+		case NPTV6:
+		case NAT64:
+			if (dev_info.switch_info.name != NULL &&
+				strstr(dev_info.switch_info.name, lan_port_intf_name) != 0) {
+				result = nat_ipv6_build_pipes(ports[portid], portid, true);
 				if (result != DOCA_SUCCESS)
 					return result;
 			} else if (dev_info.switch_info.name != NULL &&
 				strstr(dev_info.switch_info.name, wan_port_intf_name) != 0) {
-				result = build_pat_global_pipe(portid, nat_rules, nat_num_rules);
+				result = nat_ipv6_build_pipes(ports[portid], portid, false);
 				if (result != DOCA_SUCCESS)
 					return result;
 			} else {
@@ -1331,5 +2028,9 @@ nat_pipes_init(struct nat_rule_match *nat_rules, int nat_num_rules, struct nat_c
 			break;
 		}
 	}
+	if (app_cfg->mode == DYNAMIC)
+		return init_dynamic_pools(&app_cfg->pool_cfg);
+	if (app_cfg->mode == NPTV6 || app_cfg->mode == NAT64)
+		return nat_ipv6_init_lcores();
 	return DOCA_SUCCESS;
 }
@@ -17,6 +17,9 @@
 #include <doca_flow.h>
 #include "flow_parser.h"
 
+#include "nat_ipv6.h"
+#include "nat_pool.h"
+
 #include <dpdk_utils.h>
 #include <utils.h>
 
@@ -29,9 +32,11 @@ extern "C" {
 
 enum nat_mode {
 	STATIC = 0,		/* assign global ip address to each local ip address */
-	DYNAMIC = 1,		/* assign global ip address from address pool for each new local ip address */
+	DYNAMIC = 1,		/* assign global ip address and port from address pool for each new local flow */
 	PAT = 2,		/* assign global port to local port - use the same global address to all local addresses */
-	NAT_INVALID_MODE = 3,
+	NPTV6 = 3,		/* translate an IPv6 internal prefix to an external prefix of the same length */
+	NAT64 = 4,		/* translate IPv6 local flows to IPv4 with a global ip address and port from an address pool */
+	NAT_INVALID_MODE = 5,
 };
 
 
@@ -41,6 +46,8 @@ struct nat_cfg {
 	int wan_intf_id;				/* wan interface id */
 	char json_path[MAX_FILE_NAME];			/* Path to the JSON file with NAT rules */
 	bool has_json;					/* true when a json file path was given */
+	struct nat_pool_cfg pool_cfg;			/* Global address pool of the dynamic and NAT64 modes */
+	struct nat_ipv6_cfg ipv6_cfg;			/* Prefixes of the NPTV6 and NAT64 modes */
 };
 
 struct nat_rule_match {
@@ -77,40 +84,68 @@ doca_error_t nat_init(struct nat_cfg *app_cfg, struct application_dpdk_config *a
 doca_error_t register_nat_params(void);
 
 /*
- * Parse and create nat rules from json
+ * Parse the global address pool of the dynamic mode from json
  *
  * @file_path [in]: json configuration file path
- * @mode [in]: nat mode
- * @n_rules [out]: number of rules
- * @nat_rules [out]: array of rules
+ * @pool_cfg [out]: global address pool configuration
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t parsing_nat_pool(char *file_path, struct nat_pool_cfg *pool_cfg);
+
+/*
+ * Parse the configuration of the NPTV6 or NAT64 mode from json
  *
- * @NOTE: In case of failure, all already allocated resource are freed
+ * @file_path [in]: json configuration file path
+ * @app_cfg [in/out]: app configuration values, the mode selects the parsed values
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
-doca_error_t parsing_nat_rules(char *file_path, enum nat_mode mode, int *n_rules, struct nat_rule_match **nat_rules);
+doca_error_t parsing_nat_ipv6(char *file_path, struct nat_cfg *app_cfg);
 
 /*
- * Create nat pipes
+ * Create nat pipes, the rules of the static and PAT modes are added by nat_rules_load()
  *
- * @nat_rules [in]: nat rules array
- * @nat_num_rules [in]: number of rules
  * @app_cfg [in]: app configureation values
  * @nb_ports [in]: number of ports
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  *
  * @NOTE: In case of failure, all already allocated resource are freed
  */
-doca_error_t nat_pipes_init(struct nat_rule_match *nat_rules, int nat_num_rules, struct nat_cfg *app_cfg, int nb_ports);
+doca_error_t nat_pipes_init(struct nat_cfg *app_cfg, int nb_ports);
+
+/*
+ * Read the rules file of the static or PAT mode and update the pipes: the rules that are no longer in the file are
+ * removed and the new rules are added, the other rules stay in place. The first call adds all the rules.
+ *
+ * @app_cfg [in]: app configuration values
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ *
+ * @NOTE: A rules file that fails to parse leaves the installed rules unchanged
+ */
+doca_error_t nat_rules_load(struct nat_cfg *app_cfg);
 
 /*
  * Destroy doca ports and flow
  *
  * @nb_ports [in]: number of ports
- * @nat_rules [in]: nat rules array
  *
  * @NOTE: In case of failure, all already allocated resource are freed
  */
-void nat_destroy(int nb_ports, struct nat_rule_match *nat_rules);
+void nat_destroy(int nb_ports);
+
+/*
+ * Dynamic mode lcore main loop: receive the packets of new LAN flows, allocate their global IP and port, install their
+ * entries and forward the packets translated in software until the entries are in place. Every lcore uses the queue of
+ * its lcore index, the entries of the sessions are aged out and their global IP and port recycled.
+ *
+ * @arg [in]: unused
+ * @return: 0 on success
+ */
+int nat_dynamic_process_pkts(void *arg);
+
+/*
+ * Stop the dynamic mode lcores main loop
+ */
+void nat_dynamic_stop(void);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -0,0 +1,951 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <string.h>
+
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+
+#include <doca_log.h>
+
+#include "nat_ipv6.h"
+
+DOCA_LOG_REGISTER(NAT_IPV6);
+
+#define NAT_IPV6_RX_BURST_SIZE 32	/* Packets received at once from a port */
+#define NAT_IPV6_TIMEOUT_US (10000)	/* Timeout for processing the entries added while the pipes are built */
+#define NAT_IPV6_AGING_PER_SEC 10	/* NAT64 aging sweeps per second of an lcore */
+#define NAT_IPV6_SUBNET_WORDS 2		/* 32 bits words of a /64 subnet */
+#define NAT_IPV6_SRC_OFFSET 8		/* Offset of the source address in the IPv6 header */
+#define NAT_IPV6_DST_OFFSET 24		/* Offset of the destination address in the IPv6 header */
+#define NAT64_SESSION_ACTIVE (1 << 0)	/* The session is in use */
+#define NAT64_SESSION_FAILED (1 << 1)	/* The WAN entry of the session failed */
+#define NAT64_SESSION_RETIRED (1 << 2)	/* The session is being removed */
+
+enum nat64_l4_pipe {
+	NAT64_L4_TCP = 0,	/* Pipe of the TCP sessions */
+	NAT64_L4_UDP = 1,	/* Pipe of the UDP sessions */
+	NAT64_L4_ICMP = 2,	/* Pipe of the ICMP echo sessions */
+	NAT64_L4_NUM = 3,	/* Number of session pipes */
+};
+
+/* Context of an lcore, only accessed by its lcore */
+struct nat_ipv6_lcore_ctx {
+	struct nat_pool *pool;		/* NAT64 global IPs/ports and sessions of the lcore */
+	uint32_t nb_pending;		/* Entry operations not completed yet */
+	uint32_t aging_cursor;		/* Next session checked by the NAT64 aging sweep */
+	uint16_t ip_id;			/* Next IPv4 identification of the NAT64 packets */
+	uint64_t nb_subnets;		/* NPTv6 subnets whose entries were added by the lcore */
+	uint64_t nb_created;		/* Created NAT64 sessions */
+	uint64_t nb_aged;		/* Aged out NAT64 sessions */
+	uint64_t nb_failed;		/* Entries that failed */
+	uint64_t nb_exhausted;		/* New NAT64 flows dropped on an empty pool */
+	uint64_t nb_sw_pkts;		/* Packets translated in software */
+	uint64_t nb_dropped;		/* Packets that could not be translated */
+} __rte_cache_aligned;
+
+/* NPTV6 and NAT64 modes state */
+struct nat_ipv6_state {
+	bool is_nat64;					/* NAT64 mode, NPTV6 mode otherwise */
+	struct nat_ipv6_cfg cfg;			/* Mode configuration */
+	const struct nat_pool_cfg *pool_cfg;		/* NAT64 global address pool */
+	uint16_t nb_queues;				/* Number of queues, one per lcore */
+	uint16_t lan_port_id;				/* Port of the LAN */
+	uint16_t wan_port_id;				/* Port of the WAN */
+	struct doca_flow_port *lan_port;		/* DOCA Flow port of the LAN */
+	struct doca_flow_port *wan_port;		/* DOCA Flow port of the WAN */
+	struct doca_flow_pipe *lan_pipe;		/* NPTv6 pipe of the LAN subnets */
+	struct doca_flow_pipe *wan_pipe;		/* NPTv6 pipe of the WAN subnets */
+	struct doca_flow_pipe *session_pipes[NAT64_L4_NUM]; /* NAT64 WAN pipes of the sessions, by L4 protocol */
+	struct doca_flow_pipe **queue_pipes;		/* NAT64 WAN pipes that send the packets to one queue, by queue */
+	uint64_t *subnets;				/* NPTv6 internal subnets with entries, 0 for an empty slot */
+	uint32_t subnets_mask;				/* Number of subnet slots minus one */
+	uint32_t nb_subnets;				/* NPTv6 subnets with entries, shared by the lcores */
+	struct nat_ipv6_lcore_ctx *lcores;		/* Context of the lcores, by queue */
+	volatile bool force_quit;			/* Set to stop the lcores */
+};
+
+static struct nat_ipv6_state ipv6_state;
+static int subnet_entry_ctx;	/* User context of the NPTv6 subnet entries, they have no session */
+
+void
+nat_ipv6_configure(bool is_nat64, const struct nat_ipv6_cfg *ipv6_cfg, const struct nat_pool_cfg *pool_cfg,
+		   uint16_t nb_queues)
+{
+	ipv6_state.is_nat64 = is_nat64;
+	ipv6_state.cfg = *ipv6_cfg;
+	ipv6_state.pool_cfg = pool_cfg;
+	ipv6_state.nb_queues = nb_queues;
+}
+
+/*
+ * build a pipe that sends all its packets to software queues
+ *
+ * @port [in]: port of the pipe
+ * @name [in]: pipe name
+ * @is_root [in]: true to build a root pipe
+ * @rss_queues [in]: queues of the packets
+ * @nb_queues [in]: number of queues
+ * @rss_pipe [out]: created pipe
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+build_rss_pipe(struct doca_flow_port *port, const char *name, bool is_root, uint16_t *rss_queues, uint16_t nb_queues,
+	       struct doca_flow_pipe **rss_pipe)
+{
+	struct doca_flow_match match;
+	struct doca_flow_fwd fwd;
+	struct doca_flow_pipe_cfg pipe_cfg;
+	struct doca_flow_pipe_entry *entry;
+	doca_error_t result;
+
+	memset(&match, 0, sizeof(match));
+	memset(&fwd, 0, sizeof(fwd));
+	memset(&pipe_cfg, 0, sizeof(pipe_cfg));
+
+	pipe_cfg.attr.name = name;
+	pipe_cfg.match = &match;
+	pipe_cfg.attr.is_root = is_root;
+	pipe_cfg.port = port;
+
+	fwd.type = DOCA_FLOW_FWD_RSS;
+	fwd.rss_outer_flags = DOCA_FLOW_RSS_IPV4 | DOCA_FLOW_RSS_IPV6 | DOCA_FLOW_RSS_TCP | DOCA_FLOW_RSS_UDP;
+	fwd.rss_queues = rss_queues;
+	fwd.num_of_queues = nb_queues;
+
+	result = doca_flow_pipe_create(&pipe_cfg, &fwd, NULL, rss_pipe);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create %s: %s", name, doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_flow_pipe_add_entry(0, *rss_pipe, &match, NULL, NULL, NULL, DOCA_FLOW_NO_WAIT, NULL, &entry);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to add %s entry: %s", name, doca_error_get_descr(result));
+		return result;
+	}
+	result = doca_flow_entries_process(port, 0, NAT_IPV6_TIMEOUT_US, 1);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to process entries");
+		return result;
+	}
+	if (doca_flow_pipe_entry_get_status(entry) != DOCA_FLOW_ENTRY_STATUS_SUCCESS) {
+		DOCA_LOG_ERR("Failed to process entries");
+		return DOCA_ERROR_BAD_STATE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * build the root pipe of the NPTv6 subnets of a port. The LAN pipe matches the upper 64 bits of the source and sets
+ * them to the external subnet, the WAN pipe does the same for the destination. The packets it misses go to software.
+ *
+ * @port [in]: port of the pipe
+ * @port_id [in]: port id
+ * @is_lan [in]: true for the LAN port, false for the WAN port
+ * @miss_pipe [in]: pipe of the packets of the subnets without entries
+ * @nptv6_pipe [out]: created pipe
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+build_nptv6_pipe(struct doca_flow_port *port, uint16_t port_id, bool is_lan, struct doca_flow_pipe *miss_pipe,
+		 struct doca_flow_pipe **nptv6_pipe)
+{
+	struct doca_flow_match match, match_mask;
+	struct doca_flow_actions actions, actions_mask, *actions_arr[1], *actions_mask_arr[1];
+	struct doca_flow_fwd fwd;
+	struct doca_flow_fwd miss_fwd;
+	struct doca_flow_pipe_cfg pipe_cfg;
+	doca_be32_t *addr, *addr_mask, *set_addr, *set_addr_mask;
+	doca_error_t result;
+	int i;
+
+	memset(&match, 0, sizeof(match));
+	memset(&match_mask, 0, sizeof(match_mask));
+	memset(&actions, 0, sizeof(actions));
+	memset(&actions_mask, 0, sizeof(actions_mask));
+	memset(&fwd, 0, sizeof(fwd));
+	memset(&miss_fwd, 0, sizeof(miss_fwd));
+	memset(&pipe_cfg, 0, sizeof(pipe_cfg));
+
+	pipe_cfg.attr.name = is_lan ? "NAT_NPTV6_LAN_PIPE" : "NAT_NPTV6_WAN_PIPE";
+	pipe_cfg.match = &match;
+	pipe_cfg.match_mask = &match_mask;
+	actions_arr[0] = &actions;
+	actions_mask_arr[0] = &actions_mask;
+	pipe_cfg.actions = actions_arr;
+	pipe_cfg.actions_masks = actions_mask_arr;
+	pipe_cfg.attr.nb_actions = 1;
+	pipe_cfg.attr.is_root = true;
+	pipe_cfg.port = port;
+
+	match.outer.l3_type = DOCA_FLOW_L3_TYPE_IP6;
+	match_mask.outer.l3_type = DOCA_FLOW_L3_TYPE_IP6;
+	actions.outer.l3_type = DOCA_FLOW_L3_TYPE_IP6;
+	actions_mask.outer.l3_type = DOCA_FLOW_L3_TYPE_IP6;
+	addr = is_lan ? match.outer.ip6.src_ip : match.outer.ip6.dst_ip;
+	addr_mask = is_lan ? match_mask.outer.ip6.src_ip : match_mask.outer.ip6.dst_ip;
+	set_addr = is_lan ? actions.outer.ip6.src_ip : actions.outer.ip6.dst_ip;
+	set_addr_mask = is_lan ? actions_mask.outer.ip6.src_ip : actions_mask.outer.ip6.dst_ip;
+	/* Only the subnet changes, the interface identifier of the address is kept */
+	for (i = 0; i < NAT_IPV6_SUBNET_WORDS; i++) {
+		addr[i] = 0xffffffff;
+		addr_mask[i] = 0xffffffff;
+		set_addr[i] = 0xffffffff;
+		set_addr_mask[i] = 0xffffffff;
+	}
+
+	fwd.type = DOCA_FLOW_FWD_PORT;
+	fwd.port_id = port_id ^ 1;
+	miss_fwd.type = DOCA_FLOW_FWD_PIPE;
+	miss_fwd.next_pipe = miss_pipe;
+
+	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, nptv6_pipe);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create NAT NPTv6 pipe: %s", doca_error_get_descr(result));
+		return result;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * build a NAT64 WAN pipe of the sessions of a L4 protocol. It matches the IPv4 5-tuple of the replies, every entry
+ * forwards to the queue pipe of the lcore that owns the session.
+ *
+ * @port [in]: WAN port
+ * @l4_pipe [in]: L4 protocol of the pipe
+ * @miss_pipe [in]: pipe of the packets it misses, NULL to drop them
+ * @is_root [in]: true to build a root pipe
+ * @session_pipe [out]: created pipe
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+build_nat64_session_pipe(struct doca_flow_port *port, enum nat64_l4_pipe l4_pipe, struct doca_flow_pipe *miss_pipe,
+			 bool is_root, struct doca_flow_pipe **session_pipe)
+{
+	static const char * const names[NAT64_L4_NUM] = {"NAT64_WAN_TCP_PIPE", "NAT64_WAN_UDP_PIPE",
+							  "NAT64_WAN_ICMP_PIPE"};
+	struct doca_flow_match match;
+	struct doca_flow_fwd fwd;
+	struct doca_flow_fwd miss_fwd;
+	struct doca_flow_pipe_cfg pipe_cfg;
+	doca_error_t result;
+
+	memset(&match, 0, sizeof(match));
+	memset(&fwd, 0, sizeof(fwd));
+	memset(&miss_fwd, 0, sizeof(miss_fwd));
+	memset(&pipe_cfg, 0, sizeof(pipe_cfg));
+
+	pipe_cfg.attr.name = names[l4_pipe];
+	pipe_cfg.match = &match;
+	pipe_cfg.attr.is_root = is_root;
+	pipe_cfg.port = port;
+
+	match.outer.l3_type = DOCA_FLOW_L3_TYPE_IP4;
+	match.outer.ip4.src_ip = 0xffffffff;
+	match.outer.ip4.dst_ip = 0xffffffff;
+	switch (l4_pipe) {
+	case NAT64_L4_TCP:
+		match.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_TCP;
+		match.outer.transport.src_port = 0xffff;
+		match.outer.transport.dst_port = 0xffff;
+		break;
+	case NAT64_L4_UDP:
+		match.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_UDP;
+		match.outer.transport.src_port = 0xffff;
+		match.outer.transport.dst_port = 0xffff;
+		break;
+	default:
+		match.outer.l4_type_ext = DOCA_FLOW_L4_TYPE_EXT_ICMP;
+		match.outer.icmp.ident = 0xffff;
+		break;
+	}
+
+	/* The queue is chosen by every entry */
+	fwd.type = DOCA_FLOW_FWD_PIPE;
+	fwd.next_pipe = NULL;
+	if (miss_pipe != NULL) {
+		miss_fwd.type = DOCA_FLOW_FWD_PIPE;
+		miss_fwd.next_pipe = miss_pipe;
+	} else
+		miss_fwd.type = DOCA_FLOW_FWD_DROP;
+
+	result = doca_flow_pipe_create(&pipe_cfg, &fwd, &miss_fwd, session_pipe);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create NAT64 session pipe: %s", doca_error_get_descr(result));
+		return result;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * build the NAT64 WAN pipes: a pipe per queue and the session pipes of TCP, UDP and ICMP chained by their misses
+ *
+ * @port [in]: WAN port
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+build_nat64_wan_pipes(struct doca_flow_port *port)
+{
+	doca_error_t result;
+	uint16_t queue;
+
+	ipv6_state.queue_pipes = rte_zmalloc(NULL, ipv6_state.nb_queues * sizeof(*ipv6_state.queue_pipes), 0);
+	if (ipv6_state.queue_pipes == NULL) {
+		DOCA_LOG_ERR("Failed to allocate the NAT64 queue pipes");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	for (queue = 0; queue < ipv6_state.nb_queues; queue++) {
+		result = build_rss_pipe(port, "NAT64_QUEUE_PIPE", false, &queue, 1, &ipv6_state.queue_pipes[queue]);
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+
+	result = build_nat64_session_pipe(port, NAT64_L4_ICMP, NULL, false, &ipv6_state.session_pipes[NAT64_L4_ICMP]);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = build_nat64_session_pipe(port, NAT64_L4_UDP, ipv6_state.session_pipes[NAT64_L4_ICMP], false,
+					  &ipv6_state.session_pipes[NAT64_L4_UDP]);
+	if (result != DOCA_SUCCESS)
+		return result;
+	return build_nat64_session_pipe(port, NAT64_L4_TCP, ipv6_state.session_pipes[NAT64_L4_UDP], true,
+					&ipv6_state.session_pipes[NAT64_L4_TCP]);
+}
+
+doca_error_t
+nat_ipv6_build_pipes(struct doca_flow_port *port, uint16_t port_id, bool is_lan)
+{
+	uint16_t rss_queues[ipv6_state.nb_queues];
+	struct doca_flow_pipe *rss_pipe;
+	doca_error_t result;
+	uint16_t queue;
+
+	if (is_lan) {
+		ipv6_state.lan_port_id = port_id;
+		ipv6_state.lan_port = port;
+	} else {
+		ipv6_state.wan_port_id = port_id;
+		ipv6_state.wan_port = port;
+	}
+	for (queue = 0; queue < ipv6_state.nb_queues; queue++)
+		rss_queues[queue] = queue;
+
+	if (!ipv6_state.is_nat64) {
+		result = build_rss_pipe(port, "NAT_NPTV6_RSS_PIPE", false, rss_queues, ipv6_state.nb_queues, &rss_pipe);
+		if (result != DOCA_SUCCESS)
+			return result;
+		return build_nptv6_pipe(port, port_id, is_lan, rss_pipe,
+					is_lan ? &ipv6_state.lan_pipe : &ipv6_state.wan_pipe);
+	}
+
+	/* Every NAT64 LAN packet is translated in software */
+	if (is_lan)
+		return build_rss_pipe(port, "NAT64_LAN_PIPE", true, rss_queues, ipv6_state.nb_queues, &rss_pipe);
+	return build_nat64_wan_pipes(port);
+}
+
+/*
+ * Round up to a power of two
+ *
+ * @n [in]: Number to round, at most 2^31
+ * @return: Smallest power of two not below n
+ */
+static uint32_t
+nat_ipv6_pow2(uint32_t n)
+{
+	uint32_t size = 1;
+
+	while (size < n)
+		size <<= 1;
+	return size;
+}
+
+doca_error_t
+nat_ipv6_init_lcores(void)
+{
+	doca_error_t result;
+	uint16_t queue;
+
+	ipv6_state.lcores = rte_zmalloc(NULL, ipv6_state.nb_queues * sizeof(*ipv6_state.lcores), RTE_CACHE_LINE_SIZE);
+	if (ipv6_state.lcores == NULL) {
+		DOCA_LOG_ERR("Failed to allocate the lcores context");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	if (!ipv6_state.is_nat64) {
+		/* The lcores may claim a few subnets over the maximum before they see the count, there is always a free slot */
+		ipv6_state.subnets_mask = nat_ipv6_pow2(2 * (ipv6_state.cfg.max_subnets + ipv6_state.nb_queues)) - 1;
+		ipv6_state.subnets = rte_zmalloc(NULL, ((size_t)ipv6_state.subnets_mask + 1) * sizeof(*ipv6_state.subnets),
+						 RTE_CACHE_LINE_SIZE);
+		if (ipv6_state.subnets == NULL) {
+			DOCA_LOG_ERR("Failed to allocate the NPTv6 subnets table");
+			return DOCA_ERROR_NO_MEMORY;
+		}
+		return DOCA_SUCCESS;
+	}
+
+	for (queue = 0; queue < ipv6_state.nb_queues; queue++) {
+		result = nat_pool_create(ipv6_state.pool_cfg, queue, ipv6_state.nb_queues, &ipv6_state.lcores[queue].pool);
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Claim an NPTv6 subnet for an lcore, only the first lcore that claims a subnet adds its entries
+ *
+ * @subnet [in]: upper 64 bits of the internal addresses of the subnet, as they are in memory
+ * @return: true if the subnet is claimed, false if it already has entries or the maximum is reached
+ */
+static bool
+claim_subnet(uint64_t subnet)
+{
+	uint32_t pos = (uint32_t)((subnet * 0x9E3779B97F4A7C15ULL) >> 32) & ipv6_state.subnets_mask;
+	uint64_t slot;
+
+	for (;; pos = (pos + 1) & ipv6_state.subnets_mask) {
+		slot = __atomic_load_n(&ipv6_state.subnets[pos], __ATOMIC_ACQUIRE);
+		if (slot == subnet)
+			return false;
+		if (slot != 0)
+			continue;
+		if (__atomic_load_n(&ipv6_state.nb_subnets, __ATOMIC_RELAXED) >= ipv6_state.cfg.max_subnets)
+			return false;
+		if (__atomic_compare_exchange_n(&ipv6_state.subnets[pos], &slot, subnet, false, __ATOMIC_ACQ_REL,
+						__ATOMIC_ACQUIRE)) {
+			__atomic_fetch_add(&ipv6_state.nb_subnets, 1, __ATOMIC_RELAXED);
+			return true;
+		}
+		/* Another lcore took the slot, it may be for the same subnet */
+		if (slot == subnet)
+			return false;
+	}
+}
+
+/*
+ * Add the LAN and WAN entries of an NPTv6 subnet, unless another lcore already did
+ *
+ * @lcore [in]: context of the lcore
+ * @pipe_queue [in]: queue of the lcore
+ * @internal [in]: upper 64 bits of the internal addresses of the subnet
+ * @external [in]: upper 64 bits of the external addresses of the subnet
+ */
+static void
+add_subnet_entries(struct nat_ipv6_lcore_ctx *lcore, uint16_t pipe_queue, const uint8_t *internal,
+		   const uint8_t *external)
+{
+	struct doca_flow_match match;
+	struct doca_flow_actions actions;
+	struct doca_flow_pipe_entry *entry;
+	uint64_t subnet;
+	doca_error_t result;
+
+	memcpy(&subnet, internal, sizeof(subnet));
+	if (subnet == 0 || !claim_subnet(subnet))
+		return;
+	lcore->nb_subnets++;
+
+	memset(&match, 0, sizeof(match));
+	memset(&actions, 0, sizeof(actions));
+	memcpy(match.outer.ip6.src_ip, internal, NAT_IPV6_SUBNET_WORDS * sizeof(doca_be32_t));
+	memcpy(actions.outer.ip6.src_ip, external, NAT_IPV6_SUBNET_WORDS * sizeof(doca_be32_t));
+	result = doca_flow_pipe_add_entry(pipe_queue, ipv6_state.lan_pipe, &match, &actions, NULL, NULL,
+					  DOCA_FLOW_NO_WAIT, &subnet_entry_ctx, &entry);
+	if (result == DOCA_SUCCESS)
+		lcore->nb_pending++;
+	else
+		lcore->nb_failed++;
+
+	memset(&match, 0, sizeof(match));
+	memset(&actions, 0, sizeof(actions));
+	memcpy(match.outer.ip6.dst_ip, external, NAT_IPV6_SUBNET_WORDS * sizeof(doca_be32_t));
+	memcpy(actions.outer.ip6.dst_ip, internal, NAT_IPV6_SUBNET_WORDS * sizeof(doca_be32_t));
+	result = doca_flow_pipe_add_entry(pipe_queue, ipv6_state.wan_pipe, &match, &actions, NULL, NULL,
+					  DOCA_FLOW_NO_WAIT, &subnet_entry_ctx, &entry);
+	if (result == DOCA_SUCCESS)
+		lcore->nb_pending++;
+	else
+		lcore->nb_failed++;
+}
+
+/*
+ * Get the IP header of a packet
+ *
+ * @mbuf [in]: packet
+ * @ether_type [in]: expected Ethernet type, host byte order
+ * @len [out]: length of the packet from the IP header
+ * @return: the IP header, NULL if the packet is not of the expected type
+ */
+static uint8_t *
+get_l3(struct rte_mbuf *mbuf, uint16_t ether_type, size_t *len)
+{
+	struct rte_ether_hdr *eth_hdr = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+
+	if (!rte_pktmbuf_is_contiguous(mbuf) || rte_pktmbuf_data_len(mbuf) < sizeof(*eth_hdr) ||
+	    eth_hdr->ether_type != rte_cpu_to_be_16(ether_type))
+		return NULL;
+	*len = rte_pktmbuf_data_len(mbuf) - sizeof(*eth_hdr);
+	return (uint8_t *)(eth_hdr + 1);
+}
+
+/*
+ * Move the Ethernet header of a packet in front of its translated IP header and trim the packet to its length
+ *
+ * @mbuf [in]: packet
+ * @l3 [in]: translated IP header
+ * @len [in]: length of the translated IP packet
+ * @ether_type [in]: Ethernet type of the translated packet, host byte order
+ */
+static void
+set_l3(struct rte_mbuf *mbuf, uint8_t *l3, size_t len, uint16_t ether_type)
+{
+	struct rte_ether_hdr *eth_hdr = rte_pktmbuf_mtod(mbuf, struct rte_ether_hdr *);
+	struct rte_ether_hdr *new_eth_hdr = (struct rte_ether_hdr *)(l3 - sizeof(*new_eth_hdr));
+
+	memmove(new_eth_hdr, eth_hdr, 2 * RTE_ETHER_ADDR_LEN);
+	new_eth_hdr->ether_type = rte_cpu_to_be_16(ether_type);
+	if (new_eth_hdr > eth_hdr)
+		rte_pktmbuf_adj(mbuf, (uint8_t *)new_eth_hdr - (uint8_t *)eth_hdr);
+	else if (new_eth_hdr < eth_hdr)
+		rte_pktmbuf_prepend(mbuf, (uint8_t *)eth_hdr - (uint8_t *)new_eth_hdr);
+	rte_pktmbuf_trim(mbuf, rte_pktmbuf_data_len(mbuf) - sizeof(*new_eth_hdr) - len);
+}
+
+/*
+ * Translate a burst of NPTv6 packets whose subnet has no entries yet and add the entries of their subnets
+ *
+ * @lcore [in]: context of the lcore
+ * @pipe_queue [in]: queue of the lcore
+ * @mbufs [in/out]: received packets, replaced by the packets to send
+ * @nb_pkts [in]: number of received packets
+ * @outbound [in]: true for the packets of the LAN, false for the packets of the WAN
+ * @return: number of packets to send
+ */
+static uint16_t
+handle_nptv6_burst(struct nat_ipv6_lcore_ctx *lcore, uint16_t pipe_queue, struct rte_mbuf **mbufs, uint16_t nb_pkts,
+		   bool outbound)
+{
+	uint8_t subnet[NAT_IPV6_SUBNET_WORDS * sizeof(doca_be32_t)];
+	uint8_t *l3, *addr;
+	uint16_t i, nb_tx = 0;
+	size_t len;
+
+	for (i = 0; i < nb_pkts; i++) {
+		l3 = get_l3(mbufs[i], RTE_ETHER_TYPE_IPV6, &len);
+		if (l3 == NULL || len < NAT_XLAT_IPV6_HDR_LEN) {
+			lcore->nb_dropped++;
+			rte_pktmbuf_free(mbufs[i]);
+			continue;
+		}
+		addr = l3 + (outbound ? NAT_IPV6_SRC_OFFSET : NAT_IPV6_DST_OFFSET);
+		memcpy(subnet, addr, sizeof(subnet));
+		if (!nat_nptv6_match(&ipv6_state.cfg.npt, addr, outbound) ||
+		    nat_nptv6_translate(&ipv6_state.cfg.npt, addr, outbound) != DOCA_SUCCESS) {
+			lcore->nb_dropped++;
+			rte_pktmbuf_free(mbufs[i]);
+			continue;
+		}
+		if (outbound)
+			add_subnet_entries(lcore, pipe_queue, subnet, addr);
+		else
+			add_subnet_entries(lcore, pipe_queue, addr, subnet);
+		mbufs[nb_tx++] = mbufs[i];
+	}
+	lcore->nb_sw_pkts += nb_tx;
+	return nb_tx;
+}
+
+/*
+ * Remove a NAT64 session: its WAN entry is removed and the session is released once the removal completes
+ *
+ * @lcore [in]: context of the lcore of the session
+ * @pipe_queue [in]: queue of the lcore
+ * @session [in]: session to retire
+ */
+static void
+retire_nat64_session(struct nat_ipv6_lcore_ctx *lcore, uint16_t pipe_queue, struct nat_session *session)
+{
+	doca_error_t result;
+
+	session->flags |= NAT64_SESSION_RETIRED;
+	nat_session_unlink(lcore->pool, session);
+	if (session->rev_entry != NULL) {
+		result = doca_flow_pipe_rm_entry(pipe_queue, DOCA_FLOW_NO_WAIT, session->rev_entry);
+		if (result == DOCA_SUCCESS) {
+			session->nb_pending++;
+			lcore->nb_pending++;
+		} else
+			DOCA_LOG_ERR("Failed to remove NAT64 entry: %s", doca_error_get_descr(result));
+		session->rev_entry = NULL;
+	}
+	if (session->nb_pending == 0)
+		nat_session_release(lcore->pool, session);
+}
+
+void
+nat_ipv6_entry_cb(struct doca_flow_pipe_entry *entry, uint16_t pipe_queue, enum doca_flow_entry_status status,
+		  enum doca_flow_entry_op op, void *user_ctx)
+{
+	(void)entry;
+
+	struct nat_session *session = (struct nat_session *)user_ctx;
+	struct nat_ipv6_lcore_ctx *lcore;
+
+	if (user_ctx == NULL || ipv6_state.lcores == NULL || pipe_queue >= ipv6_state.nb_queues)
+		return;
+	lcore = &ipv6_state.lcores[pipe_queue];
+
+	if (user_ctx == &subnet_entry_ctx) {
+		lcore->nb_pending--;
+		if (status != DOCA_FLOW_ENTRY_STATUS_SUCCESS)
+			lcore->nb_failed++;
+		return;
+	}
+
+	switch (op) {
+	case DOCA_FLOW_ENTRY_OP_ADD:
+		session->nb_pending--;
+		lcore->nb_pending--;
+		if (status != DOCA_FLOW_ENTRY_STATUS_SUCCESS) {
+			session->flags |= NAT64_SESSION_FAILED;
+			session->rev_entry = NULL;
+		}
+		/* The replies of a session without WAN entry are dropped, the next LAN packet creates a new session */
+		if ((session->flags & (NAT64_SESSION_FAILED | NAT64_SESSION_RETIRED)) == NAT64_SESSION_FAILED &&
+		    session->nb_pending == 0) {
+			lcore->nb_failed++;
+			retire_nat64_session(lcore, pipe_queue, session);
+		}
+		break;
+	case DOCA_FLOW_ENTRY_OP_DEL:
+		session->nb_pending--;
+		lcore->nb_pending--;
+		if (session->nb_pending == 0)
+			nat_session_release(lcore->pool, session);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Add the WAN entries of new NAT64 sessions as one batch, they steer the replies to the queue of the lcore
+ *
+ * @lcore [in]: context of the lcore
+ * @pipe_queue [in]: queue of the lcore
+ * @sessions [in]: new sessions
+ * @nb_sessions [in]: number of new sessions
+ */
+static void
+add_nat64_entries(struct nat_ipv6_lcore_ctx *lcore, uint16_t pipe_queue, struct nat_session **sessions,
+		  int nb_sessions)
+{
+	struct doca_flow_match match;
+	struct doca_flow_fwd fwd;
+	struct nat_session *session;
+	enum nat64_l4_pipe l4_pipe;
+	uint32_t flags;
+	doca_error_t result;
+	int i;
+
+	memset(&fwd, 0, sizeof(fwd));
+	fwd.type = DOCA_FLOW_FWD_PIPE;
+	fwd.next_pipe = ipv6_state.queue_pipes[pipe_queue];
+
+	for (i = 0; i < nb_sessions; i++) {
+		session = sessions[i];
+		memset(&match, 0, sizeof(match));
+		match.outer.ip4.src_ip = session->key.remote_ip;
+		match.outer.ip4.dst_ip = session->global_ip;
+		if (session->key.proto == IPPROTO_ICMP) {
+			l4_pipe = NAT64_L4_ICMP;
+			match.outer.icmp.ident = session->global_port;
+		} else {
+			l4_pipe = session->key.proto == IPPROTO_TCP ? NAT64_L4_TCP : NAT64_L4_UDP;
+			match.outer.transport.src_port = session->key.remote_port;
+			match.outer.transport.dst_port = session->global_port;
+		}
+
+		/* Last entry in a batch should be with NO_WAIT flag */
+		flags = i == nb_sessions - 1 ? DOCA_FLOW_NO_WAIT : DOCA_FLOW_WAIT_FOR_BATCH;
+		result = doca_flow_pipe_add_entry(pipe_queue, ipv6_state.session_pipes[l4_pipe], &match, NULL, NULL,
+						  &fwd, flags, session, &session->rev_entry);
+		if (result != DOCA_SUCCESS) {
+			session->rev_entry = NULL;
+			session->flags |= NAT64_SESSION_FAILED;
+			lcore->nb_failed++;
+			retire_nat64_session(lcore, pipe_queue, session);
+			continue;
+		}
+		session->nb_pending++;
+		lcore->nb_pending++;
+	}
+}
+
+/*
+ * Translate a burst of NAT64 LAN packets to IPv4, the sessions of new flows are created and their WAN entries added
+ *
+ * @lcore [in]: context of the lcore
+ * @pipe_queue [in]: queue of the lcore
+ * @mbufs [in/out]: received packets, replaced by the packets to send to the WAN
+ * @nb_pkts [in]: number of received packets
+ * @now [in]: current time in seconds
+ * @return: number of packets to send to the WAN
+ */
+static uint16_t
+handle_nat64_lan_burst(struct nat_ipv6_lcore_ctx *lcore, uint16_t pipe_queue, struct rte_mbuf **mbufs,
+		       uint16_t nb_pkts, uint32_t now)
+{
+	struct nat_session *new_sessions[NAT_IPV6_RX_BURST_SIZE];
+	struct nat_xlat_flow flow;
+	struct nat_session_key key;
+	struct nat_session *session;
+	uint8_t *l3, *new_l3;
+	size_t len, new_len;
+	uint16_t i, nb_tx = 0;
+	int nb_new = 0;
+
+	for (i = 0; i < nb_pkts; i++) {
+		l3 = get_l3(mbufs[i], RTE_ETHER_TYPE_IPV6, &len);
+		if (l3 == NULL || nat_xlat_parse_ipv6(l3, len, &flow) != DOCA_SUCCESS ||
+		    memcmp(flow.dst_ip, ipv6_state.cfg.nat64_prefix, NAT_XLAT_NAT64_PREFIX_LEN) != 0)
+			goto drop;
+
+		memset(&key, 0, sizeof(key));
+		memcpy(key.local_ip, flow.src_ip, sizeof(key.local_ip));
+		memcpy(&key.remote_ip, flow.dst_ip + NAT_XLAT_NAT64_PREFIX_LEN, sizeof(key.remote_ip));
+		key.local_port = flow.src_port;
+		/* An ICMP echo session is identified by its identifier only */
+		key.remote_port = flow.proto == IPPROTO_ICMPV6 ? 0 : flow.dst_port;
+		key.proto = flow.proto == IPPROTO_ICMPV6 ? IPPROTO_ICMP : flow.proto;
+
+		session = nat_session_lookup(lcore->pool, &key);
+		if (session == NULL) {
+			if (nat_session_create(lcore->pool, &key, &session) != DOCA_SUCCESS) {
+				lcore->nb_exhausted++;
+				goto drop;
+			}
+			session->flags = NAT64_SESSION_ACTIVE;
+			lcore->nb_created++;
+			new_sessions[nb_new++] = session;
+		}
+		session->last_used = now;
+
+		if (nat64_ipv6_to_ipv4(l3, &flow, session->global_ip, session->global_port,
+				       rte_cpu_to_be_16(lcore->ip_id++), &new_l3, &new_len) != DOCA_SUCCESS)
+			goto drop;
+		set_l3(mbufs[i], new_l3, new_len, RTE_ETHER_TYPE_IPV4);
+		mbufs[nb_tx++] = mbufs[i];
+		continue;
+drop:
+		lcore->nb_dropped++;
+		rte_pktmbuf_free(mbufs[i]);
+	}
+
+	if (nb_new > 0)
+		add_nat64_entries(lcore, pipe_queue, new_sessions, nb_new);
+	lcore->nb_sw_pkts += nb_tx;
+	return nb_tx;
+}
+
+/*
+ * Translate a burst of NAT64 WAN packets to IPv6, the WAN entries steer the replies of a session to its lcore
+ *
+ * @lcore [in]: context of the lcore
+ * @mbufs [in/out]: received packets, replaced by the packets to send to the LAN
+ * @nb_pkts [in]: number of received packets
+ * @now [in]: current time in seconds
+ * @return: number of packets to send to the LAN
+ */
+static uint16_t
+handle_nat64_wan_burst(struct nat_ipv6_lcore_ctx *lcore, struct rte_mbuf **mbufs, uint16_t nb_pkts, uint32_t now)
+{
+	struct nat_xlat_flow flow;
+	struct nat_session *session;
+	uint32_t global_ip, remote_ip;
+	uint8_t *l3, *new_l3;
+	size_t len, new_len;
+	uint16_t i, nb_tx = 0;
+
+	for (i = 0; i < nb_pkts; i++) {
+		l3 = get_l3(mbufs[i], RTE_ETHER_TYPE_IPV4, &len);
+		if (l3 == NULL || rte_pktmbuf_headroom(mbufs[i]) < NAT_XLAT_HEADROOM ||
+		    nat_xlat_parse_ipv4(l3, len, &flow) != DOCA_SUCCESS)
+			goto drop;
+
+		memcpy(&global_ip, flow.dst_ip, sizeof(global_ip));
+		memcpy(&remote_ip, flow.src_ip, sizeof(remote_ip));
+		session = nat_session_lookup_tuple(lcore->pool, global_ip, flow.dst_port);
+		if (session == NULL || (session->flags & NAT64_SESSION_RETIRED) || session->key.proto != flow.proto ||
+		    session->key.remote_ip != remote_ip ||
+		    (flow.proto != IPPROTO_ICMP && session->key.remote_port != flow.src_port))
+			goto drop;
+		session->last_used = now;
+
+		if (nat64_ipv4_to_ipv6(l3, &flow, ipv6_state.cfg.nat64_prefix, (const uint8_t *)session->key.local_ip,
+				       session->key.local_port, &new_l3, &new_len) != DOCA_SUCCESS)
+			goto drop;
+		set_l3(mbufs[i], new_l3, new_len, RTE_ETHER_TYPE_IPV6);
+		mbufs[nb_tx++] = mbufs[i];
+		continue;
+drop:
+		lcore->nb_dropped++;
+		rte_pktmbuf_free(mbufs[i]);
+	}
+	lcore->nb_sw_pkts += nb_tx;
+	return nb_tx;
+}
+
+/*
+ * Check a slice of the NAT64 sessions of an lcore and retire the idle ones, every session is checked once per aging
+ * timeout
+ *
+ * @lcore [in]: context of the lcore
+ * @pipe_queue [in]: queue of the lcore
+ * @now [in]: current time in seconds
+ */
+static void
+age_nat64_sessions(struct nat_ipv6_lcore_ctx *lcore, uint16_t pipe_queue, uint32_t now)
+{
+	struct nat_pool *pool = lcore->pool;
+	uint32_t aging_sec = ipv6_state.pool_cfg->aging_sec;
+	uint32_t nb_checks = pool->max_sessions / (aging_sec * NAT_IPV6_AGING_PER_SEC) + 1;
+	struct nat_session *session;
+
+	while (nb_checks-- > 0) {
+		session = &pool->sessions[lcore->aging_cursor];
+		if (++lcore->aging_cursor == pool->max_sessions)
+			lcore->aging_cursor = 0;
+		if ((session->flags & (NAT64_SESSION_ACTIVE | NAT64_SESSION_RETIRED)) != NAT64_SESSION_ACTIVE ||
+		    session->nb_pending != 0 || now - session->last_used < aging_sec)
+			continue;
+		lcore->nb_aged++;
+		retire_nat64_session(lcore, pipe_queue, session);
+	}
+}
+
+/*
+ * Send a burst of packets, the packets that are not sent are freed
+ *
+ * @port_id [in]: port to send to
+ * @pipe_queue [in]: queue of the lcore
+ * @mbufs [in]: packets
+ * @nb_pkts [in]: number of packets
+ */
+static void
+send_burst(uint16_t port_id, uint16_t pipe_queue, struct rte_mbuf **mbufs, uint16_t nb_pkts)
+{
+	uint16_t nb_sent = rte_eth_tx_burst(port_id, pipe_queue, mbufs, nb_pkts);
+
+	while (nb_sent < nb_pkts)
+		rte_pktmbuf_free(mbufs[nb_sent++]);
+}
+
+int
+nat_ipv6_process_pkts(void *arg)
+{
+	(void)arg;
+
+	struct rte_mbuf *mbufs[NAT_IPV6_RX_BURST_SIZE];
+	struct nat_ipv6_lcore_ctx *lcore;
+	int lcore_index = rte_lcore_index(rte_lcore_id());
+	uint64_t hz = rte_get_timer_hz(), aging_period = hz / NAT_IPV6_AGING_PER_SEC, next_aging, cycles;
+	uint16_t pipe_queue, nb_rx, nb_tx;
+	uint32_t now;
+
+	if (lcore_index < 0 || lcore_index >= ipv6_state.nb_queues || ipv6_state.lcores == NULL) {
+		DOCA_LOG_DBG("Core %u nothing need to do", rte_lcore_id());
+		return 0;
+	}
+	pipe_queue = lcore_index;
+	lcore = &ipv6_state.lcores[pipe_queue];
+	next_aging = rte_get_timer_cycles() + aging_period;
+
+	while (!ipv6_state.force_quit) {
+		cycles = rte_get_timer_cycles();
+		now = cycles / hz;
+
+		nb_rx = rte_eth_rx_burst(ipv6_state.lan_port_id, pipe_queue, mbufs, NAT_IPV6_RX_BURST_SIZE);
+		if (nb_rx > 0) {
+			if (ipv6_state.is_nat64)
+				nb_tx = handle_nat64_lan_burst(lcore, pipe_queue, mbufs, nb_rx, now);
+			else
+				nb_tx = handle_nptv6_burst(lcore, pipe_queue, mbufs, nb_rx, true);
+			send_burst(ipv6_state.wan_port_id, pipe_queue, mbufs, nb_tx);
+		}
+
+		nb_rx = rte_eth_rx_burst(ipv6_state.wan_port_id, pipe_queue, mbufs, NAT_IPV6_RX_BURST_SIZE);
+		if (nb_rx > 0) {
+			if (ipv6_state.is_nat64)
+				nb_tx = handle_nat64_wan_burst(lcore, mbufs, nb_rx, now);
+			else
+				nb_tx = handle_nptv6_burst(lcore, pipe_queue, mbufs, nb_rx, false);
+			send_burst(ipv6_state.lan_port_id, pipe_queue, mbufs, nb_tx);
+		}
+
+		if (lcore->nb_pending > 0) {
+			doca_flow_entries_process(ipv6_state.lan_port, pipe_queue, 0, 0);
+			doca_flow_entries_process(ipv6_state.wan_port, pipe_queue, 0, 0);
+		}
+
+		if (ipv6_state.is_nat64 && cycles >= next_aging) {
+			age_nat64_sessions(lcore, pipe_queue, now);
+			next_aging = cycles + aging_period;
+		}
+	}
+	return 0;
+}
+
+void
+nat_ipv6_stop(void)
+{
+	ipv6_state.force_quit = true;
+}
+
+void
+nat_ipv6_destroy(void)
+{
+	struct nat_ipv6_lcore_ctx *lcore;
+	uint16_t queue;
+
+	if (ipv6_state.lcores != NULL) {
+		for (queue = 0; queue < ipv6_state.nb_queues; queue++) {
+			lcore = &ipv6_state.lcores[queue];
+			if (ipv6_state.is_nat64)
+				DOCA_LOG_INFO("Queue %u: %" PRIu64 " sessions created, %" PRIu64 " aged, %" PRIu64
+					      " failed entries, %" PRIu64 " new flows dropped on an empty pool, %" PRIu64
+					      " packets translated, %" PRIu64 " dropped", queue, lcore->nb_created,
+					      lcore->nb_aged, lcore->nb_failed, lcore->nb_exhausted, lcore->nb_sw_pkts,
+					      lcore->nb_dropped);
+			else
+				DOCA_LOG_INFO("Queue %u: %" PRIu64 " subnets added, %" PRIu64 " failed entries, %" PRIu64
+					      " packets translated in software, %" PRIu64 " dropped", queue,
+					      lcore->nb_subnets, lcore->nb_failed, lcore->nb_sw_pkts, lcore->nb_dropped);
+			nat_pool_destroy(lcore->pool);
+		}
+		rte_free(ipv6_state.lcores);
+		ipv6_state.lcores = NULL;
+	}
+	rte_free(ipv6_state.subnets);
+	ipv6_state.subnets = NULL;
+	rte_free(ipv6_state.queue_pipes);
+	ipv6_state.queue_pipes = NULL;
+}
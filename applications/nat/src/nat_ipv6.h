@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef NAT_IPV6_H_
+#define NAT_IPV6_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <doca_flow.h>
+
+#include "nat_pool.h"
+#include "nat_xlat.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * NPTV6 and NAT64 modes.
+ *
+ * NPTV6: the pipes of both ports match the /64 subnets already seen and rewrite their prefix and subnet word, the
+ * packets of the other subnets are sent to the lcores. An lcore translates them in software and adds the entries of
+ * their subnet, so a large prefix is expanded only into the subnets in use and never into more than "max subnets".
+ *
+ * NAT64: the hardware can not replace an IPv6 header with an IPv4 header, the lcores translate every packet. The
+ * LAN packets are spread over the lcores by RSS, an lcore allocates the global IPv4 address and port of their
+ * sessions from its own pool and adds a WAN entry that steers the replies of the session to its queue. The WAN
+ * packets that match no session are dropped by the hardware. Idle sessions are aged out by the lcores.
+ */
+
+#define NAT_IPV6_DEFAULT_MAX_SUBNETS (1 << 16)	/* Default number of NPTv6 subnets with entries */
+#define NAT_IPV6_MAX_SUBNETS (1 << 24)		/* Maximal number of NPTv6 subnets with entries */
+
+/* Configuration of the NPTV6 and NAT64 modes */
+struct nat_ipv6_cfg {
+	struct nat_nptv6 npt;				 /* NPTv6 prefixes */
+	uint32_t max_subnets;				 /* Maximal number of NPTv6 /64 subnets with entries */
+	uint8_t nat64_prefix[NAT_XLAT_NAT64_PREFIX_LEN]; /* NAT64 /96 prefix of the IPv4 hosts */
+};
+
+/*
+ * Set the configuration of the NPTV6 or NAT64 mode, before the pipes are built
+ *
+ * @is_nat64 [in]: true for NAT64 mode, false for NPTV6 mode
+ * @ipv6_cfg [in]: mode configuration
+ * @pool_cfg [in]: global address pool of NAT64 mode, must outlive the mode
+ * @nb_queues [in]: number of queues, one per lcore
+ */
+void nat_ipv6_configure(bool is_nat64, const struct nat_ipv6_cfg *ipv6_cfg, const struct nat_pool_cfg *pool_cfg,
+			uint16_t nb_queues);
+
+/*
+ * Build the pipes of a port in NPTV6 or NAT64 mode
+ *
+ * @port [in]: DOCA Flow port
+ * @port_id [in]: port id
+ * @is_lan [in]: true for the LAN port, false for the WAN port
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t nat_ipv6_build_pipes(struct doca_flow_port *port, uint16_t port_id, bool is_lan);
+
+/*
+ * Allocate the lcores context once the pipes of both ports are built
+ *
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t nat_ipv6_init_lcores(void);
+
+/*
+ * Entry processing callback of the NPTV6 and NAT64 modes
+ *
+ * @entry [in]: DOCA Flow entry
+ * @pipe_queue [in]: queue identifier
+ * @status [in]: DOCA Flow entry status
+ * @op [in]: DOCA Flow entry operation
+ * @user_ctx [in]: user context of the entry
+ */
+void nat_ipv6_entry_cb(struct doca_flow_pipe_entry *entry, uint16_t pipe_queue, enum doca_flow_entry_status status,
+		       enum doca_flow_entry_op op, void *user_ctx);
+
+/*
+ * NPTV6 and NAT64 modes lcore main loop: receive the packets of both ports on the queue of the lcore index, translate
+ * them and send them to the other port
+ *
+ * @arg [in]: unused
+ * @return: 0 on success
+ */
+int nat_ipv6_process_pkts(void *arg);
+
+/*
+ * Stop the NPTV6 and NAT64 modes lcores main loop
+ */
+void nat_ipv6_stop(void);
+
+/*
+ * Free the lcores context and log their counters, after the DOCA Flow ports are stopped
+ */
+void nat_ipv6_destroy(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NAT_IPV6_H_ */
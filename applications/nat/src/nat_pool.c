@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <doca_log.h>
+
+#include "nat_pool.h"
+
+DOCA_LOG_REGISTER(NAT_POOL);
+
+#define NAT_POOL_CACHE_LINE 64	   /* Alignment of a pool, pools of different lcores never share a cache line */
+#define NAT_POOL_MIN_TABLE_SIZE 16 /* Minimal number of hash slots */
+
+/*
+ * Round up to a power of two
+ *
+ * @n [in]: Number to round, at most 2^31
+ * @return: Smallest power of two not below n
+ */
+static uint32_t
+nat_pool_pow2(uint32_t n)
+{
+	uint32_t size = 1;
+
+	while (size < n)
+		size <<= 1;
+	return size;
+}
+
+/*
+ * Hash the flow of a session
+ *
+ * @key [in]: Flow of the session
+ * @return: 32 bits hash, its low bits select the first hash slot
+ */
+static inline uint32_t
+nat_session_hash(const struct nat_session_key *key)
+{
+	uint64_t h;
+
+	h = ((uint64_t)key->local_ip[0] << 32 | key->remote_ip) * 0x9E3779B97F4A7C15ULL;
+	h ^= ((uint64_t)key->local_ip[1] << 32 | key->local_ip[2]) * 0xBF58476D1CE4E5B9ULL + key->local_ip[3];
+	h ^= ((uint64_t)key->local_port << 32 | (uint64_t)key->remote_port << 16 | key->proto) + (h >> 29);
+	/* murmur3 finalizer */
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ULL;
+	h ^= h >> 33;
+	return (uint32_t)h;
+}
+
+/*
+ * Compare the flows of two sessions
+ *
+ * @a [in]: First flow
+ * @b [in]: Second flow
+ * @return: true if the flows are the same
+ */
+static inline bool
+nat_session_key_equal(const struct nat_session_key *a, const struct nat_session_key *b)
+{
+	/* The padding is zero, the whole keys are compared */
+	return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+doca_error_t
+nat_pool_create(const struct nat_pool_cfg *cfg, uint32_t lcore_idx, uint32_t nb_lcores, struct nat_pool **pool)
+{
+	struct nat_pool *new_pool;
+	uint64_t nb_all_tuples;
+	uint32_t nb_ports, i;
+
+	if (cfg->nb_global_ips == 0 || cfg->nb_global_ips > NAT_POOL_MAX_GLOBAL_IPS || cfg->min_port > cfg->max_port ||
+	    cfg->max_sessions > NAT_POOL_MAX_SESSIONS || nb_lcores == 0 || lcore_idx >= nb_lcores) {
+		DOCA_LOG_ERR("Invalid NAT pool configuration");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	nb_ports = cfg->max_port - cfg->min_port + 1;
+	nb_all_tuples = (uint64_t)cfg->nb_global_ips * nb_ports;
+	if (nb_all_tuples < nb_lcores || cfg->max_sessions < nb_lcores) {
+		DOCA_LOG_ERR("NAT pool of %" PRIu64 " tuples and %u sessions is too small for %u lcores", nb_all_tuples,
+			     cfg->max_sessions, nb_lcores);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	new_pool = aligned_alloc(NAT_POOL_CACHE_LINE, sizeof(*new_pool) + NAT_POOL_CACHE_LINE -
+				 sizeof(*new_pool) % NAT_POOL_CACHE_LINE);
+	if (new_pool == NULL) {
+		DOCA_LOG_ERR("Failed to allocate NAT pool");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	memset(new_pool, 0, sizeof(*new_pool));
+	new_pool->global_ips = cfg->global_ips;
+	new_pool->nb_global_ips = cfg->nb_global_ips;
+	new_pool->min_port = cfg->min_port;
+	new_pool->first_tuple = nb_all_tuples * lcore_idx / nb_lcores;
+	new_pool->nb_tuples = nb_all_tuples * (lcore_idx + 1) / nb_lcores - new_pool->first_tuple;
+	new_pool->max_sessions = cfg->max_sessions / nb_lcores;
+	if (new_pool->max_sessions > new_pool->nb_tuples)
+		new_pool->max_sessions = new_pool->nb_tuples;
+	new_pool->tuples_mask = nat_pool_pow2(new_pool->nb_tuples) - 1;
+	new_pool->table_mask = nat_pool_pow2(new_pool->max_sessions * 2) - 1;
+	if (new_pool->table_mask < NAT_POOL_MIN_TABLE_SIZE - 1)
+		new_pool->table_mask = NAT_POOL_MIN_TABLE_SIZE - 1;
+
+	new_pool->free_tuples = malloc(((uint64_t)new_pool->tuples_mask + 1) * sizeof(*new_pool->free_tuples));
+	new_pool->sessions = calloc(new_pool->max_sessions, sizeof(*new_pool->sessions));
+	new_pool->table = calloc((uint64_t)new_pool->table_mask + 1, sizeof(*new_pool->table));
+	new_pool->tuple_sessions = calloc(new_pool->nb_tuples, sizeof(*new_pool->tuple_sessions));
+	if (new_pool->free_tuples == NULL || new_pool->sessions == NULL || new_pool->table == NULL ||
+	    new_pool->tuple_sessions == NULL) {
+		DOCA_LOG_ERR("Failed to allocate NAT pool of %u tuples and %u sessions", new_pool->nb_tuples,
+			     new_pool->max_sessions);
+		nat_pool_destroy(new_pool);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	for (i = 0; i < new_pool->nb_tuples; i++)
+		new_pool->free_tuples[i] = new_pool->first_tuple + i;
+	new_pool->tuples_tail = new_pool->nb_tuples;
+	for (i = 0; i < new_pool->max_sessions; i++)
+		new_pool->sessions[i].next_free = i + 1;
+	new_pool->sessions[new_pool->max_sessions - 1].next_free = UINT32_MAX;
+
+	*pool = new_pool;
+	return DOCA_SUCCESS;
+}
+
+void
+nat_pool_destroy(struct nat_pool *pool)
+{
+	if (pool == NULL)
+		return;
+	free(pool->tuple_sessions);
+	free(pool->table);
+	free(pool->sessions);
+	free(pool->free_tuples);
+	free(pool);
+}
+
+struct nat_session *
+nat_session_lookup(const struct nat_pool *pool, const struct nat_session_key *key)
+{
+	uint32_t hash = nat_session_hash(key);
+	uint32_t pos = hash & pool->table_mask;
+	struct nat_session *session;
+	uint64_t slot;
+
+	for (slot = pool->table[pos]; slot != 0; slot = pool->table[pos]) {
+		if ((uint32_t)(slot >> 32) == hash) {
+			session = &pool->sessions[(uint32_t)slot - 1];
+			if (nat_session_key_equal(&session->key, key))
+				return session;
+		}
+		pos = (pos + 1) & pool->table_mask;
+	}
+	return NULL;
+}
+
+struct nat_session *
+nat_session_lookup_tuple(const struct nat_pool *pool, uint32_t global_ip, uint16_t global_port)
+{
+	uint32_t ip_idx, port, tuple, idx;
+
+	for (ip_idx = 0; ip_idx < pool->nb_global_ips; ip_idx++) {
+		if (pool->global_ips[ip_idx] == global_ip)
+			break;
+	}
+	port = ntohs(global_port);
+	if (ip_idx == pool->nb_global_ips || port < pool->min_port)
+		return NULL;
+	tuple = (port - pool->min_port) * pool->nb_global_ips + ip_idx;
+	if (tuple - pool->first_tuple >= pool->nb_tuples)
+		return NULL;
+	idx = pool->tuple_sessions[tuple - pool->first_tuple];
+	return idx == 0 ? NULL : &pool->sessions[idx - 1];
+}
+
+doca_error_t
+nat_session_create(struct nat_pool *pool, const struct nat_session_key *key, struct nat_session **session)
+{
+	uint32_t hash = nat_session_hash(key);
+	uint32_t pos = hash & pool->table_mask;
+	struct nat_session *new_session;
+	uint32_t idx, tuple;
+
+	if (pool->free_session == UINT32_MAX || pool->tuples_head == pool->tuples_tail)
+		return DOCA_ERROR_FULL;
+
+	idx = pool->free_session;
+	new_session = &pool->sessions[idx];
+	pool->free_session = new_session->next_free;
+	tuple = pool->free_tuples[pool->tuples_head++ & pool->tuples_mask];
+
+	memset(new_session, 0, sizeof(*new_session));
+	new_session->key = *key;
+	new_session->tuple = tuple;
+	new_session->global_ip = pool->global_ips[tuple % pool->nb_global_ips];
+	new_session->global_port = htons(pool->min_port + tuple / pool->nb_global_ips);
+	new_session->next_free = UINT32_MAX;
+
+	/* The table has twice the slots of the sessions, there is always an empty slot */
+	while (pool->table[pos] != 0)
+		pos = (pos + 1) & pool->table_mask;
+	pool->table[pos] = (uint64_t)hash << 32 | (idx + 1);
+	pool->tuple_sessions[tuple - pool->first_tuple] = idx + 1;
+	pool->nb_sessions++;
+
+	*session = new_session;
+	return DOCA_SUCCESS;
+}
+
+void
+nat_session_unlink(struct nat_pool *pool, struct nat_session *session)
+{
+	uint32_t hash = nat_session_hash(&session->key);
+	uint32_t idx = session - pool->sessions;
+	uint32_t pos = hash & pool->table_mask;
+	uint32_t next, home;
+
+	while ((uint32_t)pool->table[pos] != idx + 1) {
+		if (pool->table[pos] == 0)
+			return; /* Already unlinked */
+		pos = (pos + 1) & pool->table_mask;
+	}
+
+	/* Backward shift deletion, keeps every probe sequence free of holes without tombstones */
+	for (;;) {
+		pool->table[pos] = 0;
+		next = pos;
+		for (;;) {
+			next = (next + 1) & pool->table_mask;
+			if (pool->table[next] == 0)
+				return;
+			home = (uint32_t)(pool->table[next] >> 32) & pool->table_mask;
+			/* The slot can move back to pos only if its home slot is not between pos and itself */
+			if (((next - home) & pool->table_mask) >= ((next - pos) & pool->table_mask))
+				break;
+		}
+		pool->table[pos] = pool->table[next];
+		pos = next;
+	}
+}
+
+void
+nat_session_release(struct nat_pool *pool, struct nat_session *session)
+{
+	uint32_t idx = session - pool->sessions;
+
+	pool->tuple_sessions[session->tuple - pool->first_tuple] = 0;
+	pool->free_tuples[pool->tuples_tail++ & pool->tuples_mask] = session->tuple;
+	session->next_free = pool->free_session;
+	pool->free_session = idx;
+	pool->nb_sessions--;
+}
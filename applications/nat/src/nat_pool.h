@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef NAT_POOL_H_
+#define NAT_POOL_H_
+
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Global address pool and session table of the dynamic NAT mode.
+ *
+ * The global IP/port tuples are numbered IP first: tuple t is global IP (t % nb_global_ips) with port
+ * (min_port + t / nb_global_ips). Every lcore owns a pool made of a contiguous range of tuples and of its own sessions,
+ * so an lcore allocates and recycles tuples and sessions without any lock or atomic operation. The free tuples of a
+ * pool are kept in a FIFO ring, a released tuple is reused as late as possible. Sessions are preallocated and found by
+ * their 5-tuple in an open addressing hash table, or by their tuple for the packets that come back from the WAN.
+ */
+
+#define NAT_POOL_MAX_GLOBAL_IPS 256		/* Maximal number of global IPs in the pool */
+#define NAT_POOL_DEFAULT_MIN_PORT 1024		/* Default lowest global port */
+#define NAT_POOL_DEFAULT_MAX_PORT 65535		/* Default highest global port */
+#define NAT_POOL_MAX_SESSIONS (1U << 30)	/* Maximal number of sessions of all the lcores */
+#define NAT_POOL_DEFAULT_MAX_SESSIONS (1 << 20) /* Default number of sessions of all the lcores */
+#define NAT_POOL_DEFAULT_AGING_SEC 60		/* Default idle time of a session before it is removed */
+
+struct doca_flow_pipe_entry;
+
+/* Dynamic NAT pool configuration, shared by the pools of all the lcores */
+struct nat_pool_cfg {
+	uint32_t global_ips[NAT_POOL_MAX_GLOBAL_IPS]; /* Global IPs, network byte order */
+	uint32_t nb_global_ips;			      /* Number of global IPs */
+	uint16_t min_port;			      /* Lowest global port, host byte order */
+	uint16_t max_port;			      /* Highest global port, host byte order */
+	uint32_t max_sessions;			      /* Maximal number of sessions of all the lcores */
+	uint32_t aging_sec;			      /* Idle time of a session before it is removed (seconds) */
+};
+
+/* Flow of a session as seen on the LAN side, all fields in network byte order */
+struct nat_session_key {
+	uint32_t local_ip[4]; /* Source IP of the LAN packets, an IPv4 address uses the first word and zeroes the rest */
+	uint32_t remote_ip;   /* Destination IPv4 of the LAN packets */
+	uint16_t local_port;  /* Source port of the LAN packets, or identifier of an ICMP echo */
+	uint16_t remote_port; /* Destination port of the LAN packets, zero for an ICMP echo */
+	uint8_t proto;	      /* IP protocol, TCP, UDP or ICMP */
+	uint8_t pad[3];	      /* Must be zero */
+};
+
+struct nat_session {
+	struct nat_session_key key;		/* Flow of the session */
+	uint32_t global_ip;			/* Global IP of the session, network byte order */
+	uint16_t global_port;			/* Global port of the session, network byte order */
+	uint8_t flags;				/* Owned by the user of the pool, zero on creation */
+	uint8_t nb_pending;			/* Owned by the user of the pool, zero on creation */
+	uint32_t tuple;				/* Global IP/port tuple of the session */
+	uint32_t next_free;			/* Next session in the free list */
+	uint32_t last_used;			/* Owned by the user of the pool, zero on creation */
+	struct doca_flow_pipe_entry *fwd_entry; /* LAN to WAN entry of the session */
+	struct doca_flow_pipe_entry *rev_entry; /* WAN to LAN entry of the session */
+};
+
+struct nat_pool {
+	const uint32_t *global_ips;   /* Global IPs of the configuration */
+	uint32_t nb_global_ips;	      /* Number of global IPs */
+	uint16_t min_port;	      /* Lowest global port, host byte order */
+	uint32_t first_tuple;	      /* First tuple owned by the pool */
+	uint32_t nb_tuples;	      /* Number of tuples owned by the pool */
+	uint32_t *free_tuples;	      /* Ring of the free tuples */
+	uint32_t tuples_mask;	      /* Size of the ring minus one */
+	uint32_t tuples_head;	      /* Ring position of the next tuple to allocate */
+	uint32_t tuples_tail;	      /* Ring position of the next released tuple */
+	struct nat_session *sessions; /* Preallocated sessions */
+	uint32_t max_sessions;	      /* Number of preallocated sessions */
+	uint32_t nb_sessions;	      /* Number of sessions in use */
+	uint32_t free_session;	      /* First free session, UINT32_MAX if none */
+	uint32_t *tuple_sessions;     /* Session of every tuple of the pool: session index + 1, 0 if the tuple is free */
+	uint64_t *table;	      /* Hash slots: hash signature << 32 | session index + 1, 0 if empty */
+	uint32_t table_mask;	      /* Number of hash slots minus one */
+};
+
+/*
+ * Create the pool of an lcore
+ *
+ * @cfg [in]: Pool configuration, must outlive the pool
+ * @lcore_idx [in]: Index of the lcore, decides the tuples of the pool
+ * @nb_lcores [in]: Number of lcores the tuples and sessions are divided between
+ * @pool [out]: Created pool
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t nat_pool_create(const struct nat_pool_cfg *cfg, uint32_t lcore_idx, uint32_t nb_lcores,
+			     struct nat_pool **pool);
+
+/*
+ * Destroy a pool and all its sessions
+ *
+ * @pool [in]: Pool to destroy
+ */
+void nat_pool_destroy(struct nat_pool *pool);
+
+/*
+ * Find the session of a flow
+ *
+ * @pool [in]: Pool
+ * @key [in]: Flow of the session
+ * @return: The session, NULL if the flow has no session
+ */
+struct nat_session *nat_session_lookup(const struct nat_pool *pool, const struct nat_session_key *key);
+
+/*
+ * Find the session of a global IP and port of the pool
+ *
+ * @pool [in]: Pool
+ * @global_ip [in]: Global IP, network byte order
+ * @global_port [in]: Global port, network byte order
+ * @return: The session, NULL if the global IP and port are not owned by the pool or have no session
+ */
+struct nat_session *nat_session_lookup_tuple(const struct nat_pool *pool, uint32_t global_ip, uint16_t global_port);
+
+/*
+ * Create a session for a flow and allocate its global IP and port
+ *
+ * @pool [in]: Pool
+ * @key [in]: Flow of the session, must not have a session already
+ * @session [out]: Created session
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_FULL when the pool has no free tuple or session
+ */
+doca_error_t nat_session_create(struct nat_pool *pool, const struct nat_session_key *key,
+				struct nat_session **session);
+
+/*
+ * Remove a session from the hash table, its flow is no longer found but its tuple stays allocated
+ *
+ * @pool [in]: Pool
+ * @session [in]: Session to remove
+ */
+void nat_session_unlink(struct nat_pool *pool, struct nat_session *session);
+
+/*
+ * Free an unlinked session and its global IP and port
+ *
+ * @pool [in]: Pool
+ * @session [in]: Session to free
+ */
+void nat_session_release(struct nat_pool *pool, struct nat_session *session);
+
+/*
+ * Get the number of free tuples of a pool
+ *
+ * @pool [in]: Pool
+ * @return: Number of free tuples
+ */
+static inline uint32_t
+nat_pool_nb_free_tuples(const struct nat_pool *pool)
+{
+	return pool->tuples_tail - pool->tuples_head;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NAT_POOL_H_ */
@@ -0,0 +1,716 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <json-c/json.h>
+
+#include <doca_log.h>
+
+#include "nat_rules.h"
+
+DOCA_LOG_REGISTER(NAT_RULES);
+
+#define NAT_RULES_MAX_KEY_LEN 64	/* Maximal length of a top level key, longer keys are truncated */
+#define NAT_RULES_MIN_SET_SIZE 1024	/* Initial number of rules of a set */
+#define NAT_RULES_MAX_PORT 65535	/* Highest valid port */
+
+/* State of a rules file stream */
+struct nat_rules_reader {
+	FILE *fp;			 /* Rules file */
+	int line;			 /* Current line of the file, for error messages */
+	enum nat_mode mode;		 /* NAT mode of the rules */
+	bool has_global_ip;		 /* true once the PAT global IP was read */
+	doca_be32_t global_ip;		 /* PAT global IP */
+	uint32_t nb_rules;		 /* Number of rules read */
+	char buf[NAT_RULE_MAX_LEN + 1]; /* JSON text of the current rule or value */
+};
+
+/*
+ * parse and set local ip from json file to nat rule struct
+ *
+ * @cur_rule [in]: rule in json object format
+ * @rule [out]: rule in app structure format.
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+create_local_ip(struct json_object *cur_rule, struct nat_rule_match *rule)
+{
+	struct json_object *local_ip;
+
+	if (!json_object_object_get_ex(cur_rule, "local ip", &local_ip)) {
+		DOCA_LOG_ERR("Missing local IP");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (json_object_get_type(local_ip) != json_type_string) {
+		DOCA_LOG_ERR("Expecting a string value for \"local ip\"");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	return parse_ipv4_str(json_object_get_string(local_ip), &rule->local_ip);
+}
+
+/*
+ * parse and set global ip from json file to nat rule struct
+ *
+ * @cur_rule [in]: rule in json object format
+ * @rule [out]: rule in app structure format.
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+create_global_ip(struct json_object *cur_rule, struct nat_rule_match *rule)
+{
+	struct json_object *global_ip;
+
+	if (!json_object_object_get_ex(cur_rule, "global ip", &global_ip)) {
+		DOCA_LOG_ERR("Missing global IP");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (json_object_get_type(global_ip) != json_type_string) {
+		DOCA_LOG_ERR("Expecting a string value for \"global ip\"");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	return parse_ipv4_str(json_object_get_string(global_ip), &rule->global_ip);
+}
+
+/*
+ * parse a port of a rule
+ *
+ * @cur_rule [in]: rule in json object format
+ * @name [in]: name of the port
+ * @port [out]: the port
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+create_port(struct json_object *cur_rule, const char *name, int *port)
+{
+	struct json_object *json_port;
+
+	if (!json_object_object_get_ex(cur_rule, name, &json_port)) {
+		DOCA_LOG_ERR("Missing %s", name);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	if (json_object_get_type(json_port) != json_type_int) {
+		DOCA_LOG_ERR("Expecting an int value for \"%s\"", name);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	*port = json_object_get_int(json_port);
+	if (*port < 0 || *port > NAT_RULES_MAX_PORT) {
+		DOCA_LOG_ERR("Invalid %s %d", name, *port);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Read the next char of the rules file
+ *
+ * @reader [in]: rules file stream
+ * @return: the char or EOF
+ */
+static inline int
+reader_getc(struct nat_rules_reader *reader)
+{
+	int c = getc_unlocked(reader->fp);
+
+	if (c == '\n')
+		reader->line++;
+	return c;
+}
+
+/*
+ * Skip a comment, its first '/' was read
+ *
+ * @reader [in]: rules file stream
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+reader_skip_comment(struct nat_rules_reader *reader)
+{
+	int c = reader_getc(reader), prev = 0;
+
+	if (c == '/') {
+		while (c != '\n' && c != EOF)
+			c = reader_getc(reader);
+		return DOCA_SUCCESS;
+	}
+	if (c != '*') {
+		DOCA_LOG_ERR("Unexpected '/' in line %d", reader->line);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	for (c = reader_getc(reader); c != EOF; prev = c, c = reader_getc(reader)) {
+		if (prev == '*' && c == '/')
+			return DOCA_SUCCESS;
+	}
+	DOCA_LOG_ERR("Unterminated comment");
+	return DOCA_ERROR_INVALID_VALUE;
+}
+
+/*
+ * Read the next char of the rules file that is not a white space or part of a comment
+ *
+ * @reader [in]: rules file stream
+ * @c [out]: the char or EOF
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+reader_next_token(struct nat_rules_reader *reader, int *c)
+{
+	doca_error_t result;
+
+	for (;;) {
+		*c = reader_getc(reader);
+		if (*c == '/') {
+			result = reader_skip_comment(reader);
+			if (result != DOCA_SUCCESS)
+				return result;
+			continue;
+		}
+		if (*c == EOF || !isspace(*c))
+			return DOCA_SUCCESS;
+	}
+}
+
+/*
+ * Read a string, its opening quote was read
+ *
+ * @reader [in]: rules file stream
+ * @str [out]: the string without its quotes, truncated to the buffer size. NULL to skip the string
+ * @size [in]: size of the buffer
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+reader_read_string(struct nat_rules_reader *reader, char *str, size_t size)
+{
+	bool escape = false;
+	size_t len = 0;
+	int c;
+
+	for (c = reader_getc(reader); c != EOF; c = reader_getc(reader)) {
+		if (!escape && c == '"') {
+			if (str != NULL)
+				str[len] = '\0';
+			return DOCA_SUCCESS;
+		}
+		escape = !escape && c == '\\';
+		if (str != NULL && len < size - 1)
+			str[len++] = c;
+	}
+	DOCA_LOG_ERR("Unterminated string");
+	return DOCA_ERROR_INVALID_VALUE;
+}
+
+/*
+ * Read a JSON value, its first char was read. The value ends at the closing char of an object, array or string, or
+ * before the ',', '}' or ']' that follows a number or literal.
+ *
+ * @reader [in]: rules file stream
+ * @c [in]: first char of the value
+ * @copy [in]: true to copy the value to the reader buffer, false to skip it
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+reader_read_value(struct nat_rules_reader *reader, int c, bool copy)
+{
+	bool in_string = false, escape = false;
+	int depth = 0;
+	size_t len = 0;
+	doca_error_t result;
+
+	if (c == EOF || c == ',' || c == '}' || c == ']') {
+		DOCA_LOG_ERR("Expecting a value in line %d", reader->line);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	for (;; c = reader_getc(reader)) {
+		if (c == EOF) {
+			DOCA_LOG_ERR("Unexpected end of file");
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		if (!in_string) {
+			if (depth == 0 && (c == ',' || c == '}' || c == ']')) {
+				ungetc(c, reader->fp);
+				break;
+			}
+			if (c == '/') {
+				result = reader_skip_comment(reader);
+				if (result != DOCA_SUCCESS)
+					return result;
+				c = ' ';
+			}
+		}
+
+		if (copy) {
+			if (len == NAT_RULE_MAX_LEN) {
+				DOCA_LOG_ERR("Value in line %d is longer than %d bytes", reader->line, NAT_RULE_MAX_LEN);
+				return DOCA_ERROR_INVALID_VALUE;
+			}
+			reader->buf[len++] = c;
+		}
+
+		if (in_string) {
+			if (escape)
+				escape = false;
+			else if (c == '\\')
+				escape = true;
+			else if (c == '"') {
+				in_string = false;
+				if (depth == 0)
+					break;
+			}
+		} else if (c == '"')
+			in_string = true;
+		else if (c == '{' || c == '[')
+			depth++;
+		else if (c == '}' || c == ']') {
+			if (--depth == 0)
+				break;
+		}
+	}
+	if (copy)
+		reader->buf[len] = '\0';
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Read the PAT global IP from the rules file
+ *
+ * @reader [in]: rules file stream
+ * @c [in]: first char of the value
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+reader_read_global_ip(struct nat_rules_reader *reader, int c)
+{
+	struct json_object *global_ip;
+	doca_error_t result;
+
+	result = reader_read_value(reader, c, true);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	global_ip = json_tokener_parse(reader->buf);
+	if (global_ip == NULL || json_object_get_type(global_ip) != json_type_string) {
+		DOCA_LOG_ERR("Expecting a string value for \"global ip\"");
+		json_object_put(global_ip);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	result = parse_ipv4_str(json_object_get_string(global_ip), &reader->global_ip);
+	json_object_put(global_ip);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	DOCA_LOG_DBG("PAT global IP = %d.%d.%d.%d", (reader->global_ip & 0xff), (reader->global_ip >> 8 & 0xff),
+		     (reader->global_ip >> 16 & 0xff), (reader->global_ip >> 24 & 0xff));
+	reader->has_global_ip = true;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Read one rule object of the rules array, its opening brace was read
+ *
+ * @reader [in]: rules file stream
+ * @c [in]: first char of the rule
+ * @rule [out]: the rule
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+reader_read_rule(struct nat_rules_reader *reader, int c, struct nat_rule_match *rule)
+{
+	struct json_object *cur_rule;
+	int line = reader->line;
+	doca_error_t result;
+
+	if (c != '{') {
+		DOCA_LOG_ERR("Expecting an object for rule %u in line %d", reader->nb_rules, line);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	result = reader_read_value(reader, c, true);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	cur_rule = json_tokener_parse(reader->buf);
+	if (cur_rule == NULL) {
+		DOCA_LOG_ERR("Failed to parse rule %u in line %d", reader->nb_rules, line);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	memset(rule, 0, sizeof(*rule));
+	result = create_local_ip(cur_rule, rule);
+	if (result != DOCA_SUCCESS)
+		goto put_rule;
+	if (reader->mode == STATIC) {
+		result = create_global_ip(cur_rule, rule);
+		goto put_rule;
+	}
+	result = create_port(cur_rule, "local port", &rule->local_port);
+	if (result != DOCA_SUCCESS)
+		goto put_rule;
+	result = create_port(cur_rule, "global port", &rule->global_port);
+	rule->global_ip = reader->global_ip;
+
+put_rule:
+	json_object_put(cur_rule);
+	if (result != DOCA_SUCCESS)
+		DOCA_LOG_ERR("Invalid rule %u in line %d", reader->nb_rules, line);
+	return result;
+}
+
+/*
+ * Read the rules array, its opening bracket was read
+ *
+ * @reader [in]: rules file stream
+ * @cb [in]: callback of every rule
+ * @ctx [in]: user context of the callback
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+reader_read_rules(struct nat_rules_reader *reader, nat_rule_cb cb, void *ctx)
+{
+	struct nat_rule_match rule;
+	doca_error_t result;
+	int c;
+
+	if (reader->mode == PAT && !reader->has_global_ip) {
+		DOCA_LOG_ERR("\"global ip\" must come before \"rules\" in PAT mode");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	result = reader_next_token(reader, &c);
+	if (result != DOCA_SUCCESS)
+		return result;
+	while (c != ']') {
+		result = reader_read_rule(reader, c, &rule);
+		if (result != DOCA_SUCCESS)
+			return result;
+		result = cb(&rule, ctx);
+		if (result != DOCA_SUCCESS)
+			return result;
+		reader->nb_rules++;
+
+		result = reader_next_token(reader, &c);
+		if (result != DOCA_SUCCESS)
+			return result;
+		if (c == ',') {
+			result = reader_next_token(reader, &c);
+			if (result != DOCA_SUCCESS)
+				return result;
+		} else if (c != ']') {
+			DOCA_LOG_ERR("Expecting ',' or ']' after rule %u in line %d", reader->nb_rules - 1, reader->line);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Read the top level object of the rules file
+ *
+ * @reader [in]: rules file stream
+ * @cb [in]: callback of every rule
+ * @ctx [in]: user context of the callback
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+reader_read_file(struct nat_rules_reader *reader, nat_rule_cb cb, void *ctx)
+{
+	char key[NAT_RULES_MAX_KEY_LEN];
+	bool has_rules = false;
+	doca_error_t result;
+	int c;
+
+	result = reader_next_token(reader, &c);
+	if (result != DOCA_SUCCESS)
+		return result;
+	if (c != '{') {
+		DOCA_LOG_ERR("Expecting a JSON object in line %d", reader->line);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	result = reader_next_token(reader, &c);
+	if (result != DOCA_SUCCESS)
+		return result;
+	while (c != '}') {
+		if (c != '"') {
+			DOCA_LOG_ERR("Expecting a key in line %d", reader->line);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		result = reader_read_string(reader, key, sizeof(key));
+		if (result != DOCA_SUCCESS)
+			return result;
+		result = reader_next_token(reader, &c);
+		if (result != DOCA_SUCCESS)
+			return result;
+		if (c != ':') {
+			DOCA_LOG_ERR("Expecting ':' after \"%s\" in line %d", key, reader->line);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+		result = reader_next_token(reader, &c);
+		if (result != DOCA_SUCCESS)
+			return result;
+
+		if (strcmp(key, "rules") == 0) {
+			if (c != '[') {
+				DOCA_LOG_ERR("Expecting an array for \"rules\" in line %d", reader->line);
+				return DOCA_ERROR_INVALID_VALUE;
+			}
+			result = reader_read_rules(reader, cb, ctx);
+			has_rules = true;
+		} else if (strcmp(key, "global ip") == 0 && reader->mode == PAT)
+			result = reader_read_global_ip(reader, c);
+		else
+			result = reader_read_value(reader, c, false);
+		if (result != DOCA_SUCCESS)
+			return result;
+
+		result = reader_next_token(reader, &c);
+		if (result != DOCA_SUCCESS)
+			return result;
+		if (c == ',') {
+			result = reader_next_token(reader, &c);
+			if (result != DOCA_SUCCESS)
+				return result;
+		} else if (c != '}') {
+			DOCA_LOG_ERR("Expecting ',' or '}' in line %d", reader->line);
+			return DOCA_ERROR_INVALID_VALUE;
+		}
+	}
+
+	if (!has_rules) {
+		DOCA_LOG_ERR("Missing \"rules\" parameter");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+nat_rules_stream(const char *file_path, enum nat_mode mode, nat_rule_cb cb, void *ctx)
+{
+	struct nat_rules_reader *reader;
+	doca_error_t result;
+
+	if (mode != STATIC && mode != PAT) {
+		DOCA_LOG_ERR("Invalid NAT mode");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	reader = (struct nat_rules_reader *)calloc(1, sizeof(*reader));
+	if (reader == NULL) {
+		DOCA_LOG_ERR("calloc() function failed");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	reader->fp = fopen(file_path, "r");
+	if (reader->fp == NULL) {
+		DOCA_LOG_ERR("JSON file open failed");
+		free(reader);
+		return DOCA_ERROR_IO_FAILED;
+	}
+	reader->line = 1;
+	reader->mode = mode;
+
+	result = reader_read_file(reader, cb, ctx);
+	if (result == DOCA_SUCCESS)
+		DOCA_LOG_INFO("Number of rules in input file: %u", reader->nb_rules);
+	else
+		DOCA_LOG_ERR("Failed to read NAT rules from %s", file_path);
+
+	fclose(reader->fp);
+	free(reader);
+	return result;
+}
+
+doca_error_t
+nat_rule_set_append(struct nat_rule_set *set, const struct nat_rule_match *match)
+{
+	struct nat_rule *rules;
+	uint32_t size;
+
+	if (set->nb_rules == set->size) {
+		size = set->size == 0 ? NAT_RULES_MIN_SET_SIZE : set->size * 2;
+		if (size <= set->size) {
+			DOCA_LOG_ERR("Too many NAT rules");
+			return DOCA_ERROR_NO_MEMORY;
+		}
+		rules = (struct nat_rule *)realloc(set->rules, (size_t)size * sizeof(*rules));
+		if (rules == NULL) {
+			DOCA_LOG_ERR("Failed to allocate %u NAT rules", size);
+			return DOCA_ERROR_NO_MEMORY;
+		}
+		set->rules = rules;
+		set->size = size;
+	}
+
+	memset(&set->rules[set->nb_rules], 0, sizeof(set->rules[set->nb_rules]));
+	set->rules[set->nb_rules++].match = *match;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Compare two rules, the rules that match the same LAN traffic are next to each other in a sorted set
+ *
+ * @a [in]: first rule definition
+ * @b [in]: second rule definition
+ * @return: negative, zero or positive like memcmp()
+ */
+static int
+nat_rule_cmp(const struct nat_rule_match *a, const struct nat_rule_match *b)
+{
+	if (a->local_ip != b->local_ip)
+		return a->local_ip < b->local_ip ? -1 : 1;
+	if (a->local_port != b->local_port)
+		return a->local_port < b->local_port ? -1 : 1;
+	if (a->global_ip != b->global_ip)
+		return a->global_ip < b->global_ip ? -1 : 1;
+	if (a->global_port != b->global_port)
+		return a->global_port < b->global_port ? -1 : 1;
+	return 0;
+}
+
+/*
+ * qsort() compare function of rules
+ *
+ * @a [in]: first rule
+ * @b [in]: second rule
+ * @return: negative, zero or positive like memcmp()
+ */
+static int
+nat_rule_qsort_cmp(const void *a, const void *b)
+{
+	return nat_rule_cmp(&((const struct nat_rule *)a)->match, &((const struct nat_rule *)b)->match);
+}
+
+/*
+ * qsort() compare function of WAN keys
+ *
+ * @a [in]: first key
+ * @b [in]: second key
+ * @return: negative, zero or positive like memcmp()
+ */
+static int
+nat_wan_key_cmp(const void *a, const void *b)
+{
+	uint64_t key_a = *(const uint64_t *)a, key_b = *(const uint64_t *)b;
+
+	return key_a < key_b ? -1 : key_a > key_b;
+}
+
+doca_error_t
+nat_rule_set_sort(struct nat_rule_set *set, enum nat_mode mode)
+{
+	char ip_str[INET_ADDRSTRLEN];
+	struct nat_rule_match *prev, *cur;
+	doca_be32_t global_ip;
+	uint64_t *wan_keys;
+	uint32_t i, nb_rules = 0;
+	doca_error_t result = DOCA_SUCCESS;
+
+	if (set->nb_rules == 0)
+		return DOCA_SUCCESS;
+	qsort(set->rules, set->nb_rules, sizeof(*set->rules), nat_rule_qsort_cmp);
+
+	/* Drop the repeated rules, two rules with the same LAN match and different translations conflict */
+	for (i = 0; i < set->nb_rules; i++) {
+		cur = &set->rules[i].match;
+		if (nb_rules > 0) {
+			prev = &set->rules[nb_rules - 1].match;
+			if (nat_rule_cmp(prev, cur) == 0) {
+				inet_ntop(AF_INET, &cur->local_ip, ip_str, sizeof(ip_str));
+				DOCA_LOG_WARN("Ignoring repeated rule of local IP %s port %d", ip_str, cur->local_port);
+				continue;
+			}
+			if (prev->local_ip == cur->local_ip && (mode == STATIC || prev->local_port == cur->local_port)) {
+				inet_ntop(AF_INET, &cur->local_ip, ip_str, sizeof(ip_str));
+				DOCA_LOG_ERR("Conflicting rules of local IP %s port %d", ip_str, cur->local_port);
+				return DOCA_ERROR_INVALID_VALUE;
+			}
+		}
+		set->rules[nb_rules++].match = *cur;
+	}
+	set->nb_rules = nb_rules;
+
+	/* Two rules with the same WAN match conflict as well */
+	wan_keys = (uint64_t *)malloc((size_t)nb_rules * sizeof(*wan_keys));
+	if (wan_keys == NULL) {
+		DOCA_LOG_ERR("Failed to allocate %u NAT rules keys", nb_rules);
+		return DOCA_ERROR_NO_MEMORY;
+	}
+	for (i = 0; i < nb_rules; i++)
+		wan_keys[i] = (uint64_t)set->rules[i].match.global_ip << 16 | set->rules[i].match.global_port;
+	qsort(wan_keys, nb_rules, sizeof(*wan_keys), nat_wan_key_cmp);
+	for (i = 1; i < nb_rules; i++) {
+		if (wan_keys[i] == wan_keys[i - 1]) {
+			global_ip = wan_keys[i] >> 16;
+			inet_ntop(AF_INET, &global_ip, ip_str, sizeof(ip_str));
+			DOCA_LOG_ERR("Conflicting rules of global IP %s port %d", ip_str, (int)(wan_keys[i] & 0xffff));
+			result = DOCA_ERROR_INVALID_VALUE;
+			break;
+		}
+	}
+	free(wan_keys);
+	return result;
+}
+
+void
+nat_rule_set_foreach_missing(struct nat_rule_set *set, const struct nat_rule_set *other, nat_rule_set_cb cb,
+			     void *ctx)
+{
+	uint32_t i = 0, j = 0;
+	int cmp;
+
+	while (i < set->nb_rules) {
+		cmp = j < other->nb_rules ? nat_rule_cmp(&set->rules[i].match, &other->rules[j].match) : -1;
+		if (cmp < 0)
+			cb(&set->rules[i++], ctx);
+		else if (cmp > 0)
+			j++;
+		else {
+			i++;
+			j++;
+		}
+	}
+}
+
+void
+nat_rule_set_move_entries(struct nat_rule_set *from, struct nat_rule_set *to)
+{
+	uint32_t i = 0, j = 0;
+	int cmp;
+
+	while (i < from->nb_rules && j < to->nb_rules) {
+		cmp = nat_rule_cmp(&from->rules[i].match, &to->rules[j].match);
+		if (cmp < 0)
+			i++;
+		else if (cmp > 0)
+			j++;
+		else {
+			memcpy(to->rules[j].entries, from->rules[i].entries, sizeof(to->rules[j].entries));
+			memset(from->rules[i].entries, 0, sizeof(from->rules[i].entries));
+			i++;
+			j++;
+		}
+	}
+}
+
+void
+nat_rule_set_free(struct nat_rule_set *set)
+{
+	free(set->rules);
+	memset(set, 0, sizeof(*set));
+}
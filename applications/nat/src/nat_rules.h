@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef NAT_RULES_H_
+#define NAT_RULES_H_
+
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include "nat_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Rules files of the static and PAT modes.
+ *
+ * The rules file is read as a stream: the JSON text is scanned in a single pass and only one rule object at a time is
+ * handed to json-c, so the memory of the parser does not grow with the number of rules. The rules are kept in a
+ * compact set sorted by their match, a new rules file is compared with the installed set and only the rules that
+ * differ are removed from or added to the pipes.
+ */
+
+#define NAT_RULE_MAX_LEN 1024	/* Maximal length of the JSON text of one rule or one top level value */
+#define NAT_RULE_NB_ENTRIES 4	/* Entries of a rule: LAN TCP, LAN UDP, WAN TCP and WAN UDP */
+#define NAT_RULE_LAN_ENTRY 0	/* Index of the first LAN entry of a rule, static mode has only the first one */
+#define NAT_RULE_WAN_ENTRY 2	/* Index of the first WAN entry of a rule, static mode has only the first one */
+
+struct doca_flow_pipe_entry;
+
+/* Installed rule */
+struct nat_rule {
+	struct nat_rule_match match;					 /* Rule definition */
+	struct doca_flow_pipe_entry *entries[NAT_RULE_NB_ENTRIES]; /* Pipe entries of the rule, NULL if not added */
+};
+
+/* Set of rules sorted by their definition */
+struct nat_rule_set {
+	struct nat_rule *rules; /* Rules array */
+	uint32_t nb_rules;	/* Number of rules in the set */
+	uint32_t size;		/* Allocated number of rules */
+};
+
+/*
+ * Rule callback of the rules stream
+ *
+ * @rule [in]: parsed rule
+ * @ctx [in]: user context
+ * @return: DOCA_SUCCESS to continue and DOCA_ERROR to stop the stream
+ */
+typedef doca_error_t (*nat_rule_cb)(const struct nat_rule_match *rule, void *ctx);
+
+/*
+ * Rule set callback
+ *
+ * @rule [in]: rule of the set
+ * @ctx [in]: user context
+ */
+typedef void (*nat_rule_set_cb)(struct nat_rule *rule, void *ctx);
+
+/*
+ * Read a rules file as a stream and call a callback for every rule. In PAT mode the "global ip" must come before the
+ * "rules" array.
+ *
+ * @file_path [in]: json rules file path
+ * @mode [in]: nat mode, static or PAT
+ * @cb [in]: callback of every rule
+ * @ctx [in]: user context of the callback
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t nat_rules_stream(const char *file_path, enum nat_mode mode, nat_rule_cb cb, void *ctx);
+
+/*
+ * Append a rule to a set, the set must be sorted before it is used
+ *
+ * @set [in]: rule set
+ * @match [in]: rule definition
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t nat_rule_set_append(struct nat_rule_set *set, const struct nat_rule_match *match);
+
+/*
+ * Sort a set and check that no two rules match the same LAN or WAN traffic
+ *
+ * @set [in]: rule set
+ * @mode [in]: nat mode, static or PAT
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_INVALID_VALUE if two rules conflict
+ */
+doca_error_t nat_rule_set_sort(struct nat_rule_set *set, enum nat_mode mode);
+
+/*
+ * Call a callback for every rule of a set that is missing from another set, both sets must be sorted
+ *
+ * @set [in]: rule set to walk
+ * @other [in]: rule set to compare with
+ * @cb [in]: callback of every missing rule
+ * @ctx [in]: user context of the callback
+ */
+void nat_rule_set_foreach_missing(struct nat_rule_set *set, const struct nat_rule_set *other, nat_rule_set_cb cb,
+				  void *ctx);
+
+/*
+ * Move the entries of the rules found in both sets from one set to the other, both sets must be sorted
+ *
+ * @from [in]: rule set that owns the entries
+ * @to [in]: rule set that takes the entries
+ */
+void nat_rule_set_move_entries(struct nat_rule_set *from, struct nat_rule_set *to);
+
+/*
+ * Free the rules of a set
+ *
+ * @set [in]: rule set
+ */
+void nat_rule_set_free(struct nat_rule_set *set);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NAT_RULES_H_ */
@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <netinet/in.h>
+#include <string.h>
+
+#include "nat_xlat.h"
+
+#define IPV6_VERSION 6			/* Version field of an IPv6 header */
+#define IPV4_VERSION 4			/* Version field of an IPv4 header */
+#define IPV4_DF 0x40			/* Don't Fragment flag, in the first byte of the flags field */
+#define IPV4_FRAG_MASK 0x3fff		/* More Fragments flag and fragment offset */
+#define IPV4_MAX_FRAGMENTABLE 1260	/* Largest translated IPv4 packet sent without DF (RFC 7915) */
+#define TCP_HDR_LEN 20			/* Length of a TCP header without options */
+#define UDP_HDR_LEN 8			/* Length of a UDP header */
+#define ICMP_ECHO_HDR_LEN 8		/* Length of an ICMP echo header */
+#define TCP_CSUM_OFFSET 16		/* Offset of the TCP checksum */
+#define UDP_CSUM_OFFSET 6		/* Offset of the UDP checksum */
+#define ICMP_CSUM_OFFSET 2		/* Offset of the ICMP checksum */
+#define ICMP_ID_OFFSET 4		/* Offset of the ICMP echo identifier */
+#define ICMP_ECHO_REPLY 0		/* ICMPv4 echo reply type */
+#define ICMP_ECHO_REQUEST 8		/* ICMPv4 echo request type */
+#define ICMPV6_ECHO_REQUEST 128		/* ICMPv6 echo request type */
+#define ICMPV6_ECHO_REPLY 129		/* ICMPv6 echo reply type */
+#define NPTV6_SUBNET_OFFSET 6		/* Offset of the subnet word that carries the NPTv6 adjustment */
+
+/*
+ * Read a 16 bits word as it is in memory
+ *
+ * @p [in]: word address
+ * @return: the word
+ */
+static inline uint16_t
+get_word(const uint8_t *p)
+{
+	uint16_t word;
+
+	memcpy(&word, p, sizeof(word));
+	return word;
+}
+
+/*
+ * Write a 16 bits word as it is in memory
+ *
+ * @p [in]: word address
+ * @word [in]: the word
+ */
+static inline void
+put_word(uint8_t *p, uint16_t word)
+{
+	memcpy(p, &word, sizeof(word));
+}
+
+/*
+ * Add a buffer to a one's complement sum. The words are summed as they are in memory, the sum is in the byte order of
+ * the checksums it updates.
+ *
+ * @sum [in]: current sum
+ * @buf [in]: buffer
+ * @len [in]: buffer length
+ * @return: new sum, not folded
+ */
+static uint32_t
+csum_add(uint32_t sum, const uint8_t *buf, size_t len)
+{
+	uint8_t last[2] = {0};
+
+	for (; len >= 2; buf += 2, len -= 2)
+		sum += get_word(buf);
+	if (len > 0) {
+		last[0] = *buf;
+		sum += get_word(last);
+	}
+	return sum;
+}
+
+/*
+ * Fold a one's complement sum to 16 bits
+ *
+ * @sum [in]: sum
+ * @return: folded sum
+ */
+static inline uint16_t
+csum_fold(uint32_t sum)
+{
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return sum;
+}
+
+/*
+ * Update a checksum for replaced data (RFC 1624)
+ *
+ * @csum [in]: checksum to update
+ * @old_sum [in]: one's complement sum of the replaced data
+ * @new_sum [in]: one's complement sum of the new data
+ * @return: updated checksum
+ */
+static inline uint16_t
+csum_update(uint16_t csum, uint32_t old_sum, uint32_t new_sum)
+{
+	return ~csum_fold((uint16_t)~csum + (uint32_t)(uint16_t)~csum_fold(old_sum) + csum_fold(new_sum));
+}
+
+/*
+ * Add the length and next header of an IPv6 pseudo header to a one's complement sum
+ *
+ * @sum [in]: current sum
+ * @l4_len [in]: upper layer length
+ * @next_header [in]: upper layer protocol
+ * @return: new sum, not folded
+ */
+static inline uint32_t
+csum_add_ipv6_pseudo(uint32_t sum, uint16_t l4_len, uint8_t next_header)
+{
+	uint8_t pseudo[8] = {0, 0, l4_len >> 8, l4_len & 0xff, 0, 0, 0, next_header};
+
+	return csum_add(sum, pseudo, sizeof(pseudo));
+}
+
+doca_error_t
+nat_nptv6_init(const uint8_t *internal, const uint8_t *external, uint8_t prefix_len, struct nat_nptv6 *npt)
+{
+	uint16_t internal_sum, external_sum;
+	int i;
+
+	if (prefix_len == 0 || prefix_len > NAT_XLAT_NPTV6_MAX_PREFIX)
+		return DOCA_ERROR_INVALID_VALUE;
+
+	memset(npt, 0, sizeof(*npt));
+	for (i = 0; i < NAT_XLAT_IPV6_ADDR_LEN; i++) {
+		if (prefix_len >= (i + 1) * 8)
+			npt->mask[i] = 0xff;
+		else if (prefix_len > i * 8)
+			npt->mask[i] = 0xff << ((i + 1) * 8 - prefix_len);
+		npt->internal[i] = internal[i] & npt->mask[i];
+		npt->external[i] = external[i] & npt->mask[i];
+	}
+	npt->prefix_len = prefix_len;
+
+	/* The subnet word gets the difference of the prefixes sums, the sum of the address does not change */
+	internal_sum = csum_fold(csum_add(0, npt->internal, NPTV6_SUBNET_OFFSET));
+	external_sum = csum_fold(csum_add(0, npt->external, NPTV6_SUBNET_OFFSET));
+	npt->adjustment = csum_fold((uint32_t)internal_sum + (uint16_t)~external_sum);
+	return DOCA_SUCCESS;
+}
+
+bool
+nat_nptv6_match(const struct nat_nptv6 *npt, const uint8_t *addr, bool outbound)
+{
+	const uint8_t *prefix = outbound ? npt->internal : npt->external;
+	int i;
+
+	for (i = 0; i < NPTV6_SUBNET_OFFSET; i++) {
+		if ((addr[i] & npt->mask[i]) != prefix[i])
+			return false;
+	}
+	return true;
+}
+
+doca_error_t
+nat_nptv6_translate(const struct nat_nptv6 *npt, uint8_t *addr, bool outbound)
+{
+	const uint8_t *prefix = outbound ? npt->internal : npt->external;
+	const uint8_t *new_prefix = outbound ? npt->external : npt->internal;
+	uint16_t subnet = get_word(addr + NPTV6_SUBNET_OFFSET);
+	uint16_t adjustment = outbound ? npt->adjustment : (uint16_t)~npt->adjustment;
+	int i;
+
+	/* 0xffff and 0 are the same one's complement value, the 0xffff subnet can not be translated back */
+	if (subnet == 0xffff)
+		return DOCA_ERROR_NOT_SUPPORTED;
+
+	for (i = 0; i < NPTV6_SUBNET_OFFSET; i++) {
+		if ((addr[i] & npt->mask[i]) != prefix[i])
+			return DOCA_ERROR_INVALID_VALUE;
+		addr[i] = (addr[i] & ~npt->mask[i]) | new_prefix[i];
+	}
+	subnet = csum_fold((uint32_t)subnet + adjustment);
+	put_word(addr + NPTV6_SUBNET_OFFSET, subnet == 0xffff ? 0 : subnet);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Parse the L4 header of a packet that NAT64 can translate
+ *
+ * @l4 [in]: L4 header
+ * @proto [in]: L4 protocol
+ * @flow [in/out]: flow of the packet, its L4 length is set
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_NOT_SUPPORTED for a packet that is not translated
+ */
+static doca_error_t
+parse_l4(const uint8_t *l4, uint8_t proto, struct nat_xlat_flow *flow)
+{
+	flow->proto = proto;
+	switch (proto) {
+	case IPPROTO_TCP:
+		if (flow->l4_len < TCP_HDR_LEN)
+			return DOCA_ERROR_NOT_SUPPORTED;
+		break;
+	case IPPROTO_UDP:
+		if (flow->l4_len < UDP_HDR_LEN)
+			return DOCA_ERROR_NOT_SUPPORTED;
+		break;
+	case IPPROTO_ICMP:
+		if (flow->l4_len < ICMP_ECHO_HDR_LEN || (l4[0] != ICMP_ECHO_REQUEST && l4[0] != ICMP_ECHO_REPLY))
+			return DOCA_ERROR_NOT_SUPPORTED;
+		flow->src_port = get_word(l4 + ICMP_ID_OFFSET);
+		flow->dst_port = flow->src_port;
+		return DOCA_SUCCESS;
+	case IPPROTO_ICMPV6:
+		if (flow->l4_len < ICMP_ECHO_HDR_LEN || (l4[0] != ICMPV6_ECHO_REQUEST && l4[0] != ICMPV6_ECHO_REPLY))
+			return DOCA_ERROR_NOT_SUPPORTED;
+		flow->src_port = get_word(l4 + ICMP_ID_OFFSET);
+		flow->dst_port = flow->src_port;
+		return DOCA_SUCCESS;
+	default:
+		return DOCA_ERROR_NOT_SUPPORTED;
+	}
+	flow->src_port = get_word(l4);
+	flow->dst_port = get_word(l4 + 2);
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+nat_xlat_parse_ipv6(const uint8_t *l3, size_t len, struct nat_xlat_flow *flow)
+{
+	doca_error_t result;
+
+	if (len < NAT_XLAT_IPV6_HDR_LEN || (l3[0] >> 4) != IPV6_VERSION)
+		return DOCA_ERROR_NOT_SUPPORTED;
+
+	/* Extension headers, and so fragments, are not translated */
+	flow->l3_hdr_len = NAT_XLAT_IPV6_HDR_LEN;
+	flow->l4_len = (l3[4] << 8) | l3[5];
+	if (NAT_XLAT_IPV6_HDR_LEN + (size_t)flow->l4_len > len)
+		return DOCA_ERROR_NOT_SUPPORTED;
+	flow->src_ip = l3 + 8;
+	flow->dst_ip = l3 + 24;
+	if (l3[6] == IPPROTO_ICMP)
+		return DOCA_ERROR_NOT_SUPPORTED;
+	result = parse_l4(l3 + NAT_XLAT_IPV6_HDR_LEN, l3[6], flow);
+	/* A zero UDP checksum is invalid over IPv6 (RFC 8200), it can not be updated */
+	if (result == DOCA_SUCCESS && flow->proto == IPPROTO_UDP &&
+	    get_word(l3 + NAT_XLAT_IPV6_HDR_LEN + UDP_CSUM_OFFSET) == 0)
+		return DOCA_ERROR_NOT_SUPPORTED;
+	return result;
+}
+
+doca_error_t
+nat_xlat_parse_ipv4(const uint8_t *l3, size_t len, struct nat_xlat_flow *flow)
+{
+	uint16_t total_len;
+
+	if (len < NAT_XLAT_IPV4_HDR_LEN || (l3[0] >> 4) != IPV4_VERSION)
+		return DOCA_ERROR_NOT_SUPPORTED;
+
+	flow->l3_hdr_len = (l3[0] & 0x0f) * 4;
+	total_len = (l3[2] << 8) | l3[3];
+	if (flow->l3_hdr_len < NAT_XLAT_IPV4_HDR_LEN || total_len < flow->l3_hdr_len || total_len > len)
+		return DOCA_ERROR_NOT_SUPPORTED;
+	/* Fragments are not translated */
+	if ((((l3[6] << 8) | l3[7]) & IPV4_FRAG_MASK) != 0)
+		return DOCA_ERROR_NOT_SUPPORTED;
+	flow->l4_len = total_len - flow->l3_hdr_len;
+	flow->src_ip = l3 + 12;
+	flow->dst_ip = l3 + 16;
+	if (l3[9] == IPPROTO_ICMPV6)
+		return DOCA_ERROR_NOT_SUPPORTED;
+	return parse_l4(l3 + flow->l3_hdr_len, l3[9], flow);
+}
+
+doca_error_t
+nat64_ipv6_to_ipv4(uint8_t *l3, const struct nat_xlat_flow *flow, uint32_t src_ip, uint16_t src_port,
+		   uint16_t ip_id, uint8_t **new_l3, size_t *new_len)
+{
+	uint8_t addrs[2 * NAT_XLAT_IPV6_ADDR_LEN];
+	uint8_t *l4 = l3 + NAT_XLAT_IPV6_HDR_LEN;
+	uint8_t *ipv4 = l3 + NAT_XLAT_IPV6_HDR_LEN - NAT_XLAT_IPV4_HDR_LEN;
+	uint8_t tos = (l3[0] << 4) | (l3[1] >> 4);
+	uint8_t hop_limit = l3[7];
+	uint16_t total_len = NAT_XLAT_IPV4_HDR_LEN + flow->l4_len;
+	uint32_t old_sum, new_sum;
+	uint16_t csum;
+	int csum_offset;
+
+	/* The translator forwards the packet, the hop limit is decremented */
+	if (hop_limit <= 1)
+		return DOCA_ERROR_NOT_SUPPORTED;
+
+	/* The IPv4 header overwrites the end of the IPv6 addresses */
+	memcpy(addrs, l3 + 8, sizeof(addrs));
+	old_sum = csum_add(0, addrs, sizeof(addrs));
+
+	if (flow->proto == IPPROTO_ICMPV6) {
+		/* ICMPv4 has no pseudo header */
+		csum_offset = ICMP_CSUM_OFFSET;
+		old_sum = csum_add_ipv6_pseudo(old_sum, flow->l4_len, IPPROTO_ICMPV6);
+		old_sum = csum_add(old_sum, l4, 2) + get_word(l4 + ICMP_ID_OFFSET);
+		l4[0] = l4[0] == ICMPV6_ECHO_REQUEST ? ICMP_ECHO_REQUEST : ICMP_ECHO_REPLY;
+		put_word(l4 + ICMP_ID_OFFSET, src_port);
+		new_sum = (uint32_t)get_word(l4) + src_port;
+	} else {
+		/* The lengths and protocols of the pseudo headers have the same sum */
+		csum_offset = flow->proto == IPPROTO_TCP ? TCP_CSUM_OFFSET : UDP_CSUM_OFFSET;
+		old_sum += get_word(l4);
+		put_word(l4, src_port);
+		new_sum = csum_add((uint32_t)src_port + (src_ip & 0xffff) + (src_ip >> 16), addrs + 28, 4);
+	}
+
+	/* UDP checksum is mandatory over IPv6, it is never zero here */
+	csum = csum_update(get_word(l4 + csum_offset), old_sum, new_sum);
+	if (flow->proto == IPPROTO_UDP && csum == 0)
+		csum = 0xffff;
+	put_word(l4 + csum_offset, csum);
+
+	ipv4[0] = (IPV4_VERSION << 4) | (NAT_XLAT_IPV4_HDR_LEN / 4);
+	ipv4[1] = tos;
+	ipv4[2] = total_len >> 8;
+	ipv4[3] = total_len & 0xff;
+	if (total_len > IPV4_MAX_FRAGMENTABLE) {
+		put_word(ipv4 + 4, 0);
+		ipv4[6] = IPV4_DF;
+	} else {
+		put_word(ipv4 + 4, ip_id);
+		ipv4[6] = 0;
+	}
+	ipv4[7] = 0;
+	ipv4[8] = hop_limit - 1;
+	ipv4[9] = flow->proto == IPPROTO_ICMPV6 ? IPPROTO_ICMP : flow->proto;
+	put_word(ipv4 + 10, 0);
+	memcpy(ipv4 + 12, &src_ip, sizeof(src_ip));
+	memcpy(ipv4 + 16, addrs + 28, 4);
+	put_word(ipv4 + 10, ~csum_fold(csum_add(0, ipv4, NAT_XLAT_IPV4_HDR_LEN)));
+
+	*new_l3 = ipv4;
+	*new_len = total_len;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+nat64_ipv4_to_ipv6(uint8_t *l3, const struct nat_xlat_flow *flow, const uint8_t *prefix, const uint8_t *dst_ip,
+		   uint16_t dst_port, uint8_t **new_l3, size_t *new_len)
+{
+	uint8_t addrs[2 * NAT_XLAT_IPV6_ADDR_LEN];
+	uint8_t *l4 = l3 + flow->l3_hdr_len;
+	uint8_t *ipv6 = l4 - NAT_XLAT_IPV6_HDR_LEN;
+	uint8_t tos = l3[1];
+	uint8_t ttl = l3[8];
+	uint8_t next_header = flow->proto == IPPROTO_ICMP ? IPPROTO_ICMPV6 : flow->proto;
+	uint32_t old_sum, new_sum;
+	uint16_t csum;
+	int csum_offset;
+
+	if (ttl <= 1)
+		return DOCA_ERROR_NOT_SUPPORTED;
+
+	memcpy(addrs, prefix, NAT_XLAT_NAT64_PREFIX_LEN);
+	memcpy(addrs + NAT_XLAT_NAT64_PREFIX_LEN, l3 + 12, 4);
+	memcpy(addrs + NAT_XLAT_IPV6_ADDR_LEN, dst_ip, NAT_XLAT_IPV6_ADDR_LEN);
+	new_sum = csum_add(0, addrs, sizeof(addrs));
+
+	if (flow->proto == IPPROTO_ICMP) {
+		/* ICMPv6 adds the pseudo header */
+		csum_offset = ICMP_CSUM_OFFSET;
+		old_sum = (uint32_t)get_word(l4) + get_word(l4 + ICMP_ID_OFFSET);
+		l4[0] = l4[0] == ICMP_ECHO_REQUEST ? ICMPV6_ECHO_REQUEST : ICMPV6_ECHO_REPLY;
+		put_word(l4 + ICMP_ID_OFFSET, dst_port);
+		new_sum = csum_add_ipv6_pseudo(new_sum, flow->l4_len, IPPROTO_ICMPV6) + get_word(l4) + dst_port;
+	} else {
+		csum_offset = flow->proto == IPPROTO_TCP ? TCP_CSUM_OFFSET : UDP_CSUM_OFFSET;
+		old_sum = csum_add(get_word(l4 + 2), l3 + 12, 8);
+		put_word(l4 + 2, dst_port);
+		new_sum += dst_port;
+	}
+
+	csum = get_word(l4 + csum_offset);
+	if (flow->proto == IPPROTO_UDP && csum == 0) {
+		/* A UDP checksum is optional over IPv4 only, it is computed for IPv6 */
+		new_sum = csum_add_ipv6_pseudo(csum_add(0, addrs, sizeof(addrs)), flow->l4_len, IPPROTO_UDP);
+		csum = ~csum_fold(csum_add(new_sum, l4, flow->l4_len));
+	} else
+		csum = csum_update(csum, old_sum, new_sum);
+	if (flow->proto == IPPROTO_UDP && csum == 0)
+		csum = 0xffff;
+	put_word(l4 + csum_offset, csum);
+
+	/* IPv4 options are dropped, the IPv6 header ends where the IPv4 header did */
+	ipv6[0] = (IPV6_VERSION << 4) | (tos >> 4);
+	ipv6[1] = (tos & 0x0f) << 4;
+	ipv6[2] = 0;
+	ipv6[3] = 0;
+	ipv6[4] = flow->l4_len >> 8;
+	ipv6[5] = flow->l4_len & 0xff;
+	ipv6[6] = next_header;
+	ipv6[7] = ttl - 1;
+	memcpy(ipv6 + 8, addrs, sizeof(addrs));
+
+	*new_l3 = ipv6;
+	*new_len = NAT_XLAT_IPV6_HDR_LEN + flow->l4_len;
+	return DOCA_SUCCESS;
+}
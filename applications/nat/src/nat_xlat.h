@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef NAT_XLAT_H_
+#define NAT_XLAT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * IPv6 packet translators of the NPTV6 and NAT64 modes. They work in place on the IP header and payload of a
+ * packet held in one contiguous buffer, without any DPDK or DOCA Flow dependency.
+ *
+ * NPTv6 (RFC 6296) maps an internal prefix of at most 48 bits to an external prefix of the same length and adjusts
+ * the 16 bits subnet word so the one's complement sum of the address does not change, the L4 checksums stay valid.
+ * NAT64 (RFC 6146 and RFC 7915) replaces the IPv6 header with an IPv4 header and back, the IPv4 address of the remote
+ * host is embedded in the last 32 bits of a /96 prefix (RFC 6052). TCP, UDP and ICMP echo are translated, their
+ * checksums are updated incrementally.
+ */
+
+#define NAT_XLAT_IPV6_ADDR_LEN 16	/* Length of an IPv6 address */
+#define NAT_XLAT_IPV4_HDR_LEN 20	/* Length of an IPv4 header without options */
+#define NAT_XLAT_IPV6_HDR_LEN 40	/* Length of an IPv6 header */
+#define NAT_XLAT_HEADROOM 20		/* Room needed before the IPv4 header to translate it to IPv6 */
+#define NAT_XLAT_NPTV6_MAX_PREFIX 48	/* Longest NPTv6 prefix, the subnet word carries the adjustment */
+#define NAT_XLAT_NAT64_PREFIX_LEN 12	/* Length of the NAT64 /96 prefix */
+
+/* NPTv6 mapping of an internal prefix to an external prefix */
+struct nat_nptv6 {
+	uint8_t internal[NAT_XLAT_IPV6_ADDR_LEN]; /* Internal prefix, the bits after the prefix are zero */
+	uint8_t external[NAT_XLAT_IPV6_ADDR_LEN]; /* External prefix, the bits after the prefix are zero */
+	uint8_t mask[NAT_XLAT_IPV6_ADDR_LEN];	  /* Mask of the prefix bits */
+	uint8_t prefix_len;			  /* Prefix length in bits */
+	uint16_t adjustment;			  /* One's complement value added to the subnet word outbound */
+};
+
+/* Flow of a packet, the ports and addresses are in network byte order */
+struct nat_xlat_flow {
+	const uint8_t *src_ip;	/* Source address in the packet */
+	const uint8_t *dst_ip;	/* Destination address in the packet */
+	uint16_t src_port;	/* Source port, or identifier of an ICMP echo */
+	uint16_t dst_port;	/* Destination port, or identifier of an ICMP echo */
+	uint8_t proto;		/* IPPROTO_TCP, IPPROTO_UDP, IPPROTO_ICMP or IPPROTO_ICMPV6 */
+	uint16_t l3_hdr_len;	/* Length of the IP header */
+	uint16_t l4_len;	/* Length of the L4 header and payload */
+};
+
+/*
+ * Create an NPTv6 mapping
+ *
+ * @internal [in]: internal prefix
+ * @external [in]: external prefix
+ * @prefix_len [in]: length of both prefixes, 1 to NAT_XLAT_NPTV6_MAX_PREFIX bits
+ * @npt [out]: the mapping
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_INVALID_VALUE for an unsupported prefix length
+ */
+doca_error_t nat_nptv6_init(const uint8_t *internal, const uint8_t *external, uint8_t prefix_len,
+			    struct nat_nptv6 *npt);
+
+/*
+ * Check if an address is in the internal or the external prefix of an NPTv6 mapping
+ *
+ * @npt [in]: the mapping
+ * @addr [in]: IPv6 address
+ * @outbound [in]: true to check the internal prefix, false for the external prefix
+ * @return: true if the address is in the prefix
+ */
+bool nat_nptv6_match(const struct nat_nptv6 *npt, const uint8_t *addr, bool outbound);
+
+/*
+ * Translate an address of an NPTv6 mapping, only the prefix and the subnet word change
+ *
+ * @npt [in]: the mapping
+ * @addr [in/out]: IPv6 address in the internal (outbound) or external (inbound) prefix
+ * @outbound [in]: true to translate from internal to external, false for the other way
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_NOT_SUPPORTED for the 0xffff subnet, which has no translation
+ */
+doca_error_t nat_nptv6_translate(const struct nat_nptv6 *npt, uint8_t *addr, bool outbound);
+
+/*
+ * Parse the flow of an IPv6 packet that NAT64 can translate
+ *
+ * @l3 [in]: IPv6 header
+ * @len [in]: length of the buffer from the IPv6 header
+ * @flow [out]: flow of the packet
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_NOT_SUPPORTED for a packet that is not translated
+ */
+doca_error_t nat_xlat_parse_ipv6(const uint8_t *l3, size_t len, struct nat_xlat_flow *flow);
+
+/*
+ * Parse the flow of an IPv4 packet that NAT64 can translate
+ *
+ * @l3 [in]: IPv4 header
+ * @len [in]: length of the buffer from the IPv4 header
+ * @flow [out]: flow of the packet
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_NOT_SUPPORTED for a packet that is not translated
+ */
+doca_error_t nat_xlat_parse_ipv4(const uint8_t *l3, size_t len, struct nat_xlat_flow *flow);
+
+/*
+ * Translate a parsed IPv6 packet to IPv4 in place, the IPv4 header starts 20 bytes after the IPv6 header
+ *
+ * @l3 [in]: IPv6 header
+ * @flow [in]: flow of the packet from nat_xlat_parse_ipv6()
+ * @src_ip [in]: IPv4 source address
+ * @src_port [in]: source port, or identifier of an ICMP echo
+ * @ip_id [in]: IPv4 identification of a packet that can be fragmented
+ * @new_l3 [out]: IPv4 header
+ * @new_len [out]: length of the IPv4 packet
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_NOT_SUPPORTED when the hop limit expires
+ */
+doca_error_t nat64_ipv6_to_ipv4(uint8_t *l3, const struct nat_xlat_flow *flow, uint32_t src_ip, uint16_t src_port,
+				uint16_t ip_id, uint8_t **new_l3, size_t *new_len);
+
+/*
+ * Translate a parsed IPv4 packet to IPv6 in place, the buffer must have NAT_XLAT_HEADROOM bytes before the IPv4
+ * header. The source address is the IPv4 source embedded in the NAT64 prefix.
+ *
+ * @l3 [in]: IPv4 header
+ * @flow [in]: flow of the packet from nat_xlat_parse_ipv4()
+ * @prefix [in]: NAT64 /96 prefix
+ * @dst_ip [in]: IPv6 destination address
+ * @dst_port [in]: destination port, or identifier of an ICMP echo
+ * @new_l3 [out]: IPv6 header
+ * @new_len [out]: length of the IPv6 packet
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR_NOT_SUPPORTED when the TTL expires
+ */
+doca_error_t nat64_ipv4_to_ipv6(uint8_t *l3, const struct nat_xlat_flow *flow, const uint8_t *prefix,
+				const uint8_t *dst_ip, uint16_t dst_port, uint8_t **new_l3, size_t *new_len);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NAT_XLAT_H_ */
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * DCQCN reaction point (Zhu et al., "Congestion Control for Large-Scale RDMA Deployments", SIGCOMM 2015).
+ * A CNP cuts the rate by alpha / 2 and remembers the rate before the cut as the target rate. The rate then recovers
+ * towards the target rate on every expiration of the rate increase timer or of the byte counter: the first
+ * STAGE_THRESH expirations only halve the distance to the target (fast recovery), after that the target itself
+ * increases by AI (additive increase) and, once both the timer and the byte counter passed STAGE_THRESH, by HAI per
+ * stage (hyper increase). Alpha decays every ALPHA_TIMER without a CNP.
+ * The timers run on the timestamps of the TX events, so no timer event is needed.
+ */
+
+#include <doca_pcc_dev.h>
+#include <doca_pcc_dev_event.h>
+#include <doca_pcc_dev_algo_access.h>
+
+#include "utils.h"
+#include "dcqcn_ctxt.h"
+#include "dcqcn_algo_params.h"
+
+#pragma clang diagnostic ignored "-Wunused-parameter"
+
+#define DCQCN_MAX_ALPHA_DECAYS (16) /* Alpha decay periods applied at once, after a longer idle time alpha is reset */
+
+typedef enum {
+	DCQCN_G             = 0,    /* configurable parameter of alpha update gain */
+	DCQCN_AI            = 1,    /* configurable parameter of additive increase */
+	DCQCN_HAI           = 2,    /* configurable parameter of hyper increase */
+	DCQCN_ALPHA_TIMER   = 3,    /* configurable parameter of alpha decay period */
+	DCQCN_RATE_TIMER    = 4,    /* configurable parameter of rate increase timer */
+	DCQCN_BYTE_RESET    = 5,    /* configurable parameter of rate increase byte counter */
+	DCQCN_STAGE_THRESH  = 6,    /* configurable parameter of fast recovery stages */
+	DCQCN_NEW_FLOW_RATE = 7,    /* configurable parameter of new flow rate */
+	DCQCN_MIN_RATE      = 8,    /* configurable parameter of min rate */
+	DCQCN_PARAM_NUM             /* Maximal number of configurable parameters */
+} dcqcn_params_t;
+
+enum {
+	DCQCN_COUNTER_CNP_EVENT     = 0, /* cnp event for dcqcn user algorithm */
+	DCQCN_COUNTER_RATE_INCREASE = 1, /* rate increases of dcqcn user algorithm */
+	DCQCN_COUNTER_NUM                /* Maximal number of counters */
+} dcqcn_counter_t;
+
+const volatile char dcqcn_desc[]                            = "DCQCN v0.1";
+static const volatile char dcqcn_param_g_desc[]             = "G, alpha update gain";
+static const volatile char dcqcn_param_ai_desc[]            = "AI, additive increase";
+static const volatile char dcqcn_param_hai_desc[]           = "HAI, hyper increase";
+static const volatile char dcqcn_param_alpha_timer_desc[]   = "ALPHA_TIMER, alpha decay period";
+static const volatile char dcqcn_param_rate_timer_desc[]    = "RATE_TIMER, rate increase timer";
+static const volatile char dcqcn_param_byte_reset_desc[]    = "BYTE_RESET, rate increase byte counter";
+static const volatile char dcqcn_param_stage_thresh_desc[]  = "STAGE_THRESH, fast recovery stages";
+static const volatile char dcqcn_param_new_flow_rate_desc[] = "NEW_FLOW_RATE, new flow rate";
+static const volatile char dcqcn_param_min_rate_desc[]      = "MIN_RATE, min rate";
+static const volatile char dcqcn_counter_cnp_desc[]         = "COUNTER_CNP_EVENT, number of cnp events handled";
+static const volatile char dcqcn_counter_increase_desc[]    = "COUNTER_RATE_INCREASE, number of rate increases";
+
+void
+dcqcn_init(uint32_t algo_idx)
+{
+	struct doca_pcc_dev_algo_meta_data algo_def = {0};
+
+	algo_def.algo_id = 0xBFFE;
+	algo_def.algo_major_version = 0x00;
+	algo_def.algo_minor_version = 0x01;
+	algo_def.algo_desc_size = sizeof(dcqcn_desc);
+	algo_def.algo_desc_addr = (uint64_t)dcqcn_desc;
+
+	uint32_t total_param_num = DCQCN_PARAM_NUM;
+	uint32_t total_counter_num = DCQCN_COUNTER_NUM;
+	uint32_t param_num = 0;
+	uint32_t counter_num = 0;
+
+	doca_pcc_dev_algo_init_metadata(algo_idx, &algo_def, total_param_num, total_counter_num);
+
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   DCQCN_DEFAULT_G,             DCQCN_G_MAX,            1, 1, sizeof(dcqcn_param_g_desc),             (uint64_t)dcqcn_param_g_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   DCQCN_DEFAULT_AI,            DCQCN_RATE_MAX,         1, 1, sizeof(dcqcn_param_ai_desc),            (uint64_t)dcqcn_param_ai_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   DCQCN_DEFAULT_HAI,           DCQCN_RATE_MAX,         1, 1, sizeof(dcqcn_param_hai_desc),           (uint64_t)dcqcn_param_hai_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   DCQCN_DEFAULT_ALPHA_TIMER,   UINT32_MAX,             1, 1, sizeof(dcqcn_param_alpha_timer_desc),   (uint64_t)dcqcn_param_alpha_timer_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   DCQCN_DEFAULT_RATE_TIMER,    UINT32_MAX,             1, 1, sizeof(dcqcn_param_rate_timer_desc),    (uint64_t)dcqcn_param_rate_timer_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   DCQCN_DEFAULT_BYTE_RESET,    UINT32_MAX,             1, 1, sizeof(dcqcn_param_byte_reset_desc),    (uint64_t)dcqcn_param_byte_reset_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   DCQCN_DEFAULT_STAGE_THRESH,  DCQCN_STAGE_THRESH_MAX, 1, 1, sizeof(dcqcn_param_stage_thresh_desc),  (uint64_t)dcqcn_param_stage_thresh_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   DCQCN_DEFAULT_NEW_FLOW_RATE, DCQCN_RATE_MAX,         1, 1, sizeof(dcqcn_param_new_flow_rate_desc), (uint64_t)dcqcn_param_new_flow_rate_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   DCQCN_DEFAULT_MIN_RATE,      DCQCN_RATE_MAX,         1, 1, sizeof(dcqcn_param_min_rate_desc),      (uint64_t)dcqcn_param_min_rate_desc);
+
+	doca_pcc_dev_algo_init_counter(algo_idx, counter_num++, UINT32_MAX, 2, sizeof(dcqcn_counter_cnp_desc), (uint64_t)dcqcn_counter_cnp_desc);
+	doca_pcc_dev_algo_init_counter(algo_idx, counter_num++, UINT32_MAX, 2, sizeof(dcqcn_counter_increase_desc), (uint64_t)dcqcn_counter_increase_desc);
+}
+
+/*
+ * Move the rate towards the target rate, after increasing the target rate according to the recovery stage
+ *
+ * @ccctx [in/out]: A pointer to a flow context data retrieved by libpcc.
+ * @param [in]: A pointer to an array of parameters that are used to control algo behavior
+ */
+static inline void
+dcqcn_rate_increase(cc_ctxt_dcqcn_t *ccctx, uint32_t *param)
+{
+	uint32_t max_stage = MAX(ccctx->timer_stage, ccctx->byte_stage);
+	uint32_t min_stage = MIN(ccctx->timer_stage, ccctx->byte_stage);
+	uint64_t target_rate = ccctx->target_rate;
+
+	if (min_stage > param[DCQCN_STAGE_THRESH])
+		target_rate += doca_pcc_dev_mult(min_stage - param[DCQCN_STAGE_THRESH], param[DCQCN_HAI]);
+	else if (max_stage >= param[DCQCN_STAGE_THRESH])
+		target_rate += param[DCQCN_AI];
+
+	if (target_rate > DOCA_PCC_DEV_MAX_RATE)
+		target_rate = DOCA_PCC_DEV_MAX_RATE;
+
+	ccctx->target_rate = (uint32_t)target_rate;
+	ccctx->cur_rate = (ccctx->cur_rate + ccctx->target_rate) >> 1;
+}
+
+/*
+ * Handle a roce tx event: decay alpha and run the rate increase timer and byte counter
+ *
+ * @event [in]: A pointer to an event data structure to be passed to extractor functions
+ * @param [in]: A pointer to an array of parameters that are used to control algo behavior
+ * @counter [in/out]: A pointer to an array of counters that are incremented by algo
+ * @ccctx [in/out]: A pointer to a flow context data retrieved by libpcc.
+ * @results [out]: A pointer to result struct to update rate in HW.
+ */
+static inline void
+dcqcn_handle_roce_tx(doca_pcc_dev_event_t *event, uint32_t *param, uint32_t *counter, cc_ctxt_dcqcn_t *ccctx,
+			doca_pcc_dev_results_t *results)
+{
+	uint32_t timestamp = doca_pcc_dev_get_timestamp(event);
+	uint32_t elapsed = timestamp - ccctx->alpha_timestamp;
+	uint32_t increases = 0;
+
+	/* Alpha decays once per alpha timer period without a CNP */
+	if (elapsed >= param[DCQCN_ALPHA_TIMER]) {
+		uint32_t periods = elapsed / param[DCQCN_ALPHA_TIMER];
+		uint32_t alpha = ccctx->alpha;
+
+		if (periods > DCQCN_MAX_ALPHA_DECAYS) {
+			alpha = 0;
+			ccctx->alpha_timestamp = timestamp;
+		} else {
+			ccctx->alpha_timestamp += periods * param[DCQCN_ALPHA_TIMER];
+			while (periods-- > 0)
+				alpha = doca_pcc_dev_fxp_mult((1 << 16) - param[DCQCN_G], alpha);
+		}
+		ccctx->alpha = alpha;
+	}
+
+	if ((timestamp - ccctx->timer_timestamp) >= param[DCQCN_RATE_TIMER]) {
+		ccctx->timer_timestamp = timestamp;
+		if (ccctx->timer_stage < UINT16_MAX)
+			ccctx->timer_stage++;
+		dcqcn_rate_increase(ccctx, param);
+		increases++;
+	}
+
+	ccctx->byte_cnt += doca_pcc_dev_get_roce_tx_cntrs(event).sent_32bytes << 5;
+	if (ccctx->byte_cnt >= param[DCQCN_BYTE_RESET]) {
+		ccctx->byte_cnt = 0;
+		if (ccctx->byte_stage < UINT16_MAX)
+			ccctx->byte_stage++;
+		dcqcn_rate_increase(ccctx, param);
+		increases++;
+	}
+
+	if (counter != NULL)
+		counter[DCQCN_COUNTER_RATE_INCREASE] += increases;
+
+	results->rate = ccctx->cur_rate;
+	results->rtt_req = 0;
+}
+
+/*
+ * Handle a roce cnp event: cut the rate and restart the recovery
+ *
+ * @event [in]: A pointer to an event data structure to be passed to extractor functions
+ * @param [in]: A pointer to an array of parameters that are used to control algo behavior
+ * @ccctx [in/out]: A pointer to a flow context data retrieved by libpcc.
+ * @results [out]: A pointer to result struct to update rate in HW.
+ */
+static inline void
+dcqcn_handle_roce_cnp(doca_pcc_dev_event_t *event, uint32_t *param, cc_ctxt_dcqcn_t *ccctx,
+			doca_pcc_dev_results_t *results)
+{
+	uint32_t timestamp = doca_pcc_dev_get_timestamp(event);
+	uint32_t cur_rate = ccctx->cur_rate;
+
+	ccctx->target_rate = cur_rate;
+	cur_rate = doca_pcc_dev_fxp_mult((1 << 16) - (ccctx->alpha >> 1), cur_rate);
+	if (cur_rate < param[DCQCN_MIN_RATE])
+		cur_rate = param[DCQCN_MIN_RATE];
+	ccctx->cur_rate = cur_rate;
+
+	ccctx->alpha = doca_pcc_dev_fxp_mult((1 << 16) - param[DCQCN_G], ccctx->alpha) + param[DCQCN_G];
+	ccctx->alpha_timestamp = timestamp;
+	ccctx->timer_timestamp = timestamp;
+	ccctx->byte_cnt = 0;
+	ccctx->timer_stage = 0;
+	ccctx->byte_stage = 0;
+
+	results->rate = cur_rate;
+	results->rtt_req = 0;
+}
+
+/*
+ * Handle a new flow: start at the new flow rate with the maximal congestion estimate
+ *
+ * @event [in]: A pointer to an event data structure to be passed to extractor functions
+ * @param [in]: A pointer to an array of parameters that are used to control algo behavior
+ * @ccctx [in/out]: A pointer to a flow context data retrieved by libpcc.
+ * @results [out]: A pointer to result struct to update rate in HW.
+ */
+static inline void
+dcqcn_handle_new_flow(doca_pcc_dev_event_t *event, uint32_t *param, cc_ctxt_dcqcn_t *ccctx,
+			doca_pcc_dev_results_t *results)
+{
+	uint32_t timestamp = doca_pcc_dev_get_timestamp(event);
+
+	ccctx->cur_rate = param[DCQCN_NEW_FLOW_RATE];
+	ccctx->target_rate = param[DCQCN_NEW_FLOW_RATE];
+	ccctx->alpha = 1 << 16;
+	ccctx->alpha_timestamp = timestamp;
+	ccctx->timer_timestamp = timestamp;
+	ccctx->byte_cnt = 0;
+	ccctx->timer_stage = 0;
+	ccctx->byte_stage = 0;
+	results->rate = param[DCQCN_NEW_FLOW_RATE];
+	results->rtt_req = 0;
+}
+
+void
+dcqcn_algo(doca_pcc_dev_event_t *event, uint32_t *param, uint32_t *counter, doca_pcc_dev_algo_ctxt_t *algo_ctxt,
+		doca_pcc_dev_results_t *results)
+{
+	cc_ctxt_dcqcn_t *dcqcn_ctx = (cc_ctxt_dcqcn_t *)algo_ctxt;
+	uint32_t ev_type = doca_pcc_dev_get_ev_attr(event).ev_type;
+
+	if (unlikely(dcqcn_ctx->cur_rate == 0)) {
+		dcqcn_handle_new_flow(event, param, dcqcn_ctx, results);
+	} else if (ev_type == DOCA_PCC_DEV_EVNT_ROCE_TX) {
+		dcqcn_handle_roce_tx(event, param, counter, dcqcn_ctx, results);
+	} else if (ev_type == DOCA_PCC_DEV_EVNT_ROCE_CNP) {
+		dcqcn_handle_roce_cnp(event, param, dcqcn_ctx, results);
+		if (counter != NULL)
+			counter[DCQCN_COUNTER_CNP_EVENT]++;
+	} else {
+		/* DCQCN only reacts to CNPs, NACKs and RTT responses keep the rate */
+		results->rate = dcqcn_ctx->cur_rate;
+		results->rtt_req = 0;
+	}
+}
+
+doca_pcc_dev_error_t
+dcqcn_set_algo_params(uint32_t param_id_base, uint32_t param_num, const uint32_t *new_param_values,
+			uint32_t *params)
+{
+	uint32_t i;
+
+	/* Zero values are rejected by the min value of the parameters, the periods can be used as divisors */
+	if ((param_num > DCQCN_PARAM_NUM) || (param_id_base >= DCQCN_PARAM_NUM) ||
+	    (param_id_base + param_num > DCQCN_PARAM_NUM))
+		return DOCA_PCC_DEV_STATUS_FAIL;
+
+	if ((new_param_values == NULL) || (params == NULL))
+		return DOCA_PCC_DEV_STATUS_FAIL;
+
+	for (i = 0; i < param_num; i++)
+		params[i] = new_param_values[i];
+
+	return DOCA_PCC_DEV_STATUS_OK;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef _DCQCN_ALGO_PARAMS_H_
+#define _DCQCN_ALGO_PARAMS_H_
+
+/* Configurable algorithm parameters, the defaults follow the DCQCN paper scaled to a 100Gb/s line rate */
+#define DCQCN_DEFAULT_G             ((1 << 16) / 256)          /* 1/256 in fxp16 - alpha update gain */
+#define DCQCN_DEFAULT_AI            (((1 << 20) * 5) / 1000)   /* 0.005 in fxp20 - additive increase of the target rate */
+#define DCQCN_DEFAULT_HAI           (((1 << 20) * 5) / 100)    /* 0.05 in fxp20 - hyper increase of the target rate */
+#define DCQCN_DEFAULT_ALPHA_TIMER   (55000)                    /* Alpha decay period - in nanosec */
+#define DCQCN_DEFAULT_RATE_TIMER    (55000)                    /* Rate increase timer period - in nanosec */
+#define DCQCN_DEFAULT_BYTE_RESET    (10 << 20)                 /* Rate increase byte counter period - in bytes */
+#define DCQCN_DEFAULT_STAGE_THRESH  (5)                        /* Number of fast recovery stages (F) */
+#define DCQCN_DEFAULT_NEW_FLOW_RATE (1 << 20)                  /* Rate format in fixed point 20 */
+#define DCQCN_DEFAULT_MIN_RATE      (1 << (20 - 14))           /* Rate format in fixed point 20 */
+
+#define DCQCN_G_MAX                 (1 << 16)                  /* Maximum value of G */
+#define DCQCN_STAGE_THRESH_MAX      (0xffff)                   /* Maximum value of the stage threshold */
+#define DCQCN_RATE_MAX              (1 << 20)                  /* Maximum value of rate */
+
+#endif /* _DCQCN_ALGO_PARAMS_H_ */
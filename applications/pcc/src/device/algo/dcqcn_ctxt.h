@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef DCQCN_CTXT_H_
+#define DCQCN_CTXT_H_
+
+typedef struct {
+	uint32_t cur_rate;           /* Current rate (RC) */
+	uint32_t target_rate;        /* Rate to recover to after a decrease (RT) */
+	uint32_t alpha;              /* Congestion estimate in fxp16 */
+	uint32_t alpha_timestamp;    /* The time of the last alpha update */
+	uint32_t timer_timestamp;    /* The time of the last rate increase timer expiration */
+	uint32_t byte_cnt;           /* Bytes sent since the last byte counter expiration */
+	uint16_t timer_stage;        /* Rate increase timer expirations since the last CNP */
+	uint16_t byte_stage;         /* Byte counter expirations since the last CNP */
+	uint32_t reserved[5];        /* Reserved bits */
+} cc_ctxt_dcqcn_t;
+
+#endif /* DCQCN_CTXT_H_ */
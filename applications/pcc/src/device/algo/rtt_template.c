@@ -24,10 +24,10 @@
 /* Algorithm parameters are defined in rtt_template_algo_params.h */
 
 /* Define the constants */
-#define DEC_FACTOR      ((1 << 16) - param[RTT_TEMPLATE_UPDATE_FACTOR])     /* Rate decrease factor */
-#define CNP_DEC_FACTOR  ((1 << 16) - 2 * param[RTT_TEMPLATE_UPDATE_FACTOR]) /* CNP rate decrease factor */
-#define NACK_DEC_FACTOR ((1 << 16) - 5 * param[RTT_TEMPLATE_UPDATE_FACTOR]) /* NACK rate decrease factor */
-#define ABORT_TIME      (300000)                                            /* The time to abort rtt_req - in nanosec */
+#define CNP_UPDATE_MULT  (2)       /* CNP rate decrease is CNP_UPDATE_MULT times the update factor */
+#define NACK_UPDATE_MULT (5)       /* NACK rate decrease is NACK_UPDATE_MULT times the update factor */
+#define ABORT_TIME       (300000)  /* The time to abort rtt_req - in nanosec */
+#define RTT_TEMPLATE_MAX_ABORT_CNT (13) /* Largest abort count for which ABORT_TIME << abort_cnt fits in 32 bits */
 
 typedef enum {
 	RTT_TEMPLATE_UPDATE_FACTOR = 0,     /* configurable parameter of update factor */
@@ -45,6 +45,23 @@ enum {
 	RTT_TEMPLATE_COUNTER_NUM            /* Maximal number of counters */
 } rtt_template_counter_t;
 
+/*
+ * Values that the algorithm uses on every event, derived from the parameters of a port.
+ * They are computed when the parameters change, so the event handlers never read the parameter array.
+ */
+typedef struct {
+	uint32_t dec_factor;      /* Rate decrease factor, in fxp16 */
+	uint32_t cnp_dec_factor;  /* CNP rate decrease factor, in fxp16 */
+	uint32_t nack_dec_factor; /* NACK rate decrease factor, in fxp16 */
+	uint32_t ai;              /* Additive increase, in fxp20 */
+	uint32_t base_rtt;        /* Base value of rtt - in nanosec */
+	uint32_t max_delay;       /* Maximum delay - in nanosec */
+	uint32_t min_rate;        /* Minimal rate, in fxp20 */
+	uint32_t new_flow_rate;   /* Rate of a new flow, in fxp20 */
+} rtt_template_consts_t;
+
+static rtt_template_consts_t rtt_template_consts[DOCA_PCC_DEV_MAX_NUM_PORTS];
+
 const volatile char rtt_template_desc[]                            = "Rtt template v0.1";
 static const volatile char rtt_template_param_update_factor_desc[] = "UPDATE_FACTOR, update factor";
 static const volatile char rtt_template_param_ai_desc[]            = "AI, ai";
@@ -55,9 +72,40 @@ static const volatile char rtt_template_param_max_delay_desc[]     = "MAX_DELAY,
 static const volatile char rtt_template_counter_tx_desc[]          = "COUNTER_TX_EVENT, number of tx events handled";
 static const volatile char rtt_template_counter_rtt_desc[]         = "COUNTER_RTT_EVENT, number of rtt events handled";
 
+/*
+ * Compute the values that the algorithm uses on every event from the parameters of a port
+ *
+ * @param [in]: A pointer to the full array of parameters of the port
+ * @consts [out]: The values derived from the parameters
+ */
+static void
+rtt_template_update_consts(const uint32_t *param, rtt_template_consts_t *consts)
+{
+	uint32_t update_factor = param[RTT_TEMPLATE_UPDATE_FACTOR];
+
+	consts->dec_factor = (1 << 16) - update_factor;
+	consts->cnp_dec_factor = (1 << 16) - CNP_UPDATE_MULT * update_factor;
+	consts->nack_dec_factor = (1 << 16) - NACK_UPDATE_MULT * update_factor;
+	consts->ai = param[RTT_TEMPLATE_AI];
+	consts->base_rtt = param[RTT_TEMPLATE_BASE_RTT];
+	consts->max_delay = param[RTT_TEMPLATE_MAX_DELAY];
+	consts->min_rate = param[RTT_TEMPLATE_MIN_RATE];
+	consts->new_flow_rate = param[RTT_TEMPLATE_NEW_FLOW_RATE];
+}
+
 void
 rtt_template_init(uint32_t algo_idx)
 {
+	const uint32_t default_param[RTT_TEMPLATE_PARAM_NUM] = {
+		[RTT_TEMPLATE_UPDATE_FACTOR] = UPDATE_FACTOR,
+		[RTT_TEMPLATE_AI] = AI,
+		[RTT_TEMPLATE_BASE_RTT] = BASE_RTT,
+		[RTT_TEMPLATE_NEW_FLOW_RATE] = NEW_FLOW_RATE,
+		[RTT_TEMPLATE_MIN_RATE] = MIN_RATE,
+		[RTT_TEMPLATE_MAX_DELAY] = MAX_DELAY,
+	};
+	uint32_t port_num;
+
 	struct doca_pcc_dev_algo_meta_data algo_def = {0};
 
 	algo_def.algo_id = 0xBFFF;
@@ -82,6 +130,9 @@ rtt_template_init(uint32_t algo_idx)
 
 	doca_pcc_dev_algo_init_counter(algo_idx, counter_num++, UINT32_MAX, 2, sizeof(rtt_template_counter_tx_desc), (uint64_t)rtt_template_counter_tx_desc);
 	doca_pcc_dev_algo_init_counter(algo_idx, counter_num++, UINT32_MAX, 2, sizeof(rtt_template_counter_rtt_desc), (uint64_t)rtt_template_counter_rtt_desc);
+
+	for (port_num = 0; port_num < DOCA_PCC_DEV_MAX_NUM_PORTS; port_num++)
+		rtt_template_update_consts(default_param, &rtt_template_consts[port_num]);
 }
 
 /*
@@ -92,36 +143,36 @@ rtt_template_init(uint32_t algo_idx)
  * @ccctx [in]: A pointer to a flow context data retrieved by libpcc.
  * @rtt [in]: The value of rtt.
  * @cur_rate [in]: Current rate value
- * @param [in]: A pointer to an array of parameters that are used to control algo behavior
+ * @consts [in]: The values derived from the parameters that control algo behavior
  * @return: The new calculated rate value
  */
 static inline uint32_t
-algorithm_core(cc_ctxt_rtt_template_t *ccctx, uint32_t rtt, uint32_t cur_rate, uint32_t *param)
+algorithm_core(cc_ctxt_rtt_template_t *ccctx, uint32_t rtt, uint32_t cur_rate, const rtt_template_consts_t *consts)
 {
 	/* ##### Put your algorithm code in here #### */
 
 	/* Example */
-	if (ccctx->flags.was_nack && (rtt >= param[RTT_TEMPLATE_MAX_DELAY])) {
+	if (ccctx->was_nack && (rtt >= consts->max_delay)) {
 		/* NACK */
-		cur_rate = doca_pcc_dev_fxp_mult(NACK_DEC_FACTOR, cur_rate);
-		ccctx->flags.was_nack = 0;
-	} else if (ccctx->flags.was_cnp || (rtt >= param[RTT_TEMPLATE_MAX_DELAY])) {
+		cur_rate = doca_pcc_dev_fxp_mult(consts->nack_dec_factor, cur_rate);
+		ccctx->was_nack = 0;
+	} else if (ccctx->was_cnp || (rtt >= consts->max_delay)) {
 		/* CNP */
-		cur_rate = doca_pcc_dev_fxp_mult(CNP_DEC_FACTOR, cur_rate);
-		ccctx->flags.was_cnp = 0;
+		cur_rate = doca_pcc_dev_fxp_mult(consts->cnp_dec_factor, cur_rate);
+		ccctx->was_cnp = 0;
 	} else {
 		/* RTT */
-		if (rtt > param[RTT_TEMPLATE_BASE_RTT])
-			cur_rate = doca_pcc_dev_fxp_mult(DEC_FACTOR, cur_rate);
+		if (rtt > consts->base_rtt)
+			cur_rate = doca_pcc_dev_fxp_mult(consts->dec_factor, cur_rate);
 		else
-			cur_rate += param[RTT_TEMPLATE_AI];
+			cur_rate += consts->ai;
 	}
 
 	if (cur_rate > DOCA_PCC_DEV_MAX_RATE)
 		cur_rate = DOCA_PCC_DEV_MAX_RATE;
 
-	if (cur_rate < param[RTT_TEMPLATE_MIN_RATE])
-		cur_rate = param[RTT_TEMPLATE_MIN_RATE];
+	if (cur_rate < consts->min_rate)
+		cur_rate = consts->min_rate;
 	/* End of example */
 
 	return cur_rate;
@@ -164,7 +215,8 @@ rtt_template_handle_roce_tx(doca_pcc_dev_event_t *event, uint32_t cur_rate, cc_c
 		if (unlikely((rtt_till_now > ((uint32_t)ABORT_TIME << ccctx->abort_cnt))
 				|| (ccctx->rtt_req_to_rtt_sent > 2))) {
 			rtt_req = 1;
-			if (rtt_till_now > ((uint32_t)ABORT_TIME << ccctx->abort_cnt))
+			if ((rtt_till_now > ((uint32_t)ABORT_TIME << ccctx->abort_cnt)) &&
+			    (ccctx->abort_cnt < RTT_TEMPLATE_MAX_ABORT_CNT))
 				ccctx->abort_cnt += 1;
 			ccctx->rtt_req_to_rtt_sent = 1;
 		}
@@ -183,12 +235,13 @@ rtt_template_handle_roce_tx(doca_pcc_dev_event_t *event, uint32_t cur_rate, cc_c
  *
  * @event [in]: A pointer to an event data structure to be passed to extractor functions
  * @cur_rate [in]: Current rate value
- * @param [in]: A pointer to an array of parameters that are used to control algo behavior
+ * @consts [in]: The values derived from the parameters that control algo behavior
  * @ccctx [in/out]: A pointer to a flow context data retrieved by libpcc.
  * @results [out]: A pointer to result struct to update rate in HW.
  */
 static inline void
-rtt_template_handle_roce_rtt(doca_pcc_dev_event_t *event, uint32_t cur_rate, uint32_t *param, cc_ctxt_rtt_template_t *ccctx,
+rtt_template_handle_roce_rtt(doca_pcc_dev_event_t *event, uint32_t cur_rate, const rtt_template_consts_t *consts,
+				cc_ctxt_rtt_template_t *ccctx,
 				doca_pcc_dev_results_t *results)
 {
 	/*
@@ -223,7 +276,7 @@ rtt_template_handle_roce_rtt(doca_pcc_dev_event_t *event, uint32_t cur_rate, uin
 	ccctx->rtt = rtt;
 
 	/* Call to the core of the CC algorithm */
-	cur_rate = algorithm_core(ccctx, rtt, cur_rate, param);
+	cur_rate = algorithm_core(ccctx, rtt, cur_rate, consts);
 
 	ccctx->rtt_req_to_rtt_sent = 1;
 	ccctx->cur_rate = cur_rate;
@@ -245,7 +298,7 @@ static inline void
 rtt_template_handle_roce_cnp(doca_pcc_dev_event_t *event, uint32_t cur_rate, cc_ctxt_rtt_template_t *ccctx,
 				doca_pcc_dev_results_t *results)
 {
-	ccctx->flags.was_cnp = 1;
+	ccctx->was_cnp = 1;
 
 	/* ###### You can put the code for immediate reaction to CNPs ####### */
 	/*
@@ -271,7 +324,7 @@ static inline void
 rtt_template_handle_roce_nack(doca_pcc_dev_event_t *event, uint32_t cur_rate, cc_ctxt_rtt_template_t *ccctx,
 				doca_pcc_dev_results_t *results)
 {
-	ccctx->flags.was_nack = 1;
+	ccctx->was_nack = 1;
 	results->rate = cur_rate;
 	ccctx->cur_rate = cur_rate;
 }
@@ -283,42 +336,44 @@ rtt_template_handle_roce_nack(doca_pcc_dev_event_t *event, uint32_t cur_rate, cc
  *
  * @event [in]: A pointer to an event data structure to be passed to extractor functions
  * @cur_rate [in]: Current rate value
- * @param [in]: A pointer to an array of parameters that are used to control algo behavior
+ * @consts [in]: The values derived from the parameters that control algo behavior
  * @ccctx [in/out]: A pointer to a flow context data retrieved by libpcc.
  * @results [out]: A pointer to result struct to update rate in HW.
  */
 static inline void
-rtt_template_handle_new_flow(doca_pcc_dev_event_t *event, uint32_t cur_rate, uint32_t *param, cc_ctxt_rtt_template_t *ccctx,
-				doca_pcc_dev_results_t *results)
+rtt_template_handle_new_flow(doca_pcc_dev_event_t *event, uint32_t cur_rate, const rtt_template_consts_t *consts,
+				cc_ctxt_rtt_template_t *ccctx, doca_pcc_dev_results_t *results)
 {
-	ccctx->cur_rate = param[RTT_TEMPLATE_NEW_FLOW_RATE];
+	ccctx->cur_rate = consts->new_flow_rate;
 	ccctx->start_delay = doca_pcc_dev_get_timestamp(event);
 	ccctx->rtt_meas_psn = 0;
 	ccctx->rtt_req_to_rtt_sent = 1;
 	ccctx->abort_cnt = 0;
-	ccctx->flags.was_nack = 0;
-	results->rate = param[RTT_TEMPLATE_NEW_FLOW_RATE];
+	ccctx->was_nack = 0;
+	ccctx->was_cnp = 0;
+	results->rate = consts->new_flow_rate;
 	results->rtt_req = 1;
 }
 
-uint32_t
-rtt_template_algo(doca_pcc_dev_event_t *event, uint32_t *param, uint32_t *counter, doca_pcc_dev_algo_ctxt_t *algo_ctxt,
-			doca_pcc_dev_results_t *results)
+void
+rtt_template_algo(doca_pcc_dev_event_t *event, uint32_t port_num, uint32_t *counter,
+			doca_pcc_dev_algo_ctxt_t *algo_ctxt, doca_pcc_dev_results_t *results)
 {
+	const rtt_template_consts_t *consts = &rtt_template_consts[port_num];
 	cc_ctxt_rtt_template_t  *rtt_template_ctx = (cc_ctxt_rtt_template_t *)algo_ctxt;
 	doca_pcc_dev_event_general_attr_t ev_attr = doca_pcc_dev_get_ev_attr(event);
 	uint32_t ev_type = ev_attr.ev_type;
 	uint32_t cur_rate = rtt_template_ctx->cur_rate;
 
 	if (unlikely(cur_rate == 0)) {
-		rtt_template_handle_new_flow(event, cur_rate, param, rtt_template_ctx, results);
+		rtt_template_handle_new_flow(event, cur_rate, consts, rtt_template_ctx, results);
 	} else if (ev_type == DOCA_PCC_DEV_EVNT_ROCE_TX) {
 		rtt_template_handle_roce_tx(event, cur_rate, rtt_template_ctx, results);
 		/* Example code to update counter */
 		if (counter != NULL)
 			counter[RTT_TEMPLATE_COUNTER_TX_EVENT]++;
 	} else if (ev_type == DOCA_PCC_DEV_EVNT_RTT) {
-		rtt_template_handle_roce_rtt(event, cur_rate, param, rtt_template_ctx, results);
+		rtt_template_handle_roce_rtt(event, cur_rate, consts, rtt_template_ctx, results);
 		/* Example code to update counter */
 		if (counter != NULL)
 			counter[RTT_TEMPLATE_COUNTER_RTT_EVENT]++;
@@ -330,21 +385,33 @@ rtt_template_algo(doca_pcc_dev_event_t *event, uint32_t *param, uint32_t *counte
 		results->rate = cur_rate;
 		results->rtt_req = 0;
 	}
-
-	return 0;
 }
 
 doca_pcc_dev_error_t
-rtt_template_set_algo_params(uint32_t param_id_base, uint32_t param_num, const uint32_t *new_param_values,
-				uint32_t *params)
+rtt_template_set_algo_params(uint32_t port_num, uint32_t param_id_base, uint32_t param_num,
+				const uint32_t *new_param_values, uint32_t *params)
 {
+	uint32_t i;
+
 	/* Example */
-	if ((param_num > RTT_TEMPLATE_PARAM_NUM) || (param_id_base >= RTT_TEMPLATE_PARAM_NUM))
+	if ((port_num >= DOCA_PCC_DEV_MAX_NUM_PORTS) || (param_num > RTT_TEMPLATE_PARAM_NUM) ||
+	    (param_id_base >= RTT_TEMPLATE_PARAM_NUM) || (param_id_base + param_num > RTT_TEMPLATE_PARAM_NUM))
 		return DOCA_PCC_DEV_STATUS_FAIL;
 
 	if ((new_param_values == NULL) || (params == NULL))
 		return DOCA_PCC_DEV_STATUS_FAIL;
 
+	/* The NACK decrease factor, the largest one, must stay a positive fraction */
+	if ((param_id_base == RTT_TEMPLATE_UPDATE_FACTOR) &&
+	    (new_param_values[0] >= (1 << 16) / NACK_UPDATE_MULT))
+		return DOCA_PCC_DEV_STATUS_FAIL;
+
+	for (i = 0; i < param_num; i++)
+		params[i] = new_param_values[i];
+
+	/* params points at parameter param_id_base of the full array */
+	rtt_template_update_consts(params - param_id_base, &rtt_template_consts[port_num]);
+
 	return DOCA_PCC_DEV_STATUS_OK;
 	/* End of example */
 }
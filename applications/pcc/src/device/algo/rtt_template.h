@@ -20,12 +20,12 @@
  * It calculates the new rate parameters based on flow context data and event info.
  *
  * @event [in]: A pointer to an event data structure to be passed to extractor functions
- * @param [in]: A pointer to an array of parameters that are used to control algo behavior (see PPCC access register)
+ * @port_num [in]: index of the port, selects the values derived from its parameters (see PPCC access register)
  * @counter [in/out]: A pointer to an array of counters that are incremented by algo (see PPCC access register)
  * @algo_ctxt [in/out]: A pointer to a flow context data retrieved by libpcc.
  * @results [out]: A pointer to result struct to update rate in HW.
  */
-void rtt_template_algo(doca_pcc_dev_event_t *event, uint32_t *param, uint32_t *counter,
+void rtt_template_algo(doca_pcc_dev_event_t *event, uint32_t port_num, uint32_t *counter,
 			doca_pcc_dev_algo_ctxt_t *algo_ctxt, doca_pcc_dev_results_t *results);
 
 /*
@@ -41,7 +41,9 @@ void rtt_template_init(uint32_t algo_idx);
  * Entry point to rtt template (example) user algorithm setting parameters (reference code)
  * This function starts the user algorithm setting parameters code
  * The function will be called to update algorithm parameters
+ * It also computes the values that the algorithm derives from the parameters, so events do not compute them
  *
+ * @port_num [in]: index of the port
  * @param_id_base [in]: id of the first parameter that was changed.
  * @param_num [in]: number of all parameters that were changed
  * @new_param_values [in]: pointer to an array which holds param_num number of new values for parameters
@@ -49,7 +51,7 @@ void rtt_template_init(uint32_t algo_idx);
  *
  * @return DOCA_PCC_DEV_STATUS_FAIL if input parameters (one or more) are not legal.
  */
-doca_pcc_dev_error_t rtt_template_set_algo_params(uint32_t param_id_base, uint32_t param_num,
+doca_pcc_dev_error_t rtt_template_set_algo_params(uint32_t port_num, uint32_t param_id_base, uint32_t param_num,
 			const uint32_t *new_param_values, uint32_t *params);
 
 #endif /* RTT_TEMPLATE_H */
@@ -14,21 +14,22 @@
 #ifndef RTT_TEMPLATE_CTXT_H_
 #define RTT_TEMPLATE_CTXT_H_
 
+/*
+ * Per flow context. The infrastructure keeps a fixed doca_pcc_dev_algo_ctxt_t per flow, the state of the algorithm
+ * is packed in the first 16 bytes so an event touches as few bytes of it as possible.
+ */
 typedef struct {
-	uint8_t was_nack:1;          /* Signal the reception of a NACK */
-	uint8_t was_cnp:1;           /* Signal the reception of a CNP */
-	uint8_t reserved:6;          /* Reserved bits */
-} rtt_template_flags_t;
-
-typedef struct {
-	uint32_t cur_rate;           /* Current rate */
-	uint32_t start_delay;        /* The time at which the RTT packet was sent by the NIC's Tx pipe */
-	uint32_t rtt;                /* Value of the last measured round trip time */
-	rtt_template_flags_t flags;  /* Flags struct */
-	uint8_t abort_cnt;           /* Counter of abort RTT requests */
-	uint8_t rtt_meas_psn;        /* RTT request sequence number */
-	uint8_t rtt_req_to_rtt_sent; /* Set between the algorithm's RTT request until the time at which the RTT packet was sent */
-	uint32_t reserved[8];        /* Reserved bits */
+	uint32_t cur_rate;                /* Current rate */
+	uint32_t start_delay;             /* The time at which the RTT packet was sent by the NIC's Tx pipe */
+	uint32_t rtt;                     /* Value of the last measured round trip time */
+	uint16_t was_nack:1;              /* Signal the reception of a NACK */
+	uint16_t was_cnp:1;               /* Signal the reception of a CNP */
+	uint16_t rtt_meas_psn:1;          /* RTT request sequence number */
+	uint16_t rtt_req_to_rtt_sent:2;   /* Set between the algorithm's RTT request until the time at which the RTT packet was sent */
+	uint16_t abort_cnt:4;             /* Counter of abort RTT requests, saturates at RTT_TEMPLATE_MAX_ABORT_CNT */
+	uint16_t reserved_bits:7;         /* Reserved bits */
+	uint16_t reserved0;               /* Reserved bits */
+	uint32_t reserved[8];             /* Reserved bits */
 } cc_ctxt_rtt_template_t;
 
 #endif /* RTT_TEMPLATE_CTXT_H_ */
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Swift style delay based algorithm (Kumar et al., "Swift: Delay is Simple and Effective for Congestion Control in
+ * the Datacenter", SIGCOMM 2020), adapted from a congestion window to a rate.
+ * Every RTT response is compared with a target delay: below the target the rate increases by AI, above it the rate
+ * decreases in proportion to the excess delay, by BETA * (rtt - target) / rtt and at most by MAX_MDF, at most once
+ * per RTT. The target delay grows linearly from BASE_TARGET at line rate to BASE_TARGET + FS_RANGE at zero rate
+ * (flow scaling), so slower flows are allowed a larger delay and win back bandwidth, which drives fairness.
+ * A NACK is handled like a retransmission timeout and decreases the rate by MAX_MDF.
+ * RTT requests are sent like in the rtt template: a new request after every response, re-sent after a timeout.
+ */
+
+#include <doca_pcc_dev.h>
+#include <doca_pcc_dev_event.h>
+#include <doca_pcc_dev_algo_access.h>
+
+#include "utils.h"
+#include "swift_ctxt.h"
+#include "swift_algo_params.h"
+
+#pragma clang diagnostic ignored "-Wunused-parameter"
+
+#define SWIFT_ABORT_TIME (300000) /* The time to abort rtt_req - in nanosec */
+
+typedef enum {
+	SWIFT_BASE_TARGET   = 0,    /* configurable parameter of target delay */
+	SWIFT_FS_RANGE      = 1,    /* configurable parameter of flow scaling range */
+	SWIFT_AI            = 2,    /* configurable parameter of additive increase */
+	SWIFT_BETA          = 3,    /* configurable parameter of multiplicative decrease gain */
+	SWIFT_MAX_MDF       = 4,    /* configurable parameter of maximal multiplicative decrease */
+	SWIFT_NEW_FLOW_RATE = 5,    /* configurable parameter of new flow rate */
+	SWIFT_MIN_RATE      = 6,    /* configurable parameter of min rate */
+	SWIFT_PARAM_NUM             /* Maximal number of configurable parameters */
+} swift_params_t;
+
+enum {
+	SWIFT_COUNTER_RTT_EVENT = 0, /* rtt event for swift user algorithm */
+	SWIFT_COUNTER_DECREASE  = 1, /* rate decreases of swift user algorithm */
+	SWIFT_COUNTER_NUM            /* Maximal number of counters */
+} swift_counter_t;
+
+const volatile char swift_desc[]                            = "Swift v0.1";
+static const volatile char swift_param_base_target_desc[]   = "BASE_TARGET, target delay";
+static const volatile char swift_param_fs_range_desc[]      = "FS_RANGE, flow scaling range";
+static const volatile char swift_param_ai_desc[]            = "AI, additive increase";
+static const volatile char swift_param_beta_desc[]          = "BETA, multiplicative decrease gain";
+static const volatile char swift_param_max_mdf_desc[]       = "MAX_MDF, maximal multiplicative decrease";
+static const volatile char swift_param_new_flow_rate_desc[] = "NEW_FLOW_RATE, new flow rate";
+static const volatile char swift_param_min_rate_desc[]      = "MIN_RATE, min rate";
+static const volatile char swift_counter_rtt_desc[]         = "COUNTER_RTT_EVENT, number of rtt events handled";
+static const volatile char swift_counter_decrease_desc[]    = "COUNTER_DECREASE, number of rate decreases";
+
+void
+swift_init(uint32_t algo_idx)
+{
+	struct doca_pcc_dev_algo_meta_data algo_def = {0};
+
+	algo_def.algo_id = 0xBFFD;
+	algo_def.algo_major_version = 0x00;
+	algo_def.algo_minor_version = 0x01;
+	algo_def.algo_desc_size = sizeof(swift_desc);
+	algo_def.algo_desc_addr = (uint64_t)swift_desc;
+
+	uint32_t total_param_num = SWIFT_PARAM_NUM;
+	uint32_t total_counter_num = SWIFT_COUNTER_NUM;
+	uint32_t param_num = 0;
+	uint32_t counter_num = 0;
+
+	doca_pcc_dev_algo_init_metadata(algo_idx, &algo_def, total_param_num, total_counter_num);
+
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   SWIFT_DEFAULT_BASE_TARGET,   UINT32_MAX,       1, 1, sizeof(swift_param_base_target_desc),   (uint64_t)swift_param_base_target_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   SWIFT_DEFAULT_FS_RANGE,      UINT32_MAX,       0, 1, sizeof(swift_param_fs_range_desc),      (uint64_t)swift_param_fs_range_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   SWIFT_DEFAULT_AI,            SWIFT_RATE_MAX,   1, 1, sizeof(swift_param_ai_desc),            (uint64_t)swift_param_ai_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   SWIFT_DEFAULT_BETA,          SWIFT_FACTOR_MAX, 1, 1, sizeof(swift_param_beta_desc),          (uint64_t)swift_param_beta_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   SWIFT_DEFAULT_MAX_MDF,       SWIFT_FACTOR_MAX, 1, 1, sizeof(swift_param_max_mdf_desc),       (uint64_t)swift_param_max_mdf_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   SWIFT_DEFAULT_NEW_FLOW_RATE, SWIFT_RATE_MAX,   1, 1, sizeof(swift_param_new_flow_rate_desc), (uint64_t)swift_param_new_flow_rate_desc);
+	doca_pcc_dev_algo_init_param(algo_idx,   param_num++,   SWIFT_DEFAULT_MIN_RATE,      SWIFT_RATE_MAX,   1, 1, sizeof(swift_param_min_rate_desc),      (uint64_t)swift_param_min_rate_desc);
+
+	doca_pcc_dev_algo_init_counter(algo_idx, counter_num++, UINT32_MAX, 2, sizeof(swift_counter_rtt_desc), (uint64_t)swift_counter_rtt_desc);
+	doca_pcc_dev_algo_init_counter(algo_idx, counter_num++, UINT32_MAX, 2, sizeof(swift_counter_decrease_desc), (uint64_t)swift_counter_decrease_desc);
+}
+
+/*
+ * Decrease the rate by a fxp16 factor, at most once per rtt
+ *
+ * @ccctx [in/out]: A pointer to a flow context data retrieved by libpcc.
+ * @timestamp [in]: Event timestamp
+ * @factor [in]: Decrease factor in fxp16
+ * @param [in]: A pointer to an array of parameters that are used to control algo behavior
+ * @return: 1 if the rate was decreased, 0 otherwise
+ */
+static inline uint32_t
+swift_rate_decrease(cc_ctxt_swift_t *ccctx, uint32_t timestamp, uint32_t factor, uint32_t *param)
+{
+	uint32_t cur_rate;
+
+	if ((timestamp - ccctx->last_decrease) < ccctx->rtt)
+		return 0;
+
+	cur_rate = doca_pcc_dev_fxp_mult((1 << 16) - factor, ccctx->cur_rate);
+	if (cur_rate < param[SWIFT_MIN_RATE])
+		cur_rate = param[SWIFT_MIN_RATE];
+	ccctx->cur_rate = cur_rate;
+	ccctx->last_decrease = timestamp;
+	return 1;
+}
+
+/*
+ * Handle a roce tx event: track the RTT request and re-send it if it was lost
+ *
+ * @event [in]: A pointer to an event data structure to be passed to extractor functions
+ * @ccctx [in/out]: A pointer to a flow context data retrieved by libpcc.
+ * @results [out]: A pointer to result struct to update rate in HW.
+ */
+static inline void
+swift_handle_roce_tx(doca_pcc_dev_event_t *event, cc_ctxt_swift_t *ccctx, doca_pcc_dev_results_t *results)
+{
+	uint32_t timestamp = doca_pcc_dev_get_timestamp(event);
+	doca_pcc_dev_event_general_attr_t ev_attr = doca_pcc_dev_get_ev_attr(event);
+	uint8_t rtt_req = 0;
+
+	if (unlikely((ev_attr.flags & DOCA_PCC_DEV_TX_FLAG_RTT_REQ_SENT) && (ccctx->rtt_meas_psn == 0))) {
+		ccctx->rtt_meas_psn = 1;
+		ccctx->rtt_req_to_rtt_sent = 0;
+		ccctx->start_delay = timestamp;
+	} else {
+		uint32_t rtt_till_now = timestamp - ccctx->start_delay;
+
+		/* Abort RTT request flow - for cases event or packet was dropped */
+		if (ccctx->rtt_meas_psn == 0) {
+			rtt_till_now = 0;
+			ccctx->rtt_req_to_rtt_sent += 1;
+		}
+		if (unlikely((rtt_till_now > ((uint32_t)SWIFT_ABORT_TIME << ccctx->abort_cnt))
+				|| (ccctx->rtt_req_to_rtt_sent > 2))) {
+			rtt_req = 1;
+			if (rtt_till_now > ((uint32_t)SWIFT_ABORT_TIME << ccctx->abort_cnt))
+				ccctx->abort_cnt += 1;
+			ccctx->rtt_req_to_rtt_sent = 1;
+		}
+	}
+
+	results->rate = ccctx->cur_rate;
+	results->rtt_req = rtt_req;
+}
+
+/*
+ * Handle a roce rtt event: compare the delay with the target delay of the flow
+ *
+ * @event [in]: A pointer to an event data structure to be passed to extractor functions
+ * @param [in]: A pointer to an array of parameters that are used to control algo behavior
+ * @counter [in/out]: A pointer to an array of counters that are incremented by algo
+ * @ccctx [in/out]: A pointer to a flow context data retrieved by libpcc.
+ * @results [out]: A pointer to result struct to update rate in HW.
+ */
+static inline void
+swift_handle_roce_rtt(doca_pcc_dev_event_t *event, uint32_t *param, uint32_t *counter, cc_ctxt_swift_t *ccctx,
+			doca_pcc_dev_results_t *results)
+{
+	uint32_t timestamp = doca_pcc_dev_get_timestamp(event);
+	uint32_t cur_rate = ccctx->cur_rate;
+	uint32_t rtt, target, factor;
+
+	/* Not the response we are waiting for, e.g. of a request re-sent by the abort flow */
+	if (unlikely((ccctx->rtt_meas_psn == 0) && (ccctx->rtt_req_to_rtt_sent == 0))) {
+		results->rate = cur_rate;
+		results->rtt_req = 0;
+		return;
+	}
+	ccctx->rtt_meas_psn = 0;
+	ccctx->abort_cnt = 0;
+
+	rtt = timestamp - doca_pcc_dev_get_rtt_req_send_timestamp(event);
+	ccctx->rtt = rtt;
+
+	/* Flow scaling: the target grows linearly as the rate drops from line rate */
+	target = param[SWIFT_BASE_TARGET] +
+		 (uint32_t)(doca_pcc_dev_mult(param[SWIFT_FS_RANGE], DOCA_PCC_DEV_MAX_RATE - MIN(cur_rate, DOCA_PCC_DEV_MAX_RATE)) >>
+			    DOCA_PCC_DEV_LOG_MAX_RATE);
+
+	if (rtt < target) {
+		cur_rate += param[SWIFT_AI];
+		if (cur_rate > DOCA_PCC_DEV_MAX_RATE)
+			cur_rate = DOCA_PCC_DEV_MAX_RATE;
+		ccctx->cur_rate = cur_rate;
+	} else {
+		factor = (uint32_t)(doca_pcc_dev_mult(param[SWIFT_BETA], rtt - target) / rtt);
+		if (swift_rate_decrease(ccctx, timestamp, MIN(factor, param[SWIFT_MAX_MDF]), param) && (counter != NULL))
+			counter[SWIFT_COUNTER_DECREASE]++;
+	}
+
+	ccctx->rtt_req_to_rtt_sent = 1;
+	results->rate = ccctx->cur_rate;
+	results->rtt_req = 1;
+}
+
+/*
+ * Handle a new flow: start at the new flow rate and request the first RTT
+ *
+ * @event [in]: A pointer to an event data structure to be passed to extractor functions
+ * @param [in]: A pointer to an array of parameters that are used to control algo behavior
+ * @ccctx [in/out]: A pointer to a flow context data retrieved by libpcc.
+ * @results [out]: A pointer to result struct to update rate in HW.
+ */
+static inline void
+swift_handle_new_flow(doca_pcc_dev_event_t *event, uint32_t *param, cc_ctxt_swift_t *ccctx,
+			doca_pcc_dev_results_t *results)
+{
+	uint32_t timestamp = doca_pcc_dev_get_timestamp(event);
+
+	ccctx->cur_rate = param[SWIFT_NEW_FLOW_RATE];
+	ccctx->start_delay = timestamp;
+	ccctx->last_decrease = timestamp;
+	ccctx->rtt = param[SWIFT_BASE_TARGET];
+	ccctx->rtt_meas_psn = 0;
+	ccctx->rtt_req_to_rtt_sent = 1;
+	ccctx->abort_cnt = 0;
+	results->rate = param[SWIFT_NEW_FLOW_RATE];
+	results->rtt_req = 1;
+}
+
+void
+swift_algo(doca_pcc_dev_event_t *event, uint32_t *param, uint32_t *counter, doca_pcc_dev_algo_ctxt_t *algo_ctxt,
+		doca_pcc_dev_results_t *results)
+{
+	cc_ctxt_swift_t *swift_ctx = (cc_ctxt_swift_t *)algo_ctxt;
+	uint32_t ev_type = doca_pcc_dev_get_ev_attr(event).ev_type;
+
+	if (unlikely(swift_ctx->cur_rate == 0)) {
+		swift_handle_new_flow(event, param, swift_ctx, results);
+	} else if (ev_type == DOCA_PCC_DEV_EVNT_ROCE_TX) {
+		swift_handle_roce_tx(event, swift_ctx, results);
+	} else if (ev_type == DOCA_PCC_DEV_EVNT_RTT) {
+		swift_handle_roce_rtt(event, param, counter, swift_ctx, results);
+		if (counter != NULL)
+			counter[SWIFT_COUNTER_RTT_EVENT]++;
+	} else if (ev_type == DOCA_PCC_DEV_EVNT_ROCE_NACK) {
+		if (swift_rate_decrease(swift_ctx, doca_pcc_dev_get_timestamp(event), param[SWIFT_MAX_MDF], param) &&
+		    (counter != NULL))
+			counter[SWIFT_COUNTER_DECREASE]++;
+		results->rate = swift_ctx->cur_rate;
+		results->rtt_req = 0;
+	} else {
+		/* Swift is delay based, CNPs keep the rate */
+		results->rate = swift_ctx->cur_rate;
+		results->rtt_req = 0;
+	}
+}
+
+doca_pcc_dev_error_t
+swift_set_algo_params(uint32_t param_id_base, uint32_t param_num, const uint32_t *new_param_values,
+			uint32_t *params)
+{
+	uint32_t i;
+
+	if ((param_num > SWIFT_PARAM_NUM) || (param_id_base >= SWIFT_PARAM_NUM) ||
+	    (param_id_base + param_num > SWIFT_PARAM_NUM))
+		return DOCA_PCC_DEV_STATUS_FAIL;
+
+	if ((new_param_values == NULL) || (params == NULL))
+		return DOCA_PCC_DEV_STATUS_FAIL;
+
+	for (i = 0; i < param_num; i++)
+		params[i] = new_param_values[i];
+
+	return DOCA_PCC_DEV_STATUS_OK;
+}
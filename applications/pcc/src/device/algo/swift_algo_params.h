@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef _SWIFT_ALGO_PARAMS_H_
+#define _SWIFT_ALGO_PARAMS_H_
+
+/* Configurable algorithm parameters */
+#define SWIFT_DEFAULT_BASE_TARGET   (20000)                    /* Target delay of a flow at line rate - in nanosec */
+#define SWIFT_DEFAULT_FS_RANGE      (30000)                    /* Target delay added to a flow at zero rate - in nanosec */
+#define SWIFT_DEFAULT_AI            (((1 << 20) * 2) / 1000)   /* 0.002 in fxp20 - additive increase per rtt */
+#define SWIFT_DEFAULT_BETA          (((1 << 16) * 80) / 100)   /* 0.8 in fxp16 - multiplicative decrease gain */
+#define SWIFT_DEFAULT_MAX_MDF       ((1 << 16) / 2)            /* 0.5 in fxp16 - maximal multiplicative decrease */
+#define SWIFT_DEFAULT_NEW_FLOW_RATE (1 << 20)                  /* Rate format in fixed point 20 */
+#define SWIFT_DEFAULT_MIN_RATE      (1 << (20 - 14))           /* Rate format in fixed point 20 */
+
+#define SWIFT_FACTOR_MAX            (1 << 16)                  /* Maximum value of a fxp16 factor */
+#define SWIFT_RATE_MAX              (1 << 20)                  /* Maximum value of rate */
+
+#endif /* _SWIFT_ALGO_PARAMS_H_ */
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef SWIFT_CTXT_H_
+#define SWIFT_CTXT_H_
+
+typedef struct {
+	uint32_t cur_rate;           /* Current rate */
+	uint32_t start_delay;        /* The time at which the RTT packet was sent by the NIC's Tx pipe */
+	uint32_t rtt;                /* Value of the last measured round trip time */
+	uint32_t last_decrease;      /* The time of the last rate decrease */
+	uint8_t abort_cnt;           /* Counter of abort RTT requests */
+	uint8_t rtt_meas_psn;        /* RTT request sequence number */
+	uint8_t rtt_req_to_rtt_sent; /* Set between the algorithm's RTT request until the time at which the RTT packet was sent */
+	uint8_t reserved0;           /* Reserved bits */
+	uint32_t reserved[7];        /* Reserved bits */
+} cc_ctxt_swift_t;
+
+#endif /* SWIFT_CTXT_H_ */
@@ -15,10 +15,19 @@
 #include <doca_pcc_dev_event.h>
 #include <doca_pcc_dev_algo_access.h>
 #include "algo/rtt_template.h"
+#include "algo/dcqcn.h"
+#include "algo/swift.h"
 
 #define __unused __attribute__((__unused__))
 #define DOCA_PCC_DEV_EVNT_ROCE_ACK_MASK (1 << DOCA_PCC_DEV_EVNT_ROCE_ACK)
 
+/* Algorithm indexes, every algorithm runs in the slot of the same number */
+enum {
+	PCC_ALGO_RTT_TEMPLATE = 0,	/* rtt template (example) algorithm */
+	PCC_ALGO_DCQCN = 1,		/* DCQCN algorithm */
+	PCC_ALGO_SWIFT = 2,		/* Swift style delay based algorithm */
+};
+
 /*
  * Main entry point to user CC algorithm (Refernce code)
  * This function starts the algorithm code of a single event
@@ -40,11 +49,27 @@ void doca_pcc_dev_user_algo(doca_pcc_dev_algo_ctxt_t *algo_ctxt, doca_pcc_dev_ev
 
 	switch (attr->algo_slot) {
 		case 0: {
+			/* The parameters are not fetched, the algorithm keeps the values derived from them per port */
+			port_num = doca_pcc_dev_get_ev_attr(event).port_num;
+			counter = doca_pcc_dev_get_counters(port_num, attr->algo_slot);
+
+			rtt_template_algo(event, port_num, counter, algo_ctxt, results);
+			break;
+			}
+		case 1: {
+			port_num = doca_pcc_dev_get_ev_attr(event).port_num;
+			param = doca_pcc_dev_get_algo_params(port_num, attr->algo_slot);
+			counter = doca_pcc_dev_get_counters(port_num, attr->algo_slot);
+
+			dcqcn_algo(event, param, counter, algo_ctxt, results);
+			break;
+			}
+		case 2: {
 			port_num = doca_pcc_dev_get_ev_attr(event).port_num;
 			param = doca_pcc_dev_get_algo_params(port_num, attr->algo_slot);
 			counter = doca_pcc_dev_get_counters(port_num, attr->algo_slot);
 
-			rtt_template_algo(event, param, counter, algo_ctxt, results);
+			swift_algo(event, param, counter, algo_ctxt, results);
 			break;
 			}
 		default: {
@@ -66,15 +91,20 @@ void doca_pcc_dev_user_algo(doca_pcc_dev_algo_ctxt_t *algo_ctxt, doca_pcc_dev_ev
  */
 void doca_pcc_dev_user_init(uint32_t *disable_event_bitmask)
 {
-	uint32_t algo_idx = 0;
-
-	/* Initialize algorithm with algo_idx=0 */
-	rtt_template_init(algo_idx);
+	/* Initialize algorithms with their algo_idx */
+	rtt_template_init(PCC_ALGO_RTT_TEMPLATE);
+	dcqcn_init(PCC_ALGO_DCQCN);
+	swift_init(PCC_ALGO_SWIFT);
 
 	for (int port_num = 0; port_num < DOCA_PCC_DEV_MAX_NUM_PORTS; ++port_num) {
 		/* Slot 0 will use algo_idx 0, default enabled */
-		doca_pcc_dev_init_algo_slot(port_num, 0, algo_idx, 1);
-		doca_pcc_dev_trace_5(0, port_num, 0, algo_idx, 1, DOCA_PCC_DEV_EVNT_ROCE_ACK_MASK);
+		doca_pcc_dev_init_algo_slot(port_num, 0, PCC_ALGO_RTT_TEMPLATE, 1);
+		doca_pcc_dev_trace_5(0, port_num, 0, PCC_ALGO_RTT_TEMPLATE, 1, DOCA_PCC_DEV_EVNT_ROCE_ACK_MASK);
+		/* Slots 1 and 2 hold the algorithms to compare with, a flow uses them when selected through PPCC */
+		doca_pcc_dev_init_algo_slot(port_num, 1, PCC_ALGO_DCQCN, 1);
+		doca_pcc_dev_trace_5(0, port_num, 1, PCC_ALGO_DCQCN, 1, DOCA_PCC_DEV_EVNT_ROCE_ACK_MASK);
+		doca_pcc_dev_init_algo_slot(port_num, 2, PCC_ALGO_SWIFT, 1);
+		doca_pcc_dev_trace_5(0, port_num, 2, PCC_ALGO_SWIFT, 1, DOCA_PCC_DEV_EVNT_ROCE_ACK_MASK);
 	}
 
 	/* disable events of below type */
@@ -115,8 +145,28 @@ doca_pcc_dev_error_t doca_pcc_dev_user_set_algo_params(uint32_t port_num, uint32
 	case 0: {
 		uint32_t algo_idx = doca_pcc_dev_get_algo_index(port_num, algo_slot);
 
-		if (algo_idx == 0)
-			ret = rtt_template_set_algo_params(param_id_base, param_num, new_param_values, params);
+		if (algo_idx == PCC_ALGO_RTT_TEMPLATE)
+			ret = rtt_template_set_algo_params(port_num, param_id_base, param_num, new_param_values, params);
+		else
+			ret = DOCA_PCC_DEV_STATUS_FAIL;
+
+		break;
+	}
+	case 1: {
+		uint32_t algo_idx = doca_pcc_dev_get_algo_index(port_num, algo_slot);
+
+		if (algo_idx == PCC_ALGO_DCQCN)
+			ret = dcqcn_set_algo_params(param_id_base, param_num, new_param_values, params);
+		else
+			ret = DOCA_PCC_DEV_STATUS_FAIL;
+
+		break;
+	}
+	case 2: {
+		uint32_t algo_idx = doca_pcc_dev_get_algo_index(port_num, algo_slot);
+
+		if (algo_idx == PCC_ALGO_SWIFT)
+			ret = swift_set_algo_params(param_id_base, param_num, new_param_values, params);
 		else
 			ret = DOCA_PCC_DEV_STATUS_FAIL;
 
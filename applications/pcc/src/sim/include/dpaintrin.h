@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Host model of the DPA intrinsics used by the PCC device API.
+ * The algorithms and the simulator run on the same thread, so a compiler barrier is enough for the fences, and the
+ * thread time is the simulated time set by the simulator (see pcc_dev_model.h).
+ * The fixed point intrinsics are not modelled, an algorithm that uses them fails to link in the simulator.
+ */
+
+#ifndef PCC_SIM_DPAINTRIN_H_
+#define PCC_SIM_DPAINTRIN_H_
+
+#include <stdint.h>
+
+#define __DPA_HEAP (1 << 0)	/* Heap memory space */
+#define __DPA_MEMORY (1 << 1)	/* Device memory space */
+#define __DPA_MMIO (1 << 2)	/* MMIO space */
+#define __DPA_SYSTEM (__DPA_HEAP | __DPA_MEMORY | __DPA_MMIO)
+
+#define __DPA_R (1 << 0)	/* Read accesses */
+#define __DPA_W (1 << 1)	/* Write accesses */
+#define __DPA_RW (__DPA_R | __DPA_W)
+
+#define __dpa_thread_fence(memory_space, pred_op, succ_op) __atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+/*
+ * Get the thread time
+ *
+ * @return: Simulated time in nanoseconds
+ */
+uint64_t __dpa_thread_time(void);
+
+#endif
@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Host model of the PCC device library.
+ * It keeps the algorithm database that the PCC infrastructure keeps on the DPA: the metadata, parameter and counter
+ * attributes registered per algorithm, and the parameter values and counters of every port and algo slot.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <doca_pcc_dev.h>
+#include <doca_pcc_dev_algo_access.h>
+
+#include "pcc_dev_model.h"
+
+/* Parameter attributes of an algorithm */
+struct model_param {
+	uint32_t default_value;	/* Value the slots start with */
+	uint32_t max_value;	/* Maximal value */
+	uint32_t min_value;	/* Minimal value */
+	uint32_t permissions;	/* 1 if the value can be updated */
+	const char *desc;	/* Parameter description */
+};
+
+/* Counter attributes of an algorithm */
+struct model_counter {
+	uint32_t max_value;	/* Maximal value */
+	uint32_t permissions;	/* Counter permissions */
+	const char *desc;	/* Counter description */
+};
+
+/* Algorithm database entry */
+struct model_algo {
+	bool valid;						/* Metadata was initialized */
+	struct doca_pcc_dev_algo_meta_data meta;		/* Algorithm metadata */
+	uint32_t param_num;					/* Number of parameters */
+	uint32_t counter_num;					/* Number of counters */
+	struct model_param params[DOCA_PCC_DEV_MAX_NUM_PARAMS_PER_ALGO];	/* Parameter attributes */
+	struct model_counter counters[DOCA_PCC_DEV_MAX_NUM_COUNTERS_PER_ALGO];	/* Counter attributes */
+};
+
+/* Per port algo slot */
+struct model_slot {
+	bool valid;						/* Slot was initialized */
+	uint32_t algo_idx;					/* Algorithm of the slot */
+	uint32_t enabled;					/* Algorithm is reported */
+	uint32_t params[DOCA_PCC_DEV_MAX_NUM_PARAMS_PER_ALGO];	/* Current parameter values */
+	uint32_t counters[DOCA_PCC_DEV_MAX_NUM_COUNTERS_PER_ALGO];	/* Counters */
+};
+
+static struct model_algo model_algos[DOCA_PCC_DEV_MAX_NUM_ALGOS];
+static struct model_slot model_slots[DOCA_PCC_DEV_MAX_NUM_PORTS][DOCA_PCC_DEV_MAX_NUM_USER_SLOTS];
+static uint64_t model_time;
+static int model_verbose;
+
+/*
+ * Get an initialized slot
+ *
+ * @port_num [in]: Port number
+ * @algo_slot [in]: Algo slot
+ * @return: The slot, NULL if it is out of range or was not initialized
+ */
+static struct model_slot *
+get_slot(uint32_t port_num, uint32_t algo_slot)
+{
+	if (port_num >= DOCA_PCC_DEV_MAX_NUM_PORTS || algo_slot >= DOCA_PCC_DEV_MAX_NUM_USER_SLOTS)
+		return NULL;
+	if (!model_slots[port_num][algo_slot].valid)
+		return NULL;
+	return &model_slots[port_num][algo_slot];
+}
+
+uint64_t
+__dpa_thread_time(void)
+{
+	return model_time;
+}
+
+void
+pcc_dev_model_set_time(uint64_t time_ns)
+{
+	model_time = time_ns;
+}
+
+void
+pcc_dev_model_set_verbose(int verbose)
+{
+	model_verbose = verbose;
+}
+
+doca_pcc_dev_error_t
+doca_pcc_dev_algo_init_metadata(uint32_t algo_idx, const struct doca_pcc_dev_algo_meta_data *user_def,
+				uint32_t param_num, uint32_t counter_num)
+{
+	struct model_algo *algo;
+
+	if (algo_idx >= DOCA_PCC_DEV_MAX_NUM_ALGOS || user_def == NULL ||
+	    param_num > DOCA_PCC_DEV_MAX_NUM_PARAMS_PER_ALGO || counter_num > DOCA_PCC_DEV_MAX_NUM_COUNTERS_PER_ALGO)
+		return DOCA_PCC_DEV_STATUS_FAIL;
+
+	algo = &model_algos[algo_idx];
+	memset(algo, 0, sizeof(*algo));
+	algo->meta = *user_def;
+	algo->param_num = param_num;
+	algo->counter_num = counter_num;
+	algo->valid = true;
+	return DOCA_PCC_DEV_STATUS_OK;
+}
+
+doca_pcc_dev_error_t
+doca_pcc_dev_algo_init_param(uint32_t algo_idx, uint32_t param_id, uint32_t default_value, uint32_t max_value,
+			     uint32_t min_value, uint32_t permissions, uint32_t param_desc_size, uint64_t param_desc_addr)
+{
+	struct model_param *param;
+
+	(void)param_desc_size;
+	if (algo_idx >= DOCA_PCC_DEV_MAX_NUM_ALGOS || !model_algos[algo_idx].valid ||
+	    param_id >= model_algos[algo_idx].param_num || min_value > max_value || default_value > max_value ||
+	    default_value < min_value)
+		return DOCA_PCC_DEV_STATUS_FAIL;
+
+	param = &model_algos[algo_idx].params[param_id];
+	param->default_value = default_value;
+	param->max_value = max_value;
+	param->min_value = min_value;
+	param->permissions = permissions;
+	param->desc = (const char *)(uintptr_t)param_desc_addr;
+	return DOCA_PCC_DEV_STATUS_OK;
+}
+
+doca_pcc_dev_error_t
+doca_pcc_dev_algo_init_counter(uint32_t algo_idx, uint32_t counter_id, uint32_t max_value, uint32_t permissions,
+			       uint32_t counter_desc_size, uint64_t counter_desc_addr)
+{
+	struct model_counter *counter;
+
+	(void)counter_desc_size;
+	if (algo_idx >= DOCA_PCC_DEV_MAX_NUM_ALGOS || !model_algos[algo_idx].valid ||
+	    counter_id >= model_algos[algo_idx].counter_num)
+		return DOCA_PCC_DEV_STATUS_FAIL;
+
+	counter = &model_algos[algo_idx].counters[counter_id];
+	counter->max_value = max_value;
+	counter->permissions = permissions;
+	counter->desc = (const char *)(uintptr_t)counter_desc_addr;
+	return DOCA_PCC_DEV_STATUS_OK;
+}
+
+doca_pcc_dev_error_t
+doca_pcc_dev_init_algo_slot(uint32_t portid, uint32_t algo_slot, uint32_t algo_idx, uint32_t algo_en)
+{
+	struct model_slot *slot;
+	uint32_t i;
+
+	if (portid >= DOCA_PCC_DEV_MAX_NUM_PORTS || algo_slot >= DOCA_PCC_DEV_MAX_NUM_USER_SLOTS ||
+	    algo_idx >= DOCA_PCC_DEV_MAX_NUM_ALGOS || !model_algos[algo_idx].valid)
+		return DOCA_PCC_DEV_STATUS_FAIL;
+
+	slot = &model_slots[portid][algo_slot];
+	memset(slot, 0, sizeof(*slot));
+	slot->algo_idx = algo_idx;
+	slot->enabled = algo_en;
+	for (i = 0; i < model_algos[algo_idx].param_num; i++)
+		slot->params[i] = model_algos[algo_idx].params[i].default_value;
+	slot->valid = true;
+	return DOCA_PCC_DEV_STATUS_OK;
+}
+
+uint32_t
+doca_pcc_dev_get_counters_num(uint32_t port_num, uint32_t algo_slot)
+{
+	struct model_slot *slot = get_slot(port_num, algo_slot);
+
+	return slot == NULL ? 0 : model_algos[slot->algo_idx].counter_num;
+}
+
+uint32_t *
+doca_pcc_dev_get_counters(uint32_t port_num, uint32_t algo_slot)
+{
+	struct model_slot *slot = get_slot(port_num, algo_slot);
+
+	return slot == NULL ? NULL : slot->counters;
+}
+
+uint32_t
+doca_pcc_dev_get_algo_params_num(uint32_t port_num, uint32_t algo_slot)
+{
+	struct model_slot *slot = get_slot(port_num, algo_slot);
+
+	return slot == NULL ? 0 : model_algos[slot->algo_idx].param_num;
+}
+
+uint32_t *
+doca_pcc_dev_get_algo_params(uint32_t port_num, uint32_t algo_slot)
+{
+	struct model_slot *slot = get_slot(port_num, algo_slot);
+
+	return slot == NULL ? NULL : slot->params;
+}
+
+uint32_t
+doca_pcc_dev_get_algo_index(uint32_t port_num, uint32_t algo_slot)
+{
+	struct model_slot *slot = get_slot(port_num, algo_slot);
+
+	return slot == NULL ? DOCA_PCC_DEV_ALGO_INDEX_INTERNAL : slot->algo_idx;
+}
+
+void
+doca_pcc_dev_default_internal_algo(doca_pcc_dev_algo_ctxt_t *algo_ctxt, doca_pcc_dev_event_t *event,
+				   const doca_pcc_dev_attr_t *attr, doca_pcc_dev_results_t *results)
+{
+	/* The internal algorithm is part of the firmware and is not modelled, its flows run at line rate */
+	(void)algo_ctxt;
+	(void)event;
+	(void)attr;
+	results->rate = DOCA_PCC_DEV_MAX_RATE;
+	results->rtt_req = 0;
+}
+
+void
+doca_pcc_dev_printf(const char *format, ...)
+{
+	va_list args;
+
+	if (!model_verbose)
+		return;
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+}
+
+void
+doca_pcc_dev_trace_5(int format_id, uint64_t arg1, uint64_t arg2, uint64_t arg3, uint64_t arg4, uint64_t arg5)
+{
+	if (!model_verbose)
+		return;
+	fprintf(stderr, "trace %d: %#lx %#lx %#lx %#lx %#lx\n", format_id, (unsigned long)arg1, (unsigned long)arg2,
+		(unsigned long)arg3, (unsigned long)arg4, (unsigned long)arg5);
+}
+
+void
+doca_pcc_dev_trace_flush(void)
+{
+	fflush(stderr);
+}
+
+int
+pcc_dev_model_slot_enabled(uint32_t port_num, uint32_t algo_slot)
+{
+	struct model_slot *slot = get_slot(port_num, algo_slot);
+
+	return slot != NULL && slot->enabled;
+}
+
+const char *
+pcc_dev_model_algo_desc(uint32_t port_num, uint32_t algo_slot)
+{
+	struct model_slot *slot = get_slot(port_num, algo_slot);
+
+	if (slot == NULL)
+		return "";
+	return (const char *)(uintptr_t)model_algos[slot->algo_idx].meta.algo_desc_addr;
+}
+
+int
+pcc_dev_model_get_param_info(uint32_t port_num, uint32_t algo_slot, uint32_t param_id,
+			     struct pcc_dev_model_param_info *info)
+{
+	struct model_slot *slot = get_slot(port_num, algo_slot);
+	struct model_param *param;
+
+	if (slot == NULL || param_id >= model_algos[slot->algo_idx].param_num)
+		return -1;
+
+	param = &model_algos[slot->algo_idx].params[param_id];
+	info->default_value = param->default_value;
+	info->min_value = param->min_value;
+	info->max_value = param->max_value;
+	info->permissions = param->permissions;
+	info->desc = param->desc;
+	return 0;
+}
+
+int
+pcc_dev_model_find_param(uint32_t port_num, uint32_t algo_slot, const char *name)
+{
+	struct model_slot *slot = get_slot(port_num, algo_slot);
+	size_t len = strlen(name);
+	const char *desc;
+	uint32_t i;
+
+	if (slot == NULL)
+		return -1;
+
+	for (i = 0; i < model_algos[slot->algo_idx].param_num; i++) {
+		desc = model_algos[slot->algo_idx].params[i].desc;
+		if (desc != NULL && strncmp(desc, name, len) == 0 && (desc[len] == ',' || desc[len] == '\0'))
+			return i;
+	}
+	return -1;
+}
+
+const char *
+pcc_dev_model_counter_desc(uint32_t port_num, uint32_t algo_slot, uint32_t counter_id)
+{
+	struct model_slot *slot = get_slot(port_num, algo_slot);
+
+	if (slot == NULL || counter_id >= model_algos[slot->algo_idx].counter_num)
+		return NULL;
+	return model_algos[slot->algo_idx].counters[counter_id].desc;
+}
+
+doca_pcc_dev_error_t
+pcc_dev_model_set_params(uint32_t port_num, uint32_t algo_slot, uint32_t param_id_base, uint32_t param_num,
+			 const uint32_t *values)
+{
+	struct model_slot *slot = get_slot(port_num, algo_slot);
+	struct model_param *param;
+	uint32_t i;
+
+	if (slot == NULL || param_id_base + param_num > model_algos[slot->algo_idx].param_num)
+		return DOCA_PCC_DEV_STATUS_FAIL;
+
+	for (i = 0; i < param_num; i++) {
+		param = &model_algos[slot->algo_idx].params[param_id_base + i];
+		if (!param->permissions || values[i] < param->min_value || values[i] > param->max_value)
+			return DOCA_PCC_DEV_STATUS_FAIL;
+	}
+
+	/* The user callback gets the parameters to be changed and assigns the values it accepts */
+	return doca_pcc_dev_user_set_algo_params(port_num, algo_slot, param_id_base, param_num, values,
+						 &slot->params[param_id_base]);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef PCC_DEV_MODEL_H_
+#define PCC_DEV_MODEL_H_
+
+#include <stdint.h>
+
+#include <doca_pcc_dev.h>
+
+/* Parameter attributes registered by an algorithm */
+struct pcc_dev_model_param_info {
+	uint32_t default_value;	/* Value the slots start with */
+	uint32_t min_value;	/* Minimal value accepted by pcc_dev_model_set_params() */
+	uint32_t max_value;	/* Maximal value accepted by pcc_dev_model_set_params() */
+	uint32_t permissions;	/* 1 if the value can be updated */
+	const char *desc;	/* "NAME, description" */
+};
+
+/*
+ * Set the time returned by the thread time of the device API
+ *
+ * @time_ns [in]: Simulated time in nanoseconds
+ */
+void pcc_dev_model_set_time(uint64_t time_ns);
+
+/*
+ * Print the device printf and trace output to stderr
+ *
+ * @verbose [in]: Non-zero to print, the output is dropped by default
+ */
+void pcc_dev_model_set_verbose(int verbose);
+
+/*
+ * Check if an algorithm slot was initialized and enabled by the user init
+ *
+ * @port_num [in]: Port number
+ * @algo_slot [in]: Algo slot
+ * @return: Non-zero if the slot is enabled
+ */
+int pcc_dev_model_slot_enabled(uint32_t port_num, uint32_t algo_slot);
+
+/*
+ * Get the description of the algorithm of a slot
+ *
+ * @port_num [in]: Port number
+ * @algo_slot [in]: Algo slot
+ * @return: Algorithm description, empty if the slot was not initialized
+ */
+const char *pcc_dev_model_algo_desc(uint32_t port_num, uint32_t algo_slot);
+
+/*
+ * Get the attributes of a parameter of the algorithm of a slot
+ *
+ * @port_num [in]: Port number
+ * @algo_slot [in]: Algo slot
+ * @param_id [in]: Parameter id
+ * @info [out]: Parameter attributes
+ * @return: 0 on success, -1 if the slot or the parameter do not exist
+ */
+int pcc_dev_model_get_param_info(uint32_t port_num, uint32_t algo_slot, uint32_t param_id,
+				 struct pcc_dev_model_param_info *info);
+
+/*
+ * Find a parameter of the algorithm of a slot by the name its description starts with
+ *
+ * @port_num [in]: Port number
+ * @algo_slot [in]: Algo slot
+ * @name [in]: Parameter name, e.g. "AI"
+ * @return: Parameter id, -1 if not found
+ */
+int pcc_dev_model_find_param(uint32_t port_num, uint32_t algo_slot, const char *name);
+
+/*
+ * Get the description of a counter of the algorithm of a slot
+ *
+ * @port_num [in]: Port number
+ * @algo_slot [in]: Algo slot
+ * @counter_id [in]: Counter id
+ * @return: Counter description, NULL if the slot or the counter do not exist
+ */
+const char *pcc_dev_model_counter_desc(uint32_t port_num, uint32_t algo_slot, uint32_t counter_id);
+
+/*
+ * Set parameters of a slot like a PPCC access register write does: the values are checked against the parameter
+ * attributes, then passed to doca_pcc_dev_user_set_algo_params() which assigns them
+ *
+ * @port_num [in]: Port number
+ * @algo_slot [in]: Algo slot
+ * @param_id_base [in]: Id of the first parameter to set
+ * @param_num [in]: Number of parameters to set
+ * @values [in]: New values
+ * @return: DOCA_PCC_DEV_STATUS_OK on success, DOCA_PCC_DEV_STATUS_FAIL if a value was refused
+ */
+doca_pcc_dev_error_t pcc_dev_model_set_params(uint32_t port_num, uint32_t algo_slot, uint32_t param_id_base,
+					      uint32_t param_num, const uint32_t *values);
+
+#endif /* PCC_DEV_MODEL_H_ */
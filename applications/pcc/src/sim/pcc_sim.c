@@ -0,0 +1,1031 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Offline simulator of the PCC device algorithms.
+ * The device code (pcc_dev_main.c and the algorithms) is built for the host against a model of the PCC device
+ * library (pcc_dev_model.c), and this file feeds it the events the NIC would raise, then applies the rates it sets.
+ *
+ * The synthetic mode models flows of one port sending through a single bottleneck link: every flow sends at the
+ * rate of its algorithm, the link drains a queue at line rate, marks packets with ECN between SIM_ECN_KMIN and
+ * SIM_ECN_KMAX (the receiver answers with at most one CNP per flow per SIM_CNP_INTERVAL) and drops what does not fit
+ * in the buffer (a NACK is sent for a dropped packet). RTT probes return after the base RTT plus the queueing delay.
+ * The flows start one after the other, so the rates have to converge every time a flow joins.
+ *
+ * The replay mode feeds a recorded event stream instead, one event per line:
+ *     <time in ns> <flow> <tx|rtt|cnp|nack> <value>
+ * where the value is the number of bytes sent for tx events and the measured RTT in ns for rtt events. The
+ * synthetic mode can write its events in this format, and event logs of a cluster can be converted to it.
+ *
+ * The rates are sampled into a CSV file (throughput, queue, Jain fairness index and the rates of the first flows),
+ * which can be plotted with the gnuplot script the simulator writes, and the convergence time is reported.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <doca_pcc_dev.h>
+#include <doca_pcc_dev_algo_access.h>
+
+#include "pcc_dev_model.h"
+
+#define SIM_MAX_FLOWS (1 << 20)			/* Maximal number of flows */
+#define SIM_FLOWS_DEFAULT (16)			/* Number of flows */
+#define SIM_DURATION_DEFAULT (10000)		/* Simulated time, in us */
+#define SIM_STAGGER_DEFAULT (100)		/* Time between the start of two flows, in us */
+#define SIM_LINK_DEFAULT (100)			/* Line rate and bottleneck link speed, in Gb/s */
+#define SIM_BASE_RTT_DEFAULT (8000)		/* RTT of an empty network, in ns */
+#define SIM_BUFFER_DEFAULT (1024)		/* Bottleneck buffer, in KB */
+#define SIM_INTERVAL_DEFAULT (10)		/* Sampling interval, in us */
+#define SIM_PLOT_FLOWS_DEFAULT (8)		/* Flows with a rate column in the CSV file */
+#define SIM_TICK_NS (500)			/* Time step of the network model */
+#define SIM_MTU (4096)				/* Packet size */
+#define SIM_TX_BURST (SIM_MTU)			/* Bytes a flow sends between two TX events */
+#define SIM_ECN_KMIN (5 * 1024)			/* Queue length where ECN marking starts */
+#define SIM_ECN_KMAX (200 * 1024)		/* Queue length where every packet is marked */
+#define SIM_ECN_PMAX (0.01)			/* Marking probability at SIM_ECN_KMAX */
+#define SIM_CNP_INTERVAL (50000)		/* Minimal time between two CNPs of a flow, in ns */
+#define SIM_CNP_INFLIGHT (16)			/* CNPs of a flow on their way back, more are dropped */
+#define SIM_FAIR_JAIN (0.95)			/* Jain index of a converged sample */
+#define SIM_PORT (0)				/* Port of the flows */
+#define SIM_MAX_SET_PARAMS (DOCA_PCC_DEV_MAX_NUM_PARAMS_PER_ALGO)	/* Number of -P options */
+#define SIM_EVENT_TYPES (DOCA_PCC_DEV_EVNT_RTT + 1)	/* Size of the per event type arrays */
+#define SIM_BENCH_POOL (1 << 12)		/* Prebuilt benchmark events, reused with new timestamps */
+#define SIM_BENCH_EVENT_GAP (100)		/* Time between two benchmark events, in ns */
+
+/* Simulated flow */
+struct sim_flow {
+	doca_pcc_dev_algo_ctxt_t ctxt;	/* Algorithm context of the flow */
+	uint64_t start;			/* Time the flow starts sending */
+	uint32_t rate;			/* Rate set by the algorithm, fxp20 of the line rate */
+	uint32_t sn;			/* Serial number of the next event */
+	bool started;			/* The flow got its first event */
+	bool rtt_req;			/* The algorithm requested an RTT probe */
+	double credit;			/* Bytes the flow may send */
+	uint64_t tx_pending;		/* Bytes sent since the last TX event */
+	uint64_t sent_tick;		/* Bytes sent in the current time step */
+	uint64_t cnp_times[SIM_CNP_INFLIGHT];	/* Arrival times of the CNPs on their way back, in order */
+	uint32_t cnp_head;		/* Index of the next CNP to arrive */
+	uint32_t nb_cnps;		/* Number of CNPs on their way back */
+	uint64_t nack_time;		/* Arrival time of the pending NACK, 0 if none */
+	uint64_t rtt_time;		/* Arrival time of the pending RTT response, 0 if none */
+	uint64_t rtt_send;		/* Time the pending RTT probe was sent */
+	uint64_t next_cnp;		/* Earliest time the receiver sends another CNP */
+	uint64_t tx_bytes;		/* Bytes sent */
+};
+
+/* Simulator state */
+struct sim {
+	struct sim_flow *flows;		/* Flows */
+	uint32_t nb_flows;		/* Number of flows */
+	uint32_t nb_started;		/* Number of flows that got their first event */
+	uint32_t algo_slot;		/* Algo slot of the flows */
+	uint32_t disable_mask;		/* Event types disabled by the user init */
+	uint64_t now;			/* Simulated time, in ns */
+	uint64_t rng;			/* Random generator state */
+	FILE *record;			/* Event stream output, NULL if not recorded */
+	/* Network model */
+	double link_gbps;		/* Line rate and bottleneck link speed */
+	double link_bytes_per_ns;	/* Bottleneck link speed */
+	uint64_t base_rtt;		/* RTT of an empty network */
+	double buffer;			/* Bottleneck buffer, in bytes */
+	double queue;			/* Bottleneck queue, in bytes */
+	double queue_sum;		/* Sum of the sampled queue lengths */
+	double queue_max;		/* Longest queue */
+	double drained_bytes;		/* Bytes sent by the bottleneck link */
+	double dropped_bytes;		/* Bytes dropped by the bottleneck */
+	/* Sampling */
+	FILE *out;			/* CSV output, NULL if not written */
+	uint32_t plot_flows;		/* Flows with a rate column */
+	uint64_t interval;		/* Sampling interval, in ns */
+	uint64_t next_sample;		/* Time of the next sample */
+	uint64_t nb_samples;		/* Number of samples */
+	double sample_drained;		/* Drained bytes at the previous sample */
+	double last_jain;		/* Jain index of the last sample */
+	double jain_sum;		/* Sum of the Jain indexes sampled after the last flow started */
+	uint64_t nb_jain;		/* Number of Jain indexes in jain_sum */
+	uint64_t last_start;		/* Time the last flow started */
+	double drained_at_last_start;	/* Drained bytes when the last flow started */
+	uint64_t fair_since;		/* Time since when all samples are fair, 0 if the last one is not */
+	/* Statistics */
+	uint64_t events[SIM_EVENT_TYPES];	/* Events by type */
+	uint64_t algo_cycles;		/* Cycles spent in the algorithm */
+};
+
+static const char *const sim_event_names[SIM_EVENT_TYPES] = {
+	[DOCA_PCC_DEV_EVNT_ROCE_CNP] = "cnp",
+	[DOCA_PCC_DEV_EVNT_ROCE_TX] = "tx",
+	[DOCA_PCC_DEV_EVNT_ROCE_NACK] = "nack",
+	[DOCA_PCC_DEV_EVNT_RTT] = "rtt",
+};
+
+/*
+ * Read the cycle counter, or a nanosecond clock where there is no cycle counter
+ *
+ * @return: Current cycle count
+ */
+static inline uint64_t
+sim_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/*
+ * Get a uniform random number
+ *
+ * @sim [in]: Simulator
+ * @return: Random number in [0, 1)
+ */
+static inline double
+sim_random(struct sim *sim)
+{
+	/* xorshift64* */
+	sim->rng ^= sim->rng >> 12;
+	sim->rng ^= sim->rng << 25;
+	sim->rng ^= sim->rng >> 27;
+	return ((sim->rng * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / (1ULL << 53));
+}
+
+/*
+ * Store a value the way the NIC writes event fields, the device API byte swaps them back
+ *
+ * @dst [out]: Event field
+ * @value [in]: Value
+ */
+static inline void
+sim_put_be32(void *dst, uint32_t value)
+{
+	value = __builtin_bswap32(value);
+	memcpy(dst, &value, sizeof(value));
+}
+
+/*
+ * Get the rate of an algorithm in Gb/s
+ *
+ * @sim [in]: Simulator
+ * @rate [in]: Rate in fxp20 of the line rate
+ * @return: Rate in Gb/s
+ */
+static inline double
+sim_rate_gbps(const struct sim *sim, uint32_t rate)
+{
+	return (double)rate / DOCA_PCC_DEV_MAX_RATE * sim->link_gbps;
+}
+
+/*
+ * Build an event the way the NIC writes it
+ *
+ * @event [out]: Event
+ * @ev_type [in]: Event type
+ * @flags [in]: Event flags
+ * @flow_idx [in]: Flow tag
+ * @sn [in]: Event serial number
+ * @timestamp [in]: Event timestamp, in ns
+ * @value [in]: Bytes sent for TX events, RTT in ns for RTT events
+ */
+static void
+sim_build_event(doca_pcc_dev_event_t *event, uint32_t ev_type, uint32_t flags, uint32_t flow_idx, uint32_t sn,
+		uint32_t timestamp, uint32_t value)
+{
+	doca_pcc_dev_event_general_attr_t ev_attr = {0};
+	doca_pcc_dev_roce_tx_cntrs_t cntrs = {0};
+	doca_pcc_dev_ack_nack_cnp_extra_t extra = {0};
+	uint32_t raw;
+
+	memset(event, 0, sizeof(*event));
+	ev_attr.ev_type = ev_type;
+	ev_attr.port_num = SIM_PORT;
+	ev_attr.flags = flags;
+	memcpy(&raw, &ev_attr, sizeof(raw));
+	sim_put_be32(&event->ev_attr, raw);
+	sim_put_be32(&event->flow_tag, flow_idx);
+	sim_put_be32(&event->sn, sn);
+	sim_put_be32(&event->timestamp, timestamp);
+
+	switch (ev_type) {
+	case DOCA_PCC_DEV_EVNT_ROCE_TX:
+		cntrs.sent_32bytes = value / 32 > 0xffff ? 0xffff : value / 32;
+		cntrs.sent_pkts = (value + SIM_MTU - 1) / SIM_MTU > 0xffff ? 0xffff : (value + SIM_MTU - 1) / SIM_MTU;
+		memcpy(&raw, &cntrs, sizeof(raw));
+		sim_put_be32(&event->ev_spec_attr.roce_tx.cntrs, raw);
+		sim_put_be32(&event->ev_spec_attr.roce_tx.first_timestamp, timestamp);
+		break;
+	case DOCA_PCC_DEV_EVNT_RTT:
+		sim_put_be32(&event->ev_spec_attr.rtt_tstamp.req_send_timestamp, timestamp - value);
+		sim_put_be32(&event->ev_spec_attr.rtt_tstamp.req_recv_timestamp, timestamp - value / 2);
+		sim_put_be32(&event->ev_spec_attr.rtt_tstamp.resp_send_timestamp, timestamp - value / 2);
+		break;
+	case DOCA_PCC_DEV_EVNT_ROCE_CNP:
+	case DOCA_PCC_DEV_EVNT_ROCE_NACK:
+		extra.num_coalesced = 1;
+		memcpy(&raw, &extra, sizeof(raw));
+		sim_put_be32(&event->ev_spec_attr.ack_nack_cnp.extra, raw);
+		sim_put_be32(&event->ev_spec_attr.ack_nack_cnp.first_timestamp, timestamp);
+		sim_put_be32(&event->ev_spec_attr.ack_nack_cnp.first_sn, sn);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Build an event of a flow, run the algorithm of the flow on it and apply the results
+ *
+ * @sim [in]: Simulator
+ * @flow [in]: Flow
+ * @ev_type [in]: Event type
+ * @flags [in]: Event flags
+ * @value [in]: Bytes sent for TX events, RTT in ns for RTT events
+ */
+static void
+sim_deliver(struct sim *sim, struct sim_flow *flow, uint32_t ev_type, uint32_t flags, uint32_t value)
+{
+	doca_pcc_dev_event_t event;
+	doca_pcc_dev_attr_t attr = {0};
+	doca_pcc_dev_results_t results = {0};
+	uint32_t flow_idx = flow - sim->flows;
+	uint64_t start;
+
+	if (!flow->started) {
+		flow->started = true;
+		sim->nb_started++;
+		sim->last_start = sim->now;
+		sim->drained_at_last_start = sim->drained_bytes;
+	}
+
+	if (sim->record != NULL)
+		fprintf(sim->record, "%" PRIu64 " %u %s %u\n", sim->now, flow_idx, sim_event_names[ev_type], value);
+
+	if (sim->disable_mask & (1U << ev_type))
+		return;
+
+	sim_build_event(&event, ev_type, flags, flow_idx, flow->sn++, (uint32_t)sim->now, value);
+
+	attr.algo_slot = sim->algo_slot;
+	pcc_dev_model_set_time(sim->now);
+	start = sim_cycles();
+	doca_pcc_dev_user_algo(&flow->ctxt, &event, &attr, &results);
+	sim->algo_cycles += sim_cycles() - start;
+	sim->events[ev_type]++;
+
+	flow->rate = results.rate > DOCA_PCC_DEV_MAX_RATE ? DOCA_PCC_DEV_MAX_RATE : results.rate;
+	if (results.rtt_req)
+		flow->rtt_req = true;
+}
+
+/*
+ * Get the ECN marking probability of a packet
+ *
+ * @queue [in]: Queue length, in bytes
+ * @return: Marking probability
+ */
+static inline double
+sim_ecn_probability(double queue)
+{
+	if (queue <= SIM_ECN_KMIN)
+		return 0.0;
+	if (queue >= SIM_ECN_KMAX)
+		return 1.0;
+	return SIM_ECN_PMAX * (queue - SIM_ECN_KMIN) / (SIM_ECN_KMAX - SIM_ECN_KMIN);
+}
+
+/*
+ * Run one time step of the network model: deliver the events that arrived, let every flow send at its rate, then
+ * run the bottleneck queue and schedule the CNPs and NACKs of the packets it marked and dropped
+ *
+ * @sim [in]: Simulator
+ */
+static void
+sim_tick(struct sim *sim)
+{
+	double tick_bytes = sim->link_bytes_per_ns * SIM_TICK_NS;
+	uint64_t qdelay = (uint64_t)(sim->queue / sim->link_bytes_per_ns);
+	double in_bytes = 0, drained, dropped, ecn, pkts;
+	struct sim_flow *flow;
+	uint64_t bytes, arrival;
+	uint32_t i, flags, last;
+
+	for (i = 0; i < sim->nb_flows; i++) {
+		flow = &sim->flows[i];
+		flow->sent_tick = 0;
+		if (!flow->started) {
+			if (sim->now < flow->start)
+				continue;
+			/* The first TX event of a flow starts its algorithm */
+			sim_deliver(sim, flow, DOCA_PCC_DEV_EVNT_ROCE_TX, 0, 0);
+		}
+
+		while (flow->nb_cnps > 0 && flow->cnp_times[flow->cnp_head] <= sim->now) {
+			flow->cnp_head = (flow->cnp_head + 1) % SIM_CNP_INFLIGHT;
+			flow->nb_cnps--;
+			sim_deliver(sim, flow, DOCA_PCC_DEV_EVNT_ROCE_CNP, 0, 0);
+		}
+		if (flow->nack_time != 0 && flow->nack_time <= sim->now) {
+			flow->nack_time = 0;
+			sim_deliver(sim, flow, DOCA_PCC_DEV_EVNT_ROCE_NACK, 0, 0);
+		}
+		if (flow->rtt_time != 0 && flow->rtt_time <= sim->now) {
+			flow->rtt_time = 0;
+			sim_deliver(sim, flow, DOCA_PCC_DEV_EVNT_RTT, 0, (uint32_t)(sim->now - flow->rtt_send));
+		}
+
+		flow->credit += (double)flow->rate / DOCA_PCC_DEV_MAX_RATE * tick_bytes;
+		bytes = (uint64_t)flow->credit;
+		flow->credit -= bytes;
+		flow->sent_tick = bytes;
+		flow->tx_pending += bytes;
+		flow->tx_bytes += bytes;
+		in_bytes += bytes;
+
+		if (flow->tx_pending >= SIM_TX_BURST) {
+			flags = 0;
+			/* A requested RTT probe goes out with the next packets, one probe at a time */
+			if (flow->rtt_req && flow->rtt_time == 0) {
+				flags = DOCA_PCC_DEV_TX_FLAG_RTT_REQ_SENT;
+				flow->rtt_req = false;
+				flow->rtt_send = sim->now;
+				flow->rtt_time = sim->now + sim->base_rtt + qdelay;
+			}
+			sim_deliver(sim, flow, DOCA_PCC_DEV_EVNT_ROCE_TX, flags, (uint32_t)flow->tx_pending);
+			flow->tx_pending = 0;
+		}
+	}
+
+	sim->queue += in_bytes;
+	drained = sim->queue < tick_bytes ? sim->queue : tick_bytes;
+	sim->queue -= drained;
+	sim->drained_bytes += drained;
+	dropped = sim->queue > sim->buffer ? sim->queue - sim->buffer : 0;
+	sim->queue -= dropped;
+	sim->dropped_bytes += dropped;
+	if (sim->queue > sim->queue_max)
+		sim->queue_max = sim->queue;
+
+	ecn = sim_ecn_probability(sim->queue);
+	if (ecn == 0.0 && dropped == 0.0)
+		return;
+
+	/* Every flow is marked and dropped in proportion to the packets it sent in this time step */
+	qdelay = (uint64_t)(sim->queue / sim->link_bytes_per_ns);
+	for (i = 0; i < sim->nb_flows; i++) {
+		flow = &sim->flows[i];
+		if (flow->sent_tick == 0)
+			continue;
+		pkts = (double)flow->sent_tick / SIM_MTU;
+		if (ecn > 0.0 && flow->nb_cnps < SIM_CNP_INFLIGHT && sim->now >= flow->next_cnp &&
+		    sim_random(sim) < ecn * pkts) {
+			/* A CNP never overtakes the previous one of its flow */
+			arrival = sim->now + sim->base_rtt + qdelay;
+			last = (flow->cnp_head + flow->nb_cnps + SIM_CNP_INFLIGHT - 1) % SIM_CNP_INFLIGHT;
+			if (flow->nb_cnps > 0 && arrival < flow->cnp_times[last])
+				arrival = flow->cnp_times[last];
+			flow->cnp_times[(flow->cnp_head + flow->nb_cnps) % SIM_CNP_INFLIGHT] = arrival;
+			flow->nb_cnps++;
+			flow->next_cnp = sim->now + SIM_CNP_INTERVAL;
+		}
+		if (dropped > 0.0 && flow->nack_time == 0 && sim_random(sim) < dropped / in_bytes * pkts)
+			flow->nack_time = sim->now + sim->base_rtt + qdelay;
+	}
+}
+
+/*
+ * Sample the rates of the flows and write them to the CSV file
+ *
+ * @sim [in]: Simulator
+ * @synthetic [in]: The network is modelled, otherwise the throughput is the sum of the rates
+ */
+static void
+sim_sample(struct sim *sim, bool synthetic)
+{
+	double sum = 0, sum_sq = 0, min = 0, max = 0, gbps, throughput, jain = 1.0;
+	uint32_t i, nb_active = 0;
+
+	for (i = 0; i < sim->nb_flows; i++) {
+		if (!sim->flows[i].started)
+			continue;
+		gbps = sim_rate_gbps(sim, sim->flows[i].rate);
+		if (nb_active == 0 || gbps < min)
+			min = gbps;
+		if (nb_active == 0 || gbps > max)
+			max = gbps;
+		sum += gbps;
+		sum_sq += gbps * gbps;
+		nb_active++;
+	}
+	if (nb_active > 0 && sum_sq > 0)
+		jain = sum * sum / (nb_active * sum_sq);
+
+	if (synthetic)
+		throughput = (sim->drained_bytes - sim->sample_drained) * 8 / sim->interval;
+	else
+		throughput = sum;
+	sim->sample_drained = sim->drained_bytes;
+	sim->queue_sum += sim->queue;
+	sim->nb_samples++;
+	sim->last_jain = jain;
+
+	/* Convergence is measured once the flows the simulation starts with are all running */
+	if (nb_active == sim->nb_flows || (!synthetic && nb_active > 0)) {
+		sim->jain_sum += jain;
+		sim->nb_jain++;
+		if (jain < SIM_FAIR_JAIN)
+			sim->fair_since = 0;
+		else if (sim->fair_since == 0)
+			sim->fair_since = sim->now;
+	}
+
+	if (sim->out == NULL)
+		return;
+	fprintf(sim->out, "%.3f,%.3f,%.3f,%.4f,%.3f,%.3f", sim->now / 1000.0, sim->queue / 1024, throughput, jain, min,
+		max);
+	for (i = 0; i < sim->plot_flows; i++)
+		fprintf(sim->out, ",%.3f", sim->flows[i].started ? sim_rate_gbps(sim, sim->flows[i].rate) : 0.0);
+	fprintf(sim->out, "\n");
+}
+
+/*
+ * Take the samples that are due up to a time
+ *
+ * @sim [in]: Simulator
+ * @time [in]: Current time
+ * @synthetic [in]: The network is modelled
+ */
+static void
+sim_sample_until(struct sim *sim, uint64_t time, bool synthetic)
+{
+	uint64_t now = sim->now;
+
+	while (sim->next_sample <= time) {
+		sim->now = sim->next_sample;
+		sim_sample(sim, synthetic);
+		sim->next_sample += sim->interval;
+	}
+	sim->now = now;
+}
+
+/*
+ * Run the network model
+ *
+ * @sim [in]: Simulator
+ * @duration [in]: Simulated time, in ns
+ */
+static void
+sim_run_synthetic(struct sim *sim, uint64_t duration)
+{
+	for (sim->now = 0; sim->now < duration; sim->now += SIM_TICK_NS) {
+		sim_tick(sim);
+		sim_sample_until(sim, sim->now + SIM_TICK_NS, true);
+	}
+}
+
+/*
+ * Feed a recorded event stream to the algorithm
+ *
+ * @sim [in]: Simulator
+ * @path [in]: Event stream file
+ * @return: 0 on success and -1 otherwise
+ */
+static int
+sim_run_replay(struct sim *sim, const char *path)
+{
+	char line[256], name[16];
+	struct sim_flow *flow;
+	uint64_t time, nb_line = 0;
+	uint32_t idx, value, ev_type, flags;
+	char *c;
+	FILE *in;
+	int ret = 0;
+
+	in = fopen(path, "r");
+	if (in == NULL) {
+		fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), in) != NULL) {
+		nb_line++;
+		for (c = line; *c != '\0'; c++) {
+			if (*c == ',')
+				*c = ' ';
+			else if (*c == '#')
+				*c = '\0';
+		}
+		value = 0;
+		if (sscanf(line, "%" SCNu64 " %u %15s %u", &time, &idx, name, &value) < 3)
+			continue;
+
+		for (ev_type = 0; ev_type < SIM_EVENT_TYPES; ev_type++) {
+			if (sim_event_names[ev_type] != NULL && strcmp(sim_event_names[ev_type], name) == 0)
+				break;
+		}
+		if (ev_type == SIM_EVENT_TYPES || idx >= sim->nb_flows || time < sim->now) {
+			fprintf(stderr, "%s:%" PRIu64 ": invalid event, flows must be below %u and times in order\n",
+				path, nb_line, sim->nb_flows);
+			ret = -1;
+			break;
+		}
+
+		sim_sample_until(sim, time, false);
+		sim->now = time;
+		flow = &sim->flows[idx];
+		flags = 0;
+		/* Like in the network model, a requested probe goes out with the next TX while none is in flight */
+		if (ev_type == DOCA_PCC_DEV_EVNT_ROCE_TX && flow->rtt_req && flow->rtt_time == 0) {
+			flags = DOCA_PCC_DEV_TX_FLAG_RTT_REQ_SENT;
+			flow->rtt_req = false;
+			flow->rtt_time = time;
+		} else if (ev_type == DOCA_PCC_DEV_EVNT_RTT) {
+			flow->rtt_time = 0;
+		}
+		sim_deliver(sim, flow, ev_type, flags, value);
+	}
+
+	if (ret == 0)
+		sim_sample_until(sim, sim->now, false);
+	fclose(in);
+	return ret;
+}
+
+/*
+ * Apply a NAME=VALUE or ID=VALUE parameter setting to the algo slot of the flows
+ *
+ * @sim [in]: Simulator
+ * @setting [in]: Parameter setting
+ * @return: 0 on success and -1 otherwise
+ */
+static int
+sim_set_param(struct sim *sim, const char *setting)
+{
+	char name[64], *end;
+	const char *eq = strchr(setting, '=');
+	uint32_t value;
+	long id;
+
+	if (eq == NULL || (size_t)(eq - setting) >= sizeof(name)) {
+		fprintf(stderr, "Invalid parameter setting %s, expected NAME=VALUE\n", setting);
+		return -1;
+	}
+	memcpy(name, setting, eq - setting);
+	name[eq - setting] = '\0';
+
+	id = strtol(name, &end, 0);
+	if (*end != '\0')
+		id = pcc_dev_model_find_param(SIM_PORT, sim->algo_slot, name);
+	value = strtoul(eq + 1, NULL, 0);
+	if (id < 0 || pcc_dev_model_set_params(SIM_PORT, sim->algo_slot, id, 1, &value) != DOCA_PCC_DEV_STATUS_OK) {
+		fprintf(stderr, "Algo slot %u refused parameter setting %s\n", sim->algo_slot, setting);
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Pick the event type of a benchmark event of the mixed run, in the proportions of the network model
+ *
+ * @sim [in]: Simulator
+ * @return: Event type
+ */
+static uint32_t
+sim_bench_mixed_type(struct sim *sim)
+{
+	double r = sim_random(sim);
+
+	if (r < 0.80)
+		return DOCA_PCC_DEV_EVNT_ROCE_TX;
+	if (r < 0.92)
+		return DOCA_PCC_DEV_EVNT_RTT;
+	if (r < 0.98)
+		return DOCA_PCC_DEV_EVNT_ROCE_CNP;
+	return DOCA_PCC_DEV_EVNT_ROCE_NACK;
+}
+
+/*
+ * Measure the cycles the algorithm of the algo slot spends per event, for every event type and for a mix of them.
+ * The events go to random flows, so with many flows the flow contexts do not fit in the cache, like on a DPA that
+ * handles many QPs.
+ *
+ * @sim [in]: Simulator
+ * @nb_events [in]: Number of events of every run
+ * @return: 0 on success and -1 otherwise
+ */
+static int
+sim_bench(struct sim *sim, uint64_t nb_events)
+{
+	static const uint32_t run_types[] = {
+		DOCA_PCC_DEV_EVNT_ROCE_TX,
+		DOCA_PCC_DEV_EVNT_RTT,
+		DOCA_PCC_DEV_EVNT_ROCE_CNP,
+		DOCA_PCC_DEV_EVNT_ROCE_NACK,
+		DOCA_PCC_DEV_EVNT_NULL,	/* Mixed */
+	};
+	doca_pcc_dev_attr_t attr = {0};
+	doca_pcc_dev_results_t results;
+	doca_pcc_dev_algo_ctxt_t *ctxts;
+	doca_pcc_dev_event_t *pool;
+	uint32_t *pool_flows, *pool_values, ev_type, timestamp, j;
+	size_t ctxts_size;
+	uint64_t i, start, cycles;
+	unsigned int run;
+	int ret = -1;
+
+	ctxts_size = ((size_t)sim->nb_flows * sizeof(*ctxts) + 63) & ~(size_t)63;
+	ctxts = aligned_alloc(64, ctxts_size);
+	pool = calloc(SIM_BENCH_POOL, sizeof(*pool));
+	pool_flows = calloc(SIM_BENCH_POOL, sizeof(*pool_flows));
+	pool_values = calloc(SIM_BENCH_POOL, sizeof(*pool_values));
+	if (ctxts == NULL || pool == NULL || pool_flows == NULL || pool_values == NULL) {
+		fprintf(stderr, "Failed to allocate the benchmark flows\n");
+		goto free_pool;
+	}
+
+	attr.algo_slot = sim->algo_slot;
+	printf("Benchmark:         slot %u, %s, %u flows (%zu KB of contexts), %" PRIu64 " events per run\n",
+	       sim->algo_slot, pcc_dev_model_algo_desc(SIM_PORT, sim->algo_slot), sim->nb_flows, ctxts_size / 1024,
+	       nb_events);
+
+	for (run = 0; run < sizeof(run_types) / sizeof(run_types[0]); run++) {
+		/* Every flow starts with its first TX event, out of the measurement */
+		memset(ctxts, 0, ctxts_size);
+		for (j = 0; j < sim->nb_flows; j++) {
+			sim_build_event(&pool[0], DOCA_PCC_DEV_EVNT_ROCE_TX, 0, j, 0, 0, 0);
+			doca_pcc_dev_user_algo(&ctxts[j], &pool[0], &attr, &results);
+		}
+
+		for (j = 0; j < SIM_BENCH_POOL; j++) {
+			ev_type = run_types[run] != DOCA_PCC_DEV_EVNT_NULL ? run_types[run] : sim_bench_mixed_type(sim);
+			pool_flows[j] = (uint32_t)(sim_random(sim) * sim->nb_flows);
+			/* RTTs around the base RTT, so the algorithms take both their increase and decrease paths */
+			if (ev_type == DOCA_PCC_DEV_EVNT_RTT)
+				pool_values[j] = sim->base_rtt / 2 + (uint32_t)(sim_random(sim) * sim->base_rtt * 2);
+			else
+				pool_values[j] = SIM_MTU;
+			sim_build_event(&pool[j], ev_type, 0, pool_flows[j], j, 0, pool_values[j]);
+		}
+
+		start = sim_cycles();
+		for (i = 0; i < nb_events; i++) {
+			j = i & (SIM_BENCH_POOL - 1);
+			timestamp = (uint32_t)((i + 1) * SIM_BENCH_EVENT_GAP);
+			sim_put_be32(&pool[j].timestamp, timestamp);
+			sim_put_be32(&pool[j].ev_spec_attr.rtt_tstamp.req_send_timestamp, timestamp - pool_values[j]);
+			pcc_dev_model_set_time(timestamp);
+			doca_pcc_dev_user_algo(&ctxts[pool_flows[j]], &pool[j], &attr, &results);
+		}
+		cycles = sim_cycles() - start;
+
+#if defined(__x86_64__) || defined(__i386__)
+		printf("%-18s %.1f cycles per event\n",
+#else
+		printf("%-18s %.1f ns per event\n",
+#endif
+		       run_types[run] != DOCA_PCC_DEV_EVNT_NULL ? sim_event_names[run_types[run]] : "mixed",
+		       (double)cycles / nb_events);
+	}
+	ret = 0;
+
+free_pool:
+	free(pool_values);
+	free(pool_flows);
+	free(pool);
+	free(ctxts);
+	return ret;
+}
+
+/*
+ * Print the algorithms of the enabled slots, with their parameters and counters
+ */
+static void
+sim_list_algos(void)
+{
+	struct pcc_dev_model_param_info info;
+	uint32_t slot, i, *params;
+	const char *desc;
+
+	for (slot = 0; slot < DOCA_PCC_DEV_MAX_NUM_USER_SLOTS; slot++) {
+		if (!pcc_dev_model_slot_enabled(SIM_PORT, slot))
+			continue;
+		printf("Algo slot %u: %s\n", slot, pcc_dev_model_algo_desc(SIM_PORT, slot));
+		params = doca_pcc_dev_get_algo_params(SIM_PORT, slot);
+		for (i = 0; pcc_dev_model_get_param_info(SIM_PORT, slot, i, &info) == 0; i++)
+			printf("  param %2u: %-45s = %u (default %u, %u to %u)\n", i, info.desc, params[i],
+			       info.default_value, info.min_value, info.max_value);
+		for (i = 0; (desc = pcc_dev_model_counter_desc(SIM_PORT, slot, i)) != NULL; i++)
+			printf("  counter %u: %s\n", i, desc);
+	}
+}
+
+/*
+ * Write a gnuplot script that plots the CSV file
+ *
+ * @path [in]: Script path
+ * @csv [in]: CSV file path
+ * @plot_flows [in]: Number of flow rate columns
+ * @return: 0 on success and -1 otherwise
+ */
+static int
+sim_write_plot(const char *path, const char *csv, uint32_t plot_flows)
+{
+	FILE *plot = fopen(path, "w");
+
+	if (plot == NULL) {
+		fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	fprintf(plot, "set datafile separator ','\n"
+		      "set key autotitle columnhead outside\n"
+		      "set xlabel 'time (us)'\n"
+		      "set ylabel 'rate (Gb/s)'\n"
+		      "set y2label 'queue (KB)'\n"
+		      "set y2tics\n"
+		      "plot for [i=7:%u] '%s' using 1:i with lines, '' using 1:3 with lines lw 2, "
+		      "'' using 1:2 axes x1y2 with lines dt 2\n",
+		plot_flows + 6, csv);
+	fclose(plot);
+	return 0;
+}
+
+/*
+ * Print the usage of the simulator
+ *
+ * @prog [in]: Program name
+ */
+static void
+usage(const char *prog)
+{
+	printf("Usage: %s [-a <slot>] [-f <flows>] [-d <duration>] [-s <stagger>] [-l <link>] [-R <base rtt>] "
+	       "[-q <buffer>] [-P <NAME=VALUE>]... [-r <events>] [-w <events>] [-o <csv>] [-g <gnuplot>] "
+	       "[-i <interval>] [-p <flows>] [-S <seed>] [-b <events>] [-L] [-v]\n"
+	       "  -a, --algo-slot   algo slot of the flows (default 0)\n"
+	       "  -f, --flows       number of flows, 1 to %d (default %d)\n"
+	       "  -d, --duration    simulated time in us (default %d)\n"
+	       "  -s, --stagger     time between the start of two flows in us (default %d)\n"
+	       "  -l, --link        line rate and bottleneck link speed in Gb/s (default %d)\n"
+	       "  -R, --base-rtt    RTT of an empty network in ns (default %d)\n"
+	       "  -q, --buffer      bottleneck buffer in KB (default %d)\n"
+	       "  -P, --param       set a parameter of the algo slot, by name or id\n"
+	       "  -r, --replay      replay a recorded event stream instead of modelling the network\n"
+	       "  -w, --record      write the event stream\n"
+	       "  -o, --output      CSV file of the sampled rates\n"
+	       "  -g, --gnuplot     gnuplot script plotting the CSV file\n"
+	       "  -i, --interval    sampling interval in us (default %d)\n"
+	       "  -p, --plot-flows  flows with a rate column in the CSV file (default %d)\n"
+	       "  -S, --seed        random seed\n"
+	       "  -b, --bench       measure the cycles of the algorithm on this number of events per event type\n"
+	       "  -L, --list        list the algorithms, their parameters and counters\n"
+	       "  -v, --verbose     print the device printf and trace output\n",
+	       prog, SIM_MAX_FLOWS, SIM_FLOWS_DEFAULT, SIM_DURATION_DEFAULT, SIM_STAGGER_DEFAULT, SIM_LINK_DEFAULT,
+	       SIM_BASE_RTT_DEFAULT, SIM_BUFFER_DEFAULT, SIM_INTERVAL_DEFAULT, SIM_PLOT_FLOWS_DEFAULT);
+}
+
+int
+main(int argc, char **argv)
+{
+	static const struct option long_options[] = {
+		{"algo-slot", required_argument, NULL, 'a'},
+		{"flows", required_argument, NULL, 'f'},
+		{"duration", required_argument, NULL, 'd'},
+		{"stagger", required_argument, NULL, 's'},
+		{"link", required_argument, NULL, 'l'},
+		{"base-rtt", required_argument, NULL, 'R'},
+		{"buffer", required_argument, NULL, 'q'},
+		{"param", required_argument, NULL, 'P'},
+		{"replay", required_argument, NULL, 'r'},
+		{"record", required_argument, NULL, 'w'},
+		{"output", required_argument, NULL, 'o'},
+		{"gnuplot", required_argument, NULL, 'g'},
+		{"interval", required_argument, NULL, 'i'},
+		{"plot-flows", required_argument, NULL, 'p'},
+		{"seed", required_argument, NULL, 'S'},
+		{"bench", required_argument, NULL, 'b'},
+		{"list", no_argument, NULL, 'L'},
+		{"verbose", no_argument, NULL, 'v'},
+		{"help", no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0},
+	};
+	const char *replay = NULL, *record = NULL, *output = NULL, *gnuplot = NULL;
+	const char *settings[SIM_MAX_SET_PARAMS];
+	long algo_slot = 0, flows = SIM_FLOWS_DEFAULT, duration = SIM_DURATION_DEFAULT, stagger = SIM_STAGGER_DEFAULT;
+	long link = SIM_LINK_DEFAULT, base_rtt = SIM_BASE_RTT_DEFAULT, buffer = SIM_BUFFER_DEFAULT;
+	long interval = SIM_INTERVAL_DEFAULT, plot_flows = SIM_PLOT_FLOWS_DEFAULT;
+	uint32_t nb_settings = 0, i, *counters;
+	unsigned long seed = 1;
+	long long bench = 0;
+	bool list = false, verbose = false;
+	struct sim sim;
+	uint64_t nb_events = 0, elapsed;
+	const char *desc;
+	int opt, exit_status = EXIT_FAILURE;
+
+	while ((opt = getopt_long(argc, argv, "a:f:d:s:l:R:q:P:r:w:o:g:i:p:S:b:Lvh", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'a':
+			algo_slot = strtol(optarg, NULL, 0);
+			break;
+		case 'f':
+			flows = strtol(optarg, NULL, 0);
+			break;
+		case 'd':
+			duration = strtol(optarg, NULL, 0);
+			break;
+		case 's':
+			stagger = strtol(optarg, NULL, 0);
+			break;
+		case 'l':
+			link = strtol(optarg, NULL, 0);
+			break;
+		case 'R':
+			base_rtt = strtol(optarg, NULL, 0);
+			break;
+		case 'q':
+			buffer = strtol(optarg, NULL, 0);
+			break;
+		case 'P':
+			if (nb_settings == SIM_MAX_SET_PARAMS) {
+				fprintf(stderr, "Too many parameter settings\n");
+				return EXIT_FAILURE;
+			}
+			settings[nb_settings++] = optarg;
+			break;
+		case 'r':
+			replay = optarg;
+			break;
+		case 'w':
+			record = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'g':
+			gnuplot = optarg;
+			break;
+		case 'i':
+			interval = strtol(optarg, NULL, 0);
+			break;
+		case 'p':
+			plot_flows = strtol(optarg, NULL, 0);
+			break;
+		case 'S':
+			seed = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			bench = strtoll(optarg, NULL, 0);
+			break;
+		case 'L':
+			list = true;
+			break;
+		case 'v':
+			verbose = true;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (algo_slot < 0 || algo_slot >= DOCA_PCC_DEV_MAX_NUM_USER_SLOTS || flows < 1 || flows > SIM_MAX_FLOWS ||
+	    duration < 1 || stagger < 0 || link < 1 || base_rtt < 1 || buffer < 1 || interval < 1 || plot_flows < 0 ||
+	    bench < 0 || (gnuplot != NULL && output == NULL)) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	memset(&sim, 0, sizeof(sim));
+	pcc_dev_model_set_verbose(verbose);
+	doca_pcc_dev_user_init(&sim.disable_mask);
+	if (list) {
+		sim_list_algos();
+		return EXIT_SUCCESS;
+	}
+	if (!pcc_dev_model_slot_enabled(SIM_PORT, algo_slot)) {
+		fprintf(stderr, "Algo slot %ld is not enabled by the device code\n", algo_slot);
+		return EXIT_FAILURE;
+	}
+
+	sim.algo_slot = algo_slot;
+	for (i = 0; i < nb_settings; i++) {
+		if (sim_set_param(&sim, settings[i]) != 0)
+			return EXIT_FAILURE;
+	}
+
+	sim.nb_flows = flows;
+	sim.plot_flows = plot_flows < flows ? plot_flows : flows;
+	sim.link_gbps = link;
+	sim.link_bytes_per_ns = link / 8.0;
+	sim.base_rtt = base_rtt;
+	sim.buffer = buffer * 1024.0;
+	sim.interval = interval * 1000ULL;
+	sim.next_sample = sim.interval;
+	sim.rng = seed * 0x9E3779B97F4A7C15ULL + 1;
+	if (bench > 0)
+		return sim_bench(&sim, bench) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+	sim.flows = calloc(flows, sizeof(*sim.flows));
+	if (sim.flows == NULL) {
+		fprintf(stderr, "Failed to allocate %ld flows\n", flows);
+		return EXIT_FAILURE;
+	}
+	for (i = 0; i < sim.nb_flows; i++)
+		sim.flows[i].start = i * stagger * 1000ULL;
+
+	if (record != NULL) {
+		sim.record = fopen(record, "w");
+		if (sim.record == NULL) {
+			fprintf(stderr, "Failed to open %s: %s\n", record, strerror(errno));
+			goto free_flows;
+		}
+		fprintf(sim.record, "# time_ns flow event value\n");
+	}
+	if (output != NULL) {
+		sim.out = fopen(output, "w");
+		if (sim.out == NULL) {
+			fprintf(stderr, "Failed to open %s: %s\n", output, strerror(errno));
+			goto close_files;
+		}
+		fprintf(sim.out, "time_us,queue_kb,throughput_gbps,jain,min_rate_gbps,max_rate_gbps");
+		for (i = 0; i < sim.plot_flows; i++)
+			fprintf(sim.out, ",flow%u_gbps", i);
+		fprintf(sim.out, "\n");
+	}
+	if (gnuplot != NULL && sim_write_plot(gnuplot, output, sim.plot_flows) != 0)
+		goto close_files;
+
+	if (replay != NULL) {
+		if (sim_run_replay(&sim, replay) != 0)
+			goto close_files;
+	} else {
+		sim_run_synthetic(&sim, duration * 1000ULL);
+	}
+
+	for (i = 0; i < SIM_EVENT_TYPES; i++)
+		nb_events += sim.events[i];
+	elapsed = sim.now > sim.last_start ? sim.now - sim.last_start : 0;
+
+	printf("Algorithm:         slot %u, %s\n", sim.algo_slot, pcc_dev_model_algo_desc(SIM_PORT, sim.algo_slot));
+	printf("Flows:             %u started, the last at %.1f us\n", sim.nb_started, sim.last_start / 1000.0);
+	printf("Events:            %" PRIu64 " (tx %" PRIu64 ", rtt %" PRIu64 ", cnp %" PRIu64 ", nack %" PRIu64 ")\n",
+	       nb_events, sim.events[DOCA_PCC_DEV_EVNT_ROCE_TX], sim.events[DOCA_PCC_DEV_EVNT_RTT],
+	       sim.events[DOCA_PCC_DEV_EVNT_ROCE_CNP], sim.events[DOCA_PCC_DEV_EVNT_ROCE_NACK]);
+#if defined(__x86_64__) || defined(__i386__)
+	printf("Algorithm cycles:  %.1f per event\n", nb_events ? (double)sim.algo_cycles / nb_events : 0.0);
+#else
+	printf("Algorithm time:    %.1f ns per event\n", nb_events ? (double)sim.algo_cycles / nb_events : 0.0);
+#endif
+	if (replay == NULL) {
+		printf("Throughput:        %.2f Gb/s after the last flow started (%.1f%% of the link)\n",
+		       elapsed ? (sim.drained_bytes - sim.drained_at_last_start) * 8 / elapsed : 0.0,
+		       elapsed ? (sim.drained_bytes - sim.drained_at_last_start) * 8 / elapsed / link * 100 : 0.0);
+		printf("Queue:             %.1f KB mean, %.1f KB max, %.1f KB dropped\n",
+		       sim.nb_samples ? sim.queue_sum / sim.nb_samples / 1024 : 0.0, sim.queue_max / 1024,
+		       sim.dropped_bytes / 1024);
+	}
+	printf("Fairness:          Jain index %.4f at the end, %.4f mean after the last flow started\n", sim.last_jain,
+	       sim.nb_jain ? sim.jain_sum / sim.nb_jain : 0.0);
+	if (sim.fair_since != 0)
+		printf("Convergence:       %.1f us after the last flow started (Jain index >= %.2f)\n",
+		       (sim.fair_since - sim.last_start) / 1000.0, SIM_FAIR_JAIN);
+	else
+		printf("Convergence:       not converged (Jain index >= %.2f)\n", SIM_FAIR_JAIN);
+	counters = doca_pcc_dev_get_counters(SIM_PORT, sim.algo_slot);
+	for (i = 0; (desc = pcc_dev_model_counter_desc(SIM_PORT, sim.algo_slot, i)) != NULL; i++)
+		printf("Counter %u:         %u (%s)\n", i, counters[i], desc);
+
+	exit_status = EXIT_SUCCESS;
+
+close_files:
+	if (sim.out != NULL)
+		fclose(sim.out);
+	if (sim.record != NULL)
+		fclose(sim.record);
+free_flows:
+	free(sim.flows);
+	return exit_status;
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+/*
+ * Benchmark of the flow pipes manager the switch keeps its pipe and entry IDs in.
+ * The manager is filled with live entries spread over pipes and ports, then runs add/remove cycles: a random live
+ * entry is removed and a new entry is added to a random pipe, the way a control plane churns rules. Stale IDs are
+ * checked to be rejected, then every port is flushed. The manager only keeps pointers, so no device is needed.
+ */
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "flow_pipes_manager.h"
+
+#define BENCH_CYCLES_DEFAULT 1000000 /* Default number of add/remove cycles */
+#define BENCH_LIVE_DEFAULT 65536     /* Default number of live entries */
+#define BENCH_PIPES_DEFAULT 64	     /* Default number of pipes */
+#define BENCH_PORTS_DEFAULT 2	     /* Default number of ports */
+#define BENCH_NB_STALE_CHECKS 4096   /* Number of removed IDs checked to be rejected */
+
+/*
+ * Get the time of a monotonic clock
+ *
+ * @return: Current time (nanoseconds)
+ */
+static inline uint64_t
+bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Get a random number
+ *
+ * @rng [in/out]: Random state, never 0
+ * @return: Random number
+ */
+static inline uint64_t
+bench_random(uint64_t *rng)
+{
+	/* xorshift64* */
+	*rng ^= *rng >> 12;
+	*rng ^= *rng << 25;
+	*rng ^= *rng >> 27;
+	return *rng * 0x2545F4914F6CDD1DULL;
+}
+
+/*
+ * Make a fake DOCA Flow object, the manager never dereferences it
+ *
+ * @n [in]: Object number
+ * @return: Object pointer
+ */
+static inline void *
+bench_object(uint64_t n)
+{
+	return (void *)(uintptr_t)((n + 1) * 64);
+}
+
+/*
+ * Print the usage of the benchmark
+ *
+ * @prog [in]: Program name
+ */
+static void
+usage(const char *prog)
+{
+	printf("Usage: %s [-c <cycles>] [-l <entries>] [-p <pipes>] [-P <ports>] [-S <seed>]\n"
+	       "  -c, --cycles   add/remove cycles (default %d)\n"
+	       "  -l, --live     live entries during the cycles (default %d)\n"
+	       "  -p, --pipes    pipes the entries are spread over (default %d)\n"
+	       "  -P, --ports    ports the pipes are spread over (default %d)\n"
+	       "  -S, --seed     random seed\n",
+	       prog, BENCH_CYCLES_DEFAULT, BENCH_LIVE_DEFAULT, BENCH_PIPES_DEFAULT, BENCH_PORTS_DEFAULT);
+}
+
+int
+main(int argc, char **argv)
+{
+	static const struct option long_options[] = {
+		{"cycles", required_argument, NULL, 'c'},
+		{"live", required_argument, NULL, 'l'},
+		{"pipes", required_argument, NULL, 'p'},
+		{"ports", required_argument, NULL, 'P'},
+		{"seed", required_argument, NULL, 'S'},
+		{"help", no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0},
+	};
+	long long nb_cycles = BENCH_CYCLES_DEFAULT, nb_live = BENCH_LIVE_DEFAULT;
+	long nb_pipes = BENCH_PIPES_DEFAULT, nb_ports = BENCH_PORTS_DEFAULT;
+	struct flow_pipes_manager *manager;
+	struct doca_flow_pipe_entry *entry;
+	uint64_t *pipe_ids = NULL, *entry_ids = NULL, rng = 1, start, elapsed, peak_memory, id, n;
+	long long i, k;
+	long port;
+	int opt, exit_status = EXIT_FAILURE;
+
+	while ((opt = getopt_long(argc, argv, "c:l:p:P:S:h", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'c':
+			nb_cycles = strtoll(optarg, NULL, 0);
+			break;
+		case 'l':
+			nb_live = strtoll(optarg, NULL, 0);
+			break;
+		case 'p':
+			nb_pipes = strtol(optarg, NULL, 0);
+			break;
+		case 'P':
+			nb_ports = strtol(optarg, NULL, 0);
+			break;
+		case 'S':
+			rng = strtoull(optarg, NULL, 0);
+			if (rng == 0)
+				rng = 1;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (nb_cycles < 0 || nb_live <= 0 || nb_pipes <= 0 || nb_ports <= 0 || nb_ports > UINT16_MAX ||
+	    nb_ports > nb_pipes) {
+		fprintf(stderr, "Invalid arguments: at least one entry and pipe, and at most a port per pipe\n");
+		return EXIT_FAILURE;
+	}
+
+	if (create_pipes_manager(&manager) != DOCA_SUCCESS)
+		return EXIT_FAILURE;
+	pipe_ids = malloc(nb_pipes * sizeof(*pipe_ids));
+	entry_ids = malloc(nb_live * sizeof(*entry_ids));
+	if (pipe_ids == NULL || entry_ids == NULL) {
+		fprintf(stderr, "Failed to allocate the IDs\n");
+		goto destroy_manager;
+	}
+
+	for (i = 0; i < nb_pipes; i++) {
+		if (pipes_manager_pipe_create(manager, bench_object(i), i % nb_ports, &pipe_ids[i]) != DOCA_SUCCESS)
+			goto destroy_manager;
+	}
+
+	n = 0;
+	start = bench_now();
+	for (i = 0; i < nb_live; i++) {
+		if (pipes_manager_pipe_add_entry(manager, bench_object(n++), pipe_ids[bench_random(&rng) % nb_pipes],
+						 &entry_ids[i]) != DOCA_SUCCESS)
+			goto destroy_manager;
+	}
+	elapsed = bench_now() - start;
+	printf("Fill:      %lld entries on %ld pipes and %ld ports, %.1f ns per entry\n", nb_live, nb_pipes, nb_ports,
+	       (double)elapsed / nb_live);
+
+	start = bench_now();
+	for (i = 0; i < nb_cycles; i++) {
+		k = bench_random(&rng) % nb_live;
+		if (pipes_manager_pipe_rm_entry(manager, entry_ids[k]) != DOCA_SUCCESS ||
+		    pipes_manager_pipe_add_entry(manager, bench_object(n++), pipe_ids[bench_random(&rng) % nb_pipes],
+						 &entry_ids[k]) != DOCA_SUCCESS) {
+			fprintf(stderr, "Add/remove cycle %lld failed\n", i);
+			goto destroy_manager;
+		}
+	}
+	elapsed = bench_now() - start;
+	peak_memory = flow_id_registry_memory(&manager->registry);
+	if (nb_cycles > 0)
+		printf("Cycles:    %lld add/remove cycles, %.1f ns per cycle, %.2f M cycles/sec\n", nb_cycles,
+		       (double)elapsed / nb_cycles, nb_cycles * 1000.0 / elapsed);
+	printf("Memory:    %" PRIu64 " KB for %lld live entries, %.1f bytes per entry\n", peak_memory / 1024,
+	       nb_live, (double)peak_memory / nb_live);
+
+	/* A removed ID must not find the entry that reused its slot */
+	for (i = 0; i < BENCH_NB_STALE_CHECKS && i < nb_live; i++) {
+		id = entry_ids[i];
+		if (pipes_manager_pipe_rm_entry(manager, id) != DOCA_SUCCESS ||
+		    pipes_manager_pipe_add_entry(manager, bench_object(n++), pipe_ids[i % nb_pipes], &entry_ids[i]) !=
+			    DOCA_SUCCESS) {
+			fprintf(stderr, "Add/remove of entry %lld failed\n", i);
+			goto destroy_manager;
+		}
+		if (entry_ids[i] == id || pipes_manager_get_entry(manager, id, &entry) == DOCA_SUCCESS) {
+			fprintf(stderr, "Removed entry ID %" PRIu64 " is still valid\n", id);
+			goto destroy_manager;
+		}
+	}
+
+	start = bench_now();
+	for (port = 0; port < nb_ports; port++) {
+		if (pipes_manager_pipes_flush(manager, port) != DOCA_SUCCESS)
+			goto destroy_manager;
+	}
+	elapsed = bench_now() - start;
+	printf("Flush:     %ld ports in %.3f ms, %" PRIu64 " KB left\n", nb_ports, elapsed / 1e6,
+	       flow_id_registry_memory(&manager->registry) / 1024);
+
+	for (i = 0; i < nb_pipes; i++) {
+		if (pipes_manager_get_pipe(manager, pipe_ids[i], (struct doca_flow_pipe **)&entry) == DOCA_SUCCESS) {
+			fprintf(stderr, "Flushed pipe ID %" PRIu64 " is still valid\n", pipe_ids[i]);
+			goto destroy_manager;
+		}
+	}
+	exit_status = EXIT_SUCCESS;
+
+destroy_manager:
+	free(entry_ids);
+	free(pipe_ids);
+	destroy_pipes_manager(manager);
+	return exit_status;
+}
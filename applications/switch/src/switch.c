@@ -38,6 +38,7 @@ main(int argc, char **argv)
 	int exit_status = EXIT_SUCCESS;
 	struct doca_log_backend *sdk_log;
 	struct application_dpdk_config dpdk_config = {0};
+	struct switch_cfg switch_cfg = {.rules_batch_size = SWITCH_DEFAULT_BATCH_SIZE};
 
 	/* Register a logger backend */
 	result = doca_log_backend_create_standard();
@@ -53,12 +54,18 @@ main(int argc, char **argv)
 		return EXIT_FAILURE;
 
 	/* Parse cmdline/json arguments */
-	result = doca_argp_init("doca_switch", NULL);
+	result = doca_argp_init("doca_switch", &switch_cfg);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to init ARGP resources: %s", doca_error_get_descr(result));
 		return EXIT_FAILURE;
 	}
 	doca_argp_set_dpdk_program(dpdk_init);
+	result = register_switch_params();
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register application params: %s", doca_error_get_descr(result));
+		doca_argp_destroy();
+		return EXIT_FAILURE;
+	}
 	result = doca_argp_start(argc, argv);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to parse application input: %s", doca_error_get_descr(result));
@@ -84,6 +91,25 @@ main(int argc, char **argv)
 		goto dpdk_cleanup;
 	}
 
+	/* Compile the rules file, then load the compiled file which skips parsing the command lines */
+	if (switch_cfg.compiled_path[0] != '\0') {
+		result = flow_parser_compile_rules(switch_cfg.rules_path, switch_cfg.compiled_path, false);
+		if (result != DOCA_SUCCESS) {
+			exit_status = EXIT_FAILURE;
+			goto switch_cleanup;
+		}
+		strlcpy(switch_cfg.rules_path, switch_cfg.compiled_path, SWITCH_MAX_FILE_NAME);
+	}
+
+	/* Run the rules file commands before opening the CLI */
+	if (switch_cfg.rules_path[0] != '\0') {
+		result = flow_parser_load_rules(switch_cfg.rules_path, false, switch_cfg.rules_batch_size);
+		if (result != DOCA_SUCCESS) {
+			exit_status = EXIT_FAILURE;
+			goto switch_cleanup;
+		}
+	}
+
 	/* Initiate Flow Parser */
 	result = flow_parser_init("SWITCH>> ", false);
 	if (result != DOCA_SUCCESS) {
@@ -11,11 +11,15 @@
  *
  */
 
+#include <string.h>
+
 #include <rte_ethdev.h>
 
+#include <doca_argp.h>
 #include <doca_log.h>
 
 #include "dpdk_utils.h"
+#include "utils.h"
 #include "flow_pipes_manager.h"
 #include "switch_core.h"
 
@@ -32,6 +36,166 @@ struct entries_status {
 	int nb_processed;	/* will hold the number of entries that was already processed */
 };
 
+/* Entry added with DOCA_FLOW_WAIT_FOR_BATCH, registered in the pipes manager once its batch is processed */
+struct pending_entry {
+	struct doca_flow_pipe_entry *entry;	/* DOCA Flow entry */
+	uint64_t pipe_id;			/* Pipe ID of the entry */
+	struct entries_status status;		/* Status of the entry, user context of the entry process callback */
+};
+
+static struct pending_entry pending_entries[SWITCH_MAX_BATCH_SIZE];	/* Entries of the current batch */
+static int nb_pending_entries;						/* Number of entries in the current batch */
+
+/*
+ * ARGP Callback - Handle rules file parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+rules_callback(void *param, void *config)
+{
+	struct switch_cfg *switch_cfg = (struct switch_cfg *)config;
+	const char *rules_path = (char *)param;
+
+	if (strnlen(rules_path, SWITCH_MAX_FILE_NAME) == SWITCH_MAX_FILE_NAME) {
+		DOCA_LOG_ERR("Rules file name is too long - MAX=%d", SWITCH_MAX_FILE_NAME - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strlcpy(switch_cfg->rules_path, rules_path, SWITCH_MAX_FILE_NAME);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle rules batch size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+rules_batch_size_callback(void *param, void *config)
+{
+	struct switch_cfg *switch_cfg = (struct switch_cfg *)config;
+	int batch_size = *(int *)param;
+
+	if (batch_size < 1 || batch_size > SWITCH_MAX_BATCH_SIZE) {
+		DOCA_LOG_ERR("Rules batch size must be between 1 and %d", SWITCH_MAX_BATCH_SIZE);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	switch_cfg->rules_batch_size = batch_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle compiled rules file parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+rules_compile_callback(void *param, void *config)
+{
+	struct switch_cfg *switch_cfg = (struct switch_cfg *)config;
+	const char *compiled_path = (char *)param;
+
+	if (strnlen(compiled_path, SWITCH_MAX_FILE_NAME) == SWITCH_MAX_FILE_NAME) {
+		DOCA_LOG_ERR("Compiled rules file name is too long - MAX=%d", SWITCH_MAX_FILE_NAME - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strlcpy(switch_cfg->compiled_path, compiled_path, SWITCH_MAX_FILE_NAME);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP validation Callback - check the compiled rules file has a rules file to compile
+ *
+ * @config [in]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+switch_args_validation_callback(void *config)
+{
+	struct switch_cfg *switch_cfg = (struct switch_cfg *)config;
+
+	if (switch_cfg->compiled_path[0] != '\0' && switch_cfg->rules_path[0] == '\0') {
+		DOCA_LOG_ERR("Missing rules file to compile");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+register_switch_params(void)
+{
+	doca_error_t result;
+	struct doca_argp_param *rules_param, *batch_size_param, *compile_param;
+
+	/* Create and register rules file param */
+	result = doca_argp_param_create(&rules_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(rules_param, "r");
+	doca_argp_param_set_long_name(rules_param, "rules");
+	doca_argp_param_set_arguments(rules_param, "<path>");
+	doca_argp_param_set_description(rules_param, "Path to a file of CLI commands to run before opening the CLI");
+	doca_argp_param_set_callback(rules_param, rules_callback);
+	doca_argp_param_set_type(rules_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(rules_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register rules batch size param */
+	result = doca_argp_param_create(&batch_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(batch_size_param, "b");
+	doca_argp_param_set_long_name(batch_size_param, "rules-batch-size");
+	doca_argp_param_set_arguments(batch_size_param, "<size>");
+	doca_argp_param_set_description(batch_size_param, "Rules file entries processed together, default 64");
+	doca_argp_param_set_callback(batch_size_param, rules_batch_size_callback);
+	doca_argp_param_set_type(batch_size_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(batch_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register compiled rules file param */
+	result = doca_argp_param_create(&compile_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(compile_param, "rules-compile");
+	doca_argp_param_set_arguments(compile_param, "<path>");
+	doca_argp_param_set_description(compile_param, "Compile the rules file to a binary file that loads faster");
+	doca_argp_param_set_callback(compile_param, rules_compile_callback);
+	doca_argp_param_set_type(compile_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(compile_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Register application callback */
+	result = doca_argp_register_validation_callback(switch_args_validation_callback);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program validation callback: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	return DOCA_SUCCESS;
+}
+
 /*
  * Entry processing callback
  *
@@ -60,6 +224,55 @@ check_for_valid_entry(struct doca_flow_pipe_entry *entry, uint16_t pipe_queue,
 	entry_status->nb_processed++;
 }
 
+/*
+ * Process the pending entries and register the added ones in the pipes manager
+ */
+static void
+process_pending_entries(void)
+{
+	struct pending_entry *pending;
+	uint64_t entry_id;
+	int i, nb_processed, prev_nb_processed = -1;
+	doca_error_t result;
+
+	if (nb_pending_entries == 0)
+		return;
+
+	/* Process until all the entries are done or a round makes no progress */
+	for (;;) {
+		nb_processed = 0;
+		for (i = 0; i < nb_pending_entries; i++)
+			nb_processed += pending_entries[i].status.nb_processed;
+		if (nb_processed == nb_pending_entries || nb_processed == prev_nb_processed)
+			break;
+		prev_nb_processed = nb_processed;
+		result = doca_flow_entries_process(doca_flow_port_switch_get(NULL), 0, DEFAULT_TIMEOUT_US,
+						   nb_pending_entries - nb_processed);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Entries processing failed: %s", doca_error_get_descr(result));
+			break;
+		}
+	}
+
+	for (i = 0; i < nb_pending_entries; i++) {
+		pending = &pending_entries[i];
+		if (pending->status.nb_processed != 1 || pending->status.failure) {
+			DOCA_LOG_ERR("Entry creation failed");
+			continue;
+		}
+
+		if (pipes_manager_pipe_add_entry(pipes_manager, pending->entry, pending->pipe_id, &entry_id) !=
+		    DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Flow Pipes Manager failed to add entry");
+			doca_flow_pipe_rm_entry(0, DOCA_FLOW_NO_WAIT, pending->entry);
+			continue;
+		}
+
+		DOCA_LOG_INFO("Entry created successfully with id: %" PRIu64, entry_id);
+	}
+	nb_pending_entries = 0;
+}
+
 /*
  * Create DOCA Flow pipe
  *
@@ -129,7 +342,7 @@ pipe_create(struct doca_flow_pipe_cfg *cfg, uint16_t port_id, struct doca_flow_f
  * @monitor [in]: DOCA Flow monitor
  * @fwd [in]: DOCA Flow forward
  * @fw_pipe_id [in]: Pipe ID to forward
- * @flags [in]: Hardware steering flag, current implementation supports DOCA_FLOW_NO_WAIT only
+ * @flags [in]: DOCA_FLOW_WAIT_FOR_BATCH to keep the entry pending, DOCA_FLOW_NO_WAIT to process the pending batch
  */
 static void
 pipe_add_entry(uint16_t pipe_queue, uint64_t pipe_id, struct doca_flow_match *match,
@@ -139,12 +352,8 @@ pipe_add_entry(uint16_t pipe_queue, uint64_t pipe_id, struct doca_flow_match *ma
 	(void)pipe_queue;
 
 	struct doca_flow_pipe *pipe;
-	struct doca_flow_pipe_entry *entry;
-	uint64_t entry_id;
+	struct pending_entry *pending;
 	doca_error_t result;
-	struct entries_status status = {0};
-	int num_of_entries = 1;
-	uint32_t hws_flag = flags;
 
 	DOCA_LOG_DBG("Add entry is being called");
 
@@ -152,45 +361,37 @@ pipe_add_entry(uint16_t pipe_queue, uint64_t pipe_id, struct doca_flow_match *ma
 		result = pipes_manager_get_pipe(pipes_manager, fw_pipe_id, &fwd->next_pipe);
 		if (result != DOCA_SUCCESS) {
 			DOCA_LOG_ERR("Failed to find relevant fwd pipe with id %" PRIu64, fw_pipe_id);
-			return;
+			goto process_batch;
 		}
 	}
 
 	result = pipes_manager_get_pipe(pipes_manager, pipe_id, &pipe);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to find pipe with id %" PRIu64 " to add entry into", pipe_id);
-		return;
+		goto process_batch;
 	}
 
-	if (hws_flag != DOCA_FLOW_NO_WAIT) {
-		DOCA_LOG_DBG("Batch insertion of pipe entries is not supported");
-		hws_flag = DOCA_FLOW_NO_WAIT;
-	}
+	/* A full batch is processed even if more entries are on the way */
+	if (nb_pending_entries == SWITCH_MAX_BATCH_SIZE - 1)
+		flags = DOCA_FLOW_NO_WAIT;
 
-	result = doca_flow_pipe_add_entry(0, pipe, match, actions, monitor, fwd, hws_flag, &status, &entry);
+	pending = &pending_entries[nb_pending_entries];
+	memset(&pending->status, 0, sizeof(pending->status));
+	result = doca_flow_pipe_add_entry(0, pipe, match, actions, monitor, fwd, flags, &pending->status,
+					  &pending->entry);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Entry creation failed: %s", doca_error_get_descr(result));
-		return;
+		goto process_batch;
 	}
+	pending->pipe_id = pipe_id;
+	nb_pending_entries++;
 
-	result = doca_flow_entries_process(doca_flow_port_switch_get(NULL), 0, DEFAULT_TIMEOUT_US, num_of_entries);
-	if (result != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Entry creation FAILED: %s", doca_error_get_descr(result));
+	if (flags != DOCA_FLOW_NO_WAIT)
 		return;
-	}
-
-	if (status.nb_processed != num_of_entries || status.failure) {
-		DOCA_LOG_ERR("Entry creation failed");
-		return;
-	}
-
-	if (pipes_manager_pipe_add_entry(pipes_manager, entry, pipe_id, &entry_id) != DOCA_SUCCESS) {
-		DOCA_LOG_ERR("Flow Pipes Manager failed to add entry");
-		doca_flow_pipe_rm_entry(0, DOCA_FLOW_NO_WAIT, entry);
-		return;
-	}
 
-	DOCA_LOG_INFO("Entry created successfully with id: %" PRIu64, entry_id);
+process_batch:
+	/* Entries already waiting for this batch are processed without a failed entry */
+	process_pending_entries();
 }
 
 /*
@@ -16,6 +16,24 @@
 
 #include "flow_parser.h"
 
+#define SWITCH_MAX_FILE_NAME 255	 /* Maximal length of a file path */
+#define SWITCH_MAX_BATCH_SIZE 128	 /* Maximal number of entries in a batch, the default queue depth */
+#define SWITCH_DEFAULT_BATCH_SIZE 64	 /* Default number of rules file entries in a batch */
+
+/* Switch configuration struct */
+struct switch_cfg {
+	char rules_path[SWITCH_MAX_FILE_NAME];	  /* Path of a rules file to load before opening the CLI */
+	char compiled_path[SWITCH_MAX_FILE_NAME]; /* Path to compile the rules file to */
+	uint32_t rules_batch_size;		  /* Number of rules file entries in a batch */
+};
+
+/*
+ * Register the command line parameters for the Switch application
+ *
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t register_switch_params(void);
+
 /*
  * Count the total number of ports
  *
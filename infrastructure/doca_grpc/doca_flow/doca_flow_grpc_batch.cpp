@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <doca_log.h>
+
+#include "doca_flow_grpc_batch.hpp"
+
+DOCA_LOG_REGISTER(DOCA_FLOW_GRPC::BATCH);
+
+doca_error_t
+doca_flow_grpc_call_result(const grpc::Status &status, const DocaFlowResponse &response)
+{
+	if (status.error_code() == grpc::StatusCode::UNIMPLEMENTED)
+		return DOCA_ERROR_NOT_SUPPORTED;
+	if (!status.ok()) {
+		DOCA_LOG_ERR("DOCA Flow gRPC call failed: %s", status.error_message().c_str());
+		return DOCA_ERROR_IO_FAILED;
+	}
+	if (!response.success())
+		return response.result() != DOCA_SUCCESS ? (doca_error_t)response.result() : DOCA_ERROR_UNKNOWN;
+	return DOCA_SUCCESS;
+}
+
+DocaFlowEntryBatcher::DocaFlowEntryBatcher(std::shared_ptr<grpc::Channel> channel,
+					   enum doca_flow_grpc_batch_mode mode,
+					   uint64_t port_id,
+					   uint32_t pipe_queue,
+					   uint32_t batch_size,
+					   uint64_t timeout_us)
+	: stub_(DocaFlow::NewStub(channel)),
+	  mode_(mode),
+	  batch_size_(batch_size > 0 ? batch_size : 1),
+	  nb_streamed_(0),
+	  nb_failed_(0),
+	  nb_rpcs_(0)
+{
+	request_.set_port_id(port_id);
+	request_.set_pipe_queue(pipe_queue);
+	request_.set_timeout(timeout_us);
+}
+
+DocaFlowEntryBatcher::~DocaFlowEntryBatcher()
+{
+	if (writer_ != nullptr)
+		context_->TryCancel();
+}
+
+doca_error_t
+DocaFlowEntryBatcher::add_entry(DocaFlowPipeAddEntryRequest **entry)
+{
+	doca_error_t result;
+
+	if ((uint32_t)request_.entries_size() >= batch_size_) {
+		result = flush();
+		if (result != DOCA_SUCCESS)
+			return result;
+	}
+	/* Cleared entries of the previous batch are reused, so their sub-messages are not allocated again */
+	*entry = request_.add_entries();
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+DocaFlowEntryBatcher::collect(const DocaFlowResponse &response, size_t nb_entries)
+{
+	const EntriesProcessRes &res = response.entries_process_res();
+
+	if ((size_t)res.entries_ids_size() != nb_entries || (size_t)res.status_size() != nb_entries) {
+		DOCA_LOG_ERR("Server returned the status of %d entries instead of %zu", res.status_size(), nb_entries);
+		return DOCA_ERROR_BAD_STATE;
+	}
+
+	for (size_t i = 0; i < nb_entries; i++) {
+		entry_ids_.push_back(res.entries_ids((int)i));
+		statuses_.push_back((DocaFlowEntryStatus)res.status((int)i));
+		if (res.status((int)i) != ENTRY_STATUS_SUCCESS)
+			nb_failed_++;
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+DocaFlowEntryBatcher::flush(void)
+{
+	size_t nb_entries = request_.entries_size();
+	doca_error_t result = DOCA_SUCCESS, tmp_result;
+
+	if (nb_entries == 0)
+		return DOCA_SUCCESS;
+
+	if (mode_ == DOCA_FLOW_GRPC_BATCH_UNARY) {
+		grpc::ClientContext context;
+		DocaFlowResponse response;
+		grpc::Status status;
+
+		status = stub_->DocaFlowPipeAddEntries(&context, request_, &response);
+		nb_rpcs_++;
+		result = doca_flow_grpc_call_result(status, response);
+		/* A failed batch still returns the status of its entries */
+		if (status.ok()) {
+			tmp_result = collect(response, nb_entries);
+			DOCA_ERROR_PROPAGATE(result, tmp_result);
+		}
+	} else {
+		if (writer_ == nullptr) {
+			context_.reset(new grpc::ClientContext());
+			writer_ = stub_->DocaFlowPipeAddEntriesStream(context_.get(), &stream_response_);
+			nb_rpcs_++;
+		}
+		if (!writer_->Write(request_)) {
+			/* The stream is broken, its status explains why */
+			DOCA_LOG_ERR("Failed to write a batch of entries to the stream");
+			result = DOCA_ERROR_IO_FAILED;
+		} else {
+			nb_streamed_ += nb_entries;
+		}
+	}
+
+	request_.mutable_entries()->Clear();
+	return result;
+}
+
+doca_error_t
+DocaFlowEntryBatcher::finish(void)
+{
+	grpc::Status status;
+	doca_error_t result, tmp_result;
+
+	result = flush();
+	if (mode_ == DOCA_FLOW_GRPC_BATCH_UNARY || writer_ == nullptr)
+		return result;
+
+	writer_->WritesDone();
+	status = writer_->Finish();
+	writer_.reset();
+	context_.reset();
+
+	tmp_result = doca_flow_grpc_call_result(status, stream_response_);
+	DOCA_ERROR_PROPAGATE(result, tmp_result);
+	if (status.ok()) {
+		tmp_result = collect(stream_response_, nb_streamed_);
+		DOCA_ERROR_PROPAGATE(result, tmp_result);
+	}
+	nb_streamed_ = 0;
+	return result;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef DOCA_FLOW_GRPC_BATCH_H_
+#define DOCA_FLOW_GRPC_BATCH_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include <doca_error.h>
+
+#include "doca_flow.grpc.pb.h"
+
+#define DOCA_FLOW_GRPC_DEFAULT_BATCH_SIZE 256		/* Default number of entries in a batch */
+#define DOCA_FLOW_GRPC_DEFAULT_PROCESS_TIMEOUT_US 10000 /* Default time the server processes a batch (micro seconds) */
+
+enum doca_flow_grpc_batch_mode {
+	DOCA_FLOW_GRPC_BATCH_UNARY,  /* A DocaFlowPipeAddEntries call per batch */
+	DOCA_FLOW_GRPC_BATCH_STREAM, /* All the batches are written to a single DocaFlowPipeAddEntriesStream call */
+};
+
+/*
+ * Convert the result of a DOCA Flow gRPC call to a DOCA error
+ *
+ * @status [in]: gRPC status of the call
+ * @response [in]: Response of the call, valid if the status is OK
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_NOT_SUPPORTED if the server does not implement the call and
+ *          DOCA_ERROR otherwise
+ */
+doca_error_t
+doca_flow_grpc_call_result(const grpc::Status &status, const DocaFlowResponse &response);
+
+/*
+ * Client-side batching of pipe entries: the entries are sent to the server a batch at a time, the server processes
+ * every batch and returns the status of all its entries, instead of three round trips per entry (add, process and
+ * get status). The ids and status of the entries are kept in the order the entries were added.
+ */
+class DocaFlowEntryBatcher {
+public:
+	/*
+	 * Create a batcher
+	 *
+	 * @channel [in]: Channel to the DOCA Flow gRPC server
+	 * @mode [in]: How the batches are sent
+	 * @port_id [in]: Port of the entries, to process them
+	 * @pipe_queue [in]: Pipe queue of all the entries
+	 * @batch_size [in]: Number of entries in a batch
+	 * @timeout_us [in]: Time the server processes a batch (micro seconds)
+	 */
+	DocaFlowEntryBatcher(std::shared_ptr<grpc::Channel> channel,
+			     enum doca_flow_grpc_batch_mode mode,
+			     uint64_t port_id,
+			     uint32_t pipe_queue,
+			     uint32_t batch_size,
+			     uint64_t timeout_us);
+
+	/*
+	 * Destroy the batcher, an unfinished stream is cancelled
+	 */
+	~DocaFlowEntryBatcher();
+
+	/*
+	 * Get a new entry of the current batch to fill, the batch is sent first if it is full
+	 *
+	 * @entry [out]: Entry to fill, valid until the next call to a batcher method
+	 * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+	 */
+	doca_error_t add_entry(DocaFlowPipeAddEntryRequest **entry);
+
+	/*
+	 * Send the current batch. In UNARY mode the status of its entries is available once the call returns.
+	 *
+	 * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+	 */
+	doca_error_t flush(void);
+
+	/*
+	 * Send the current batch and end the stream, after which the status of all the entries is available
+	 *
+	 * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+	 */
+	doca_error_t finish(void);
+
+	/*
+	 * Get the ids of the added entries, 0 for an entry that failed to be added
+	 *
+	 * @return: Entry ids, in the order the entries were added
+	 */
+	const std::vector<uint64_t> &entry_ids(void) const
+	{
+		return entry_ids_;
+	}
+
+	/*
+	 * Get the status of the added entries
+	 *
+	 * @return: Entry status, in the order the entries were added
+	 */
+	const std::vector<DocaFlowEntryStatus> &statuses(void) const
+	{
+		return statuses_;
+	}
+
+	/*
+	 * Get the number of entries whose status is not ENTRY_STATUS_SUCCESS
+	 *
+	 * @return: Number of failed entries
+	 */
+	uint64_t nb_failed(void) const
+	{
+		return nb_failed_;
+	}
+
+	/*
+	 * Get the number of RPCs used so far, a stream counts as a single RPC
+	 *
+	 * @return: Number of RPCs
+	 */
+	uint64_t nb_rpcs(void) const
+	{
+		return nb_rpcs_;
+	}
+
+private:
+	/*
+	 * Append the entry ids and status of a response
+	 *
+	 * @response [in]: Response of the server
+	 * @nb_entries [in]: Number of entries the response is for
+	 * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+	 */
+	doca_error_t collect(const DocaFlowResponse &response, size_t nb_entries);
+
+	std::unique_ptr<DocaFlow::Stub> stub_;						  /* DOCA Flow stub */
+	enum doca_flow_grpc_batch_mode mode_;						  /* How batches are sent */
+	uint32_t batch_size_;								  /* Entries in a batch */
+	DocaFlowPipeAddEntriesRequest request_;						  /* Current batch */
+	std::unique_ptr<grpc::ClientContext> context_;					  /* Context of the stream */
+	std::unique_ptr<grpc::ClientWriter<DocaFlowPipeAddEntriesRequest>> writer_; /* Open stream, if any */
+	DocaFlowResponse stream_response_;						  /* Response of the stream */
+	size_t nb_streamed_;								  /* Entries written to the stream */
+	std::vector<uint64_t> entry_ids_;						  /* Ids of the sent entries */
+	std::vector<DocaFlowEntryStatus> statuses_;					  /* Status of the sent entries */
+	uint64_t nb_failed_;								  /* Entries that failed */
+	uint64_t nb_rpcs_;								  /* RPCs used so far */
+};
+
+#endif /* DOCA_FLOW_GRPC_BATCH_H_ */
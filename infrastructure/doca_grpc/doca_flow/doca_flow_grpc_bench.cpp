@@ -0,0 +1,768 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <grpcpp/grpcpp.h>
+
+#include <doca_argp.h>
+#include <doca_flow.h>
+#include <doca_log.h>
+
+#include "doca_flow_grpc_batch.hpp"
+
+DOCA_LOG_REGISTER(DOCA_FLOW_GRPC::BENCH);
+
+#define BENCH_MAX_ADDRESS_LEN 128	/* Maximal length of a server address */
+#define BENCH_MAX_QUEUES 64		/* Number of pipe queues of the stand-in server */
+#define DEFAULT_BENCH_RULES 100000	/* Default number of drop rules to load */
+#define DEFAULT_BENCH_PIPE_ID 1		/* Pipe the benchmark adds its entries to, the stand-in rejects pipe 0 */
+
+/* Ways to load the rules, as the loading loop of an application would do it */
+enum bench_mode {
+	BENCH_MODE_SINGLE,  /* Add, process and get status per rule, three round trips per rule */
+	BENCH_MODE_BATCHED, /* Add a batch of rules, process them once, get the status per rule */
+	BENCH_MODE_BULK,    /* DocaFlowPipeAddEntries per batch */
+	BENCH_MODE_STREAM,  /* Batches written to a single DocaFlowPipeAddEntriesStream call */
+	BENCH_MODE_ALL,	    /* All the modes, one after the other */
+};
+
+static const char *const bench_mode_names[] = {"single", "batched", "bulk", "stream", "all"};
+
+/* Benchmark configuration, filled by the command line parameters */
+struct bench_config {
+	char address[BENCH_MAX_ADDRESS_LEN]; /* Server to benchmark, empty to run the stand-in server in-process */
+	bool server_only;		     /* Only run the stand-in server on address */
+	enum bench_mode mode;		     /* Modes to benchmark */
+	uint32_t nb_rules;		     /* Number of rules to load in every mode */
+	uint32_t batch_size;		     /* Number of rules in a batch */
+};
+
+static volatile bool force_quit;
+
+/*
+ * Stand-in for the DOCA Flow gRPC server that keeps the entries in memory, so the cost of the RPCs can be measured
+ * without a DPU. Only the entry RPCs are implemented, the rest return UNIMPLEMENTED.
+ */
+class StandInDocaFlowService final : public DocaFlow::Service {
+public:
+	StandInDocaFlowService() : next_entry_id_(1)
+	{
+	}
+
+	grpc::Status DocaFlowPipeAddEntry(grpc::ServerContext *context,
+					  const DocaFlowPipeAddEntryRequest *request,
+					  DocaFlowResponse *response) override
+	{
+		std::lock_guard<std::mutex> lock(lock_);
+		uint64_t entry_id;
+		doca_error_t result;
+
+		result = add_entry(*request, request->pipe_queue(), &entry_id);
+		set_result(response, result);
+		response->set_entry_id(entry_id);
+		return grpc::Status::OK;
+	}
+
+	grpc::Status DocaFlowEntriesProcess(grpc::ServerContext *context,
+					    const DocaFlowEntriesProcessRequest *request,
+					    DocaFlowResponse *response) override
+	{
+		std::lock_guard<std::mutex> lock(lock_);
+		EntriesProcessRes *res = response->mutable_entries_process_res();
+
+		if (request->pipe_queue() >= BENCH_MAX_QUEUES) {
+			set_result(response, DOCA_ERROR_INVALID_VALUE);
+			return grpc::Status::OK;
+		}
+		process(request->pipe_queue(), request->max_processed_entries(), res);
+		set_result(response, DOCA_SUCCESS);
+		return grpc::Status::OK;
+	}
+
+	grpc::Status DocaFlowPipeEntryGetStatus(grpc::ServerContext *context,
+						const DocaFlowPipeEntryGetStatusRequest *request,
+						DocaFlowResponse *response) override
+	{
+		std::lock_guard<std::mutex> lock(lock_);
+		auto it = entries_.find(request->entry_id());
+
+		if (it == entries_.end()) {
+			set_result(response, DOCA_ERROR_NOT_FOUND);
+			return grpc::Status::OK;
+		}
+		response->set_status(it->second);
+		set_result(response, DOCA_SUCCESS);
+		return grpc::Status::OK;
+	}
+
+	grpc::Status DocaFlowPipeAddEntries(grpc::ServerContext *context,
+					    const DocaFlowPipeAddEntriesRequest *request,
+					    DocaFlowResponse *response) override
+	{
+		std::lock_guard<std::mutex> lock(lock_);
+
+		set_result(response, add_batch(*request, response->mutable_entries_process_res()));
+		return grpc::Status::OK;
+	}
+
+	grpc::Status DocaFlowPipeAddEntriesStream(grpc::ServerContext *context,
+						  grpc::ServerReader<DocaFlowPipeAddEntriesRequest> *reader,
+						  DocaFlowResponse *response) override
+	{
+		DocaFlowPipeAddEntriesRequest request;
+		doca_error_t result = DOCA_SUCCESS, tmp_result;
+
+		while (reader->Read(&request)) {
+			std::lock_guard<std::mutex> lock(lock_);
+
+			tmp_result = add_batch(request, response->mutable_entries_process_res());
+			DOCA_ERROR_PROPAGATE(result, tmp_result);
+		}
+		set_result(response, result);
+		return grpc::Status::OK;
+	}
+
+private:
+	/*
+	 * Fill the result of a response
+	 *
+	 * @response [out]: Response
+	 * @result [in]: Result of the call
+	 */
+	static void set_result(DocaFlowResponse *response, doca_error_t result)
+	{
+		response->set_success(result == DOCA_SUCCESS);
+		response->set_result(result);
+	}
+
+	/*
+	 * Add an entry, the lock must be held
+	 *
+	 * @request [in]: Entry to add
+	 * @pipe_queue [in]: Pipe queue of the entry
+	 * @entry_id [out]: Id of the added entry, 0 if it failed to be added
+	 * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+	 */
+	doca_error_t add_entry(const DocaFlowPipeAddEntryRequest &request, uint32_t pipe_queue, uint64_t *entry_id)
+	{
+		*entry_id = 0;
+		if (request.pipe_id() == 0 || pipe_queue >= BENCH_MAX_QUEUES)
+			return DOCA_ERROR_INVALID_VALUE;
+
+		*entry_id = next_entry_id_++;
+		entries_.emplace(*entry_id, ENTRY_STATUS_IN_PROCESS);
+		pending_[pipe_queue].push_back(*entry_id);
+		return DOCA_SUCCESS;
+	}
+
+	/*
+	 * Complete the pending entries of a queue, the lock must be held
+	 *
+	 * @pipe_queue [in]: Pipe queue
+	 * @max_entries [in]: Maximal number of entries to complete, 0 for all
+	 * @res [out]: The completed entries and their status are appended
+	 */
+	void process(uint32_t pipe_queue, uint32_t max_entries, EntriesProcessRes *res)
+	{
+		std::deque<uint64_t> &pending = pending_[pipe_queue];
+		uint32_t nb_processed = 0;
+
+		while (!pending.empty() && (max_entries == 0 || nb_processed < max_entries)) {
+			entries_[pending.front()] = ENTRY_STATUS_SUCCESS;
+			res->add_entries_ids(pending.front());
+			res->add_status(ENTRY_STATUS_SUCCESS);
+			pending.pop_front();
+			nb_processed++;
+		}
+	}
+
+	/*
+	 * Add and process a batch of entries, the lock must be held
+	 *
+	 * @request [in]: Batch of entries
+	 * @res [out]: The ids and status of the entries are appended, in the order of the batch
+	 * @return: DOCA_SUCCESS if all the entries were added and DOCA_ERROR otherwise
+	 */
+	doca_error_t add_batch(const DocaFlowPipeAddEntriesRequest &request, EntriesProcessRes *res)
+	{
+		uint32_t pipe_queue = request.pipe_queue();
+		int first = res->entries_ids_size();
+		EntriesProcessRes processed;
+		uint64_t entry_id;
+		doca_error_t result = DOCA_SUCCESS, tmp_result;
+
+		for (const auto &entry : request.entries()) {
+			tmp_result = add_entry(entry, pipe_queue, &entry_id);
+			DOCA_ERROR_PROPAGATE(result, tmp_result);
+			res->add_entries_ids(entry_id);
+			res->add_status(entry_id != 0 ? ENTRY_STATUS_IN_PROCESS : ENTRY_STATUS_ERROR);
+		}
+		if (pipe_queue >= BENCH_MAX_QUEUES)
+			return result;
+
+		/* The entries of the batch are the last ones of the queue, so processing the queue completes them */
+		process(pipe_queue, 0, &processed);
+		for (int i = first; i < res->entries_ids_size(); i++) {
+			if (res->entries_ids(i) != 0)
+				res->set_status(i, entries_[res->entries_ids(i)]);
+		}
+		return result;
+	}
+
+	std::mutex lock_;						 /* Protects the entries */
+	uint64_t next_entry_id_;					 /* Id of the next added entry */
+	std::unordered_map<uint64_t, DocaFlowEntryStatus> entries_;	 /* Status of every entry */
+	std::deque<uint64_t> pending_[BENCH_MAX_QUEUES];		 /* Entries not processed yet, per queue */
+};
+
+/*
+ * Get the time of a monotonic clock
+ *
+ * @return: Current time (seconds)
+ */
+static double
+get_time_sec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * Fill a 5-tuple drop entry, like the firewall drop rules
+ *
+ * @rule [in]: Rule number, makes the 5-tuple unique
+ * @entry [out]: Entry to fill
+ */
+static void
+fill_drop_entry(uint32_t rule, DocaFlowPipeAddEntryRequest *entry)
+{
+	DocaFlowHeaderFormat *outer = entry->mutable_match()->mutable_outer();
+
+	entry->set_pipe_queue(0);
+	entry->set_pipe_id(DEFAULT_BENCH_PIPE_ID);
+	entry->set_flags(DOCA_FLOW_NO_WAIT);
+	outer->set_l4_type_ext(L4_TYPE_EXT_TCP);
+	outer->mutable_ip4()->set_src_ip(0x0a000000 | (rule & 0xffffff));
+	outer->mutable_ip4()->set_dst_ip(0x0b000000 | (rule >> 8));
+	outer->mutable_transport()->set_src_port(1024 + (rule & 0xfff));
+	outer->mutable_transport()->set_dst_port(80);
+	entry->mutable_fwd()->set_type(FWD_DROP);
+}
+
+/*
+ * Load rules with the singular RPCs
+ *
+ * @stub [in]: DOCA Flow stub
+ * @nb_rules [in]: Number of rules to load
+ * @batch_size [in]: Rules added before they are processed, 1 for the single mode
+ * @nb_rpcs [out]: Number of RPCs used
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+load_singular(DocaFlow::Stub *stub, uint32_t nb_rules, uint32_t batch_size, uint64_t *nb_rpcs)
+{
+	std::vector<uint64_t> entry_ids(batch_size);
+	DocaFlowPipeAddEntryRequest entry;
+	DocaFlowEntriesProcessRequest process_request;
+	DocaFlowPipeEntryGetStatusRequest status_request;
+	uint32_t rule = 0, nb_batch, i;
+	doca_error_t result;
+
+	*nb_rpcs = 0;
+	process_request.set_port_id(0);
+	process_request.set_pipe_queue(0);
+	process_request.set_timeout(DOCA_FLOW_GRPC_DEFAULT_PROCESS_TIMEOUT_US);
+
+	while (rule < nb_rules) {
+		nb_batch = std::min(batch_size, nb_rules - rule);
+		for (i = 0; i < nb_batch; i++) {
+			grpc::ClientContext context;
+			DocaFlowResponse response;
+
+			fill_drop_entry(rule + i, &entry);
+			/* Only the last entry of a batch pushes the batch to the hardware */
+			entry.set_flags(i + 1 == nb_batch ? DOCA_FLOW_NO_WAIT : DOCA_FLOW_WAIT_FOR_BATCH);
+			result = doca_flow_grpc_call_result(stub->DocaFlowPipeAddEntry(&context, entry, &response),
+							    response);
+			(*nb_rpcs)++;
+			if (result != DOCA_SUCCESS) {
+				DOCA_LOG_ERR("Failed to add entry: %s", doca_error_get_descr(result));
+				return result;
+			}
+			entry_ids[i] = response.entry_id();
+		}
+
+		{
+			grpc::ClientContext context;
+			DocaFlowResponse response;
+
+			process_request.set_max_processed_entries(nb_batch);
+			result = doca_flow_grpc_call_result(
+				stub->DocaFlowEntriesProcess(&context, process_request, &response), response);
+			(*nb_rpcs)++;
+			if (result != DOCA_SUCCESS) {
+				DOCA_LOG_ERR("Entry process function failed: %s", doca_error_get_descr(result));
+				return result;
+			}
+		}
+
+		for (i = 0; i < nb_batch; i++) {
+			grpc::ClientContext context;
+			DocaFlowResponse response;
+
+			status_request.set_entry_id(entry_ids[i]);
+			result = doca_flow_grpc_call_result(
+				stub->DocaFlowPipeEntryGetStatus(&context, status_request, &response), response);
+			(*nb_rpcs)++;
+			if (result != DOCA_SUCCESS || response.status() != ENTRY_STATUS_SUCCESS) {
+				DOCA_LOG_ERR("Failed to process entry");
+				return DOCA_ERROR_BAD_STATE;
+			}
+		}
+		rule += nb_batch;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Load rules with the batch RPCs
+ *
+ * @channel [in]: Channel to the server
+ * @mode [in]: How the batches are sent
+ * @nb_rules [in]: Number of rules to load
+ * @batch_size [in]: Number of rules in a batch
+ * @nb_rpcs [out]: Number of RPCs used
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+load_batches(std::shared_ptr<grpc::Channel> channel, enum doca_flow_grpc_batch_mode mode, uint32_t nb_rules,
+	     uint32_t batch_size, uint64_t *nb_rpcs)
+{
+	DocaFlowEntryBatcher batcher(channel, mode, 0, 0, batch_size, DOCA_FLOW_GRPC_DEFAULT_PROCESS_TIMEOUT_US);
+	DocaFlowPipeAddEntryRequest *entry;
+	doca_error_t result;
+
+	for (uint32_t rule = 0; rule < nb_rules; rule++) {
+		result = batcher.add_entry(&entry);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to send a batch of entries: %s", doca_error_get_descr(result));
+			return result;
+		}
+		fill_drop_entry(rule, entry);
+	}
+
+	result = batcher.finish();
+	*nb_rpcs = batcher.nb_rpcs();
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to load the entries: %s", doca_error_get_descr(result));
+		return result;
+	}
+	if (batcher.statuses().size() != nb_rules || batcher.nb_failed() > 0) {
+		DOCA_LOG_ERR("%lu of %u entries failed", batcher.nb_failed(), nb_rules);
+		return DOCA_ERROR_BAD_STATE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Load the rules in a mode and report the rate
+ *
+ * @channel [in]: Channel to the server
+ * @mode [in]: Mode to benchmark
+ * @cfg [in]: Benchmark configuration
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+bench_mode(std::shared_ptr<grpc::Channel> channel, enum bench_mode mode, struct bench_config *cfg)
+{
+	std::unique_ptr<DocaFlow::Stub> stub = DocaFlow::NewStub(channel);
+	uint64_t nb_rpcs = 0;
+	double start, elapsed;
+	doca_error_t result;
+
+	start = get_time_sec();
+	switch (mode) {
+	case BENCH_MODE_SINGLE:
+		result = load_singular(stub.get(), cfg->nb_rules, 1, &nb_rpcs);
+		break;
+	case BENCH_MODE_BATCHED:
+		result = load_singular(stub.get(), cfg->nb_rules, cfg->batch_size, &nb_rpcs);
+		break;
+	case BENCH_MODE_BULK:
+		result = load_batches(channel, DOCA_FLOW_GRPC_BATCH_UNARY, cfg->nb_rules, cfg->batch_size, &nb_rpcs);
+		break;
+	case BENCH_MODE_STREAM:
+		result = load_batches(channel, DOCA_FLOW_GRPC_BATCH_STREAM, cfg->nb_rules, cfg->batch_size, &nb_rpcs);
+		break;
+	default:
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	elapsed = get_time_sec() - start;
+
+	if (result == DOCA_ERROR_NOT_SUPPORTED) {
+		printf("%-8s  not supported by the server\n", bench_mode_names[mode]);
+		return DOCA_SUCCESS;
+	}
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	printf("%-8s  %10u rules  %10lu RPCs  %8.3f sec  %12.0f rules/sec\n", bench_mode_names[mode], cfg->nb_rules,
+	       nb_rpcs, elapsed, cfg->nb_rules / elapsed);
+	fflush(stdout);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Callback function to handle TERM and INT signals
+ *
+ * @signum [in]: signal number
+ */
+static void
+signal_handler(int signum)
+{
+	if (signum == SIGINT || signum == SIGTERM)
+		force_quit = true;
+}
+
+/*
+ * Run the benchmark, or only the stand-in server
+ *
+ * @cfg [in]: Benchmark configuration
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+run_bench(struct bench_config *cfg)
+{
+	StandInDocaFlowService service;
+	std::unique_ptr<grpc::Server> server;
+	std::shared_ptr<grpc::Channel> channel;
+	std::string address(cfg->address);
+	int selected_port = 0;
+	doca_error_t result = DOCA_SUCCESS;
+
+	if (cfg->server_only || address.empty()) {
+		grpc::ServerBuilder builder;
+
+		if (address.empty())
+			address = "127.0.0.1:0";
+		builder.AddListeningPort(address, grpc::InsecureServerCredentials(), &selected_port);
+		builder.RegisterService(&service);
+		server = builder.BuildAndStart();
+		if (server == nullptr || selected_port == 0) {
+			DOCA_LOG_ERR("Failed to start the stand-in server on %s", address.c_str());
+			return DOCA_ERROR_INITIALIZATION;
+		}
+		if (address == "127.0.0.1:0")
+			address = "127.0.0.1:" + std::to_string(selected_port);
+		DOCA_LOG_INFO("Stand-in DOCA Flow server listening on %s", address.c_str());
+	}
+
+	if (cfg->server_only) {
+		signal(SIGINT, signal_handler);
+		signal(SIGTERM, signal_handler);
+		while (!force_quit)
+			sleep(1);
+		server->Shutdown();
+		return DOCA_SUCCESS;
+	}
+
+	channel = grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
+	for (int mode = BENCH_MODE_SINGLE; mode < BENCH_MODE_ALL; mode++) {
+		if (cfg->mode != BENCH_MODE_ALL && cfg->mode != mode)
+			continue;
+		result = bench_mode(channel, (enum bench_mode)mode, cfg);
+		if (result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Benchmark of mode %s failed: %s", bench_mode_names[mode],
+				     doca_error_get_descr(result));
+			break;
+		}
+	}
+
+	if (server != nullptr)
+		server->Shutdown();
+	return result;
+}
+
+/*
+ * ARGP Callback - Handle server address parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+address_callback(void *param, void *config)
+{
+	struct bench_config *cfg = (struct bench_config *)config;
+	const char *address = (char *)param;
+
+	if (strnlen(address, sizeof(cfg->address)) == sizeof(cfg->address)) {
+		DOCA_LOG_ERR("Server address is too long, max %zu characters", sizeof(cfg->address) - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strcpy(cfg->address, address);
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle server only parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS
+ */
+static doca_error_t
+server_only_callback(void *param, void *config)
+{
+	struct bench_config *cfg = (struct bench_config *)config;
+
+	cfg->server_only = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle benchmark mode parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+mode_callback(void *param, void *config)
+{
+	struct bench_config *cfg = (struct bench_config *)config;
+	const char *name = (char *)param;
+
+	for (int mode = BENCH_MODE_SINGLE; mode <= BENCH_MODE_ALL; mode++) {
+		if (strcmp(name, bench_mode_names[mode]) == 0) {
+			cfg->mode = (enum bench_mode)mode;
+			return DOCA_SUCCESS;
+		}
+	}
+	DOCA_LOG_ERR("Unknown mode %s, expected single, batched, bulk, stream or all", name);
+	return DOCA_ERROR_INVALID_VALUE;
+}
+
+/*
+ * ARGP Callback - Handle number of rules parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+nb_rules_callback(void *param, void *config)
+{
+	struct bench_config *cfg = (struct bench_config *)config;
+	int nb_rules = *(int *)param;
+
+	if (nb_rules < 1) {
+		DOCA_LOG_ERR("Number of rules must be at least 1");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->nb_rules = nb_rules;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle batch size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+batch_size_callback(void *param, void *config)
+{
+	struct bench_config *cfg = (struct bench_config *)config;
+	int batch_size = *(int *)param;
+
+	if (batch_size < 1) {
+		DOCA_LOG_ERR("Batch size must be at least 1");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->batch_size = batch_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Register the command line parameters for the benchmark.
+ *
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+register_bench_params(void)
+{
+	struct doca_argp_param *address_param, *server_param, *mode_param, *rules_param, *batch_param;
+	doca_error_t result;
+
+	/* Create and register server address param */
+	result = doca_argp_param_create(&address_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(address_param, "a");
+	doca_argp_param_set_long_name(address_param, "address");
+	doca_argp_param_set_arguments(address_param, "<ip:port>");
+	doca_argp_param_set_description(address_param,
+					"DOCA Flow gRPC server to benchmark, the stand-in server runs in-process if not set");
+	doca_argp_param_set_callback(address_param, address_callback);
+	doca_argp_param_set_type(address_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(address_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register server only param */
+	result = doca_argp_param_create(&server_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(server_param, "s");
+	doca_argp_param_set_long_name(server_param, "server");
+	doca_argp_param_set_description(server_param, "Only run the stand-in server on the given address");
+	doca_argp_param_set_callback(server_param, server_only_callback);
+	doca_argp_param_set_type(server_param, DOCA_ARGP_TYPE_BOOLEAN);
+	result = doca_argp_register_param(server_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register mode param */
+	result = doca_argp_param_create(&mode_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(mode_param, "m");
+	doca_argp_param_set_long_name(mode_param, "mode");
+	doca_argp_param_set_arguments(mode_param, "<mode>");
+	doca_argp_param_set_description(mode_param, "single, batched, bulk, stream or all (default all)");
+	doca_argp_param_set_callback(mode_param, mode_callback);
+	doca_argp_param_set_type(mode_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(mode_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register number of rules param */
+	result = doca_argp_param_create(&rules_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(rules_param, "n");
+	doca_argp_param_set_long_name(rules_param, "rules");
+	doca_argp_param_set_arguments(rules_param, "<num>");
+	doca_argp_param_set_description(rules_param, "Number of drop rules to load in every mode (default 100000)");
+	doca_argp_param_set_callback(rules_param, nb_rules_callback);
+	doca_argp_param_set_type(rules_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(rules_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register batch size param */
+	result = doca_argp_param_create(&batch_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(batch_param, "b");
+	doca_argp_param_set_long_name(batch_param, "batch-size");
+	doca_argp_param_set_arguments(batch_param, "<num>");
+	doca_argp_param_set_description(batch_param, "Number of rules in a batch (default 256)");
+	doca_argp_param_set_callback(batch_param, batch_size_callback);
+	doca_argp_param_set_type(batch_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(batch_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Benchmark of the rules/sec the DOCA Flow gRPC service loads, with the singular and the batch entry RPCs
+ *
+ * @argc [in]: command line arguments size
+ * @argv [in]: array of command line arguments
+ * @return: EXIT_SUCCESS on success and EXIT_FAILURE otherwise
+ */
+int
+main(int argc, char *argv[])
+{
+	struct bench_config cfg = {};
+	doca_error_t result;
+
+	cfg.mode = BENCH_MODE_ALL;
+	cfg.nb_rules = DEFAULT_BENCH_RULES;
+	cfg.batch_size = DOCA_FLOW_GRPC_DEFAULT_BATCH_SIZE;
+
+	/* Register a logger backend */
+	result = doca_log_backend_create_standard();
+	if (result != DOCA_SUCCESS)
+		return EXIT_FAILURE;
+
+	/* Parse cmdline/json arguments */
+	result = doca_argp_init("doca_flow_grpc_bench", &cfg);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to init ARGP resources: %s", doca_error_get_descr(result));
+		return EXIT_FAILURE;
+	}
+
+	result = register_bench_params();
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program parameters: %s", doca_error_get_descr(result));
+		doca_argp_destroy();
+		return EXIT_FAILURE;
+	}
+
+	result = doca_argp_start(argc, argv);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to parse program input: %s", doca_error_get_descr(result));
+		doca_argp_destroy();
+		return EXIT_FAILURE;
+	}
+
+	if (cfg.server_only && cfg.address[0] == '\0') {
+		DOCA_LOG_ERR("The stand-in server needs an address to listen on");
+		doca_argp_destroy();
+		return EXIT_FAILURE;
+	}
+
+	result = run_bench(&cfg);
+	doca_argp_destroy();
+	return result == DOCA_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
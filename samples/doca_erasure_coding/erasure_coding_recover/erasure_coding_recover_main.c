@@ -27,6 +27,7 @@ DOCA_LOG_REGISTER(EC_RECOVER::MAIN);
 #define USER_MAX_PATH_NAME 255		       /* max file name length */
 #define MAX_PATH_NAME (USER_MAX_PATH_NAME + 1) /* max file name string length */
 #define MAX_BLOCKS (128 + 32)		       /* ec blocks up to 128 in, 32 out */
+#define DEFAULT_STRIPE_BLOCK_SIZE (256 * 1024) /* Block size of a stripe, a stripe has a block per data block */
 
 /* Configuration struct */
 struct ec_cfg {
@@ -37,6 +38,7 @@ struct ec_cfg {
 	enum doca_ec_matrix_type matrix;		/* ec matrix type */
 	uint32_t data_block_count;			/* data block count */
 	uint32_t rdnc_block_count;			/* redundancy block count */
+	uint64_t stripe_block_size;			/* maximal block size of a stripe */
 	size_t n_delete_block;				/* number of deleted block indices */
 	uint32_t delete_block_indices[MAX_BLOCKS];	/* indices of data blocks to delete */
 };
@@ -44,7 +46,7 @@ struct ec_cfg {
 /* Sample's Logic */
 doca_error_t ec_recover(const char *pci_addr, const char *input_path, const char *output_path, bool do_both,
 			enum doca_ec_matrix_type matrix_type, uint32_t data_block_count, uint32_t rdnc_block_count,
-			uint32_t *missing_indices, size_t n_missing);
+			uint64_t stripe_block_size, uint32_t *missing_indices, size_t n_missing);
 
 /*
  * ARGP Callback - Handle PCI device address parameter
@@ -204,6 +206,27 @@ rdnc_block_count_callback(void *param, void *config)
 	return DOCA_SUCCESS;
 }
 
+/*
+ * ARGP Callback - Handle stripe block size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+stripe_block_size_callback(void *param, void *config)
+{
+	struct ec_cfg *ec_cfg = (struct ec_cfg *)config;
+	int stripe_block_size = *(int *)param;
+
+	if (stripe_block_size < 0) {
+		DOCA_LOG_ERR("Stripe block size should not be negative");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	ec_cfg->stripe_block_size = stripe_block_size;
+	return DOCA_SUCCESS;
+}
+
 /*
  * ARGP Callback - Handle deleted block indices parameter
  *
@@ -246,7 +269,7 @@ register_ec_params(void)
 {
 	doca_error_t result;
 	struct doca_argp_param *pci_param, *input_path_param, *output_path_param, *do_both_param, *matrix_param,
-		*data_block_count_param, *rdnc_block_count_param, *delete_block_indices_param;
+		*data_block_count_param, *rdnc_block_count_param, *stripe_block_size_param, *delete_block_indices_param;
 
 	result = doca_argp_param_create(&pci_param);
 	if (result != DOCA_SUCCESS) {
@@ -360,6 +383,23 @@ register_ec_params(void)
 		return result;
 	}
 
+	result = doca_argp_param_create(&stripe_block_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(stripe_block_size_param, "s");
+	doca_argp_param_set_long_name(stripe_block_size_param, "stripe-block-size");
+	doca_argp_param_set_description(stripe_block_size_param,
+					"Maximal block size of a stripe, 0 for the device maximum - default: 262144");
+	doca_argp_param_set_callback(stripe_block_size_param, stripe_block_size_callback);
+	doca_argp_param_set_type(stripe_block_size_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(stripe_block_size_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
 	result = doca_argp_param_create(&delete_block_indices_param);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
@@ -423,6 +463,7 @@ main(int argc, char **argv)
 	ec_cfg.matrix = DOCA_EC_MATRIX_TYPE_CAUCHY;
 	ec_cfg.data_block_count = 2; /* data block count */
 	ec_cfg.rdnc_block_count = 2; /* redundancy block count */
+	ec_cfg.stripe_block_size = DEFAULT_STRIPE_BLOCK_SIZE;
 	ec_cfg.delete_block_indices[0] = 0;
 	ec_cfg.n_delete_block = 1;
 
@@ -445,8 +486,8 @@ main(int argc, char **argv)
 	}
 
 	result = ec_recover(ec_cfg.pci_address, ec_cfg.input_path, ec_cfg.output_path, ec_cfg.do_both, ec_cfg.matrix,
-			    ec_cfg.data_block_count, ec_cfg.rdnc_block_count, ec_cfg.delete_block_indices,
-			    ec_cfg.n_delete_block);
+			    ec_cfg.data_block_count, ec_cfg.rdnc_block_count, ec_cfg.stripe_block_size,
+			    ec_cfg.delete_block_indices, ec_cfg.n_delete_block);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("ec_recover() encountered an error: %s", doca_error_get_descr(result));
 		goto argp_cleanup;
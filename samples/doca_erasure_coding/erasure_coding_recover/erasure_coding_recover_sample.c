@@ -53,70 +53,122 @@ DOCA_LOG_REGISTER(EC_RECOVER);
 #define ASSERT_DOCA_ERR(result, state, error) \
 	SAMPLE_ASSERT((result) == DOCA_SUCCESS, (result), state, (error ": %s"), doca_error_get_descr(result))
 
-#define NUM_EC_TASKS (8)		       /* EC tasks number */
+#define NUM_EC_TASKS (8)		       /* EC tasks in flight, each on the buffers of its own stripe */
 #define USER_MAX_PATH_NAME 255		       /* Max file name length */
 #define MAX_PATH_NAME (USER_MAX_PATH_NAME + 1) /* Max file name string length */
 #define MAX_DATA_SIZE (MAX_PATH_NAME + 100)		/* Max data file length - path + max int string size */
+#define EC_BLOCK_ALIGNMENT 64		       /* Block size alignment required for ec operations */
 #define RECOVERED_FILE_NAME "_recovered"       /* Recovered file extension (if file name not given) */
 #define DATA_INFO_FILE_NAME "data_info"	       /* Data information file name - i.e. size & name of original file */
+#define STRIPE_INFO_FILE_NAME "stripe_info"    /* Block size of a stripe, missing for a file encoded as a single stripe */
 #define DATA_BLOCK_FILE_NAME "data_block_"     /* Data blocks file name (attached index at the end) */
 #define RDNC_BLOCK_FILE_NAME "rdnc_block_"     /* Redundancy blocks file name (attached index at the end) */
 
+/*
+ * The input is cut into stripes of data_block_count blocks. Every stripe is encoded or recovered by its own task, and
+ * the blocks of all the stripes are appended to the block files in stripe order. NUM_EC_TASKS stripes are in flight:
+ * while the device works on some of them, the completed ones are written and the free ones are read again, so the
+ * memory in use does not depend on the file size.
+ */
+struct ec_stripe {
+	struct doca_buf *src_doca_buf;	/* Source doca buffer of the stripe */
+	struct doca_buf *dst_doca_buf;	/* Destination doca buffer of the stripe */
+	char *src;			/* Source blocks of the stripe */
+	char *dst;			/* Destination blocks of the stripe */
+	uint64_t index;			/* Index of the stripe in the file */
+	bool busy;			/* The stripe was submitted and was not written yet */
+	bool done;			/* The task of the stripe completed */
+};
+
 struct ec_sample_objects {
-	struct doca_buf *src_doca_buf;		/* Source doca buffer as input for the task */
-	struct doca_buf *dst_doca_buf;		/* Destination doca buffer as input for the task */
+	struct ec_stripe stripes[NUM_EC_TASKS]; /* Stripes in flight */
 	struct doca_ec *ec;			/* DOCA Erasure coding context */
-	char *src_buffer;			/* Source memory region to be used as input for the task */
-	char *dst_buffer;			/* Destination memory region to be used as output for task results */
-	char *file_data;			/* Block data pointer from reading block file */
+	char *src_buffer;			/* Source memory region of all the stripes */
+	char *dst_buffer;			/* Destination memory region of all the stripes */
 	char *block_file_data;			/* Block data pointer from reading block file */
 	uint32_t *missing_indices;		/* Data indices to that are missing and need recover */
+	int64_t *block_pos;			/* Position of every block in the stripe buffers, see ec_decode() */
+	FILE *in_file;				/* Input file to encode */
 	FILE *out_file;				/* Recovered file pointer to write to */
 	FILE *block_file;			/* Block file pointer to write to */
+	FILE **block_files;			/* Data and redundancy block files of the stream, by block index */
+	uint32_t nb_block_files;		/* Size of the block files array */
 	struct doca_ec_matrix *encoding_matrix;	/* Encoding matrix that will be use to create the redundancy */
 	struct doca_ec_matrix *decoding_matrix;	/* Decoding matrix that will be use to recover the data */
 	struct program_core_objects core_state; /* DOCA core objects - please refer to struct program_core_objects */
 	bool run_main_loop;			/* Controls whether progress loop should be run */
+	doca_error_t task_status;		/* Status of the first failed task */
+	uint32_t data_block_count;		/* Data blocks in a stripe */
+	uint32_t rdnc_block_count;		/* Redundancy blocks in a stripe */
+	size_t n_missing;			/* Number of missing blocks */
+	uint64_t block_size;			/* Block size of a stripe */
+	uint64_t file_size;			/* Size of the original file */
+	uint64_t nb_stripes;			/* Number of stripes in the file */
 };
 
+/* Stripe handler of the stream, see ec_stream() */
+typedef doca_error_t (*ec_stripe_handler)(struct ec_sample_objects *state, struct ec_stripe *stripe);
+
 /*
  * Clean all the sample resources
  *
  * @state [in]: ec_sample_objects struct
- * @ec [in]: ec context
  */
 static void
 ec_cleanup(struct ec_sample_objects *state)
 {
 	doca_error_t result = DOCA_SUCCESS;
+	uint32_t i;
 
-	if (state->src_doca_buf != NULL) {
-		result = doca_buf_dec_refcount(state->src_doca_buf, NULL);
-		if (result != DOCA_SUCCESS)
-			DOCA_LOG_ERR("Failed to decrease DOCA buffer reference count: %s",
-				     doca_error_get_descr(result));
+	/* The tasks in flight are flushed first, their callbacks still use the stripes */
+	if (state->core_state.ctx != NULL) {
+		result = doca_ctx_stop(state->core_state.ctx);
+		if (result == DOCA_ERROR_IN_PROGRESS) {
+			while (state->run_main_loop)
+				(void)doca_pe_progress(state->core_state.pe);
+		} else if (result != DOCA_SUCCESS)
+			DOCA_LOG_ERR("Unable to stop context: %s", doca_error_get_descr(result));
+		state->core_state.ctx = NULL;
 	}
-	if (state->dst_doca_buf != NULL) {
-		result = doca_buf_dec_refcount(state->dst_doca_buf, NULL);
-		if (result != DOCA_SUCCESS)
-			DOCA_LOG_ERR("Failed to decrease DOCA buffer reference count: %s",
-				     doca_error_get_descr(result));
+
+	for (i = 0; i < NUM_EC_TASKS; i++) {
+		if (state->stripes[i].src_doca_buf != NULL) {
+			result = doca_buf_dec_refcount(state->stripes[i].src_doca_buf, NULL);
+			if (result != DOCA_SUCCESS)
+				DOCA_LOG_ERR("Failed to decrease DOCA buffer reference count: %s",
+					     doca_error_get_descr(result));
+		}
+		if (state->stripes[i].dst_doca_buf != NULL) {
+			result = doca_buf_dec_refcount(state->stripes[i].dst_doca_buf, NULL);
+			if (result != DOCA_SUCCESS)
+				DOCA_LOG_ERR("Failed to decrease DOCA buffer reference count: %s",
+					     doca_error_get_descr(result));
+		}
 	}
 
 	if (state->missing_indices != NULL)
 		free(state->missing_indices);
+	if (state->block_pos != NULL)
+		free(state->block_pos);
 	if (state->block_file_data != NULL)
 		free(state->block_file_data);
-	if (state->file_data != NULL)
-		free(state->file_data);
 	if (state->src_buffer != NULL)
 		free(state->src_buffer);
 	if (state->dst_buffer != NULL)
 		free(state->dst_buffer);
+	if (state->in_file != NULL)
+		fclose(state->in_file);
 	if (state->out_file != NULL)
 		fclose(state->out_file);
 	if (state->block_file != NULL)
 		fclose(state->block_file);
+	if (state->block_files != NULL) {
+		for (i = 0; i < state->nb_block_files; i++) {
+			if (state->block_files[i] != NULL)
+				fclose(state->block_files[i]);
+		}
+		free(state->block_files);
+	}
 	if (state->encoding_matrix != NULL) {
 		result = doca_ec_matrix_destroy(state->encoding_matrix);
 		if (result != DOCA_SUCCESS)
@@ -128,12 +180,6 @@ ec_cleanup(struct ec_sample_objects *state)
 			DOCA_LOG_ERR("Failed to destroy ec decoding matrix: %s", doca_error_get_descr(result));
 	}
 
-	if (state->core_state.ctx != NULL) {
-		result = doca_ctx_stop(state->core_state.ctx);
-		if (result != DOCA_SUCCESS)
-			DOCA_LOG_ERR("Unable to stop context: %s", doca_error_get_descr(result));
-		state->core_state.ctx = NULL;
-	}
 	if (state->ec != NULL) {
 		result = doca_ec_destroy(state->ec);
 		if (result != DOCA_SUCCESS)
@@ -194,15 +240,12 @@ ec_state_changed_callback(const union doca_data user_data, struct doca_ctx *ctx,
  * @state [in]: The DOCA EC sample state
  * @pci_addr [in]: The PCI address of a doca device
  * @is_support_func [in]: Function that pci device should support
- * @max_bufs [in]: The buffer count to create
- * @src_size [in]: The source data size (to create the buffer)
- * @dst_size [in]: The destination data size (to create the buffer)
  * @max_block_size [out]: The maximum block size supported for ec operations
  * @return: DOCA_SUCCESS if the core init successfully and DOCA_ERROR otherwise.
  */
 static doca_error_t
-ec_core_init(struct ec_sample_objects *state, const char *pci_addr, tasks_check is_support_func, uint32_t max_bufs,
-	     uint32_t src_size, uint32_t dst_size, uint64_t *max_block_size)
+ec_core_init(struct ec_sample_objects *state, const char *pci_addr, tasks_check is_support_func,
+	     uint64_t *max_block_size)
 {
 	doca_error_t result;
 	union doca_data ctx_user_data;
@@ -210,7 +253,8 @@ ec_core_init(struct ec_sample_objects *state, const char *pci_addr, tasks_check
 	result = open_doca_device_with_pci(pci_addr, is_support_func, &state->core_state.dev);
 	ASSERT_DOCA_ERR(result, state, "Unable to open the pci device");
 
-	result = create_core_objects(&state->core_state, max_bufs);
+	/* A source and a destination buffer per stripe */
+	result = create_core_objects(&state->core_state, 2 * NUM_EC_TASKS);
 	ASSERT_DOCA_ERR(result, state, "Failed to init core");
 
 	result = doca_ec_create(state->core_state.dev, &state->ec);
@@ -225,40 +269,70 @@ ec_core_init(struct ec_sample_objects *state, const char *pci_addr, tasks_check
 	result = doca_pe_connect_ctx(state->core_state.pe, state->core_state.ctx);
 	ASSERT_DOCA_ERR(result, state, "Unable to connect context to progress engine");
 
-	result = doca_mmap_set_memrange(state->core_state.dst_mmap, state->dst_buffer, dst_size);
+	/* Include state in user data of context to be used in callbacks */
+	ctx_user_data.ptr = state;
+	result = doca_ctx_set_user_data(state->core_state.ctx, ctx_user_data);
+	ASSERT_DOCA_ERR(result, state, "Unable to set user data to context");
+
+	/* Set state change callback to be called whenever the context state changes */
+	result = doca_ctx_set_state_changed_cb(state->core_state.ctx, ec_state_changed_callback);
+	ASSERT_DOCA_ERR(result, state, "Unable to set state change callback");
+
+	return DOCA_SUCCESS;
+}
+
+/**
+ * Allocate the buffers of the stripes
+ *
+ * @state [in]: The DOCA EC sample state
+ * @src_size [in]: The source data size of a stripe
+ * @dst_size [in]: The destination data size of a stripe
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise.
+ */
+static doca_error_t
+ec_stripes_init(struct ec_sample_objects *state, uint64_t src_size, uint64_t dst_size)
+{
+	struct ec_stripe *stripe;
+	doca_error_t result;
+	uint32_t i;
+
+	state->src_buffer = malloc(src_size * NUM_EC_TASKS);
+	SAMPLE_ASSERT(state->src_buffer != NULL, DOCA_ERROR_NO_MEMORY, state, "Unable to allocate src_buffer string");
+
+	state->dst_buffer = malloc(dst_size * NUM_EC_TASKS);
+	SAMPLE_ASSERT(state->dst_buffer != NULL, DOCA_ERROR_NO_MEMORY, state, "Unable to allocate dst_buffer string");
+
+	result = doca_mmap_set_memrange(state->core_state.dst_mmap, state->dst_buffer, dst_size * NUM_EC_TASKS);
 	ASSERT_DOCA_ERR(result, state, "Failed to set mmap mem range dst");
 
 	result = doca_mmap_start(state->core_state.dst_mmap);
 	ASSERT_DOCA_ERR(result, state, "Failed to start mmap dst");
 
-	result = doca_mmap_set_memrange(state->core_state.src_mmap, state->src_buffer, src_size);
+	result = doca_mmap_set_memrange(state->core_state.src_mmap, state->src_buffer, src_size * NUM_EC_TASKS);
 	ASSERT_DOCA_ERR(result, state, "Failed to set mmap mem range src");
 
 	result = doca_mmap_start(state->core_state.src_mmap);
 	ASSERT_DOCA_ERR(result, state, "Failed to start mmap src");
 
-	/* Construct DOCA buffer for each address range */
-	result = doca_buf_inventory_buf_get_by_addr(state->core_state.buf_inv, state->core_state.src_mmap,
-						    state->src_buffer, src_size, &state->src_doca_buf);
-	ASSERT_DOCA_ERR(result, state, "Unable to acquire DOCA buffer representing source buffer");
+	for (i = 0; i < NUM_EC_TASKS; i++) {
+		stripe = &state->stripes[i];
+		stripe->src = state->src_buffer + i * src_size;
+		stripe->dst = state->dst_buffer + i * dst_size;
 
-	/* Construct DOCA buffer for each address range */
-	result = doca_buf_inventory_buf_get_by_addr(state->core_state.buf_inv, state->core_state.dst_mmap,
-						    state->dst_buffer, dst_size, &state->dst_doca_buf);
-	ASSERT_DOCA_ERR(result, state, "Unable to acquire DOCA buffer representing destination buffer");
+		/* Construct DOCA buffer for each address range */
+		result = doca_buf_inventory_buf_get_by_addr(state->core_state.buf_inv, state->core_state.src_mmap,
+							    stripe->src, src_size, &stripe->src_doca_buf);
+		ASSERT_DOCA_ERR(result, state, "Unable to acquire DOCA buffer representing source buffer");
 
-	/* Setting data length in doca buffer */
-	result = doca_buf_set_data(state->src_doca_buf, state->src_buffer, src_size);
-	ASSERT_DOCA_ERR(result, state, "Unable to set DOCA buffer data");
+		/* Construct DOCA buffer for each address range */
+		result = doca_buf_inventory_buf_get_by_addr(state->core_state.buf_inv, state->core_state.dst_mmap,
+							    stripe->dst, dst_size, &stripe->dst_doca_buf);
+		ASSERT_DOCA_ERR(result, state, "Unable to acquire DOCA buffer representing destination buffer");
 
-	/* Include state in user data of context to be used in callbacks */
-	ctx_user_data.ptr = state;
-	result = doca_ctx_set_user_data(state->core_state.ctx, ctx_user_data);
-	ASSERT_DOCA_ERR(result, state, "Unable to set user data to context");
-
-	/* Set state change callback to be called whenever the context state changes */
-	result = doca_ctx_set_state_changed_cb(state->core_state.ctx, ec_state_changed_callback);
-	ASSERT_DOCA_ERR(result, state, "Unable to set state change callback");
+		/* Setting data length in doca buffer, the source of every stripe is a full stripe */
+		result = doca_buf_set_data(stripe->src_doca_buf, stripe->src, src_size);
+		ASSERT_DOCA_ERR(result, state, "Unable to set DOCA buffer data");
+	}
 
 	return DOCA_SUCCESS;
 }
@@ -267,37 +341,131 @@ ec_core_init(struct ec_sample_objects *state, const char *pci_addr, tasks_check
  * EC tasks mutual error callback
  *
  * @task [in]: the failed doca task
- * @task_status [out]: the status of the task
- * @cb_result [out]: the result of the callback
+ * @state [in]: the DOCA EC sample state
  */
 static void
-ec_task_error(struct doca_task *task, doca_error_t *task_status, doca_error_t *cb_result)
+ec_task_error(struct doca_task *task, struct ec_sample_objects *state)
 {
-	*task_status = DOCA_ERROR_UNEXPECTED;
+	doca_error_t task_status = doca_task_get_status(task);
+
+	DOCA_LOG_ERR("EC Task finished unsuccessfully: %s", doca_error_get_descr(task_status));
 
-	DOCA_LOG_ERR("EC Task finished unsuccessfully");
+	/* The stream stops on the first failed task */
+	if (state->task_status == DOCA_SUCCESS)
+		state->task_status = task_status != DOCA_SUCCESS ? task_status : DOCA_ERROR_UNEXPECTED;
 
 	/* Free task */
 	doca_task_free(task);
+}
+
+/*
+ * Run the stripes of the stream, NUM_EC_TASKS at a time
+ *
+ * @state [in]: the DOCA EC sample state
+ * @read_stripe [in]: fills the source blocks of a stripe
+ * @submit_stripe [in]: submits the task of a stripe
+ * @write_stripe [in]: writes the blocks of a completed stripe, the stripes are written in order
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR otherwise.
+ */
+static doca_error_t
+ec_stream(struct ec_sample_objects *state, ec_stripe_handler read_stripe, ec_stripe_handler submit_stripe,
+	  ec_stripe_handler write_stripe)
+{
+	struct ec_stripe *stripe;
+	uint64_t next_submit = 0, next_write = 0;
+	struct timespec start, end;
+	struct timespec ts = {
+		.tv_sec = 0,
+		.tv_nsec = SLEEP_IN_NANOS,
+	};
+	double elapsed;
+	doca_error_t result;
 
-	*cb_result = DOCA_SUCCESS;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	while (next_write < state->nb_stripes) {
+		/* Refill the free stripes, the device works on the submitted ones meanwhile */
+		while (next_submit < state->nb_stripes && !state->stripes[next_submit % NUM_EC_TASKS].busy) {
+			stripe = &state->stripes[next_submit % NUM_EC_TASKS];
+			stripe->index = next_submit;
+			stripe->done = false;
+
+			result = read_stripe(state, stripe);
+			if (result != DOCA_SUCCESS)
+				return result;
+
+			result = doca_buf_reset_data_len(stripe->dst_doca_buf);
+			if (result != DOCA_SUCCESS) {
+				DOCA_LOG_ERR("Unable to reset DOCA buffer data: %s", doca_error_get_descr(result));
+				return result;
+			}
+
+			result = submit_stripe(state, stripe);
+			if (result != DOCA_SUCCESS)
+				return result;
+			stripe->busy = true;
+			next_submit++;
+		}
 
-	/* Stop context once task is completed */
-	(void)doca_ctx_stop(doca_task_get_ctx(task));
-}
+		/* The blocks are appended to the files, so the stripes are written in order */
+		stripe = &state->stripes[next_write % NUM_EC_TASKS];
+		if (stripe->busy && stripe->done) {
+			result = write_stripe(state, stripe);
+			if (result != DOCA_SUCCESS)
+				return result;
+			stripe->busy = false;
+			next_write++;
+			continue;
+		}
 
+		if (state->task_status != DOCA_SUCCESS)
+			return state->task_status;
+
+		if (doca_pe_progress(state->core_state.pe) == 0)
+			nanosleep(&ts, &ts);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	DOCA_LOG_INFO("Processed %lu bytes in %lu stripes in %.3f seconds: %.3f GB/s", state->file_size,
+		      state->nb_stripes, elapsed, elapsed > 0 ? state->file_size / elapsed / 1e9 : 0);
+
+	return DOCA_SUCCESS;
+}
 
 /*
- * All the necessary variables for EC create task callback functions defined in this sample
+ * Open a block file
+ *
+ * @dir_path [in]: the directory of the block files
+ * @block_index [in]: index of the block, the redundancy blocks follow the data blocks
+ * @data_block_count [in]: data block count
+ * @mode [in]: fopen mode
+ * @file [out]: the opened file, NULL if it does not exist and mode is "r"
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR otherwise.
  */
-struct create_task_data {
-	const char *output_dir_path;		/* The path in which the output file should be saved */
-	uint32_t block_size;			/* The block size used for EC */
-	size_t rdnc_block_count;		/* The number of redundancy blocks created for the data */
-	struct doca_buf *rdnc_blocks;		/* The redundancy blocks created for the data */
-	doca_error_t *task_status;		/* The status of the task (output paramater) */
-	doca_error_t *cb_result;		/* The result of the callback (output paramater) */
-};
+static doca_error_t
+ec_open_block_file(const char *dir_path, uint32_t block_index, uint32_t data_block_count, const char *mode,
+		   FILE **file)
+{
+	char full_path[MAX_PATH_NAME];
+	const char *file_name = block_index < data_block_count ? DATA_BLOCK_FILE_NAME : RDNC_BLOCK_FILE_NAME;
+	uint32_t index = block_index < data_block_count ? block_index : block_index - data_block_count;
+	int ret;
+
+	ret = snprintf(full_path, sizeof(full_path), "%s/%s%u", dir_path, file_name, index);
+	if (ret < 0 || ret >= (int)sizeof(full_path)) {
+		DOCA_LOG_ERR("Path exceeded max path len");
+		return DOCA_ERROR_IO_FAILED;
+	}
+	*file = fopen(full_path, mode);
+	if (*file == NULL && strcmp(mode, "r") != 0) {
+		DOCA_LOG_ERR("Unable to open output file: %s", full_path);
+		return DOCA_ERROR_IO_FAILED;
+	}
+	if (*file != NULL && strcmp(mode, "r") == 0)
+		DOCA_LOG_INFO("Copy: %s", full_path);
+	return DOCA_SUCCESS;
+}
 
 /*
  * EC create task error callback
@@ -310,10 +478,9 @@ static void
 ec_create_error_callback(struct doca_ec_task_create *create_task, union doca_data task_user_data,
 			 union doca_data ctx_user_data)
 {
-	struct create_task_data *task_data = task_user_data.ptr;
-	(void)ctx_user_data;
+	(void)task_user_data;
 
-	ec_task_error(doca_ec_task_create_as_task(create_task), task_data->task_status, task_data->cb_result);
+	ec_task_error(doca_ec_task_create_as_task(create_task), ctx_user_data.ptr);
 }
 
 /*
@@ -327,42 +494,96 @@ static void
 ec_create_completed_callback(struct doca_ec_task_create *create_task, union doca_data task_user_data,
 			      union doca_data ctx_user_data)
 {
-	int ret;
-	size_t i;
-	uint8_t *resp_data;
-	doca_error_t result;
-	char full_path[MAX_PATH_NAME];
-	struct create_task_data *task_data = task_user_data.ptr;
-	struct ec_sample_objects *state = ctx_user_data.ptr;
-
-	*task_data->task_status = DOCA_SUCCESS;
-
-	/* Write the result to output file */
-	result = doca_buf_get_data(task_data->rdnc_blocks, (void **)&resp_data);
-	CB_ASSERT(result == DOCA_SUCCESS, result, task_data->cb_result,
-		  "Unable to retrieve data pointer from redundancy data blocks buffer");
-
-	for (i = 0; i < task_data->rdnc_block_count; i++) {
-		ret = snprintf(full_path, sizeof(full_path), "%s/%s%ld", task_data->output_dir_path, RDNC_BLOCK_FILE_NAME, i);
-		CB_ASSERT(ret >= 0 && ret < (int)sizeof(full_path), DOCA_ERROR_IO_FAILED, task_data->cb_result, "Path exceeded max path len");
-		state->block_file = fopen(full_path, "wr");
-		CB_ASSERT(state->block_file != NULL, DOCA_ERROR_IO_FAILED, task_data->cb_result,
-			  "Unable to open output file: %s", full_path);
-		ret = fwrite(resp_data + i * task_data->block_size, task_data->block_size, 1, state->block_file);
-		CB_ASSERT(ret >= 0, DOCA_ERROR_IO_FAILED, task_data->cb_result, "Failed to write to file");
-		fclose(state->block_file);
-		state->block_file = NULL;
-	}
+	struct ec_stripe *stripe = task_user_data.ptr;
+	(void)ctx_user_data;
 
-	DOCA_LOG_INFO("File was encoded successfully and saved in: %s", task_data->output_dir_path);
+	/* The stripe is written by the main loop, in order */
+	stripe->done = true;
 
 	/* Free task */
 	doca_task_free(doca_ec_task_create_as_task(create_task));
+}
+
+/*
+ * Read the data blocks of a stripe from the input file
+ *
+ * @state [in]: the DOCA EC sample state
+ * @stripe [in]: the stripe to read
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR otherwise.
+ */
+static doca_error_t
+ec_encode_read_stripe(struct ec_sample_objects *state, struct ec_stripe *stripe)
+{
+	uint64_t stripe_size = state->block_size * state->data_block_count;
+	uint64_t offset = stripe->index * stripe_size;
+	uint64_t len = state->file_size - offset < stripe_size ? state->file_size - offset : stripe_size;
 
-	*task_data->cb_result = DOCA_SUCCESS;
+	if (fread(stripe->src, 1, len, state->in_file) != len) {
+		DOCA_LOG_ERR("Failed to read stripe %lu of the input file", stripe->index);
+		return DOCA_ERROR_IO_FAILED;
+	}
+	/* The last stripe is padded with zeros */
+	if (len < stripe_size)
+		memset(stripe->src + len, 0, stripe_size - len);
+	return DOCA_SUCCESS;
+}
 
-	/* Stop context once task is completed */
-	(void)doca_ctx_stop(state->core_state.ctx);
+/*
+ * Submit the create task of a stripe
+ *
+ * @state [in]: the DOCA EC sample state
+ * @stripe [in]: the stripe to encode
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR otherwise.
+ */
+static doca_error_t
+ec_encode_submit_stripe(struct ec_sample_objects *state, struct ec_stripe *stripe)
+{
+	struct doca_ec_task_create *task;
+	union doca_data user_data;
+	doca_error_t result;
+
+	user_data.ptr = stripe;
+	result = doca_ec_task_create_allocate_init(state->ec, state->encoding_matrix, stripe->src_doca_buf,
+						   stripe->dst_doca_buf, user_data, &task);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to allocate and initiate task: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Enqueue ec create task */
+	result = doca_task_submit(doca_ec_task_create_as_task(task));
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to submit task: %s", doca_error_get_descr(result));
+		doca_task_free(doca_ec_task_create_as_task(task));
+		return result;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Append the data and redundancy blocks of an encoded stripe to the block files
+ *
+ * @state [in]: the DOCA EC sample state
+ * @stripe [in]: the encoded stripe
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR otherwise.
+ */
+static doca_error_t
+ec_encode_write_stripe(struct ec_sample_objects *state, struct ec_stripe *stripe)
+{
+	uint32_t i;
+	char *block;
+
+	for (i = 0; i < state->data_block_count + state->rdnc_block_count; i++) {
+		if (i < state->data_block_count)
+			block = stripe->src + i * state->block_size;
+		else
+			block = stripe->dst + (i - state->data_block_count) * state->block_size;
+		if (fwrite(block, state->block_size, 1, state->block_files[i]) != 1) {
+			DOCA_LOG_ERR("Failed to write to file");
+			return DOCA_ERROR_IO_FAILED;
+		}
+	}
+	return DOCA_SUCCESS;
 }
 
 /*
@@ -374,160 +595,116 @@ ec_create_completed_callback(struct doca_ec_task_create *create_task, union doca
  * @output_dir_path [in]: path to the task output file
  * @data_block_count [in]: data block count
  * @rdnc_block_count [in]: redundancy block count
+ * @stripe_block_size [in]: maximal block size of a stripe, 0 for the maximum the device supports
  * @return: DOCA_SUCCESS on success, DOCA_ERROR otherwise.
  */
 doca_error_t
 ec_encode(const char *pci_addr, const char *file_path, enum doca_ec_matrix_type matrix_type,
-	  const char *output_dir_path, uint32_t data_block_count, uint32_t rdnc_block_count)
+	  const char *output_dir_path, uint32_t data_block_count, uint32_t rdnc_block_count,
+	  uint64_t stripe_block_size)
 {
-	uint32_t max_bufs = 2;
 	doca_error_t result;
 	int ret;
-	size_t i;
-	size_t file_size;
+	uint32_t i;
 	uint64_t max_block_size;
 	uint64_t block_size;
-	uint64_t src_size;
-	uint64_t dst_size;
+	struct stat file_stat;
 	struct ec_sample_objects state_object = {0};
 	struct ec_sample_objects *state = &state_object;
 	char full_path[MAX_PATH_NAME];
-	struct timespec ts = {
-		.tv_sec = 0,
-		.tv_nsec = SLEEP_IN_NANOS,
-	};
-	doca_error_t task_status = DOCA_SUCCESS;
-	doca_error_t callback_result = DOCA_SUCCESS;
-	struct doca_task *doca_task;
-	struct doca_ec_task_create *task;
-	struct create_task_data task_data;
-	union doca_data user_data;
 
-	result = read_file(file_path, &state->file_data, &file_size);
-	ASSERT_DOCA_ERR(result, state, "Can't read input file");
+	state->data_block_count = data_block_count;
+	state->rdnc_block_count = rdnc_block_count;
 
-	block_size = file_size / data_block_count;
-	if (block_size * data_block_count != file_size)
-		block_size++;
-	if (block_size % 64 != 0)
-		block_size += 64 - (block_size % 64);
-	src_size = (uint64_t)block_size * data_block_count;
-	dst_size = (uint64_t)block_size * rdnc_block_count;
+	state->in_file = fopen(file_path, "r");
+	SAMPLE_ASSERT(state->in_file != NULL, DOCA_ERROR_IO_FAILED, state, "Can't read input file: %s", file_path);
+	SAMPLE_ASSERT(fstat(fileno(state->in_file), &file_stat) == 0 && file_stat.st_size > 0, DOCA_ERROR_INVALID_VALUE,
+		      state, "Input file is empty or can't be read: %s", file_path);
+	state->file_size = file_stat.st_size;
 
-	state->src_buffer = malloc(src_size);
-	SAMPLE_ASSERT(state->src_buffer != NULL, DOCA_ERROR_NO_MEMORY, state, "Unable to allocate src_buffer string");
-	memcpy(state->src_buffer, state->file_data, file_size);
+	result = ec_core_init(state, pci_addr, (tasks_check)&doca_ec_cap_task_create_is_supported, &max_block_size);
+	if (result != DOCA_SUCCESS)
+		return result;
 
-	state->dst_buffer = malloc(dst_size);
-	SAMPLE_ASSERT(state->dst_buffer != NULL, DOCA_ERROR_NO_MEMORY, state, "Unable to allocate dst_buffer string");
+	/* A file that fits in a single stripe keeps the smallest block size, as before streaming */
+	if (stripe_block_size == 0 || stripe_block_size > max_block_size)
+		stripe_block_size = max_block_size;
+	stripe_block_size -= stripe_block_size % EC_BLOCK_ALIGNMENT;
+	SAMPLE_ASSERT(stripe_block_size > 0, DOCA_ERROR_INVALID_VALUE, state,
+		      "Stripe block size must be at least %d bytes", EC_BLOCK_ALIGNMENT);
 
-	for (i = 0; i < data_block_count; i++) {
-		ret = snprintf(full_path, sizeof(full_path), "%s/%s%ld", output_dir_path, DATA_BLOCK_FILE_NAME, i);
-		SAMPLE_ASSERT(ret >= 0 && ret < (int)sizeof(full_path), DOCA_ERROR_IO_FAILED, state, "Path exceeded max path len");
-		state->block_file = fopen(full_path, "wr");
-		SAMPLE_ASSERT(state->block_file != NULL, DOCA_ERROR_IO_FAILED, state, "Unable to open output file: %s",
-		       full_path);
-		ret = fwrite(state->src_buffer + i * block_size, block_size, 1, state->block_file);
-		SAMPLE_ASSERT(ret >= 0, DOCA_ERROR_IO_FAILED, state, "Failed to write to file");
-		fclose(state->block_file);
-		state->block_file = NULL;
+	block_size = state->file_size / data_block_count;
+	if (block_size * data_block_count != state->file_size)
+		block_size++;
+	if (block_size % EC_BLOCK_ALIGNMENT != 0)
+		block_size += EC_BLOCK_ALIGNMENT - (block_size % EC_BLOCK_ALIGNMENT);
+	if (block_size > stripe_block_size)
+		block_size = stripe_block_size;
+	state->block_size = block_size;
+	state->nb_stripes = (state->file_size + block_size * data_block_count - 1) / (block_size * data_block_count);
+
+	state->nb_block_files = data_block_count + rdnc_block_count;
+	state->block_files = calloc(state->nb_block_files, sizeof(*state->block_files));
+	SAMPLE_ASSERT(state->block_files != NULL, DOCA_ERROR_NO_MEMORY, state, "Unable to allocate block files");
+	for (i = 0; i < state->nb_block_files; i++) {
+		result = ec_open_block_file(output_dir_path, i, data_block_count, "w", &state->block_files[i]);
+		if (result != DOCA_SUCCESS) {
+			ec_cleanup(state);
+			return result;
+		}
 	}
 
 	ret = snprintf(full_path, sizeof(full_path), "%s/%s", output_dir_path, DATA_INFO_FILE_NAME);
 	SAMPLE_ASSERT(ret >= 0 && ret < (int)sizeof(full_path), DOCA_ERROR_IO_FAILED, state, "Path exceeded max path len");
 	state->block_file = fopen(full_path, "wr");
 	SAMPLE_ASSERT(state->block_file != NULL, DOCA_ERROR_IO_FAILED, state, "Unable to open output file: %s", full_path);
-	ret = fprintf(state->block_file, "%ld %.*s", file_size, (int)strlen(file_path), file_path);
+	ret = fprintf(state->block_file, "%lu %.*s", state->file_size, (int)strlen(file_path), file_path);
 	SAMPLE_ASSERT(ret >= 0, DOCA_ERROR_IO_FAILED, state, "Failed to write to file");
 	fclose(state->block_file);
 	state->block_file = NULL;
 
-	result = ec_core_init(state, pci_addr, (tasks_check)&doca_ec_cap_task_create_is_supported, max_bufs, src_size,
-			      dst_size, &max_block_size);
-	if (result != DOCA_SUCCESS)
-		return result;
+	ret = snprintf(full_path, sizeof(full_path), "%s/%s", output_dir_path, STRIPE_INFO_FILE_NAME);
+	SAMPLE_ASSERT(ret >= 0 && ret < (int)sizeof(full_path), DOCA_ERROR_IO_FAILED, state, "Path exceeded max path len");
+	state->block_file = fopen(full_path, "wr");
+	SAMPLE_ASSERT(state->block_file != NULL, DOCA_ERROR_IO_FAILED, state, "Unable to open output file: %s", full_path);
+	ret = fprintf(state->block_file, "%lu", state->block_size);
+	SAMPLE_ASSERT(ret >= 0, DOCA_ERROR_IO_FAILED, state, "Failed to write to file");
+	fclose(state->block_file);
+	state->block_file = NULL;
 
 	/* Set task configuration */
 	result = doca_ec_task_create_set_conf(state->ec, ec_create_completed_callback, ec_create_error_callback,
 					      NUM_EC_TASKS);
 	ASSERT_DOCA_ERR(result, state, "Unable to set configuration for create tasks");
 
+	result = ec_stripes_init(state, block_size * data_block_count, block_size * rdnc_block_count);
+	if (result != DOCA_SUCCESS)
+		return result;
+
 	/* Start the task */
 	result = doca_ctx_start(state->core_state.ctx);
 	ASSERT_DOCA_ERR(result, state, "Unable to start context");
+	state->run_main_loop = true;
 
 	/* Create a matrix for the task */
 	result = doca_ec_matrix_create(state->ec, matrix_type, data_block_count, rdnc_block_count,
 				       &state->encoding_matrix);
 	ASSERT_DOCA_ERR(result, state, "Unable to create ec matrix");
 
-	SAMPLE_ASSERT(block_size <= max_block_size, DOCA_ERROR_INVALID_VALUE, state,
-		      "Block size (%lu) exceeds the maximum size supported (%lu). Try to increase the number of blocks or use a smaller file as input",
-		      block_size, max_block_size);
-
-	/* Include all necessary parameters for completion callback in user data of task */
-	task_data = (struct create_task_data) {
-		.output_dir_path = output_dir_path,
-		.block_size = block_size,
-		.rdnc_block_count = rdnc_block_count,
-		.rdnc_blocks = state->dst_doca_buf,
-		.task_status = &task_status,
-		.cb_result = &callback_result
-	};
-	user_data.ptr = &task_data;
-
-	/* Construct EC create task */
-	result = doca_ec_task_create_allocate_init(state->ec, state->encoding_matrix, state->src_doca_buf,
-						   state->dst_doca_buf, user_data, &task);
-	ASSERT_DOCA_ERR(result, state, "Unable to allocate and initiate task");
-
-	doca_task = doca_ec_task_create_as_task(task);
-	SAMPLE_ASSERT(doca_task != NULL, DOCA_ERROR_UNEXPECTED, state, "Unable to retrieve task as doca_task");
-
-	/* Enqueue ec create task */
-	result = doca_task_submit(doca_task);
-	ASSERT_DOCA_ERR(result, state, "Unable to submit task");
-
-	state->run_main_loop = true;
-
-	/* Wait for create task completion and context stopped */
-	while (state->run_main_loop) {
-		if (doca_pe_progress(state->core_state.pe) == 0)
-			nanosleep(&ts, &ts);
-	}
-
-	/* Check result of task and callback */
-	ASSERT_DOCA_ERR(task_status, state, "EC create task failed");
+	DOCA_LOG_INFO("Encoding %lu stripes of %u blocks of %lu bytes", state->nb_stripes, data_block_count,
+		      block_size);
+	result = ec_stream(state, ec_encode_read_stripe, ec_encode_submit_stripe, ec_encode_write_stripe);
+	ASSERT_DOCA_ERR(result, state, "EC create task failed");
 
-	if (callback_result == DOCA_SUCCESS)
-		DOCA_LOG_INFO("Success, redundancy blocks were created");
-	else
-		DOCA_LOG_ERR("Sample failed: %s", doca_error_get_descr(callback_result));
+	DOCA_LOG_INFO("File was encoded successfully and saved in: %s", output_dir_path);
+	DOCA_LOG_INFO("Success, redundancy blocks were created");
 
 	/* Clean and destroy all relevant objects */
 	ec_cleanup(state);
 
-	return callback_result;
+	return DOCA_SUCCESS;
 }
 
-/*
- * All the necessary variables for EC recover task callback functions defined in this sample
- */
-struct recover_task_data {
-	const char *dir_path;			/* The path to the tasks output file */
-	char *output_file_path;			/* The path of the recovered file */
-	int64_t file_size;			/* The size of the input file */
-	int32_t block_size;			/* The block size used for EC */
-	uint32_t data_block_count;		/* The number of data blocks created */
-	size_t n_missing;			/* The number of missing data blocks that are to be recovered on success
-						 */
-	struct doca_buf *recovered_data_blocks; /* The buffer to which the blocks of recovered data will be written on
-						 * success
-						 */
-	doca_error_t *task_status;		/* The status of the task (output paramater) */
-	doca_error_t *cb_result;		/* The result of the callback (output paramater) */
-};
-
 /*
  * EC recover task error callback
  *
@@ -539,10 +716,9 @@ static void
 ec_recover_error_callback(struct doca_ec_task_recover *recover_task, union doca_data task_user_data,
 			  union doca_data ctx_user_data)
 {
-	struct recover_task_data *task_data = task_user_data.ptr;
-	(void)ctx_user_data;
+	(void)task_user_data;
 
-	ec_task_error(doca_ec_task_recover_as_task(recover_task), task_data->task_status, task_data->cb_result);
+	ec_task_error(doca_ec_task_recover_as_task(recover_task), ctx_user_data.ptr);
 }
 
 /*
@@ -556,58 +732,109 @@ static void
 ec_recover_completed_callback(struct doca_ec_task_recover *recover_task, union doca_data task_user_data,
 			      union doca_data ctx_user_data)
 {
-	int ret;
-	size_t i;
-	doca_error_t result;
-	uint8_t *resp_data;
-	char full_path[MAX_PATH_NAME];
-	size_t block_file_size = 0;
-	struct recover_task_data *task_data = task_user_data.ptr;
-	struct ec_sample_objects *state = ctx_user_data.ptr;
-
-	*task_data->task_status = DOCA_SUCCESS;
-
-	/* write the result to output file */
-	result = doca_buf_get_data(task_data->recovered_data_blocks, (void **)&resp_data);
-	CB_ASSERT(result == DOCA_SUCCESS, result, task_data->cb_result,
-		  "Unable to retrieve data pointer from redundancy data blocks buffer");
-
-	for (i = 0; i < task_data->n_missing; i++) {
-		ret = snprintf(full_path, sizeof(full_path), "%s/%s%d", task_data->dir_path, DATA_BLOCK_FILE_NAME,
-			      state->missing_indices[i]);
-		CB_ASSERT(ret >= 0 && ret < (int)sizeof(full_path), DOCA_ERROR_IO_FAILED, task_data->cb_result, "Path exceeded max path len");
-		state->block_file = fopen(full_path, "wr");
-		CB_ASSERT(state->block_file != NULL, DOCA_ERROR_IO_FAILED, task_data->cb_result,
-			  "Unable to open output file: %s", full_path);
-		ret = fwrite(resp_data + i * task_data->block_size, task_data->block_size, 1,
-			     state->block_file);
-		CB_ASSERT(ret >= 0, DOCA_ERROR_IO_FAILED, task_data->cb_result, "Failed to write to file");
-		fclose(state->block_file);
-		state->block_file = NULL;
+	struct ec_stripe *stripe = task_user_data.ptr;
+	(void)ctx_user_data;
+
+	/* The stripe is written by the main loop, in order */
+	stripe->done = true;
+
+	/* Free task */
+	doca_task_free(doca_ec_task_recover_as_task(recover_task));
+}
+
+/*
+ * Read the available blocks of a stripe from the block files
+ *
+ * @state [in]: the DOCA EC sample state
+ * @stripe [in]: the stripe to read
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR otherwise.
+ */
+static doca_error_t
+ec_decode_read_stripe(struct ec_sample_objects *state, struct ec_stripe *stripe)
+{
+	uint32_t i;
+
+	for (i = 0; i < state->nb_block_files; i++) {
+		if (state->block_pos[i] <= 0)
+			continue;
+		if (fread(stripe->src + (state->block_pos[i] - 1) * state->block_size, state->block_size, 1,
+			  state->block_files[i]) != 1) {
+			DOCA_LOG_ERR("Failed to read stripe %lu of block %u", stripe->index, i);
+			return DOCA_ERROR_IO_FAILED;
+		}
 	}
+	return DOCA_SUCCESS;
+}
 
-	for (i = 0; i < task_data->data_block_count; i++) {
-		ret = snprintf(full_path, sizeof(full_path), "%s/%s%ld", task_data->dir_path, DATA_BLOCK_FILE_NAME, i);
-		CB_ASSERT(ret >= 0 && ret < (int)sizeof(full_path), DOCA_ERROR_IO_FAILED, task_data->cb_result, "Path exceeded max path len");
-		result = read_file(full_path, &state->block_file_data, &block_file_size);
-		CB_ASSERT(result == DOCA_SUCCESS, result, task_data->cb_result, "Unable to open data file");
-		if (i == task_data->data_block_count - 1)
-			block_file_size = task_data->file_size - (task_data->data_block_count - 1) * block_file_size;
-		ret = fwrite(state->block_file_data, block_file_size, 1, state->out_file);
-		CB_ASSERT(ret >= 0, DOCA_ERROR_IO_FAILED, task_data->cb_result, "Failed to write to file");
-		free(state->block_file_data);
-		state->block_file_data = NULL;
+/*
+ * Submit the recover task of a stripe
+ *
+ * @state [in]: the DOCA EC sample state
+ * @stripe [in]: the stripe to recover
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR otherwise.
+ */
+static doca_error_t
+ec_decode_submit_stripe(struct ec_sample_objects *state, struct ec_stripe *stripe)
+{
+	struct doca_ec_task_recover *task;
+	union doca_data user_data;
+	doca_error_t result;
+
+	user_data.ptr = stripe;
+	result = doca_ec_task_recover_allocate_init(state->ec, state->decoding_matrix, stripe->src_doca_buf,
+						    stripe->dst_doca_buf, user_data, &task);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to allocate and initiate task: %s", doca_error_get_descr(result));
+		return result;
 	}
 
-	DOCA_LOG_INFO("File was decoded successfully and saved in: %s", task_data->output_file_path);
+	/* Enqueue ec recover task */
+	result = doca_task_submit(doca_ec_task_recover_as_task(task));
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Unable to submit task: %s", doca_error_get_descr(result));
+		doca_task_free(doca_ec_task_recover_as_task(task));
+		return result;
+	}
+	return DOCA_SUCCESS;
+}
 
-	/* Free task */
-	doca_task_free(doca_ec_task_recover_as_task(recover_task));
+/*
+ * Append the recovered blocks of a stripe to their block files and its data to the recovered file
+ *
+ * @state [in]: the DOCA EC sample state
+ * @stripe [in]: the recovered stripe
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR otherwise.
+ */
+static doca_error_t
+ec_decode_write_stripe(struct ec_sample_objects *state, struct ec_stripe *stripe)
+{
+	uint64_t offset = stripe->index * state->block_size * state->data_block_count;
+	uint64_t len;
+	uint32_t i;
+	char *block;
 
-	*task_data->cb_result = DOCA_SUCCESS;
+	for (i = 0; i < state->n_missing; i++) {
+		if (fwrite(stripe->dst + i * state->block_size, state->block_size, 1,
+			   state->block_files[state->missing_indices[i]]) != 1) {
+			DOCA_LOG_ERR("Failed to write to file");
+			return DOCA_ERROR_IO_FAILED;
+		}
+	}
 
-	/* Stop context once task is completed */
-	(void)doca_ctx_stop(state->core_state.ctx);
+	/* The padding of the last stripe is not part of the file */
+	for (i = 0; i < state->data_block_count && offset < state->file_size; i++) {
+		if (state->block_pos[i] > 0)
+			block = stripe->src + (state->block_pos[i] - 1) * state->block_size;
+		else
+			block = stripe->dst + (-state->block_pos[i] - 1) * state->block_size;
+		len = state->file_size - offset < state->block_size ? state->file_size - offset : state->block_size;
+		if (fwrite(block, len, 1, state->out_file) != 1) {
+			DOCA_LOG_ERR("Failed to write to file");
+			return DOCA_ERROR_IO_FAILED;
+		}
+		offset += len;
+	}
+	return DOCA_SUCCESS;
 }
 
 /*
@@ -625,34 +852,26 @@ doca_error_t
 ec_decode(const char *pci_addr, enum doca_ec_matrix_type matrix_type, const char *user_output_file_path,
 	  const char *dir_path, uint32_t data_block_count, uint32_t rdnc_block_count)
 {
-	uint32_t max_bufs = 2;
 	doca_error_t result;
 	int ret;
-	size_t i;
+	uint32_t i;
 	uint64_t max_block_size;
 	size_t block_file_size;
 	uint64_t block_size = 0;
+	uint64_t blocks_size = 0;
+	uint64_t stripe_block_size = 0;
+	uint32_t n_available = 0;
 	uint32_t str_len;
-	uint64_t src_size = -1;
-	uint64_t src_size_cur = 0;
-	uint64_t dst_size;
 	struct ec_sample_objects state_object = {0};
 	struct ec_sample_objects *state = &state_object;
-	size_t n_missing = 0;
+	struct stat block_stat;
 	char *end;
 	int64_t file_size;
 	char output_file_path[MAX_PATH_NAME];
 	char full_path[MAX_PATH_NAME];
-	struct timespec ts = {
-		.tv_sec = 0,
-		.tv_nsec = SLEEP_IN_NANOS,
-	};
-	doca_error_t task_status = DOCA_SUCCESS;
-	doca_error_t callback_result = DOCA_SUCCESS;
-	struct doca_task *doca_task;
-	struct doca_ec_task_recover *task;
-	struct recover_task_data task_data;
-	union doca_data user_data;
+
+	state->data_block_count = data_block_count;
+	state->rdnc_block_count = rdnc_block_count;
 
 	ret = snprintf(full_path, sizeof(full_path), "%s/%s", dir_path, DATA_INFO_FILE_NAME);
 	SAMPLE_ASSERT(ret >= 0 && ret < (int)sizeof(full_path), DOCA_ERROR_IO_FAILED, state, "Path exceeded max path len");
@@ -663,6 +882,7 @@ ec_decode(const char *pci_addr, enum doca_ec_matrix_type matrix_type, const char
 	file_size = strtol(state->block_file_data, &end, 10);
 	SAMPLE_ASSERT(file_size > 0, DOCA_ERROR_INVALID_VALUE, state, "File size from data info file none positive");
 	SAMPLE_ASSERT(*end != '\0', DOCA_ERROR_INVALID_VALUE, state, "Data info file not containing path");
+	state->file_size = file_size;
 
 	if (user_output_file_path != NULL) {
 		SAMPLE_ASSERT(strnlen(user_output_file_path, MAX_PATH_NAME) < MAX_PATH_NAME, DOCA_ERROR_INVALID_VALUE,
@@ -678,58 +898,92 @@ ec_decode(const char *pci_addr, enum doca_ec_matrix_type matrix_type, const char
 	free(state->block_file_data);
 	state->block_file_data = NULL;
 
+	/* Blocks encoded before streaming have no stripe info, they are a single stripe */
+	ret = snprintf(full_path, sizeof(full_path), "%s/%s", dir_path, STRIPE_INFO_FILE_NAME);
+	SAMPLE_ASSERT(ret >= 0 && ret < (int)sizeof(full_path), DOCA_ERROR_IO_FAILED, state, "Path exceeded max path len");
+	if (access(full_path, F_OK) == 0) {
+		result = read_file(full_path, &state->block_file_data, &block_file_size);
+		ASSERT_DOCA_ERR(result, state, "Unable to open stripe info file");
+		SAMPLE_ASSERT(strnlen(state->block_file_data, block_file_size) < MAX_DATA_SIZE,
+			      DOCA_ERROR_INVALID_VALUE, state, "Stripe info may be nonfinite");
+		stripe_block_size = strtoull(state->block_file_data, NULL, 10);
+		SAMPLE_ASSERT(stripe_block_size > 0 && stripe_block_size % EC_BLOCK_ALIGNMENT == 0,
+			      DOCA_ERROR_INVALID_VALUE, state, "Stripe block size is not 64 byte aligned");
+		free(state->block_file_data);
+		state->block_file_data = NULL;
+	}
+
 	state->out_file = fopen(output_file_path, "wr");
 	SAMPLE_ASSERT(state->out_file != NULL, DOCA_ERROR_IO_FAILED, state, "Unable to open output file: %s",
 	       output_file_path);
 
-	state->missing_indices = calloc(data_block_count + rdnc_block_count, sizeof(uint32_t));
-	SAMPLE_ASSERT(state->missing_indices != NULL, DOCA_ERROR_NO_MEMORY, state, "Unable to allocate missing_indices");
+	state->nb_block_files = data_block_count + rdnc_block_count;
+	state->block_files = calloc(state->nb_block_files, sizeof(*state->block_files));
+	SAMPLE_ASSERT(state->block_files != NULL, DOCA_ERROR_NO_MEMORY, state, "Unable to allocate block files");
 
-	for (i = 0; i < data_block_count + rdnc_block_count; i++) {
-		char *file_name = i < data_block_count ? DATA_BLOCK_FILE_NAME : RDNC_BLOCK_FILE_NAME;
-		size_t index = i < data_block_count ? i : i - data_block_count;
+	state->missing_indices = calloc(state->nb_block_files, sizeof(uint32_t));
+	SAMPLE_ASSERT(state->missing_indices != NULL, DOCA_ERROR_NO_MEMORY, state, "Unable to allocate missing_indices");
 
-		ret = snprintf(full_path, sizeof(full_path), "%s/%s%ld", dir_path, file_name, index);
-		SAMPLE_ASSERT(ret >= 0 && ret < (int)sizeof(full_path), DOCA_ERROR_IO_FAILED, state, "Path exceeded max path len");
-		result = read_file(full_path, &state->block_file_data, &block_file_size);
-		if (result == DOCA_SUCCESS && block_file_size > 0 && block_size == 0) {
-			block_size = block_file_size;
-			SAMPLE_ASSERT(block_size % 64 == 0, DOCA_ERROR_INVALID_VALUE, state,
-			       "Block size is not 64 byte aligned");
-			src_size = (uint64_t)block_size * data_block_count;
-			state->src_buffer = malloc(src_size);
-			SAMPLE_ASSERT(state->src_buffer != NULL, DOCA_ERROR_NO_MEMORY, state,
-			       "Unable to allocate src_buffer string");
+	/*
+	 * Position of every block in the stripe buffers: the available blocks are in the source by order, from 1 up, the
+	 * missing blocks are in the destination by order, from -1 down, and 0 is a block the recovery does not use
+	 */
+	state->block_pos = calloc(state->nb_block_files, sizeof(*state->block_pos));
+	SAMPLE_ASSERT(state->block_pos != NULL, DOCA_ERROR_NO_MEMORY, state, "Unable to allocate block positions");
+
+	for (i = 0; i < state->nb_block_files && n_available < data_block_count; i++) {
+		result = ec_open_block_file(dir_path, i, data_block_count, "r", &state->block_files[i]);
+		if (result != DOCA_SUCCESS) {
+			ec_cleanup(state);
+			return result;
+		}
+		if (state->block_files[i] != NULL && fstat(fileno(state->block_files[i]), &block_stat) == 0 &&
+		    block_stat.st_size > 0) {
+			if (blocks_size == 0)
+				blocks_size = block_stat.st_size;
+			SAMPLE_ASSERT((uint64_t)block_stat.st_size == blocks_size, DOCA_ERROR_INVALID_VALUE, state,
+				      "Blocks are not same size");
+			state->block_pos[i] = ++n_available;
+			continue;
 		}
-		if (result == DOCA_SUCCESS) {
-			SAMPLE_ASSERT((uint64_t)block_file_size == block_size, DOCA_ERROR_INVALID_VALUE, state,
-			       "Blocks are not same size");
-			DOCA_LOG_INFO("Copy: %s", full_path);
-			memcpy(state->src_buffer + src_size_cur, state->block_file_data, block_size);
-			src_size_cur += block_size;
-			free(state->block_file_data);
-			state->block_file_data = NULL;
-		} else
-			state->missing_indices[n_missing++] = i;
-		if (src_size_cur == src_size)
-			break;
+		if (state->block_files[i] != NULL) {
+			fclose(state->block_files[i]);
+			state->block_files[i] = NULL;
+		}
+		state->missing_indices[state->n_missing] = i;
+		state->block_pos[i] = -(int64_t)++state->n_missing;
 	}
 
-	SAMPLE_ASSERT(src_size_cur == src_size, DOCA_ERROR_INVALID_VALUE, state, "Not enough data for recover");
-	SAMPLE_ASSERT(n_missing > 0, DOCA_ERROR_INVALID_VALUE, state,
+	SAMPLE_ASSERT(n_available == data_block_count, DOCA_ERROR_INVALID_VALUE, state, "Not enough data for recover");
+	SAMPLE_ASSERT(state->n_missing > 0, DOCA_ERROR_INVALID_VALUE, state,
 	       "Nothing to decode, all original data block are in place");
-	dst_size = block_size * n_missing;
 
-	state->dst_buffer = malloc(dst_size);
-	SAMPLE_ASSERT(state->dst_buffer != NULL, DOCA_ERROR_NO_MEMORY, state, "Unable to allocate dst_buffer string");
+	block_size = stripe_block_size != 0 ? stripe_block_size : blocks_size;
+	SAMPLE_ASSERT(block_size % EC_BLOCK_ALIGNMENT == 0, DOCA_ERROR_INVALID_VALUE, state,
+		      "Block size is not 64 byte aligned");
+	SAMPLE_ASSERT(blocks_size % block_size == 0, DOCA_ERROR_INVALID_VALUE, state,
+		      "Block files are not made of whole stripes");
+	state->block_size = block_size;
+	state->nb_stripes = blocks_size / block_size;
+	SAMPLE_ASSERT(state->nb_stripes * block_size * data_block_count >= state->file_size, DOCA_ERROR_INVALID_VALUE,
+		      state, "Block files are smaller than the original file");
+
+	/* The recovered blocks are written back to their block files */
+	for (i = 0; i < state->n_missing; i++) {
+		result = ec_open_block_file(dir_path, state->missing_indices[i], data_block_count, "w",
+					    &state->block_files[state->missing_indices[i]]);
+		if (result != DOCA_SUCCESS) {
+			ec_cleanup(state);
+			return result;
+		}
+	}
 
-	result = ec_core_init(state, pci_addr, (tasks_check)&doca_ec_cap_task_recover_is_supported, max_bufs, src_size,
-			      dst_size, &max_block_size);
+	result = ec_core_init(state, pci_addr, (tasks_check)&doca_ec_cap_task_recover_is_supported, &max_block_size);
 	if (result != DOCA_SUCCESS)
 		return result;
 
 	SAMPLE_ASSERT(block_size <= max_block_size, DOCA_ERROR_INVALID_VALUE, state,
-		      "Block size (%lu) exceeds the maximum size supported (%lu). Try to increase the number of blocks or use a smaller file as input",
+		      "Block size (%lu) exceeds the maximum size supported (%lu). Try to encode with a smaller stripe block size",
 		      block_size, max_block_size);
 
 	/* Set task configuration */
@@ -737,67 +991,36 @@ ec_decode(const char *pci_addr, enum doca_ec_matrix_type matrix_type, const char
 					       NUM_EC_TASKS);
 	ASSERT_DOCA_ERR(result, state, "Unable to set configuration for recover tasks");
 
+	result = ec_stripes_init(state, block_size * data_block_count, block_size * state->n_missing);
+	if (result != DOCA_SUCCESS)
+		return result;
+
 	/* Start the task */
 	result = doca_ctx_start(state->core_state.ctx);
 	ASSERT_DOCA_ERR(result, state, "Unable to start context");
+	state->run_main_loop = true;
 
 	/* Create a matrix for the task */
 	result = doca_ec_matrix_create(state->ec, matrix_type, data_block_count, rdnc_block_count,
 				       &state->encoding_matrix);
 	ASSERT_DOCA_ERR(result, state, "Unable to create ec matrix");
 
-	result = doca_ec_matrix_create_recover(state->ec, state->encoding_matrix, state->missing_indices, n_missing,
-					       &state->decoding_matrix);
+	result = doca_ec_matrix_create_recover(state->ec, state->encoding_matrix, state->missing_indices,
+					       state->n_missing, &state->decoding_matrix);
 	ASSERT_DOCA_ERR(result, state, "Unable to create recovery matrix");
 
-	/* Include all necessary parameters for completion callback in user data of task */
-	task_data = (struct recover_task_data) {
-		.dir_path = dir_path,
-		.output_file_path = output_file_path,
-		.file_size = file_size,
-		.block_size = block_size,
-		.data_block_count = data_block_count,
-		.n_missing = n_missing,
-		.recovered_data_blocks = state->dst_doca_buf,
-		.task_status = &task_status,
-		.cb_result = &callback_result
-	};
-	user_data.ptr = &task_data;
-
-	/* Construct EC recover task */
-	result = doca_ec_task_recover_allocate_init(state->ec, state->decoding_matrix, state->src_doca_buf,
-						    state->dst_doca_buf, user_data, &task);
-	ASSERT_DOCA_ERR(result, state, "Unable to allocate and initiate task");
-
-	doca_task = doca_ec_task_recover_as_task(task);
-	SAMPLE_ASSERT(doca_task != NULL, DOCA_ERROR_UNEXPECTED, state, "Unable to retrieve task as doca_task");
-
-	/* Enqueue ec recover task */
-	result = doca_task_submit(doca_task);
-	ASSERT_DOCA_ERR(result, state, "Unable to submit task");
-
-	state->run_main_loop = true;
+	DOCA_LOG_INFO("Recovering %lu stripes of %u blocks of %lu bytes", state->nb_stripes, data_block_count,
+		      block_size);
+	result = ec_stream(state, ec_decode_read_stripe, ec_decode_submit_stripe, ec_decode_write_stripe);
+	ASSERT_DOCA_ERR(result, state, "EC recover task failed");
 
-	/* Wait for recover task completion and context stopped */
-	while (state->run_main_loop) {
-		if (doca_pe_progress(state->core_state.pe) == 0)
-			nanosleep(&ts, &ts);
-	}
-
-	/* Check result of task and the callback */
-	ASSERT_DOCA_ERR(task_status, state, "EC recover task failed");
-
-	if (callback_result == DOCA_SUCCESS)
-		DOCA_LOG_INFO("Success, data was recovered");
-	else
-		DOCA_LOG_ERR("Sample failed: %s", doca_error_get_descr(callback_result));
-
-	/* The task was already freed and the context was stopped in the callbacks */
+	DOCA_LOG_INFO("File was decoded successfully and saved in: %s", output_file_path);
+	DOCA_LOG_INFO("Success, data was recovered");
 
 	/* Clean and destroy all relevant objects */
 	ec_cleanup(state);
 
-	return callback_result;
+	return DOCA_SUCCESS;
 }
 
 /*
@@ -835,6 +1058,7 @@ ec_delete_data(const char *output_path, uint32_t *missing_indices, size_t n_miss
  * @matrix_type [in]: matrix type
  * @data_block_count [in]: data block count
  * @rdnc_block_count [in]: redundancy block count
+ * @stripe_block_size [in]: maximal block size of a stripe, 0 for the maximum the device supports
  * @missing_indices [in]: data indices to delete
  * @n_missing [in]: indices count
  * @return: DOCA_SUCCESS on success, DOCA_ERROR otherwise.
@@ -842,7 +1066,7 @@ ec_delete_data(const char *output_path, uint32_t *missing_indices, size_t n_miss
 doca_error_t
 ec_recover(const char *pci_addr, const char *input_path, const char *output_path, bool do_both,
 	   enum doca_ec_matrix_type matrix_type, uint32_t data_block_count, uint32_t rdnc_block_count,
-	   uint32_t *missing_indices, size_t n_missing)
+	   uint64_t stripe_block_size, uint32_t *missing_indices, size_t n_missing)
 {
 	doca_error_t result = DOCA_SUCCESS;
 	struct stat path_stat;
@@ -861,7 +1085,8 @@ ec_recover(const char *pci_addr, const char *input_path, const char *output_path
 	}
 
 	if (do_both || input_path_is_file)
-		result = ec_encode(pci_addr, input_path, matrix_type, output_path, data_block_count, rdnc_block_count);
+		result = ec_encode(pci_addr, input_path, matrix_type, output_path, data_block_count, rdnc_block_count,
+				   stripe_block_size);
 	if (result != DOCA_SUCCESS)
 		return result;
 	if (do_both)
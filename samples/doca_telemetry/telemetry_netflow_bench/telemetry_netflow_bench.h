@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef TELEMETRY_NETFLOW_BENCH_H_
+#define TELEMETRY_NETFLOW_BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <doca_error.h>
+
+#include <telemetry.h>
+
+#define NETFLOW_BENCH_RECORDS 10000000		/* Default records generated per worker lcore */
+#define NETFLOW_BENCH_FLOWS 65536		/* Default flows per worker lcore */
+#define NETFLOW_BENCH_PKTS_PER_FLOW 16		/* Default records after which a flow ends with a TCP FIN */
+#define NETFLOW_BENCH_COLLECTOR_ADDR "127.0.0.1" /* Default address of the bundled collector */
+
+/* Benchmark configuration */
+struct netflow_bench_cfg {
+	uint32_t records_per_lcore;	/* Records generated by every worker lcore */
+	uint32_t flows_per_lcore;	/* Flows the records of every worker lcore are spread over */
+	uint32_t pkts_per_flow;		/* Records after which a flow ends with a TCP FIN, 0 for never */
+	bool external_collector;	/* Export to an external collector instead of the bundled one */
+	struct netflow_cfg exporter;	/* Exporter configuration */
+};
+
+/*
+ * Fill the benchmark configuration with the defaults
+ *
+ * @cfg [out]: benchmark configuration
+ */
+void netflow_bench_default_cfg(struct netflow_bench_cfg *cfg);
+
+/*
+ * Register the command line parameters of the benchmark
+ *
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t register_netflow_bench_params(void);
+
+/*
+ * Run the benchmark: the worker lcores aggregate records while the main lcore sends them to the collector
+ *
+ * @cfg [in]: benchmark configuration, the collector port is updated to the one of the bundled collector
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t telemetry_netflow_bench(struct netflow_bench_cfg *cfg);
+
+#endif /* TELEMETRY_NETFLOW_BENCH_H_ */
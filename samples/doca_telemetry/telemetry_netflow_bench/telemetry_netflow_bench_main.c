@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <stdlib.h>
+
+#include <doca_argp.h>
+#include <doca_log.h>
+
+#include <dpdk_utils.h>
+
+#include "telemetry_netflow_bench.h"
+
+DOCA_LOG_REGISTER(TELEMETRY::NETFLOW::BENCH::MAIN);
+
+/*
+ * Sample main function
+ *
+ * @argc [in]: command line arguments size
+ * @argv [in]: array of command line arguments
+ * @return: EXIT_SUCCESS on success and EXIT_FAILURE otherwise
+ */
+int
+main(int argc, char **argv)
+{
+	doca_error_t result;
+	struct doca_log_backend *sdk_log;
+	struct netflow_bench_cfg cfg;
+	int exit_status = EXIT_FAILURE;
+
+	netflow_bench_default_cfg(&cfg);
+
+	/* Register a logger backend */
+	result = doca_log_backend_create_standard();
+	if (result != DOCA_SUCCESS)
+		goto sample_exit;
+
+	/* Register a logger backend for internal SDK errors and warnings */
+	result = doca_log_backend_create_with_file_sdk(stderr, &sdk_log);
+	if (result != DOCA_SUCCESS)
+		goto sample_exit;
+	result = doca_log_backend_set_sdk_level(sdk_log, DOCA_LOG_LEVEL_WARNING);
+	if (result != DOCA_SUCCESS)
+		goto sample_exit;
+
+	DOCA_LOG_INFO("Starting the sample");
+
+	result = doca_argp_init("doca_telemetry_netflow_bench", &cfg);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to init ARGP resources: %s", doca_error_get_descr(result));
+		goto sample_exit;
+	}
+	doca_argp_set_dpdk_program(dpdk_init);
+	result = register_netflow_bench_params();
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register sample params: %s", doca_error_get_descr(result));
+		goto argp_cleanup;
+	}
+	result = doca_argp_start(argc, argv);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to parse sample input: %s", doca_error_get_descr(result));
+		goto argp_cleanup;
+	}
+
+	result = telemetry_netflow_bench(&cfg);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("telemetry_netflow_bench() encountered an error: %s", doca_error_get_descr(result));
+		goto dpdk_cleanup;
+	}
+
+	exit_status = EXIT_SUCCESS;
+
+dpdk_cleanup:
+	dpdk_fini();
+argp_cleanup:
+	doca_argp_destroy();
+sample_exit:
+	if (exit_status == EXIT_SUCCESS)
+		DOCA_LOG_INFO("Sample finished successfully");
+	else
+		DOCA_LOG_INFO("Sample finished with errors");
+	return exit_status;
+}
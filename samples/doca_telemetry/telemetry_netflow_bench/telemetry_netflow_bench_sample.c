@@ -0,0 +1,557 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <linux/types.h>
+
+#include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_pause.h>
+
+#include <doca_argp.h>
+#include <doca_log.h>
+
+#include <netflow_collector.h>
+#include <telemetry.h>
+#include <utils.h>
+
+#include "telemetry_netflow_bench.h"
+
+DOCA_LOG_REGISTER(TELEMETRY_NETFLOW_BENCH);
+
+#define NETFLOW_BENCH_SOURCE_ID 1		/* Netflow source id of the exporter */
+#define NETFLOW_BENCH_PKT_LEN 512		/* Length of every packet of the generated flows */
+#define NETFLOW_BENCH_TCP_FIN 0x01		/* TCP FIN flag, ends a flow */
+#define NETFLOW_BENCH_DST_ADDR 0xc0a80001	/* Destination address of all the flows, 192.168.0.1 */
+#define NETFLOW_BENCH_DST_PORT 80		/* Destination port of all the flows */
+#define NETFLOW_BENCH_DRAIN_MS 2000		/* Time the collector has to receive the last export packets */
+#define NETFLOW_BENCH_DRAIN_POLL_US 10000	/* Interval of the collector counters checks */
+
+static uint32_t nb_workers_done;	/* Worker lcores done generating and flushing, written with atomics */
+
+/*
+ * ARGP Callback - Handle records per lcore parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+records_callback(void *param, void *config)
+{
+	struct netflow_bench_cfg *cfg = (struct netflow_bench_cfg *)config;
+	int records = *(int *)param;
+
+	if (records <= 0) {
+		DOCA_LOG_ERR("Records per lcore must be positive, got %d", records);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->records_per_lcore = records;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle flows per lcore parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+flows_callback(void *param, void *config)
+{
+	struct netflow_bench_cfg *cfg = (struct netflow_bench_cfg *)config;
+	int flows = *(int *)param;
+
+	/* The flow index is encoded in the source address and port */
+	if (flows <= 0 || flows > (1 << 24)) {
+		DOCA_LOG_ERR("Flows per lcore must be between 1 and %d, got %d", 1 << 24, flows);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->flows_per_lcore = flows;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle packets per flow parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+pkts_per_flow_callback(void *param, void *config)
+{
+	struct netflow_bench_cfg *cfg = (struct netflow_bench_cfg *)config;
+	int pkts = *(int *)param;
+
+	if (pkts < 0) {
+		DOCA_LOG_ERR("Packets per flow must not be negative, got %d", pkts);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->pkts_per_flow = pkts;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle collector address parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+collector_addr_callback(void *param, void *config)
+{
+	struct netflow_bench_cfg *cfg = (struct netflow_bench_cfg *)config;
+	const char *addr = (char *)param;
+	struct in_addr in;
+
+	if (inet_pton(AF_INET, addr, &in) != 1) {
+		DOCA_LOG_ERR("Collector address \"%s\" is not an IPv4 address", addr);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strlcpy(cfg->exporter.collector_addr, addr, sizeof(cfg->exporter.collector_addr));
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle collector port parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+collector_port_callback(void *param, void *config)
+{
+	struct netflow_bench_cfg *cfg = (struct netflow_bench_cfg *)config;
+	int port = *(int *)param;
+
+	if (port < 0 || port > UINT16_MAX) {
+		DOCA_LOG_ERR("Collector port must be between 0 and %d, got %d", UINT16_MAX, port);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->exporter.collector_port = port;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle external collector parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS
+ */
+static doca_error_t
+external_collector_callback(void *param, void *config)
+{
+	struct netflow_bench_cfg *cfg = (struct netflow_bench_cfg *)config;
+
+	cfg->external_collector = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle batch size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+batch_size_callback(void *param, void *config)
+{
+	struct netflow_bench_cfg *cfg = (struct netflow_bench_cfg *)config;
+	int batch_size = *(int *)param;
+
+	/* The exporter checks the batch size against the queue size */
+	if (batch_size <= 0) {
+		DOCA_LOG_ERR("Batch size must be positive, got %d", batch_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->exporter.batch_size = batch_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle queue size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+queue_size_callback(void *param, void *config)
+{
+	struct netflow_bench_cfg *cfg = (struct netflow_bench_cfg *)config;
+	int queue_size = *(int *)param;
+
+	if (queue_size <= 0) {
+		DOCA_LOG_ERR("Queue size must be positive, got %d", queue_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->exporter.queue_size = queue_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle cache size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+cache_size_callback(void *param, void *config)
+{
+	struct netflow_bench_cfg *cfg = (struct netflow_bench_cfg *)config;
+	int cache_size = *(int *)param;
+
+	if (cache_size <= 0) {
+		DOCA_LOG_ERR("Cache size must be positive, got %d", cache_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->exporter.cache_size = cache_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle template parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+template_callback(void *param, void *config)
+{
+	struct netflow_bench_cfg *cfg = (struct netflow_bench_cfg *)config;
+	const char *template = (char *)param;
+
+	if (strcmp(template, "full") == 0)
+		cfg->exporter.template_type = NETFLOW_TEMPLATE_FULL;
+	else if (strcmp(template, "ipv4") == 0)
+		cfg->exporter.template_type = NETFLOW_TEMPLATE_IPV4;
+	else {
+		DOCA_LOG_ERR("Template must be \"full\" or \"ipv4\", got \"%s\"", template);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle max packet size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+max_packet_size_callback(void *param, void *config)
+{
+	struct netflow_bench_cfg *cfg = (struct netflow_bench_cfg *)config;
+	int max_packet_size = *(int *)param;
+
+	if (max_packet_size < 0 || max_packet_size > UINT16_MAX) {
+		DOCA_LOG_ERR("Max packet size must be between 0 and %d, got %d", UINT16_MAX, max_packet_size);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->exporter.max_packet_size = max_packet_size;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Create and register a parameter of the benchmark
+ *
+ * @short_name [in]: short name, NULL for none
+ * @long_name [in]: long name
+ * @description [in]: description
+ * @callback [in]: callback
+ * @type [in]: type
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+register_param(const char *short_name, const char *long_name, const char *description, doca_argp_param_cb_t callback,
+	       enum doca_argp_type type)
+{
+	struct doca_argp_param *param;
+	doca_error_t result;
+
+	result = doca_argp_param_create(&param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	if (short_name != NULL)
+		doca_argp_param_set_short_name(param, short_name);
+	doca_argp_param_set_long_name(param, long_name);
+	doca_argp_param_set_description(param, description);
+	doca_argp_param_set_callback(param, callback);
+	doca_argp_param_set_type(param, type);
+	result = doca_argp_register_param(param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+register_netflow_bench_params(void)
+{
+	doca_error_t result;
+
+	result = register_param("r", "records", "Netflow records generated by every worker lcore", records_callback,
+				DOCA_ARGP_TYPE_INT);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param("f", "flows", "Flows the records of every worker lcore are spread over",
+				flows_callback, DOCA_ARGP_TYPE_INT);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param("p", "pkts-per-flow",
+				"Records after which a flow ends with a TCP FIN, 0 to let the timeouts export them",
+				pkts_per_flow_callback, DOCA_ARGP_TYPE_INT);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param("a", "collector-addr", "Collector IPv4 address, the bundled collector listens on it",
+				collector_addr_callback, DOCA_ARGP_TYPE_STRING);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param(NULL, "collector-port", "Collector UDP port, 0 for any port of the bundled collector",
+				collector_port_callback, DOCA_ARGP_TYPE_INT);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param("e", "external-collector",
+				"Export to an external collector instead of the bundled one, records are not verified",
+				external_collector_callback, DOCA_ARGP_TYPE_BOOLEAN);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param("b", "batch-size", "Records handed over to the sender at once", batch_size_callback,
+				DOCA_ARGP_TYPE_INT);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param("q", "queue-size", "Records waiting to be sent per lcore, multiple of the batch size",
+				queue_size_callback, DOCA_ARGP_TYPE_INT);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param("c", "cache-size", "Flows aggregated per lcore, power of 2", cache_size_callback,
+				DOCA_ARGP_TYPE_INT);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param("t", "template", "Template of the exported records: \"full\" or \"ipv4\"",
+				template_callback, DOCA_ARGP_TYPE_STRING);
+	if (result != DOCA_SUCCESS)
+		return result;
+	return register_param("m", "max-packet-size", "Largest Netflow packet, 0 for the library default",
+			      max_packet_size_callback, DOCA_ARGP_TYPE_INT);
+}
+
+void
+netflow_bench_default_cfg(struct netflow_bench_cfg *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->records_per_lcore = NETFLOW_BENCH_RECORDS;
+	cfg->flows_per_lcore = NETFLOW_BENCH_FLOWS;
+	cfg->pkts_per_flow = NETFLOW_BENCH_PKTS_PER_FLOW;
+	netflow_default_cfg(&cfg->exporter);
+	strlcpy(cfg->exporter.collector_addr, NETFLOW_BENCH_COLLECTOR_ADDR, sizeof(cfg->exporter.collector_addr));
+	cfg->exporter.collector_port = 0;
+}
+
+/*
+ * Check a record decoded by the collector against the generated flows: every packet has the same length and all the
+ * flows are TCP flows from 10.0.0.0/8 to the same destination
+ *
+ * @record [in]: decoded record
+ * @user_ctx [in]: unused
+ * @return: true if the record is valid
+ */
+static bool
+check_record(const struct doca_telemetry_netflow_record *record, void *user_ctx)
+{
+	uint32_t pkts = ntohl(record->d_pkts);
+
+	(void)user_ctx;
+
+	return pkts != 0 && ntohl(record->d_octets) == pkts * NETFLOW_BENCH_PKT_LEN &&
+	       record->protocol == IPPROTO_TCP && ntohl(record->src_addr_v4) >> 24 == 10 &&
+	       ntohl(record->dst_addr_v4) == NETFLOW_BENCH_DST_ADDR && ntohs(record->dst_port) == NETFLOW_BENCH_DST_PORT;
+}
+
+/*
+ * Worker lcore main loop, aggregates the records of its flows and flushes its cache
+ *
+ * @arg [in]: benchmark configuration
+ * @return: 0 on success and -1 otherwise
+ */
+static int
+generate_records(void *arg)
+{
+	const struct netflow_bench_cfg *cfg = arg;
+	struct doca_telemetry_netflow_record record;
+	uint32_t flow = 0, round = 0, i;
+	doca_error_t result;
+
+	memset(&record, 0, sizeof(record));
+	record.dst_addr_v4 = htonl(NETFLOW_BENCH_DST_ADDR);
+	record.dst_port = htons(NETFLOW_BENCH_DST_PORT);
+	record.protocol = IPPROTO_TCP;
+	record.d_pkts = htonl(1);
+	record.d_octets = htonl(NETFLOW_BENCH_PKT_LEN);
+
+	/* The flows of the lcores are disjoint: the lcore id is the second byte of the source address */
+	for (i = 0; i < cfg->records_per_lcore; i++) {
+		record.src_addr_v4 = htonl(10U << 24 | (rte_lcore_id() & 0xff) << 16 | (flow >> 8 & 0xffff));
+		record.src_port = htons(1024 + (flow & 0xff));
+		record.tcp_flags = cfg->pkts_per_flow != 0 && (round + 1) % cfg->pkts_per_flow == 0 ?
+					   NETFLOW_BENCH_TCP_FIN : 0;
+		enqueue_netflow_record_to_ring(&record);
+		if (++flow == cfg->flows_per_lcore) {
+			flow = 0;
+			round++;
+		}
+	}
+
+	/* The sender frees room in the queue */
+	while ((result = netflow_lcore_flush()) == DOCA_ERROR_AGAIN)
+		rte_pause();
+	__atomic_fetch_add(&nb_workers_done, 1, __ATOMIC_RELEASE);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Lcore %u failed to flush its flows: %s", rte_lcore_id(), doca_error_get_descr(result));
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Wait for the collector to receive the records sent
+ *
+ * @collector [in]: collector
+ * @sent [in]: records sent
+ * @stats [out]: collector counters
+ */
+static void
+wait_collector(struct netflow_collector *collector, uint64_t sent, struct netflow_collector_stats *stats)
+{
+	uint64_t deadline = rte_get_timer_cycles() + rte_get_timer_hz() * NETFLOW_BENCH_DRAIN_MS / 1000;
+
+	do {
+		netflow_collector_get_stats(collector, stats);
+		if (stats->records + stats->unknown_template >= sent)
+			return;
+		rte_delay_us_sleep(NETFLOW_BENCH_DRAIN_POLL_US);
+	} while (rte_get_timer_cycles() < deadline);
+}
+
+doca_error_t
+telemetry_netflow_bench(struct netflow_bench_cfg *cfg)
+{
+	struct netflow_collector *collector = NULL;
+	struct netflow_collector_stats collector_stats;
+	struct netflow_stats stats;
+	uint64_t start, cycles, expected_pkts;
+	unsigned int lcore_id, nb_workers;
+	double seconds;
+	doca_error_t result, send_result = DOCA_SUCCESS;
+	int worker_result = 0;
+
+	nb_workers = rte_lcore_count() - 1;
+	if (nb_workers == 0) {
+		DOCA_LOG_ERR("At least 2 lcores are needed, the main lcore sends the records of the workers");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	if (!cfg->external_collector) {
+		result = netflow_collector_create(cfg->exporter.collector_addr, cfg->exporter.collector_port, check_record,
+						  NULL, &collector);
+		if (result != DOCA_SUCCESS)
+			return result;
+		cfg->exporter.collector_port = netflow_collector_get_port(collector);
+	}
+
+	result = init_netflow_exporter(NETFLOW_BENCH_SOURCE_ID, "netflow_bench", &cfg->exporter);
+	if (result != DOCA_SUCCESS)
+		goto destroy_collector;
+
+	DOCA_LOG_INFO("Exporting %u records of %u flows from each of %u lcores to %s:%u", cfg->records_per_lcore,
+		      cfg->flows_per_lcore, nb_workers, cfg->exporter.collector_addr, cfg->exporter.collector_port);
+
+	start = rte_get_timer_cycles();
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		rte_eal_remote_launch(generate_records, cfg, lcore_id);
+	}
+	/* The main lcore is the sender, it stops once the workers flushed and their queues are empty */
+	while (__atomic_load_n(&nb_workers_done, __ATOMIC_ACQUIRE) < nb_workers) {
+		result = send_netflow_record();
+		if (result != DOCA_SUCCESS)
+			send_result = result;
+	}
+	do {
+		result = send_netflow_record();
+		if (result != DOCA_SUCCESS)
+			send_result = result;
+		netflow_get_stats(&stats);
+	} while (stats.sent + stats.send_failed < stats.exported);
+	cycles = rte_get_timer_cycles() - start;
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (rte_eal_wait_lcore(lcore_id) != 0)
+			worker_result = -1;
+	}
+
+	seconds = (double)cycles / rte_get_timer_hz();
+	DOCA_LOG_INFO("Aggregated %" PRIu64 " records in %.3f seconds: %.0f records/sec", stats.records, seconds,
+		      stats.records / seconds);
+	DOCA_LOG_INFO("Exported %" PRIu64 " flows: %.0f flows/sec, %" PRIu64 " dropped, %" PRIu64 " sent, %" PRIu64
+		      " failed to be sent", stats.exported, stats.exported / seconds, stats.dropped, stats.sent,
+		      stats.send_failed);
+	if (worker_result != 0 || send_result != DOCA_SUCCESS) {
+		result = send_result != DOCA_SUCCESS ? send_result : DOCA_ERROR_BAD_STATE;
+		goto destroy_exporter;
+	}
+	if (collector == NULL)
+		goto destroy_exporter;
+
+	wait_collector(collector, stats.sent, &collector_stats);
+	DOCA_LOG_INFO("Collector received %" PRIu64 " packets, %" PRIu64 " records of %" PRIu64 " packets, %" PRIu64
+		      " invalid records, %" PRIu64 " malformed, %" PRIu64 " lost packets, %" PRIu64
+		      " records of unknown templates", collector_stats.packets, collector_stats.records,
+		      collector_stats.pkts, collector_stats.invalid_records, collector_stats.malformed,
+		      collector_stats.lost_packets, collector_stats.unknown_template);
+
+	/* Every generated packet should reach the collector when no record was dropped */
+	expected_pkts = (uint64_t)cfg->records_per_lcore * nb_workers;
+	if (stats.dropped != 0 || stats.send_failed != 0 || collector_stats.lost_packets != 0)
+		DOCA_LOG_WARN("Records were lost, the packets counters are not verified");
+	else if (collector_stats.pkts != expected_pkts || collector_stats.records != stats.sent ||
+		 collector_stats.invalid_records != 0 || collector_stats.malformed != 0) {
+		DOCA_LOG_ERR("Verification failed: collector received %" PRIu64 " packets in %" PRIu64
+			     " records, expected %" PRIu64 " packets in %" PRIu64 " records",
+			     collector_stats.pkts, collector_stats.records, expected_pkts, stats.sent);
+		result = DOCA_ERROR_BAD_STATE;
+	} else
+		DOCA_LOG_INFO("Verified %" PRIu64 " packets in %" PRIu64 " records", expected_pkts, stats.sent);
+
+destroy_exporter:
+	destroy_netflow_schema_and_source();
+destroy_collector:
+	if (collector != NULL)
+		netflow_collector_destroy(collector);
+	return result;
+}
@@ -41,12 +41,57 @@ port_state_string_dict = {
 	gen_pbuf.k_PORT_STATE_ACTIVE : "Active",
 }
 
+# Fields that delta-encoded records leave out while they do not change
+GM_INFO_FIELDS = (
+	'gm_identity',
+	'port_identity',
+	'current_utc_offset',
+	'time_traceable',
+	'frequency_traceable',
+	'gm_priority1',
+	'gm_clock_class',
+	'gm_clock_accuracy',
+	'gm_priority2',
+	'gm_offset_scaled_log_variance',
+	'domain_number',
+	'port_state',
+)
+
 logger = logging.getLogger(FULL_CLIENT_NAME)
 ch = logging.StreamHandler()
 ch.setFormatter(logging.Formatter('%(asctime)s - %(name)s - %(levelname)s - %(message)s'))
 logger.addHandler(ch)
 logger.setLevel(logging.INFO)
 
+class MonitorDeltaDecoder:
+	"""Restores the Grandmaster fields of delta-encoded monitor records."""
+
+	def __init__(self):
+		self.gm_info = None
+		self.seq = 0
+
+	def decode(self, record):
+		"""Fill in place the Grandmaster fields the server left out of a record.
+
+		Args:
+			record (grpc): PTP monitor record, full once decoded
+
+		Returns:
+			False if the record refers to Grandmaster fields that were never received
+		"""
+		if not record.gm_info_omitted:
+			self.gm_info = {field: getattr(record, field) for field in GM_INFO_FIELDS}
+			self.seq = record.gm_info_seq
+			return True
+
+		if self.gm_info is None or record.gm_info_seq != self.seq:
+			return False
+
+		for field, value in self.gm_info.items():
+			setattr(record, field, value)
+		record.gm_info_omitted = False
+		return True
+
 def print_time_record(record):
 	filler_lines = 0
 
@@ -148,9 +193,13 @@ def main(server_address):
 
 	try:
 		stub = gen_grpc.FireflyMonitorStub(channel)
-		monitor_events_stream = stub.Subscribe(gen_pbuf.SubscribeReq())
+		decoder = MonitorDeltaDecoder()
+		monitor_events_stream = stub.Subscribe(gen_pbuf.SubscribeReq(delta=True))
 		# get push notification and print them
 		for monitor_record in monitor_events_stream:
+			if not decoder.decode(monitor_record):
+				logger.error('Received a monitor record with unknown Grandmaster information')
+				break
 			print_monitor_record(monitor_record)
 	except RuntimeError as e:
 		logger.error('Failed to connect to the gRPC server on the DPU')
@@ -20,7 +20,7 @@ DESCRIPTOR = _descriptor.FileDescriptor(
   syntax='proto3',
   serialized_options=None,
   create_key=_descriptor._internal_create_key,
-  serialized_pb=b'\n\x15\x66irefly_monitor.proto\"\x0e\n\x0cSubscribeReq\":\n\rSamplingValue\x12\x0b\n\x03max\x18\x01 \x01(\x03\x12\x0f\n\x07\x61verage\x18\x02 \x01(\x03\x12\x0b\n\x03rms\x18\x03 \x01(\x03\"*\n\x0eTimestampValue\x12\x0b\n\x03raw\x18\x01 \x01(\x04\x12\x0b\n\x03str\x18\x02 \x01(\t\"\xf3\x04\n\rMonitorRecord\x12\x12\n\ngm_present\x18\x01 \x01(\x08\x12!\n\rptp_stability\x18\x02 \x01(\x0e\x32\n.ePTPState\x12!\n\x08ptp_time\x18\x03 \x01(\x0b\x32\x0f.TimestampValue\x12!\n\x08sys_time\x18\x04 \x01(\x0b\x32\x0f.TimestampValue\x12\x13\n\x0b\x65rror_count\x18\x05 \x01(\r\x12(\n\x0flast_error_time\x18\x06 \x01(\x0b\x32\x0f.TimestampValue\x12\x13\n\x0bgm_identity\x18\x07 \x01(\t\x12\x15\n\rport_identity\x18\x08 \x01(\t\x12%\n\rmaster_offset\x18\t \x01(\x0b\x32\x0e.SamplingValue\x12\x1a\n\x12\x63urrent_utc_offset\x18\n \x01(\x03\x12\x16\n\x0etime_traceable\x18\x0b \x01(\x08\x12\x1b\n\x13\x66requency_traceable\x18\x0c \x01(\x08\x12\x14\n\x0cgm_priority1\x18\r \x01(\r\x12\x16\n\x0egm_clock_class\x18\x0e \x01(\r\x12\x19\n\x11gm_clock_accuracy\x18\x0f \x01(\r\x12\x14\n\x0cgm_priority2\x18\x10 \x01(\r\x12%\n\x1dgm_offset_scaled_log_variance\x18\x11 \x01(\r\x12\x15\n\rdomain_number\x18\x12 \x01(\r\x12\"\n\nport_state\x18\x13 \x01(\x0e\x32\x0e.ePTPPortState\x12*\n\x11\x61\x64justed_ptp_time\x18\x14 \x01(\x0b\x32\x0f.TimestampValue\x12\x15\n\rtai_timescale\x18\x15 \x01(\x08*0\n\x0c\x65NetworkPort\x12\x0b\n\x07k_Dummy\x10\x00\x12\x13\n\rk_DocaFirefly\x10\x80\xc8\x01*J\n\tePTPState\x12\x12\n\x0ek_STATE_STABLE\x10\x00\x12\x12\n\x0ek_STATE_FAULTY\x10\x01\x12\x15\n\x11k_STATE_RECOVERED\x10\x02*b\n\rePTPPortState\x12\x19\n\x15k_PORT_STATE_INACTIVE\x10\x00\x12\x1d\n\x19k_PORT_STATE_UNCALIBRATED\x10\x01\x12\x17\n\x13k_PORT_STATE_ACTIVE\x10\x02\x32>\n\x0e\x46ireflyMonitor\x12,\n\tSubscribe\x12\r.SubscribeReq\x1a\x0e.MonitorRecord0\x01\x62\x06proto3'
+  serialized_pb=b'\n\x15\x66irefly_monitor.proto\"\x1d\n\x0cSubscribeReq\x12\r\n\x05\x64\x65lta\x18\x01 \x01(\x08\":\n\rSamplingValue\x12\x0b\n\x03max\x18\x01 \x01(\x03\x12\x0f\n\x07\x61verage\x18\x02 \x01(\x03\x12\x0b\n\x03rms\x18\x03 \x01(\x03\"*\n\x0eTimestampValue\x12\x0b\n\x03raw\x18\x01 \x01(\x04\x12\x0b\n\x03str\x18\x02 \x01(\t\"\xa1\x05\n\rMonitorRecord\x12\x12\n\ngm_present\x18\x01 \x01(\x08\x12!\n\rptp_stability\x18\x02 \x01(\x0e\x32\n.ePTPState\x12!\n\x08ptp_time\x18\x03 \x01(\x0b\x32\x0f.TimestampValue\x12!\n\x08sys_time\x18\x04 \x01(\x0b\x32\x0f.TimestampValue\x12\x13\n\x0b\x65rror_count\x18\x05 \x01(\r\x12(\n\x0flast_error_time\x18\x06 \x01(\x0b\x32\x0f.TimestampValue\x12\x13\n\x0bgm_identity\x18\x07 \x01(\t\x12\x15\n\rport_identity\x18\x08 \x01(\t\x12%\n\rmaster_offset\x18\t \x01(\x0b\x32\x0e.SamplingValue\x12\x1a\n\x12\x63urrent_utc_offset\x18\n \x01(\x03\x12\x16\n\x0etime_traceable\x18\x0b \x01(\x08\x12\x1b\n\x13\x66requency_traceable\x18\x0c \x01(\x08\x12\x14\n\x0cgm_priority1\x18\r \x01(\r\x12\x16\n\x0egm_clock_class\x18\x0e \x01(\r\x12\x19\n\x11gm_clock_accuracy\x18\x0f \x01(\r\x12\x14\n\x0cgm_priority2\x18\x10 \x01(\r\x12%\n\x1dgm_offset_scaled_log_variance\x18\x11 \x01(\r\x12\x15\n\rdomain_number\x18\x12 \x01(\r\x12\"\n\nport_state\x18\x13 \x01(\x0e\x32\x0e.ePTPPortState\x12*\n\x11\x61\x64justed_ptp_time\x18\x14 \x01(\x0b\x32\x0f.TimestampValue\x12\x15\n\rtai_timescale\x18\x15 \x01(\x08\x12\x13\n\x0bgm_info_seq\x18\x16 \x01(\r\x12\x17\n\x0fgm_info_omitted\x18\x17 \x01(\x08*0\n\x0c\x65NetworkPort\x12\x0b\n\x07k_Dummy\x10\x00\x12\x13\n\rk_DocaFirefly\x10\x80\xc8\x01*J\n\tePTPState\x12\x12\n\x0ek_STATE_STABLE\x10\x00\x12\x12\n\x0ek_STATE_FAULTY\x10\x01\x12\x15\n\x11k_STATE_RECOVERED\x10\x02*b\n\rePTPPortState\x12\x19\n\x15k_PORT_STATE_INACTIVE\x10\x00\x12\x1d\n\x19k_PORT_STATE_UNCALIBRATED\x10\x01\x12\x17\n\x13k_PORT_STATE_ACTIVE\x10\x02\x32>\n\x0e\x46ireflyMonitor\x12,\n\tSubscribe\x12\r.SubscribeReq\x1a\x0e.MonitorRecord0\x01\x62\x06proto3'
 )
 
 _ENETWORKPORT = _descriptor.EnumDescriptor(
@@ -43,8 +43,8 @@ _ENETWORKPORT = _descriptor.EnumDescriptor(
   ],
   containing_type=None,
   serialized_options=None,
-  serialized_start=775,
-  serialized_end=823,
+  serialized_start=836,
+  serialized_end=884,
 )
 _sym_db.RegisterEnumDescriptor(_ENETWORKPORT)
 
@@ -74,8 +74,8 @@ _EPTPSTATE = _descriptor.EnumDescriptor(
   ],
   containing_type=None,
   serialized_options=None,
-  serialized_start=825,
-  serialized_end=899,
+  serialized_start=886,
+  serialized_end=960,
 )
 _sym_db.RegisterEnumDescriptor(_EPTPSTATE)
 
@@ -105,8 +105,8 @@ _EPTPPORTSTATE = _descriptor.EnumDescriptor(
   ],
   containing_type=None,
   serialized_options=None,
-  serialized_start=901,
-  serialized_end=999,
+  serialized_start=962,
+  serialized_end=1060,
 )
 _sym_db.RegisterEnumDescriptor(_EPTPPORTSTATE)
 
@@ -130,6 +130,13 @@ _SUBSCRIBEREQ = _descriptor.Descriptor(
   containing_type=None,
   create_key=_descriptor._internal_create_key,
   fields=[
+    _descriptor.FieldDescriptor(
+      name='delta', full_name='SubscribeReq.delta', index=0,
+      number=1, type=8, cpp_type=7, label=1,
+      has_default_value=False, default_value=False,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
   ],
   extensions=[
   ],
@@ -143,7 +150,7 @@ _SUBSCRIBEREQ = _descriptor.Descriptor(
   oneofs=[
   ],
   serialized_start=25,
-  serialized_end=39,
+  serialized_end=54,
 )
 
 
@@ -188,8 +195,8 @@ _SAMPLINGVALUE = _descriptor.Descriptor(
   extension_ranges=[],
   oneofs=[
   ],
-  serialized_start=41,
-  serialized_end=99,
+  serialized_start=56,
+  serialized_end=114,
 )
 
 
@@ -227,8 +234,8 @@ _TIMESTAMPVALUE = _descriptor.Descriptor(
   extension_ranges=[],
   oneofs=[
   ],
-  serialized_start=101,
-  serialized_end=143,
+  serialized_start=116,
+  serialized_end=158,
 )
 
 
@@ -387,6 +394,20 @@ _MONITORRECORD = _descriptor.Descriptor(
       message_type=None, enum_type=None, containing_type=None,
       is_extension=False, extension_scope=None,
       serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
+    _descriptor.FieldDescriptor(
+      name='gm_info_seq', full_name='MonitorRecord.gm_info_seq', index=21,
+      number=22, type=13, cpp_type=3, label=1,
+      has_default_value=False, default_value=0,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
+    _descriptor.FieldDescriptor(
+      name='gm_info_omitted', full_name='MonitorRecord.gm_info_omitted', index=22,
+      number=23, type=8, cpp_type=7, label=1,
+      has_default_value=False, default_value=False,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      serialized_options=None, file=DESCRIPTOR,  create_key=_descriptor._internal_create_key),
   ],
   extensions=[
   ],
@@ -399,8 +420,8 @@ _MONITORRECORD = _descriptor.Descriptor(
   extension_ranges=[],
   oneofs=[
   ],
-  serialized_start=146,
-  serialized_end=773,
+  serialized_start=161,
+  serialized_end=834,
 )
 
 _MONITORRECORD.fields_by_name['ptp_stability'].enum_type = _EPTPSTATE
@@ -456,8 +477,8 @@ _FIREFLYMONITOR = _descriptor.ServiceDescriptor(
   index=0,
   serialized_options=None,
   create_key=_descriptor._internal_create_key,
-  serialized_start=1001,
-  serialized_end=1063,
+  serialized_start=1062,
+  serialized_end=1124,
   methods=[
   _descriptor.MethodDescriptor(
     name='Subscribe',
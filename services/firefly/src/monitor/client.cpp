@@ -16,6 +16,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <string>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -26,6 +27,7 @@
 
 #include "client.hpp"
 #include "firefly_monitor_core.hpp"
+#include "firefly_monitor_delta.hpp"
 
 DOCA_LOG_REGISTER(FIREFLY_MONITOR::GRPC);
 
@@ -82,6 +84,39 @@ deserialize_record(MonitorRecord &data, struct ptp_info *record)
 	}
 }
 
+void
+record_to_sample(const MonitorRecord &data, uint64_t recv_time, struct monitor_sample *sample)
+{
+	memset(sample, 0, sizeof(*sample));
+	sample->recv_time = recv_time;
+	sample->ptp_time = data.ptp_time().raw();
+	sample->sys_time = data.sys_time().raw();
+	sample->error_count = data.error_count();
+	sample->ptp_stability = (uint8_t)data.ptp_stability();
+	if (data.tai_timescale())
+		sample->flags |= MONITOR_SAMPLE_FLAG_TAI_TIMESCALE;
+	/* The rest of the fields are only sent when needed */
+	if (data.gm_present()) {
+		sample->flags |= MONITOR_SAMPLE_FLAG_GM_PRESENT;
+		if (data.time_traceable())
+			sample->flags |= MONITOR_SAMPLE_FLAG_TIME_TRACEABLE;
+		if (data.frequency_traceable())
+			sample->flags |= MONITOR_SAMPLE_FLAG_FREQUENCY_TRACEABLE;
+		sample->gm_id = monitor_parse_clock_identity(data.gm_identity().c_str());
+		sample->offset_average = data.master_offset().average();
+		sample->offset_max = data.master_offset().max();
+		sample->offset_rms = data.master_offset().rms();
+		sample->utc_offset = (int16_t)data.current_utc_offset();
+		sample->port_state = (uint8_t)data.port_state();
+		sample->domain_number = (uint8_t)data.domain_number();
+		sample->gm_clock_class = (uint8_t)data.gm_clock_class();
+		sample->gm_clock_accuracy = (uint8_t)data.gm_clock_accuracy();
+		sample->gm_priority1 = (uint8_t)data.gm_priority1();
+		sample->gm_priority2 = (uint8_t)data.gm_priority2();
+		sample->gm_scaled_offset = (uint16_t)data.gm_offset_scaled_log_variance();
+	}
+}
+
 /*
  * Callback function to handle TERM and INT signals
  *
@@ -97,9 +132,14 @@ signal_handler(int signum)
 }
 
 doca_error_t
-run_client(const char *arg)
+run_client(const char *arg, struct firefly_monitor_config *cfg)
 {
-	doca_error_t result;
+	struct monitor_recorder recorder;
+	struct monitor_histogram histogram, total_histogram;
+	struct monitor_sample sample;
+	bool recording = cfg->record_path[0] != '\0';
+	bool need_sample = recording || cfg->histogram_interval > 0;
+	doca_error_t result = DOCA_SUCCESS, tmp_result;
 
 	/* Check if we got a port or if we are using the default one */
 	std::string server_address(arg);
@@ -114,9 +154,24 @@ run_client(const char *arg)
 		return DOCA_ERROR_NO_MEMORY;
 	}
 
+	if (recording) {
+		result = monitor_recorder_create(cfg->record_path, cfg->record_format,
+						 (size_t)cfg->record_buffer_kb * 1024,
+						 (uint64_t)cfg->flush_interval * NS_PER_SEC, &recorder);
+		if (result != DOCA_SUCCESS) {
+			delete client;
+			return result;
+		}
+		DOCA_LOG_INFO("Recording the monitor records to %s", cfg->record_path);
+	}
+	monitor_histogram_init(&histogram, (uint64_t)cfg->histogram_interval * NS_PER_SEC);
+	monitor_histogram_init(&total_histogram, 0);
+
 	/* Subscribe to monitor events */
 	grpc::ClientContext context;
 	SubscribeReq request;
+	MonitorDeltaDecoder decoder;
+	request.set_delta(true);
 	client->stream = client->stub_->Subscribe(&context, request);
 
 	force_quit = false;
@@ -128,19 +183,52 @@ run_client(const char *arg)
 		MonitorRecord grpc_record;
 		if (!client->stream->Read(&grpc_record)) {
 			DOCA_LOG_ERR("Failed to receive a monitor record from the server");
-			delete client;
-			return DOCA_ERROR_IO_FAILED;
+			result = DOCA_ERROR_IO_FAILED;
+			break;
 		}
-
-		struct ptp_info record;
-		deserialize_record(grpc_record, &record);
-		result = report_monitoring_result_to_stdout(&record);
+		result = decoder.decode(grpc_record);
 		if (result != DOCA_SUCCESS) {
-			delete client;
-			return result;
+			DOCA_LOG_ERR("Received a monitor record with unknown Grandmaster information");
+			break;
+		}
+
+		if (need_sample) {
+			record_to_sample(grpc_record, monitor_get_time_ns(), &sample);
+			if (recording) {
+				result = monitor_recorder_append(&recorder, &sample);
+				if (result != DOCA_SUCCESS)
+					break;
+			}
+			/* The histogram windows are only printed when the screen is not rendered */
+			monitor_histogram_add(&histogram, &sample, cfg->quiet ? stdout : NULL);
+			monitor_histogram_add(&total_histogram, &sample, NULL);
+			if (cfg->quiet)
+				fflush(stdout);
+		}
+
+		if (!cfg->quiet) {
+			struct ptp_info record;
+			deserialize_record(grpc_record, &record);
+			result = report_monitoring_result_to_stdout(&record);
+			if (result != DOCA_SUCCESS)
+				break;
+		}
+	}
+
+	if (total_histogram.nb_samples > 0) {
+		printf("master_offset histogram of the whole run:\n");
+		monitor_histogram_report(&total_histogram, stdout);
+	}
+	if (recording) {
+		tmp_result = monitor_recorder_destroy(&recorder);
+		if (tmp_result != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Failed to finish the recording: %s", doca_error_get_descr(tmp_result));
+			DOCA_ERROR_PROPAGATE(result, tmp_result);
+		} else {
+			DOCA_LOG_INFO("Recorded %lu monitor records", recorder.nb_samples);
 		}
 	}
 
 	delete client;
-	return DOCA_SUCCESS;
+	return result;
 }
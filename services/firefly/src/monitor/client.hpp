@@ -14,21 +14,48 @@
 #ifndef CLIENT_H_
 #define CLIENT_H_
 
+#include <limits.h>
+
 #include <grpcpp/grpcpp.h>
 
 #include <doca_error.h>
 
 #include "firefly_monitor.grpc.pb.h"
+#include "firefly_monitor_recorder.hpp"
+
+#define DEFAULT_RECORD_BUFFER_KB 64	/* Default size of the record buffer (KB) */
+#define DEFAULT_FLUSH_INTERVAL 5	/* Default maximal time a record stays in the buffer (seconds) */
+
+/* Client configuration, filled by the command line parameters */
+struct firefly_monitor_config {
+	char record_path[PATH_MAX];		  /* Recording file, empty if the records are not recorded */
+	enum monitor_record_format record_format; /* Format of the recording */
+	uint32_t record_buffer_kb;		  /* Size of the record buffer (KB) */
+	uint32_t flush_interval;		  /* Maximal time a record stays in the buffer (seconds) */
+	uint32_t histogram_interval;		  /* Window of the master offset histogram (seconds), 0 to disable */
+	bool quiet;				  /* Do not render the records, only record and report histograms */
+};
 
 /*
  * Starts the client.
  *
  * @arg [in]: String representing the server IP, i.e. "127.0.0.1" or "192.168.100.3:5050"
  *            If no port is provided, it will use the server's default port
+ * @cfg [in]: Client configuration
  * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
  */
 doca_error_t
-run_client(const char *arg);
+run_client(const char *arg, struct firefly_monitor_config *cfg);
+
+/*
+ * Convert a given record from the gRPC structure for it to its compact recorded form, without copying its strings
+ *
+ * @data [in]: gRPC input to be converted
+ * @recv_time [in]: Local time at which the record was received (nanoseconds)
+ * @sample [out]: sample to be populated
+ */
+void
+record_to_sample(const MonitorRecord &data, uint64_t recv_time, struct monitor_sample *sample);
 
 class FireflyMonitorClient {
 public:
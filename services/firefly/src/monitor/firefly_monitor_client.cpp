@@ -24,6 +24,164 @@
 
 DOCA_LOG_REGISTER(FIREFLY_MONITOR::MAIN);
 
+/*
+ * ARGP Callback - Handle recording file parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+record_path_callback(void *param, void *config)
+{
+	struct firefly_monitor_config *cfg = (struct firefly_monitor_config *)config;
+	const char *path = (char *)param;
+
+	if (strnlen(path, sizeof(cfg->record_path)) == sizeof(cfg->record_path)) {
+		DOCA_LOG_ERR("Recording file path is too long, max %zu characters", sizeof(cfg->record_path) - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	strlcpy(cfg->record_path, path, sizeof(cfg->record_path));
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle recording format parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+record_format_callback(void *param, void *config)
+{
+	struct firefly_monitor_config *cfg = (struct firefly_monitor_config *)config;
+
+	if (monitor_parse_record_format((char *)param, &cfg->record_format) != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Recording format must be \"binary\" or \"csv\"");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle record buffer size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+record_buffer_callback(void *param, void *config)
+{
+	struct firefly_monitor_config *cfg = (struct firefly_monitor_config *)config;
+	int size_kb = *(int *)param;
+
+	if (size_kb < 1) {
+		DOCA_LOG_ERR("Record buffer size must be at least 1 KB");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->record_buffer_kb = size_kb;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle flush interval parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+flush_interval_callback(void *param, void *config)
+{
+	struct firefly_monitor_config *cfg = (struct firefly_monitor_config *)config;
+	int interval = *(int *)param;
+
+	if (interval < 0) {
+		DOCA_LOG_ERR("Flush interval can not be negative");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->flush_interval = interval;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle histogram interval parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+histogram_interval_callback(void *param, void *config)
+{
+	struct firefly_monitor_config *cfg = (struct firefly_monitor_config *)config;
+	int interval = *(int *)param;
+
+	if (interval < 0) {
+		DOCA_LOG_ERR("Histogram interval can not be negative");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->histogram_interval = interval;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle quiet parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+quiet_callback(void *param, void *config)
+{
+	struct firefly_monitor_config *cfg = (struct firefly_monitor_config *)config;
+
+	cfg->quiet = *(bool *)param;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Create and register a single command line parameter
+ *
+ * @short_name [in]: Short name of the parameter, NULL for none
+ * @long_name [in]: Long name of the parameter
+ * @arguments [in]: Description of the parameter arguments, NULL for none
+ * @description [in]: Description of the parameter
+ * @callback [in]: Callback that handles the parameter
+ * @type [in]: Type of the parameter
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+register_param(const char *short_name, const char *long_name, const char *arguments, const char *description,
+	       doca_argp_param_cb_t callback, enum doca_argp_type type)
+{
+	struct doca_argp_param *param;
+	doca_error_t result;
+
+	result = doca_argp_param_create(&param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	if (short_name != NULL)
+		doca_argp_param_set_short_name(param, short_name);
+	doca_argp_param_set_long_name(param, long_name);
+	if (arguments != NULL)
+		doca_argp_param_set_arguments(param, arguments);
+	doca_argp_param_set_description(param, description);
+	doca_argp_param_set_callback(param, callback);
+	doca_argp_param_set_type(param, type);
+	result = doca_argp_register_param(param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	return DOCA_SUCCESS;
+}
+
 /*
  * Register the command line parameters for the service tool.
  *
@@ -34,6 +192,33 @@ register_firefly_monitor_params(void)
 {
 	doca_error_t result = DOCA_SUCCESS;
 
+	result = register_param("r", "record", "<path>", "Record the monitor records to a file", record_path_callback,
+				DOCA_ARGP_TYPE_STRING);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param(NULL, "record-format", "<binary|csv>", "Format of the recording (default binary)",
+				record_format_callback, DOCA_ARGP_TYPE_STRING);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param(NULL, "record-buffer", "<KB>", "Records buffered before a write (default 64 KB)",
+				record_buffer_callback, DOCA_ARGP_TYPE_INT);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param(NULL, "flush-interval", "<seconds>",
+				"Maximal time a record is buffered before it is written (default 5)",
+				flush_interval_callback, DOCA_ARGP_TYPE_INT);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param(NULL, "histogram-interval", "<seconds>",
+				"Window of the printed master_offset histograms, 0 to disable (default 60)",
+				histogram_interval_callback, DOCA_ARGP_TYPE_INT);
+	if (result != DOCA_SUCCESS)
+		return result;
+	result = register_param("q", "quiet", NULL, "Do not render the records, only record them and print histograms",
+				quiet_callback, DOCA_ARGP_TYPE_BOOLEAN);
+	if (result != DOCA_SUCCESS)
+		return result;
+
 	result = doca_argp_register_version_callback(firefly_monitor_version_callback);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to register version callback: %s", doca_error_get_descr(result));
@@ -54,6 +239,12 @@ main(int argc, char *argv[])
 {
 	doca_error_t result;
 	const char *grpc_address;
+	struct firefly_monitor_config cfg = {};
+
+	cfg.record_format = MONITOR_RECORD_FORMAT_BINARY;
+	cfg.record_buffer_kb = DEFAULT_RECORD_BUFFER_KB;
+	cfg.flush_interval = DEFAULT_FLUSH_INTERVAL;
+	cfg.histogram_interval = DEFAULT_HISTOGRAM_INTERVAL;
 
 	/* Register a logger backend */
 	result = doca_log_backend_create_standard();
@@ -62,7 +253,7 @@ main(int argc, char *argv[])
 	}
 
 	/* Parse cmdline/json arguments */
-	result = doca_argp_init("doca_firefly_monitor_client", NULL);
+	result = doca_argp_init("doca_firefly_monitor_client", &cfg);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Failed to init ARGP resources: %s", doca_error_get_descr(result));
 		return EXIT_FAILURE;
@@ -99,7 +290,7 @@ main(int argc, char *argv[])
 	}
 
 	/* Start the client */
-	result = run_client(grpc_address);
+	result = run_client(grpc_address, &cfg);
 	if (result != DOCA_SUCCESS) {
 		DOCA_LOG_ERR("Firefly Monitor encountered an error: %s", doca_error_get_descr(result));
 		doca_argp_destroy();
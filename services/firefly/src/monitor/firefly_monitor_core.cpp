@@ -13,6 +13,7 @@
 
 #include <bsd/string.h>
 #include <signal.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -20,6 +21,8 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include <doca_error.h>
 #include <doca_log.h>
 
@@ -66,30 +69,61 @@ firefly_monitor_version_callback(void *param, void *doca_config)
 	exit(EXIT_SUCCESS);
 }
 
+#define SCREEN_BUFFER_SIZE 4096 /* Size of the formatted screen, larger than any monitoring result */
+
+/* A formatted screen of a monitoring result */
+struct screen_buffer {
+	char data[SCREEN_BUFFER_SIZE]; /* Formatted text */
+	size_t used;		       /* Length of the formatted text */
+};
+
 /*
- * Report the timestamps to the standard output
+ * Append formatted text to a screen buffer, text that does not fit is truncated
+ *
+ * @screen [in]: Screen buffer
+ * @format [in]: printf() format string
+ */
+static void __attribute__((format(printf, 2, 3)))
+screen_printf(struct screen_buffer *screen, const char *format, ...)
+{
+	va_list args;
+	int len;
+
+	if (screen->used >= sizeof(screen->data) - 1)
+		return;
+
+	va_start(args, format);
+	len = vsnprintf(screen->data + screen->used, sizeof(screen->data) - screen->used, format, args);
+	va_end(args);
+	if (len > 0)
+		screen->used += std::min((size_t)len, sizeof(screen->data) - 1 - screen->used);
+}
+
+/*
+ * Report the timestamps to the screen buffer
  *
  * @ptp_state [in]: PTP State to be reported
+ * @screen [in]: Screen buffer to append to
  * @return: Number of fillter lines required later on
  */
 static uint32_t
-report_time_to_stdout(struct ptp_info *ptp_state)
+report_time_to_stdout(struct ptp_info *ptp_state, struct screen_buffer *screen)
 {
 	uint32_t filler_lines;
 
 	if (ptp_state->tai_timescale) {
 		/* ptp_time (TAI):		Thu Sep  1 12:58:19 2022 */
-		printf("ptp_time (TAI):            %s\n", ptp_state->ptp_time.string);
+		screen_printf(screen, "ptp_time (TAI):            %s\n", ptp_state->ptp_time.string);
 		/* ptp_time (UTC adjusted):	Thu Sep  1 12:58:19 2022 */
-		printf("ptp_time (UTC adjusted):   %s\n", ptp_state->adjusted_ptp_time.string);
+		screen_printf(screen, "ptp_time (UTC adjusted):   %s\n", ptp_state->adjusted_ptp_time.string);
 		filler_lines = 0;
 	} else {
 		/* ptp_time (UTC):		Thu Sep  1 12:58:19 2022 */
-		printf("ptp_time (UTC):            %s\n", ptp_state->ptp_time.string);
+		screen_printf(screen, "ptp_time (UTC):            %s\n", ptp_state->ptp_time.string);
 		filler_lines = 1;
 	}
 	/* system_time (UTC):		Thu Sep  1 12:58:19 2022 */
-	printf("system_time (UTC):         %s\n", ptp_state->sys_time.string);
+	screen_printf(screen, "system_time (UTC):         %s\n", ptp_state->sys_time.string);
 
 	return filler_lines;
 }
@@ -97,63 +131,72 @@ report_time_to_stdout(struct ptp_info *ptp_state)
 doca_error_t
 report_monitoring_result_to_stdout(struct ptp_info *ptp_state)
 {
+	static struct screen_buffer screen_storage;
+	struct screen_buffer *screen = &screen_storage;
 	int i = 0;
 	uint32_t filler_lines = 0;
 
-	printf("\n\n");
+	/* The whole screen is formatted in memory and written at once, instead of a write per line */
+	screen->used = 0;
+	screen_printf(screen, "\n\n");
 	if (ptp_state->gm_present) {
 		/* gmIdentity:			EC:46:70:FF:FE:10:FE:B9 (ec4670.fffe.10feb9) */
-		printf("gmIdentity:                %s\n", ptp_state->gm_identity);
+		screen_printf(screen, "gmIdentity:                %s\n", ptp_state->gm_identity);
 		/* portIdentity:		EC:46:70:FF:FE:10:FE:B9 (ec4670.fffe.10feb9-1) */
-		printf("portIdentity:              %s\n", ptp_state->port_identity);
+		screen_printf(screen, "portIdentity:              %s\n", ptp_state->port_identity);
 		/* port_state:			Active */
-		printf("port_state:                %s\n", get_port_state_string(ptp_state->port_state));
+		screen_printf(screen, "port_state:                %s\n", get_port_state_string(ptp_state->port_state));
 		/* domainNumber:		127 */
-		printf("domainNumber:              %u\n", ptp_state->domain_number);
+		screen_printf(screen, "domainNumber:              %u\n", ptp_state->domain_number);
 		/* master_offset:		avg:	23 max:	40 rms:	4 */
-		printf("master_offset:             avg:\t%ld\tmax:\t%ld\trms:\t%lu\n", ptp_state->master_offset.average,
-		       ptp_state->master_offset.max, ptp_state->master_offset.rms);
+		screen_printf(screen, "master_offset:             avg:\t%ld\tmax:\t%ld\trms:\t%lu\n",
+			      ptp_state->master_offset.average, ptp_state->master_offset.max, ptp_state->master_offset.rms);
 		/* gmPresent:			true */
-		printf("gmPresent:                 true\n");
+		screen_printf(screen, "gmPresent:                 true\n");
 		/* ptp_stable:			Yes/No/Recovered */
-		printf("ptp_stable:                %s\n", get_stability_string(ptp_state->ptp_stability));
+		screen_printf(screen, "ptp_stable:                %s\n", get_stability_string(ptp_state->ptp_stability));
 		/* currentUtcOffset:		37 */
-		printf("UtcOffset:                 %ld\n", ptp_state->utc_offset);
+		screen_printf(screen, "UtcOffset:                 %ld\n", ptp_state->utc_offset);
 		/* timeTraceable:		1 */
-		printf("timeTraceable:             %s\n", (ptp_state->time_traceable ? "1" : "0"));
+		screen_printf(screen, "timeTraceable:             %s\n", (ptp_state->time_traceable ? "1" : "0"));
 		/* frequencyTraceable:		1 */
-		printf("frequencyTraceable:        %s\n", (ptp_state->frequency_traceable ? "1" : "0"));
+		screen_printf(screen, "frequencyTraceable:        %s\n", (ptp_state->frequency_traceable ? "1" : "0"));
 		/* grandmasterPriority1:	128 */
-		printf("grandmasterPriority1:      %u\n", ptp_state->gm_priority1);
+		screen_printf(screen, "grandmasterPriority1:      %u\n", ptp_state->gm_priority1);
 		/* gmClockClass:		6 */
-		printf("gmClockClass:              %u\n", ptp_state->gm_clock_class);
+		screen_printf(screen, "gmClockClass:              %u\n", ptp_state->gm_clock_class);
 		/* gmClockAccuracy:		0x21 */
-		printf("gmClockAccuracy:           0x%x\n", ptp_state->gm_clock_accuracy);
+		screen_printf(screen, "gmClockAccuracy:           0x%x\n", ptp_state->gm_clock_accuracy);
 		/* grandmasterPriority2:	128 */
-		printf("grandmasterPriority2:      %u\n", ptp_state->gm_priority2);
+		screen_printf(screen, "grandmasterPriority2:      %u\n", ptp_state->gm_priority2);
 		/* gmOffsetScaledLogVariance:	0x34fb */
-		printf("gmOffsetScaledLogVariance: 0x%x\n", ptp_state->gm_scaled_offset);
-		filler_lines += report_time_to_stdout(ptp_state);
+		screen_printf(screen, "gmOffsetScaledLogVariance: 0x%x\n", ptp_state->gm_scaled_offset);
+		filler_lines += report_time_to_stdout(ptp_state, screen);
 	} else {
 		/* gmPresent:			false */
-		printf("gmPresent:                 false\n");
+		screen_printf(screen, "gmPresent:                 false\n");
 		/* ptp_stable:			Yes/No/Recovered */
-		printf("ptp_stable:                %s\n", get_stability_string(ptp_state->ptp_stability));
-		filler_lines += report_time_to_stdout(ptp_state);
+		screen_printf(screen, "ptp_stable:                %s\n", get_stability_string(ptp_state->ptp_stability));
+		filler_lines += report_time_to_stdout(ptp_state, screen);
 		/* 15 lines for gmPresent, and 2 that we have here locally */
 		filler_lines += 15 - 2;
 	}
 
 	if (ptp_state->error_count > 0) {
-		printf("error_count:               %u\n", ptp_state->error_count);
-		printf("last_err_time (UTC):       %s\n", ptp_state->last_error_time.string);
+		screen_printf(screen, "error_count:               %u\n", ptp_state->error_count);
+		screen_printf(screen, "last_err_time (UTC):       %s\n", ptp_state->last_error_time.string);
 	} else {
-		printf("\n\n");
+		screen_printf(screen, "\n\n");
 	}
 
 	/* Maintain the same output length for easy screen formatting */
 	for (i = 0; i < filler_lines; i++) {
-		printf("\n");
+		screen_printf(screen, "\n");
+	}
+
+	if (fwrite(screen->data, 1, screen->used, stdout) != screen->used) {
+		DOCA_LOG_ERR("Failed to write the monitoring result to the standard output");
+		return DOCA_ERROR_IO_FAILED;
 	}
 
 	/* Flush the output to avoid caching */
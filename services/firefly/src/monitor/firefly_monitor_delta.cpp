@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include "firefly_monitor_delta.hpp"
+
+/*
+ * Copy the Grandmaster fields between records
+ *
+ * @src [in]: Record to copy the fields from
+ * @dst [out]: Record to copy the fields to
+ */
+static void
+copy_gm_info(const MonitorRecord &src, MonitorRecord &dst)
+{
+	dst.set_gm_identity(src.gm_identity());
+	dst.set_port_identity(src.port_identity());
+	dst.set_current_utc_offset(src.current_utc_offset());
+	dst.set_time_traceable(src.time_traceable());
+	dst.set_frequency_traceable(src.frequency_traceable());
+	dst.set_gm_priority1(src.gm_priority1());
+	dst.set_gm_clock_class(src.gm_clock_class());
+	dst.set_gm_clock_accuracy(src.gm_clock_accuracy());
+	dst.set_gm_priority2(src.gm_priority2());
+	dst.set_gm_offset_scaled_log_variance(src.gm_offset_scaled_log_variance());
+	dst.set_domain_number(src.domain_number());
+	dst.set_port_state(src.port_state());
+}
+
+/*
+ * Compare the Grandmaster fields of two records
+ *
+ * @a [in]: First record
+ * @b [in]: Second record
+ * @return: true if all the Grandmaster fields are equal
+ */
+static bool
+gm_info_equal(const MonitorRecord &a, const MonitorRecord &b)
+{
+	return a.gm_identity() == b.gm_identity() && a.port_identity() == b.port_identity() &&
+	       a.current_utc_offset() == b.current_utc_offset() && a.time_traceable() == b.time_traceable() &&
+	       a.frequency_traceable() == b.frequency_traceable() && a.gm_priority1() == b.gm_priority1() &&
+	       a.gm_clock_class() == b.gm_clock_class() && a.gm_clock_accuracy() == b.gm_clock_accuracy() &&
+	       a.gm_priority2() == b.gm_priority2() &&
+	       a.gm_offset_scaled_log_variance() == b.gm_offset_scaled_log_variance() &&
+	       a.domain_number() == b.domain_number() && a.port_state() == b.port_state();
+}
+
+/*
+ * Clear the Grandmaster fields of a record, so they are not serialized
+ *
+ * @record [in/out]: Record
+ */
+static void
+clear_gm_info(MonitorRecord &record)
+{
+	record.clear_gm_identity();
+	record.clear_port_identity();
+	record.clear_current_utc_offset();
+	record.clear_time_traceable();
+	record.clear_frequency_traceable();
+	record.clear_gm_priority1();
+	record.clear_gm_clock_class();
+	record.clear_gm_clock_accuracy();
+	record.clear_gm_priority2();
+	record.clear_gm_offset_scaled_log_variance();
+	record.clear_domain_number();
+	record.clear_port_state();
+}
+
+void
+MonitorDeltaEncoder::encode(MonitorRecord &record)
+{
+	if (first_ || !gm_info_equal(record, gm_info_)) {
+		copy_gm_info(record, gm_info_);
+		seq_++;
+		first_ = false;
+		record.set_gm_info_seq(seq_);
+		record.set_gm_info_omitted(false);
+		return;
+	}
+
+	clear_gm_info(record);
+	record.set_gm_info_seq(seq_);
+	record.set_gm_info_omitted(true);
+}
+
+doca_error_t
+MonitorDeltaDecoder::decode(MonitorRecord &record)
+{
+	if (!record.gm_info_omitted()) {
+		copy_gm_info(record, gm_info_);
+		seq_ = record.gm_info_seq();
+		valid_ = true;
+		return DOCA_SUCCESS;
+	}
+
+	/* The record refers to Grandmaster fields that this subscription never received */
+	if (!valid_ || record.gm_info_seq() != seq_)
+		return DOCA_ERROR_BAD_STATE;
+
+	copy_gm_info(gm_info_, record);
+	record.set_gm_info_omitted(false);
+	return DOCA_SUCCESS;
+}
+
+void
+MonitorDeltaDecoder::reset(void)
+{
+	gm_info_.Clear();
+	seq_ = 0;
+	valid_ = false;
+}
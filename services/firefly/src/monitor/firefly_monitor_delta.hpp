@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef FIREFLY_MONITOR_DELTA_H_
+#define FIREFLY_MONITOR_DELTA_H_
+
+#include <doca_error.h>
+
+#include "firefly_monitor.pb.h"
+
+/*
+ * Delta encoding of the Grandmaster fields of the monitor records (see gm_info_seq in firefly_monitor.proto).
+ * These fields change rarely, so a delta subscription only carries them in the records in which they changed.
+ */
+
+/*
+ * Server side of the delta encoding, one per delta subscription
+ */
+class MonitorDeltaEncoder {
+public:
+	/*
+	 * Delta encode a record in place: update gm_info_seq and leave out the Grandmaster fields if they did not
+	 * change since the previous record
+	 *
+	 * @record [in/out]: Full record, to be sent to the subscriber
+	 */
+	void encode(MonitorRecord &record);
+
+private:
+	MonitorRecord gm_info_; /* Grandmaster fields of the last sent record */
+	uint32_t seq_ = 0;	/* gm_info_seq of the last sent record */
+	bool first_ = true;	/* No record was sent yet */
+};
+
+/*
+ * Client side of the delta encoding, one per subscription
+ */
+class MonitorDeltaDecoder {
+public:
+	/*
+	 * Decode a record in place: restore the Grandmaster fields that were left out.
+	 * Records of servers that do not delta encode pass unchanged.
+	 *
+	 * @record [in/out]: Received record, full once decoded
+	 * @return: DOCA_SUCCESS on success and DOCA_ERROR_BAD_STATE if the Grandmaster fields of the record are unknown
+	 */
+	doca_error_t decode(MonitorRecord &record);
+
+	/*
+	 * Forget the Grandmaster fields, the next subscription starts with a full record
+	 */
+	void reset(void);
+
+private:
+	MonitorRecord gm_info_; /* Grandmaster fields of the last full record */
+	uint32_t seq_ = 0;	/* gm_info_seq of gm_info_ */
+	bool valid_ = false;	/* gm_info_ holds the fields of a received record */
+};
+
+#endif /* FIREFLY_MONITOR_DELTA_H_ */
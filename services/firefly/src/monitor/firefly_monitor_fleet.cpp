@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <bsd/string.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <doca_argp.h>
+#include <doca_log.h>
+
+#include "firefly_monitor_core.hpp"
+#include "fleet.hpp"
+
+DOCA_LOG_REGISTER(FIREFLY_MONITOR::FLEET_MAIN);
+
+/*
+ * ARGP Callback - Handle devices file parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+devices_path_callback(void *param, void *config)
+{
+	struct fleet_config *cfg = (struct fleet_config *)config;
+
+	if (strlcpy(cfg->devices_path, (char *)param, sizeof(cfg->devices_path)) >= sizeof(cfg->devices_path)) {
+		DOCA_LOG_ERR("Devices file path is too long, max %zu characters", sizeof(cfg->devices_path) - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle number of threads parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+threads_callback(void *param, void *config)
+{
+	struct fleet_config *cfg = (struct fleet_config *)config;
+	int threads = *(int *)param;
+
+	if (threads < 1) {
+		DOCA_LOG_ERR("Number of threads must be at least 1");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->nb_threads = threads;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle report interval parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+report_interval_callback(void *param, void *config)
+{
+	struct fleet_config *cfg = (struct fleet_config *)config;
+	int interval = *(int *)param;
+
+	if (interval < 1) {
+		DOCA_LOG_ERR("Report interval must be at least 1 second");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->report_interval = interval;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle offset threshold parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+offset_threshold_callback(void *param, void *config)
+{
+	struct fleet_config *cfg = (struct fleet_config *)config;
+	int threshold = *(int *)param;
+
+	if (threshold < 0) {
+		DOCA_LOG_ERR("Offset threshold can not be negative");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->offset_threshold = threshold;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle stale timeout parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+stale_timeout_callback(void *param, void *config)
+{
+	struct fleet_config *cfg = (struct fleet_config *)config;
+	int timeout = *(int *)param;
+
+	if (timeout < 1) {
+		DOCA_LOG_ERR("Stale timeout must be at least 1 second");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->stale_timeout = timeout;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle worst offsets list size parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+worst_count_callback(void *param, void *config)
+{
+	struct fleet_config *cfg = (struct fleet_config *)config;
+	int count = *(int *)param;
+
+	if (count < 0) {
+		DOCA_LOG_ERR("Worst offsets list size can not be negative");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->worst_count = count;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Register the command line parameters for the fleet aggregator.
+ *
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+register_firefly_fleet_params(void)
+{
+	struct doca_argp_param *devices_param, *threads_param, *report_param, *threshold_param, *stale_param;
+	struct doca_argp_param *worst_param;
+	doca_error_t result;
+
+	/* Create and register devices file param */
+	result = doca_argp_param_create(&devices_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(devices_param, "d");
+	doca_argp_param_set_long_name(devices_param, "devices");
+	doca_argp_param_set_arguments(devices_param, "<path>");
+	doca_argp_param_set_description(devices_param,
+					"File with a device per line: \"[name] address[:port]\", '#' starts a comment");
+	doca_argp_param_set_callback(devices_param, devices_path_callback);
+	doca_argp_param_set_type(devices_param, DOCA_ARGP_TYPE_STRING);
+	doca_argp_param_set_mandatory(devices_param);
+	result = doca_argp_register_param(devices_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register number of threads param */
+	result = doca_argp_param_create(&threads_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(threads_param, "t");
+	doca_argp_param_set_long_name(threads_param, "threads");
+	doca_argp_param_set_arguments(threads_param, "<num>");
+	doca_argp_param_set_description(threads_param, "Number of threads that handle the subscriptions (default 2)");
+	doca_argp_param_set_callback(threads_param, threads_callback);
+	doca_argp_param_set_type(threads_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(threads_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register report interval param */
+	result = doca_argp_param_create(&report_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(report_param, "report-interval");
+	doca_argp_param_set_arguments(report_param, "<seconds>");
+	doca_argp_param_set_description(report_param, "Time between two fleet reports (default 5)");
+	doca_argp_param_set_callback(report_param, report_interval_callback);
+	doca_argp_param_set_type(report_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(report_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register offset threshold param */
+	result = doca_argp_param_create(&threshold_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(threshold_param, "offset-threshold");
+	doca_argp_param_set_arguments(threshold_param, "<ns>");
+	doca_argp_param_set_description(threshold_param, "Largest master offset of a device in sync (default 1000)");
+	doca_argp_param_set_callback(threshold_param, offset_threshold_callback);
+	doca_argp_param_set_type(threshold_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(threshold_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register stale timeout param */
+	result = doca_argp_param_create(&stale_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(stale_param, "stale-timeout");
+	doca_argp_param_set_arguments(stale_param, "<seconds>");
+	doca_argp_param_set_description(stale_param,
+					"Time without records after which a device is out of sync (default 10)");
+	doca_argp_param_set_callback(stale_param, stale_timeout_callback);
+	doca_argp_param_set_type(stale_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(stale_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register worst offsets list size param */
+	result = doca_argp_param_create(&worst_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(worst_param, "worst");
+	doca_argp_param_set_arguments(worst_param, "<num>");
+	doca_argp_param_set_description(worst_param, "Number of devices in the worst offsets list (default 5)");
+	doca_argp_param_set_callback(worst_param, worst_count_callback);
+	doca_argp_param_set_type(worst_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(worst_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_register_version_callback(firefly_monitor_version_callback);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register version callback: %s", doca_error_get_descr(result));
+		return result;
+	}
+	return result;
+}
+
+/*
+ * Main function for DOCA Firefly's PTP Monitor fleet aggregator
+ *
+ * @argc [in]: command line arguments size
+ * @argv [in]: array of command line arguments
+ * @return: EXIT_SUCCESS on success and EXIT_FAILURE otherwise
+ */
+int
+main(int argc, char *argv[])
+{
+	struct fleet_config cfg = {};
+	doca_error_t result;
+
+	cfg.nb_threads = DEFAULT_FLEET_THREADS;
+	cfg.report_interval = DEFAULT_FLEET_REPORT_INTERVAL;
+	cfg.offset_threshold = DEFAULT_FLEET_OFFSET_THRESHOLD;
+	cfg.stale_timeout = DEFAULT_FLEET_STALE_TIMEOUT;
+	cfg.worst_count = DEFAULT_FLEET_WORST_COUNT;
+
+	/* Register a logger backend */
+	result = doca_log_backend_create_standard();
+	if (result != DOCA_SUCCESS) {
+		return EXIT_FAILURE;
+	}
+
+	/* Parse cmdline/json arguments */
+	result = doca_argp_init("doca_firefly_monitor_fleet", &cfg);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to init ARGP resources: %s", doca_error_get_descr(result));
+		return EXIT_FAILURE;
+	}
+
+	result = register_firefly_fleet_params();
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program parameters: %s", doca_error_get_descr(result));
+		doca_argp_destroy();
+		return EXIT_FAILURE;
+	}
+
+	result = doca_argp_start(argc, argv);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to parse program input: %s", doca_error_get_descr(result));
+		doca_argp_destroy();
+		return EXIT_FAILURE;
+	}
+
+	result = run_fleet(&cfg);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Fleet aggregator failed: %s", doca_error_get_descr(result));
+		doca_argp_destroy();
+		return EXIT_FAILURE;
+	}
+
+	doca_argp_destroy();
+	return EXIT_SUCCESS;
+}
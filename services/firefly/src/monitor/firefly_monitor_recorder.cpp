@@ -0,0 +1,544 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <bsd/string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <doca_log.h>
+
+#include "firefly_monitor_recorder.hpp"
+
+DOCA_LOG_REGISTER(FIREFLY_MONITOR::RECORDER);
+
+#define MONITOR_CSV_LINE_MAX 512 /* Longest CSV line of a sample, including the line break */
+
+/* Columns of a CSV recording, in the order of monitor_csv_format() */
+#define MONITOR_CSV_HEADER \
+	MONITOR_CSV_HEADER_PREFIX \
+	"ptp_time_ns,sys_time_s,gm_present,gm_id,ptp_stability,port_state,offset_avg_ns,offset_max_ns,offset_rms_ns," \
+	"error_count,utc_offset,domain_number,gm_clock_class,gm_clock_accuracy,gm_priority1,gm_priority2," \
+	"gm_scaled_offset,time_traceable,frequency_traceable,tai_timescale\n"
+
+static_assert(sizeof(struct monitor_sample) == 72, "monitor_sample is part of the format");
+static_assert(sizeof(struct monitor_recording_header) == 16, "monitor_recording_header is part of the format");
+
+uint64_t
+monitor_get_time_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (uint64_t)now.tv_sec * NS_PER_SEC + now.tv_nsec;
+}
+
+uint64_t
+monitor_parse_clock_identity(const char *identity)
+{
+	uint64_t id = 0;
+	int digit;
+
+	for (; *identity != '\0' && *identity != ' '; identity++) {
+		if (!isxdigit((unsigned char)*identity))
+			continue;
+		digit = isdigit((unsigned char)*identity) ? *identity - '0' : tolower((unsigned char)*identity) - 'a' + 10;
+		id = (id << 4) | digit;
+	}
+	return id;
+}
+
+doca_error_t
+monitor_parse_record_format(const char *name, enum monitor_record_format *format)
+{
+	if (strcmp(name, "binary") == 0)
+		*format = MONITOR_RECORD_FORMAT_BINARY;
+	else if (strcmp(name, "csv") == 0)
+		*format = MONITOR_RECORD_FORMAT_CSV;
+	else
+		return DOCA_ERROR_INVALID_VALUE;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Format a sample as a CSV line
+ *
+ * @sample [in]: Sample to format
+ * @line [out]: Formatted line, including the line break
+ * @size [in]: Size of the line buffer
+ * @return: Length of the line, as returned by snprintf()
+ */
+static int
+monitor_csv_format(const struct monitor_sample *sample, char *line, size_t size)
+{
+	return snprintf(line, size,
+			"%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%u,0x%016" PRIx64 ",%u,%u,%" PRId64 ",%" PRId64 ",%" PRIu64
+			",%u,%d,%u,%u,0x%x,%u,%u,0x%x,%u,%u,%u\n",
+			sample->recv_time, sample->ptp_time, sample->sys_time,
+			!!(sample->flags & MONITOR_SAMPLE_FLAG_GM_PRESENT), sample->gm_id, sample->ptp_stability,
+			sample->port_state, sample->offset_average, sample->offset_max, sample->offset_rms,
+			sample->error_count, sample->utc_offset, sample->domain_number, sample->gm_clock_class,
+			sample->gm_clock_accuracy, sample->gm_priority1, sample->gm_priority2, sample->gm_scaled_offset,
+			!!(sample->flags & MONITOR_SAMPLE_FLAG_TIME_TRACEABLE),
+			!!(sample->flags & MONITOR_SAMPLE_FLAG_FREQUENCY_TRACEABLE),
+			!!(sample->flags & MONITOR_SAMPLE_FLAG_TAI_TIMESCALE));
+}
+
+/*
+ * Parse a CSV line of a sample
+ *
+ * @line [in]: Line to parse
+ * @sample [out]: The parsed sample
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+monitor_csv_parse(const char *line, struct monitor_sample *sample)
+{
+	unsigned int gm_present, stability, port_state, domain, clock_class, accuracy, priority1, priority2,
+		scaled_offset, time_traceable, frequency_traceable, tai;
+	int utc_offset;
+
+	if (sscanf(line,
+		   "%" SCNu64 ",%" SCNu64 ",%" SCNu64 ",%u,%" SCNx64 ",%u,%u,%" SCNd64 ",%" SCNd64 ",%" SCNu64
+		   ",%u,%d,%u,%u,%x,%u,%u,%x,%u,%u,%u",
+		   &sample->recv_time, &sample->ptp_time, &sample->sys_time, &gm_present, &sample->gm_id, &stability,
+		   &port_state, &sample->offset_average, &sample->offset_max, &sample->offset_rms, &sample->error_count,
+		   &utc_offset, &domain, &clock_class, &accuracy, &priority1, &priority2, &scaled_offset,
+		   &time_traceable, &frequency_traceable, &tai) != 21)
+		return DOCA_ERROR_INVALID_VALUE;
+
+	sample->utc_offset = (int16_t)utc_offset;
+	sample->ptp_stability = (uint8_t)stability;
+	sample->port_state = (uint8_t)port_state;
+	sample->domain_number = (uint8_t)domain;
+	sample->gm_clock_class = (uint8_t)clock_class;
+	sample->gm_clock_accuracy = (uint8_t)accuracy;
+	sample->gm_priority1 = (uint8_t)priority1;
+	sample->gm_priority2 = (uint8_t)priority2;
+	sample->gm_scaled_offset = (uint16_t)scaled_offset;
+	sample->flags = (gm_present ? MONITOR_SAMPLE_FLAG_GM_PRESENT : 0) |
+			(time_traceable ? MONITOR_SAMPLE_FLAG_TIME_TRACEABLE : 0) |
+			(frequency_traceable ? MONITOR_SAMPLE_FLAG_FREQUENCY_TRACEABLE : 0) |
+			(tai ? MONITOR_SAMPLE_FLAG_TAI_TIMESCALE : 0);
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+monitor_sample_write_csv(const struct monitor_sample *sample, FILE *file)
+{
+	char line[MONITOR_CSV_LINE_MAX];
+
+	monitor_csv_format(sample, line, sizeof(line));
+	if (fputs(line, file) == EOF)
+		return DOCA_ERROR_IO_FAILED;
+	return DOCA_SUCCESS;
+}
+
+doca_error_t
+monitor_csv_write_header(FILE *file)
+{
+	if (fputs(MONITOR_CSV_HEADER, file) == EOF)
+		return DOCA_ERROR_IO_FAILED;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Write the buffered samples to the recording file, the recorder lock must be held
+ *
+ * @recorder [in]: Recorder
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+recorder_write(struct monitor_recorder *recorder)
+{
+	if (recorder->buffer_used > 0 &&
+	    fwrite(recorder->buffer, 1, recorder->buffer_used, recorder->file) != recorder->buffer_used) {
+		DOCA_LOG_ERR("Failed to write to the recording file: %s", strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+	recorder->buffer_used = 0;
+	recorder->last_flush = monitor_get_time_ns();
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Flusher thread of a recorder, writes the buffer once the flush interval passed since the last write, so records
+ * are not kept in memory while no new record is appended
+ *
+ * @arg [in]: Recorder
+ * @return: NULL
+ */
+static void *
+recorder_flusher(void *arg)
+{
+	struct monitor_recorder *recorder = (struct monitor_recorder *)arg;
+	struct timespec deadline;
+	uint64_t due;
+	doca_error_t result;
+
+	pthread_mutex_lock(&recorder->lock);
+	while (!recorder->stop) {
+		due = recorder->last_flush + recorder->flush_interval;
+		if (monitor_get_time_ns() >= due) {
+			/* An empty buffer counts as flushed, the next record waits at most a whole interval */
+			result = recorder_write(recorder);
+			if (result != DOCA_SUCCESS) {
+				recorder->flusher_result = result;
+				break;
+			}
+			continue;
+		}
+		deadline.tv_sec = due / NS_PER_SEC;
+		deadline.tv_nsec = due % NS_PER_SEC;
+		pthread_cond_timedwait(&recorder->stop_cond, &recorder->lock, &deadline);
+	}
+	pthread_mutex_unlock(&recorder->lock);
+	return NULL;
+}
+
+doca_error_t
+monitor_recorder_create(const char *path, enum monitor_record_format format, size_t buffer_size,
+			uint64_t flush_interval, struct monitor_recorder *recorder)
+{
+	struct monitor_recording_header header;
+	doca_error_t result;
+
+	if (buffer_size < MONITOR_CSV_LINE_MAX) {
+		DOCA_LOG_ERR("Record buffer must hold at least %d bytes", MONITOR_CSV_LINE_MAX);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+
+	memset(recorder, 0, sizeof(*recorder));
+	recorder->format = format;
+	recorder->buffer_size = buffer_size;
+	recorder->flush_interval = flush_interval;
+	recorder->last_flush = monitor_get_time_ns();
+	recorder->flusher_result = DOCA_SUCCESS;
+
+	recorder->buffer = (char *)malloc(buffer_size);
+	if (recorder->buffer == NULL) {
+		DOCA_LOG_ERR("Failed to allocate the record buffer");
+		return DOCA_ERROR_NO_MEMORY;
+	}
+
+	recorder->file = fopen(path, "w");
+	if (recorder->file == NULL) {
+		DOCA_LOG_ERR("Failed to open the recording file %s: %s", path, strerror(errno));
+		result = DOCA_ERROR_IO_FAILED;
+		goto free_buffer;
+	}
+
+	/* The file is written in whole buffers, the stdio buffering would only add a copy */
+	setvbuf(recorder->file, NULL, _IONBF, 0);
+
+	if (format == MONITOR_RECORD_FORMAT_BINARY) {
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, MONITOR_RECORDING_MAGIC, sizeof(header.magic));
+		header.version = MONITOR_RECORDING_VERSION;
+		header.sample_size = sizeof(struct monitor_sample);
+		header.start_time = recorder->last_flush;
+		memcpy(recorder->buffer, &header, sizeof(header));
+		recorder->buffer_used = sizeof(header);
+	} else {
+		recorder->buffer_used = strlcpy(recorder->buffer, MONITOR_CSV_HEADER, buffer_size);
+	}
+
+	pthread_mutex_init(&recorder->lock, NULL);
+	pthread_cond_init(&recorder->stop_cond, NULL);
+	if (flush_interval > 0) {
+		if (pthread_create(&recorder->flusher, NULL, recorder_flusher, recorder) != 0) {
+			DOCA_LOG_ERR("Failed to start the recording flusher thread");
+			result = DOCA_ERROR_OPERATING_SYSTEM;
+			goto destroy_lock;
+		}
+		recorder->flusher_started = true;
+	}
+
+	return DOCA_SUCCESS;
+
+destroy_lock:
+	pthread_cond_destroy(&recorder->stop_cond);
+	pthread_mutex_destroy(&recorder->lock);
+	fclose(recorder->file);
+	recorder->file = NULL;
+free_buffer:
+	free(recorder->buffer);
+	recorder->buffer = NULL;
+	return result;
+}
+
+doca_error_t
+monitor_recorder_flush(struct monitor_recorder *recorder)
+{
+	doca_error_t result;
+
+	pthread_mutex_lock(&recorder->lock);
+	result = recorder->flusher_result;
+	if (result == DOCA_SUCCESS)
+		result = recorder_write(recorder);
+	pthread_mutex_unlock(&recorder->lock);
+	return result;
+}
+
+doca_error_t
+monitor_recorder_append(struct monitor_recorder *recorder, const struct monitor_sample *sample)
+{
+	doca_error_t result;
+
+	pthread_mutex_lock(&recorder->lock);
+	result = recorder->flusher_result;
+	if (result != DOCA_SUCCESS)
+		goto unlock;
+
+	/* Keep room for the longest record, so a record is never split between two writes */
+	if (recorder->buffer_size - recorder->buffer_used < MONITOR_CSV_LINE_MAX) {
+		result = recorder_write(recorder);
+		if (result != DOCA_SUCCESS)
+			goto unlock;
+	}
+
+	if (recorder->format == MONITOR_RECORD_FORMAT_BINARY) {
+		memcpy(recorder->buffer + recorder->buffer_used, sample, sizeof(*sample));
+		recorder->buffer_used += sizeof(*sample);
+	} else {
+		recorder->buffer_used += monitor_csv_format(sample, recorder->buffer + recorder->buffer_used,
+							    recorder->buffer_size - recorder->buffer_used);
+	}
+	recorder->nb_samples++;
+
+	if (sample->recv_time - recorder->last_flush >= recorder->flush_interval)
+		result = recorder_write(recorder);
+unlock:
+	pthread_mutex_unlock(&recorder->lock);
+	return result;
+}
+
+doca_error_t
+monitor_recorder_destroy(struct monitor_recorder *recorder)
+{
+	doca_error_t result;
+
+	if (recorder->flusher_started) {
+		pthread_mutex_lock(&recorder->lock);
+		recorder->stop = true;
+		pthread_cond_signal(&recorder->stop_cond);
+		pthread_mutex_unlock(&recorder->lock);
+		pthread_join(recorder->flusher, NULL);
+		recorder->flusher_started = false;
+	}
+	pthread_cond_destroy(&recorder->stop_cond);
+	pthread_mutex_destroy(&recorder->lock);
+
+	result = recorder->flusher_result;
+	if (result == DOCA_SUCCESS)
+		result = recorder_write(recorder);
+	if (fclose(recorder->file) != 0 && result == DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to close the recording file: %s", strerror(errno));
+		result = DOCA_ERROR_IO_FAILED;
+	}
+	free(recorder->buffer);
+	recorder->buffer = NULL;
+	recorder->file = NULL;
+	return result;
+}
+
+doca_error_t
+monitor_recording_open(const char *path, struct monitor_recording_reader *reader)
+{
+	struct monitor_recording_header header;
+	char line[MONITOR_CSV_LINE_MAX];
+	doca_error_t result;
+
+	memset(reader, 0, sizeof(*reader));
+	reader->file = fopen(path, "r");
+	if (reader->file == NULL) {
+		DOCA_LOG_ERR("Failed to open the recording file %s: %s", path, strerror(errno));
+		return DOCA_ERROR_IO_FAILED;
+	}
+
+	if (fread(&header, sizeof(header), 1, reader->file) == 1 &&
+	    memcmp(header.magic, MONITOR_RECORDING_MAGIC, sizeof(header.magic)) == 0) {
+		if (header.version != MONITOR_RECORDING_VERSION) {
+			DOCA_LOG_ERR("Unsupported recording version %u (byte swapped %u), expected %u", header.version,
+				     __builtin_bswap16(header.version), MONITOR_RECORDING_VERSION);
+			result = DOCA_ERROR_UNSUPPORTED_VERSION;
+			goto close_file;
+		}
+		if (header.sample_size != sizeof(struct monitor_sample)) {
+			DOCA_LOG_ERR("Recording sample size %u does not match the expected %zu", header.sample_size,
+				     sizeof(struct monitor_sample));
+			result = DOCA_ERROR_UNSUPPORTED_VERSION;
+			goto close_file;
+		}
+		reader->format = MONITOR_RECORD_FORMAT_BINARY;
+		return DOCA_SUCCESS;
+	}
+
+	/* Not a binary recording, it must start with the CSV header line */
+	rewind(reader->file);
+	if (fgets(line, sizeof(line), reader->file) == NULL ||
+	    strncmp(line, MONITOR_CSV_HEADER_PREFIX, strlen(MONITOR_CSV_HEADER_PREFIX)) != 0) {
+		DOCA_LOG_ERR("%s is not a monitor recording", path);
+		result = DOCA_ERROR_INVALID_VALUE;
+		goto close_file;
+	}
+	reader->format = MONITOR_RECORD_FORMAT_CSV;
+	reader->line = 1;
+	return DOCA_SUCCESS;
+
+close_file:
+	fclose(reader->file);
+	reader->file = NULL;
+	return result;
+}
+
+doca_error_t
+monitor_recording_read(struct monitor_recording_reader *reader, struct monitor_sample *sample)
+{
+	char line[MONITOR_CSV_LINE_MAX];
+
+	if (reader->format == MONITOR_RECORD_FORMAT_BINARY) {
+		if (fread(sample, sizeof(*sample), 1, reader->file) == 1)
+			return DOCA_SUCCESS;
+		/* A partial sample at the end is the tail of an interrupted recording */
+		return ferror(reader->file) ? DOCA_ERROR_IO_FAILED : DOCA_ERROR_EMPTY;
+	}
+
+	if (fgets(line, sizeof(line), reader->file) == NULL)
+		return ferror(reader->file) ? DOCA_ERROR_IO_FAILED : DOCA_ERROR_EMPTY;
+	reader->line++;
+	if (monitor_csv_parse(line, sample) != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Malformed record in line %" PRIu64, reader->line);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+void
+monitor_recording_close(struct monitor_recording_reader *reader)
+{
+	if (reader->file != NULL)
+		fclose(reader->file);
+	reader->file = NULL;
+}
+
+/*
+ * Reset the counters of a histogram window
+ *
+ * @histogram [in]: Histogram
+ * @window_start [in]: Start of the new window (nanoseconds)
+ */
+static void
+monitor_histogram_reset(struct monitor_histogram *histogram, uint64_t window_start)
+{
+	memset(histogram->counts, 0, sizeof(histogram->counts));
+	histogram->window_start = window_start;
+	histogram->nb_samples = 0;
+	histogram->min = INT64_MAX;
+	histogram->max = INT64_MIN;
+	histogram->sum = 0;
+}
+
+void
+monitor_histogram_init(struct monitor_histogram *histogram, uint64_t window)
+{
+	histogram->window = window;
+	monitor_histogram_reset(histogram, 0);
+}
+
+void
+monitor_histogram_add(struct monitor_histogram *histogram, const struct monitor_sample *sample, FILE *out)
+{
+	int64_t offset = sample->offset_average;
+	uint64_t abs_offset;
+	unsigned int bucket;
+
+	if (histogram->window != 0 && sample->recv_time >= histogram->window_start + histogram->window) {
+		if (histogram->nb_samples > 0 && out != NULL)
+			monitor_histogram_report(histogram, out);
+		monitor_histogram_reset(histogram, sample->recv_time - sample->recv_time % histogram->window);
+	} else if (histogram->nb_samples == 0 && histogram->window_start == 0) {
+		histogram->window_start = sample->recv_time;
+	}
+
+	if (!(sample->flags & MONITOR_SAMPLE_FLAG_GM_PRESENT))
+		return;
+
+	abs_offset = offset < 0 ? -(uint64_t)offset : (uint64_t)offset;
+	bucket = abs_offset == 0 ? 0 : 64 - __builtin_clzll(abs_offset);
+	if (bucket >= MONITOR_HISTOGRAM_BUCKETS)
+		bucket = MONITOR_HISTOGRAM_BUCKETS - 1;
+
+	histogram->counts[bucket]++;
+	histogram->nb_samples++;
+	histogram->sum += offset;
+	if (offset < histogram->min)
+		histogram->min = offset;
+	if (offset > histogram->max)
+		histogram->max = offset;
+}
+
+void
+monitor_histogram_report(const struct monitor_histogram *histogram, FILE *out)
+{
+	time_t start = histogram->window_start / NS_PER_SEC;
+	char time_str[32];
+	struct tm tm;
+	unsigned int i;
+
+	gmtime_r(&start, &tm);
+	strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &tm);
+
+	if (histogram->nb_samples == 0) {
+		fprintf(out, "%s UTC  samples: 0\n", time_str);
+		return;
+	}
+
+	fprintf(out, "%s UTC  samples: %" PRIu64 "  offset min: %" PRId64 " max: %" PRId64 " mean: %" PRId64
+		"  p50 <= %" PRIu64 " p99 <= %" PRIu64 "  |offset| ns:", time_str, histogram->nb_samples, histogram->min,
+		histogram->max, histogram->sum / (int64_t)histogram->nb_samples,
+		monitor_histogram_percentile(histogram, 50), monitor_histogram_percentile(histogram, 99));
+	for (i = 0; i < MONITOR_HISTOGRAM_BUCKETS; i++) {
+		if (histogram->counts[i] == 0)
+			continue;
+		if (i == 0)
+			fprintf(out, " 0:%" PRIu64, histogram->counts[i]);
+		else if (i == MONITOR_HISTOGRAM_BUCKETS - 1)
+			fprintf(out, " >=%" PRIu64 ":%" PRIu64, (uint64_t)1 << (i - 1), histogram->counts[i]);
+		else
+			fprintf(out, " <%" PRIu64 ":%" PRIu64, (uint64_t)1 << i, histogram->counts[i]);
+	}
+	fprintf(out, "\n");
+}
+
+uint64_t
+monitor_histogram_percentile(const struct monitor_histogram *histogram, double percentile)
+{
+	uint64_t target = (uint64_t)(percentile / 100 * histogram->nb_samples + 0.5);
+	uint64_t seen = 0;
+	unsigned int i;
+
+	if (target == 0)
+		target = 1;
+	for (i = 0; i < MONITOR_HISTOGRAM_BUCKETS - 1; i++) {
+		seen += histogram->counts[i];
+		if (seen >= target)
+			return i == 0 ? 0 : ((uint64_t)1 << i) - 1;
+	}
+	return UINT64_MAX;
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef FIREFLY_MONITOR_RECORDER_H_
+#define FIREFLY_MONITOR_RECORDER_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <doca_error.h>
+
+#define MONITOR_RECORDING_MAGIC "FFMR"		  /* First bytes of a binary recording */
+#define MONITOR_RECORDING_VERSION 1		  /* Version of the binary recording format */
+#define MONITOR_CSV_HEADER_PREFIX "recv_time_ns," /* First column of the header line of a CSV recording */
+#define MONITOR_HISTOGRAM_BUCKETS 32		  /* Number of log2 buckets of the master offset histogram */
+#define NS_PER_SEC ((uint64_t)1000000000)	  /* Nanoseconds in a second */
+#define DEFAULT_HISTOGRAM_INTERVAL 60		  /* Default window of the master offset histogram (seconds) */
+
+/* Bits of monitor_sample.flags */
+#define MONITOR_SAMPLE_FLAG_GM_PRESENT (1 << 0)		 /* Is the Grandmaster present? */
+#define MONITOR_SAMPLE_FLAG_TIME_TRACEABLE (1 << 1)	 /* PTP timeTraceable property */
+#define MONITOR_SAMPLE_FLAG_FREQUENCY_TRACEABLE (1 << 2) /* PTP frequencyTraceable property */
+#define MONITOR_SAMPLE_FLAG_TAI_TIMESCALE (1 << 3)	 /* Are we working in PTP time (TAI) or in UTC? */
+
+enum monitor_record_format {
+	MONITOR_RECORD_FORMAT_BINARY, /* Fixed size monitor_sample records after a monitor_recording_header */
+	MONITOR_RECORD_FORMAT_CSV,    /* A header line and a line per record */
+};
+
+/*
+ * Compact form of a monitor record, as written to a recording. The user-facing strings of the record are not kept,
+ * they can be rebuilt from the raw values.
+ */
+struct monitor_sample {
+	uint64_t recv_time;	   /* Local time at which the client received the record (nanoseconds) */
+	uint64_t ptp_time;	   /* The accurate PTP timestamp (nanoseconds) */
+	uint64_t sys_time;	   /* The system's time (seconds) */
+	uint64_t gm_id;		   /* Grandmaster clock identity as a number, 0 if the Grandmaster is not present */
+	int64_t offset_average;	   /* Average offset from the master clock (in nano seconds) */
+	int64_t offset_max;	   /* Maximal (abs) offset from the master clock (in nano seconds) */
+	uint64_t offset_rms;	   /* Standard deviation (RMS) of the offset from the master clock */
+	uint32_t error_count;	   /* Number of errors the server encountered thus far */
+	int16_t utc_offset;	   /* Current offset from UTC (in seconds) */
+	uint8_t flags;		   /* MONITOR_SAMPLE_FLAG_* bits */
+	uint8_t ptp_stability;	   /* Stability state of the PTP (ptp_state_t) */
+	uint8_t port_state;	   /* The effective PTP port state of the most active port (monitor_port_state_t) */
+	uint8_t domain_number;	   /* The PTP domainNumber */
+	uint8_t gm_clock_class;	   /* Clock class of the Grandmaster clock */
+	uint8_t gm_clock_accuracy; /* Clock accuracy of the Grandmaster clock */
+	uint8_t gm_priority1;	   /* Priority1 field of the Grandmaster clock */
+	uint8_t gm_priority2;	   /* Priority2 field of the Grandmaster clock */
+	uint16_t gm_scaled_offset; /* Offset scaled log variance of the Grandmaster clock */
+};
+
+/* Header of a binary recording, the samples are in the byte order of the machine that recorded them */
+struct monitor_recording_header {
+	char magic[4];	      /* MONITOR_RECORDING_MAGIC, not NULL terminated */
+	uint16_t version;     /* MONITOR_RECORDING_VERSION */
+	uint16_t sample_size; /* Size of a monitor_sample */
+	uint64_t start_time;  /* Local time at which the recording started (nanoseconds) */
+};
+
+/*
+ * Histogram of the absolute average master offset over time windows. Bucket 0 counts zero offsets and bucket k
+ * counts offsets in [2^(k-1), 2^k) nanoseconds, the last bucket also counts all the larger offsets.
+ */
+struct monitor_histogram {
+	uint64_t window;			      /* Length of a window (nanoseconds), 0 for a single window */
+	uint64_t window_start;			      /* Start of the current window (nanoseconds) */
+	uint64_t counts[MONITOR_HISTOGRAM_BUCKETS]; /* Number of samples per bucket */
+	uint64_t nb_samples;			      /* Number of samples in the current window */
+	int64_t min;				      /* Minimal average offset in the current window */
+	int64_t max;				      /* Maximal average offset in the current window */
+	int64_t sum;				      /* Sum of the average offsets in the current window */
+};
+
+/*
+ * Writer of a recording, buffers the records and writes them when the buffer fills or the flush interval passes.
+ * The interval is also enforced by a flusher thread, so the records are written even when no new record arrives.
+ */
+struct monitor_recorder {
+	FILE *file;			   /* Recording file */
+	enum monitor_record_format format; /* Format of the recording */
+	char *buffer;			   /* Records that were not written to the file yet */
+	size_t buffer_size;		   /* Size of the buffer (bytes) */
+	size_t buffer_used;		   /* Used bytes of the buffer */
+	uint64_t flush_interval;	   /* Maximal time a record stays in the buffer (nanoseconds) */
+	uint64_t last_flush;		   /* Time of the last write to the file (nanoseconds) */
+	uint64_t nb_samples;		   /* Number of recorded samples */
+	pthread_mutex_t lock;		   /* Protects the buffer and the file against the flusher thread */
+	pthread_cond_t stop_cond;	   /* Wakes the flusher thread when the recorder is destroyed */
+	pthread_t flusher;		   /* Thread writing the buffer once the flush interval passes */
+	bool flusher_started;		   /* Was the flusher thread started? */
+	bool stop;			   /* Asks the flusher thread to exit */
+	doca_error_t flusher_result;	   /* First write error of the flusher thread */
+};
+
+/* Reader of a binary or CSV recording */
+struct monitor_recording_reader {
+	FILE *file;			   /* Recording file */
+	enum monitor_record_format format; /* Format of the recording, detected from its first bytes */
+	uint64_t line;			   /* Current line of a CSV recording, for error messages */
+};
+
+/*
+ * Get the local time, as recorded in monitor_sample.recv_time
+ *
+ * @return: Current CLOCK_REALTIME time (nanoseconds)
+ */
+uint64_t
+monitor_get_time_ns(void);
+
+/*
+ * Convert a canonical clock identity string, i.e. "EC:46:70:FF:FE:10:FE:B9 (ec4670.fffe.10feb9)", to a number
+ *
+ * @identity [in]: Clock identity string
+ * @return: The hexadecimal digits before the first space, as a number
+ */
+uint64_t
+monitor_parse_clock_identity(const char *identity);
+
+/*
+ * Parse the name of a recording format
+ *
+ * @name [in]: "binary" or "csv"
+ * @format [out]: The matching format
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t
+monitor_parse_record_format(const char *name, enum monitor_record_format *format);
+
+/*
+ * Create a recorder that writes to a new file.
+ * With a non zero flush interval a flusher thread is started, it writes the buffered records once they are older than
+ * the interval, even if no other record is appended.
+ *
+ * @path [in]: Path of the recording file, it is truncated if it exists
+ * @format [in]: Format of the recording
+ * @buffer_size [in]: Size of the record buffer (bytes), bounds the memory and the data lost on a crash
+ * @flush_interval [in]: Maximal time a record stays in the buffer (nanoseconds)
+ * @recorder [out]: The created recorder
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t
+monitor_recorder_create(const char *path, enum monitor_record_format format, size_t buffer_size,
+			uint64_t flush_interval, struct monitor_recorder *recorder);
+
+/*
+ * Add a sample to a recording
+ *
+ * @recorder [in]: Recorder
+ * @sample [in]: Sample to record
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t
+monitor_recorder_append(struct monitor_recorder *recorder, const struct monitor_sample *sample);
+
+/*
+ * Write the buffered samples to the recording file, can be called concurrently with the flusher thread
+ *
+ * @recorder [in]: Recorder
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t
+monitor_recorder_flush(struct monitor_recorder *recorder);
+
+/*
+ * Stop the flusher thread, flush the buffered samples, close the recording file and free the recorder resources
+ *
+ * @recorder [in]: Recorder
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t
+monitor_recorder_destroy(struct monitor_recorder *recorder);
+
+/*
+ * Open a recording for reading, its format is detected from its first bytes
+ *
+ * @path [in]: Path of the recording file
+ * @reader [out]: The opened reader
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t
+monitor_recording_open(const char *path, struct monitor_recording_reader *reader);
+
+/*
+ * Read the next sample of a recording
+ *
+ * @reader [in]: Reader
+ * @sample [out]: The read sample
+ * @return: DOCA_SUCCESS on success, DOCA_ERROR_EMPTY at the end of the recording and DOCA_ERROR otherwise
+ */
+doca_error_t
+monitor_recording_read(struct monitor_recording_reader *reader, struct monitor_sample *sample);
+
+/*
+ * Close a recording
+ *
+ * @reader [in]: Reader
+ */
+void
+monitor_recording_close(struct monitor_recording_reader *reader);
+
+/*
+ * Write a sample as a CSV line
+ *
+ * @sample [in]: Sample to write
+ * @file [in]: Output file
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t
+monitor_sample_write_csv(const struct monitor_sample *sample, FILE *file);
+
+/*
+ * Write the CSV header line
+ *
+ * @file [in]: Output file
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t
+monitor_csv_write_header(FILE *file);
+
+/*
+ * Initialize a master offset histogram
+ *
+ * @histogram [out]: Histogram
+ * @window [in]: Length of a window (nanoseconds), 0 for a single window
+ */
+void
+monitor_histogram_init(struct monitor_histogram *histogram, uint64_t window);
+
+/*
+ * Add a sample to a master offset histogram, samples without a Grandmaster have no offset and are ignored.
+ * When the sample starts a new window, the previous window is reported first.
+ *
+ * @histogram [in]: Histogram
+ * @sample [in]: Sample to add
+ * @out [in]: Where to report a finished window, NULL to only reset it
+ */
+void
+monitor_histogram_add(struct monitor_histogram *histogram, const struct monitor_sample *sample, FILE *out);
+
+/*
+ * Report the current window of a master offset histogram as a single line
+ *
+ * @histogram [in]: Histogram
+ * @out [in]: Output file
+ */
+void
+monitor_histogram_report(const struct monitor_histogram *histogram, FILE *out);
+
+/*
+ * Get an upper bound of a percentile of the absolute average master offset in the current window
+ *
+ * @histogram [in]: Histogram
+ * @percentile [in]: Percentile, between 0 and 100
+ * @return: Upper limit of the bucket that holds the percentile (nanoseconds)
+ */
+uint64_t
+monitor_histogram_percentile(const struct monitor_histogram *histogram, double percentile);
+
+#endif /* FIREFLY_MONITOR_RECORDER_H_ */
@@ -0,0 +1,447 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <bsd/string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <doca_argp.h>
+#include <doca_log.h>
+
+#include "firefly_monitor_core.hpp"
+#include "firefly_monitor_recorder.hpp"
+
+DOCA_LOG_REGISTER(FIREFLY_MONITOR::REPLAY);
+
+#define DEFAULT_GAP_THRESHOLD 5 /* Default time without records that is reported as a gap (seconds) */
+
+/* Replay tool configuration, filled by the command line parameters */
+struct firefly_replay_config {
+	char record_path[PATH_MAX];  /* Recording to analyze */
+	char csv_path[PATH_MAX];     /* Where to convert the recording to CSV, empty to skip the conversion */
+	uint32_t histogram_interval; /* Window of the master offset histogram (seconds), 0 for a single window */
+	uint32_t gap_threshold;	     /* Time without records that is reported as a gap (seconds) */
+};
+
+/* Statistics of a whole recording */
+struct replay_stats {
+	uint64_t nb_samples;	      /* Number of samples */
+	uint64_t nb_gm_present;	      /* Number of samples with a Grandmaster */
+	uint64_t nb_stable;	      /* Number of samples in a stable state */
+	uint64_t nb_gaps;	      /* Number of gaps between records */
+	uint64_t first_time;	      /* Receive time of the first sample (nanoseconds) */
+	uint64_t last_time;	      /* Receive time of the last sample (nanoseconds) */
+	uint64_t max_abs_offset;      /* Largest maximal (abs) master offset */
+	uint64_t max_rms;	      /* Largest master offset RMS */
+	struct monitor_sample prev;   /* Previous sample, to detect state changes */
+	struct monitor_histogram all; /* Master offset histogram of the whole recording */
+};
+
+/*
+ * Format a receive time as a UTC string
+ *
+ * @time_ns [in]: Time (nanoseconds)
+ * @str [out]: Formatted time
+ * @size [in]: Size of the str buffer
+ * @return: str
+ */
+static const char *
+format_time(uint64_t time_ns, char *str, size_t size)
+{
+	time_t seconds = time_ns / NS_PER_SEC;
+	struct tm tm;
+	size_t len;
+
+	gmtime_r(&seconds, &tm);
+	len = strftime(str, size, "%Y-%m-%d %H:%M:%S", &tm);
+	snprintf(str + len, size - len, ".%03" PRIu64, (time_ns % NS_PER_SEC) / 1000000);
+	return str;
+}
+
+/*
+ * Report the changes between the previous and the current sample
+ *
+ * @stats [in]: Recording statistics, holding the previous sample
+ * @sample [in]: Current sample
+ * @gap_threshold [in]: Time without records that is reported as a gap (nanoseconds)
+ */
+static void
+report_changes(struct replay_stats *stats, const struct monitor_sample *sample, uint64_t gap_threshold)
+{
+	const struct monitor_sample *prev = &stats->prev;
+	char time_str[48];
+
+	format_time(sample->recv_time, time_str, sizeof(time_str));
+
+	if (sample->recv_time - prev->recv_time > gap_threshold) {
+		printf("%s  no records for %.1f seconds\n", time_str,
+		       (double)(sample->recv_time - prev->recv_time) / NS_PER_SEC);
+		stats->nb_gaps++;
+	}
+	if (sample->ptp_stability != prev->ptp_stability)
+		printf("%s  ptp_stable: %s -> %s\n", time_str,
+		       get_stability_string((ptp_state_t)prev->ptp_stability),
+		       get_stability_string((ptp_state_t)sample->ptp_stability));
+	if ((sample->flags ^ prev->flags) & MONITOR_SAMPLE_FLAG_GM_PRESENT)
+		printf("%s  gmPresent: %s\n", time_str,
+		       (sample->flags & MONITOR_SAMPLE_FLAG_GM_PRESENT) ? "true" : "false");
+	else if (sample->gm_id != prev->gm_id)
+		printf("%s  gmIdentity: 0x%016" PRIx64 " -> 0x%016" PRIx64 "\n", time_str, prev->gm_id, sample->gm_id);
+	if ((sample->flags & MONITOR_SAMPLE_FLAG_GM_PRESENT) && sample->port_state != prev->port_state)
+		printf("%s  port_state: %s -> %s\n", time_str,
+		       get_port_state_string((monitor_port_state_t)prev->port_state),
+		       get_port_state_string((monitor_port_state_t)sample->port_state));
+	if (sample->error_count != prev->error_count)
+		printf("%s  error_count: %u -> %u\n", time_str, prev->error_count, sample->error_count);
+}
+
+/*
+ * Analyze a recording: print the master offset histogram of every window, the state changes and a summary
+ *
+ * @cfg [in]: Replay tool configuration
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+replay_recording(struct firefly_replay_config *cfg)
+{
+	struct monitor_recording_reader reader;
+	struct monitor_histogram histogram;
+	struct monitor_sample sample;
+	struct replay_stats stats;
+	char start_str[48], end_str[48];
+	uint64_t abs_offset;
+	FILE *csv = NULL;
+	doca_error_t result;
+
+	result = monitor_recording_open(cfg->record_path, &reader);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	if (cfg->csv_path[0] != '\0') {
+		csv = fopen(cfg->csv_path, "w");
+		if (csv == NULL) {
+			DOCA_LOG_ERR("Failed to open %s: %s", cfg->csv_path, strerror(errno));
+			result = DOCA_ERROR_IO_FAILED;
+			goto close_recording;
+		}
+		result = monitor_csv_write_header(csv);
+		if (result != DOCA_SUCCESS)
+			goto close_csv;
+	}
+
+	memset(&stats, 0, sizeof(stats));
+	monitor_histogram_init(&stats.all, 0);
+	monitor_histogram_init(&histogram, (uint64_t)cfg->histogram_interval * NS_PER_SEC);
+
+	printf("Recording %s (%s)\n\n", cfg->record_path,
+	       reader.format == MONITOR_RECORD_FORMAT_BINARY ? "binary" : "csv");
+	while ((result = monitor_recording_read(&reader, &sample)) == DOCA_SUCCESS) {
+		if (stats.nb_samples == 0)
+			stats.first_time = sample.recv_time;
+		else
+			report_changes(&stats, &sample, (uint64_t)cfg->gap_threshold * NS_PER_SEC);
+
+		if (csv != NULL) {
+			result = monitor_sample_write_csv(&sample, csv);
+			if (result != DOCA_SUCCESS) {
+				DOCA_LOG_ERR("Failed to write to %s", cfg->csv_path);
+				goto close_csv;
+			}
+		}
+
+		monitor_histogram_add(&histogram, &sample, stdout);
+		monitor_histogram_add(&stats.all, &sample, NULL);
+
+		stats.nb_samples++;
+		stats.last_time = sample.recv_time;
+		if (sample.ptp_stability == STATE_STABLE)
+			stats.nb_stable++;
+		if (sample.flags & MONITOR_SAMPLE_FLAG_GM_PRESENT) {
+			stats.nb_gm_present++;
+			abs_offset = sample.offset_max < 0 ? -(uint64_t)sample.offset_max : (uint64_t)sample.offset_max;
+			if (abs_offset > stats.max_abs_offset)
+				stats.max_abs_offset = abs_offset;
+			if (sample.offset_rms > stats.max_rms)
+				stats.max_rms = sample.offset_rms;
+		}
+		stats.prev = sample;
+	}
+	if (result != DOCA_ERROR_EMPTY)
+		goto close_csv;
+	result = DOCA_SUCCESS;
+
+	/* The last window is not followed by a sample that would report it */
+	if (cfg->histogram_interval > 0 && histogram.nb_samples > 0)
+		monitor_histogram_report(&histogram, stdout);
+
+	if (stats.nb_samples == 0) {
+		printf("The recording holds no records\n");
+		goto close_csv;
+	}
+
+	printf("\nRecords:           %" PRIu64 " from %s to %s UTC (%.1f seconds)\n", stats.nb_samples,
+	       format_time(stats.first_time, start_str, sizeof(start_str)),
+	       format_time(stats.last_time, end_str, sizeof(end_str)),
+	       (double)(stats.last_time - stats.first_time) / NS_PER_SEC);
+	printf("gmPresent:         %.2f%% of the records\n", 100.0 * stats.nb_gm_present / stats.nb_samples);
+	printf("ptp_stable:        %.2f%% of the records\n", 100.0 * stats.nb_stable / stats.nb_samples);
+	printf("Gaps:              %" PRIu64 " (more than %u seconds without records)\n", stats.nb_gaps,
+	       cfg->gap_threshold);
+	printf("error_count:       %u at the end\n", stats.prev.error_count);
+	if (stats.nb_gm_present > 0) {
+		printf("master_offset:     max |max| %" PRIu64 " ns, max rms %" PRIu64 " ns, p99.9 |avg| <= %" PRIu64
+		       " ns\n",
+		       stats.max_abs_offset, stats.max_rms, monitor_histogram_percentile(&stats.all, 99.9));
+		printf("Whole recording:   ");
+		monitor_histogram_report(&stats.all, stdout);
+	}
+
+close_csv:
+	if (csv != NULL && fclose(csv) != 0 && result == DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to close %s: %s", cfg->csv_path, strerror(errno));
+		result = DOCA_ERROR_IO_FAILED;
+	}
+close_recording:
+	monitor_recording_close(&reader);
+	return result;
+}
+
+/*
+ * ARGP Callback - Handle recording file parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+record_path_callback(void *param, void *config)
+{
+	struct firefly_replay_config *cfg = (struct firefly_replay_config *)config;
+
+	if (strlcpy(cfg->record_path, (char *)param, sizeof(cfg->record_path)) >= sizeof(cfg->record_path)) {
+		DOCA_LOG_ERR("Recording file path is too long, max %zu characters", sizeof(cfg->record_path) - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle CSV output file parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+csv_path_callback(void *param, void *config)
+{
+	struct firefly_replay_config *cfg = (struct firefly_replay_config *)config;
+
+	if (strlcpy(cfg->csv_path, (char *)param, sizeof(cfg->csv_path)) >= sizeof(cfg->csv_path)) {
+		DOCA_LOG_ERR("CSV file path is too long, max %zu characters", sizeof(cfg->csv_path) - 1);
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle histogram interval parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+histogram_interval_callback(void *param, void *config)
+{
+	struct firefly_replay_config *cfg = (struct firefly_replay_config *)config;
+	int interval = *(int *)param;
+
+	if (interval < 0) {
+		DOCA_LOG_ERR("Histogram interval can not be negative");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->histogram_interval = interval;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * ARGP Callback - Handle gap threshold parameter
+ *
+ * @param [in]: Input parameter
+ * @config [in/out]: Program configuration context
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+gap_threshold_callback(void *param, void *config)
+{
+	struct firefly_replay_config *cfg = (struct firefly_replay_config *)config;
+	int threshold = *(int *)param;
+
+	if (threshold < 1) {
+		DOCA_LOG_ERR("Gap threshold must be at least 1 second");
+		return DOCA_ERROR_INVALID_VALUE;
+	}
+	cfg->gap_threshold = threshold;
+	return DOCA_SUCCESS;
+}
+
+/*
+ * Register the command line parameters for the replay tool.
+ *
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+register_firefly_replay_params(void)
+{
+	struct doca_argp_param *file_param, *csv_param, *histogram_param, *gap_param;
+	doca_error_t result;
+
+	/* Create and register recording file param */
+	result = doca_argp_param_create(&file_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(file_param, "f");
+	doca_argp_param_set_long_name(file_param, "file");
+	doca_argp_param_set_arguments(file_param, "<path>");
+	doca_argp_param_set_description(file_param, "Recording to analyze, binary or CSV");
+	doca_argp_param_set_callback(file_param, record_path_callback);
+	doca_argp_param_set_type(file_param, DOCA_ARGP_TYPE_STRING);
+	doca_argp_param_set_mandatory(file_param);
+	result = doca_argp_register_param(file_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register CSV output param */
+	result = doca_argp_param_create(&csv_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_short_name(csv_param, "c");
+	doca_argp_param_set_long_name(csv_param, "csv");
+	doca_argp_param_set_arguments(csv_param, "<path>");
+	doca_argp_param_set_description(csv_param, "Convert the recording to a CSV file");
+	doca_argp_param_set_callback(csv_param, csv_path_callback);
+	doca_argp_param_set_type(csv_param, DOCA_ARGP_TYPE_STRING);
+	result = doca_argp_register_param(csv_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register histogram interval param */
+	result = doca_argp_param_create(&histogram_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(histogram_param, "histogram-interval");
+	doca_argp_param_set_arguments(histogram_param, "<seconds>");
+	doca_argp_param_set_description(histogram_param,
+					"Window of the master_offset histograms, 0 for the whole recording only (default 60)");
+	doca_argp_param_set_callback(histogram_param, histogram_interval_callback);
+	doca_argp_param_set_type(histogram_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(histogram_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	/* Create and register gap threshold param */
+	result = doca_argp_param_create(&gap_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to create ARGP param: %s", doca_error_get_descr(result));
+		return result;
+	}
+	doca_argp_param_set_long_name(gap_param, "gap");
+	doca_argp_param_set_arguments(gap_param, "<seconds>");
+	doca_argp_param_set_description(gap_param, "Report periods without records longer than this (default 5)");
+	doca_argp_param_set_callback(gap_param, gap_threshold_callback);
+	doca_argp_param_set_type(gap_param, DOCA_ARGP_TYPE_INT);
+	result = doca_argp_register_param(gap_param);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program param: %s", doca_error_get_descr(result));
+		return result;
+	}
+
+	result = doca_argp_register_version_callback(firefly_monitor_version_callback);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register version callback: %s", doca_error_get_descr(result));
+		return result;
+	}
+	return result;
+}
+
+/*
+ * Main function for DOCA Firefly's PTP Monitor recording analysis tool
+ *
+ * @argc [in]: command line arguments size
+ * @argv [in]: array of command line arguments
+ * @return: EXIT_SUCCESS on success and EXIT_FAILURE otherwise
+ */
+int
+main(int argc, char *argv[])
+{
+	struct firefly_replay_config cfg = {};
+	doca_error_t result;
+
+	cfg.histogram_interval = DEFAULT_HISTOGRAM_INTERVAL;
+	cfg.gap_threshold = DEFAULT_GAP_THRESHOLD;
+
+	/* Register a logger backend */
+	result = doca_log_backend_create_standard();
+	if (result != DOCA_SUCCESS) {
+		return EXIT_FAILURE;
+	}
+
+	/* Parse cmdline/json arguments */
+	result = doca_argp_init("doca_firefly_monitor_replay", &cfg);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to init ARGP resources: %s", doca_error_get_descr(result));
+		return EXIT_FAILURE;
+	}
+
+	result = register_firefly_replay_params();
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to register program parameters: %s", doca_error_get_descr(result));
+		doca_argp_destroy();
+		return EXIT_FAILURE;
+	}
+
+	result = doca_argp_start(argc, argv);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to parse program input: %s", doca_error_get_descr(result));
+		doca_argp_destroy();
+		return EXIT_FAILURE;
+	}
+
+	result = replay_recording(&cfg);
+	if (result != DOCA_SUCCESS) {
+		DOCA_LOG_ERR("Failed to analyze the recording: %s", doca_error_get_descr(result));
+		doca_argp_destroy();
+		return EXIT_FAILURE;
+	}
+
+	doca_argp_destroy();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,575 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <grpcpp/alarm.h>
+#include <grpcpp/grpcpp.h>
+
+#include <doca_log.h>
+
+#include "client.hpp"
+#include "firefly_monitor_core.hpp"
+#include "firefly_monitor_delta.hpp"
+#include "fleet.hpp"
+
+DOCA_LOG_REGISTER(FIREFLY_MONITOR::FLEET);
+
+#define FLEET_POLL_TIMEOUT_MS 200	   /* Maximal time a thread waits for a completion before checking for exit */
+#define FLEET_MIN_BACKOFF_MS 1000	   /* First delay before resubscribing to a device */
+#define FLEET_MAX_BACKOFF_MS 30000	   /* Maximal delay before resubscribing to a device */
+#define FLEET_MAX_REPORTED_DEVICES 32	   /* Maximal number of out of sync devices listed in a report */
+
+static std::atomic<bool> force_quit;
+
+FleetSnapshotTable::FleetSnapshotTable(size_t nb_devices)
+	: entries_(new struct fleet_snapshot_entry[nb_devices]), nb_devices_(nb_devices)
+{
+	for (size_t i = 0; i < nb_devices; i++) {
+		entries_[i].seq.store(0, std::memory_order_relaxed);
+		entries_[i].state.store(FLEET_DEVICE_CONNECTING, std::memory_order_relaxed);
+		for (size_t w = 0; w < FLEET_SAMPLE_WORDS; w++)
+			entries_[i].words[w].store(0, std::memory_order_relaxed);
+	}
+}
+
+void
+FleetSnapshotTable::publish(size_t device, const struct monitor_sample &sample)
+{
+	struct fleet_snapshot_entry &entry = entries_[device];
+	uint64_t words[FLEET_SAMPLE_WORDS] = {};
+	uint32_t seq = entry.seq.load(std::memory_order_relaxed);
+
+	memcpy(words, &sample, sizeof(sample));
+
+	/* An odd sequence tells the readers that the sample is being written */
+	entry.seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (size_t w = 0; w < FLEET_SAMPLE_WORDS; w++)
+		entry.words[w].store(words[w], std::memory_order_relaxed);
+	entry.seq.store(seq + 2, std::memory_order_release);
+}
+
+bool
+FleetSnapshotTable::read(size_t device, struct monitor_sample &sample) const
+{
+	const struct fleet_snapshot_entry &entry = entries_[device];
+	uint64_t words[FLEET_SAMPLE_WORDS];
+	uint32_t seq_before, seq_after;
+
+	do {
+		seq_before = entry.seq.load(std::memory_order_acquire);
+		if (seq_before == 0)
+			return false;
+		if (seq_before & 1)
+			continue;
+		for (size_t w = 0; w < FLEET_SAMPLE_WORDS; w++)
+			words[w] = entry.words[w].load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		seq_after = entry.seq.load(std::memory_order_relaxed);
+	} while ((seq_before & 1) || seq_before != seq_after);
+
+	memcpy(&sample, words, sizeof(sample));
+	return true;
+}
+
+void
+FleetSnapshotTable::set_state(size_t device, enum fleet_device_state state)
+{
+	entries_[device].state.store(state, std::memory_order_release);
+}
+
+enum fleet_device_state
+FleetSnapshotTable::get_state(size_t device) const
+{
+	return (enum fleet_device_state)entries_[device].state.load(std::memory_order_acquire);
+}
+
+/*
+ * Get the absolute maximal master offset of a sample
+ *
+ * @sample [in]: Sample
+ * @return: Absolute master offset (nanoseconds)
+ */
+static uint64_t
+sample_abs_offset(const struct monitor_sample *sample)
+{
+	return sample->offset_max < 0 ? (uint64_t)(-(sample->offset_max + 1)) + 1 : (uint64_t)sample->offset_max;
+}
+
+enum fleet_sync_problem
+fleet_check_device(const FleetSnapshotTable &table, size_t device, const struct fleet_config *cfg, uint64_t now,
+		   struct monitor_sample *sample)
+{
+	if (table.get_state(device) != FLEET_DEVICE_CONNECTED || !table.read(device, *sample))
+		return FLEET_SYNC_DISCONNECTED;
+	if (now > sample->recv_time && now - sample->recv_time > (uint64_t)cfg->stale_timeout * NS_PER_SEC)
+		return FLEET_SYNC_STALE;
+	if (!(sample->flags & MONITOR_SAMPLE_FLAG_GM_PRESENT))
+		return FLEET_SYNC_NO_GM;
+	if (sample->ptp_stability != STATE_STABLE)
+		return FLEET_SYNC_NOT_STABLE;
+	if (sample_abs_offset(sample) > cfg->offset_threshold)
+		return FLEET_SYNC_OFFSET;
+	return FLEET_SYNC_OK;
+}
+
+void
+fleet_summarize(const FleetSnapshotTable &table, const struct fleet_config *cfg, uint64_t now,
+		struct fleet_summary *summary)
+{
+	struct monitor_sample sample;
+	enum fleet_sync_problem problem;
+
+	memset(summary, 0, sizeof(*summary));
+	summary->nb_devices = table.size();
+	for (size_t device = 0; device < table.size(); device++) {
+		problem = fleet_check_device(table, device, cfg, now, &sample);
+		if (problem != FLEET_SYNC_OK)
+			summary->nb_out_of_sync++;
+		if (problem == FLEET_SYNC_DISCONNECTED)
+			continue;
+		summary->nb_connected++;
+		if (sample.flags & MONITOR_SAMPLE_FLAG_GM_PRESENT)
+			summary->nb_gm_present++;
+		if (sample.ptp_stability == STATE_STABLE)
+			summary->nb_stable++;
+	}
+}
+
+void
+fleet_worst_offsets(const FleetSnapshotTable &table, size_t max_devices, std::vector<struct fleet_offset> &worst)
+{
+	struct monitor_sample sample;
+
+	worst.clear();
+	for (size_t device = 0; device < table.size(); device++) {
+		if (table.get_state(device) != FLEET_DEVICE_CONNECTED || !table.read(device, sample))
+			continue;
+		if (!(sample.flags & MONITOR_SAMPLE_FLAG_GM_PRESENT))
+			continue;
+		worst.push_back({device, sample_abs_offset(&sample)});
+	}
+
+	auto by_offset = [](const struct fleet_offset &a, const struct fleet_offset &b) {
+		return a.abs_offset > b.abs_offset;
+	};
+	if (worst.size() > max_devices) {
+		std::partial_sort(worst.begin(), worst.begin() + max_devices, worst.end(), by_offset);
+		worst.resize(max_devices);
+	} else {
+		std::sort(worst.begin(), worst.end(), by_offset);
+	}
+}
+
+const char *
+fleet_sync_problem_string(enum fleet_sync_problem problem)
+{
+	switch (problem) {
+	case FLEET_SYNC_OK:
+		return "in sync";
+	case FLEET_SYNC_DISCONNECTED:
+		return "disconnected";
+	case FLEET_SYNC_STALE:
+		return "no recent records";
+	case FLEET_SYNC_NO_GM:
+		return "no Grandmaster";
+	case FLEET_SYNC_NOT_STABLE:
+		return "PTP not stable";
+	case FLEET_SYNC_OFFSET:
+		return "master offset above threshold";
+	default:
+		return "unknown";
+	}
+}
+
+/*
+ * Subscription to the monitor records of a single device, driven by the completion queue of its thread.
+ * At most one operation of a subscription is pending at any time, its completion tag is the subscription itself.
+ */
+class DeviceSubscription {
+public:
+	DeviceSubscription(size_t device,
+			   const struct fleet_device_info &info,
+			   grpc::CompletionQueue *cq,
+			   FleetSnapshotTable *table)
+		: device_(device),
+		  info_(info),
+		  cq_(cq),
+		  table_(table),
+		  stub_(FireflyMonitor::FireflyMonitor::NewStub(
+			  grpc::CreateChannel(info.address, grpc::InsecureChannelCredentials())))
+	{
+	}
+
+	/*
+	 * Start the subscription
+	 */
+	void start(void)
+	{
+		SubscribeReq request;
+
+		context_.reset(new grpc::ClientContext());
+		decoder_.reset();
+		request.set_delta(true);
+		reader_ = stub_->PrepareAsyncSubscribe(context_.get(), request, cq_);
+		op_ = OP_START;
+		reader_->StartCall(this);
+	}
+
+	/*
+	 * Handle the completion of the pending operation and start the next one
+	 *
+	 * @ok [in]: Completion status returned by the completion queue
+	 */
+	void proceed(bool ok)
+	{
+		std::chrono::system_clock::time_point deadline;
+
+		switch (op_) {
+		case OP_START:
+		case OP_READ:
+			if (op_ == OP_READ && ok && !handle_record())
+				ok = false;
+			if (!ok || quitting_) {
+				/* The stream ended or was cancelled, get its status */
+				op_ = OP_FINISH;
+				reader_->Finish(&status_, this);
+				break;
+			}
+			op_ = OP_READ;
+			reader_->Read(&record_, this);
+			break;
+		case OP_FINISH:
+			table_->set_state(device_, FLEET_DEVICE_DISCONNECTED);
+			if (quitting_) {
+				op_ = OP_DONE;
+				break;
+			}
+			DOCA_LOG_WARN("Subscription to %s (%s) ended: %s, retrying in %u ms", info_.name.c_str(),
+				      info_.address.c_str(), status_.error_message().c_str(), backoff_ms_);
+			op_ = OP_BACKOFF;
+			deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(backoff_ms_);
+			alarm_.Set(cq_, deadline, this);
+			backoff_ms_ = std::min(backoff_ms_ * 2, (uint32_t)FLEET_MAX_BACKOFF_MS);
+			break;
+		case OP_BACKOFF:
+			/* A cancelled alarm completes with !ok */
+			if (!ok || quitting_) {
+				op_ = OP_DONE;
+				break;
+			}
+			start();
+			break;
+		default:
+			break;
+		}
+	}
+
+	/*
+	 * Cancel the pending operation, the subscription is done once its last completion is handled
+	 */
+	void cancel(void)
+	{
+		quitting_ = true;
+		if (op_ == OP_BACKOFF)
+			alarm_.Cancel();
+		else if (op_ == OP_START || op_ == OP_READ)
+			context_->TryCancel();
+	}
+
+	/*
+	 * Check if the subscription has no pending operation left
+	 *
+	 * @return: true if the subscription is done
+	 */
+	bool done(void) const
+	{
+		return op_ == OP_DONE;
+	}
+
+private:
+	/*
+	 * Decode the received record and publish it to the snapshot table
+	 *
+	 * @return: false if the record can not be decoded and the subscription has to restart
+	 */
+	bool handle_record(void)
+	{
+		struct monitor_sample sample;
+
+		if (decoder_.decode(record_) != DOCA_SUCCESS) {
+			DOCA_LOG_ERR("Received a monitor record with unknown Grandmaster information from %s",
+				     info_.name.c_str());
+			context_->TryCancel();
+			return false;
+		}
+		record_to_sample(record_, monitor_get_time_ns(), &sample);
+		table_->publish(device_, sample);
+		if (table_->get_state(device_) != FLEET_DEVICE_CONNECTED) {
+			DOCA_LOG_INFO("Subscribed to %s (%s)", info_.name.c_str(), info_.address.c_str());
+			table_->set_state(device_, FLEET_DEVICE_CONNECTED);
+		}
+		backoff_ms_ = FLEET_MIN_BACKOFF_MS;
+		return true;
+	}
+
+	enum subscription_op {
+		OP_START,   /* The call is being started */
+		OP_READ,    /* A record is being read */
+		OP_FINISH,  /* The status of the ended call is being read */
+		OP_BACKOFF, /* Waiting before subscribing again */
+		OP_DONE,    /* No pending operation, the subscription was cancelled */
+	};
+
+	size_t device_;						  /* Index of the device in the snapshot table */
+	const struct fleet_device_info &info_;			  /* Name and address of the device */
+	grpc::CompletionQueue *cq_;				  /* Completion queue of the handling thread */
+	FleetSnapshotTable *table_;				  /* Where the received records are published */
+	std::unique_ptr<FireflyMonitor::Stub> stub_;		  /* Stub of the device channel */
+	std::unique_ptr<grpc::ClientContext> context_;		  /* Context of the current call */
+	std::unique_ptr<grpc::ClientAsyncReader<MonitorRecord>> reader_; /* Stream of the current call */
+	MonitorRecord record_;					  /* Record being read */
+	MonitorDeltaDecoder decoder_;				  /* Delta decoder of the current call */
+	grpc::Status status_;					  /* Status of the ended call */
+	grpc::Alarm alarm_;					  /* Backoff timer */
+	uint32_t backoff_ms_ = FLEET_MIN_BACKOFF_MS;		  /* Delay before the next resubscription */
+	enum subscription_op op_ = OP_DONE;			  /* Pending operation */
+	bool quitting_ = false;					  /* The subscription is being cancelled */
+};
+
+/*
+ * Handle the subscriptions of a thread until force_quit is set
+ *
+ * @cq [in]: Completion queue of the thread
+ * @subscriptions [in]: Subscriptions of the thread
+ */
+static void
+fleet_worker(grpc::CompletionQueue *cq, std::vector<std::unique_ptr<DeviceSubscription>> *subscriptions)
+{
+	std::chrono::system_clock::time_point deadline;
+	grpc::CompletionQueue::NextStatus status;
+	DeviceSubscription *subscription;
+	size_t nb_done = 0;
+	bool cancelled = false;
+	void *tag;
+	bool ok;
+
+	for (auto &sub : *subscriptions)
+		sub->start();
+
+	while (nb_done < subscriptions->size()) {
+		if (force_quit && !cancelled) {
+			for (auto &sub : *subscriptions)
+				sub->cancel();
+			cancelled = true;
+		}
+		deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(FLEET_POLL_TIMEOUT_MS);
+		status = cq->AsyncNext(&tag, &ok, deadline);
+		if (status == grpc::CompletionQueue::SHUTDOWN)
+			break;
+		if (status == grpc::CompletionQueue::TIMEOUT)
+			continue;
+		subscription = static_cast<DeviceSubscription *>(tag);
+		subscription->proceed(ok);
+		if (subscription->done())
+			nb_done++;
+	}
+
+	cq->Shutdown();
+	while (cq->Next(&tag, &ok))
+		;
+}
+
+/*
+ * Load the devices file, each line is "[name] address[:port]", empty lines and lines starting with '#' are skipped
+ *
+ * @path [in]: Path of the devices file
+ * @devices [out]: The loaded devices
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+static doca_error_t
+load_devices(const char *path, std::vector<struct fleet_device_info> &devices)
+{
+	char line[1024], first[512], second[512];
+	FILE *file;
+	int nb_fields;
+	uint64_t line_nb = 0;
+	doca_error_t result = DOCA_SUCCESS;
+
+	file = fopen(path, "r");
+	if (file == NULL) {
+		DOCA_LOG_ERR("Failed to open the devices file %s: %s", path, strerror(errno));
+		return DOCA_ERROR_NOT_FOUND;
+	}
+
+	while (fgets(line, sizeof(line), file) != NULL) {
+		struct fleet_device_info info;
+		char *start = line;
+
+		line_nb++;
+		while (isspace(*start))
+			start++;
+		if (*start == '\0' || *start == '#')
+			continue;
+		nb_fields = sscanf(start, "%511s %511s", first, second);
+		if (nb_fields == 2) {
+			info.name = first;
+			info.address = second;
+		} else {
+			info.name = first;
+			info.address = first;
+		}
+		/* Use the default port when none is given */
+		if (info.address.find(':') == std::string::npos)
+			info.address += ":" + std::to_string(eNetworkPort::k_DocaFirefly);
+		if (devices.size() == FLEET_MAX_DEVICES) {
+			DOCA_LOG_ERR("%s line %" PRIu64 ": too many devices, the maximum is %d", path, line_nb,
+				     FLEET_MAX_DEVICES);
+			result = DOCA_ERROR_INVALID_VALUE;
+			break;
+		}
+		devices.push_back(info);
+	}
+
+	fclose(file);
+	if (result == DOCA_SUCCESS && devices.empty()) {
+		DOCA_LOG_ERR("No devices in %s", path);
+		result = DOCA_ERROR_INVALID_VALUE;
+	}
+	return result;
+}
+
+/*
+ * Print a fleet report to stdout
+ *
+ * @devices [in]: The devices
+ * @table [in]: Snapshot table
+ * @cfg [in]: Fleet aggregator configuration
+ */
+static void
+print_report(const std::vector<struct fleet_device_info> &devices, const FleetSnapshotTable &table,
+	     const struct fleet_config *cfg)
+{
+	std::vector<struct fleet_offset> worst;
+	struct fleet_summary summary;
+	struct monitor_sample sample;
+	enum fleet_sync_problem problem;
+	uint64_t now = monitor_get_time_ns();
+	size_t nb_listed = 0;
+
+	fleet_summarize(table, cfg, now, &summary);
+	fleet_worst_offsets(table, cfg->worst_count, worst);
+
+	printf("Fleet:           %zu devices, %zu connected, %zu with a Grandmaster, %zu stable, %zu out of sync\n",
+	       summary.nb_devices, summary.nb_connected, summary.nb_gm_present, summary.nb_stable,
+	       summary.nb_out_of_sync);
+
+	if (!worst.empty())
+		printf("Worst offsets:\n");
+	for (const auto &entry : worst)
+		printf("\t%-32s %" PRIu64 " ns\n", devices[entry.device].name.c_str(), entry.abs_offset);
+
+	if (summary.nb_out_of_sync > 0)
+		printf("Out of sync:\n");
+	for (size_t device = 0; device < table.size() && nb_listed < FLEET_MAX_REPORTED_DEVICES; device++) {
+		problem = fleet_check_device(table, device, cfg, now, &sample);
+		if (problem == FLEET_SYNC_OK)
+			continue;
+		printf("\t%-32s %s\n", devices[device].name.c_str(), fleet_sync_problem_string(problem));
+		nb_listed++;
+	}
+	if (summary.nb_out_of_sync > nb_listed)
+		printf("\t... and %zu more\n", summary.nb_out_of_sync - nb_listed);
+	printf("\n");
+	fflush(stdout);
+}
+
+/*
+ * Callback function to handle TERM and INT signals
+ *
+ * @signum [in]: signal number
+ */
+static void
+signal_handler(int signum)
+{
+	if (signum == SIGINT || signum == SIGTERM) {
+		DOCA_LOG_INFO("Signal %d received, preparing to exit", signum);
+		force_quit = true;
+	}
+}
+
+doca_error_t
+run_fleet(struct fleet_config *cfg)
+{
+	std::vector<struct fleet_device_info> devices;
+	std::vector<std::unique_ptr<grpc::CompletionQueue>> queues;
+	std::vector<std::vector<std::unique_ptr<DeviceSubscription>>> subscriptions;
+	std::vector<std::thread> threads;
+	uint32_t nb_threads;
+	uint64_t next_report;
+	doca_error_t result;
+
+	result = load_devices(cfg->devices_path, devices);
+	if (result != DOCA_SUCCESS)
+		return result;
+
+	FleetSnapshotTable table(devices.size());
+	nb_threads = std::min(cfg->nb_threads, (uint32_t)devices.size());
+
+	/* Assign the devices to the threads round robin, each thread has its own completion queue */
+	queues.resize(nb_threads);
+	subscriptions.resize(nb_threads);
+	for (uint32_t i = 0; i < nb_threads; i++)
+		queues[i].reset(new grpc::CompletionQueue());
+	for (size_t device = 0; device < devices.size(); device++) {
+		uint32_t thread = device % nb_threads;
+
+		subscriptions[thread].emplace_back(
+			new DeviceSubscription(device, devices[device], queues[thread].get(), &table));
+	}
+
+	DOCA_LOG_INFO("Monitoring %zu devices with %u threads", devices.size(), nb_threads);
+
+	force_quit = false;
+	signal(SIGINT, signal_handler);
+	signal(SIGTERM, signal_handler);
+
+	for (uint32_t i = 0; i < nb_threads; i++)
+		threads.emplace_back(fleet_worker, queues[i].get(), &subscriptions[i]);
+
+	next_report = monitor_get_time_ns() + (uint64_t)cfg->report_interval * NS_PER_SEC;
+	while (!force_quit) {
+		if (monitor_get_time_ns() >= next_report) {
+			print_report(devices, table, cfg);
+			next_report += (uint64_t)cfg->report_interval * NS_PER_SEC;
+		}
+		usleep(100000);
+	}
+
+	for (auto &thread : threads)
+		thread.join();
+
+	return DOCA_SUCCESS;
+}
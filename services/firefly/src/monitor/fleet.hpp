@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES, ALL RIGHTS RESERVED.
+ *
+ * This software product is a proprietary product of NVIDIA CORPORATION &
+ * AFFILIATES (the "Company") and all right, title, and interest in and to the
+ * software product, including all associated intellectual property rights, are
+ * and shall remain exclusively with the Company.
+ *
+ * This software product is governed by the End User License Agreement
+ * provided with the software product.
+ *
+ */
+
+#ifndef FLEET_H_
+#define FLEET_H_
+
+#include <limits.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <doca_error.h>
+
+#include "firefly_monitor_recorder.hpp"
+
+#define FLEET_MAX_DEVICES 65536		   /* Maximal number of monitored devices */
+#define DEFAULT_FLEET_THREADS 2		   /* Default number of threads that handle the subscriptions */
+#define DEFAULT_FLEET_REPORT_INTERVAL 5	   /* Default time between two fleet reports (seconds) */
+#define DEFAULT_FLEET_OFFSET_THRESHOLD 1000 /* Default largest master offset of a device in sync (nanoseconds) */
+#define DEFAULT_FLEET_STALE_TIMEOUT 10	   /* Default time without records of a device in sync (seconds) */
+#define DEFAULT_FLEET_WORST_COUNT 5	   /* Default number of devices in the worst offsets list */
+
+/* Words of a monitor_sample in a snapshot table entry */
+#define FLEET_SAMPLE_WORDS ((sizeof(struct monitor_sample) + sizeof(uint64_t) - 1) / sizeof(uint64_t))
+
+/* Fleet aggregator configuration, filled by the command line parameters */
+struct fleet_config {
+	char devices_path[PATH_MAX]; /* File with a line per device: "[name] address[:port]" */
+	uint32_t nb_threads;	     /* Number of threads that handle the subscriptions */
+	uint32_t report_interval;    /* Time between two fleet reports (seconds) */
+	uint64_t offset_threshold;   /* Largest master offset of a device in sync (nanoseconds) */
+	uint32_t stale_timeout;	     /* Time without records after which a device is out of sync (seconds) */
+	uint32_t worst_count;	     /* Number of devices in the worst offsets list */
+};
+
+enum fleet_device_state {
+	FLEET_DEVICE_CONNECTING,   /* The subscription was not established yet */
+	FLEET_DEVICE_CONNECTED,	   /* Records are received from the device */
+	FLEET_DEVICE_DISCONNECTED, /* The subscription failed, it is retried after a backoff */
+};
+
+/* Why a device is out of sync, in the order they are checked */
+enum fleet_sync_problem {
+	FLEET_SYNC_OK,		 /* The device is in sync */
+	FLEET_SYNC_DISCONNECTED, /* The device is not connected */
+	FLEET_SYNC_STALE,	 /* No record was received from the device recently */
+	FLEET_SYNC_NO_GM,	 /* The device has no Grandmaster */
+	FLEET_SYNC_NOT_STABLE,	 /* The PTP of the device is not stable */
+	FLEET_SYNC_OFFSET,	 /* The master offset of the device exceeds the threshold */
+};
+
+struct fleet_device_info {
+	std::string name;    /* Name of the device in the reports */
+	std::string address; /* gRPC address of the device */
+};
+
+/* Master offset of a device, as returned by the worst offsets query */
+struct fleet_offset {
+	size_t device;	     /* Index of the device */
+	uint64_t abs_offset; /* Maximal (abs) master offset of the device (nanoseconds) */
+};
+
+/* Counters of the fleet summary query */
+struct fleet_summary {
+	size_t nb_devices;     /* Number of devices */
+	size_t nb_connected;   /* Number of connected devices */
+	size_t nb_gm_present;  /* Number of connected devices with a Grandmaster */
+	size_t nb_stable;      /* Number of connected devices with a stable PTP */
+	size_t nb_out_of_sync; /* Number of devices that are out of sync */
+};
+
+/*
+ * An entry of the snapshot table: the latest sample of a device and its state. The entry is written only by the
+ * thread that handles the device and is read by any thread without locks: a sequence counter that is odd while the
+ * sample is written lets readers detect a torn read and retry.
+ */
+struct alignas(64) fleet_snapshot_entry {
+	std::atomic<uint32_t> seq;			   /* Sequence counter, odd while the sample is written */
+	std::atomic<uint32_t> state;			   /* fleet_device_state of the device */
+	std::atomic<uint64_t> words[FLEET_SAMPLE_WORDS]; /* The latest sample, seq is 0 until it is written */
+};
+
+/*
+ * Latest state of every device of the fleet
+ */
+class FleetSnapshotTable {
+public:
+	/*
+	 * Create a table
+	 *
+	 * @nb_devices [in]: Number of devices
+	 */
+	explicit FleetSnapshotTable(size_t nb_devices);
+
+	/*
+	 * Publish the latest sample of a device, only the thread that handles the device may call it
+	 *
+	 * @device [in]: Index of the device
+	 * @sample [in]: Latest sample
+	 */
+	void publish(size_t device, const struct monitor_sample &sample);
+
+	/*
+	 * Read the latest sample of a device, from any thread
+	 *
+	 * @device [in]: Index of the device
+	 * @sample [out]: Latest sample
+	 * @return: false if no sample was published for the device
+	 */
+	bool read(size_t device, struct monitor_sample &sample) const;
+
+	/*
+	 * Set the state of a device
+	 *
+	 * @device [in]: Index of the device
+	 * @state [in]: New state
+	 */
+	void set_state(size_t device, enum fleet_device_state state);
+
+	/*
+	 * Get the state of a device
+	 *
+	 * @device [in]: Index of the device
+	 * @return: State of the device
+	 */
+	enum fleet_device_state get_state(size_t device) const;
+
+	/*
+	 * Get the number of devices
+	 *
+	 * @return: Number of devices
+	 */
+	size_t size(void) const
+	{
+		return nb_devices_;
+	}
+
+private:
+	std::unique_ptr<struct fleet_snapshot_entry[]> entries_; /* An entry per device */
+	size_t nb_devices_;					  /* Number of devices */
+};
+
+/*
+ * Check if a device is in sync
+ *
+ * @table [in]: Snapshot table
+ * @device [in]: Index of the device
+ * @cfg [in]: Fleet aggregator configuration
+ * @now [in]: Current time (nanoseconds)
+ * @sample [out]: Latest sample of the device, valid unless the device never sent a record
+ * @return: FLEET_SYNC_OK if the device is in sync, otherwise the first problem found
+ */
+enum fleet_sync_problem
+fleet_check_device(const FleetSnapshotTable &table, size_t device, const struct fleet_config *cfg, uint64_t now,
+		   struct monitor_sample *sample);
+
+/*
+ * Count the connected, Grandmaster present, stable and out of sync devices
+ *
+ * @table [in]: Snapshot table
+ * @cfg [in]: Fleet aggregator configuration
+ * @now [in]: Current time (nanoseconds)
+ * @summary [out]: Fleet counters
+ */
+void
+fleet_summarize(const FleetSnapshotTable &table, const struct fleet_config *cfg, uint64_t now,
+		struct fleet_summary *summary);
+
+/*
+ * Find the connected devices with the largest master offsets
+ *
+ * @table [in]: Snapshot table
+ * @max_devices [in]: Maximal number of devices to return
+ * @worst [out]: The devices, the worst first
+ */
+void
+fleet_worst_offsets(const FleetSnapshotTable &table, size_t max_devices, std::vector<struct fleet_offset> &worst);
+
+/*
+ * Get a user-facing description of a sync problem
+ *
+ * @problem [in]: Sync problem
+ * @return: Description
+ */
+const char *
+fleet_sync_problem_string(enum fleet_sync_problem problem);
+
+/*
+ * Subscribe to all the devices of the fleet and report their state until a TERM or INT signal is received
+ *
+ * @cfg [in]: Fleet aggregator configuration
+ * @return: DOCA_SUCCESS on success and DOCA_ERROR otherwise
+ */
+doca_error_t
+run_fleet(struct fleet_config *cfg);
+
+#endif /* FLEET_H_ */